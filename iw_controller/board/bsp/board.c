@@ -36,6 +36,8 @@
 #include "fsl_common.h"
 #include "clock_config.h"
 #include "board.h"
+#include "fsl_inputmux.h"
+#include "fsl_pint.h"
 
 
 
@@ -171,6 +173,40 @@ uint8_t bsp_door_sensor_status()
     return status;
 }
 
+/*传感器引脚中断回调*/
+static bsp_sensor_int_callback_t bsp_sensor_int_callback;
+
+static void bsp_sensor_pint_callback(pint_pin_int_t pintr,uint32_t pmatch_status)
+{
+    if (bsp_sensor_int_callback) {
+        bsp_sensor_int_callback();
+    }
+}
+
+/*锁,锁孔,门磁和手动按键引脚双边沿中断*/
+int bsp_sensor_int_init(bsp_sensor_int_callback_t callback)
+{
+    const IRQn_Type irq[BSP_SENSOR_INT_CNT] = { PIN_INT0_IRQn,PIN_INT1_IRQn,PIN_INT2_IRQn,PIN_INT3_IRQn,PIN_INT4_IRQn };
+
+    bsp_sensor_int_callback = callback;
+    /*引脚连接到PINT通道*/
+    INPUTMUX_Init(INPUTMUX);
+    INPUTMUX_AttachSignal(INPUTMUX,BSP_SENSOR_INT_UNLOCK_SW,kINPUTMUX_GpioPort0Pin4ToPintsel);
+    INPUTMUX_AttachSignal(INPUTMUX,BSP_SENSOR_INT_UNLOCK_SW_MAIN,kINPUTMUX_GpioPort1Pin3ToPintsel);
+    INPUTMUX_AttachSignal(INPUTMUX,BSP_SENSOR_INT_LOCK,kINPUTMUX_GpioPort1Pin7ToPintsel);
+    INPUTMUX_AttachSignal(INPUTMUX,BSP_SENSOR_INT_HOLE,kINPUTMUX_GpioPort1Pin1ToPintsel);
+    INPUTMUX_AttachSignal(INPUTMUX,BSP_SENSOR_INT_DOOR,kINPUTMUX_GpioPort1Pin20ToPintsel);
+    INPUTMUX_Deinit(INPUTMUX);
+
+    PINT_Init(PINT);
+    for (uint8_t i = 0;i < BSP_SENSOR_INT_CNT;i ++) {
+        PINT_PinInterruptConfig(PINT,(pint_pin_int_t)i,kPINT_PinIntEnableBothEdges,bsp_sensor_pint_callback);
+        NVIC_SetPriority(irq[i],3);
+        EnableIRQ(irq[i]);
+    }
+    return 0;
+}
+
 /*板级初始化*/
 int bsp_board_init(void)
 {
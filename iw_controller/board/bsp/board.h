@@ -77,6 +77,17 @@ extern "C" {
 #define  BSP_UNLOCK_SW_STATUS_PRESS        0x77
 #define  BSP_UNLOCK_SW_STATUS_RELEASE      0x88
 
+/*传感器引脚中断通道 PINT*/
+#define  BSP_SENSOR_INT_UNLOCK_SW          0
+#define  BSP_SENSOR_INT_UNLOCK_SW_MAIN     1
+#define  BSP_SENSOR_INT_LOCK               2
+#define  BSP_SENSOR_INT_HOLE               3
+#define  BSP_SENSOR_INT_DOOR               4
+#define  BSP_SENSOR_INT_CNT                5
+
+/*传感器引脚电平变化回调,在中断中执行*/
+typedef void (*bsp_sensor_int_callback_t)(void);
+
   
 int bsp_board_init(void);
 /*开压缩机*/
@@ -95,6 +106,8 @@ uint8_t bsp_lock_sensor_status(void);
 uint8_t bsp_hole_sensor_status(void);
 /*手动开锁按键状态*/
 uint8_t bsp_unlock_sw_status();
+/*锁,锁孔,门磁和手动按键引脚双边沿中断*/
+int bsp_sensor_int_init(bsp_sensor_int_callback_t callback);
 
 
 
@@ -0,0 +1,99 @@
+/*****************************************************************************
+*  linux simulation board
+*  Copyright (C) 2019 wkxboot 1131204425@qq.com.
+*
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License version 3 as
+*  published by the Free Software Foundation.
+*
+*  @file     SEGGER_RTT.c
+*  @brief    segger rtt terminal on stdin/stdout
+*  @author   wkxboot
+*  @email    1131204425@qq.com
+*  @version  v1.0.0
+*  @date     2019/1/10
+*  @license  GNU General Public License (GPL)
+*
+*
+*****************************************************************************/
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include "SEGGER_RTT.h"
+
+
+/*
+* @brief 终端初始化
+* @param 无
+* @return 无
+* @note 读取前先查询,标准输入保持阻塞模式
+*/
+void SEGGER_RTT_Init(void)
+{
+}
+
+/*
+* @brief 终端读取
+* @param BufferIndex 终端号,只支持0
+* @param pBuffer 存储地址
+* @param BufferSize 期望读取的数量
+* @return 实际读取的数量
+* @note 没有输入时返回0
+*/
+unsigned SEGGER_RTT_Read(unsigned BufferIndex,void *pBuffer,unsigned BufferSize)
+{
+    struct pollfd fd = { .fd = STDIN_FILENO,.events = POLLIN };
+    ssize_t n;
+
+    if (BufferIndex != 0 || BufferSize == 0) {
+        return 0;
+    }
+    if (poll(&fd,1,0) != 1 || (fd.revents & POLLIN) == 0) {
+        return 0;
+    }
+    n = read(STDIN_FILENO,pBuffer,BufferSize);
+    return n > 0 ? (unsigned)n : 0;
+}
+
+/*
+* @brief 终端写入
+* @param BufferIndex 终端号,只支持0
+* @param pBuffer 数据
+* @param NumBytes 数量
+* @return 实际写入的数量
+* @note stdout阻塞写入,被信号打断时继续
+*/
+unsigned SEGGER_RTT_Write(unsigned BufferIndex,const void *pBuffer,unsigned NumBytes)
+{
+    const char *data = (const char *)pBuffer;
+    unsigned cnt = 0;
+    ssize_t n;
+
+    if (BufferIndex != 0) {
+        return 0;
+    }
+    while (cnt < NumBytes) {
+        n = write(STDOUT_FILENO,data + cnt,NumBytes - cnt);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        cnt += (unsigned)n;
+    }
+    return cnt;
+}
+
+unsigned SEGGER_RTT_WriteString(unsigned BufferIndex,const char *s)
+{
+    return SEGGER_RTT_Write(BufferIndex,s,(unsigned)strlen(s));
+}
+
+/*printf.c的输出*/
+void _putchar(char character)
+{
+    SEGGER_RTT_Write(0,&character,1);
+}
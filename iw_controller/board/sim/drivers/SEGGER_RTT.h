@@ -0,0 +1,40 @@
+/*****************************************************************************
+*  linux simulation board
+*  Copyright (C) 2019 wkxboot 1131204425@qq.com.
+*
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License version 3 as
+*  published by the Free Software Foundation.
+*
+*  @file     SEGGER_RTT.h
+*  @brief    segger rtt terminal on stdin/stdout
+*  @author   wkxboot
+*  @email    1131204425@qq.com
+*  @version  v1.0.0
+*  @date     2019/1/10
+*  @license  GNU General Public License (GPL)
+*
+*
+*****************************************************************************/
+#ifndef  __SIM_SEGGER_RTT_H__
+#define  __SIM_SEGGER_RTT_H__
+
+#ifdef  __cplusplus
+    extern "C" {
+#endif
+
+/*
+* 仿真时RTT终端0是进程的标准输入输出:日志写到stdout,debug_task的命令
+* 从stdin读取.只使用read/write系统调用,可以在任务和仿真中断中调用.
+*/
+void     SEGGER_RTT_Init(void);
+unsigned SEGGER_RTT_Read(unsigned BufferIndex,void *pBuffer,unsigned BufferSize);
+unsigned SEGGER_RTT_Write(unsigned BufferIndex,const void *pBuffer,unsigned NumBytes);
+unsigned SEGGER_RTT_WriteString(unsigned BufferIndex,const char *s);
+
+#ifdef  __cplusplus
+    }
+#endif
+
+#endif
@@ -0,0 +1,64 @@
+/*****************************************************************************
+*  linux simulation board
+*  Copyright (C) 2019 wkxboot 1131204425@qq.com.
+*
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License version 3 as
+*  published by the Free Software Foundation.
+*
+*  @file     cmsis_gcc.h
+*  @brief    cortex-m intrinsics used by the firmware, host versions
+*  @author   wkxboot
+*  @email    1131204425@qq.com
+*  @version  v1.0.0
+*  @date     2019/1/10
+*  @license  GNU General Public License (GPL)
+*
+*
+*****************************************************************************/
+#ifndef  __SIM_CMSIS_GCC_H__
+#define  __SIM_CMSIS_GCC_H__
+
+#include "stdint.h"
+
+#ifndef   __ASM
+#define   __ASM                          __asm
+#endif
+#ifndef   __INLINE
+#define   __INLINE                       inline
+#endif
+#ifndef   __STATIC_INLINE
+#define   __STATIC_INLINE                static inline
+#endif
+
+/*仿真中断运行在节拍信号中,IPSR非0表示在中断中*/
+extern long xPortIsInsideInterrupt(void);
+
+__STATIC_INLINE uint32_t __get_IPSR(void)
+{
+    return xPortIsInsideInterrupt() ? 15U : 0U;
+}
+
+__STATIC_INLINE uint8_t __CLZ(uint32_t value)
+{
+    return value == 0 ? 32U : (uint8_t)__builtin_clz(value);
+}
+
+__STATIC_INLINE uint32_t __RBIT(uint32_t value)
+{
+    uint32_t result = 0;
+
+    for (uint8_t i = 0;i < 32;i ++) {
+        result = (result << 1) | (value & 1U);
+        value >>= 1;
+    }
+    return result;
+}
+
+#define  __DSB()                         __sync_synchronize()
+#define  __DMB()                         __sync_synchronize()
+#define  __ISB()                         __sync_synchronize()
+#define  __NOP()                         do { } while (0)
+
+#endif
@@ -0,0 +1,155 @@
+/*****************************************************************************
+*  linux simulation board
+*  Copyright (C) 2019 wkxboot 1131204425@qq.com.
+*
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License version 3 as
+*  published by the Free Software Foundation.
+*
+*  @file     fsl_adc.c
+*  @brief    simulated lpc54606 sdk: 12-bit adc
+*  @author   wkxboot
+*  @email    1131204425@qq.com
+*  @version  v1.0.0
+*  @date     2019/1/10
+*  @license  GNU General Public License (GPL)
+*
+*
+*****************************************************************************/
+#include "fsl_adc.h"
+#include "fsl_inputmux.h"
+#include "sim.h"
+
+
+ADC_Type sim_adc;
+
+static adc_conv_seq_config_t sim_adc_seqa;
+static bool sim_adc_seqa_enabled;
+static uint32_t sim_adc_int_enable;
+static uint32_t sim_adc_threshold_low;
+static uint32_t sim_adc_threshold_high;
+static uint32_t sim_adc_threshold_mode[SIM_ADC_CHANNEL_CNT];
+static volatile uint32_t sim_adc_flags;
+
+void ADC_Init(ADC_Type *base,const adc_config_t *config)
+{
+    (void)config;
+    memset(base,0,sizeof(*base));
+    sim_adc_seqa_enabled = false;
+}
+
+void ADC_Deinit(ADC_Type *base)
+{
+    (void)base;
+    sim_adc_seqa_enabled = false;
+}
+
+bool ADC_DoSelfCalibration(ADC_Type *base)
+{
+    (void)base;
+    return true;
+}
+
+void ADC_EnableTemperatureSensor(ADC_Type *base,bool enable)
+{
+    (void)base;
+    (void)enable;
+}
+
+void ADC_SetConvSeqAConfig(ADC_Type *base,const adc_conv_seq_config_t *config)
+{
+    (void)base;
+    sim_adc_seqa = *config;
+}
+
+void ADC_EnableConvSeqA(ADC_Type *base,bool enable)
+{
+    (void)base;
+    sim_adc_seqa_enabled = enable;
+}
+
+void ADC_EnableInterrupts(ADC_Type *base,uint32_t mask)
+{
+    (void)base;
+    sim_adc_int_enable |= mask;
+}
+
+void ADC_DisableInterrupts(ADC_Type *base,uint32_t mask)
+{
+    (void)base;
+    sim_adc_int_enable &= ~mask;
+}
+
+void ADC_SetThresholdPair0(ADC_Type *base,uint32_t lowValue,uint32_t highValue)
+{
+    (void)base;
+    sim_adc_threshold_low = lowValue;
+    sim_adc_threshold_high = highValue;
+}
+
+void ADC_SetChannelWithThresholdPair0(ADC_Type *base,uint32_t channelMask)
+{
+    /*仿真只有阈值对0*/
+    (void)base;
+    (void)channelMask;
+}
+
+void ADC_EnableThresholdCompareInterrupt(ADC_Type *base,uint32_t channel,adc_threshold_interrupt_mode_t mode)
+{
+    (void)base;
+    assert(channel < SIM_ADC_CHANNEL_CNT);
+    sim_adc_threshold_mode[channel] = mode;
+}
+
+uint32_t ADC_GetStatusFlags(ADC_Type *base)
+{
+    (void)base;
+    return sim_adc_flags;
+}
+
+void ADC_ClearStatusFlags(ADC_Type *base,uint32_t mask)
+{
+    (void)base;
+    sim_adc_flags &= ~mask;
+}
+
+/*
+* @brief 硬件触发输入的上升沿
+* @param input 触发输入号
+* @return 无
+* @note 序列A按通道号从低到高转换,每个结果产生一次DMA请求
+*/
+void sim_adc_trigger(uint8_t input)
+{
+    uint32_t value;
+    bool outside,irq = false;
+
+    if (sim_adc_seqa_enabled == false || sim_adc_seqa.triggerMask != input) {
+        return;
+    }
+    for (uint8_t ch = 0;ch < SIM_ADC_CHANNEL_CNT;ch ++) {
+        if ((sim_adc_seqa.channelMask & (1U << ch)) == 0) {
+            continue;
+        }
+        if (sim_input(SIM_INPUT_ADC,ch,&value) != 0) {
+            value = SIM_ADC_DEFAULT_VALUE;
+        }
+        value &= 0xFFFU;
+        sim_adc.SEQ_GDAT[0] = (value << ADC_SEQ_GDAT_RESULT_SHIFT) | ((uint32_t)ch << ADC_SEQ_GDAT_CHN_SHIFT) | ADC_SEQ_GDAT_DATAVALID_MASK;
+        outside = value < sim_adc_threshold_low || value > sim_adc_threshold_high;
+        if (outside) {
+            sim_adc_flags |= kADC_ThresholdCompareFlagOnChn0 << ch;
+            irq = irq || sim_adc_threshold_mode[ch] == kADC_ThresholdInterruptOnOutside;
+        }
+        if ((sim_adc_int_enable & kADC_ConvSeqAInterruptEnable) && sim_adc_seqa.interruptMode == kADC_InterruptForEachConversion) {
+            sim_inputmux_dma_signal(SIM_INPUTMUX_DMA_ADC0_SEQA);
+        }
+    }
+    if ((sim_adc_int_enable & kADC_ConvSeqAInterruptEnable) && sim_adc_seqa.interruptMode == kADC_InterruptForEachSequence) {
+        sim_inputmux_dma_signal(SIM_INPUTMUX_DMA_ADC0_SEQA);
+    }
+    if (irq) {
+        NVIC_SetPendingIRQ(ADC0_THCMP_IRQn);
+    }
+}
@@ -0,0 +1,132 @@
+/*****************************************************************************
+*  linux simulation board
+*  Copyright (C) 2019 wkxboot 1131204425@qq.com.
+*
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License version 3 as
+*  published by the Free Software Foundation.
+*
+*  @file     fsl_adc.h
+*  @brief    simulated lpc54606 sdk: 12-bit adc
+*  @author   wkxboot
+*  @email    1131204425@qq.com
+*  @version  v1.0.0
+*  @date     2019/1/10
+*  @license  GNU General Public License (GPL)
+*
+*
+*****************************************************************************/
+#ifndef  __SIM_FSL_ADC_H__
+#define  __SIM_FSL_ADC_H__
+
+#include "fsl_common.h"
+
+#ifdef  __cplusplus
+    extern "C" {
+#endif
+
+#define  SIM_ADC_CHANNEL_CNT             12
+
+#define  ADC_SEQ_GDAT_RESULT_MASK        (0xFFF0U)
+#define  ADC_SEQ_GDAT_RESULT_SHIFT       (4U)
+#define  ADC_SEQ_GDAT_CHN_MASK           (0x3C000000U)
+#define  ADC_SEQ_GDAT_CHN_SHIFT          (26U)
+#define  ADC_SEQ_GDAT_DATAVALID_MASK     (0x80000000U)
+
+typedef enum _adc_clock_mode
+{
+    kADC_ClockSynchronousMode = 0U,
+    kADC_ClockAsynchronousMode,
+}adc_clock_mode_t;
+
+typedef enum _adc_resolution
+{
+    kADC_Resolution6bit = 0U,
+    kADC_Resolution8bit,
+    kADC_Resolution10bit,
+    kADC_Resolution12bit,
+}adc_resolution_t;
+
+typedef struct _adc_config
+{
+    adc_clock_mode_t clockMode;
+    uint32_t clockDividerNumber;
+    adc_resolution_t resolution;
+    bool enableBypassCalibration;
+    uint32_t sampleTimeNumber;
+}adc_config_t;
+
+typedef enum _adc_trigger_polarity
+{
+    kADC_TriggerPolarityNegativeEdge = 0U,
+    kADC_TriggerPolarityPositiveEdge,
+}adc_trigger_polarity_t;
+
+typedef enum _adc_seq_interrupt_mode
+{
+    kADC_InterruptForEachConversion = 0U,
+    kADC_InterruptForEachSequence,
+}adc_seq_interrupt_mode_t;
+
+typedef struct _adc_conv_seq_config
+{
+    uint32_t channelMask;
+    uint32_t triggerMask;
+    adc_trigger_polarity_t triggerPolarity;
+    bool enableSyncBypass;
+    bool enableSingleStep;
+    adc_seq_interrupt_mode_t interruptMode;
+}adc_conv_seq_config_t;
+
+typedef enum _adc_threshold_interrupt_mode
+{
+    kADC_ThresholdInterruptDisabled = 0U,
+    kADC_ThresholdInterruptOnOutside,
+    kADC_ThresholdInterruptOnCrossing,
+}adc_threshold_interrupt_mode_t;
+
+enum _adc_status_flags
+{
+    kADC_ThresholdCompareFlagOnChn0 = 1U << 0,
+    kADC_ConvSeqAInterruptFlag = 1U << 28,
+};
+
+enum _adc_interrupt_enable
+{
+    kADC_ConvSeqAInterruptEnable = 1U << 0,
+    kADC_ConvSeqBInterruptEnable = 1U << 1,
+    kADC_OverrunInterruptEnable = 1U << 2,
+};
+
+typedef struct
+{
+    __IO uint32_t SEQ_GDAT[2];
+}ADC_Type;
+
+extern ADC_Type sim_adc;
+#define  ADC0                            (&sim_adc)
+
+/*
+* 序列A在配置的硬件触发输入上升沿转换所有通道,转换值来自inputs文件的adcN,
+* 每个转换结果经过INPUTMUX产生DMA请求.阈值比较在每次转换后检查.
+*/
+void ADC_Init(ADC_Type *base,const adc_config_t *config);
+void ADC_Deinit(ADC_Type *base);
+bool ADC_DoSelfCalibration(ADC_Type *base);
+void ADC_EnableTemperatureSensor(ADC_Type *base,bool enable);
+void ADC_SetConvSeqAConfig(ADC_Type *base,const adc_conv_seq_config_t *config);
+void ADC_EnableConvSeqA(ADC_Type *base,bool enable);
+void ADC_EnableInterrupts(ADC_Type *base,uint32_t mask);
+void ADC_DisableInterrupts(ADC_Type *base,uint32_t mask);
+void ADC_SetThresholdPair0(ADC_Type *base,uint32_t lowValue,uint32_t highValue);
+void ADC_SetChannelWithThresholdPair0(ADC_Type *base,uint32_t channelMask);
+void ADC_EnableThresholdCompareInterrupt(ADC_Type *base,uint32_t channel,adc_threshold_interrupt_mode_t mode);
+uint32_t ADC_GetStatusFlags(ADC_Type *base);
+void ADC_ClearStatusFlags(ADC_Type *base,uint32_t mask);
+
+#ifdef  __cplusplus
+    }
+#endif
+
+#endif
@@ -0,0 +1,38 @@
+/*****************************************************************************
+*  linux simulation board
+*  Copyright (C) 2019 wkxboot 1131204425@qq.com.
+*
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License version 3 as
+*  published by the Free Software Foundation.
+*
+*  @file     fsl_clock.c
+*  @brief    simulated lpc54606 sdk: clocks
+*  @author   wkxboot
+*  @email    1131204425@qq.com
+*  @version  v1.0.0
+*  @date     2019/1/10
+*  @license  GNU General Public License (GPL)
+*
+*
+*****************************************************************************/
+#include "fsl_clock.h"
+
+
+uint32_t CLOCK_GetFreq(clock_name_t name)
+{
+    switch (name) {
+    case kCLOCK_CoreSysClk:
+    case kCLOCK_BusClk:
+        return SystemCoreClock;
+    case kCLOCK_FroHf:
+        return 96000000U;
+    case kCLOCK_Fro12M:
+        return 12000000U;
+    case kCLOCK_WdtOsc:
+        return SIM_CLOCK_WDT_OSC_FREQ;
+    default:
+        return 0;
+    }
+}
@@ -0,0 +1,97 @@
+/*****************************************************************************
+*  linux simulation board
+*  Copyright (C) 2019 wkxboot 1131204425@qq.com.
+*
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License version 3 as
+*  published by the Free Software Foundation.
+*
+*  @file     fsl_clock.h
+*  @brief    simulated lpc54606 sdk: clocks
+*  @author   wkxboot
+*  @email    1131204425@qq.com
+*  @version  v1.0.0
+*  @date     2019/1/10
+*  @license  GNU General Public License (GPL)
+*
+*
+*****************************************************************************/
+#ifndef  __SIM_FSL_CLOCK_H__
+#define  __SIM_FSL_CLOCK_H__
+
+#include "fsl_common.h"
+
+#ifdef  __cplusplus
+    extern "C" {
+#endif
+
+typedef enum _clock_name
+{
+    kCLOCK_CoreSysClk,
+    kCLOCK_BusClk,
+    kCLOCK_FroHf,
+    kCLOCK_Fro12M,
+    kCLOCK_WdtOsc,
+}clock_name_t;
+
+/*时钟门控只记录,仿真外设不检查*/
+typedef enum _clock_ip_name
+{
+    kCLOCK_IpInvalid = 0,
+    kCLOCK_Iocon,
+    kCLOCK_InputMux,
+    kCLOCK_Gpio0,
+    kCLOCK_Gpio1,
+    kCLOCK_Pint,
+    kCLOCK_Eeprom,
+    kCLOCK_Dma,
+    kCLOCK_Adc0,
+    kCLOCK_Wwdt,
+    kCLOCK_Ct32b0,
+    kCLOCK_Ct32b1,
+    kCLOCK_Ct32b2,
+    kCLOCK_FlexComm0,
+    kCLOCK_FlexComm1,
+    kCLOCK_FlexComm2,
+    kCLOCK_FlexComm3,
+    kCLOCK_FlexComm4,
+    kCLOCK_FlexComm5,
+    kCLOCK_FlexComm6,
+    kCLOCK_FlexComm7,
+    kCLOCK_FlexComm8,
+    kCLOCK_FlexComm9,
+}clock_ip_name_t;
+
+typedef enum _clock_attach_id
+{
+    kFRO_HF_to_ADC_CLK,
+    kMAIN_CLK_to_ADC_CLK,
+    kFRO12M_to_FLEXCOMM0,
+    kNONE_to_NONE,
+}clock_attach_id_t;
+
+#define  SIM_CLOCK_WDT_OSC_FREQ          500000U
+
+uint32_t CLOCK_GetFreq(clock_name_t name);
+
+static inline void CLOCK_EnableClock(clock_ip_name_t clk)
+{
+    (void)clk;
+}
+
+static inline void CLOCK_DisableClock(clock_ip_name_t clk)
+{
+    (void)clk;
+}
+
+static inline void CLOCK_AttachClk(clock_attach_id_t connection)
+{
+    (void)connection;
+}
+
+#ifdef  __cplusplus
+    }
+#endif
+
+#endif
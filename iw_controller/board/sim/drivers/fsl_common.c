@@ -0,0 +1,181 @@
+/*****************************************************************************
+*  linux simulation board
+*  Copyright (C) 2019 wkxboot 1131204425@qq.com.
+*
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License version 3 as
+*  published by the Free Software Foundation.
+*
+*  @file     fsl_common.c
+*  @brief    simulated lpc54606 sdk: common definitions and nvic
+*  @author   wkxboot
+*  @email    1131204425@qq.com
+*  @version  v1.0.0
+*  @date     2019/1/10
+*  @license  GNU General Public License (GPL)
+*
+*
+*****************************************************************************/
+#include "fsl_common.h"
+#include "sim.h"
+
+
+typedef void (*sim_irq_handler_t)(void);
+
+uint32_t SystemCoreClock = 12000000U;
+CoreDebug_Type sim_core_debug;
+
+static DWT_Type sim_dwt_regs;
+static uint64_t sim_dwt_time;
+
+static volatile bool sim_nvic_enabled[SIM_IRQ_CNT];
+static volatile bool sim_nvic_pending[SIM_IRQ_CNT];
+static volatile uint8_t sim_nvic_priority[SIM_IRQ_CNT];
+
+/*没有实现的中断*/
+static void sim_default_handler(void)
+{
+}
+
+#define  SIM_WEAK_HANDLER(name)          void name(void) __attribute__((weak,alias("sim_default_handler")))
+
+SIM_WEAK_HANDLER(WDT_BOD_IRQHandler);
+SIM_WEAK_HANDLER(DMA0_IRQHandler);
+SIM_WEAK_HANDLER(PIN_INT0_IRQHandler);
+SIM_WEAK_HANDLER(PIN_INT1_IRQHandler);
+SIM_WEAK_HANDLER(PIN_INT2_IRQHandler);
+SIM_WEAK_HANDLER(PIN_INT3_IRQHandler);
+SIM_WEAK_HANDLER(PIN_INT4_IRQHandler);
+SIM_WEAK_HANDLER(PIN_INT5_IRQHandler);
+SIM_WEAK_HANDLER(PIN_INT6_IRQHandler);
+SIM_WEAK_HANDLER(PIN_INT7_IRQHandler);
+SIM_WEAK_HANDLER(CTIMER0_IRQHandler);
+SIM_WEAK_HANDLER(CTIMER1_IRQHandler);
+SIM_WEAK_HANDLER(CTIMER2_IRQHandler);
+SIM_WEAK_HANDLER(FLEXCOMM0_IRQHandler);
+SIM_WEAK_HANDLER(FLEXCOMM1_IRQHandler);
+SIM_WEAK_HANDLER(FLEXCOMM2_IRQHandler);
+SIM_WEAK_HANDLER(FLEXCOMM3_IRQHandler);
+SIM_WEAK_HANDLER(FLEXCOMM4_IRQHandler);
+SIM_WEAK_HANDLER(FLEXCOMM5_IRQHandler);
+SIM_WEAK_HANDLER(FLEXCOMM6_IRQHandler);
+SIM_WEAK_HANDLER(FLEXCOMM7_IRQHandler);
+SIM_WEAK_HANDLER(FLEXCOMM8_IRQHandler);
+SIM_WEAK_HANDLER(FLEXCOMM9_IRQHandler);
+SIM_WEAK_HANDLER(ADC0_SEQA_IRQHandler);
+SIM_WEAK_HANDLER(ADC0_SEQB_IRQHandler);
+SIM_WEAK_HANDLER(ADC0_THCMP_IRQHandler);
+SIM_WEAK_HANDLER(EEPROM_IRQHandler);
+
+static const sim_irq_handler_t sim_irq_handler[SIM_IRQ_CNT] = {
+[WDT_BOD_IRQn]   = WDT_BOD_IRQHandler,
+[DMA0_IRQn]      = DMA0_IRQHandler,
+[PIN_INT0_IRQn]  = PIN_INT0_IRQHandler,
+[PIN_INT1_IRQn]  = PIN_INT1_IRQHandler,
+[PIN_INT2_IRQn]  = PIN_INT2_IRQHandler,
+[PIN_INT3_IRQn]  = PIN_INT3_IRQHandler,
+[PIN_INT4_IRQn]  = PIN_INT4_IRQHandler,
+[PIN_INT5_IRQn]  = PIN_INT5_IRQHandler,
+[PIN_INT6_IRQn]  = PIN_INT6_IRQHandler,
+[PIN_INT7_IRQn]  = PIN_INT7_IRQHandler,
+[CTIMER0_IRQn]   = CTIMER0_IRQHandler,
+[CTIMER1_IRQn]   = CTIMER1_IRQHandler,
+[CTIMER2_IRQn]   = CTIMER2_IRQHandler,
+[FLEXCOMM0_IRQn] = FLEXCOMM0_IRQHandler,
+[FLEXCOMM1_IRQn] = FLEXCOMM1_IRQHandler,
+[FLEXCOMM2_IRQn] = FLEXCOMM2_IRQHandler,
+[FLEXCOMM3_IRQn] = FLEXCOMM3_IRQHandler,
+[FLEXCOMM4_IRQn] = FLEXCOMM4_IRQHandler,
+[FLEXCOMM5_IRQn] = FLEXCOMM5_IRQHandler,
+[FLEXCOMM6_IRQn] = FLEXCOMM6_IRQHandler,
+[FLEXCOMM7_IRQn] = FLEXCOMM7_IRQHandler,
+[FLEXCOMM8_IRQn] = FLEXCOMM8_IRQHandler,
+[FLEXCOMM9_IRQn] = FLEXCOMM9_IRQHandler,
+[ADC0_SEQA_IRQn] = ADC0_SEQA_IRQHandler,
+[ADC0_SEQB_IRQn] = ADC0_SEQB_IRQHandler,
+[ADC0_THCMP_IRQn]= ADC0_THCMP_IRQHandler,
+[EEPROM_IRQn]    = EEPROM_IRQHandler,
+};
+
+void NVIC_EnableIRQ(IRQn_Type irq)
+{
+    if (irq >= 0 && irq < SIM_IRQ_CNT) {
+        sim_nvic_enabled[irq] = true;
+    }
+}
+
+void NVIC_DisableIRQ(IRQn_Type irq)
+{
+    if (irq >= 0 && irq < SIM_IRQ_CNT) {
+        sim_nvic_enabled[irq] = false;
+    }
+}
+
+void NVIC_SetPendingIRQ(IRQn_Type irq)
+{
+    if (irq >= 0 && irq < SIM_IRQ_CNT) {
+        sim_nvic_pending[irq] = true;
+    }
+}
+
+void NVIC_ClearPendingIRQ(IRQn_Type irq)
+{
+    if (irq >= 0 && irq < SIM_IRQ_CNT) {
+        sim_nvic_pending[irq] = false;
+    }
+}
+
+void NVIC_SetPriority(IRQn_Type irq,uint32_t priority)
+{
+    if (irq >= 0 && irq < SIM_IRQ_CNT) {
+        sim_nvic_priority[irq] = (uint8_t)priority;
+    }
+}
+
+void __NVIC_SystemReset(void)
+{
+    sim_reset(false);
+}
+
+/*
+* @brief 调用挂起并使能的中断
+* @param 无
+* @return 无
+* @note 每次选择优先级最高的一个,中断中再次挂起的在同一节拍继续处理
+*/
+void sim_nvic_dispatch(void)
+{
+    int irq,best;
+
+    for (uint16_t cnt = 0;cnt < SIM_IRQ_CNT * 4;cnt ++) {
+        best = -1;
+        for (irq = 0;irq < SIM_IRQ_CNT;irq ++) {
+            if (sim_nvic_enabled[irq] == false || sim_nvic_pending[irq] == false) {
+                continue;
+            }
+            if (best < 0 || sim_nvic_priority[irq] < sim_nvic_priority[best]) {
+                best = irq;
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+        sim_nvic_pending[best] = false;
+        if (sim_irq_handler[best] != NULL) {
+            sim_irq_handler[best]();
+        }
+    }
+}
+
+DWT_Type *sim_dwt(void)
+{
+    uint64_t now = sim_time_us();
+
+    /*写入的CYCCNT作为起点继续计数*/
+    if ((sim_core_debug.DEMCR & CoreDebug_DEMCR_TRCENA_Msk) && (sim_dwt_regs.CTRL & DWT_CTRL_CYCCNTENA_Msk)) {
+        sim_dwt_regs.CYCCNT += (uint32_t)((now - sim_dwt_time) * (SystemCoreClock / 1000000U));
+    }
+    sim_dwt_time = now;
+    return &sim_dwt_regs;
+}
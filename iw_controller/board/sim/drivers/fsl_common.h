@@ -0,0 +1,154 @@
+/*****************************************************************************
+*  linux simulation board
+*  Copyright (C) 2019 wkxboot 1131204425@qq.com.
+*
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License version 3 as
+*  published by the Free Software Foundation.
+*
+*  @file     fsl_common.h
+*  @brief    simulated lpc54606 sdk: common definitions and nvic
+*  @author   wkxboot
+*  @email    1131204425@qq.com
+*  @version  v1.0.0
+*  @date     2019/1/10
+*  @license  GNU General Public License (GPL)
+*
+*
+*****************************************************************************/
+#ifndef  __SIM_FSL_COMMON_H__
+#define  __SIM_FSL_COMMON_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "LPC54606_features.h"
+#include "cmsis_gcc.h"
+
+#ifdef  __cplusplus
+    extern "C" {
+#endif
+
+/*只保留固件用到的SDK定义,名称和取值与SDK 2.x一致*/
+typedef int32_t status_t;
+
+enum _generic_status
+{
+    kStatus_Success = 0,
+    kStatus_Fail = 1,
+    kStatus_ReadOnly = 2,
+    kStatus_OutOfRange = 3,
+    kStatus_InvalidArgument = 4,
+    kStatus_Timeout = 5,
+};
+
+#ifndef  __weak
+#define  __weak                          __attribute__((weak))
+#endif
+#define  __IO                            volatile
+#define  __I                             volatile const
+#define  __O                             volatile
+#define  SDK_ALIGN(var,alignbytes)       var __attribute__((aligned(alignbytes)))
+#define  ARRAY_SIZE(x)                   (sizeof(x) / sizeof((x)[0]))
+#ifndef  MIN
+#define  MIN(a,b)                        ((a) < (b) ? (a) : (b))
+#endif
+#ifndef  MAX
+#define  MAX(a,b)                        ((a) > (b) ? (a) : (b))
+#endif
+
+#define  __NVIC_PRIO_BITS                3
+
+typedef enum IRQn
+{
+    SysTick_IRQn                 = -1,
+    WDT_BOD_IRQn                 = 0,
+    DMA0_IRQn                    = 1,
+    PIN_INT0_IRQn                = 4,
+    PIN_INT1_IRQn                = 5,
+    PIN_INT2_IRQn                = 6,
+    PIN_INT3_IRQn                = 7,
+    CTIMER0_IRQn                 = 10,
+    CTIMER1_IRQn                 = 11,
+    FLEXCOMM0_IRQn               = 14,
+    FLEXCOMM1_IRQn               = 15,
+    FLEXCOMM2_IRQn               = 16,
+    FLEXCOMM3_IRQn               = 17,
+    FLEXCOMM4_IRQn               = 18,
+    FLEXCOMM5_IRQn               = 19,
+    FLEXCOMM6_IRQn               = 20,
+    FLEXCOMM7_IRQn               = 21,
+    ADC0_SEQA_IRQn               = 22,
+    ADC0_SEQB_IRQn               = 23,
+    ADC0_THCMP_IRQn              = 24,
+    PIN_INT4_IRQn                = 32,
+    PIN_INT5_IRQn                = 33,
+    PIN_INT6_IRQn                = 34,
+    PIN_INT7_IRQn                = 35,
+    CTIMER2_IRQn                 = 36,
+    FLEXCOMM8_IRQn               = 40,
+    FLEXCOMM9_IRQn               = 41,
+    EEPROM_IRQn                  = 52,
+}IRQn_Type;
+
+#define  SIM_IRQ_CNT                     57
+
+/*
+* 仿真NVIC:使能和挂起的中断在节拍信号中按优先级调用,同一优先级按中断号,
+* 中断之间不嵌套.
+*/
+void NVIC_EnableIRQ(IRQn_Type irq);
+void NVIC_DisableIRQ(IRQn_Type irq);
+void NVIC_SetPendingIRQ(IRQn_Type irq);
+void NVIC_ClearPendingIRQ(IRQn_Type irq);
+void NVIC_SetPriority(IRQn_Type irq,uint32_t priority);
+void __NVIC_SystemReset(void);
+
+#define  NVIC_SystemReset()              __NVIC_SystemReset()
+
+static inline status_t EnableIRQ(IRQn_Type irq)
+{
+    NVIC_EnableIRQ(irq);
+    return kStatus_Success;
+}
+
+static inline status_t DisableIRQ(IRQn_Type irq)
+{
+    NVIC_DisableIRQ(irq);
+    return kStatus_Success;
+}
+
+extern uint32_t SystemCoreClock;
+
+/*DWT周期计数器按SystemCoreClock和单调时钟计算,读取时更新*/
+typedef struct
+{
+    __IO uint32_t CTRL;
+    __IO uint32_t CYCCNT;
+}DWT_Type;
+
+typedef struct
+{
+    __IO uint32_t DEMCR;
+}CoreDebug_Type;
+
+DWT_Type *sim_dwt(void);
+extern CoreDebug_Type sim_core_debug;
+
+#define  DWT                             (sim_dwt())
+#define  CoreDebug                       (&sim_core_debug)
+#define  CoreDebug_DEMCR_TRCENA_Msk      (1UL << 24)
+#define  DWT_CTRL_CYCCNTENA_Msk          (1UL << 0)
+
+#ifdef  __cplusplus
+    }
+#endif
+
+/*与SDK一致,fsl_common.h带入时钟驱动*/
+#include "fsl_clock.h"
+
+#endif
@@ -0,0 +1,182 @@
+/*****************************************************************************
+*  linux simulation board
+*  Copyright (C) 2019 wkxboot 1131204425@qq.com.
+*
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License version 3 as
+*  published by the Free Software Foundation.
+*
+*  @file     fsl_ctimer.c
+*  @brief    simulated lpc54606 sdk: standard counter/timers
+*  @author   wkxboot
+*  @email    1131204425@qq.com
+*  @version  v1.0.0
+*  @date     2019/1/10
+*  @license  GNU General Public License (GPL)
+*
+*
+*****************************************************************************/
+#include "fsl_ctimer.h"
+#include "fsl_clock.h"
+#include "sim.h"
+
+
+#define  SIM_CTIMER_EDGE_MAX             64 /*一个节拍最多处理的匹配次数,暂停之后不追赶*/
+
+typedef struct
+{
+    bool     running;
+    uint32_t prescale;
+    uint64_t start;         /*开始计数的时间 单位:us*/
+    uint32_t start_tc;      /*开始时的计数值*/
+    bool     match_enable[SIM_CTIMER_MATCH_CNT];
+    ctimer_match_config_t match[SIM_CTIMER_MATCH_CNT];
+    uint64_t match_cnt[SIM_CTIMER_MATCH_CNT];   /*已经处理的匹配次数*/
+    bool     match_out[SIM_CTIMER_MATCH_CNT];
+}sim_ctimer_t;
+
+static CTIMER_Type sim_ctimer_regs[SIM_CTIMER_CNT];
+static sim_ctimer_t sim_ctimer_state[SIM_CTIMER_CNT];
+
+static uint8_t sim_ctimer_index(CTIMER_Type *base)
+{
+    assert(base >= sim_ctimer_regs && base < sim_ctimer_regs + SIM_CTIMER_CNT);
+    return (uint8_t)(base - sim_ctimer_regs);
+}
+
+/*开始以来的计数*/
+static uint64_t sim_ctimer_count(sim_ctimer_t *timer,uint64_t now)
+{
+    uint64_t freq = CLOCK_GetFreq(kCLOCK_BusClk) / (timer->prescale + 1);
+
+    return (now - timer->start) * freq / 1000000U;
+}
+
+CTIMER_Type *sim_ctimer(uint8_t index)
+{
+    sim_ctimer_t *timer = &sim_ctimer_state[index];
+    uint64_t count;
+
+    if (timer->running) {
+        count = timer->start_tc + sim_ctimer_count(timer,sim_time_us());
+        /*匹配复位计数器时计数值在0到匹配值之间*/
+        for (uint8_t i = 0;i < SIM_CTIMER_MATCH_CNT;i ++) {
+            if (timer->match_enable[i] && timer->match[i].enableCounterReset) {
+                count %= (uint64_t)timer->match[i].matchValue + 1;
+            }
+        }
+        sim_ctimer_regs[index].TC = (uint32_t)count;
+    }
+    return &sim_ctimer_regs[index];
+}
+
+void CTIMER_GetDefaultConfig(ctimer_config_t *config)
+{
+    config->mode = kCTIMER_TimerMode;
+    config->input = kCTIMER_Capture_0;
+    config->prescale = 0;
+}
+
+void CTIMER_Init(CTIMER_Type *base,const ctimer_config_t *config)
+{
+    sim_ctimer_t *timer = &sim_ctimer_state[sim_ctimer_index(base)];
+
+    memset(timer,0,sizeof(*timer));
+    timer->prescale = config->prescale;
+    base->TC = 0;
+}
+
+void CTIMER_Deinit(CTIMER_Type *base)
+{
+    CTIMER_StopTimer(base);
+}
+
+void CTIMER_SetupMatch(CTIMER_Type *base,ctimer_match_t matchChannel,const ctimer_match_config_t *config)
+{
+    sim_ctimer_t *timer = &sim_ctimer_state[sim_ctimer_index(base)];
+
+    timer->match[matchChannel] = *config;
+    timer->match_enable[matchChannel] = true;
+    timer->match_out[matchChannel] = config->outPinInitState;
+    timer->match_cnt[matchChannel] = 0;
+}
+
+void CTIMER_StartTimer(CTIMER_Type *base)
+{
+    sim_ctimer_t *timer = &sim_ctimer_state[sim_ctimer_index(base)];
+
+    if (timer->running == false) {
+        timer->start = sim_time_us();
+        timer->start_tc = base->TC;
+        for (uint8_t i = 0;i < SIM_CTIMER_MATCH_CNT;i ++) {
+            timer->match_cnt[i] = 0;
+        }
+        timer->running = true;
+    }
+}
+
+void CTIMER_StopTimer(CTIMER_Type *base)
+{
+    uint8_t index = sim_ctimer_index(base);
+
+    sim_ctimer(index);
+    sim_ctimer_state[index].running = false;
+}
+
+void CTIMER_Reset(CTIMER_Type *base)
+{
+    sim_ctimer_t *timer = &sim_ctimer_state[sim_ctimer_index(base)];
+
+    base->TC = 0;
+    timer->start = sim_time_us();
+    timer->start_tc = 0;
+    for (uint8_t i = 0;i < SIM_CTIMER_MATCH_CNT;i ++) {
+        timer->match_cnt[i] = 0;
+    }
+}
+
+/*
+* @brief 匹配输出
+* @param 无
+* @return 无
+* @note 复位计数器的匹配按经过的周期数翻转输出,CTIMER0匹配3的上升沿触发ADC
+*/
+void sim_ctimer_tick(void)
+{
+    uint64_t now = sim_time_us();
+    uint64_t cnt,edges;
+    sim_ctimer_t *timer;
+
+    for (uint8_t index = 0;index < SIM_CTIMER_CNT;index ++) {
+        timer = &sim_ctimer_state[index];
+        if (timer->running == false) {
+            continue;
+        }
+        for (uint8_t i = 0;i < SIM_CTIMER_MATCH_CNT;i ++) {
+            if (timer->match_enable[i] == false || timer->match[i].enableCounterReset == false) {
+                continue;
+            }
+            cnt = sim_ctimer_count(timer,now) / ((uint64_t)timer->match[i].matchValue + 1);
+            edges = cnt - timer->match_cnt[i];
+            if (edges > SIM_CTIMER_EDGE_MAX) {
+                edges = SIM_CTIMER_EDGE_MAX;
+            }
+            timer->match_cnt[i] = cnt;
+            while (edges -- > 0) {
+                if (timer->match[i].outControl == kCTIMER_Output_Toggle) {
+                    timer->match_out[i] = !timer->match_out[i];
+                } else if (timer->match[i].outControl == kCTIMER_Output_Set) {
+                    timer->match_out[i] = true;
+                } else if (timer->match[i].outControl == kCTIMER_Output_Clear) {
+                    timer->match_out[i] = false;
+                } else {
+                    continue;
+                }
+                if (index == 0 && i == kCTIMER_Match_3 && timer->match_out[i]) {
+                    sim_adc_trigger(SIM_CTIMER0_MAT3_ADC_TRIGGER);
+                }
+            }
+        }
+    }
+}
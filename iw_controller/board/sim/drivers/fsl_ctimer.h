@@ -0,0 +1,115 @@
+/*****************************************************************************
+*  linux simulation board
+*  Copyright (C) 2019 wkxboot 1131204425@qq.com.
+*
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License version 3 as
+*  published by the Free Software Foundation.
+*
+*  @file     fsl_ctimer.h
+*  @brief    simulated lpc54606 sdk: standard counter/timers
+*  @author   wkxboot
+*  @email    1131204425@qq.com
+*  @version  v1.0.0
+*  @date     2019/1/10
+*  @license  GNU General Public License (GPL)
+*
+*
+*****************************************************************************/
+#ifndef  __SIM_FSL_CTIMER_H__
+#define  __SIM_FSL_CTIMER_H__
+
+#include "fsl_common.h"
+
+#ifdef  __cplusplus
+    extern "C" {
+#endif
+
+#define  SIM_CTIMER_CNT                  5
+#define  SIM_CTIMER_MATCH_CNT            4
+
+typedef enum _ctimer_timer_mode
+{
+    kCTIMER_TimerMode = 0U,
+    kCTIMER_IncreaseOnRiseEdge,
+    kCTIMER_IncreaseOnFallEdge,
+    kCTIMER_IncreaseOnBothEdge,
+}ctimer_timer_mode_t;
+
+typedef enum _ctimer_capture_channel
+{
+    kCTIMER_Capture_0 = 0U,
+    kCTIMER_Capture_1,
+    kCTIMER_Capture_2,
+    kCTIMER_Capture_3,
+}ctimer_capture_channel_t;
+
+typedef struct _ctimer_config
+{
+    ctimer_timer_mode_t mode;
+    ctimer_capture_channel_t input;
+    uint32_t prescale;
+}ctimer_config_t;
+
+typedef enum _ctimer_match
+{
+    kCTIMER_Match_0 = 0U,
+    kCTIMER_Match_1,
+    kCTIMER_Match_2,
+    kCTIMER_Match_3,
+}ctimer_match_t;
+
+typedef enum _ctimer_match_output_control
+{
+    kCTIMER_Output_NoAction = 0U,
+    kCTIMER_Output_Clear,
+    kCTIMER_Output_Set,
+    kCTIMER_Output_Toggle,
+}ctimer_match_output_control_t;
+
+typedef struct _ctimer_match_config
+{
+    uint32_t matchValue;
+    bool enableCounterReset;
+    bool enableCounterStop;
+    ctimer_match_output_control_t outControl;
+    bool outPinInitState;
+    bool enableInterrupt;
+}ctimer_match_config_t;
+
+typedef struct
+{
+    __IO uint32_t TC;
+}CTIMER_Type;
+
+/*
+* @brief 定时器实例,按单调时钟更新计数值后返回
+* @param index 实例号
+* @return 寄存器
+* @note 计数频率为总线时钟/(prescale + 1)
+*/
+CTIMER_Type *sim_ctimer(uint8_t index);
+
+#define  CTIMER0                         (sim_ctimer(0))
+#define  CTIMER1                         (sim_ctimer(1))
+#define  CTIMER2                         (sim_ctimer(2))
+#define  CTIMER3                         (sim_ctimer(3))
+#define  CTIMER4                         (sim_ctimer(4))
+
+/*CTIMER0匹配3输出连接的ADC硬件触发输入号*/
+#define  SIM_CTIMER0_MAT3_ADC_TRIGGER    4
+
+void CTIMER_GetDefaultConfig(ctimer_config_t *config);
+void CTIMER_Init(CTIMER_Type *base,const ctimer_config_t *config);
+void CTIMER_Deinit(CTIMER_Type *base);
+void CTIMER_SetupMatch(CTIMER_Type *base,ctimer_match_t matchChannel,const ctimer_match_config_t *config);
+void CTIMER_StartTimer(CTIMER_Type *base);
+void CTIMER_StopTimer(CTIMER_Type *base);
+void CTIMER_Reset(CTIMER_Type *base);
+
+#ifdef  __cplusplus
+    }
+#endif
+
+#endif
@@ -0,0 +1,258 @@
+/*****************************************************************************
+*  linux simulation board
+*  Copyright (C) 2019 wkxboot 1131204425@qq.com.
+*
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License version 3 as
+*  published by the Free Software Foundation.
+*
+*  @file     fsl_dma.c
+*  @brief    simulated lpc54606 sdk: dma
+*  @author   wkxboot
+*  @email    1131204425@qq.com
+*  @version  v1.0.0
+*  @date     2019/1/10
+*  @license  GNU General Public License (GPL)
+*
+*
+*****************************************************************************/
+#include "fsl_dma.h"
+#include "sim.h"
+
+
+/*XFERCFG寄存器位域*/
+#define  SIM_DMA_CFGVALID                (1U << 0)
+#define  SIM_DMA_RELOAD                  (1U << 1)
+#define  SIM_DMA_SWTRIG                  (1U << 2)
+#define  SIM_DMA_CLRTRIG                 (1U << 3)
+#define  SIM_DMA_SETINTA                 (1U << 4)
+#define  SIM_DMA_SETINTB                 (1U << 5)
+#define  SIM_DMA_WIDTH(x)                (((x) >> 8) & 0x3U)
+#define  SIM_DMA_SRCINC(x)               (((x) >> 12) & 0x3U)
+#define  SIM_DMA_DSTINC(x)               (((x) >> 14) & 0x3U)
+#define  SIM_DMA_XFERCOUNT(x)            ((((x) >> 16) & 0x3FFU) + 1U)
+
+typedef struct
+{
+    bool           enabled;
+    bool           hw_trigger;
+    volatile bool  active;
+    uint32_t       xfercfg;
+    uint8_t       *src;            /*第一个单元的地址*/
+    uint8_t       *dst;
+    uint32_t       index;          /*已经搬运的单元数*/
+    dma_descriptor_t *next;
+    volatile uint32_t inta;
+    dma_handle_t  *handle;
+}sim_dma_channel_t;
+
+DMA_Type sim_dma;
+
+static sim_dma_channel_t sim_dma_channel[SIM_DMA_CHANNEL_CNT];
+
+void DMA_Init(DMA_Type *base)
+{
+    (void)base;
+    memset(sim_dma_channel,0,sizeof(sim_dma_channel));
+    NVIC_EnableIRQ(DMA0_IRQn);
+}
+
+void DMA_Deinit(DMA_Type *base)
+{
+    (void)base;
+    NVIC_DisableIRQ(DMA0_IRQn);
+}
+
+void DMA_EnableChannel(DMA_Type *base,uint32_t channel)
+{
+    (void)base;
+    sim_dma_channel[channel].enabled = true;
+}
+
+void DMA_DisableChannel(DMA_Type *base,uint32_t channel)
+{
+    (void)base;
+    sim_dma_channel[channel].enabled = false;
+}
+
+void DMA_ConfigureChannelTrigger(DMA_Type *base,uint32_t channel,dma_channel_trigger_t *trigger)
+{
+    (void)base;
+    sim_dma_channel[channel].hw_trigger = trigger != NULL && trigger->type != kDMA_NoTrigger;
+}
+
+void DMA_CreateHandle(dma_handle_t *handle,DMA_Type *base,uint32_t channel)
+{
+    memset(handle,0,sizeof(*handle));
+    handle->base = base;
+    handle->channel = (uint8_t)channel;
+    sim_dma_channel[channel].handle = handle;
+}
+
+void DMA_SetCallback(dma_handle_t *handle,dma_callback callback,void *userData)
+{
+    handle->callback = callback;
+    handle->userData = userData;
+}
+
+void DMA_PrepareTransfer(dma_transfer_config_t *config,void *srcAddr,void *dstAddr,uint32_t byteWidth,uint32_t transferBytes,dma_transfer_type_t type,void *nextDesc)
+{
+    memset(config,0,sizeof(*config));
+    config->srcAddr = (uint8_t *)srcAddr;
+    config->dstAddr = (uint8_t *)dstAddr;
+    config->nextDesc = (uint8_t *)nextDesc;
+    config->xfercfg.valid = true;
+    config->xfercfg.reload = nextDesc != NULL;
+    config->xfercfg.intA = true;
+    config->xfercfg.byteWidth = (uint8_t)byteWidth;
+    config->xfercfg.transferCount = (uint16_t)(transferBytes / byteWidth);
+    config->xfercfg.srcInc = 1;
+    config->xfercfg.dstInc = 1;
+    switch (type) {
+    case kDMA_MemoryToMemory:
+        config->xfercfg.swtrig = true;
+        break;
+    case kDMA_PeripheralToMemory:
+        config->isPeriph = true;
+        config->xfercfg.srcInc = 0;
+        break;
+    case kDMA_MemoryToPeripheral:
+        config->isPeriph = true;
+        config->xfercfg.dstInc = 0;
+        break;
+    default:
+        config->xfercfg.srcInc = 0;
+        config->xfercfg.dstInc = 0;
+        break;
+    }
+}
+
+static uint32_t sim_dma_encode(const dma_xfercfg_t *xfercfg)
+{
+    uint32_t cfg = 0;
+    uint32_t width = xfercfg->byteWidth == 4 ? 2 : xfercfg->byteWidth == 2 ? 1 : 0;
+
+    cfg |= xfercfg->valid ? SIM_DMA_CFGVALID : 0;
+    cfg |= xfercfg->reload ? SIM_DMA_RELOAD : 0;
+    cfg |= xfercfg->swtrig ? SIM_DMA_SWTRIG : 0;
+    cfg |= xfercfg->clrtrig ? SIM_DMA_CLRTRIG : 0;
+    cfg |= xfercfg->intA ? SIM_DMA_SETINTA : 0;
+    cfg |= xfercfg->intB ? SIM_DMA_SETINTB : 0;
+    cfg |= width << 8;
+    cfg |= (uint32_t)(xfercfg->srcInc & 0x3U) << 12;
+    cfg |= (uint32_t)(xfercfg->dstInc & 0x3U) << 14;
+    cfg |= (uint32_t)((xfercfg->transferCount - 1U) & 0x3FFU) << 16;
+    return cfg;
+}
+
+/*硬件描述符保存的是最后一个单元的地址*/
+static void *sim_dma_end_addr(void *addr,uint32_t cfg,uint32_t inc)
+{
+    return (uint8_t *)addr + (SIM_DMA_XFERCOUNT(cfg) - 1U) * (1U << SIM_DMA_WIDTH(cfg)) * inc;
+}
+
+static uint8_t *sim_dma_start_addr(void *end,uint32_t cfg,uint32_t inc)
+{
+    return (uint8_t *)end - (SIM_DMA_XFERCOUNT(cfg) - 1U) * (1U << SIM_DMA_WIDTH(cfg)) * inc;
+}
+
+void DMA_CreateDescriptor(dma_descriptor_t *desc,dma_xfercfg_t *xfercfg,void *srcAddr,void *dstAddr,void *nextDesc)
+{
+    desc->xfercfg = sim_dma_encode(xfercfg);
+    desc->srcEndAddr = sim_dma_end_addr(srcAddr,desc->xfercfg,xfercfg->srcInc);
+    desc->dstEndAddr = sim_dma_end_addr(dstAddr,desc->xfercfg,xfercfg->dstInc);
+    desc->linkToNextDesc = nextDesc;
+}
+
+static void sim_dma_load(sim_dma_channel_t *channel,const dma_descriptor_t *desc)
+{
+    channel->xfercfg = desc->xfercfg;
+    channel->src = sim_dma_start_addr(desc->srcEndAddr,desc->xfercfg,SIM_DMA_SRCINC(desc->xfercfg));
+    channel->dst = sim_dma_start_addr(desc->dstEndAddr,desc->xfercfg,SIM_DMA_DSTINC(desc->xfercfg));
+    channel->next = (dma_descriptor_t *)desc->linkToNextDesc;
+    channel->index = 0;
+}
+
+status_t DMA_SubmitTransfer(dma_handle_t *handle,dma_transfer_config_t *config)
+{
+    sim_dma_channel_t *channel = &sim_dma_channel[handle->channel];
+    dma_descriptor_t desc;
+
+    if (channel->active) {
+        return kStatus_DMA_Busy;
+    }
+    DMA_CreateDescriptor(&desc,&config->xfercfg,config->srcAddr,config->dstAddr,config->nextDesc);
+    sim_dma_load(channel,&desc);
+    return kStatus_Success;
+}
+
+void DMA_StartTransfer(dma_handle_t *handle)
+{
+    sim_dma_channel_t *channel = &sim_dma_channel[handle->channel];
+
+    channel->active = true;
+    /*软件触发的存储器传输立即完成*/
+    while (channel->active && (channel->xfercfg & SIM_DMA_SWTRIG) && channel->hw_trigger == false) {
+        sim_dma_request(handle->channel);
+    }
+}
+
+void DMA_AbortTransfer(dma_handle_t *handle)
+{
+    sim_dma_channel_t *channel = &sim_dma_channel[handle->channel];
+
+    channel->active = false;
+    channel->inta = 0;
+}
+
+/*
+* @brief 通道的一次DMA请求,搬运一个单元
+* @param channel 通道
+* @return 无
+* @note 描述符完成后置位INTA,RELOAD时装入下一个描述符
+*/
+void sim_dma_request(uint8_t index)
+{
+    sim_dma_channel_t *channel = &sim_dma_channel[index];
+    uint32_t width,cfg;
+
+    if (index >= SIM_DMA_CHANNEL_CNT || channel->enabled == false || channel->active == false) {
+        return;
+    }
+    cfg = channel->xfercfg;
+    if ((cfg & SIM_DMA_CFGVALID) == 0) {
+        return;
+    }
+    width = 1U << SIM_DMA_WIDTH(cfg);
+    memcpy(channel->dst + channel->index * width * SIM_DMA_DSTINC(cfg),
+           channel->src + channel->index * width * SIM_DMA_SRCINC(cfg),width);
+    if (++channel->index < SIM_DMA_XFERCOUNT(cfg)) {
+        return;
+    }
+    if (cfg & SIM_DMA_SETINTA) {
+        channel->inta = 1;
+        NVIC_SetPendingIRQ(DMA0_IRQn);
+    }
+    if ((cfg & SIM_DMA_RELOAD) && channel->next != NULL) {
+        sim_dma_load(channel,channel->next);
+    } else {
+        channel->active = false;
+    }
+}
+
+void DMA0_IRQHandler(void)
+{
+    dma_handle_t *handle;
+
+    for (uint8_t i = 0;i < SIM_DMA_CHANNEL_CNT;i ++) {
+        if (sim_dma_channel[i].inta == 0) {
+            continue;
+        }
+        sim_dma_channel[i].inta = 0;
+        handle = sim_dma_channel[i].handle;
+        if (handle != NULL && handle->callback != NULL) {
+            handle->callback(handle,handle->userData,true,kDMA_IntA);
+        }
+    }
+}
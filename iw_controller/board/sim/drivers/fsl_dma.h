@@ -0,0 +1,155 @@
+/*****************************************************************************
+*  linux simulation board
+*  Copyright (C) 2019 wkxboot 1131204425@qq.com.
+*
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License version 3 as
+*  published by the Free Software Foundation.
+*
+*  @file     fsl_dma.h
+*  @brief    simulated lpc54606 sdk: dma
+*  @author   wkxboot
+*  @email    1131204425@qq.com
+*  @version  v1.0.0
+*  @date     2019/1/10
+*  @license  GNU General Public License (GPL)
+*
+*
+*****************************************************************************/
+#ifndef  __SIM_FSL_DMA_H__
+#define  __SIM_FSL_DMA_H__
+
+#include "fsl_common.h"
+
+#ifdef  __cplusplus
+    extern "C" {
+#endif
+
+#define  SIM_DMA_CHANNEL_CNT             20
+
+enum _dma_transfer_status
+{
+    kStatus_DMA_Busy = 5000,
+};
+
+typedef struct _dma_descriptor
+{
+    uint32_t xfercfg;
+    void *srcEndAddr;
+    void *dstEndAddr;
+    void *linkToNextDesc;
+}dma_descriptor_t;
+
+typedef struct _dma_xfercfg
+{
+    bool valid;
+    bool reload;
+    bool swtrig;
+    bool clrtrig;
+    bool intA;
+    bool intB;
+    uint8_t byteWidth;
+    uint8_t srcInc;
+    uint8_t dstInc;
+    uint16_t transferCount;
+}dma_xfercfg_t;
+
+typedef enum _dma_transfer_type
+{
+    kDMA_MemoryToMemory = 0x0U,
+    kDMA_PeripheralToMemory,
+    kDMA_MemoryToPeripheral,
+    kDMA_StaticToStatic,
+}dma_transfer_type_t;
+
+typedef struct _dma_transfer_config
+{
+    uint8_t *srcAddr;
+    uint8_t *dstAddr;
+    uint8_t *nextDesc;
+    dma_xfercfg_t xfercfg;
+    bool isPeriph;
+}dma_transfer_config_t;
+
+typedef enum _dma_trigger_type
+{
+    kDMA_NoTrigger = 0U,
+    kDMA_LowLevelTrigger,
+    kDMA_HighLevelTrigger,
+    kDMA_FallingEdgeTrigger,
+    kDMA_RisingEdgeTrigger,
+}dma_trigger_type_t;
+
+typedef enum _dma_trigger_burst
+{
+    kDMA_SingleTransfer = 0U,
+    kDMA_LevelBurstTransfer,
+    kDMA_EdgeBurstTransfer1,
+    kDMA_EdgeBurstTransfer2,
+    kDMA_EdgeBurstTransfer4,
+}dma_trigger_burst_t;
+
+typedef enum _dma_burst_wrap
+{
+    kDMA_NoWrap = 0U,
+    kDMA_SrcWrap,
+    kDMA_DstWrap,
+    kDMA_SrcAndDstWrap,
+}dma_burst_wrap_t;
+
+typedef struct _dma_channel_trigger
+{
+    dma_trigger_type_t type;
+    dma_trigger_burst_t burst;
+    dma_burst_wrap_t wrap;
+}dma_channel_trigger_t;
+
+enum _dma_int
+{
+    kDMA_IntA,
+    kDMA_IntB,
+    kDMA_IntError,
+};
+
+typedef struct
+{
+    uint32_t reserved;
+}DMA_Type;
+
+extern DMA_Type sim_dma;
+#define  DMA0                            (&sim_dma)
+
+struct _dma_handle;
+typedef void (*dma_callback)(struct _dma_handle *handle,void *userData,bool transferDone,uint32_t intmode);
+
+typedef struct _dma_handle
+{
+    dma_callback callback;
+    void *userData;
+    DMA_Type *base;
+    uint8_t channel;
+}dma_handle_t;
+
+/*
+* 描述符的XFERCFG和结束地址与硬件格式一致.硬件触发的通道在每个DMA请求
+* 搬运一个单元,描述符完成后挂起DMA0中断,RELOAD时装入链接的描述符.
+*/
+void DMA_Init(DMA_Type *base);
+void DMA_Deinit(DMA_Type *base);
+void DMA_EnableChannel(DMA_Type *base,uint32_t channel);
+void DMA_DisableChannel(DMA_Type *base,uint32_t channel);
+void DMA_ConfigureChannelTrigger(DMA_Type *base,uint32_t channel,dma_channel_trigger_t *trigger);
+void DMA_CreateHandle(dma_handle_t *handle,DMA_Type *base,uint32_t channel);
+void DMA_SetCallback(dma_handle_t *handle,dma_callback callback,void *userData);
+void DMA_PrepareTransfer(dma_transfer_config_t *config,void *srcAddr,void *dstAddr,uint32_t byteWidth,uint32_t transferBytes,dma_transfer_type_t type,void *nextDesc);
+void DMA_CreateDescriptor(dma_descriptor_t *desc,dma_xfercfg_t *xfercfg,void *srcAddr,void *dstAddr,void *nextDesc);
+status_t DMA_SubmitTransfer(dma_handle_t *handle,dma_transfer_config_t *config);
+void DMA_StartTransfer(dma_handle_t *handle);
+void DMA_AbortTransfer(dma_handle_t *handle);
+
+#ifdef  __cplusplus
+    }
+#endif
+
+#endif
@@ -0,0 +1,130 @@
+/*****************************************************************************
+*  linux simulation board
+*  Copyright (C) 2019 wkxboot 1131204425@qq.com.
+*
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License version 3 as
+*  published by the Free Software Foundation.
+*
+*  @file     fsl_eeprom.c
+*  @brief    simulated lpc54606 sdk: eeprom
+*  @author   wkxboot
+*  @email    1131204425@qq.com
+*  @version  v1.0.0
+*  @date     2019/1/10
+*  @license  GNU General Public License (GPL)
+*
+*
+*****************************************************************************/
+#include <unistd.h>
+#include "fsl_eeprom.h"
+#include "sim.h"
+
+#define  SIM_EEPROM_PAGE_SIZE          (FSL_FEATURE_EEPROM_SIZE / FSL_FEATURE_EEPROM_PAGE_COUNT)
+
+EEPROM_Type sim_eeprom;
+
+static uint8_t *sim_eeprom_mem;
+/*CMD启动的编程开始时间 0:没有在编程*/
+static uint64_t sim_eeprom_program_start;
+
+uintptr_t sim_eeprom_addr(uint32_t addr)
+{
+    if (sim_eeprom_mem == NULL) {
+        sim_eeprom_mem = sim_map("eeprom.bin",FSL_FEATURE_EEPROM_SIZE,0xFF);
+    }
+    assert(addr >= FSL_FEATURE_EEPROM_BASE_ADDRESS && addr <= FSL_FEATURE_EEPROM_BASE_ADDRESS + FSL_FEATURE_EEPROM_SIZE);
+    return (uintptr_t)(sim_eeprom_mem + (addr - FSL_FEATURE_EEPROM_BASE_ADDRESS));
+}
+
+void EEPROM_GetDefaultConfig(eeprom_config_t *config)
+{
+    config->autoProgram = kEEPROM_AutoProgramWriteWord;
+    config->readWaitPhase1 = 0x5U;
+    config->readWaitPhase2 = 0x9U;
+    config->writeWaitPhase1 = 0x5U;
+    config->writeWaitPhase2 = 0x9U;
+    config->writeWaitPhase3 = 0x3U;
+    config->lockTimingParam = false;
+}
+
+void EEPROM_Init(EEPROM_Type *base,const eeprom_config_t *config,uint32_t sourceClock_Hz)
+{
+    (void)config;
+    (void)sourceClock_Hz;
+    base->CMD = 0;
+    base->INTEN = 0;
+    base->INTSTAT = 0;
+    sim_eeprom_addr(FSL_FEATURE_EEPROM_BASE_ADDRESS);
+}
+
+status_t EEPROM_Write(EEPROM_Type *base,uint32_t offset,void *data,uint32_t size)
+{
+    (void)base;
+    if (offset + size > FSL_FEATURE_EEPROM_SIZE) {
+        return kStatus_InvalidArgument;
+    }
+    memcpy((void *)sim_eeprom_addr(FSL_FEATURE_EEPROM_BASE_ADDRESS + offset),data,size);
+    /*SDK逐页编程并等待每页完成*/
+    if (size > 0) {
+        usleep(SIM_EEPROM_PAGE_PROGRAM_US * ((offset + size - 1) / SIM_EEPROM_PAGE_SIZE - offset / SIM_EEPROM_PAGE_SIZE + 1));
+    }
+    return kStatus_Success;
+}
+
+void EEPROM_EnableInterrupt(EEPROM_Type *base,uint32_t mask)
+{
+    base->INTEN |= mask;
+}
+
+void EEPROM_DisableInterrupt(EEPROM_Type *base,uint32_t mask)
+{
+    base->INTEN &= ~mask;
+}
+
+/*
+* @brief 完成写CMD启动的编程
+* @param 无
+* @return 无
+* @note 页寄存器的数据已经在存储区中;第一次看到CMD时开始计时,页编程时间后置位完成标志
+*/
+static void sim_eeprom_program(void)
+{
+    uint64_t now;
+
+    if (sim_eeprom.CMD != FSL_FEATURE_EEPROM_PROGRAM_CMD) {
+        sim_eeprom_program_start = 0;
+        return;
+    }
+    now = sim_time_us();
+    if (sim_eeprom_program_start == 0) {
+        sim_eeprom_program_start = now;
+    }
+    if (now - sim_eeprom_program_start < SIM_EEPROM_PAGE_PROGRAM_US) {
+        return;
+    }
+    sim_eeprom_program_start = 0;
+    sim_eeprom.CMD = 0;
+    sim_eeprom.INTSTAT |= kEEPROM_ProgramFinishInterruptEnable;
+    if (sim_eeprom.INTEN & kEEPROM_ProgramFinishInterruptEnable) {
+        NVIC_SetPendingIRQ(EEPROM_IRQn);
+    }
+}
+
+uint32_t EEPROM_GetInterruptStatus(EEPROM_Type *base)
+{
+    /*调度器启动之前没有节拍,轮询时完成编程*/
+    sim_eeprom_program();
+    return base->INTSTAT;
+}
+
+void EEPROM_ClearInterruptFlag(EEPROM_Type *base,uint32_t mask)
+{
+    base->INTSTAT &= ~mask;
+}
+
+void sim_eeprom_tick(void)
+{
+    sim_eeprom_program();
+}
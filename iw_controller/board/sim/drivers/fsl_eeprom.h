@@ -0,0 +1,91 @@
+/*****************************************************************************
+*  linux simulation board
+*  Copyright (C) 2019 wkxboot 1131204425@qq.com.
+*
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License version 3 as
+*  published by the Free Software Foundation.
+*
+*  @file     fsl_eeprom.h
+*  @brief    simulated lpc54606 sdk: eeprom
+*  @author   wkxboot
+*  @email    1131204425@qq.com
+*  @version  v1.0.0
+*  @date     2019/1/10
+*  @license  GNU General Public License (GPL)
+*
+*
+*****************************************************************************/
+#ifndef  __SIM_FSL_EEPROM_H__
+#define  __SIM_FSL_EEPROM_H__
+
+#include "fsl_common.h"
+
+#ifdef  __cplusplus
+    extern "C" {
+#endif
+
+typedef enum _eeprom_auto_program
+{
+    kEEPROM_AutoProgramDisable = 0U,
+    kEEPROM_AutoProgramWriteWord,
+    kEEPROM_AutoProgramLastWord,
+}eeprom_auto_program_t;
+
+typedef struct _eeprom_config
+{
+    eeprom_auto_program_t autoProgram;
+    uint8_t readWaitPhase1;
+    uint8_t readWaitPhase2;
+    uint8_t writeWaitPhase1;
+    uint8_t writeWaitPhase2;
+    uint8_t writeWaitPhase3;
+    bool lockTimingParam;
+}eeprom_config_t;
+
+enum _eeprom_interrupt_enable
+{
+    kEEPROM_ProgramFinishInterruptEnable = 1U << 2,
+};
+
+typedef struct
+{
+    __IO uint32_t CMD;
+    __IO uint32_t INTEN;
+    __IO uint32_t INTSTAT;
+}EEPROM_Type;
+
+extern EEPROM_Type sim_eeprom;
+#define  EEPROM                          (&sim_eeprom)
+
+/********************    配置开始    **************************************/
+#define  SIM_EEPROM_PAGE_PROGRAM_US    3000 /*仿真的页编程时间 单位:us,用于对比同步和异步编程的阻塞时间*/
+/********************    配置结束    **************************************/
+
+/*
+* 存储区是状态目录中的eeprom.bin,写入FSL_FEATURE_EEPROM_BASE_ADDRESS窗口
+* 的数据直接进入文件.EEPROM_Write每页等待SIM_EEPROM_PAGE_PROGRAM_US;写CMD
+* 启动的编程在节拍或者读取中断状态时计时,页编程时间后完成.
+*/
+void EEPROM_GetDefaultConfig(eeprom_config_t *config);
+void EEPROM_Init(EEPROM_Type *base,const eeprom_config_t *config,uint32_t sourceClock_Hz);
+status_t EEPROM_Write(EEPROM_Type *base,uint32_t offset,void *data,uint32_t size);
+void EEPROM_EnableInterrupt(EEPROM_Type *base,uint32_t mask);
+void EEPROM_DisableInterrupt(EEPROM_Type *base,uint32_t mask);
+uint32_t EEPROM_GetInterruptStatus(EEPROM_Type *base);
+void EEPROM_ClearInterruptFlag(EEPROM_Type *base,uint32_t mask);
+
+/*
+* @brief EEPROM地址在仿真存储区中的地址
+* @param addr FSL_FEATURE_EEPROM_BASE_ADDRESS开始的地址
+* @return 主机地址
+* @note
+*/
+uintptr_t sim_eeprom_addr(uint32_t addr);
+
+#ifdef  __cplusplus
+    }
+#endif
+
+#endif
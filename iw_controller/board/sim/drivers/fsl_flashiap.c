@@ -0,0 +1,129 @@
+/*****************************************************************************
+*  linux simulation board
+*  Copyright (C) 2019 wkxboot 1131204425@qq.com.
+*
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License version 3 as
+*  published by the Free Software Foundation.
+*
+*  @file     fsl_flashiap.c
+*  @brief    simulated lpc54606 sdk: flash in-application programming
+*  @author   wkxboot
+*  @email    1131204425@qq.com
+*  @version  v1.0.0
+*  @date     2019/1/10
+*  @license  GNU General Public License (GPL)
+*
+*
+*****************************************************************************/
+#include "fsl_flashiap.h"
+#include "sim.h"
+
+
+#define  SIM_FLASH_SIZE                  FSL_FEATURE_SYSCON_FLASH_SIZE_BYTES
+#define  SIM_FLASH_PAGE_SIZE             FSL_FEATURE_SYSCON_FLASH_PAGE_SIZE_BYTES
+#define  SIM_FLASH_SECTOR_SIZE           FSL_FEATURE_SYSCON_FLASH_SECTOR_SIZE_BYTES
+#define  SIM_FLASH_SECTOR_CNT            (SIM_FLASH_SIZE / SIM_FLASH_SECTOR_SIZE)
+
+static uint8_t *sim_flash_mem;
+/*准备好的扇区,编程或者擦除后清除*/
+static uint32_t sim_flash_prepared_start;
+static uint32_t sim_flash_prepared_end;
+static bool sim_flash_prepared;
+
+uintptr_t sim_flash_addr(uint32_t addr)
+{
+    if (sim_flash_mem == NULL) {
+        sim_flash_mem = sim_map("flash.bin",SIM_FLASH_SIZE,0xFF);
+    }
+    assert(addr <= SIM_FLASH_SIZE);
+    return (uintptr_t)(sim_flash_mem + addr);
+}
+
+static bool sim_flash_is_prepared(uint32_t start_sector,uint32_t end_sector)
+{
+    bool prepared = sim_flash_prepared && start_sector >= sim_flash_prepared_start && end_sector <= sim_flash_prepared_end;
+
+    sim_flash_prepared = false;
+    return prepared;
+}
+
+status_t FLASHIAP_PrepareSectorForWrite(uint32_t startSector,uint32_t endSector)
+{
+    if (startSector > endSector || endSector >= SIM_FLASH_SECTOR_CNT) {
+        return kStatus_FLASHIAP_InvalidSector;
+    }
+    sim_flash_prepared_start = startSector;
+    sim_flash_prepared_end = endSector;
+    sim_flash_prepared = true;
+    return kStatus_FLASHIAP_Success;
+}
+
+status_t FLASHIAP_CopyRamToFlash(uint32_t dstAddr,uint32_t *srcAddr,uint32_t numOfBytes,uint32_t systemCoreClock)
+{
+    const uint8_t *src = (const uint8_t *)srcAddr;
+    uint8_t *dst;
+
+    (void)systemCoreClock;
+    if (dstAddr % SIM_FLASH_PAGE_SIZE != 0 || dstAddr >= SIM_FLASH_SIZE) {
+        return kStatus_FLASHIAP_DstAddrError;
+    }
+    if ((uintptr_t)srcAddr % 4 != 0) {
+        return kStatus_FLASHIAP_SrcAddrError;
+    }
+    if (numOfBytes == 0 || numOfBytes % SIM_FLASH_PAGE_SIZE != 0 || dstAddr + numOfBytes > SIM_FLASH_SIZE) {
+        return kStatus_FLASHIAP_CountError;
+    }
+    if (sim_flash_is_prepared(dstAddr / SIM_FLASH_SECTOR_SIZE,(dstAddr + numOfBytes - 1) / SIM_FLASH_SECTOR_SIZE) == false) {
+        return kStatus_FLASHIAP_NotPrepared;
+    }
+    /*编程只能清除位*/
+    dst = (uint8_t *)sim_flash_addr(dstAddr);
+    for (uint32_t i = 0;i < numOfBytes;i ++) {
+        dst[i] &= src[i];
+    }
+    return kStatus_FLASHIAP_Success;
+}
+
+status_t FLASHIAP_EraseSector(uint32_t startSector,uint32_t endSector,uint32_t systemCoreClock)
+{
+    (void)systemCoreClock;
+    if (startSector > endSector || endSector >= SIM_FLASH_SECTOR_CNT) {
+        return kStatus_FLASHIAP_InvalidSector;
+    }
+    if (sim_flash_is_prepared(startSector,endSector) == false) {
+        return kStatus_FLASHIAP_NotPrepared;
+    }
+    memset((void *)sim_flash_addr(startSector * SIM_FLASH_SECTOR_SIZE),0xFF,(endSector - startSector + 1) * SIM_FLASH_SECTOR_SIZE);
+    return kStatus_FLASHIAP_Success;
+}
+
+status_t FLASHIAP_ErasePage(uint32_t startPage,uint32_t endPage,uint32_t systemCoreClock)
+{
+    (void)systemCoreClock;
+    if (startPage > endPage || endPage >= SIM_FLASH_SIZE / SIM_FLASH_PAGE_SIZE) {
+        return kStatus_FLASHIAP_InvalidSector;
+    }
+    if (sim_flash_is_prepared(startPage * SIM_FLASH_PAGE_SIZE / SIM_FLASH_SECTOR_SIZE,endPage * SIM_FLASH_PAGE_SIZE / SIM_FLASH_SECTOR_SIZE) == false) {
+        return kStatus_FLASHIAP_NotPrepared;
+    }
+    memset((void *)sim_flash_addr(startPage * SIM_FLASH_PAGE_SIZE),0xFF,(endPage - startPage + 1) * SIM_FLASH_PAGE_SIZE);
+    return kStatus_FLASHIAP_Success;
+}
+
+status_t FLASHIAP_BlankCheckSector(uint32_t startSector,uint32_t endSector)
+{
+    const uint8_t *mem;
+
+    if (startSector > endSector || endSector >= SIM_FLASH_SECTOR_CNT) {
+        return kStatus_FLASHIAP_InvalidSector;
+    }
+    mem = (const uint8_t *)sim_flash_addr(startSector * SIM_FLASH_SECTOR_SIZE);
+    for (uint32_t i = 0;i < (endSector - startSector + 1) * SIM_FLASH_SECTOR_SIZE;i ++) {
+        if (mem[i] != 0xFF) {
+            return kStatus_FLASHIAP_SectorNotblank;
+        }
+    }
+    return kStatus_FLASHIAP_Success;
+}
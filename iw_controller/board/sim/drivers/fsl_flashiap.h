@@ -0,0 +1,67 @@
+/*****************************************************************************
+*  linux simulation board
+*  Copyright (C) 2019 wkxboot 1131204425@qq.com.
+*
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License version 3 as
+*  published by the Free Software Foundation.
+*
+*  @file     fsl_flashiap.h
+*  @brief    simulated lpc54606 sdk: flash in-application programming
+*  @author   wkxboot
+*  @email    1131204425@qq.com
+*  @version  v1.0.0
+*  @date     2019/1/10
+*  @license  GNU General Public License (GPL)
+*
+*
+*****************************************************************************/
+#ifndef  __SIM_FSL_FLASHIAP_H__
+#define  __SIM_FSL_FLASHIAP_H__
+
+#include "fsl_common.h"
+
+#ifdef  __cplusplus
+    extern "C" {
+#endif
+
+enum _flashiap_status
+{
+    kStatus_FLASHIAP_Success = kStatus_Success,
+    kStatus_FLASHIAP_InvalidCommand = 6001,
+    kStatus_FLASHIAP_SrcAddrError = 6002,
+    kStatus_FLASHIAP_DstAddrError = 6003,
+    kStatus_FLASHIAP_SrcAddrNotMapped = 6004,
+    kStatus_FLASHIAP_DstAddrNotMapped = 6005,
+    kStatus_FLASHIAP_CountError = 6006,
+    kStatus_FLASHIAP_InvalidSector = 6007,
+    kStatus_FLASHIAP_SectorNotblank = 6008,
+    kStatus_FLASHIAP_NotPrepared = 6009,
+    kStatus_FLASHIAP_CompareError = 6010,
+    kStatus_FLASHIAP_Busy = 6011,
+};
+
+/*
+* flash是状态目录中的flash.bin.编程只能把1写成0,擦除写0xFF,
+* 编程和擦除之前需要准备扇区,与IAP的检查一致.
+*/
+status_t FLASHIAP_PrepareSectorForWrite(uint32_t startSector,uint32_t endSector);
+status_t FLASHIAP_CopyRamToFlash(uint32_t dstAddr,uint32_t *srcAddr,uint32_t numOfBytes,uint32_t systemCoreClock);
+status_t FLASHIAP_EraseSector(uint32_t startSector,uint32_t endSector,uint32_t systemCoreClock);
+status_t FLASHIAP_ErasePage(uint32_t startPage,uint32_t endPage,uint32_t systemCoreClock);
+status_t FLASHIAP_BlankCheckSector(uint32_t startSector,uint32_t endSector);
+
+/*
+* @brief flash地址在仿真存储区中的地址
+* @param addr flash地址
+* @return 主机地址
+* @note
+*/
+uintptr_t sim_flash_addr(uint32_t addr);
+
+#ifdef  __cplusplus
+    }
+#endif
+
+#endif
@@ -0,0 +1,85 @@
+/*****************************************************************************
+*  linux simulation board
+*  Copyright (C) 2019 wkxboot 1131204425@qq.com.
+*
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License version 3 as
+*  published by the Free Software Foundation.
+*
+*  @file     fsl_gpio.c
+*  @brief    simulated lpc54606 sdk: gpio
+*  @author   wkxboot
+*  @email    1131204425@qq.com
+*  @version  v1.0.0
+*  @date     2019/1/10
+*  @license  GNU General Public License (GPL)
+*
+*
+*****************************************************************************/
+#include "fsl_gpio.h"
+#include "fsl_pint.h"
+#include "sim.h"
+
+
+GPIO_Type sim_gpio;
+
+static volatile uint8_t sim_gpio_level[SIM_GPIO_PORT_CNT][SIM_GPIO_PIN_CNT];
+static bool sim_gpio_output[SIM_GPIO_PORT_CNT][SIM_GPIO_PIN_CNT];
+
+void GPIO_PinInit(GPIO_Type *base,uint32_t port,uint32_t pin,const gpio_pin_config_t *config)
+{
+    uint32_t value;
+
+    (void)base;
+    assert(port < SIM_GPIO_PORT_CNT && pin < SIM_GPIO_PIN_CNT);
+    sim_gpio_output[port][pin] = config->pinDirection == kGPIO_DigitalOutput;
+    if (sim_gpio_output[port][pin]) {
+        sim_gpio_level[port][pin] = config->outputLogic ? 1 : 0;
+        sim_output((uint8_t)port,(uint8_t)pin,sim_gpio_level[port][pin]);
+    } else if (sim_input((uint8_t)port,(uint8_t)pin,&value) == 0) {
+        sim_gpio_level[port][pin] = value ? 1 : 0;
+    }
+}
+
+void GPIO_PinWrite(GPIO_Type *base,uint32_t port,uint32_t pin,uint8_t output)
+{
+    (void)base;
+    assert(port < SIM_GPIO_PORT_CNT && pin < SIM_GPIO_PIN_CNT);
+    if (sim_gpio_output[port][pin]) {
+        sim_gpio_level[port][pin] = output ? 1 : 0;
+        sim_output((uint8_t)port,(uint8_t)pin,sim_gpio_level[port][pin]);
+    }
+}
+
+uint32_t GPIO_PinRead(GPIO_Type *base,uint32_t port,uint32_t pin)
+{
+    (void)base;
+    assert(port < SIM_GPIO_PORT_CNT && pin < SIM_GPIO_PIN_CNT);
+    return sim_gpio_level[port][pin];
+}
+
+/*
+* @brief 更新输入引脚电平
+* @param 无
+* @return 无
+* @note 在inputs重新读取后调用,电平变化通知PINT
+*/
+void sim_gpio_tick(void)
+{
+    uint32_t value;
+    uint8_t level;
+
+    for (uint8_t port = 0;port < SIM_GPIO_PORT_CNT;port ++) {
+        for (uint8_t pin = 0;pin < SIM_GPIO_PIN_CNT;pin ++) {
+            if (sim_gpio_output[port][pin] || sim_input(port,pin,&value) != 0) {
+                continue;
+            }
+            level = value ? 1 : 0;
+            if (level != sim_gpio_level[port][pin]) {
+                sim_gpio_level[port][pin] = level;
+                sim_pint_pin_changed(port * SIM_GPIO_PIN_CNT + pin,level);
+            }
+        }
+    }
+}
@@ -0,0 +1,65 @@
+/*****************************************************************************
+*  linux simulation board
+*  Copyright (C) 2019 wkxboot 1131204425@qq.com.
+*
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License version 3 as
+*  published by the Free Software Foundation.
+*
+*  @file     fsl_gpio.h
+*  @brief    simulated lpc54606 sdk: gpio
+*  @author   wkxboot
+*  @email    1131204425@qq.com
+*  @version  v1.0.0
+*  @date     2019/1/10
+*  @license  GNU General Public License (GPL)
+*
+*
+*****************************************************************************/
+#ifndef  __SIM_FSL_GPIO_H__
+#define  __SIM_FSL_GPIO_H__
+
+#include "fsl_common.h"
+
+#ifdef  __cplusplus
+    extern "C" {
+#endif
+
+#define  SIM_GPIO_PORT_CNT               2
+#define  SIM_GPIO_PIN_CNT                32
+
+typedef enum _gpio_pin_direction
+{
+    kGPIO_DigitalInput = 0U,
+    kGPIO_DigitalOutput = 1U,
+}gpio_pin_direction_t;
+
+typedef struct _gpio_pin_config
+{
+    gpio_pin_direction_t pinDirection;
+    uint8_t outputLogic;
+}gpio_pin_config_t;
+
+/*引脚状态在仿真中,基地址只用于区分实例*/
+typedef struct
+{
+    uint32_t reserved;
+}GPIO_Type;
+
+extern GPIO_Type sim_gpio;
+#define  GPIO                            (&sim_gpio)
+
+/*
+* 输入引脚的电平来自inputs文件,见sim_input;输出引脚变化写入outputs文件.
+* 输入电平变化时通知PINT产生边沿中断.
+*/
+void GPIO_PinInit(GPIO_Type *base,uint32_t port,uint32_t pin,const gpio_pin_config_t *config);
+void GPIO_PinWrite(GPIO_Type *base,uint32_t port,uint32_t pin,uint8_t output);
+uint32_t GPIO_PinRead(GPIO_Type *base,uint32_t port,uint32_t pin);
+
+#ifdef  __cplusplus
+    }
+#endif
+
+#endif
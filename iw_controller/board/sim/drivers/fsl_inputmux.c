@@ -0,0 +1,73 @@
+/*****************************************************************************
+*  linux simulation board
+*  Copyright (C) 2019 wkxboot 1131204425@qq.com.
+*
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License version 3 as
+*  published by the Free Software Foundation.
+*
+*  @file     fsl_inputmux.c
+*  @brief    simulated lpc54606 sdk: input multiplexing
+*  @author   wkxboot
+*  @email    1131204425@qq.com
+*  @version  v1.0.0
+*  @date     2019/1/10
+*  @license  GNU General Public License (GPL)
+*
+*
+*****************************************************************************/
+#include "fsl_inputmux.h"
+#include "sim.h"
+
+
+INPUTMUX_Type sim_inputmux;
+
+static int sim_inputmux_pint[SIM_INPUTMUX_PINTSEL_CNT] = { -1,-1,-1,-1,-1,-1,-1,-1 };
+static int sim_inputmux_dma[SIM_INPUTMUX_DMA_CNT];
+static bool sim_inputmux_dma_attached[SIM_INPUTMUX_DMA_CNT];
+
+void INPUTMUX_Init(INPUTMUX_Type *base)
+{
+    (void)base;
+}
+
+void INPUTMUX_AttachSignal(INPUTMUX_Type *base,uint32_t index,inputmux_connection_t connection)
+{
+    uint32_t signal = (uint32_t)connection & SIM_INPUTMUX_SIGNAL_MASK;
+
+    (void)base;
+    if (((uint32_t)connection & ~SIM_INPUTMUX_SIGNAL_MASK) == SIM_INPUTMUX_PINTSEL) {
+        assert(index < SIM_INPUTMUX_PINTSEL_CNT);
+        sim_inputmux_pint[index] = (int)signal;
+    } else {
+        assert(index < SIM_INPUTMUX_DMA_CNT);
+        sim_inputmux_dma[index] = (int)signal;
+        sim_inputmux_dma_attached[index] = true;
+    }
+}
+
+void INPUTMUX_Deinit(INPUTMUX_Type *base)
+{
+    (void)base;
+}
+
+int sim_inputmux_pintsel(uint8_t index)
+{
+    return index < SIM_INPUTMUX_PINTSEL_CNT ? sim_inputmux_pint[index] : -1;
+}
+
+/*
+* @brief 外设DMA请求信号,转发给连接的DMA通道
+* @param signal 信号,例如SIM_INPUTMUX_DMA_ADC0_SEQA
+* @return 无
+* @note
+*/
+void sim_inputmux_dma_signal(uint32_t signal)
+{
+    for (uint8_t i = 0;i < SIM_INPUTMUX_DMA_CNT;i ++) {
+        if (sim_inputmux_dma_attached[i] && sim_inputmux_dma[i] == (int)signal) {
+            sim_dma_request(i);
+        }
+    }
+}
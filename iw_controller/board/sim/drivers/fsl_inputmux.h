@@ -0,0 +1,132 @@
+/*****************************************************************************
+*  linux simulation board
+*  Copyright (C) 2019 wkxboot 1131204425@qq.com.
+*
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License version 3 as
+*  published by the Free Software Foundation.
+*
+*  @file     fsl_inputmux.h
+*  @brief    simulated lpc54606 sdk: input multiplexing
+*  @author   wkxboot
+*  @email    1131204425@qq.com
+*  @version  v1.0.0
+*  @date     2019/1/10
+*  @license  GNU General Public License (GPL)
+*
+*
+*****************************************************************************/
+#ifndef  __SIM_FSL_INPUTMUX_H__
+#define  __SIM_FSL_INPUTMUX_H__
+
+#include "fsl_common.h"
+
+#ifdef  __cplusplus
+    extern "C" {
+#endif
+
+#define  SIM_INPUTMUX_PINTSEL_CNT        8
+#define  SIM_INPUTMUX_DMA_CNT            20
+
+/*连接编号:高8位为目标,低16位为信号*/
+#define  SIM_INPUTMUX_PINTSEL            (0x01U << 24)
+#define  SIM_INPUTMUX_DMA                (0x02U << 24)
+#define  SIM_INPUTMUX_SIGNAL_MASK        0xFFFFU
+
+#define  SIM_INPUTMUX_DMA_ADC0_SEQA      0U
+
+typedef enum _inputmux_connection_t
+{
+    kINPUTMUX_GpioPort0Pin0ToPintsel = SIM_INPUTMUX_PINTSEL | 0,
+    kINPUTMUX_GpioPort0Pin1ToPintsel = SIM_INPUTMUX_PINTSEL | 1,
+    kINPUTMUX_GpioPort0Pin2ToPintsel = SIM_INPUTMUX_PINTSEL | 2,
+    kINPUTMUX_GpioPort0Pin3ToPintsel = SIM_INPUTMUX_PINTSEL | 3,
+    kINPUTMUX_GpioPort0Pin4ToPintsel = SIM_INPUTMUX_PINTSEL | 4,
+    kINPUTMUX_GpioPort0Pin5ToPintsel = SIM_INPUTMUX_PINTSEL | 5,
+    kINPUTMUX_GpioPort0Pin6ToPintsel = SIM_INPUTMUX_PINTSEL | 6,
+    kINPUTMUX_GpioPort0Pin7ToPintsel = SIM_INPUTMUX_PINTSEL | 7,
+    kINPUTMUX_GpioPort0Pin8ToPintsel = SIM_INPUTMUX_PINTSEL | 8,
+    kINPUTMUX_GpioPort0Pin9ToPintsel = SIM_INPUTMUX_PINTSEL | 9,
+    kINPUTMUX_GpioPort0Pin10ToPintsel = SIM_INPUTMUX_PINTSEL | 10,
+    kINPUTMUX_GpioPort0Pin11ToPintsel = SIM_INPUTMUX_PINTSEL | 11,
+    kINPUTMUX_GpioPort0Pin12ToPintsel = SIM_INPUTMUX_PINTSEL | 12,
+    kINPUTMUX_GpioPort0Pin13ToPintsel = SIM_INPUTMUX_PINTSEL | 13,
+    kINPUTMUX_GpioPort0Pin14ToPintsel = SIM_INPUTMUX_PINTSEL | 14,
+    kINPUTMUX_GpioPort0Pin15ToPintsel = SIM_INPUTMUX_PINTSEL | 15,
+    kINPUTMUX_GpioPort0Pin16ToPintsel = SIM_INPUTMUX_PINTSEL | 16,
+    kINPUTMUX_GpioPort0Pin17ToPintsel = SIM_INPUTMUX_PINTSEL | 17,
+    kINPUTMUX_GpioPort0Pin18ToPintsel = SIM_INPUTMUX_PINTSEL | 18,
+    kINPUTMUX_GpioPort0Pin19ToPintsel = SIM_INPUTMUX_PINTSEL | 19,
+    kINPUTMUX_GpioPort0Pin20ToPintsel = SIM_INPUTMUX_PINTSEL | 20,
+    kINPUTMUX_GpioPort0Pin21ToPintsel = SIM_INPUTMUX_PINTSEL | 21,
+    kINPUTMUX_GpioPort0Pin22ToPintsel = SIM_INPUTMUX_PINTSEL | 22,
+    kINPUTMUX_GpioPort0Pin23ToPintsel = SIM_INPUTMUX_PINTSEL | 23,
+    kINPUTMUX_GpioPort0Pin24ToPintsel = SIM_INPUTMUX_PINTSEL | 24,
+    kINPUTMUX_GpioPort0Pin25ToPintsel = SIM_INPUTMUX_PINTSEL | 25,
+    kINPUTMUX_GpioPort0Pin26ToPintsel = SIM_INPUTMUX_PINTSEL | 26,
+    kINPUTMUX_GpioPort0Pin27ToPintsel = SIM_INPUTMUX_PINTSEL | 27,
+    kINPUTMUX_GpioPort0Pin28ToPintsel = SIM_INPUTMUX_PINTSEL | 28,
+    kINPUTMUX_GpioPort0Pin29ToPintsel = SIM_INPUTMUX_PINTSEL | 29,
+    kINPUTMUX_GpioPort0Pin30ToPintsel = SIM_INPUTMUX_PINTSEL | 30,
+    kINPUTMUX_GpioPort0Pin31ToPintsel = SIM_INPUTMUX_PINTSEL | 31,
+    kINPUTMUX_GpioPort1Pin0ToPintsel = SIM_INPUTMUX_PINTSEL | 32,
+    kINPUTMUX_GpioPort1Pin1ToPintsel = SIM_INPUTMUX_PINTSEL | 33,
+    kINPUTMUX_GpioPort1Pin2ToPintsel = SIM_INPUTMUX_PINTSEL | 34,
+    kINPUTMUX_GpioPort1Pin3ToPintsel = SIM_INPUTMUX_PINTSEL | 35,
+    kINPUTMUX_GpioPort1Pin4ToPintsel = SIM_INPUTMUX_PINTSEL | 36,
+    kINPUTMUX_GpioPort1Pin5ToPintsel = SIM_INPUTMUX_PINTSEL | 37,
+    kINPUTMUX_GpioPort1Pin6ToPintsel = SIM_INPUTMUX_PINTSEL | 38,
+    kINPUTMUX_GpioPort1Pin7ToPintsel = SIM_INPUTMUX_PINTSEL | 39,
+    kINPUTMUX_GpioPort1Pin8ToPintsel = SIM_INPUTMUX_PINTSEL | 40,
+    kINPUTMUX_GpioPort1Pin9ToPintsel = SIM_INPUTMUX_PINTSEL | 41,
+    kINPUTMUX_GpioPort1Pin10ToPintsel = SIM_INPUTMUX_PINTSEL | 42,
+    kINPUTMUX_GpioPort1Pin11ToPintsel = SIM_INPUTMUX_PINTSEL | 43,
+    kINPUTMUX_GpioPort1Pin12ToPintsel = SIM_INPUTMUX_PINTSEL | 44,
+    kINPUTMUX_GpioPort1Pin13ToPintsel = SIM_INPUTMUX_PINTSEL | 45,
+    kINPUTMUX_GpioPort1Pin14ToPintsel = SIM_INPUTMUX_PINTSEL | 46,
+    kINPUTMUX_GpioPort1Pin15ToPintsel = SIM_INPUTMUX_PINTSEL | 47,
+    kINPUTMUX_GpioPort1Pin16ToPintsel = SIM_INPUTMUX_PINTSEL | 48,
+    kINPUTMUX_GpioPort1Pin17ToPintsel = SIM_INPUTMUX_PINTSEL | 49,
+    kINPUTMUX_GpioPort1Pin18ToPintsel = SIM_INPUTMUX_PINTSEL | 50,
+    kINPUTMUX_GpioPort1Pin19ToPintsel = SIM_INPUTMUX_PINTSEL | 51,
+    kINPUTMUX_GpioPort1Pin20ToPintsel = SIM_INPUTMUX_PINTSEL | 52,
+    kINPUTMUX_GpioPort1Pin21ToPintsel = SIM_INPUTMUX_PINTSEL | 53,
+    kINPUTMUX_GpioPort1Pin22ToPintsel = SIM_INPUTMUX_PINTSEL | 54,
+    kINPUTMUX_GpioPort1Pin23ToPintsel = SIM_INPUTMUX_PINTSEL | 55,
+    kINPUTMUX_GpioPort1Pin24ToPintsel = SIM_INPUTMUX_PINTSEL | 56,
+    kINPUTMUX_GpioPort1Pin25ToPintsel = SIM_INPUTMUX_PINTSEL | 57,
+    kINPUTMUX_GpioPort1Pin26ToPintsel = SIM_INPUTMUX_PINTSEL | 58,
+    kINPUTMUX_GpioPort1Pin27ToPintsel = SIM_INPUTMUX_PINTSEL | 59,
+    kINPUTMUX_GpioPort1Pin28ToPintsel = SIM_INPUTMUX_PINTSEL | 60,
+    kINPUTMUX_GpioPort1Pin29ToPintsel = SIM_INPUTMUX_PINTSEL | 61,
+    kINPUTMUX_GpioPort1Pin30ToPintsel = SIM_INPUTMUX_PINTSEL | 62,
+    kINPUTMUX_GpioPort1Pin31ToPintsel = SIM_INPUTMUX_PINTSEL | 63,
+    kINPUTMUX_Adc0SeqaIrqToDma = SIM_INPUTMUX_DMA | SIM_INPUTMUX_DMA_ADC0_SEQA,
+}inputmux_connection_t;
+
+typedef struct
+{
+    uint32_t reserved;
+}INPUTMUX_Type;
+
+extern INPUTMUX_Type sim_inputmux;
+#define  INPUTMUX                        (&sim_inputmux)
+
+void INPUTMUX_Init(INPUTMUX_Type *base);
+void INPUTMUX_AttachSignal(INPUTMUX_Type *base,uint32_t index,inputmux_connection_t connection);
+void INPUTMUX_Deinit(INPUTMUX_Type *base);
+
+/*
+* @brief PINT通道连接的引脚
+* @param index PINT通道
+* @return -1 没有连接 其他 port * 32 + pin
+* @note
+*/
+int sim_inputmux_pintsel(uint8_t index);
+
+#ifdef  __cplusplus
+    }
+#endif
+
+#endif
@@ -0,0 +1,115 @@
+/*****************************************************************************
+*  linux simulation board
+*  Copyright (C) 2019 wkxboot 1131204425@qq.com.
+*
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License version 3 as
+*  published by the Free Software Foundation.
+*
+*  @file     fsl_pint.c
+*  @brief    simulated lpc54606 sdk: pin interrupts
+*  @author   wkxboot
+*  @email    1131204425@qq.com
+*  @version  v1.0.0
+*  @date     2019/1/10
+*  @license  GNU General Public License (GPL)
+*
+*
+*****************************************************************************/
+#include "fsl_pint.h"
+#include "fsl_inputmux.h"
+#include "sim.h"
+
+
+PINT_Type sim_pint;
+
+static pint_cb_t sim_pint_callback[SIM_PINT_CNT];
+static pint_pin_enable_t sim_pint_enable[SIM_PINT_CNT];
+static volatile uint32_t sim_pint_status[SIM_PINT_CNT];
+
+static const IRQn_Type sim_pint_irq[SIM_PINT_CNT] = {
+PIN_INT0_IRQn,PIN_INT1_IRQn,PIN_INT2_IRQn,PIN_INT3_IRQn,PIN_INT4_IRQn,PIN_INT5_IRQn,PIN_INT6_IRQn,PIN_INT7_IRQn
+};
+
+void PINT_Init(PINT_Type *base)
+{
+    (void)base;
+    for (uint8_t i = 0;i < SIM_PINT_CNT;i ++) {
+        sim_pint_enable[i] = kPINT_PinIntEnableNone;
+        sim_pint_status[i] = 0;
+    }
+}
+
+void PINT_PinInterruptConfig(PINT_Type *base,pint_pin_int_t intr,pint_pin_enable_t enable,pint_cb_t callback)
+{
+    (void)base;
+    assert(intr < SIM_PINT_CNT);
+    sim_pint_enable[intr] = enable;
+    sim_pint_callback[intr] = callback;
+}
+
+void sim_pint_pin_changed(int pin,uint8_t level)
+{
+    pint_pin_enable_t edge = level ? kPINT_PinIntEnableRiseEdge : kPINT_PinIntEnableFallEdge;
+
+    for (uint8_t i = 0;i < SIM_PINT_CNT;i ++) {
+        if (sim_inputmux_pintsel(i) != pin) {
+            continue;
+        }
+        if (sim_pint_enable[i] == edge || sim_pint_enable[i] == kPINT_PinIntEnableBothEdges) {
+            sim_pint_status[i] = 1;
+            NVIC_SetPendingIRQ(sim_pint_irq[i]);
+        }
+    }
+}
+
+static void sim_pint_irq_handler(pint_pin_int_t intr)
+{
+    uint32_t status = sim_pint_status[intr];
+
+    sim_pint_status[intr] = 0;
+    if (status != 0 && sim_pint_callback[intr] != NULL) {
+        sim_pint_callback[intr](intr,status);
+    }
+}
+
+void PIN_INT0_IRQHandler(void)
+{
+    sim_pint_irq_handler(kPINT_PinInt0);
+}
+
+void PIN_INT1_IRQHandler(void)
+{
+    sim_pint_irq_handler(kPINT_PinInt1);
+}
+
+void PIN_INT2_IRQHandler(void)
+{
+    sim_pint_irq_handler(kPINT_PinInt2);
+}
+
+void PIN_INT3_IRQHandler(void)
+{
+    sim_pint_irq_handler(kPINT_PinInt3);
+}
+
+void PIN_INT4_IRQHandler(void)
+{
+    sim_pint_irq_handler(kPINT_PinInt4);
+}
+
+void PIN_INT5_IRQHandler(void)
+{
+    sim_pint_irq_handler(kPINT_PinInt5);
+}
+
+void PIN_INT6_IRQHandler(void)
+{
+    sim_pint_irq_handler(kPINT_PinInt6);
+}
+
+void PIN_INT7_IRQHandler(void)
+{
+    sim_pint_irq_handler(kPINT_PinInt7);
+}
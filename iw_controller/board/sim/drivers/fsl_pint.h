@@ -0,0 +1,77 @@
+/*****************************************************************************
+*  linux simulation board
+*  Copyright (C) 2019 wkxboot 1131204425@qq.com.
+*
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License version 3 as
+*  published by the Free Software Foundation.
+*
+*  @file     fsl_pint.h
+*  @brief    simulated lpc54606 sdk: pin interrupts
+*  @author   wkxboot
+*  @email    1131204425@qq.com
+*  @version  v1.0.0
+*  @date     2019/1/10
+*  @license  GNU General Public License (GPL)
+*
+*
+*****************************************************************************/
+#ifndef  __SIM_FSL_PINT_H__
+#define  __SIM_FSL_PINT_H__
+
+#include "fsl_common.h"
+
+#ifdef  __cplusplus
+    extern "C" {
+#endif
+
+#define  SIM_PINT_CNT                    8
+
+typedef enum _pint_pin_enable
+{
+    kPINT_PinIntEnableNone = 0U,
+    kPINT_PinIntEnableRiseEdge,
+    kPINT_PinIntEnableFallEdge,
+    kPINT_PinIntEnableBothEdges,
+}pint_pin_enable_t;
+
+typedef enum _pint_pin_int
+{
+    kPINT_PinInt0 = 0U,
+    kPINT_PinInt1,
+    kPINT_PinInt2,
+    kPINT_PinInt3,
+    kPINT_PinInt4,
+    kPINT_PinInt5,
+    kPINT_PinInt6,
+    kPINT_PinInt7,
+}pint_pin_int_t;
+
+typedef void (*pint_cb_t)(pint_pin_int_t pintr,uint32_t pmatch_status);
+
+typedef struct
+{
+    uint32_t reserved;
+}PINT_Type;
+
+extern PINT_Type sim_pint;
+#define  PINT                            (&sim_pint)
+
+void PINT_Init(PINT_Type *base);
+void PINT_PinInterruptConfig(PINT_Type *base,pint_pin_int_t intr,pint_pin_enable_t enable,pint_cb_t callback);
+
+/*
+* @brief 引脚电平变化,连接的PINT通道按边沿配置挂起中断
+* @param pin port * 32 + pin
+* @param level 新电平
+* @return 无
+* @note 由GPIO仿真调用
+*/
+void sim_pint_pin_changed(int pin,uint8_t level);
+
+#ifdef  __cplusplus
+    }
+#endif
+
+#endif
@@ -0,0 +1,50 @@
+/*****************************************************************************
+*  linux simulation board
+*  Copyright (C) 2019 wkxboot 1131204425@qq.com.
+*
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License version 3 as
+*  published by the Free Software Foundation.
+*
+*  @file     fsl_power.h
+*  @brief    simulated lpc54606 sdk: power
+*  @author   wkxboot
+*  @email    1131204425@qq.com
+*  @version  v1.0.0
+*  @date     2019/1/10
+*  @license  GNU General Public License (GPL)
+*
+*
+*****************************************************************************/
+#ifndef  __SIM_FSL_POWER_H__
+#define  __SIM_FSL_POWER_H__
+
+#include "fsl_common.h"
+
+typedef enum pd_bits
+{
+    kPDRUNCFG_PD_FRO_EN,
+    kPDRUNCFG_PD_TS,
+    kPDRUNCFG_PD_BOD_RST,
+    kPDRUNCFG_PD_BOD_INTR,
+    kPDRUNCFG_PD_VD2_ANA,
+    kPDRUNCFG_PD_ADC0,
+    kPDRUNCFG_PD_VDDA,
+    kPDRUNCFG_PD_VREFP,
+    kPDRUNCFG_PD_WDT_OSC,
+    kPDRUNCFG_PD_EEPROM,
+}pd_bit_t;
+
+/*模拟电源总是打开*/
+static inline void POWER_DisablePD(pd_bit_t en)
+{
+    (void)en;
+}
+
+static inline void POWER_EnablePD(pd_bit_t en)
+{
+    (void)en;
+}
+
+#endif
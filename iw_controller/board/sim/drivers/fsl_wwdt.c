@@ -0,0 +1,111 @@
+/*****************************************************************************
+*  linux simulation board
+*  Copyright (C) 2019 wkxboot 1131204425@qq.com.
+*
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License version 3 as
+*  published by the Free Software Foundation.
+*
+*  @file     fsl_wwdt.c
+*  @brief    simulated lpc54606 sdk: windowed watchdog
+*  @author   wkxboot
+*  @email    1131204425@qq.com
+*  @version  v1.0.0
+*  @date     2019/1/10
+*  @license  GNU General Public License (GPL)
+*
+*
+*****************************************************************************/
+#include "fsl_wwdt.h"
+#include "sim.h"
+
+
+WWDT_Type sim_wwdt;
+
+static bool sim_wwdt_running;
+static bool sim_wwdt_reset_enable;
+static uint32_t sim_wwdt_warning_value;
+static uint32_t sim_wwdt_window_value;
+static uint32_t sim_wwdt_timeout_value;
+static uint32_t sim_wwdt_tick_cnt;     /*每个节拍的计数*/
+static volatile uint32_t sim_wwdt_flags;
+
+void WWDT_GetDefaultConfig(wwdt_config_t *config)
+{
+    config->enableWwdt = true;
+    config->enableWatchdogReset = false;
+    config->enableWatchdogProtect = false;
+    config->enableLockOscillator = false;
+    config->windowValue = 0xFFFFFFU;
+    config->timeoutValue = 0xFFFFFFU;
+    config->warningValue = 0;
+    config->clockFreq_Hz = 0;
+}
+
+void WWDT_Init(WWDT_Type *base,const wwdt_config_t *config)
+{
+    sim_wwdt_reset_enable = config->enableWatchdogReset;
+    sim_wwdt_warning_value = config->warningValue;
+    sim_wwdt_window_value = config->windowValue;
+    sim_wwdt_timeout_value = config->timeoutValue;
+    sim_wwdt_tick_cnt = config->clockFreq_Hz / 4 / 1000;
+    if (sim_wwdt_tick_cnt == 0) {
+        sim_wwdt_tick_cnt = 1;
+    }
+    base->TC = config->timeoutValue;
+    base->TV = config->timeoutValue;
+    base->WARNINT = config->warningValue;
+    base->WINDOW = config->windowValue;
+    sim_wwdt_running = config->enableWwdt;
+}
+
+void WWDT_Deinit(WWDT_Type *base)
+{
+    (void)base;
+    sim_wwdt_running = false;
+}
+
+void WWDT_Refresh(WWDT_Type *base)
+{
+    /*窗口之外喂狗立即复位*/
+    if (sim_wwdt_running && base->TV > sim_wwdt_window_value && sim_wwdt_reset_enable) {
+        sim_reset(true);
+    }
+    base->TV = sim_wwdt_timeout_value;
+}
+
+uint32_t WWDT_GetStatusFlags(WWDT_Type *base)
+{
+    (void)base;
+    return sim_wwdt_flags | (sim_reset_by_watch_dog() ? kWWDT_TimeoutFlag : 0);
+}
+
+void WWDT_ClearStatusFlags(WWDT_Type *base,uint32_t mask)
+{
+    (void)base;
+    sim_wwdt_flags &= ~mask;
+}
+
+void sim_wwdt_tick(void)
+{
+    uint32_t tv;
+
+    if (sim_wwdt_running == false) {
+        return;
+    }
+    tv = sim_wwdt.TV;
+    if (tv > sim_wwdt_warning_value && tv <= sim_wwdt_warning_value + sim_wwdt_tick_cnt) {
+        sim_wwdt_flags |= kWWDT_WarningFlag;
+        NVIC_SetPendingIRQ(WDT_BOD_IRQn);
+    }
+    tv = tv > sim_wwdt_tick_cnt ? tv - sim_wwdt_tick_cnt : 0;
+    sim_wwdt.TV = tv;
+    if (tv == 0) {
+        sim_wwdt_flags |= kWWDT_TimeoutFlag;
+        if (sim_wwdt_reset_enable) {
+            sim_reset(true);
+        }
+        sim_wwdt.TV = sim_wwdt_timeout_value;
+    }
+}
@@ -0,0 +1,74 @@
+/*****************************************************************************
+*  linux simulation board
+*  Copyright (C) 2019 wkxboot 1131204425@qq.com.
+*
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License version 3 as
+*  published by the Free Software Foundation.
+*
+*  @file     fsl_wwdt.h
+*  @brief    simulated lpc54606 sdk: windowed watchdog
+*  @author   wkxboot
+*  @email    1131204425@qq.com
+*  @version  v1.0.0
+*  @date     2019/1/10
+*  @license  GNU General Public License (GPL)
+*
+*
+*****************************************************************************/
+#ifndef  __SIM_FSL_WWDT_H__
+#define  __SIM_FSL_WWDT_H__
+
+#include "fsl_common.h"
+
+#ifdef  __cplusplus
+    extern "C" {
+#endif
+
+typedef struct _wwdt_config
+{
+    bool enableWwdt;
+    bool enableWatchdogReset;
+    bool enableWatchdogProtect;
+    bool enableLockOscillator;
+    uint32_t windowValue;
+    uint32_t timeoutValue;
+    uint32_t warningValue;
+    uint32_t clockFreq_Hz;
+}wwdt_config_t;
+
+enum _wwdt_status_flags_t
+{
+    kWWDT_TimeoutFlag = 1U << 2,
+    kWWDT_WarningFlag = 1U << 3,
+};
+
+typedef struct
+{
+    __IO uint32_t MOD;
+    __IO uint32_t TC;
+    __IO uint32_t TV;
+    __IO uint32_t WARNINT;
+    __IO uint32_t WINDOW;
+}WWDT_Type;
+
+extern WWDT_Type sim_wwdt;
+#define  WWDT                            (&sim_wwdt)
+
+/*
+* 计数器按clockFreq_Hz / 4每个节拍递减,到warningValue挂起WDT_BOD中断,
+* 到0时复位.计数值大于windowValue时喂狗也会复位.
+*/
+void WWDT_GetDefaultConfig(wwdt_config_t *config);
+void WWDT_Init(WWDT_Type *base,const wwdt_config_t *config);
+void WWDT_Deinit(WWDT_Type *base);
+void WWDT_Refresh(WWDT_Type *base);
+uint32_t WWDT_GetStatusFlags(WWDT_Type *base);
+void WWDT_ClearStatusFlags(WWDT_Type *base,uint32_t mask);
+
+#ifdef  __cplusplus
+    }
+#endif
+
+#endif
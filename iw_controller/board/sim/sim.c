@@ -0,0 +1,375 @@
+/*****************************************************************************
+*  linux simulation board
+*  Copyright (C) 2019 wkxboot 1131204425@qq.com.
+*
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License version 3 as
+*  published by the Free Software Foundation.
+*
+*  @file     sim.c
+*  @brief    linux simulation board
+*  @author   wkxboot
+*  @email    1131204425@qq.com
+*  @version  v1.0.0
+*  @date     2019/1/10
+*  @license  GNU General Public License (GPL)
+*
+*
+*****************************************************************************/
+#define  _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include "board.h"
+#include "sim.h"
+
+
+extern void SysTick_Handler(void);
+
+typedef struct
+{
+    const char *name;
+    uint8_t     port;
+    uint8_t     pin;
+    uint32_t    value;   /*没有设置时的值*/
+}sim_io_t;
+
+/*inputs文件的键,电平为引脚电平*/
+static const sim_io_t sim_inputs[] = {
+{ "door",       BOARD_INITPINS_DOOR_SENSOR_PORT,    BOARD_INITPINS_DOOR_SENSOR_PIN,    BSP_DOOR_CLOSE_LEVEL },
+{ "lock",       BOARD_INITPINS_LOCK_SENSOR_PORT,    BOARD_INITPINS_LOCK_SENSOR_PIN,    BSP_LOCK_LOCKED_LEVEL },
+{ "hole",       BOARD_INITPINS_HOLE_SENSOR_PORT,    BOARD_INITPINS_HOLE_SENSOR_PIN,    BSP_HOLE_CLOSE_LEVEL },
+{ "unlock",     BOARD_INITPINS_UNLOCK_SW_PORT,      BOARD_INITPINS_UNLOCK_SW_PIN,      BSP_UNLOCK_SW_STATUS_RELEASE_LEVEL },
+{ "unlock_main",BOARD_INITPINS_UNLOCK_SW_MAIN_PORT, BOARD_INITPINS_UNLOCK_SW_MAIN_PIN, BSP_UNLOCK_SW_STATUS_RELEASE_LEVEL },
+{ "adc3",       SIM_INPUT_ADC,                      3,                                 SIM_ADC_DEFAULT_VALUE },
+{ "adc5",       SIM_INPUT_ADC,                      5,                                 SIM_ADC_DEFAULT_VALUE },
+};
+
+#define  SIM_INPUT_CNT                   (sizeof(sim_inputs) / sizeof(sim_inputs[0]))
+
+/*outputs文件的键*/
+static const sim_io_t sim_outputs[] = {
+{ "compressor", BOARD_INITPINS_COMPRESSOR_CTRL_PORT,BOARD_INITPINS_COMPRESSOR_CTRL_PIN,0 },
+{ "lock_ctrl",  BOARD_INITPINS_LOCK_CTRL_PORT,      BOARD_INITPINS_LOCK_CTRL_PIN,      1 },
+};
+
+#define  SIM_OUTPUT_CNT                  (sizeof(sim_outputs) / sizeof(sim_outputs[0]))
+#define  SIM_SERIAL_PORT_CNT             10
+#define  SIM_SERIAL_NAME_SIZE            64
+#define  SIM_FILE_BUFFER_SIZE            1024
+
+static char sim_dir[SIM_PATH_SIZE];
+static int sim_argc;
+static char **sim_argv;
+static bool sim_last_reset_watch_dog;
+static volatile uint32_t sim_input_value[SIM_INPUT_CNT];
+static uint8_t sim_output_level[SIM_OUTPUT_CNT];
+static char sim_serial_name[SIM_SERIAL_PORT_CNT][SIM_SERIAL_NAME_SIZE];
+static void (*sim_poll[SIM_POLL_CNT_MAX])(void);
+static uint8_t sim_poll_cnt;
+
+
+/*
+* @brief 仿真启动,在main之前执行
+* @param argc 参数数量
+* @param argv 参数,复位时用于重新执行
+* @return 无
+* @note 读取并清除上次复位原因
+*/
+__attribute__((constructor)) static void sim_startup(int argc,char **argv,char **envp)
+{
+    char path[SIM_PATH_SIZE];
+    char reason[16] = { 0 };
+    const char *dir;
+    int fd;
+
+    (void)envp;
+    sim_argc = argc;
+    sim_argv = argv;
+    dir = getenv(SIM_DIR_ENV);
+    if (dir == NULL || dir[0] == 0) {
+        dir = ".";
+    }
+    strncpy(sim_dir,dir,sizeof(sim_dir) - 1);
+    mkdir(sim_dir,0755);
+
+    fd = open(sim_path("reset",path),O_RDONLY);
+    if (fd >= 0) {
+        if (read(fd,reason,sizeof(reason) - 1) > 0) {
+            sim_last_reset_watch_dog = strncmp(reason,"watch_dog",9) == 0;
+        }
+        close(fd);
+        unlink(path);
+    }
+    for (uint8_t i = 0;i < SIM_INPUT_CNT;i ++) {
+        sim_input_value[i] = sim_inputs[i].value;
+    }
+    for (uint8_t i = 0;i < SIM_OUTPUT_CNT;i ++) {
+        sim_output_level[i] = (uint8_t)sim_outputs[i].value;
+    }
+}
+
+const char *sim_path(const char *name,char *path)
+{
+    size_t len = strlen(sim_dir);
+
+    memcpy(path,sim_dir,len);
+    path[len] = '/';
+    strncpy(path + len + 1,name,SIM_PATH_SIZE - len - 2);
+    path[SIM_PATH_SIZE - 1] = 0;
+    return path;
+}
+
+uint8_t *sim_map(const char *name,uint32_t size,uint8_t fill)
+{
+    char path[SIM_PATH_SIZE];
+    uint8_t buffer[256];
+    struct stat st;
+    uint8_t *map;
+    off_t pos;
+    int fd;
+
+    fd = open(sim_path(name,path),O_RDWR | O_CREAT | O_CLOEXEC,0644);
+    if (fd < 0 || fstat(fd,&st) != 0) {
+        fprintf(stderr,"sim: open %s failed: %s\n",path,strerror(errno));
+        exit(1);
+    }
+    if (st.st_size != (off_t)size) {
+        /*新文件或者大小变化,超出的部分截掉,不足的部分填充*/
+        memset(buffer,fill,sizeof(buffer));
+        if (ftruncate(fd,st.st_size < (off_t)size ? st.st_size : (off_t)size) != 0) {
+            exit(1);
+        }
+        for (pos = st.st_size;pos < (off_t)size;pos += sizeof(buffer)) {
+            if (pwrite(fd,buffer,sizeof(buffer),pos) != sizeof(buffer)) {
+                exit(1);
+            }
+        }
+    }
+    map = mmap(NULL,size,PROT_READ | PROT_WRITE,MAP_SHARED,fd,0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr,"sim: map %s failed: %s\n",path,strerror(errno));
+        exit(1);
+    }
+    return map;
+}
+
+/*
+* @brief 写入状态目录中的文件
+* @param name 文件名
+* @param data 内容
+* @param size 长度
+* @return 无
+* @note 先写临时文件再改名,读取者不会看到一半的内容
+*/
+static void sim_write_file(const char *name,const char *data,size_t size)
+{
+    char path[SIM_PATH_SIZE],tmp[SIM_PATH_SIZE];
+    int fd;
+
+    sim_path(name,path);
+    strcpy(tmp,path);
+    strncat(tmp,".tmp",sizeof(tmp) - strlen(tmp) - 1);
+    fd = open(tmp,O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,0644);
+    if (fd < 0) {
+        return;
+    }
+    if (write(fd,data,size) == (ssize_t)size) {
+        rename(tmp,path);
+    }
+    close(fd);
+}
+
+void sim_reset(bool watch_dog)
+{
+    struct itimerval stop;
+    sigset_t set;
+
+    memset(&stop,0,sizeof(stop));
+    setitimer(ITIMER_REAL,&stop,NULL);
+    /*丢弃挂起的节拍,新程序安装处理函数之前一直忽略*/
+    signal(SIGALRM,SIG_IGN);
+    if (watch_dog) {
+        sim_write_file("reset","watch_dog\n",10);
+    } else {
+        sim_write_file("reset","software\n",9);
+    }
+    sigemptyset(&set);
+    pthread_sigmask(SIG_SETMASK,&set,NULL);
+    if (sim_argc > 0) {
+        execv("/proc/self/exe",sim_argv);
+    }
+    _exit(1);
+}
+
+bool sim_reset_by_watch_dog(void)
+{
+    return sim_last_reset_watch_dog;
+}
+
+uint64_t sim_time_us(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC,&now);
+    return (uint64_t)now.tv_sec * 1000000U + (uint64_t)now.tv_nsec / 1000U;
+}
+
+/*
+* @brief 读取inputs文件
+* @param 无
+* @return 无
+* @note 文件中没有的键恢复为默认值
+*/
+static void sim_input_load(void)
+{
+    char path[SIM_PATH_SIZE];
+    static char buffer[SIM_FILE_BUFFER_SIZE];
+    uint32_t value[SIM_INPUT_CNT];
+    char *line,*next,*eq;
+    ssize_t size;
+    int fd;
+
+    for (uint8_t i = 0;i < SIM_INPUT_CNT;i ++) {
+        value[i] = sim_inputs[i].value;
+    }
+    fd = open(sim_path("inputs",path),O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        size = read(fd,buffer,sizeof(buffer) - 1);
+        close(fd);
+        buffer[size > 0 ? size : 0] = 0;
+        for (line = buffer;line != NULL && *line != 0;line = next) {
+            next = strchr(line,'\n');
+            if (next != NULL) {
+                *next++ = 0;
+            }
+            eq = strchr(line,'=');
+            if (eq == NULL) {
+                continue;
+            }
+            *eq = 0;
+            for (uint8_t i = 0;i < SIM_INPUT_CNT;i ++) {
+                if (strcmp(line,sim_inputs[i].name) == 0) {
+                    value[i] = (uint32_t)strtoul(eq + 1,NULL,0);
+                }
+            }
+        }
+    }
+    for (uint8_t i = 0;i < SIM_INPUT_CNT;i ++) {
+        sim_input_value[i] = value[i];
+    }
+}
+
+int sim_input(uint8_t port,uint8_t pin,uint32_t *value)
+{
+    for (uint8_t i = 0;i < SIM_INPUT_CNT;i ++) {
+        if (sim_inputs[i].port == port && sim_inputs[i].pin == pin) {
+            *value = sim_input_value[i];
+            return 0;
+        }
+    }
+    return -1;
+}
+
+void sim_output(uint8_t port,uint8_t pin,uint8_t level)
+{
+    char buffer[SIM_FILE_BUFFER_SIZE];
+    size_t size = 0;
+    bool changed = false;
+
+    for (uint8_t i = 0;i < SIM_OUTPUT_CNT;i ++) {
+        if (sim_outputs[i].port == port && sim_outputs[i].pin == pin && sim_output_level[i] != level) {
+            sim_output_level[i] = level;
+            changed = true;
+        }
+    }
+    if (changed == false) {
+        return;
+    }
+    for (uint8_t i = 0;i < SIM_OUTPUT_CNT;i ++) {
+        size += (size_t)snprintf(buffer + size,sizeof(buffer) - size,"%s=%d\n",sim_outputs[i].name,sim_output_level[i]);
+    }
+    sim_write_file("outputs",buffer,size);
+}
+
+void sim_serial_port(uint8_t port,const char *name)
+{
+    char buffer[SIM_FILE_BUFFER_SIZE];
+    char path[SIM_PATH_SIZE];
+    char link[16];
+    size_t size = 0;
+
+    if (port >= SIM_SERIAL_PORT_CNT) {
+        return;
+    }
+    strncpy(sim_serial_name[port],name,SIM_SERIAL_NAME_SIZE - 1);
+    for (uint8_t i = 0;i < SIM_SERIAL_PORT_CNT;i ++) {
+        if (sim_serial_name[i][0] != 0) {
+            size += (size_t)snprintf(buffer + size,sizeof(buffer) - size,"%d %s\n",i,sim_serial_name[i]);
+        }
+    }
+    sim_write_file("ports",buffer,size);
+    snprintf(link,sizeof(link),"tty%d",port);
+    unlink(sim_path(link,path));
+    if (symlink(name,path) != 0) {
+        fprintf(stderr,"sim: link %s failed: %s\n",path,strerror(errno));
+    }
+}
+
+/*
+* @brief 仿真中断,每个节拍在节拍信号中执行
+* @param 无
+* @return 无
+* @note 先推进外设模型,再按优先级调用挂起的中断,最后是SysTick
+*/
+int sim_poll_register(void (*poll)(void))
+{
+    if (sim_poll_cnt >= SIM_POLL_CNT_MAX) {
+        return -1;
+    }
+    sim_poll[sim_poll_cnt ++] = poll;
+    return 0;
+}
+
+void vPortSimInterruptHandler(void)
+{
+    static uint32_t input_tick;
+
+    if (++input_tick >= SIM_INPUT_POLL_INTERVAL) {
+        input_tick = 0;
+        sim_input_load();
+        sim_gpio_tick();
+    }
+    sim_ctimer_tick();
+    sim_wwdt_tick();
+    sim_eeprom_tick();
+    for (uint8_t i = 0;i < sim_poll_cnt;i ++) {
+        sim_poll[i]();
+    }
+    sim_nvic_dispatch();
+    SysTick_Handler();
+}
+
+/*pin_mux.c和clock_config.c的仿真版本*/
+void BOARD_InitBootPins(void)
+{
+    /*复位后GPIO都是输入,没有初始化的引脚也能读到电平*/
+    sim_input_load();
+    sim_gpio_tick();
+}
+
+void BOARD_BootClockPLL180M(void)
+{
+    SystemCoreClock = BOARD_BOOTCLOCKPLL180M_CORE_CLOCK;
+}
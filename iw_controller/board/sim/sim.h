@@ -0,0 +1,147 @@
+/*****************************************************************************
+*  linux simulation board
+*  Copyright (C) 2019 wkxboot 1131204425@qq.com.
+*
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License version 3 as
+*  published by the Free Software Foundation.
+*
+*  @file     sim.h
+*  @brief    linux simulation board
+*  @author   wkxboot
+*  @email    1131204425@qq.com
+*  @version  v1.0.0
+*  @date     2019/1/10
+*  @license  GNU General Public License (GPL)
+*
+*
+*****************************************************************************/
+#ifndef  __SIM_H__
+#define  __SIM_H__
+
+#include "stdint.h"
+#include "stdbool.h"
+
+#ifdef  __cplusplus
+    extern "C" {
+#endif
+
+/*
+* 仿真板:固件任务代码在FreeRTOS POSIX移植上运行,外设由board/sim/drivers中
+* 同名的fsl驱动模拟.状态目录由环境变量IW_SIM_DIR指定,默认当前目录:
+* eeprom.bin   EEPROM存储区,掉电保持
+* flash.bin    片内flash,APPLICATION/BACKUP/UPDATE区域
+* inputs       输入,每行key=value,运行时修改后生效,见sim_input_name
+* outputs      输出,压缩机和锁的控制引脚电平
+* ports        每个串口端口的伪终端从设备名称,ttyN是指向它的符号链接
+* reset        上次复位原因,watch_dog/software
+*/
+
+/********************    配置开始    **************************************/
+#define  SIM_DIR_ENV                   "IW_SIM_DIR"
+#define  SIM_PATH_SIZE                 256
+#define  SIM_INPUT_POLL_INTERVAL       50   /*输入文件检查间隔 单位:ms*/
+#define  SIM_ADC_DEFAULT_VALUE         2048 /*没有设置时的ADC转换结果*/
+#define  SIM_POLL_CNT_MAX              4    /*可注册的轮询函数数量*/
+/********************    配置结束    **************************************/
+
+/*
+* @brief 状态目录中的文件路径
+* @param name 文件名
+* @param path 路径缓存,SIM_PATH_SIZE
+* @return 路径
+* @note
+*/
+const char *sim_path(const char *name,char *path);
+
+/*
+* @brief 把状态目录中的文件映射到内存
+* @param name 文件名
+* @param size 大小,文件不存在或者大小不同时按fill填充
+* @param fill 填充值
+* @return 映射地址,失败时退出
+* @note 共享映射,写入直接进入文件
+*/
+uint8_t *sim_map(const char *name,uint32_t size,uint8_t fill);
+
+/*
+* @brief 仿真复位,重新执行程序
+* @param watch_dog true:看门狗复位
+* @return 无
+* @note 可以在中断中调用,不返回
+*/
+void sim_reset(bool watch_dog);
+
+/*
+* @brief 上次复位是否为看门狗复位
+* @param 无
+* @return true 看门狗复位
+* @note
+*/
+bool sim_reset_by_watch_dog(void);
+
+/*
+* @brief 单调时钟
+* @param 无
+* @return 时间 单位:us
+* @note
+*/
+uint64_t sim_time_us(void);
+
+/*
+* @brief 输入引脚和ADC通道的当前值
+* @param port GPIO端口,ADC通道时为SIM_INPUT_ADC
+* @param pin 引脚或者ADC通道号
+* @param value 值
+* @return 0 在inputs中设置 -1 没有设置
+* @note
+*/
+#define  SIM_INPUT_ADC                 0xFF
+int sim_input(uint8_t port,uint8_t pin,uint32_t *value);
+
+/*
+* @brief 输出引脚变化写入outputs文件
+* @param port GPIO端口
+* @param pin 引脚
+* @param level 电平
+* @return 无
+* @note 只记录有名称的引脚
+*/
+void sim_output(uint8_t port,uint8_t pin,uint8_t level);
+
+/*
+* @brief 串口端口打开后记录伪终端名称
+* @param port 端口号
+* @param name 从设备名称
+* @return 无
+* @note 写入ports文件并更新ttyN链接,复位后名称会变化
+*/
+void sim_serial_port(uint8_t port,const char *name);
+
+/*
+* @brief 注册每个节拍调用的设备轮询
+* @param poll 轮询函数,在仿真中断中执行
+* @return 0 成功 -1 已满
+* @note 用于没有硬件模型的设备,例如伪终端串口,有事件时挂起对应的中断
+*/
+int sim_poll_register(void (*poll)(void));
+
+/*外设模型,每个节拍在仿真中断中调用*/
+void sim_gpio_tick(void);
+void sim_ctimer_tick(void);
+void sim_wwdt_tick(void);
+void sim_eeprom_tick(void);
+void sim_nvic_dispatch(void);
+
+/*ADC硬件触发输入和DMA请求*/
+void sim_adc_trigger(uint8_t input);
+void sim_dma_request(uint8_t channel);
+/*INPUTMUX连接到DMA请求的信号*/
+void sim_inputmux_dma_signal(uint32_t signal);
+
+#ifdef  __cplusplus
+    }
+#endif
+
+#endif
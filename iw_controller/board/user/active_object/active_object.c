@@ -0,0 +1,307 @@
+/*****************************************************************************
+*  active_object
+*  Copyright (C) 2019 wkxboot 1131204425@qq.com.
+*
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License version 3 as
+*  published by the Free Software Foundation.
+*
+*  @file     active_object.c
+*  @brief    活动对象:事件队列,软件定时器和运行到完成的事件处理,多个活动对象共用一个线程
+*  @author   wkxboot
+*  @email    1131204425@qq.com
+*  @version  v1.0.0
+*  @date     2019/1/10
+*  @license  GNU General Public License (GPL)
+*
+*
+*****************************************************************************/
+#include "fsl_common.h"
+#include "cmsis_os.h"
+#include "active_object.h"
+#include "run_time_stats.h"
+#include "log.h"
+
+
+static active_object_t *active_object_registry[ACTIVE_OBJECT_CNT_MAX];
+static uint8_t active_object_cnt;
+
+
+/*
+* @brief 活动对象初始化并挂到线程上
+* @param thread 所属线程
+* @param ao 活动对象
+* @param queue 事件队列
+* @return -1 失败
+* @return  0 成功
+* @note 在创建线程之前调用,先挂上的活动对象先处理
+*/
+int active_object_init(active_object_thread_t *thread,active_object_t *ao,osMessageQId queue)
+{
+    if (queue == NULL || ao->handler == NULL || ao->pool == NULL) {
+        log_error("ao:%s invalid.\r\n",ao->name);
+        return -1;
+    }
+    if (thread->ao_cnt >= ACTIVE_OBJECT_THREAD_AO_CNT_MAX || active_object_cnt >= ACTIVE_OBJECT_CNT_MAX) {
+        log_error("ao:%s registry full.\r\n",ao->name);
+        return -1;
+    }
+    ao->queue = queue;
+    ao->thread = thread;
+    ao->dispatch_cnt = 0;
+    ao->post_err_cnt = 0;
+    ao->run_time_max = 0;
+    thread->ao[thread->ao_cnt ++] = ao;
+    active_object_registry[active_object_cnt ++] = ao;
+
+    return 0;
+}
+
+/*
+* @brief 唤醒线程重新检查事件和定时器
+* @param thread 线程
+* @return 无
+* @note 线程自己发出的事件不需要唤醒,等待之前会再检查一遍
+*/
+static void active_object_thread_wakeup(active_object_thread_t *thread)
+{
+    /*线程还没有创建,启动后会先检查一遍*/
+    if (thread->hdl == NULL) {
+        return;
+    }
+    if (__get_IPSR() == 0 && osThreadGetId() == thread->hdl) {
+        return;
+    }
+    osSignalSet(thread->hdl,ACTIVE_OBJECT_THREAD_SIGNAL);
+}
+
+/*
+* @brief 复制事件到活动对象的消息池并发送
+* @param ao 活动对象
+* @param event 事件,大小为消息池块大小
+* @param timeout 发送超时时间
+* @return osOK 成功
+* @return 其他 失败
+* @note 在中断中调用时timeout必须为0
+*/
+osStatus active_object_post(active_object_t *ao,const void *event,uint32_t timeout)
+{
+    osStatus status;
+    UBaseType_t mask;
+
+    status = msg_pool_send(ao->pool,ao->queue,event,timeout);
+    if (status != osOK) {
+        mask = portSET_INTERRUPT_MASK_FROM_ISR();
+        ao->post_err_cnt ++;
+        portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+        return status;
+    }
+    active_object_thread_wakeup(ao->thread);
+
+    return osOK;
+}
+
+/*
+* @brief 定时器初始化
+* @param timer 定时器
+* @param ao 到期时接收事件的活动对象
+* @param event 到期时发送的事件,需要一直有效
+* @return 无
+* @note 在活动对象的初始化函数中调用
+*/
+void active_object_timer_init(active_object_timer_t *timer,active_object_t *ao,const void *event)
+{
+    active_object_thread_t *thread = ao->thread;
+
+    timer->ao = ao;
+    timer->event = event;
+    timer->period = 0;
+    timer->expire = 0;
+    timer->armed = false;
+    timer->pending = false;
+    /*链表只由所属线程修改*/
+    timer->next = thread->timer;
+    thread->timer = timer;
+}
+
+/*
+* @brief 启动定时器
+* @param timer 定时器
+* @param timeout 第一次到期时间 单位:ms
+* @param period 之后的周期 0:单次 单位:ms
+* @return 无
+* @note 已经启动的定时器重新计时,还没有重发成功的到期事件丢弃;可以在中断中调用
+*/
+void active_object_timer_start(active_object_timer_t *timer,uint32_t timeout,uint32_t period)
+{
+    UBaseType_t mask;
+    uint32_t now;
+
+    now = osKernelSysTick();
+    mask = portSET_INTERRUPT_MASK_FROM_ISR();
+    timer->expire = now + timeout / portTICK_PERIOD_MS;
+    timer->period = period / portTICK_PERIOD_MS;
+    timer->armed = true;
+    timer->pending = false;
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+
+    active_object_thread_wakeup(timer->ao->thread);
+}
+
+/*
+* @brief 停止定时器
+* @param timer 定时器
+* @return 无
+* @note 停止前已经发出的到期事件仍然会被处理,还没有重发成功的丢弃;可以在中断中调用
+*/
+void active_object_timer_stop(active_object_timer_t *timer)
+{
+    UBaseType_t mask;
+
+    mask = portSET_INTERRUPT_MASK_FROM_ISR();
+    timer->armed = false;
+    timer->pending = false;
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+}
+
+/*
+* @brief 检查线程的定时器,发送到期事件
+* @param thread 线程
+* @return 到最近一个定时器到期的时间 单位:ms
+* @note 没有启动的定时器时返回osWaitForever;有发送失败的到期事件时返回1个tick后重发
+*/
+static uint32_t active_object_timer_poll(active_object_thread_t *thread)
+{
+    UBaseType_t mask;
+    active_object_timer_t *timer;
+    uint32_t now,timeout = osWaitForever;
+    int32_t remain;
+    bool send;
+
+    now = osKernelSysTick();
+    for (timer = thread->timer;timer != NULL;timer = timer->next) {
+        mask = portSET_INTERRUPT_MASK_FROM_ISR();
+        if (timer->armed == true) {
+            remain = (int32_t)(timer->expire - now);
+            if (remain <= 0) {
+                timer->pending = true;
+                if (timer->period == 0) {
+                    timer->armed = false;
+                } else {
+                    timer->expire += timer->period;
+                    /*错过的周期不补发*/
+                    if ((int32_t)(timer->expire - now) <= 0) {
+                        timer->expire = now + timer->period;
+                    }
+                    remain = (int32_t)(timer->expire - now);
+                }
+            }
+            if (timer->armed == true && (uint32_t)remain * portTICK_PERIOD_MS < timeout) {
+                timeout = (uint32_t)remain * portTICK_PERIOD_MS;
+            }
+        }
+        send = timer->pending;
+        portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+
+        if (send == true) {
+            if (active_object_post(timer->ao,timer->event,0) == osOK) {
+                mask = portSET_INTERRUPT_MASK_FROM_ISR();
+                timer->pending = false;
+                portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+            } else if (portTICK_PERIOD_MS < timeout) {
+                /*消息池或者队列满,处理事件后或者下一个tick重发*/
+                timeout = portTICK_PERIOD_MS;
+            }
+        }
+    }
+
+    return timeout;
+}
+
+/*
+* @brief 取出活动对象的一个事件并处理
+* @param ao 活动对象
+* @return -1 没有事件
+* @return  0 处理了一个事件
+* @note 事件处理完后归还给消息池
+*/
+static int active_object_dispatch(active_object_t *ao)
+{
+    osEvent os_event;
+    uint32_t start,cost;
+
+    os_event = osMessageGet(ao->queue,0);
+    if (os_event.status != osEventMessage) {
+        return -1;
+    }
+    start = run_time_stats_get_counter();
+    ao->handler(ao,os_event.value.p);
+    cost = run_time_stats_get_counter() - start;
+    msg_pool_free(ao->pool,os_event.value.p);
+
+    ao->dispatch_cnt ++;
+    if (cost > ao->run_time_max) {
+        ao->run_time_max = cost;
+    }
+    if (ao->thread->deadline_limit > 0 && deadline_check(&ao->thread->deadline,cost,ao->thread->deadline_limit) == true) {
+        log_warning("ao:%s event cost:%dus miss deadline.\r\n",ao->name,cost);
+    }
+
+    return 0;
+}
+
+/*
+* @brief 活动对象线程
+* @param argument 所属线程active_object_thread_t
+* @return 无
+* @note 先执行所有活动对象的初始化,然后循环处理定时器和事件
+*/
+void active_object_thread(void const *argument)
+{
+    active_object_thread_t *thread = (active_object_thread_t *)argument;
+    uint32_t timeout;
+    uint8_t i;
+
+    for (i = 0;i < thread->ao_cnt;i ++) {
+        if (thread->ao[i]->init != NULL) {
+            thread->ao[i]->init(thread->ao[i]);
+        }
+    }
+
+    while (1) {
+        timeout = active_object_timer_poll(thread);
+        /*每次只处理一个事件,然后从优先级最高的活动对象重新检查*/
+        for (i = 0;i < thread->ao_cnt;i ++) {
+            if (active_object_dispatch(thread->ao[i]) == 0) {
+                break;
+            }
+        }
+        if (i == thread->ao_cnt) {
+            osSignalWait(ACTIVE_OBJECT_THREAD_SIGNAL,timeout);
+            thread->wakeup_cnt ++;
+        }
+    }
+}
+
+/*
+* @brief 日志输出所有活动对象的统计
+* @param 无
+* @return 无
+* @note
+*/
+void active_object_dump(void)
+{
+    active_object_t *ao;
+
+    for (uint8_t i = 0;i < active_object_cnt;i ++) {
+        ao = active_object_registry[i];
+        log_info("ao:%s thread:%s wakeup:%d dispatch:%d post err:%d max:%dus\r\n",
+                 ao->name,
+                 ao->thread->name,
+                 ao->thread->wakeup_cnt,
+                 ao->dispatch_cnt,
+                 ao->post_err_cnt,
+                 ao->run_time_max);
+    }
+}
@@ -0,0 +1,174 @@
+#ifndef  __ACTIVE_OBJECT_H__
+#define  __ACTIVE_OBJECT_H__
+#include "stdint.h"
+#include "stdbool.h"
+#include "cmsis_os.h"
+#include "msg_pool.h"
+#include "deadline.h"
+
+#ifdef  __cplusplus
+#define ACTIVE_OBJECT_BEGIN  extern "C" {
+#define ACTIVE_OBJECT_END    }
+#else
+#define ACTIVE_OBJECT_BEGIN
+#define ACTIVE_OBJECT_END
+#endif
+
+
+ACTIVE_OBJECT_BEGIN
+
+/********************    配置开始    **************************************/
+#define  ACTIVE_OBJECT_CNT_MAX                 8 /*可注册的活动对象数量*/
+#define  ACTIVE_OBJECT_THREAD_AO_CNT_MAX       6 /*每个线程承载的活动对象数量*/
+/********************    配置结束    **************************************/
+
+/*线程有新事件或者定时器变化的信号*/
+#define  ACTIVE_OBJECT_THREAD_SIGNAL           (1<<0)
+
+typedef struct active_object active_object_t;
+typedef struct active_object_timer active_object_timer_t;
+typedef struct active_object_thread active_object_thread_t;
+
+/*在所属线程中执行一次的初始化*/
+typedef void (*active_object_init_t)(active_object_t *ao);
+/*事件处理,运行到完成,不能阻塞等待*/
+typedef void (*active_object_handler_t)(active_object_t *ao,const void *event);
+
+/*活动对象:一个事件队列加一个事件处理函数,事件类型对应一个消息池*/
+struct active_object
+{
+    const char                *name;
+    active_object_init_t      init;
+    active_object_handler_t   handler;
+    msg_pool_t                *pool;
+    osMessageQId              queue;
+    active_object_thread_t    *thread;
+    uint32_t                  dispatch_cnt;  /*处理的事件数量*/
+    uint32_t                  post_err_cnt;  /*发送失败次数*/
+    uint32_t                  run_time_max;  /*单个事件最长处理时间 单位:us*/
+};
+
+/*
+* 软件定时器,到期时把事件发送给活动对象,由所属线程计时,不经过定时器服务任务.
+* 发送失败的到期事件在下一个tick重发,不会丢失;重发之前再次到期的合并为一个.
+*/
+struct active_object_timer
+{
+    active_object_t           *ao;
+    const void                *event;        /*到期时发送的事件*/
+    uint32_t                  period;        /*0:单次 其他:周期 单位:tick*/
+    uint32_t                  expire;        /*到期时刻 单位:tick*/
+    bool                      armed;
+    bool                      pending;       /*到期事件因消息池或者队列满发送失败,下次检查时重发*/
+    active_object_timer_t     *next;
+};
+
+/*承载活动对象的线程,按注册顺序决定优先级*/
+struct active_object_thread
+{
+    const char                *name;
+    osThreadId                hdl;
+    active_object_t           *ao[ACTIVE_OBJECT_THREAD_AO_CNT_MAX];
+    uint8_t                   ao_cnt;
+    active_object_timer_t     *timer;        /*定时器链表*/
+    uint32_t                  wakeup_cnt;    /*唤醒次数*/
+    uint32_t                  deadline_limit;/*单个事件处理的截止时间 0:不检查 单位:us*/
+    deadline_t                deadline;
+};
+
+/*
+* @brief 定义活动对象
+* @param ao 活动对象名称
+* @param init 初始化函数,可为NULL
+* @param handler 事件处理函数
+* @param pool 事件消息池
+* @note 事件处理完才归还给消息池,消息池容量需要包含正在处理的事件
+*/
+#define  ACTIVE_OBJECT_DEF(ao,init,handler,pool)                               \
+active_object_t ao = { #ao,(init),(handler),(pool) }
+
+/*
+* @brief 定义活动对象线程
+* @param thread 线程名称
+* @param limit 单个事件处理的截止时间 0:不检查 单位:ms
+* @note 检查时需要用deadline_init注册thread.deadline
+*/
+#define  ACTIVE_OBJECT_THREAD_DEF(thread,limit)                                \
+active_object_thread_t thread = {                                              \
+.name = #thread,                                                               \
+.deadline_limit = (limit) * 1000,                                              \
+.deadline = { #thread }                                                        \
+}
+
+
+/*
+* @brief 活动对象初始化并挂到线程上
+* @param thread 所属线程
+* @param ao 活动对象
+* @param queue 事件队列
+* @return -1 失败
+* @return  0 成功
+* @note 在创建线程之前调用,先挂上的活动对象先处理
+*/
+int active_object_init(active_object_thread_t *thread,active_object_t *ao,osMessageQId queue);
+
+/*
+* @brief 活动对象线程
+* @param argument 所属线程active_object_thread_t
+* @return 无
+* @note 先执行所有活动对象的初始化,然后循环处理定时器和事件
+*/
+void active_object_thread(void const *argument);
+
+/*
+* @brief 复制事件到活动对象的消息池并发送
+* @param ao 活动对象
+* @param event 事件,大小为消息池块大小
+* @param timeout 发送超时时间
+* @return osOK 成功
+* @return 其他 失败
+* @note 在中断中调用时timeout必须为0
+*/
+osStatus active_object_post(active_object_t *ao,const void *event,uint32_t timeout);
+
+/*
+* @brief 定时器初始化
+* @param timer 定时器
+* @param ao 到期时接收事件的活动对象
+* @param event 到期时发送的事件,需要一直有效
+* @return 无
+* @note 在活动对象的初始化函数中调用
+*/
+void active_object_timer_init(active_object_timer_t *timer,active_object_t *ao,const void *event);
+
+/*
+* @brief 启动定时器
+* @param timer 定时器
+* @param timeout 第一次到期时间 单位:ms
+* @param period 之后的周期 0:单次 单位:ms
+* @return 无
+* @note 已经启动的定时器重新计时,还没有重发成功的到期事件丢弃;可以在中断中调用
+*/
+void active_object_timer_start(active_object_timer_t *timer,uint32_t timeout,uint32_t period);
+
+/*
+* @brief 停止定时器
+* @param timer 定时器
+* @return 无
+* @note 停止前已经发出的到期事件仍然会被处理,还没有重发成功的丢弃;可以在中断中调用
+*/
+void active_object_timer_stop(active_object_timer_t *timer);
+
+/*
+* @brief 日志输出所有活动对象的统计
+* @param 无
+* @return 无
+* @note
+*/
+void active_object_dump(void);
+
+
+
+ACTIVE_OBJECT_END
+
+#endif
@@ -0,0 +1,300 @@
+/*****************************************************************************
+*  run time stats
+*  Copyright (C) 2019 wkxboot 1131204425@qq.com.
+*
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License version 3 as
+*  published by the Free Software Foundation.
+*
+*  @file     run_time_stats.c
+*  @brief    按任务和中断统计cpu占用
+*  @author   wkxboot
+*  @email    1131204425@qq.com
+*  @version  v1.0.0
+*  @date     2019/1/10
+*  @license  GNU General Public License (GPL)
+*
+*
+*****************************************************************************/
+#include "fsl_common.h"
+#include "fsl_clock.h"
+#include "fsl_ctimer.h"
+#include "cmsis_os.h"
+#include "stdio.h"
+#include "string.h"
+#include "run_time_stats.h"
+#include "log.h"
+
+
+typedef struct
+{
+    uint32_t window;
+    uint32_t window_start;
+    uint32_t counter;
+    bool     valid;
+    uint8_t  task_cnt;
+    uint8_t  task_number[RUN_TIME_STATS_TASK_CNT_MAX];
+    uint32_t task_time[RUN_TIME_STATS_TASK_CNT_MAX];
+    uint32_t isr_time[RUN_TIME_STATS_ISR_CNT_MAX];
+    uint32_t elapsed;
+    uint8_t  result_cnt;
+    run_time_stats_item_t result[RUN_TIME_STATS_ITEM_CNT_MAX];
+}run_time_stats_t;
+
+/*中断累计运行时间 单位:us*/
+static volatile uint32_t isr_time[RUN_TIME_STATS_ISR_CNT_MAX];
+
+static run_time_stats_t run_time_stats = {
+.window = RUN_TIME_STATS_WINDOW_DEFAULT
+};
+
+/*uxTaskGetSystemState快照缓存*/
+static TaskStatus_t task_status[RUN_TIME_STATS_TASK_CNT_MAX];
+static run_time_stats_item_t item_buffer[RUN_TIME_STATS_ITEM_CNT_MAX];
+
+
+/*
+* @brief 运行时间统计定时器初始化
+* @param 无
+* @return 无
+* @note 由portCONFIGURE_TIMER_FOR_RUN_TIME_STATS在启动调度器时调用
+*/
+void run_time_stats_timer_init(void)
+{
+    ctimer_config_t config;
+
+    CTIMER_GetDefaultConfig(&config);
+    config.prescale = CLOCK_GetFreq(RUN_TIME_STATS_TIMER_CLK) / RUN_TIME_STATS_TIMER_FREQ - 1;
+    CTIMER_Init(RUN_TIME_STATS_TIMER,&config);
+    CTIMER_StartTimer(RUN_TIME_STATS_TIMER);
+}
+
+/*
+* @brief 获取运行时间计数值
+* @param 无
+* @return 计数值 单位:us
+* @note 由portGET_RUN_TIME_COUNTER_VALUE调用
+*/
+uint32_t run_time_stats_get_counter(void)
+{
+    return RUN_TIME_STATS_TIMER->TC;
+}
+
+/*
+* @brief 中断进入时记录开始时间
+* @param 无
+* @return 开始计数值
+* @note 与run_time_stats_isr_exit成对使用
+*/
+uint32_t run_time_stats_isr_enter(void)
+{
+    return RUN_TIME_STATS_TIMER->TC;
+}
+
+/*
+* @brief 中断退出时累计中断时间
+* @param isr 中断序号(FLEXCOMM端口号)
+* @param start run_time_stats_isr_enter返回的开始计数值
+* @return 无
+* @note 中断时间同时也计入了被中断的任务
+*/
+void run_time_stats_isr_exit(uint8_t isr,uint32_t start)
+{
+    if (isr < RUN_TIME_STATS_ISR_CNT_MAX) {
+        isr_time[isr] += RUN_TIME_STATS_TIMER->TC - start;
+    }
+}
+
+/*
+* @brief 设置统计窗口
+* @param window 窗口时间 单位:ms
+* @return -1 失败
+* @return  0 成功
+* @note
+*/
+int run_time_stats_set_window(uint32_t window)
+{
+    if (window < RUN_TIME_STATS_WINDOW_MIN || window > RUN_TIME_STATS_WINDOW_MAX) {
+        log_error("run time stats window:%d invalid.\r\n",window);
+        return -1;
+    }
+    run_time_stats.window = window;
+    /*丢弃当前窗口,重新开始统计*/
+    run_time_stats.valid = false;
+    return 0;
+}
+
+/*
+* @brief 获取统计窗口
+* @param 无
+* @return 窗口时间 单位:ms
+* @note
+*/
+uint32_t run_time_stats_get_window(void)
+{
+    return run_time_stats.window;
+}
+
+/*
+* @brief 计算占用率
+* @param time 运行时间
+* @param elapsed 窗口时间
+* @return 占用率 单位:0.01%
+* @note
+*/
+static uint16_t run_time_stats_usage(uint32_t time,uint32_t elapsed)
+{
+    if (elapsed == 0) {
+        return 0;
+    }
+    if (time >= elapsed) {
+        return 10000;
+    }
+    return (uint16_t)((uint64_t)time * 10000 / elapsed);
+}
+
+/*
+* @brief 查找任务上一次快照的运行时间
+* @param number 任务编号
+* @param time 运行时间指针
+* @return -1 没有找到(新任务)
+* @return  0 成功
+* @note
+*/
+static int run_time_stats_find_task_time(uint8_t number,uint32_t *time)
+{
+    for (uint8_t i = 0;i < run_time_stats.task_cnt;i ++) {
+        if (run_time_stats.task_number[i] == number) {
+            *time = run_time_stats.task_time[i];
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/*
+* @brief 周期轮询,窗口时间到达后更新统计结果
+* @param 无
+* @return 无
+* @note 在任务中周期调用,周期应小于统计窗口
+*/
+void run_time_stats_poll(void)
+{
+    uint32_t tick,counter,elapsed,time,prev_time;
+    uint32_t isr_time_now[RUN_TIME_STATS_ISR_CNT_MAX];
+    UBaseType_t task_cnt;
+    uint8_t cnt = 0;
+
+    tick = osKernelSysTick();
+    if (run_time_stats.valid && tick - run_time_stats.window_start < run_time_stats.window) {
+        return;
+    }
+
+    task_cnt = uxTaskGetSystemState(task_status,RUN_TIME_STATS_TASK_CNT_MAX,NULL);
+    counter = run_time_stats_get_counter();
+    for (uint8_t i = 0;i < RUN_TIME_STATS_ISR_CNT_MAX;i ++) {
+        isr_time_now[i] = isr_time[i];
+    }
+    elapsed = counter - run_time_stats.counter;
+
+    /*第一个窗口只记录快照*/
+    if (run_time_stats.valid) {
+        for (UBaseType_t i = 0;i < task_cnt;i ++) {
+            if (run_time_stats_find_task_time(task_status[i].xTaskNumber,&prev_time) != 0) {
+                prev_time = 0;
+            }
+            time = task_status[i].ulRunTimeCounter - prev_time;
+            item_buffer[cnt].number = task_status[i].xTaskNumber;
+            strncpy(item_buffer[cnt].name,task_status[i].pcTaskName,RUN_TIME_STATS_NAME_SIZE - 1);
+            item_buffer[cnt].name[RUN_TIME_STATS_NAME_SIZE - 1] = 0;
+            item_buffer[cnt].time = time;
+            item_buffer[cnt].usage = run_time_stats_usage(time,elapsed);
+            cnt ++;
+        }
+        for (uint8_t i = 0;i < RUN_TIME_STATS_ISR_CNT_MAX;i ++) {
+            /*没有发生过中断的端口不输出*/
+            if (isr_time_now[i] == 0) {
+                continue;
+            }
+            time = isr_time_now[i] - run_time_stats.isr_time[i];
+            item_buffer[cnt].number = RUN_TIME_STATS_ISR_NUMBER_FLAG | i;
+            snprintf(item_buffer[cnt].name,RUN_TIME_STATS_NAME_SIZE,"flexcomm%d",i);
+            item_buffer[cnt].time = time;
+            item_buffer[cnt].usage = run_time_stats_usage(time,elapsed);
+            cnt ++;
+        }
+    }
+
+    /*保存快照*/
+    run_time_stats.task_cnt = task_cnt;
+    for (UBaseType_t i = 0;i < task_cnt;i ++) {
+        run_time_stats.task_number[i] = task_status[i].xTaskNumber;
+        run_time_stats.task_time[i] = task_status[i].ulRunTimeCounter;
+    }
+    for (uint8_t i = 0;i < RUN_TIME_STATS_ISR_CNT_MAX;i ++) {
+        run_time_stats.isr_time[i] = isr_time_now[i];
+    }
+    run_time_stats.counter = counter;
+    run_time_stats.window_start = tick;
+
+    if (run_time_stats.valid) {
+        /*提交结果,读取方在其他任务中*/
+        taskENTER_CRITICAL();
+        memcpy(run_time_stats.result,item_buffer,cnt * sizeof(run_time_stats_item_t));
+        run_time_stats.result_cnt = cnt;
+        run_time_stats.elapsed = elapsed;
+        taskEXIT_CRITICAL();
+    }
+    run_time_stats.valid = true;
+}
+
+/*
+* @brief 获取上一个窗口的统计结果
+* @param item 统计项缓存
+* @param offset 起始统计项序号
+* @param cnt 缓存可容纳的统计项数量
+* @param total 统计项总数
+* @return 实际复制的统计项数量
+* @note 先任务后中断,中断项只包含发生过中断的端口
+*/
+int run_time_stats_get_result(run_time_stats_item_t *item,uint8_t offset,uint8_t cnt,uint8_t *total)
+{
+    uint8_t copy_cnt = 0;
+
+    taskENTER_CRITICAL();
+    *total = run_time_stats.result_cnt;
+    if (offset < run_time_stats.result_cnt) {
+        copy_cnt = run_time_stats.result_cnt - offset;
+        if (copy_cnt > cnt) {
+            copy_cnt = cnt;
+        }
+        memcpy(item,&run_time_stats.result[offset],copy_cnt * sizeof(run_time_stats_item_t));
+    }
+    taskEXIT_CRITICAL();
+
+    return copy_cnt;
+}
+
+/*
+* @brief 日志输出上一个窗口的统计结果
+* @param 无
+* @return 无
+* @note
+*/
+void run_time_stats_dump(void)
+{
+    uint8_t total;
+    int cnt;
+
+    cnt = run_time_stats_get_result(item_buffer,0,RUN_TIME_STATS_ITEM_CNT_MAX,&total);
+    log_info("window:%dms elapsed:%dus.\r\n",run_time_stats.window,run_time_stats.elapsed);
+    for (int i = 0;i < cnt;i ++) {
+        log_info("%3d %-12s %3d.%02d%% %dus\r\n",
+                 item_buffer[i].number,
+                 item_buffer[i].name,
+                 item_buffer[i].usage / 100,
+                 item_buffer[i].usage % 100,
+                 item_buffer[i].time);
+    }
+}
@@ -0,0 +1,122 @@
+#ifndef  __RUN_TIME_STATS_H__
+#define  __RUN_TIME_STATS_H__
+#include "stdint.h"
+
+#ifdef  __cplusplus
+#define RUN_TIME_STATS_BEGIN  extern "C" {
+#define RUN_TIME_STATS_END    }
+#else
+#define RUN_TIME_STATS_BEGIN
+#define RUN_TIME_STATS_END
+#endif
+
+
+RUN_TIME_STATS_BEGIN
+
+#define  RUN_TIME_STATS_TIMER                    CTIMER1  /*运行时间统计使用的定时器*/
+#define  RUN_TIME_STATS_TIMER_CLK                kCLOCK_BusClk
+#define  RUN_TIME_STATS_TIMER_FREQ               1000000  /*计数频率 单位:Hz 1us分辨率*/
+
+#define  RUN_TIME_STATS_TASK_CNT_MAX             24       /*可统计的最大任务数量*/
+#define  RUN_TIME_STATS_ISR_CNT_MAX              10       /*可统计的中断数量,对应FLEXCOMM0-9*/
+#define  RUN_TIME_STATS_ISR_NUMBER_FLAG          0x80     /*中断统计项编号标志,编号=标志|端口号*/
+#define  RUN_TIME_STATS_ITEM_CNT_MAX             (RUN_TIME_STATS_TASK_CNT_MAX + RUN_TIME_STATS_ISR_CNT_MAX)
+
+#define  RUN_TIME_STATS_WINDOW_DEFAULT           1000     /*默认统计窗口 单位:ms*/
+#define  RUN_TIME_STATS_WINDOW_MIN               100      /*最小统计窗口 单位:ms*/
+#define  RUN_TIME_STATS_WINDOW_MAX               60000    /*最大统计窗口 单位:ms*/
+
+#define  RUN_TIME_STATS_NAME_SIZE                12
+
+/*统计项*/
+typedef struct
+{
+    uint8_t  number;                        /*任务编号,中断为RUN_TIME_STATS_ISR_NUMBER_FLAG|端口号*/
+    char     name[RUN_TIME_STATS_NAME_SIZE];
+    uint32_t time;                          /*窗口内运行时间 单位:us*/
+    uint16_t usage;                         /*窗口内占用率 单位:0.01%*/
+}run_time_stats_item_t;
+
+
+/*
+* @brief 运行时间统计定时器初始化
+* @param 无
+* @return 无
+* @note 由portCONFIGURE_TIMER_FOR_RUN_TIME_STATS在启动调度器时调用
+*/
+void run_time_stats_timer_init(void);
+
+/*
+* @brief 获取运行时间计数值
+* @param 无
+* @return 计数值 单位:us
+* @note 由portGET_RUN_TIME_COUNTER_VALUE调用
+*/
+uint32_t run_time_stats_get_counter(void);
+
+/*
+* @brief 中断进入时记录开始时间
+* @param 无
+* @return 开始计数值
+* @note 与run_time_stats_isr_exit成对使用
+*/
+uint32_t run_time_stats_isr_enter(void);
+
+/*
+* @brief 中断退出时累计中断时间
+* @param isr 中断序号(FLEXCOMM端口号)
+* @param start run_time_stats_isr_enter返回的开始计数值
+* @return 无
+* @note 中断时间同时也计入了被中断的任务
+*/
+void run_time_stats_isr_exit(uint8_t isr,uint32_t start);
+
+/*
+* @brief 设置统计窗口
+* @param window 窗口时间 单位:ms
+* @return -1 失败
+* @return  0 成功
+* @note
+*/
+int run_time_stats_set_window(uint32_t window);
+
+/*
+* @brief 获取统计窗口
+* @param 无
+* @return 窗口时间 单位:ms
+* @note
+*/
+uint32_t run_time_stats_get_window(void);
+
+/*
+* @brief 周期轮询,窗口时间到达后更新统计结果
+* @param 无
+* @return 无
+* @note 在任务中周期调用,周期应小于统计窗口
+*/
+void run_time_stats_poll(void);
+
+/*
+* @brief 获取上一个窗口的统计结果
+* @param item 统计项缓存
+* @param offset 起始统计项序号
+* @param cnt 缓存可容纳的统计项数量
+* @param total 统计项总数
+* @return 实际复制的统计项数量
+* @note 先任务后中断,中断项只包含发生过中断的端口
+*/
+int run_time_stats_get_result(run_time_stats_item_t *item,uint8_t offset,uint8_t cnt,uint8_t *total);
+
+/*
+* @brief 日志输出上一个窗口的统计结果
+* @param 无
+* @return 无
+* @note
+*/
+void run_time_stats_dump(void);
+
+
+
+RUN_TIME_STATS_END
+
+#endif
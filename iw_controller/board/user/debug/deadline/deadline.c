@@ -0,0 +1,121 @@
+/*****************************************************************************
+*  deadline
+*  Copyright (C) 2019 wkxboot 1131204425@qq.com.
+*
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License version 3 as
+*  published by the Free Software Foundation.
+*
+*  @file     deadline.c
+*  @brief    作业截止时间超时计数和最长响应时间统计
+*  @author   wkxboot
+*  @email    1131204425@qq.com
+*  @version  v1.0.0
+*  @date     2019/1/10
+*  @license  GNU General Public License (GPL)
+*
+*
+*****************************************************************************/
+#include "cmsis_os.h"
+#include "deadline.h"
+#include "log.h"
+
+
+static deadline_t *deadline_registry[DEADLINE_CNT_MAX];
+static uint8_t deadline_cnt;
+
+
+/*
+* @brief 截止时间统计注册
+* @param deadline 统计
+* @return -1 失败
+* @return  0 成功
+* @note
+*/
+int deadline_init(deadline_t *deadline)
+{
+    int rc = -1;
+
+    taskENTER_CRITICAL();
+    if (deadline_cnt < DEADLINE_CNT_MAX) {
+        deadline->cnt = 0;
+        deadline->miss_cnt = 0;
+        deadline->worst = 0;
+        deadline->worst_deadline = 0;
+        deadline_registry[deadline_cnt ++] = deadline;
+        rc = 0;
+    }
+    taskEXIT_CRITICAL();
+
+    if (rc != 0) {
+        log_error("deadline:%s registry full.\r\n",deadline->name);
+    }
+    return rc;
+}
+
+/*
+* @brief 记录一个作业的响应时间
+* @param deadline 统计
+* @param response 响应时间 单位:us
+* @param limit 截止时间 单位:us
+* @return true 超过截止时间
+* @return false 没有超过
+* @note 多个任务可以共用一个统计
+*/
+bool deadline_check(deadline_t *deadline,uint32_t response,uint32_t limit)
+{
+    bool miss = response > limit;
+
+    taskENTER_CRITICAL();
+    deadline->cnt ++;
+    if (miss == true) {
+        deadline->miss_cnt ++;
+    }
+    if (response > deadline->worst) {
+        deadline->worst = response;
+        deadline->worst_deadline = limit;
+    }
+    taskEXIT_CRITICAL();
+
+    return miss;
+}
+
+/*
+* @brief 清空所有统计
+* @param 无
+* @return 无
+* @note
+*/
+void deadline_reset(void)
+{
+    taskENTER_CRITICAL();
+    for (uint8_t i = 0;i < deadline_cnt;i ++) {
+        deadline_registry[i]->cnt = 0;
+        deadline_registry[i]->miss_cnt = 0;
+        deadline_registry[i]->worst = 0;
+        deadline_registry[i]->worst_deadline = 0;
+    }
+    taskEXIT_CRITICAL();
+}
+
+/*
+* @brief 日志输出所有统计
+* @param 无
+* @return 无
+* @note
+*/
+void deadline_dump(void)
+{
+    deadline_t *deadline;
+
+    for (uint8_t i = 0;i < deadline_cnt;i ++) {
+        deadline = deadline_registry[i];
+        log_info("deadline:%s cnt:%d miss:%d worst:%dus/%dus\r\n",
+                 deadline->name,
+                 deadline->cnt,
+                 deadline->miss_cnt,
+                 deadline->worst,
+                 deadline->worst_deadline);
+    }
+}
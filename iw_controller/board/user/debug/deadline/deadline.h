@@ -0,0 +1,79 @@
+#ifndef  __DEADLINE_H__
+#define  __DEADLINE_H__
+#include "stdint.h"
+#include "stdbool.h"
+
+#ifdef  __cplusplus
+#define DEADLINE_BEGIN  extern "C" {
+#define DEADLINE_END    }
+#else
+#define DEADLINE_BEGIN
+#define DEADLINE_END
+#endif
+
+
+DEADLINE_BEGIN
+
+/********************    配置开始    **************************************/
+#define  DEADLINE_CNT_MAX                      8 /*可注册的截止时间统计数量*/
+/********************    配置结束    **************************************/
+
+/*一类作业的截止时间统计*/
+typedef struct
+{
+    const char *name;
+    uint32_t   cnt;          /*完成的作业数量*/
+    uint32_t   miss_cnt;     /*超过截止时间的作业数量*/
+    uint32_t   worst;        /*最长响应时间 单位:us*/
+    uint32_t   worst_deadline;/*最长响应时间对应的截止时间 单位:us*/
+}deadline_t;
+
+/*
+* @brief 定义截止时间统计
+* @param deadline 统计名称
+*/
+#define  DEADLINE_DEF(deadline)                                                \
+deadline_t deadline = { #deadline }
+
+
+/*
+* @brief 截止时间统计注册
+* @param deadline 统计
+* @return -1 失败
+* @return  0 成功
+* @note
+*/
+int deadline_init(deadline_t *deadline);
+
+/*
+* @brief 记录一个作业的响应时间
+* @param deadline 统计
+* @param response 响应时间 单位:us
+* @param limit 截止时间 单位:us
+* @return true 超过截止时间
+* @return false 没有超过
+* @note 多个任务可以共用一个统计
+*/
+bool deadline_check(deadline_t *deadline,uint32_t response,uint32_t limit);
+
+/*
+* @brief 清空所有统计
+* @param 无
+* @return 无
+* @note
+*/
+void deadline_reset(void);
+
+/*
+* @brief 日志输出所有统计
+* @param 无
+* @return 无
+* @note
+*/
+void deadline_dump(void);
+
+
+
+DEADLINE_END
+
+#endif
@@ -0,0 +1,190 @@
+/*****************************************************************************
+*  trace
+*  Copyright (C) 2019 wkxboot 1131204425@qq.com.
+*
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License version 3 as
+*  published by the Free Software Foundation.
+*
+*  @file     trace.c
+*  @brief    RAM环形缓存二进制事件跟踪
+*  @author   wkxboot
+*  @email    1131204425@qq.com
+*  @version  v1.0.0
+*  @date     2019/1/10
+*  @license  GNU General Public License (GPL)
+*
+*
+*****************************************************************************/
+#include "fsl_common.h"
+#include "cmsis_os.h"
+#include "trace.h"
+#include "log.h"
+
+
+typedef struct
+{
+    volatile bool enable;
+    uint32_t write;        /*累计写入的记录数量*/
+    trace_record_t ring[TRACE_RING_SIZE];
+}trace_t;
+
+static trace_t trace;
+
+/*导出时的任务快照缓存*/
+#define  TRACE_TASK_CNT_MAX                    24
+static TaskStatus_t trace_task_status[TRACE_TASK_CNT_MAX];
+
+
+/*
+* @brief 跟踪初始化,使能DWT周期计数器并开始记录
+* @param 无
+* @return 无
+* @note 在创建任务之前调用
+*/
+void trace_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    trace.write = 0;
+    trace.enable = true;
+}
+
+/*
+* @brief 开始或者停止记录
+* @param enable true:开始 false:停止
+* @return 无
+* @note 停止后环形缓存内容保持不变,可以导出
+*/
+void trace_enable(bool enable)
+{
+    trace.enable = enable;
+}
+
+/*
+* @brief 清空环形缓存
+* @param 无
+* @return 无
+* @note
+*/
+void trace_clear(void)
+{
+    UBaseType_t mask;
+
+    mask = portSET_INTERRUPT_MASK_FROM_ISR();
+    trace.write = 0;
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+}
+
+/*
+* @brief 记录一个事件
+* @param type 事件类型
+* @param id 事件id
+* @param arg 事件参数
+* @return 无
+* @note 可在任务和优先级不高于configMAX_SYSCALL_INTERRUPT_PRIORITY的中断中调用
+*/
+void trace_record(uint8_t type,uint8_t id,uint16_t arg)
+{
+    UBaseType_t mask;
+    trace_record_t *record;
+
+    if (trace.enable == false) {
+        return;
+    }
+    mask = portSET_INTERRUPT_MASK_FROM_ISR();
+    record = &trace.ring[trace.write & (TRACE_RING_SIZE - 1)];
+    record->cycle = DWT->CYCCNT;
+    record->type = type;
+    record->id = id;
+    record->arg = arg;
+    trace.write ++;
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+}
+
+/*
+* @brief 任务切入
+* @param number 任务编号
+* @return 无
+* @note 由traceTASK_SWITCHED_IN调用
+*/
+void trace_task_switched_in(uint32_t number)
+{
+    trace_record(TRACE_EVENT_TASK_SWITCHED_IN,(uint8_t)number,0);
+}
+
+/*
+* @brief 任务切出
+* @param number 任务编号
+* @return 无
+* @note 由traceTASK_SWITCHED_OUT调用
+*/
+void trace_task_switched_out(uint32_t number)
+{
+    trace_record(TRACE_EVENT_TASK_SWITCHED_OUT,(uint8_t)number,0);
+}
+
+/*
+* @brief 队列事件
+* @param type 事件类型
+* @param queue 队列句柄
+* @return 无
+* @note 由traceQUEUE_xxx调用
+*/
+void trace_queue(uint8_t type,void *queue)
+{
+    trace_record(type,0,(uint16_t)((uint32_t)queue & 0xFFFF));
+}
+
+/*
+* @brief 导出环形缓存
+* @param 无
+* @return 无
+* @note 以文本行通过日志输出,由tools/trace_decode.py解码;导出前会停止记录
+*/
+void trace_dump(void)
+{
+    uint32_t start,cnt,lost;
+    UBaseType_t task_cnt;
+    char line[TRACE_DUMP_RECORDS_PER_LINE * sizeof(trace_record_t) * 2 + 1];
+    uint8_t line_offset;
+    uint8_t *byte;
+
+    trace.enable = false;
+
+    if (trace.write > TRACE_RING_SIZE) {
+        start = trace.write - TRACE_RING_SIZE;
+        cnt = TRACE_RING_SIZE;
+    } else {
+        start = 0;
+        cnt = trace.write;
+    }
+    lost = start;
+
+    log_info("trace hdr freq:%d cnt:%d lost:%d\r\n",SystemCoreClock,cnt,lost);
+    /*任务编号和名称对应表*/
+    task_cnt = uxTaskGetSystemState(trace_task_status,TRACE_TASK_CNT_MAX,NULL);
+    for (UBaseType_t i = 0;i < task_cnt;i ++) {
+        log_info("trace task %d %s\r\n",trace_task_status[i].xTaskNumber,trace_task_status[i].pcTaskName);
+    }
+
+    line_offset = 0;
+    for (uint32_t i = 0;i < cnt;i ++) {
+        byte = (uint8_t *)&trace.ring[(start + i) & (TRACE_RING_SIZE - 1)];
+        for (uint8_t j = 0;j < sizeof(trace_record_t);j ++) {
+            line[line_offset ++] = "0123456789abcdef"[byte[j] >> 4];
+            line[line_offset ++] = "0123456789abcdef"[byte[j] & 0x0F];
+        }
+        if ((i + 1) % TRACE_DUMP_RECORDS_PER_LINE == 0 || i + 1 == cnt) {
+            line[line_offset] = 0;
+            log_info("trace rec %s\r\n",line);
+            line_offset = 0;
+            /*等待日志通道输出*/
+            osDelay(2);
+        }
+    }
+    log_info("trace end\r\n");
+}
@@ -0,0 +1,108 @@
+#ifndef  __TRACE_H__
+#define  __TRACE_H__
+#include "stdint.h"
+#include "stdbool.h"
+
+#ifdef  __cplusplus
+#define TRACE_BEGIN  extern "C" {
+#define TRACE_END    }
+#else
+#define TRACE_BEGIN
+#define TRACE_END
+#endif
+
+
+TRACE_BEGIN
+
+/********************    配置开始    **************************************/
+#define  TRACE_ENABLE                          1    /*是否把freertos跟踪宏挂接到跟踪记录,见trace_hooks.h*/
+#define  TRACE_RING_SIZE                       1024 /*环形缓存记录数量,必须是2的x次方*/
+#define  TRACE_DUMP_RECORDS_PER_LINE           4    /*导出时每行的记录数量*/
+/********************    配置结束    **************************************/
+
+/*事件类型*/
+#define  TRACE_EVENT_TASK_SWITCHED_IN          0x01 /*id:任务编号*/
+#define  TRACE_EVENT_TASK_SWITCHED_OUT         0x02 /*id:任务编号*/
+#define  TRACE_EVENT_QUEUE_SEND                0x03 /*arg:队列地址低16位*/
+#define  TRACE_EVENT_QUEUE_SEND_FROM_ISR       0x04 /*arg:队列地址低16位*/
+#define  TRACE_EVENT_QUEUE_RECEIVE             0x05 /*arg:队列地址低16位*/
+#define  TRACE_EVENT_QUEUE_BLOCK               0x06 /*arg:队列地址低16位*/
+#define  TRACE_EVENT_ISR_ENTER                 0x07 /*id:中断序号*/
+#define  TRACE_EVENT_ISR_EXIT                  0x08 /*id:中断序号*/
+#define  TRACE_EVENT_USER                      0x10 /*id:用户事件编号 arg:用户值*/
+
+/*用户事件编号*/
+#define  TRACE_USER_HOST_ADU_RECV              0x01 /*arg:adu大小*/
+#define  TRACE_USER_HOST_ADU_PARSED            0x02 /*arg:命令码*/
+#define  TRACE_USER_HOST_ADU_SENT              0x03 /*arg:adu大小*/
+#define  TRACE_USER_SCALE_REQ                  0x04 /*arg:电子秤地址<<8|操作码*/
+#define  TRACE_USER_SCALE_RSP                  0x05 /*arg:电子秤地址<<8|操作码*/
+#define  TRACE_USER_SCALE_TIMEOUT              0x06 /*arg:电子秤地址<<8|操作码*/
+
+/*跟踪记录 8字节*/
+typedef struct
+{
+    uint32_t cycle;   /*DWT周期计数*/
+    uint8_t  type;
+    uint8_t  id;
+    uint16_t arg;
+}trace_record_t;
+
+
+/*
+* @brief 跟踪初始化,使能DWT周期计数器并开始记录
+* @param 无
+* @return 无
+* @note 在创建任务之前调用
+*/
+void trace_init(void);
+
+/*
+* @brief 开始或者停止记录
+* @param enable true:开始 false:停止
+* @return 无
+* @note 停止后环形缓存内容保持不变,可以导出
+*/
+void trace_enable(bool enable);
+
+/*
+* @brief 清空环形缓存
+* @param 无
+* @return 无
+* @note
+*/
+void trace_clear(void);
+
+/*
+* @brief 记录一个事件
+* @param type 事件类型
+* @param id 事件id
+* @param arg 事件参数
+* @return 无
+* @note 可在任务和优先级不高于configMAX_SYSCALL_INTERRUPT_PRIORITY的中断中调用
+*/
+void trace_record(uint8_t type,uint8_t id,uint16_t arg);
+
+/*
+* @brief 导出环形缓存
+* @param 无
+* @return 无
+* @note 以文本行通过日志输出,由tools/trace_decode.py解码;导出前会停止记录
+*/
+void trace_dump(void);
+
+/*freertos跟踪宏调用,由TRACE_ENABLE控制是否挂接,见trace_hooks.h*/
+void trace_task_switched_in(uint32_t number);
+void trace_task_switched_out(uint32_t number);
+void trace_queue(uint8_t type,void *queue);
+
+#define  trace_user(id,arg)                    trace_record(TRACE_EVENT_USER,(id),(uint16_t)(arg))
+#define  trace_isr_enter(isr)                  trace_record(TRACE_EVENT_ISR_ENTER,(isr),0)
+#define  trace_isr_exit(isr)                   trace_record(TRACE_EVENT_ISR_EXIT,(isr),0)
+
+
+
+
+TRACE_END
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef  __TRACE_HOOKS_H__
+#define  __TRACE_HOOKS_H__
+#include "trace.h"
+
+/*
+* freertos跟踪宏,在FreeRTOSConfig.h末尾包含.
+* 任务切换宏总是挂接空闲监视(cpu_utils.c),TRACE_ENABLE使能时再挂接跟踪记录.
+*/
+#if  TRACE_ENABLE > 0
+#define  traceTASK_SWITCHED_IN()               extern void StartIdleMonitor(void); \
+                                               StartIdleMonitor(); \
+                                               trace_task_switched_in(pxCurrentTCB->uxTCBNumber)
+#define  traceTASK_SWITCHED_OUT()              extern void EndIdleMonitor(void); \
+                                               trace_task_switched_out(pxCurrentTCB->uxTCBNumber); \
+                                               EndIdleMonitor()
+#define  traceQUEUE_SEND(pxQueue)              trace_queue(TRACE_EVENT_QUEUE_SEND,(pxQueue))
+#define  traceQUEUE_SEND_FROM_ISR(pxQueue)     trace_queue(TRACE_EVENT_QUEUE_SEND_FROM_ISR,(pxQueue))
+#define  traceQUEUE_RECEIVE(pxQueue)           trace_queue(TRACE_EVENT_QUEUE_RECEIVE,(pxQueue))
+#define  traceBLOCKING_ON_QUEUE_RECEIVE(pxQueue) trace_queue(TRACE_EVENT_QUEUE_BLOCK,(pxQueue))
+#else
+#define  traceTASK_SWITCHED_IN()               extern void StartIdleMonitor(void); \
+                                               StartIdleMonitor()
+#define  traceTASK_SWITCHED_OUT()              extern void EndIdleMonitor(void); \
+                                               EndIdleMonitor()
+#endif
+
+
+#endif
@@ -4,7 +4,14 @@
 #else
 #include "flash_if.h"
 #endif
+#if  DEVICE_ENV_USE_WRITE_BACK > 0
+#include "cmsis_os.h"
+#endif
 #include "crc16.h"
+#include "stdbool.h"
+#include "stdlib.h"
+#include "stdio.h"
+#include "string.h"
 #include "log.h"
 
 /*****************************************************************************
@@ -38,11 +45,33 @@ typedef struct
 /*内部静态环境变量*/
 static device_env_t device_env;
 
+/*RAM索引:名称哈希到条目位置,开放寻址,只在环境变量变化时重建*/
+typedef struct
+{
+    uint16_t hash;
+    uint16_t offset;/*条目在数据区的位置+1 0:空槽*/
+}device_env_index_t;
+
+static device_env_index_t device_env_index[DEVICE_ENV_INDEX_SIZE];
+/*索引放不下时退回逐字符查找*/
+static bool device_env_index_valid;
+
+typedef struct
+{
+    const char *name;
+    device_env_notify_t notify;
+}device_env_notify_item_t;
+
+static device_env_notify_item_t device_env_notify_table[DEVICE_ENV_NOTIFY_CNT_MAX];
+static uint8_t device_env_notify_cnt;
+
 #if DEVICE_ENV_USE_EEPROM > 0
 /*内部静态备份环境变量*/
 static device_env_t device_env_backup;
 #endif
 
+static char *device_env_find(char *name);
+
 /*
 * @brief 
 * @param
@@ -88,6 +117,76 @@ static int device_env_match(char *name,int index2)
     return (-1);
 }
 
+/*
+* @brief 计算名称哈希
+* @param name 名称,以'\0'或者'='结束
+* @return 哈希值
+* @note FNV-1a折叠到16位
+*/
+static uint16_t device_env_hash(const char *name)
+{
+    uint32_t hash = 2166136261UL;
+
+    while (*name != '\0' && *name != '=') {
+        hash ^= (uint8_t)*name ++;
+        hash *= 16777619UL;
+    }
+
+    return (uint16_t)(hash ^ (hash >> 16));
+}
+
+/*
+* @brief 重建RAM索引
+* @param 无
+* @return 无
+* @note 环境变量内容变化后调用
+*/
+static void device_env_index_build(void)
+{
+    int i,next;
+    uint16_t hash,slot,probe;
+
+    memset(device_env_index,0,sizeof(device_env_index));
+    device_env_index_valid = true;
+    for (i = 0;i < DEVICE_ENV_DATA_SIZE_LIMIT && device_env_get_char(i) != '\0';i = next + 1) {
+        for (next = i;next < DEVICE_ENV_DATA_SIZE_LIMIT && device_env_get_char(next) != '\0';++ next);
+        if (next >= DEVICE_ENV_DATA_SIZE_LIMIT) {
+            break;
+        }
+        hash = device_env_hash(device_env_get_addr(i));
+        slot = hash & (DEVICE_ENV_INDEX_SIZE - 1);
+        for (probe = 0;probe < DEVICE_ENV_INDEX_SIZE;probe ++) {
+            if (device_env_index[slot].offset == 0) {
+                device_env_index[slot].hash = hash;
+                device_env_index[slot].offset = i + 1;
+                break;
+            }
+            slot = (slot + 1) & (DEVICE_ENV_INDEX_SIZE - 1);
+        }
+        if (probe == DEVICE_ENV_INDEX_SIZE) {
+            log_warning("env index full.use scan.\r\n");
+            device_env_index_valid = false;
+            return;
+        }
+    }
+}
+
+/*
+* @brief 通知环境变量变化
+* @param name 环境变量名
+* @param value 新的值,删除时为NULL
+* @return 无
+* @note
+*/
+static void device_env_notify(const char *name,const char *value)
+{
+    for (uint8_t i = 0;i < device_env_notify_cnt;i ++) {
+        if (device_env_notify_table[i].name == NULL || strcmp(device_env_notify_table[i].name,name) == 0) {
+            device_env_notify_table[i].notify(name,value);
+        }
+    }
+}
+
 /*
 * @brief 
 * @param
@@ -163,40 +262,609 @@ static int device_env_write(uint32_t addr,uint8_t *src,uint32_t size)
     if (rc != 0) {
         log_error("env write err.code:%d.\r\n",rc);
         return -1;
-    }  
-  
+    }  
+  
+    return 0;
+}
+
+/*
+* @brief 环境变量值和备份环境变量保存到非易存储体
+* @param 无
+* @return 0：成功 -1：失败
+* @note
+*/
+static int device_env_do_save(void) 
+{
+    int rc;
+
+    log_debug("do save...\r\n");
+    /*保存环境变量*/
+    rc = device_env_write(DEVICE_ENV_BASE_ADDR,(uint8_t*)&device_env,sizeof(device_env_t));
+    if (rc != 0) {
+        log_error("do save err.\r\n");
+        return -1;     
+    }
+#if DEVICE_ENV_USE_BACKUP > 0 
+    /*保存环境变量备份*/
+    rc = device_env_write(DEVICE_ENV_BACKUP_BASE_ADDR,(uint8_t*)&device_env,sizeof(device_env_t));
+    if (rc != 0) {
+        log_error("do backup save err.\r\n");
+        return -1;     
+    }    
+#endif
+
+    log_debug("do save ok.\r\n");
+    return 0;
+}
+
+#if DEVICE_ENV_USE_EEPROM > 0 && DEVICE_ENV_USE_LOG > 0
+/*
+* 记录区格式:区头 + 依次追加的记录
+* 区头: magic(2) crc(2) seq(4),crc覆盖magic和seq,区头有效且seq最大的区为当前区
+* 记录: tag(1) size(1) crc(2) payload(size),payload为"name=value"或者删除时的"name"
+* 记录的crc覆盖区的seq,size和payload,上一代留下的旧记录因seq不同而无效
+* 压缩时先作废另一个区的区头,再写入全部变量,最后写区头,掉电时旧区仍然有效
+*/
+#define  DEVICE_ENV_LOG_MAGIC              0x454C
+#define  DEVICE_ENV_LOG_HEADER_SIZE        8
+#define  DEVICE_ENV_LOG_RECORD_TAG         0xA5
+#define  DEVICE_ENV_LOG_RECORD_HEADER_SIZE 4
+#define  DEVICE_ENV_LOG_PAYLOAD_SIZE_MAX   255
+
+typedef struct
+{
+    uint32_t seq;   /*当前区的序号*/
+    uint8_t  area;  /*当前区 0或者1*/
+    uint16_t end;   /*下一条记录的位置*/
+    bool     valid; /*已经有有效的记录区*/
+}device_env_log_t;
+
+static device_env_log_t device_env_log;
+/*seq + size + payload,计算记录crc和回放时使用*/
+static uint8_t device_env_log_buffer[4 + 1 + DEVICE_ENV_LOG_PAYLOAD_SIZE_MAX + 1];
+
+static int device_env_apply(char *name,char *value);
+
+/*
+* @brief 记录区地址
+* @param area 区
+* @param offset 区内偏移
+* @return 地址
+* @note
+*/
+static uint32_t device_env_log_addr(uint8_t area,uint16_t offset)
+{
+    return DEVICE_ENV_LOG_BASE_ADDR + area * DEVICE_ENV_LOG_AREA_SIZE + offset;
+}
+
+/*
+* @brief 计算区头crc
+* @param header 区头
+* @return crc
+* @note
+*/
+static uint16_t device_env_log_header_crc(uint8_t *header)
+{
+    uint8_t buffer[6];
+
+    buffer[0] = header[0];
+    buffer[1] = header[1];
+    memcpy(&buffer[2],&header[4],4);
+
+    return calculate_crc16(buffer,6);
+}
+
+/*
+* @brief 读取区头
+* @param area 区
+* @param seq 区的序号
+* @return 0：有效 -1：无效
+* @note
+*/
+static int device_env_log_header_read(uint8_t area,uint32_t *seq)
+{
+    uint8_t header[DEVICE_ENV_LOG_HEADER_SIZE];
+
+    if (device_env_read(device_env_log_addr(area,0),header,DEVICE_ENV_LOG_HEADER_SIZE) != 0) {
+        return -1;
+    }
+    if ((header[0] | header[1] << 8) != DEVICE_ENV_LOG_MAGIC ||
+        (header[2] | header[3] << 8) != device_env_log_header_crc(header)) {
+        return -1;
+    }
+    memcpy(seq,&header[4],4);
+
+    return 0;
+}
+
+/*
+* @brief 写入区头
+* @param area 区
+* @param seq 区的序号,0表示作废区头
+* @return 0：成功 -1：失败
+* @note
+*/
+static int device_env_log_header_write(uint8_t area,uint32_t seq)
+{
+    uint16_t crc;
+    uint8_t header[DEVICE_ENV_LOG_HEADER_SIZE] = { 0 };
+
+    if (seq != 0) {
+        header[0] = DEVICE_ENV_LOG_MAGIC & 0xFF;
+        header[1] = DEVICE_ENV_LOG_MAGIC >> 8;
+        memcpy(&header[4],&seq,4);
+        crc = device_env_log_header_crc(header);
+        header[2] = crc & 0xFF;
+        header[3] = crc >> 8;
+    }
+
+    return device_env_write(device_env_log_addr(area,0),header,DEVICE_ENV_LOG_HEADER_SIZE);
+}
+
+/*
+* @brief 写入一条记录
+* @param area 区
+* @param offset 区内偏移
+* @param seq 区的序号
+* @param payload 记录内容
+* @param size 记录内容长度
+* @return 0：成功 -1：失败
+* @note
+*/
+static int device_env_log_record_write(uint8_t area,uint16_t offset,uint32_t seq,const char *payload,uint8_t size)
+{
+    int rc;
+    uint16_t crc;
+    uint8_t header[DEVICE_ENV_LOG_RECORD_HEADER_SIZE];
+
+    memcpy(&device_env_log_buffer[0],&seq,4);
+    device_env_log_buffer[4] = size;
+    memmove(&device_env_log_buffer[5],payload,size);
+    crc = calculate_crc16(device_env_log_buffer,5 + size);
+
+    header[0] = DEVICE_ENV_LOG_RECORD_TAG;
+    header[1] = size;
+    header[2] = crc & 0xFF;
+    header[3] = crc >> 8;
+    rc = device_env_write(device_env_log_addr(area,offset),header,DEVICE_ENV_LOG_RECORD_HEADER_SIZE);
+    if (rc != 0) {
+        return -1;
+    }
+
+    return device_env_write(device_env_log_addr(area,offset + DEVICE_ENV_LOG_RECORD_HEADER_SIZE),&device_env_log_buffer[5],size);
+}
+
+/*
+* @brief 回放记录区到RAM
+* @param area 区
+* @param seq 区的序号
+* @return 记录结束的位置
+* @note 遇到无效记录即认为是结尾,掉电时写了一半的记录会被丢弃
+*/
+static uint16_t device_env_log_replay(uint8_t area,uint32_t seq)
+{
+    uint16_t offset = DEVICE_ENV_LOG_HEADER_SIZE,crc;
+    uint8_t header[DEVICE_ENV_LOG_RECORD_HEADER_SIZE];
+    uint8_t size;
+    char *payload,*value;
+
+    memset(&device_env,0x00,sizeof(device_env_t));
+    while (offset + DEVICE_ENV_LOG_RECORD_HEADER_SIZE <= DEVICE_ENV_LOG_AREA_SIZE) {
+        if (device_env_read(device_env_log_addr(area,offset),header,DEVICE_ENV_LOG_RECORD_HEADER_SIZE) != 0) {
+            break;
+        }
+        size = header[1];
+        if (header[0] != DEVICE_ENV_LOG_RECORD_TAG || size == 0 ||
+            offset + DEVICE_ENV_LOG_RECORD_HEADER_SIZE + size > DEVICE_ENV_LOG_AREA_SIZE) {
+            break;
+        }
+        memcpy(&device_env_log_buffer[0],&seq,4);
+        device_env_log_buffer[4] = size;
+        if (device_env_read(device_env_log_addr(area,offset + DEVICE_ENV_LOG_RECORD_HEADER_SIZE),&device_env_log_buffer[5],size) != 0) {
+            break;
+        }
+        crc = calculate_crc16(device_env_log_buffer,5 + size);
+        if ((header[2] | header[3] << 8) != crc) {
+            break;
+        }
+        /*拆分名称和值*/
+        payload = (char *)&device_env_log_buffer[5];
+        payload[size] = '\0';
+        value = strchr(payload,'=');
+        if (value != NULL) {
+            *value ++ = '\0';
+        }
+        if (device_env_apply(payload,value) != 0) {
+            log_error("env log replay:%s err.\r\n",payload);
+        }
+        offset += DEVICE_ENV_LOG_RECORD_HEADER_SIZE + size;
+    }
+
+    return offset;
+}
+
+/*
+* @brief 从记录区加载环境变量
+* @param 无
+* @return 0：成功 -1：没有有效的记录区
+* @note
+*/
+static int device_env_log_load(void)
+{
+    int rc[2];
+    uint32_t seq[2];
+    uint8_t area;
+
+    rc[0] = device_env_log_header_read(0,&seq[0]);
+    rc[1] = device_env_log_header_read(1,&seq[1]);
+    if (rc[0] != 0 && rc[1] != 0) {
+        device_env_log.valid = false;
+        return -1;
+    }
+    if (rc[0] == 0 && rc[1] == 0) {
+        area = seq[1] > seq[0] ? 1 : 0;
+    } else {
+        area = rc[0] == 0 ? 0 : 1;
+    }
+    device_env_log.area = area;
+    device_env_log.seq = seq[area];
+    device_env_log.end = device_env_log_replay(area,seq[area]);
+    device_env_log.valid = true;
+    log_info("env log area:%d seq:%d end:%d.\r\n",area,device_env_log.seq,device_env_log.end);
+
+    return 0;
+}
+
+/*
+* @brief 把RAM中的全部环境变量压缩写入另一个记录区
+* @param 无
+* @return 0：成功 -1：失败
+* @note 区头最后写入,之前掉电仍然使用旧的记录区
+*/
+static int device_env_log_compact(void)
+{
+    int i,next;
+    uint8_t area;
+    uint16_t offset = DEVICE_ENV_LOG_HEADER_SIZE,size;
+    uint32_t seq;
+
+    area = device_env_log.valid == true ? device_env_log.area ^ 1 : 0;
+    seq = device_env_log.valid == true ? device_env_log.seq + 1 : 1;
+    /*序号不能为0*/
+    if (seq == 0) {
+        seq = 1;
+    }
+    log_debug("env log compact to area:%d seq:%d...\r\n",area,seq);
+    if (device_env_log_header_write(area,0) != 0) {
+        return -1;
+    }
+    for (i = 0;i < DEVICE_ENV_DATA_SIZE_LIMIT && device_env_get_char(i) != '\0';i = next + 1) {
+        for (next = i;next < DEVICE_ENV_DATA_SIZE_LIMIT && device_env_get_char(next) != '\0';++ next);
+        size = next - i;
+        if (size > DEVICE_ENV_LOG_PAYLOAD_SIZE_MAX || offset + DEVICE_ENV_LOG_RECORD_HEADER_SIZE + size > DEVICE_ENV_LOG_AREA_SIZE) {
+            log_error("env log compact entry size:%d err.\r\n",size);
+            return -1;
+        }
+        if (device_env_log_record_write(area,offset,seq,device_env_get_addr(i),size) != 0) {
+            return -1;
+        }
+        offset += DEVICE_ENV_LOG_RECORD_HEADER_SIZE + size;
+    }
+    if (device_env_log_header_write(area,seq) != 0) {
+        return -1;
+    }
+    device_env_log.area = area;
+    device_env_log.seq = seq;
+    device_env_log.end = offset;
+    device_env_log.valid = true;
+    log_debug("env log compact ok.end:%d.\r\n",offset);
+
+    return 0;
+}
+
+/*
+* @brief 追加一条记录
+* @param name 环境变量名
+* @param value 新的值,删除时为NULL
+* @return 0：成功 -1：失败
+* @note RAM已经更新;当前区放不下时压缩到另一个区
+*/
+static int device_env_log_append(char *name,char *value)
+{
+    uint16_t size;
+    char *payload = (char *)&device_env_log_buffer[5];
+
+    size = strlen(name) + (value != NULL ? strlen(value) + 1 : 0);
+    if (size > DEVICE_ENV_LOG_PAYLOAD_SIZE_MAX || device_env_log.valid == false ||
+        device_env_log.end + DEVICE_ENV_LOG_RECORD_HEADER_SIZE + size > DEVICE_ENV_LOG_AREA_SIZE) {
+        return device_env_log_compact();
+    }
+    /*先组合到缓存,写入时再复制到crc计算的位置*/
+    strcpy(payload,name);
+    if (value != NULL) {
+        strcat(payload,"=");
+        strcat(payload,value);
+    }
+    if (device_env_log_record_write(device_env_log.area,device_env_log.end,device_env_log.seq,payload,size) != 0) {
+        return -1;
+    }
+    device_env_log.end += DEVICE_ENV_LOG_RECORD_HEADER_SIZE + size;
+
+    return 0;
+}
+
+/*
+* bootloader只读写旧格式的环境变量和备份,不认识记录区.
+* bootloader使用的环境变量在追加记录后再把RAM整个写入旧格式,
+* 复位后以旧格式中的值为准同步到记录区:写旧格式时掉电,bootloader和应用都使用旧的值.
+*/
+static const char * const device_env_bootloader_name[] = {
+    ENV_BOOTLOADER_FLAG_NAME,
+    ENV_BOOTLOADER_UPDATE_SIZE_NAME,
+    ENV_BOOTLOADER_APPLICATION_SIZE_NAME,
+    ENV_BOOTLOADER_BACKUP_SIZE_NAME,
+    ENV_BOOTLOADER_UPDATE_MD5_NAME,
+    ENV_BOOTLOADER_APPLICATION_MD5_NAME,
+    ENV_BOOTLOADER_BACKUP_MD5_NAME
+};
+
+/*
+* @brief 是否为bootloader使用的环境变量
+* @param name 环境变量名
+* @return true 是 false 不是
+* @note
+*/
+static bool device_env_is_bootloader(const char *name)
+{
+    for (uint8_t i = 0;i < sizeof(device_env_bootloader_name) / sizeof(device_env_bootloader_name[0]);i ++) {
+        if (strcmp(device_env_bootloader_name[i],name) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+* @brief 按bootloader的恢复规则读取旧格式环境变量
+* @param env 读取缓存
+* @return 0：成功 -1：环境变量和备份都无效
+* @note 环境变量有效时以它为准,否则使用备份
+*/
+static int device_env_legacy_read(device_env_t *env)
+{
+    if (device_env_read(DEVICE_ENV_BASE_ADDR,(uint8_t*)env,sizeof(device_env_t)) == 0 &&
+        device_env_crc_check(env) == 0) {
+        return 0;
+    }
+#if DEVICE_ENV_USE_BACKUP > 0
+    if (device_env_read(DEVICE_ENV_BACKUP_BASE_ADDR,(uint8_t*)env,sizeof(device_env_t)) == 0 &&
+        device_env_crc_check(env) == 0) {
+        return 0;
+    }
+#endif
+
+    return -1;
+}
+
+/*
+* @brief 在旧格式环境变量中查找
+* @param env 旧格式环境变量
+* @param name 环境变量名
+* @return 环境变量值 or null
+* @note
+*/
+static char *device_env_legacy_get(device_env_t *env,const char *name)
+{
+    int i,next,len = strlen(name);
+    char *entry;
+
+    for (i = 0;i < DEVICE_ENV_DATA_SIZE_LIMIT && env->data_region[i] != '\0';i = next + 1) {
+        for (next = i;next < DEVICE_ENV_DATA_SIZE_LIMIT && env->data_region[next] != '\0';++ next);
+        if (next >= DEVICE_ENV_DATA_SIZE_LIMIT) {
+            break;
+        }
+        entry = (char *)&env->data_region[i];
+        if (strncmp(entry,name,len) == 0 && entry[len] == '=') {
+            return entry + len + 1;
+        }
+    }
+
+    return NULL;
+}
+
+/*
+* @brief 旧格式中bootloader使用的环境变量同步到RAM和记录区
+* @param 无
+* @return 0：成功 -1：失败
+* @note 记录区加载后调用;旧格式的值为准,旧格式都无效时由RAM重新写入
+*/
+static int device_env_legacy_sync(void)
+{
+    int rc;
+    char *name,*legacy,*value;
+
+    if (device_env_legacy_read(&device_env_backup) != 0) {
+        log_info("legacy env bad.rewrite...\r\n");
+        return device_env_do_save();
+    }
+    for (uint8_t i = 0;i < sizeof(device_env_bootloader_name) / sizeof(device_env_bootloader_name[0]);i ++) {
+        name = (char *)device_env_bootloader_name[i];
+        legacy = device_env_legacy_get(&device_env_backup,name);
+        value = device_env_find(name);
+        if (legacy == value || (legacy != NULL && value != NULL && strcmp(legacy,value) == 0)) {
+            continue;
+        }
+        log_info("env %s from legacy:%s.\r\n",name,legacy != NULL ? legacy : "deleted");
+        rc = device_env_apply(name,legacy);
+        if (rc < 0) {
+            return -1;
+        }
+        device_env_crc_update();
+        device_env_index_build();
+        if (device_env_log_append(name,rc > 0 ? NULL : legacy) != 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+#endif
+
+/*
+* @brief 保存一个环境变量
+* @param name 环境变量名
+* @param value 新的值,删除时为NULL
+* @return 0：成功 -1：失败
+* @note RAM已经更新;使用记录区时追加一条记录,bootloader使用的环境变量再写入旧格式;否则保存整个环境变量
+*/
+static int device_env_persist(char *name,char *value)
+{
+#if DEVICE_ENV_USE_EEPROM > 0 && DEVICE_ENV_USE_LOG > 0
+    if (device_env_log_append(name,value) != 0) {
+        return -1;
+    }
+    return device_env_is_bootloader(name) ? device_env_do_save() : 0;
+#else
+    return device_env_do_save();
+#endif
+}
+
+#if DEVICE_ENV_USE_WRITE_BACK > 0
+/*
+* 写回:使能后设置只更新RAM并记下名称,写回任务在设置停止一段时间后一次保存.
+* 同一个环境变量多次设置只保存最后的值,按最后一次设置的顺序保存.
+* RAM和缓存由互斥量保护,使能前只有一个任务访问,不加锁.
+*/
+typedef struct
+{
+    bool enable;
+    device_env_dirty_t dirty;
+    osMutexId mutex;
+    uint8_t cnt;
+    char name[DEVICE_ENV_DIRTY_CNT_MAX][DEVICE_ENV_DIRTY_NAME_SIZE_MAX];
+}device_env_write_back_t;
+
+static device_env_write_back_t device_env_write_back;
+static osStaticMutexDef_t device_env_mutex_cb;
+
+/*
+* @brief 环境变量加锁
+* @param 无
+* @return 无
+* @note
+*/
+static void device_env_lock(void)
+{
+    if (device_env_write_back.mutex != NULL) {
+        osMutexWait(device_env_write_back.mutex,osWaitForever);
+    }
+}
+
+/*
+* @brief 环境变量解锁
+* @param 无
+* @return 无
+* @note
+*/
+static void device_env_unlock(void)
+{
+    if (device_env_write_back.mutex != NULL) {
+        osMutexRelease(device_env_write_back.mutex);
+    }
+}
+
+/*
+* @brief 保存写回缓存中的环境变量
+* @param 无
+* @return 0：成功 -1：失败
+* @note 已加锁;失败的和之后的留在缓存中下次保存
+*/
+static int device_env_dirty_save(void)
+{
+    uint8_t i;
+
+#if DEVICE_ENV_USE_EEPROM > 0 && DEVICE_ENV_USE_LOG > 0
+    bool legacy = false;
+
+    for (i = 0;i < device_env_write_back.cnt;i ++) {
+        if (device_env_log_append(device_env_write_back.name[i],device_env_find(device_env_write_back.name[i])) != 0) {
+            break;
+        }
+        legacy = legacy || device_env_is_bootloader(device_env_write_back.name[i]);
+    }
+    /*bootloader使用的环境变量一次写入旧格式,失败时留在缓存中重新保存*/
+    if (legacy == true && device_env_do_save() != 0) {
+        i = 0;
+    }
+#else
+    /*整个环境变量一次保存*/
+    i = 0;
+    if (device_env_write_back.cnt > 0 && device_env_do_save() == 0) {
+        i = device_env_write_back.cnt;
+    }
+#endif
+    if (i > 0) {
+        memmove(device_env_write_back.name[0],device_env_write_back.name[i],(device_env_write_back.cnt - i) * DEVICE_ENV_DIRTY_NAME_SIZE_MAX);
+        device_env_write_back.cnt -= i;
+        log_debug("env write back %d saved.\r\n",i);
+    }
+    if (device_env_write_back.cnt > 0) {
+        log_error("env write back save err.left:%d.\r\n",device_env_write_back.cnt);
+        return -1;
+    }
+
+    return 0;
+}
+
+/*
+* @brief 记下需要保存的环境变量
+* @param name 环境变量名
+* @return 0：成功 -1：失败
+* @note 已加锁;已经在缓存中的移到最后;缓存满或者名称太长时先保存缓存,保持保存顺序
+*/
+static int device_env_dirty_add(char *name)
+{
+    uint8_t i;
+
+    for (i = 0;i < device_env_write_back.cnt;i ++) {
+        if (strcmp(device_env_write_back.name[i],name) == 0) {
+            memmove(device_env_write_back.name[i],device_env_write_back.name[i + 1],(device_env_write_back.cnt - i - 1) * DEVICE_ENV_DIRTY_NAME_SIZE_MAX);
+            device_env_write_back.cnt --;
+            break;
+        }
+    }
+    if (strlen(name) >= DEVICE_ENV_DIRTY_NAME_SIZE_MAX) {
+        if (device_env_dirty_save() != 0) {
+            return -1;
+        }
+        return device_env_persist(name,device_env_find(name));
+    }
+    if (device_env_write_back.cnt >= DEVICE_ENV_DIRTY_CNT_MAX && device_env_dirty_save() != 0) {
+        return -1;
+    }
+    strcpy(device_env_write_back.name[device_env_write_back.cnt],name);
+    device_env_write_back.cnt ++;
+
     return 0;
 }
 
 /*
-* @brief 环境变量值和备份环境变量保存到非易存储体
-* @param 无
-* @return 0：成功 -1：失败
-* @note
+* @brief 通知写回任务
+* @param now true:需要尽快保存 false:重新开始安静计时
+* @return 无
+* @note 不加锁调用
 */
-static int device_env_do_save(void) 
+static void device_env_dirty_kick(bool now)
 {
-    int rc;
-
-    log_debug("do save...\r\n");
-    /*保存环境变量*/
-    rc = device_env_write(DEVICE_ENV_BASE_ADDR,(uint8_t*)&device_env,sizeof(device_env_t));
-    if (rc != 0) {
-        log_error("do save err.\r\n");
-        return -1;     
+    if (device_env_write_back.enable == true) {
+        device_env_write_back.dirty(now);
     }
-#if DEVICE_ENV_USE_BACKUP > 0 
-    /*保存环境变量备份*/
-    rc = device_env_write(DEVICE_ENV_BACKUP_BASE_ADDR,(uint8_t*)&device_env,sizeof(device_env_t));
-    if (rc != 0) {
-        log_error("do backup save err.\r\n");
-        return -1;     
-    }    
-#endif
-
-    log_debug("do save ok.\r\n");
-    return 0;
 }
+#else
+#define  device_env_lock()
+#define  device_env_unlock()
+#endif
 
 /*
 * @brief 环境变量初始化
@@ -223,6 +891,20 @@ int device_env_init(void)
         log_error("env if init err.\r\n");
         return -1;
     }
+#if DEVICE_ENV_USE_EEPROM > 0 && DEVICE_ENV_USE_LOG > 0
+    /*优先使用记录区,没有时从旧格式迁移*/
+    if (device_env_log_load() == 0) {
+        device_env_crc_update();
+        device_env_index_build();
+        if (device_env_legacy_sync() != 0) {
+            log_error("env legacy sync err.\r\n");
+            return -1;
+        }
+        log_info("device env init ok.\r\n");
+        return 0;
+    }
+    log_info("env log not exsit.migrate...\r\n");
+#endif
     log_debug("read env...\r\n");    
     /*读取环境变量*/
     rc = device_env_read(DEVICE_ENV_BASE_ADDR,(uint8_t*)&device_env,sizeof(device_env_t));
@@ -293,23 +975,50 @@ int device_env_init(void)
     }    
 #endif
 
+#if DEVICE_ENV_USE_EEPROM > 0 && DEVICE_ENV_USE_LOG > 0
+    /*旧格式的内容写入记录区,旧格式之后不再更新*/
+    rc = device_env_log_compact();
+    if (rc != 0) {
+        log_error("env log migrate err.\r\n");
+        return -1;
+    }
+    log_info("env log migrate ok.\r\n");
+#endif
+    device_env_index_build();
     log_info("device env init ok.\r\n");
     return 0;
 }
 
 /*
-* @brief 环境变量完全清除
+* @brief 清除RAM和存储中的环境变量
 * @param 无
 * @return 0：成功 -1：失败
-* @note
+* @note 已加锁;使用记录区时分两步清除,之间掉电复位后只保留bootloader使用的环境变量
 */
-int device_env_clear(void) 
+static int device_env_erase(void) 
 {
     int rc;
 
     log_info("clear env...\r\n");
 
     memset(&device_env,0x00,sizeof(device_env_t));
+    device_env_index_build();
+#if DEVICE_ENV_USE_EEPROM > 0 && DEVICE_ENV_USE_LOG > 0
+    /*压缩一个空的记录区即清除,再清除bootloader使用的旧格式*/
+    rc = device_env_log_compact();
+    if (rc != 0) {
+        log_error("clear env log err.\r\n");
+        return -1;
+    }
+    device_env_crc_update();
+    rc = device_env_do_save();
+    if (rc != 0) {
+        log_error("clear legacy env err.\r\n");
+        return -1;
+    }
+    log_info("clear env ok.\r\n");
+    return 0;
+#endif
     /*写入环境变量*/
     rc = device_env_write(DEVICE_ENV_BASE_ADDR,(uint8_t*)&device_env,sizeof(device_env_t));
     if (rc != 0) {
@@ -332,12 +1041,32 @@ int device_env_clear(void)
 }
 
 /*
-* @brief 获取对应名称的环境变量值
+* @brief 环境变量完全清除
+* @param 无
+* @return 0：成功 -1：失败
+* @note 同步清除,写回缓存中未保存的设置丢弃
+*/
+int device_env_clear(void) 
+{
+    int rc;
+
+    device_env_lock();
+#if DEVICE_ENV_USE_WRITE_BACK > 0
+    device_env_write_back.cnt = 0;
+#endif
+    rc = device_env_erase();
+    device_env_unlock();
+
+    return rc;
+}
+
+/*
+* @brief 逐字符查找对应名称的环境变量值
 * @param name 环境变量名
 * @return 环境变量值 or null
-* @note
+* @note 索引无效时使用
 */
-char *device_env_get(char *name) 
+static char *device_env_scan(char *name) 
 {
     int i, next;
     for (i=0; device_env_get_char(i) != '\0'; i = next + 1) {
@@ -358,13 +1087,114 @@ char *device_env_get(char *name)
 }
 
 /*
-* @brief 设置环境变量值
+* @brief 查找对应名称的环境变量值
 * @param name 环境变量名
-* @param value 环境变量值
+* @return 环境变量值 or null
+* @note 已加锁;通过RAM索引查找,不访问存储体
+*/
+static char *device_env_find(char *name) 
+{
+    int val;
+    uint16_t hash,slot;
+
+    if (device_env_index_valid == false) {
+        return device_env_scan(name);
+    }
+    hash = device_env_hash(name);
+    slot = hash & (DEVICE_ENV_INDEX_SIZE - 1);
+    for (uint16_t probe = 0;probe < DEVICE_ENV_INDEX_SIZE && device_env_index[slot].offset != 0;probe ++) {
+        if (device_env_index[slot].hash == hash && (val = device_env_match(name,device_env_index[slot].offset - 1)) >= 0) {
+            return device_env_get_addr(val);
+        }
+        slot = (slot + 1) & (DEVICE_ENV_INDEX_SIZE - 1);
+    }
+
+    return (NULL);
+}
+
+/*
+* @brief 获取对应名称的环境变量值
+* @param name 环境变量名
+* @return 环境变量值 or null
+* @note 返回RAM中的位置,之后的设置会移动或者改写它;其他任务可能同时设置时使用device_env_get_copy
+*/
+char *device_env_get(char *name) 
+{
+    char *value;
+
+    device_env_lock();
+    value = device_env_find(name);
+    device_env_unlock();
+
+    return value;
+}
+
+/*
+* @brief 复制对应名称的环境变量值
+* @param name 环境变量名
+* @param buffer 值缓存
+* @param size 缓存大小
+* @return >=0：值的长度 -1：不存在或者缓存不足
+* @note 加锁复制,可以和其他任务的设置同时使用
+*/
+int device_env_get_copy(char *name,char *buffer,uint16_t size)
+{
+    char *value;
+    int len = -1;
+
+    device_env_lock();
+    value = device_env_find(name);
+    if (value != NULL) {
+        len = strlen(value);
+        if (len < size) {
+            memcpy(buffer,value,len + 1);
+        } else {
+            log_error("env:%s buffer size:%d too small.\r\n",name,size);
+            len = -1;
+        }
+    }
+    device_env_unlock();
+
+    return len;
+}
+
+/*
+* @brief 环境变量变化后更新校验,索引并保存
+* @param name 环境变量名
+* @param value 新的值,删除时为NULL
 * @return 0：成功 -1：失败
-* @note
+* @note 已加锁;保存成功后通知,写回使能后只记下名称
 */
-int device_env_set(char *name,char *value) 
+static int device_env_commit(char *name,char *value)
+{
+    int rc;
+
+    device_env_crc_update();
+    device_env_index_build();
+#if DEVICE_ENV_USE_WRITE_BACK > 0
+    if (device_env_write_back.enable == true) {
+        rc = device_env_dirty_add(name);
+    } else {
+        rc = device_env_persist(name,value);
+    }
+#else
+    rc = device_env_persist(name,value);
+#endif
+    if (rc == 0) {
+        device_env_notify(name,value);
+    }
+
+    return rc;
+}
+
+/*
+* @brief 在RAM中设置环境变量值
+* @param name 环境变量名
+* @param value 环境变量值,NULL表示删除
+* @return 0：成功 1：空间不足,旧值已删除 -1：名称非法
+* @note 不更新校验和索引,不保存
+*/
+static int device_env_apply(char *name,char *value) 
 {
     int  len, oldval;
 
@@ -410,8 +1240,7 @@ int device_env_set(char *name,char *value)
     }
     /* Delete only ? */
     if (value == NULL) {
-        device_env_crc_update();
-        return device_env_do_save();
+        return 0;
     }
 
     /*
@@ -434,7 +1263,9 @@ int device_env_set(char *name,char *value)
         log_error("Error: environment overflow, \"%s\" deleted\n", name);
         return 1;
     }
-    while ((*env = *name++) != '\0') {
+    char *key = name;
+
+    while ((*env = *key++) != '\0') {
         env++;
     }
 
@@ -448,7 +1279,285 @@ int device_env_set(char *name,char *value)
     /* end is marked with double '\0' */
     *++env = '\0';
 
-    /* Update CRC */
-    device_env_crc_update();
-    return device_env_do_save();
+    return 0;
+}
+
+/*
+* @brief 设置环境变量值
+* @param name 环境变量名
+* @param value 环境变量值
+* @return 0：成功 1：空间不足,旧值已删除 -1：失败
+* @note 写回使能后只更新RAM,由写回任务保存
+*/
+int device_env_set(char *name,char *value) 
+{
+    int rc;
+
+    device_env_lock();
+    rc = device_env_apply(name,value);
+    if (rc > 0) {
+        /*旧值已经删除,RAM和存储保持一致*/
+        device_env_commit(name,NULL);
+    } else if (rc == 0) {
+        /* Update CRC, index and save */
+        rc = device_env_commit(name,value);
+    }
+    device_env_unlock();
+#if DEVICE_ENV_USE_WRITE_BACK > 0
+    if (rc >= 0) {
+        device_env_dirty_kick(false);
+    }
+#endif
+
+    return rc;
+}
+
+/*
+* @brief 获取整数环境变量
+* @param name 环境变量名
+* @param value 整数值指针
+* @return 0：成功 -1：不存在或者不是整数
+* @note 支持10进制和0x开头的16进制;加锁转换
+*/
+int device_env_get_int(char *name,int32_t *value)
+{
+    char *str,*end;
+    long result;
+    int rc = -1;
+
+    device_env_lock();
+    str = device_env_find(name);
+    if (str != NULL) {
+        result = strtol(str,&end,0);
+        if (end == str || *end != '\0') {
+            log_error("env:%s=%s not int.\r\n",name,str);
+        } else {
+            *value = (int32_t)result;
+            rc = 0;
+        }
+    }
+    device_env_unlock();
+
+    return rc;
+}
+
+/*
+* @brief 设置整数环境变量
+* @param name 环境变量名
+* @param value 整数值
+* @return 0：成功 -1：失败
+* @note 以10进制保存
+*/
+int device_env_set_int(char *name,int32_t value)
+{
+    char str_buffer[12];
+
+    snprintf(str_buffer,sizeof(str_buffer),"%d",(int)value);
+    return device_env_set(name,str_buffer) == 0 ? 0 : -1;
+}
+
+/*
+* @brief 获取浮点环境变量
+* @param name 环境变量名
+* @param value 浮点值指针
+* @return 0：成功 -1：不存在或者不是数值
+* @note 加锁转换
+*/
+int device_env_get_float(char *name,float *value)
+{
+    char *str,*end;
+    double result;
+    int rc = -1;
+
+    device_env_lock();
+    str = device_env_find(name);
+    if (str != NULL) {
+        result = strtod(str,&end);
+        if (end == str || *end != '\0') {
+            log_error("env:%s=%s not float.\r\n",name,str);
+        } else {
+            *value = (float)result;
+            rc = 0;
+        }
+    }
+    device_env_unlock();
+
+    return rc;
+}
+
+/*
+* @brief 设置浮点环境变量
+* @param name 环境变量名
+* @param value 浮点值
+* @return 0：成功 -1：失败
+* @note 保存6位有效数字
+*/
+int device_env_set_float(char *name,float value)
+{
+    char str_buffer[16];
+
+    snprintf(str_buffer,sizeof(str_buffer),"%.6g",value);
+    return device_env_set(name,str_buffer) == 0 ? 0 : -1;
+}
+
+/*
+* @brief 16进制字符转换为数值
+* @param c 字符
+* @return 0-15：数值 -1：不是16进制字符
+* @note
+*/
+static int device_env_hex_value(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+
+    return -1;
 }
+
+/*
+* @brief 获取字节环境变量
+* @param name 环境变量名
+* @param buffer 数据缓存
+* @param size 缓存大小
+* @return >=0：数据长度 -1：不存在,格式错误或者缓存不足
+* @note 值以16进制字符串保存;加锁转换
+*/
+int device_env_get_bytes(char *name,uint8_t *buffer,uint16_t size)
+{
+    char *str;
+    int hi,lo,rc = -1;
+    uint16_t len;
+
+    device_env_lock();
+    str = device_env_find(name);
+    if (str == NULL) {
+        goto exit;
+    }
+    len = strlen(str);
+    if ((len & 1) != 0 || len / 2 > size) {
+        log_error("env:%s bytes size err.\r\n",name);
+        goto exit;
+    }
+    for (uint16_t i = 0;i < len / 2;i ++) {
+        hi = device_env_hex_value(str[i * 2]);
+        lo = device_env_hex_value(str[i * 2 + 1]);
+        if (hi < 0 || lo < 0) {
+            log_error("env:%s not hex.\r\n",name);
+            goto exit;
+        }
+        buffer[i] = (uint8_t)(hi << 4 | lo);
+    }
+    rc = len / 2;
+
+exit:
+    device_env_unlock();
+    return rc;
+}
+
+/*
+* @brief 设置字节环境变量
+* @param name 环境变量名
+* @param data 数据
+* @param size 数据长度
+* @return 0：成功 -1：失败
+* @note 值以16进制字符串保存,占用2倍空间
+*/
+int device_env_set_bytes(char *name,const uint8_t *data,uint16_t size)
+{
+    static const char hex[] = "0123456789abcdef";
+    char str_buffer[DEVICE_ENV_BYTES_SIZE_MAX * 2 + 1];
+
+    if (size > DEVICE_ENV_BYTES_SIZE_MAX) {
+        log_error("env:%s bytes size:%d too large.\r\n",name,size);
+        return -1;
+    }
+    for (uint16_t i = 0;i < size;i ++) {
+        str_buffer[i * 2] = hex[data[i] >> 4];
+        str_buffer[i * 2 + 1] = hex[data[i] & 0x0F];
+    }
+    str_buffer[size * 2] = '\0';
+
+    return device_env_set(name,str_buffer) == 0 ? 0 : -1;
+}
+
+/*
+* @brief 注册环境变量变化通知
+* @param name 关心的环境变量名,NULL表示全部
+* @param notify 通知函数
+* @return 0：成功 -1：失败
+* @note 只有device_env_set保存成功后才通知,写回使能后在RAM更新后通知;name需要一直有效
+*/
+int device_env_register_notify(const char *name,device_env_notify_t notify)
+{
+    if (notify == NULL || device_env_notify_cnt >= DEVICE_ENV_NOTIFY_CNT_MAX) {
+        log_error("env notify register err.\r\n");
+        return -1;
+    }
+    device_env_notify_table[device_env_notify_cnt].name = name;
+    device_env_notify_table[device_env_notify_cnt].notify = notify;
+    device_env_notify_cnt ++;
+
+    return 0;
+}
+
+#if DEVICE_ENV_USE_WRITE_BACK > 0
+/*
+* @brief 使能写回
+* @param dirty 有环境变量需要保存时的通知,由写回任务安排保存
+* @return 0：成功 -1：失败
+* @note 在启动调度前调用;之前的设置直接保存,bootloader不使能
+*/
+int device_env_write_back_enable(device_env_dirty_t dirty)
+{
+    osMutexStaticDef(device_env_mutex,&device_env_mutex_cb);
+
+    if (dirty == NULL) {
+        return -1;
+    }
+    device_env_write_back.mutex = osMutexCreate(osMutex(device_env_mutex));
+    if (device_env_write_back.mutex == NULL) {
+        log_error("env mutex create err.\r\n");
+        return -1;
+    }
+    device_env_write_back.dirty = dirty;
+    device_env_write_back.enable = true;
+
+    return 0;
+}
+
+/*
+* @brief 请求尽快保存写回缓存
+* @param 无
+* @return 无
+* @note 不等待,由写回任务保存
+*/
+void device_env_flush(void)
+{
+    device_env_dirty_kick(true);
+}
+
+/*
+* @brief 保存之前的全部设置
+* @param 无
+* @return 0：成功 -1：失败
+* @note 在调用者的任务中同步保存;返回0后之前的设置都已保存,之后的设置不会先于它们保存.
+*       bootloader标志和复位前使用
+*/
+int device_env_barrier(void)
+{
+    int rc;
+
+    device_env_lock();
+    rc = device_env_dirty_save();
+    device_env_unlock();
+
+    return rc;
+}
+#endif
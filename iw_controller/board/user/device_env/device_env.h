@@ -1,5 +1,7 @@
 #ifndef  __DEVICE_ENV_H__
 #define  __DEVICE_ENV_H__
+#include "stdint.h"
+#include "stdbool.h"
 
 #ifdef  __cplusplus
 extern "C" {
@@ -8,6 +10,12 @@ extern "C" {
 /********************    配置设备环境开始    **************************************/
 #define  DEVICE_ENV_USE_BACKUP                 1            /*是否使用环境变量备份*/
 #define  DEVICE_ENV_USE_EEPROM                 1            /*是否使用EEPROM保存环境变量 如果是否 则使用flash*/
+#define  DEVICE_ENV_INDEX_SIZE                 32           /*RAM索引的槽数量,2的幂,需要大于环境变量数量*/
+#define  DEVICE_ENV_NOTIFY_CNT_MAX             4            /*可注册的变化通知数量*/
+#define  DEVICE_ENV_BYTES_SIZE_MAX             32           /*字节环境变量的最大长度 bytes*/
+#define  DEVICE_ENV_USE_WRITE_BACK             1            /*是否支持写回:使能后设置只更新RAM,由写回任务合并保存,需要RTOS*/
+#define  DEVICE_ENV_DIRTY_CNT_MAX              8            /*写回缓存的未保存环境变量数量,满了在设置时立即保存*/
+#define  DEVICE_ENV_DIRTY_NAME_SIZE_MAX        20           /*写回缓存的环境变量名最大长度(含结束符),更长的名称立即保存*/
 
 #define  DEVICE_MIN_ERASE_SIZE                 256          /*最小擦除单元大小 bytes*/
 #define  DEVICE_ADDR_MAP_LIMIT                 0x00080000   /*设备最大地址映射*/  
@@ -23,11 +31,18 @@ extern "C" {
 
 #define  APPLICATION_UPDATE_BASE_ADDR          0x00038000UL /*application更新基地址*/
 
+#define  HISTORY_BASE_ADDR                     0x00058000UL /*历史记录基地址,在更新区和flash环境变量之后*/
+#define  HISTORY_SIZE_LIMIT                    0x28000      /*历史记录最大容量*/
+
 /*使用eeprom*/
 #if  DEVICE_ENV_USE_EEPROM  > 0
 #define  DEVICE_ENV_BASE_ADDR                  0x40108000   /*环境变量基地址*/   
 #define  DEVICE_ENV_BACKUP_BASE_ADDR           0x40108200   /*环境变量备份基地址*/      
 #define  DEVICE_ENV_SIZE_LIMIT                 0x200        /*环境变量大小*/ 
+#define  DEVICE_ENV_USE_LOG                    1            /*是否以追加记录的方式保存环境变量,bootloader使用的环境变量同时写入旧格式*/
+#define  DEVICE_ENV_LOG_BASE_ADDR              0x40108400   /*环境变量记录区基地址,在旧格式环境变量和备份之后*/
+#define  DEVICE_ENV_LOG_AREA_SIZE              0x1000       /*每个记录区大小,2个记录区交替压缩*/
+#define  DEVICE_ENV_EEPROM_LIMIT               0x4010C000   /*EEPROM结束地址*/
 /*使用flash*/
 #else
 
@@ -61,8 +76,30 @@ extern "C" {
 #endif
 
 
+#if  (APPLICATION_UPDATE_BASE_ADDR + APPLICATION_SIZE_LIMIT) > HISTORY_BASE_ADDR
+#error "history base addr too small."
+#endif
+
+#if  (HISTORY_BASE_ADDR + HISTORY_SIZE_LIMIT) > DEVICE_ADDR_MAP_LIMIT
+#error "history limit addr large than device addr map."
+#endif
+
+#if  DEVICE_ENV_USE_EEPROM > 0 && DEVICE_ENV_USE_LOG > 0
+#if  (DEVICE_ENV_BACKUP_BASE_ADDR + DEVICE_ENV_SIZE_LIMIT) > DEVICE_ENV_LOG_BASE_ADDR
+#error "device env log base addr too small."
+#endif
+
+#if  (DEVICE_ENV_LOG_BASE_ADDR + DEVICE_ENV_LOG_AREA_SIZE * 2) > DEVICE_ENV_EEPROM_LIMIT
+#error "device env log limit addr large than eeprom."
+#endif
+#endif
+
 #if  DEVICE_ENV_USE_EEPROM == 0 
 
+#if  (DEVICE_ENV_BACKUP_BASE_ADDR + DEVICE_ENV_SIZE_LIMIT) > HISTORY_BASE_ADDR
+#error "history base addr too small for flash env."
+#endif
+
 #if  DEVICE_ENV_USE_BACKUP > 0
 #if  (DEVICE_ENV_BASE_ADDR + DEVICE_ENV_SIZE_LIMIT) > DEVICE_ENV_BACKUP_BASE_ADDR
 #error "device env backup base addr too small."
@@ -74,7 +111,7 @@ extern "C" {
 
 #else 
 #if  (DEVICE_ENV_BASE_ADDR + DEVICE_ENV_SIZE_LIMIT) > DEVICE_ADDR_MAP_LIMIT
-#error "device env base limit addr large than device addr map."."
+#error "device env base limit addr large than device addr map."
 #endif
 
 #endif
@@ -99,6 +136,24 @@ extern "C" {
 
 
 
+/*
+* @brief 环境变量变化通知
+* @param name 环境变量名
+* @param value 新的值,删除时为NULL
+* @return 无
+* @note 在调用device_env_set的任务中加锁执行,不能再设置或者获取环境变量
+*/
+typedef void (*device_env_notify_t)(const char *name,const char *value);
+
+/*
+* @brief 写回时有环境变量需要保存
+* @param now true:需要尽快保存 false:重新开始安静计时
+* @return 无
+* @note 在设置环境变量的任务中执行,不能阻塞
+*/
+typedef void (*device_env_dirty_t)(bool now);
+
+
 /*
 * @brief 环境变量初始化
 * @param 无
@@ -119,18 +174,120 @@ int device_env_clear(void);
 * @brief 获取对应名称的环境变量值
 * @param name 环境变量名
 * @return 环境变量值 or null
-* @note
+* @note 返回RAM中的位置,之后的设置会移动或者改写它;其他任务可能同时设置时使用device_env_get_copy
 */
 char *device_env_get(char *name);
 
+/*
+* @brief 复制对应名称的环境变量值
+* @param name 环境变量名
+* @param buffer 值缓存
+* @param size 缓存大小
+* @return >=0：值的长度 -1：不存在或者缓存不足
+* @note 加锁复制,可以和其他任务的设置同时使用
+*/
+int device_env_get_copy(char *name,char *buffer,uint16_t size);
+
 /*
 * @brief 设置环境变量值
 * @param name 环境变量名
 * @param value 环境变量值
+* @return 0：成功 1：空间不足,旧值已删除 -1：失败
+* @note 写回使能后只更新RAM,由写回任务保存;顺序有要求或者复位前使用device_env_barrier
+*/
+int device_env_set(char *name,char *value);
+
+/*
+* @brief 获取整数环境变量
+* @param name 环境变量名
+* @param value 整数值指针
+* @return 0：成功 -1：不存在或者不是整数
+* @note 支持10进制和0x开头的16进制
+*/
+int device_env_get_int(char *name,int32_t *value);
+
+/*
+* @brief 设置整数环境变量
+* @param name 环境变量名
+* @param value 整数值
 * @return 0：成功 -1：失败
+* @note 以10进制保存
+*/
+int device_env_set_int(char *name,int32_t value);
+
+/*
+* @brief 获取浮点环境变量
+* @param name 环境变量名
+* @param value 浮点值指针
+* @return 0：成功 -1：不存在或者不是数值
 * @note
 */
-int device_env_set(char *name,char *value);
+int device_env_get_float(char *name,float *value);
+
+/*
+* @brief 设置浮点环境变量
+* @param name 环境变量名
+* @param value 浮点值
+* @return 0：成功 -1：失败
+* @note 保存6位有效数字
+*/
+int device_env_set_float(char *name,float value);
+
+/*
+* @brief 获取字节环境变量
+* @param name 环境变量名
+* @param buffer 数据缓存
+* @param size 缓存大小
+* @return >=0：数据长度 -1：不存在,格式错误或者缓存不足
+* @note 值以16进制字符串保存
+*/
+int device_env_get_bytes(char *name,uint8_t *buffer,uint16_t size);
+
+/*
+* @brief 设置字节环境变量
+* @param name 环境变量名
+* @param data 数据
+* @param size 数据长度
+* @return 0：成功 -1：失败
+* @note 值以16进制字符串保存,占用2倍空间
+*/
+int device_env_set_bytes(char *name,const uint8_t *data,uint16_t size);
+
+/*
+* @brief 注册环境变量变化通知
+* @param name 关心的环境变量名,NULL表示全部
+* @param notify 通知函数
+* @return 0：成功 -1：失败
+* @note 只有device_env_set保存成功后才通知,写回使能后在RAM更新后通知;name需要一直有效
+*/
+int device_env_register_notify(const char *name,device_env_notify_t notify);
+
+#if  DEVICE_ENV_USE_WRITE_BACK > 0
+/*
+* @brief 使能写回
+* @param dirty 有环境变量需要保存时的通知,由写回任务安排保存
+* @return 0：成功 -1：失败
+* @note 在启动调度前调用;之前的设置直接保存,bootloader不使能
+*/
+int device_env_write_back_enable(device_env_dirty_t dirty);
+
+/*
+* @brief 请求尽快保存写回缓存
+* @param 无
+* @return 无
+* @note 不等待,由写回任务保存
+*/
+void device_env_flush(void);
+
+/*
+* @brief 保存之前的全部设置
+* @param 无
+* @return 0：成功 -1：失败
+* @note 在调用者的任务中同步保存;返回0后之前的设置都已保存,之后的设置不会先于它们保存.
+*       bootloader标志和复位前使用
+*/
+int device_env_barrier(void);
+#endif
 
 
 #ifdef  __cplusplus
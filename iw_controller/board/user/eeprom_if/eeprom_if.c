@@ -1,5 +1,9 @@
 #include "board.h"
 #include "eeprom_if.h"
+#include "run_time_stats.h"
+#if  EEPROM_IF_USE_ASYNC > 0
+#include "cmsis_os.h"
+#endif
 
 
 #define EEPROM_IF_SOURCE_CLOCK           kCLOCK_BusClk
@@ -8,6 +12,219 @@
 
 #define FSL_FEATURE_EEPROM_PAGE_SIZE    (FSL_FEATURE_EEPROM_SIZE / FSL_FEATURE_EEPROM_PAGE_COUNT)
 
+/*阻塞时间统计:同步编程时为屏蔽中断的时间,异步编程时为中断处理的时间 单位:us*/
+static volatile uint32_t eeprom_if_block_max;
+
+#if  EEPROM_IF_USE_ASYNC > 0
+/*
+* 异步编程:写请求放入队列,每次把一页内的数据写入页寄存器后启动编程,
+* 编程完成中断里推进请求并启动下一页.队列只在屏蔽EEPROM中断时由任务修改,不屏蔽其他中断.
+*/
+typedef struct
+{
+    uint32_t offset;         /*开始偏移*/
+    const uint8_t *src;      /*数据源,完成前需要一直有效*/
+    uint16_t size;
+    uint16_t programmed;     /*已经编程完成的字节数*/
+    uint16_t chunk;          /*正在编程的字节数*/
+    eeprom_if_done_t done;
+    void *arg;
+}eeprom_if_request_t;
+
+typedef struct
+{
+    eeprom_if_request_t queue[EEPROM_IF_QUEUE_SIZE];
+    volatile uint8_t head;   /*中断处理的请求*/
+    volatile uint8_t tail;   /*下一个放入的位置*/
+    volatile uint8_t cnt;
+    volatile bool    busy;   /*正在编程*/
+    volatile bool    poll;   /*调度器启动前,由等待的调用者轮询完成标志*/
+    osMutexId        mutex;  /*同步写调用者互斥*/
+    osSemaphoreId    sem;    /*同步写完成*/
+}eeprom_if_async_t;
+
+static eeprom_if_async_t eeprom_if_async;
+static osStaticMutexDef_t eeprom_if_mutex_cb;
+static osStaticSemaphoreDef_t eeprom_if_sem_cb;
+
+
+/*
+* @brief 把一页内的数据写入页寄存器并启动编程
+* @param offset 开始偏移
+* @param src 数据源
+* @param size 数量,不超过页边界
+* @return 无
+* @note 不足一个字的部分保留EEPROM中原来的数据
+*/
+static void eeprom_if_page_program(uint32_t offset,const uint8_t *src,uint32_t size)
+{
+    uint32_t addr = FSL_FEATURE_EEPROM_BASE_ADDRESS + offset;
+    uint32_t end = addr + size;
+    uint32_t word_addr,word,byte;
+
+    for (word_addr = addr & ~3U;word_addr < end;word_addr += 4) {
+        word = *(volatile uint32_t *)EEPROM_IF_ADDR(word_addr);
+        for (byte = 0;byte < 4;byte ++) {
+            if (word_addr + byte >= addr && word_addr + byte < end) {
+                word &= ~(0xFFU << (byte * 8));
+                word |= (uint32_t)src[word_addr + byte - addr] << (byte * 8);
+            }
+        }
+        *(volatile uint32_t *)EEPROM_IF_ADDR(word_addr) = word;
+    }
+    EEPROM_ClearInterruptFlag(EEPROM_IF,kEEPROM_ProgramFinishInterruptEnable);
+    EEPROM_IF->CMD = FSL_FEATURE_EEPROM_PROGRAM_CMD;
+}
+
+/*
+* @brief 启动队列头请求的下一页
+* @param 无
+* @return 无
+* @note 在中断中或者屏蔽EEPROM中断时调用
+*/
+static void eeprom_if_next(void)
+{
+    uint32_t offset,chunk;
+    eeprom_if_request_t *req;
+
+    if (eeprom_if_async.cnt == 0) {
+        eeprom_if_async.busy = false;
+        return;
+    }
+    req = &eeprom_if_async.queue[eeprom_if_async.head];
+    offset = req->offset + req->programmed;
+    chunk = FSL_FEATURE_EEPROM_PAGE_SIZE - offset % FSL_FEATURE_EEPROM_PAGE_SIZE;
+    if (chunk > req->size - req->programmed) {
+        chunk = req->size - req->programmed;
+    }
+    req->chunk = chunk;
+    eeprom_if_async.busy = true;
+    eeprom_if_page_program(offset,&req->src[req->programmed],chunk);
+}
+
+/*
+* @brief 一页编程完成
+* @param 无
+* @return 无
+* @note 在中断中或者轮询时调用;请求完成时调用完成回调
+*/
+static void eeprom_if_program_done(void)
+{
+    eeprom_if_request_t *req;
+
+    req = &eeprom_if_async.queue[eeprom_if_async.head];
+    req->programmed += req->chunk;
+    if (req->programmed >= req->size) {
+        eeprom_if_async.head = (eeprom_if_async.head + 1) % EEPROM_IF_QUEUE_SIZE;
+        eeprom_if_async.cnt --;
+        if (req->done != NULL) {
+            req->done(0,req->arg);
+        }
+    }
+    eeprom_if_next();
+}
+
+/*
+* @brief EEPROM编程完成中断
+* @param 无
+* @return 无
+* @note
+*/
+void EEPROM_IRQHandler(void)
+{
+    uint32_t start,time;
+
+    start = run_time_stats_get_counter();
+    if (EEPROM_GetInterruptStatus(EEPROM_IF) & kEEPROM_ProgramFinishInterruptEnable) {
+        EEPROM_ClearInterruptFlag(EEPROM_IF,kEEPROM_ProgramFinishInterruptEnable);
+        if (eeprom_if_async.busy == true) {
+            eeprom_if_program_done();
+        }
+    }
+    time = run_time_stats_get_counter() - start;
+    if (time > eeprom_if_block_max) {
+        eeprom_if_block_max = time;
+    }
+
+    /* Add for ARM errata 838869, affects Cortex-M4, Cortex-M4F Store immediate overlapping
+    exception return operation might vector to incorrect interrupt */
+#if defined __CORTEX_M && (__CORTEX_M == 4U)
+    __DSB();
+#endif
+}
+
+/*
+* @brief 等待异步编程全部完成
+* @param 无
+* @return 无
+* @note 轮询时在这里处理完成标志,否则由中断处理
+*/
+static void eeprom_if_wait_idle(void)
+{
+    while (eeprom_if_async.busy == true) {
+        if (eeprom_if_async.poll == true &&
+            (EEPROM_GetInterruptStatus(EEPROM_IF) & kEEPROM_ProgramFinishInterruptEnable)) {
+            EEPROM_ClearInterruptFlag(EEPROM_IF,kEEPROM_ProgramFinishInterruptEnable);
+            eeprom_if_program_done();
+        }
+    }
+}
+
+/*
+* @brief 创建同步写使用的互斥量和信号量
+* @param 无
+* @return 0：成功 -1：失败
+* @note 调度器启动后第一次同步写时创建,启动前创建会提前屏蔽中断直到调度器启动
+*/
+static int eeprom_if_os_init(void)
+{
+    osMutexStaticDef(eeprom_if_mutex,&eeprom_if_mutex_cb);
+    osSemaphoreStaticDef(eeprom_if_sem,&eeprom_if_sem_cb);
+
+    if (eeprom_if_async.sem != NULL) {
+        return 0;
+    }
+    osThreadSuspendAll();
+    if (eeprom_if_async.sem == NULL) {
+        eeprom_if_async.mutex = osMutexCreate(osMutex(eeprom_if_mutex));
+        eeprom_if_async.sem = osSemaphoreCreate(osSemaphore(eeprom_if_sem),1);
+    }
+    osThreadResumeAll();
+
+    return eeprom_if_async.mutex != NULL && eeprom_if_async.sem != NULL ? 0 : -1;
+}
+
+/*
+* @brief 调度器启动前轮询等待编程完成
+* @param 无
+* @return 无
+* @note 关闭EEPROM中断,由调用者轮询完成标志
+*/
+static void eeprom_if_poll_idle(void)
+{
+    NVIC_DisableIRQ(EEPROM_IRQn);
+    eeprom_if_async.poll = true;
+    eeprom_if_wait_idle();
+    eeprom_if_async.poll = false;
+    NVIC_EnableIRQ(EEPROM_IRQn);
+}
+
+/*
+* @brief 同步写完成回调
+* @param result 0:成功
+* @param arg 未使用
+* @return 无
+* @note
+*/
+static void eeprom_if_write_done(int result,void *arg)
+{
+    (void)result;
+    (void)arg;
+    if (eeprom_if_async.poll == false) {
+        osSemaphoreRelease(eeprom_if_async.sem);
+    }
+}
+#endif
 
 /*
 * @brief eeprom 初始化
@@ -26,28 +243,135 @@ int eeprom_if_init(void)
     config.autoProgram = kEEPROM_AutoProgramDisable;
     sourceClock_Hz = EEPROM_IF_CLK_FREQ;
     EEPROM_Init(EEPROM_IF, &config, sourceClock_Hz);
-    
+
+#if  EEPROM_IF_USE_ASYNC > 0
+    EEPROM_ClearInterruptFlag(EEPROM_IF,kEEPROM_ProgramFinishInterruptEnable);
+    EEPROM_EnableInterrupt(EEPROM_IF,kEEPROM_ProgramFinishInterruptEnable);
+    NVIC_SetPriority(EEPROM_IRQn,EEPROM_IF_IRQ_PRIORITY);
+    NVIC_EnableIRQ(EEPROM_IRQn);
+#endif
+
+    return 0;
+}
+
+#if  EEPROM_IF_USE_ASYNC > 0
+/*
+* @brief eeprom 异步编程
+* @param addr 开始地址
+* @param src 数据源地址,完成前需要一直有效
+* @param size 数量
+* @param done 完成回调,在中断中执行,可以为NULL
+* @param arg 回调参数
+* @return 0：成功放入队列 -1：参数错误或者队列满
+* @note 不等待,不屏蔽其他中断;调用者之间需要互斥
+*/
+int eeprom_if_write_async(int addr,uint8_t *src,int size,eeprom_if_done_t done,void *arg)
+{
+    eeprom_if_request_t *req;
+
+    if (addr < FSL_FEATURE_EEPROM_BASE_ADDRESS || size <= 0 ||
+        addr + size > FSL_FEATURE_EEPROM_BASE_ADDRESS + FSL_FEATURE_EEPROM_SIZE) {
+        return -1;
+    }
+    /*只屏蔽EEPROM中断,保护队列*/
+    NVIC_DisableIRQ(EEPROM_IRQn);
+    if (eeprom_if_async.cnt >= EEPROM_IF_QUEUE_SIZE) {
+        NVIC_EnableIRQ(EEPROM_IRQn);
+        return -1;
+    }
+    req = &eeprom_if_async.queue[eeprom_if_async.tail];
+    req->offset = addr - FSL_FEATURE_EEPROM_BASE_ADDRESS;
+    req->src = src;
+    req->size = size;
+    req->programmed = 0;
+    req->chunk = 0;
+    req->done = done;
+    req->arg = arg;
+    eeprom_if_async.tail = (eeprom_if_async.tail + 1) % EEPROM_IF_QUEUE_SIZE;
+    eeprom_if_async.cnt ++;
+    if (eeprom_if_async.busy == false) {
+        eeprom_if_next();
+    }
+    if (eeprom_if_async.poll == false) {
+        NVIC_EnableIRQ(EEPROM_IRQn);
+    }
+
     return 0;
 }
 
+/*
+* @brief eeprom 是否正在编程
+* @param 无
+* @return true：正在编程 false：空闲
+* @note
+*/
+bool eeprom_if_busy(void)
+{
+    return eeprom_if_async.busy;
+}
+#endif
+
 /*
 * @brief eeprom 编程
 * @param addr 开始地址
 * @param src 数据源地址
 * @param size 数量
 * @return 0：成功 -1：失败
-* @note
+* @note 异步编程时只阻塞调用者,调度器启动前轮询等待
 */
 int eeprom_if_write(int addr,uint8_t *src,int size)
 {
+#if  EEPROM_IF_USE_ASYNC > 0
+    int rc;
+    bool running;
+
+    if (addr < FSL_FEATURE_EEPROM_BASE_ADDRESS) {
+        return -1;
+    }
+    running = osKernelRunning() != 0;
+    if (running) {
+        if (eeprom_if_os_init() != 0) {
+            return -1;
+        }
+        osMutexWait(eeprom_if_async.mutex,osWaitForever);
+    } else {
+        /*调度器没有启动,不能等待信号量,关闭EEPROM中断后轮询*/
+        NVIC_DisableIRQ(EEPROM_IRQn);
+        eeprom_if_async.poll = true;
+    }
+    rc = eeprom_if_write_async(addr,src,size,eeprom_if_write_done,NULL);
+    if (rc == 0) {
+        if (running) {
+            osSemaphoreWait(eeprom_if_async.sem,osWaitForever);
+        } else {
+            eeprom_if_wait_idle();
+        }
+    }
+    if (running) {
+        osMutexRelease(eeprom_if_async.mutex);
+    } else {
+        eeprom_if_async.poll = false;
+        NVIC_EnableIRQ(EEPROM_IRQn);
+    }
+
+    return rc;
+#else
+    uint32_t start,time;
+
     if (addr < FSL_FEATURE_EEPROM_BASE_ADDRESS) {
         return -1;
     }
+    start = run_time_stats_get_counter();
     EEPROM_ENTER_CRITICAL();
     EEPROM_Write(EEPROM_IF,addr - FSL_FEATURE_EEPROM_BASE_ADDRESS,src,size);
     EEPROM_EXIT_CRITICAL();
+    time = run_time_stats_get_counter() - start;
+    if (time > eeprom_if_block_max) {
+        eeprom_if_block_max = time;
+    }
 
     return 0;
+#endif
 }
 
 /*
@@ -56,13 +380,39 @@ int eeprom_if_write(int addr,uint8_t *src,int size)
 * @param dst 存储地址
 * @param size 数量
 * @return 0：成功 其他：失败
-* @note
+* @note 异步编程时先等待编程完成
 */
 int eeprom_if_read(int addr,uint8_t *dst,int size)
 {
+#if  EEPROM_IF_USE_ASYNC > 0
+    /*编程过程中不能读取*/
+    if (osKernelRunning() != 0) {
+        while (eeprom_if_async.busy == true) {
+            osDelay(1);
+        }
+    } else {
+        eeprom_if_poll_idle();
+    }
+#endif
     for (int i = 0;i < size; i++) {
-        dst[i] = *((uint8_t *)(addr + i));
+        dst[i] = *((uint8_t *)EEPROM_IF_ADDR(addr + i));
     }
 
     return 0;
-}
\ No newline at end of file
+}
+
+/*
+* @brief eeprom 最长阻塞时间
+* @param reset true：读取后清零
+* @return 时间 单位:us
+* @note 同步编程时为屏蔽中断的时间,异步编程时为中断处理的时间
+*/
+uint32_t eeprom_if_block_time_max(bool reset)
+{
+    uint32_t time = eeprom_if_block_max;
+
+    if (reset) {
+        eeprom_if_block_max = 0;
+    }
+    return time;
+}
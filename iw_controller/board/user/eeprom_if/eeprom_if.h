@@ -1,12 +1,37 @@
 #ifndef  __EEPROM_IF_H__
 #define  __EEPROM_IF_H__
 #include "stdint.h"
+#include "stdbool.h"
 #include "fsl_eeprom.h"
 
 #ifdef __cplusplus
     extern "C" {
 #endif
 
+/********************    配置开始    **************************************/
+#ifndef  EEPROM_IF_USE_ASYNC /*仿真构建可以在编译选项中定义,对比两种方式的阻塞时间*/
+#define  EEPROM_IF_USE_ASYNC                    1  /*是否使用编程完成中断驱动的异步编程,否则屏蔽中断等待编程完成*/
+#endif
+#define  EEPROM_IF_QUEUE_SIZE                   4  /*异步编程请求队列深度*/
+#define  EEPROM_IF_IRQ_PRIORITY                 4  /*编程完成中断优先级,数值不能小于configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY*/
+/********************    配置结束    **************************************/
+
+/*EEPROM地址对应的存储位置,linux仿真时在映射的eeprom.bin中*/
+#if defined(__linux__)
+#define  EEPROM_IF_ADDR(addr)                   sim_eeprom_addr(addr)
+#else
+#define  EEPROM_IF_ADDR(addr)                   ((uint32_t)(addr))
+#endif
+
+/*
+* @brief 异步编程完成回调
+* @param result 0：成功
+* @param arg 回调参数
+* @return 无
+* @note 在中断中执行
+*/
+typedef void (*eeprom_if_done_t)(int result,void *arg);
+
 
 /*
 * @brief eeprom 初始化
@@ -23,19 +48,50 @@ int eeprom_if_init(void);
 * @param src 数据源地址
 * @param size 数量
 * @return 0：成功 -1：失败
-* @note
+* @note 异步编程时只阻塞调用者,调度器启动前轮询等待
 */
 int eeprom_if_write(int addr,uint8_t *src,int size);
+
+#if  EEPROM_IF_USE_ASYNC > 0
+/*
+* @brief eeprom 异步编程
+* @param addr 开始地址
+* @param src 数据源地址,完成前需要一直有效
+* @param size 数量
+* @param done 完成回调,在中断中执行,可以为NULL
+* @param arg 回调参数
+* @return 0：成功放入队列 -1：参数错误或者队列满
+* @note 不等待,不屏蔽其他中断;调用者之间需要互斥
+*/
+int eeprom_if_write_async(int addr,uint8_t *src,int size,eeprom_if_done_t done,void *arg);
+
+/*
+* @brief eeprom 是否正在编程
+* @param 无
+* @return true：正在编程 false：空闲
+* @note
+*/
+bool eeprom_if_busy(void);
+#endif
+
 /*
 * @brief eeprom 读取
 * @param addr 开始地址
 * @param dst 存储地址
 * @param size 数量
 * @return 0：成功 其他：失败
-* @note
+* @note 异步编程时先等待编程完成
 */
 int eeprom_if_read(int addr,uint8_t *dst,int size);
 
+/*
+* @brief eeprom 最长阻塞时间
+* @param reset true：读取后清零
+* @return 时间 单位:us
+* @note 同步编程时为屏蔽中断的时间,异步编程时为中断处理的时间
+*/
+uint32_t eeprom_if_block_time_max(bool reset);
+
 
 
 #define  EEPROM_PRIORITY_BITS                   3
@@ -106,6 +162,22 @@ int eeprom_if_read(int addr,uint8_t *dst,int size);
 
 
 
+/*
+*  eeprom critical configuration for linux simulation(freertos posix port)
+*/
+#if defined(__linux__)
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define EEPROM_ENTER_CRITICAL()                                \
+{                                                              \
+    taskENTER_CRITICAL();
+
+#define EEPROM_EXIT_CRITICAL()                                 \
+    taskEXIT_CRITICAL();                                       \
+}
+#endif
+
 #ifdef __cplusplus
     }
 #endif
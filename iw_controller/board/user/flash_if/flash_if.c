@@ -1,3 +1,4 @@
+#include "string.h"
 #include "flash_if.h"
 #include "log.h"
 
@@ -50,7 +51,7 @@ int flash_if_init(void)
 int flash_if_read(uint32_t addr,uint8_t *dst,uint32_t size)
 {
     for (uint32_t i = 0; i < size; i++ ) {
-        dst[i] = *((uint8_t *)addr + i);
+        dst[i] = *((uint8_t *)FLASH_IF_ADDR(addr) + i);
     }
 
     return 0;
@@ -152,4 +153,109 @@ int flash_if_write(uint32_t addr,uint8_t *src,uint32_t size)
 
     log_debug("write done.\r\n");
     return 0;
-}
\ No newline at end of file
+}
+
+
+/*
+* @brief 流式编程一页
+* @param stream 流
+* @param src 一页数据,4字节对齐
+* @return 0 成功 -1 失败
+* @note
+*/
+static int flash_if_stream_program(flash_if_stream_t *stream,const uint8_t *src)
+{
+    if (stream->addr + FLASH_PAGE_SIZE > stream->limit) {
+        log_error("stream addr:0x%08x over limit.\r\n",stream->addr);
+        return -1;
+    }
+    if (flash_if_write(stream->addr,(uint8_t *)src,FLASH_PAGE_SIZE) != 0) {
+        return -1;
+    }
+    if (memcmp((const void *)FLASH_IF_ADDR(stream->addr),src,FLASH_PAGE_SIZE) != 0) {
+        log_error("stream verify err in addr:0x%08x.\r\n",stream->addr);
+        return -1;
+    }
+    stream->addr += FLASH_PAGE_SIZE;
+
+    return 0;
+}
+
+/*
+* @brief 开始流式编程
+* @param stream 流
+* @param addr 开始地址,页对齐,区域已经擦除
+* @param size 区域大小
+* @return 0 成功 -1 失败
+* @note
+*/
+int flash_if_stream_open(flash_if_stream_t *stream,uint32_t addr,uint32_t size)
+{
+    if (addr % FLASH_PAGE_SIZE != 0) {
+        log_error("stream addr:0x%08x not page aligned.\r\n",addr);
+        return -1;
+    }
+    stream->addr = addr;
+    stream->limit = addr + size;
+    stream->cnt = 0;
+
+    return 0;
+}
+
+/*
+* @brief 流式编程写入
+* @param stream 流
+* @param src 数据源,任意长度和对齐
+* @param size 数据量
+* @return 0 成功 -1 失败
+* @note 凑满一页编程一页,每次编程只屏蔽一页的时间;编程后回读校验
+*/
+int flash_if_stream_write(flash_if_stream_t *stream,const uint8_t *src,uint32_t size)
+{
+    uint32_t copy;
+
+    while (size > 0) {
+        /*页缓存为空且源数据对齐时直接从源编程*/
+        if (stream->cnt == 0 && size >= FLASH_PAGE_SIZE && ((uint32_t)src & 0x03) == 0) {
+            if (flash_if_stream_program(stream,src) != 0) {
+                return -1;
+            }
+            src += FLASH_PAGE_SIZE;
+            size -= FLASH_PAGE_SIZE;
+            continue;
+        }
+        copy = FLASH_PAGE_SIZE - stream->cnt;
+        if (copy > size) {
+            copy = size;
+        }
+        memcpy((uint8_t *)stream->page + stream->cnt,src,copy);
+        stream->cnt += copy;
+        src += copy;
+        size -= copy;
+        if (stream->cnt == FLASH_PAGE_SIZE) {
+            stream->cnt = 0;
+            if (flash_if_stream_program(stream,(const uint8_t *)stream->page) != 0) {
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/*
+* @brief 结束流式编程
+* @param stream 流
+* @return 0 成功 -1 失败
+* @note 不满一页的剩余数据用0xFF补齐后编程
+*/
+int flash_if_stream_close(flash_if_stream_t *stream)
+{
+    if (stream->cnt == 0) {
+        return 0;
+    }
+    memset((uint8_t *)stream->page + stream->cnt,0xFF,FLASH_PAGE_SIZE - stream->cnt);
+    stream->cnt = 0;
+
+    return flash_if_stream_program(stream,(const uint8_t *)stream->page);
+}
@@ -14,6 +14,22 @@
 
 #define  NV_FLASH_MAX_INTERRUPT_PRIORITY          (NV_FLASH_PRIORITY_HIGH << (8 - NV_FLASH_PRIORITY_BITS))
 
+/*flash地址对应的存储位置,linux仿真时在映射的flash.bin中*/
+#if defined(__linux__)
+#define  FLASH_IF_ADDR(addr)                      sim_flash_addr(addr)
+#else
+#define  FLASH_IF_ADDR(addr)                      ((uint32_t)(addr))
+#endif
+
+/*流式编程*/
+typedef struct
+{
+    uint32_t addr;                        /*下一页的编程地址*/
+    uint32_t limit;                       /*区域结束地址*/
+    uint32_t cnt;                         /*页缓存中的数据量*/
+    uint32_t page[FLASH_PAGE_SIZE / 4];   /*页缓存,IAP要求源地址4字节对齐*/
+}flash_if_stream_t;
+
 /*
 * @brief flash_if_init 数据区域初始化
 * @param 无
@@ -51,6 +67,34 @@ int flash_if_erase(uint32_t addr,uint32_t size);
 */
 int flash_if_write(uint32_t addr,uint8_t *src,uint32_t size);
 
+/*
+* @brief 开始流式编程
+* @param stream 流
+* @param addr 开始地址,页对齐,区域已经擦除
+* @param size 区域大小
+* @return 0 成功 -1 失败
+* @note
+*/
+int flash_if_stream_open(flash_if_stream_t *stream,uint32_t addr,uint32_t size);
+
+/*
+* @brief 流式编程写入
+* @param stream 流
+* @param src 数据源,任意长度和对齐
+* @param size 数据量
+* @return 0 成功 -1 失败
+* @note 凑满一页编程一页,每次编程只屏蔽一页的时间;编程后回读校验
+*/
+int flash_if_stream_write(flash_if_stream_t *stream,const uint8_t *src,uint32_t size);
+
+/*
+* @brief 结束流式编程
+* @param stream 流
+* @return 0 成功 -1 失败
+* @note 不满一页的剩余数据用0xFF补齐后编程
+*/
+int flash_if_stream_close(flash_if_stream_t *stream);
+
 
 #ifdef __ICCARM__
 
@@ -117,6 +161,22 @@ int flash_if_write(uint32_t addr,uint8_t *src,uint32_t size);
 
 
 
+/*
+*  nv flash critical configuration for linux simulation(freertos posix port)
+*/
+#if defined(__linux__)
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define NV_FLASH_ENTER_CRITICAL()                              \
+{                                                              \
+    taskENTER_CRITICAL();
+
+#define NV_FLASH_EXIT_CRITICAL()                               \
+    taskEXIT_CRITICAL();                                       \
+}
+#endif
+
 #ifdef __cplusplus
     }
 #endif
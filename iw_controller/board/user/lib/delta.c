@@ -0,0 +1,313 @@
+#include "string.h"
+#include "delta.h"
+#include "log.h"
+
+
+enum
+{
+    DELTA_STATE_HEAD,
+    DELTA_STATE_OP,
+    DELTA_STATE_LENGTH,
+    DELTA_STATE_SEEK,
+    DELTA_STATE_BODY,
+    DELTA_STATE_DONE,
+    DELTA_STATE_ERROR
+};
+
+enum
+{
+    DELTA_OP_COPY,
+    DELTA_OP_ADD,
+    DELTA_OP_DATA
+};
+
+#define  DELTA_VARINT_SHIFT_MAX            28
+
+
+/*
+* @brief 是否是差分补丁
+* @param src 数据开始
+* @param size 数据量
+* @return true 是 false 不是
+* @note 应用程序开头是栈顶地址,不会和"DLT1"冲突
+*/
+bool delta_is_patch(const uint8_t *src,uint32_t size)
+{
+    return size >= DELTA_MAGIC_SIZE && memcmp(src,DELTA_MAGIC,DELTA_MAGIC_SIZE) == 0;
+}
+
+/*
+* @brief 补丁初始化
+* @param patch 补丁
+* @param source 旧镜像,直接读取(flash中的当前应用)
+* @param source_size 旧镜像大小
+* @param source_md5 旧镜像MD5,16字节
+* @param output 输出函数
+* @param arg 输出函数参数
+* @return 无
+* @note 补丁头部的旧镜像大小和MD5必须一致,否则补丁不是对当前镜像做的
+*/
+void delta_patch_init(delta_patch_t *patch,const uint8_t *source,uint32_t source_size,const uint8_t *source_md5,delta_output_t output,void *arg)
+{
+    patch->state = DELTA_STATE_HEAD;
+    patch->head_cnt = 0;
+    patch->buffer_cnt = 0;
+    patch->pos = 0;
+    patch->source = source;
+    patch->source_size = source_size;
+    memcpy(patch->source_md5,source_md5,16);
+    patch->size = 0;
+    patch->out = 0;
+    patch->output = output;
+    patch->arg = arg;
+}
+
+/*
+* @brief 读取小端32位整数
+* @param src 数据
+* @return 整数
+* @note
+*/
+static uint32_t delta_get_u32(const uint8_t *src)
+{
+    return (uint32_t)src[0] | (uint32_t)src[1] << 8 | (uint32_t)src[2] << 16 | (uint32_t)src[3] << 24;
+}
+
+/*
+* @brief 解析头部
+* @param patch 补丁
+* @return 0 成功 -1 失败
+* @note
+*/
+static int delta_parse_head(delta_patch_t *patch)
+{
+    if (memcmp(patch->head,DELTA_MAGIC,DELTA_MAGIC_SIZE) != 0) {
+        log_error("delta magic err.\r\n");
+        return -1;
+    }
+    if (delta_get_u32(&patch->head[4]) != patch->source_size || memcmp(&patch->head[16],patch->source_md5,16) != 0) {
+        log_error("delta patch not for source size:%d.\r\n",patch->source_size);
+        return -1;
+    }
+    patch->size = delta_get_u32(&patch->head[8]);
+    memcpy(patch->md5,&patch->head[32],16);
+
+    return 0;
+}
+
+/*
+* @brief 输出一个字节
+* @param patch 补丁
+* @param c 字节
+* @return 0 成功 -1 失败
+* @note 缓存满和最后一个字节时调用输出函数
+*/
+static int delta_put(delta_patch_t *patch,uint8_t c)
+{
+    ((uint8_t *)patch->buffer)[patch->buffer_cnt ++] = c;
+    patch->out ++;
+    if (patch->buffer_cnt == DELTA_FLUSH_SIZE || patch->out == patch->size) {
+        if (patch->output(patch->arg,(const uint8_t *)patch->buffer,patch->buffer_cnt) != 0) {
+            return -1;
+        }
+        patch->buffer_cnt = 0;
+    }
+
+    return 0;
+}
+
+/*
+* @brief 读取变长整数的一个字节
+* @param patch 补丁
+* @param c 字节
+* @return 1 读取完成 0 还有后续字节 -1 超过32位
+* @note
+*/
+static int delta_varint(delta_patch_t *patch,uint8_t c)
+{
+    if (patch->shift > DELTA_VARINT_SHIFT_MAX || (patch->shift == DELTA_VARINT_SHIFT_MAX && (c & 0x70) != 0)) {
+        log_error("delta varint too long.\r\n");
+        return -1;
+    }
+    patch->value |= (uint32_t)(c & 0x7F) << patch->shift;
+    patch->shift += 7;
+
+    return (c & 0x80) ? 0 : 1;
+}
+
+/*
+* @brief 移动旧镜像读取位置
+* @param patch 补丁
+* @return 0 成功 -1 失败
+* @note 移动后本命令要读取的数据必须都在旧镜像内
+*/
+static int delta_seek(delta_patch_t *patch)
+{
+    uint32_t distance;
+
+    /*zigzag:偶数向后,奇数向前*/
+    if (patch->value & 0x01) {
+        distance = (patch->value >> 1) + 1;
+        if (distance > patch->pos) {
+            goto err_exit;
+        }
+        patch->pos -= distance;
+    } else {
+        distance = patch->value >> 1;
+        if (distance > patch->source_size - patch->pos) {
+            goto err_exit;
+        }
+        patch->pos += distance;
+    }
+    if (patch->length > patch->source_size - patch->pos) {
+        goto err_exit;
+    }
+
+    return 0;
+
+err_exit:
+    log_error("delta seek out of source size:%d.\r\n",patch->source_size);
+    return -1;
+}
+
+/*
+* @brief 一条命令结束
+* @param patch 补丁
+* @return 无
+* @note
+*/
+static void delta_op_end(delta_patch_t *patch)
+{
+    patch->state = patch->out == patch->size ? DELTA_STATE_DONE : DELTA_STATE_OP;
+}
+
+/*
+* @brief 流式打补丁
+* @param patch 补丁
+* @param src 补丁数据,任意长度
+* @param size 数据量
+* @return 0 成功 -1 失败
+* @note 每满DELTA_FLUSH_SIZE字节和最后不满的数据调用一次输出函数;
+*       头部收齐后patch->size和patch->md5有效,输出函数第一次调用前已经收齐
+*/
+int delta_patch(delta_patch_t *patch,const uint8_t *src,uint32_t size)
+{
+    uint32_t copy;
+    int rc;
+    uint8_t c;
+
+    while (size > 0) {
+        switch (patch->state) {
+        case DELTA_STATE_HEAD:
+            copy = DELTA_HEADER_SIZE - patch->head_cnt;
+            if (copy > size) {
+                copy = size;
+            }
+            memcpy(&patch->head[patch->head_cnt],src,copy);
+            patch->head_cnt += copy;
+            src += copy;
+            size -= copy;
+            if (patch->head_cnt == DELTA_HEADER_SIZE) {
+                if (delta_parse_head(patch) != 0) {
+                    goto err_exit;
+                }
+                patch->state = patch->size == 0 ? DELTA_STATE_DONE : DELTA_STATE_OP;
+            }
+            continue;
+        case DELTA_STATE_DONE:
+            log_error("delta data after end.\r\n");
+            goto err_exit;
+        case DELTA_STATE_ERROR:
+            return -1;
+        default:
+            break;
+        }
+
+        c = *src ++;
+        size --;
+        switch (patch->state) {
+        case DELTA_STATE_OP:
+            if (c > DELTA_OP_DATA) {
+                log_error("delta op:%d err.\r\n",c);
+                goto err_exit;
+            }
+            patch->op = c;
+            patch->value = 0;
+            patch->shift = 0;
+            patch->state = DELTA_STATE_LENGTH;
+            break;
+        case DELTA_STATE_LENGTH:
+            rc = delta_varint(patch,c);
+            if (rc < 0) {
+                goto err_exit;
+            }
+            if (rc == 0) {
+                break;
+            }
+            patch->length = patch->value;
+            if (patch->length == 0 || patch->length > patch->size - patch->out) {
+                log_error("delta length:%d over size:%d.\r\n",patch->length,patch->size);
+                goto err_exit;
+            }
+            patch->value = 0;
+            patch->shift = 0;
+            patch->state = patch->op == DELTA_OP_DATA ? DELTA_STATE_BODY : DELTA_STATE_SEEK;
+            break;
+        case DELTA_STATE_SEEK:
+            rc = delta_varint(patch,c);
+            if (rc < 0) {
+                goto err_exit;
+            }
+            if (rc == 0) {
+                break;
+            }
+            if (delta_seek(patch) != 0) {
+                goto err_exit;
+            }
+            if (patch->op == DELTA_OP_ADD) {
+                patch->state = DELTA_STATE_BODY;
+                break;
+            }
+            /*COPY没有数据,直接从旧镜像复制*/
+            while (patch->length > 0) {
+                if (delta_put(patch,patch->source[patch->pos]) != 0) {
+                    goto err_exit;
+                }
+                patch->pos ++;
+                patch->length --;
+            }
+            delta_op_end(patch);
+            break;
+        case DELTA_STATE_BODY:
+            if (patch->op == DELTA_OP_ADD) {
+                c += patch->source[patch->pos];
+                patch->pos ++;
+            }
+            if (delta_put(patch,c) != 0) {
+                goto err_exit;
+            }
+            patch->length --;
+            if (patch->length == 0) {
+                delta_op_end(patch);
+            }
+            break;
+        }
+    }
+
+    return 0;
+
+err_exit:
+    patch->state = DELTA_STATE_ERROR;
+    return -1;
+}
+
+/*
+* @brief 补丁是否完成
+* @param patch 补丁
+* @return true 完成 false 未完成
+* @note 完成时全部数据已经输出
+*/
+bool delta_patch_is_done(delta_patch_t *patch)
+{
+    return patch->state == DELTA_STATE_DONE && patch->out == patch->size && patch->buffer_cnt == 0;
+}
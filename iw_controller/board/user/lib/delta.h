@@ -0,0 +1,106 @@
+#ifndef  __DELTA_H__
+#define  __DELTA_H__
+#include "stdbool.h"
+#include "stdint.h"
+
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+/*
+* 差分补丁格式(tools/delta_diff.py生成),多字节整数小端:
+* 头部48字节:"DLT1" 旧镜像大小(4) 新镜像大小(4) 保留(4) 旧镜像MD5(16) 新镜像MD5(16)
+* 命令:1字节类型 + 长度(变长整数);COPY和ADD再跟旧镜像读取位置的相对移动(zigzag变长整数)
+*      COPY 复制旧镜像
+*      ADD  旧镜像加上后面的长度个差值字节(按字节相加,地址移动后的指针和跳转多数差值相同)
+*      DATA 后面的长度个新数据
+* 变长整数每字节低7位有效,最高位为1表示还有后续字节
+*/
+
+/********************    配置开始    **************************************/
+#define  DELTA_FLUSH_SIZE                  256  /*输出缓存大小,和flash页大小一致*/
+/********************    配置结束    **************************************/
+
+#define  DELTA_HEADER_SIZE                 48
+#define  DELTA_MAGIC                       "DLT1"
+#define  DELTA_MAGIC_SIZE                  4
+
+#if  (DELTA_FLUSH_SIZE % 4) != 0
+#error "DELTA_FLUSH_SIZE invalid."
+#endif
+
+/*补丁输出函数,0:成功 -1:失败*/
+typedef int (*delta_output_t)(void *arg,const uint8_t *data,uint32_t size);
+
+typedef struct
+{
+    uint8_t        state;
+    uint8_t        op;         /*当前命令*/
+    uint8_t        shift;      /*变长整数已读取的位数*/
+    uint16_t       head_cnt;   /*已收到的头部字节数*/
+    uint16_t       buffer_cnt; /*输出缓存中的字节数*/
+    uint32_t       value;      /*正在读取的变长整数*/
+    uint32_t       length;     /*当前命令剩余长度*/
+    uint32_t       pos;        /*旧镜像读取位置*/
+    const uint8_t *source;     /*旧镜像*/
+    uint32_t       source_size;
+    uint8_t        source_md5[16];
+    uint32_t       size;       /*新镜像大小*/
+    uint32_t       out;        /*已生成字节数*/
+    uint8_t        md5[16];    /*新镜像MD5*/
+    uint8_t        head[DELTA_HEADER_SIZE];
+    delta_output_t output;
+    void          *arg;
+    uint32_t       buffer[DELTA_FLUSH_SIZE / 4];/*4字节对齐,满缓存可以直接编程*/
+}delta_patch_t;
+
+
+/*
+* @brief 是否是差分补丁
+* @param src 数据开始
+* @param size 数据量
+* @return true 是 false 不是
+* @note 应用程序开头是栈顶地址,不会和"DLT1"冲突
+*/
+bool delta_is_patch(const uint8_t *src,uint32_t size);
+
+/*
+* @brief 补丁初始化
+* @param patch 补丁
+* @param source 旧镜像,直接读取(flash中的当前应用)
+* @param source_size 旧镜像大小
+* @param source_md5 旧镜像MD5,16字节
+* @param output 输出函数
+* @param arg 输出函数参数
+* @return 无
+* @note 补丁头部的旧镜像大小和MD5必须一致,否则补丁不是对当前镜像做的
+*/
+void delta_patch_init(delta_patch_t *patch,const uint8_t *source,uint32_t source_size,const uint8_t *source_md5,delta_output_t output,void *arg);
+
+/*
+* @brief 流式打补丁
+* @param patch 补丁
+* @param src 补丁数据,任意长度
+* @param size 数据量
+* @return 0 成功 -1 失败
+* @note 每满DELTA_FLUSH_SIZE字节和最后不满的数据调用一次输出函数;
+*       头部收齐后patch->size和patch->md5有效,输出函数第一次调用前已经收齐
+*/
+int delta_patch(delta_patch_t *patch,const uint8_t *src,uint32_t size);
+
+/*
+* @brief 补丁是否完成
+* @param patch 补丁
+* @return true 完成 false 未完成
+* @note 完成时全部数据已经输出
+*/
+bool delta_patch_is_done(delta_patch_t *patch);
+
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif
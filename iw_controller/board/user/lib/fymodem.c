@@ -17,7 +17,8 @@
  * Add rx/tx callbacks if eg storing file to external storage,
  * and full buffer cannot be in memory at the same time.
  *
- * Add support for Ymodem-G standard as described in docs for streaming.
+ * Window mode (see YM_WIN) streams packets without waiting a round
+ * trip each, and unlike Ymodem-G recovers from errors.
  *
  * Add suppport for async operation mode if calling system cannot handle
  * that calls are synchroneus and blocking.
@@ -28,7 +29,6 @@
  */
 
 #include <fymodem.h>
-#include "flash_if.h"
 #include "log.h"
 
 
@@ -45,6 +45,7 @@
 #define YM_PACKET_SIZE             (128)
 #define YM_PACKET_1K_SIZE          (1024)
 #define YM_PACKET_RX_TIMEOUT_MS    (1000)
+#define YM_PACKET_PURGE_MS         (20)    /* line quiet this long after garbage */
 #define YM_PACKET_ERROR_MAX_NBR    (5)
 
 /* contants defined by YModem protocol */
@@ -58,6 +59,17 @@
 #define YM_ABT1                    (0x41)  /* 'A' == 0x41, assume try abort by user typing */
 #define YM_ABT2                    (0x61)  /* 'a' == 0x61, assume try abort by user typing */
 
+/* window mode, an extension of this implementation.
+   after acking the header the receiver sends 'W' and the window size
+   instead of 'C'. a sender that knows it streams up to window packets
+   ahead, a classic sender ignores it and the receiver falls back to
+   'C' after one packet timeout. in window mode data packets are
+   answered with ACK/NAK followed by seq and ~seq: ACK n acks all up
+   to n, NAK n acks all before n and asks to go back to n. packets
+   out of order after a loss are dropped (go-back-n, the data goes to
+   flash in order so there is nowhere to keep them). */
+#define YM_WIN                     (0x57)  /* 'W' == 0x57, offer window mode */
+
 
 /*包数据*/
 #pragma pack (4)
@@ -120,7 +132,55 @@ static int __ym_getchar(serial_handle_t *handle,uint32_t timeout)
         return -1;
     }
 
-    return c;
+    return (uint8_t)c;
+}
+
+/*
+* @brief 读取指定数量的数据
+* @param handle 串口句柄
+* @param buf 数据缓存
+* @param size 数据量
+* @param timeout 字节间超时 单位:ms
+* @return 0 成功 -1 超时或者失败
+* @note 一次读出串口缓存中已有的全部数据,不再每个字节select一次
+*/
+static int __ym_read(serial_handle_t *handle,uint8_t *buf,uint32_t size,uint32_t timeout)
+{
+    int rc;
+
+    while (size > 0) {
+        rc = serial_select(handle,timeout);
+        if (rc <= 0) {
+            log_error("ymodem select timeout or err.\r\n");
+            return -1;
+        }
+        rc = serial_read(handle,(char *)buf,size);
+        if (rc < 0) {
+            log_error("ymodem read err.\r\n");
+            return -1;
+        }
+        buf += rc;
+        size -= rc;
+    }
+
+    return 0;
+}
+
+/*
+* @brief 丢弃数据直到线路安静
+* @param handle 串口句柄
+* @return 无
+* @note 坏包的剩余部分不当作新包解析
+*/
+static void __ym_purge(serial_handle_t *handle)
+{
+    char buf[32];
+
+    while (serial_select(handle,YM_PACKET_PURGE_MS) > 0) {
+        if (serial_read(handle,buf,sizeof(buf)) < 0) {
+            return;
+        }
+    }
 }
 
 
@@ -147,9 +207,36 @@ static int __ym_putchar(serial_handle_t *handle,char c)
     }
 
     return 0;
+}
 
+/*
+* @brief 窗口模式回应
+* @param handle 串口句柄
+* @param c YM_ACK或者YM_NAK
+* @param seq 包序号
+* @return 0 成功 -1 失败
+* @note
+*/
+static int __ym_reply(serial_handle_t *handle,char c,uint32_t seq)
+{
+    int rc;
+    char buf[3];
 
+    buf[0] = c;
+    buf[1] = seq & 0xff;
+    buf[2] = ~seq & 0xff;
+    rc = serial_write(handle,buf,3);
+    if (rc != 3) {
+        log_error("ymodem write err.\r\n");
+        return -1;
+    }
+    rc = serial_complete(handle,5);
+    if (rc != 0) {
+        log_error("ymodem complete err.\r\n");
+        return -1;
+    }
 
+    return 0;
 }
 /* ------------------------------------------------ */
 /* calculate crc16-ccitt very fast
@@ -230,6 +317,7 @@ static void ym_readU32(const uint8_t* buf, uint32_t *val)
   * @return 0: normally return, success
   *        -1: timeout or packet error
   *         1: abort by user / corrupt packet
+  *         2: garbage between packets, skipped
   */
 static int32_t ym_rx_packet(serial_handle_t *handle,
                             uint8_t *rxdata,
@@ -276,6 +364,11 @@ static int32_t ym_rx_packet(serial_handle_t *handle,
     /* User try abort, 'A' or 'a' received */
     return 1;
   default:
+    /* once the transfer runs this is line noise or the tail of a
+       corrupt packet, let the caller resync. */
+    if (packets_rxed > 0) {
+      return 2;
+    }
     /* This case could be the result of corruption on the first octet
        of the packet, but it's more likely that it's the user banging
        on the terminal trying to abort a transfer. Technically, the
@@ -288,15 +381,11 @@ static int32_t ym_rx_packet(serial_handle_t *handle,
   /* store data RXed */
   rxdata[YM_PACKET_START_INDEX] = (uint8_t)c;
   
-  uint32_t i;
-  for (i = YM_PACKET_SEQNO_INDEX; i < (rx_packet_size + YM_PACKET_OVERHEAD); i++) {
-    c = __ym_getchar(handle,timeout_ms);
-    if (c < 0) {
-      /* end of stream */
-      return -1;
-    }
-    /* store data RXed */
-    rxdata[i] = (uint8_t)c;
+  /* sequence number/complement first, a start byte found in noise
+     must not swallow the next real packet */
+  if (__ym_read(handle,&rxdata[YM_PACKET_SEQNO_INDEX],2,timeout_ms) != 0) {
+    /* end of stream */
+    return -1;
   }
   
   /* just a sanity check on the sequence number/complement value.
@@ -305,7 +394,13 @@ static int32_t ym_rx_packet(serial_handle_t *handle,
   uint8_t seq_cmp = ((rxdata[YM_PACKET_SEQNO_COMP_INDEX] ^ 0xff) & 0xff);
   if (seq_nbr != seq_cmp) {
     /* seq nbr error */
-    return 1;
+    return packets_rxed > 0 ? 2 : 1;
+  }
+  
+  /* data and crc in bulk */
+  if (__ym_read(handle,&rxdata[YM_PACKET_HEADER],rx_packet_size + YM_PACKET_TRAILER,timeout_ms) != 0) {
+    /* end of stream */
+    return -1;
   }
   
   /* check CRC16 match */
@@ -320,16 +415,59 @@ static int32_t ym_rx_packet(serial_handle_t *handle,
   return 0;
 }
 
+/* ------------------------------------------------- */
+/* pass the data of a packet to the sink, padding beyond the file
+   size trimmed. return 0 on success */
+static int32_t ym_rx_write(const fymodem_sink_t *sink,
+                           const uint8_t *data,
+                           int32_t len,
+                           uint32_t filesize,
+                           uint32_t limit,
+                           uint32_t *recv_size)
+{
+  /* This shouldn't happen, but we check anyway in case the
+     sender sent no size in its filename packet */
+  if (filesize == 0 && (*recv_size + len) > limit) {
+    log_error("YM: RX buffer overflow (exceeded 0x%08x)\n", (unsigned int)limit);
+    return -1;
+  }
+  uint32_t write_size = len;
+  if (filesize > 0) {
+    write_size = *recv_size >= filesize ? 0 : filesize - *recv_size;
+    if (write_size > (uint32_t)len) {
+      write_size = len;
+    }
+  }
+  if (write_size > 0 && sink->write(sink->arg, data, write_size) != 0) {
+    log_error("YM: sink write err in offset:0x%08x size:%d.\r\n",(unsigned int)*recv_size,(int)write_size);
+    return -1;
+  }
+  *recv_size += len;
+  return 0;
+}
+
+#if FYMODEM_WINDOW_SIZE > 1
+/* packets of the window that arrived ahead of a lost one, kept until
+   the lost one is repeated (selective repeat). the slot of packet n
+   is n % (FYMODEM_WINDOW_SIZE - 1) */
+#define YM_WINDOW_SLOTS            (FYMODEM_WINDOW_SIZE - 1)
+static struct {
+  uint32_t seq;
+  int32_t  len;  /* 0: empty */
+  uint8_t  data[YM_PACKET_1K_SIZE];
+} rx_window[YM_WINDOW_SLOTS];
+#endif
+
 /* ------------------------------------------------- */
 /**
  * Receive a file using the ymodem protocol
- * @param rxdata Pointer to the first byte
- * @param rxlen  Max in length
- * @return The length of the file received, or 0 on error
+ * @param sink   Where the file data goes
+ * @param limit  Max file length
+ * @return The length of the file received, 0 if aborted by sender, -1 on error
  */
 int32_t fymodem_receive(serial_handle_t *handle,
-                        uint32_t flash_addr,
-                        uint32_t flash_limit,
+                        const fymodem_sink_t *sink,
+                        uint32_t limit,
                         char *filename,
                         uint32_t wait_timeout)
 {
@@ -354,8 +492,13 @@ int32_t fymodem_receive(serial_handle_t *handle,
     }
     first_try = false;
 
+#if FYMODEM_WINDOW_SIZE <= 1
     bool crc_nak = true;
+#endif
     bool file_done = false;
+    /* window mode agreed, a NAK is out for the awaited packet */
+    bool window = false;
+    bool nak_sent = false;
     uint32_t packets_rxed = 0;
 
     do {
@@ -365,9 +508,10 @@ int32_t fymodem_receive(serial_handle_t *handle,
                                  &rx_packet_len,
                                  packets_rxed,
                                  YM_PACKET_RX_TIMEOUT_MS);
+      /* packets ahead of the awaited one, 0 is in order */
+      uint8_t ahead = (rx_packet_data[YM_PACKET_SEQNO_INDEX] - packets_rxed) & 0xff;
       switch (res) {
       case 0: {
-        nbr_errors = 0;
         switch (rx_packet_len) {
         case -1: {
           /* aborted by sender */
@@ -385,89 +529,169 @@ int32_t fymodem_receive(serial_handle_t *handle,
         }
         default: {
           /* normal packet, check seq nbr */
-          uint8_t seq_nbr = rx_packet_data[YM_PACKET_SEQNO_INDEX];
-          if (seq_nbr != (packets_rxed & 0xff)) {
-            /* wrong seq number */
-            __ym_putchar(handle,YM_NAK);
-          } else {
-            if (packets_rxed == 0) {
-              /* The spec suggests that the whole data section should
-                 be zeroed, but some senders might not do this.
-                 If we have a NULL filename and the first few digits of
-                 the file length are zero, then call it empty. */
-              int32_t i;
-              for (i = YM_PACKET_HEADER; i < YM_PACKET_HEADER + 4; i++) {
-                if (rx_packet_data[i] != 0) {
-                  break;
-                }
-              }
-              /* non-zero bytes found in header, filename packet has data */
-              if (i < YM_PACKET_HEADER + 4) {
-                /* read file name */
-                uint8_t *file_ptr = (uint8_t*)(rx_packet_data + YM_PACKET_HEADER);
-                i = 0;
-                while (*file_ptr && (i < FYMODEM_FILE_NAME_MAX_LENGTH)) {
-                  filename[i++] = *file_ptr++;
-                }
-                filename[i++] = '\0';
-                file_ptr++;
-                /* read file size */
-                i = 0;
-                while ((*file_ptr != ' ') && (i < YM_FILE_SIZE_LENGTH)) {
-                  filesize_asc[i++] = *file_ptr++;
-                }
-                filesize_asc[i++] = '\0';
-                /* convert file size */
-                ym_readU32(filesize_asc, &filesize);
-                /* check file size */
-                if (filesize > flash_limit) {
-                  log_error("YM: RX buffer too small (0x%08x vs 0x%08x)\n", (unsigned int)flash_limit, (unsigned int)filesize);
-                  goto rx_err_handler;
-                }
-                /* erase user application area */
-                flash_if_erase(flash_addr,flash_limit);
-
+          if (ahead != 0) {
+            if (packets_rxed > 0 && ahead == 0xff) {
+              /* repeated packet, our ack was lost */
+              if (window) {
+                __ym_reply(handle,YM_ACK,packets_rxed - 1);
+              } else {
                 __ym_putchar(handle,YM_ACK);
-                __ym_putchar(handle,crc_nak ? YM_CRC : YM_NAK);
-                crc_nak = false;
               }
-              else {
-                /* filename packet is empty, end session */
-                __ym_putchar(handle,YM_ACK);
-                file_done = true;
-                session_done = true;
+              break;
+            }
+            if (!window) {
+              /* wrong seq number */
+              __ym_putchar(handle,YM_NAK);
+              break;
+            }
+#if FYMODEM_WINDOW_SIZE > 1
+            /* the awaited packet was lost, keep this one */
+            if (ahead < FYMODEM_WINDOW_SIZE) {
+              uint32_t slot = (packets_rxed + ahead) % YM_WINDOW_SLOTS;
+              rx_window[slot].seq = packets_rxed + ahead;
+              rx_window[slot].len = rx_packet_len;
+              memcpy(rx_window[slot].data, &rx_packet_data[YM_PACKET_HEADER], rx_packet_len);
+            }
+#endif
+            if (!nak_sent) {
+              __ym_reply(handle,YM_NAK,packets_rxed);
+              nak_sent = true;
+            }
+            break;
+          }
+          nbr_errors = 0;
+          nak_sent = false;
+          if (packets_rxed == 0) {
+            /* The spec suggests that the whole data section should
+               be zeroed, but some senders might not do this.
+               If we have a NULL filename and the first few digits of
+               the file length are zero, then call it empty. */
+            int32_t i;
+            for (i = YM_PACKET_HEADER; i < YM_PACKET_HEADER + 4; i++) {
+              if (rx_packet_data[i] != 0) {
                 break;
               }
             }
-            else {
-              /* This shouldn't happen, but we check anyway in case the
-                 sender sent wrong info in its filename packet */
-              if ((recv_size + rx_packet_len) > (int32_t)flash_limit) {
-                log_error("YM: RX buffer overflow (exceeded 0x%08x)\n", (unsigned int)flash_limit);
+            /* non-zero bytes found in header, filename packet has data */
+            if (i < YM_PACKET_HEADER + 4) {
+              /* read file name */
+              uint8_t *file_ptr = (uint8_t*)(rx_packet_data + YM_PACKET_HEADER);
+              i = 0;
+              while (*file_ptr && (i < FYMODEM_FILE_NAME_MAX_LENGTH)) {
+                filename[i++] = *file_ptr++;
+              }
+              filename[i++] = '\0';
+              file_ptr++;
+              /* read file size */
+              i = 0;
+              while ((*file_ptr != ' ') && (i < YM_FILE_SIZE_LENGTH)) {
+                filesize_asc[i++] = *file_ptr++;
+              }
+              filesize_asc[i++] = '\0';
+              /* convert file size */
+              ym_readU32(filesize_asc, &filesize);
+              /* check file size */
+              if (filesize > limit) {
+                log_error("YM: RX buffer too small (0x%08x vs 0x%08x)\n", (unsigned int)limit, (unsigned int)filesize);
                 goto rx_err_handler;
               }
-              /*flash program */
-              if (flash_if_write(flash_addr + recv_size,&rx_packet_data[YM_PACKET_HEADER],rx_packet_len) == 0) {
-                    recv_size += rx_packet_len;
-                    __ym_putchar(handle,YM_ACK);
-              } else {
-                log_error("flash write err in addr:0x%08x size:%d.\r\n",flash_addr + recv_size,rx_packet_len);
+              /* prepare the sink before the sender starts data packets */
+              if (sink->open(sink->arg, filesize) != 0) {
+                log_error("YM: sink open err.\n");
                 goto rx_err_handler;
-             }
+              }
+
+              __ym_putchar(handle,YM_ACK);
+#if FYMODEM_WINDOW_SIZE > 1
+              /* offer window mode */
+              for (i = 0; i < YM_WINDOW_SLOTS; i++) {
+                rx_window[i].len = 0;
+              }
+              __ym_putchar(handle,YM_WIN);
+              __ym_putchar(handle,FYMODEM_WINDOW_SIZE);
+              window = true;
+#else
+              __ym_putchar(handle,crc_nak ? YM_CRC : YM_NAK);
+              crc_nak = false;
+#endif
+            }
+            else {
+              /* filename packet is empty, end session */
+              __ym_putchar(handle,YM_ACK);
+              file_done = true;
+              session_done = true;
+              break;
+            }
+            packets_rxed++;
+            break;
+          }
+          if (!window) {
+            /* ack first, the next packet streams into the serial
+               buffer while this one is written out of rx_packet_data */
+            __ym_putchar(handle,YM_ACK);
+            if (ym_rx_write(sink, &rx_packet_data[YM_PACKET_HEADER], rx_packet_len,
+                            filesize, limit, &recv_size) != 0) {
+              goto rx_err_handler;
             }
             packets_rxed++;
-          }  /* sequence number check ok */
+            break;
+          }
+#if FYMODEM_WINDOW_SIZE > 1
+          /* the kept packets that follow go out with this one, one
+             ack covers them all */
+          uint32_t cnt = 1;
+          while (cnt < FYMODEM_WINDOW_SIZE) {
+            uint32_t slot = (packets_rxed + cnt) % YM_WINDOW_SLOTS;
+            if (rx_window[slot].len == 0 || rx_window[slot].seq != packets_rxed + cnt) {
+              break;
+            }
+            cnt++;
+          }
+          __ym_reply(handle,YM_ACK,packets_rxed + cnt - 1);
+          if (ym_rx_write(sink, &rx_packet_data[YM_PACKET_HEADER], rx_packet_len,
+                          filesize, limit, &recv_size) != 0) {
+            goto rx_err_handler;
+          }
+          packets_rxed++;
+          while (--cnt > 0) {
+            uint32_t slot = packets_rxed % YM_WINDOW_SLOTS;
+            if (ym_rx_write(sink, rx_window[slot].data, rx_window[slot].len,
+                            filesize, limit, &recv_size) != 0) {
+              goto rx_err_handler;
+            }
+            rx_window[slot].len = 0;
+            packets_rxed++;
+          }
+#endif
+          break;
         } /* default */
         } /* inner switch */
         break;
       } /* case 0 */
       default: {
         if (packets_rxed > 0) {
+          /* behind a loss the NAK is out. only a bad copy of the
+             awaited packet itself needs another one */
+          if (window && nak_sent && res > 0 && (res == 2 || ahead != 0)) {
+            break;
+          }
           nbr_errors++;
           if (nbr_errors >= YM_PACKET_ERROR_MAX_NBR) {
             log_error("YM: RX errors too many: %d - ABORT.\n", (unsigned int)nbr_errors);
             goto rx_err_handler;
           }
+          if (window && packets_rxed == 1 && res < 0 && !nak_sent) {
+            /* nothing at all after the offer, classic sender */
+            window = false;
+          }
+          if (window) {
+            __ym_reply(handle,YM_NAK,packets_rxed);
+            nak_sent = true;
+            break;
+          }
+          if (res > 0) {
+            __ym_purge(handle);
+          }
         } else {/*未开始接收*/
             timeout += YM_PACKET_RX_TIMEOUT_MS;
             if (timeout >= wait_timeout) {
@@ -25,10 +25,29 @@
 /* max length of filename */
 #define FYMODEM_FILE_NAME_MAX_LENGTH  (64)
 
+/* packets a sender may stream ahead of the acks, 1 for classic
+   stop-and-wait only. unacked 1K packets must fit in the serial rx
+   buffer: 2 x 1029 <= 2048 ring + 16 fifo of the host port. costs
+   (window - 1) KB of RAM for packets that arrive behind a lost one */
+#define FYMODEM_WINDOW_SIZE           (2)
+
+/* receive sink, where the file data goes */
+typedef struct {
+  /* file size known from the header packet, called before the header
+     is acked so slow preparation (eg flash erase) stalls the sender.
+     return 0 to accept the file */
+  int (*open)(void *arg, uint32_t filesize);
+  /* file data in order, padding beyond the file size trimmed. called
+     after the packet is acked, so the sender already transmits the
+     next packet while this runs. return 0 on success */
+  int (*write)(void *arg, const uint8_t *data, uint32_t size);
+  void *arg;
+} fymodem_sink_t;
+
 /* receive file over ymodem */
 int32_t fymodem_receive(serial_handle_t *handle,
-                        uint32_t flash_addr,
-                        uint32_t flash_limit,
+                        const fymodem_sink_t *sink,
+                        uint32_t limit,
                         char *filename,
                         uint32_t timeout);
 
@@ -0,0 +1,245 @@
+#include "string.h"
+#include "lzss.h"
+#include "log.h"
+
+
+enum
+{
+    LZSS_STATE_HEAD,
+    LZSS_STATE_FLAG,
+    LZSS_STATE_ITEM,
+    LZSS_STATE_TOKEN,
+    LZSS_STATE_EXTRA,
+    LZSS_STATE_DONE,
+    LZSS_STATE_ERROR
+};
+
+
+/*
+* @brief 是否是压缩文件
+* @param src 文件开始的数据
+* @param size 数据量
+* @return true 是 false 不是
+* @note 应用程序开头是栈顶地址,不会和"LZS1"冲突
+*/
+bool lzss_is_compressed(const uint8_t *src,uint32_t size)
+{
+    return size >= LZSS_MAGIC_SIZE && memcmp(src,LZSS_MAGIC,LZSS_MAGIC_SIZE) == 0;
+}
+
+/*
+* @brief 解压初始化
+* @param dec 解压器
+* @param output 输出函数
+* @param arg 输出函数参数
+* @return 无
+* @note
+*/
+void lzss_decoder_init(lzss_decoder_t *dec,lzss_output_t output,void *arg)
+{
+    dec->state = LZSS_STATE_HEAD;
+    dec->head_cnt = 0;
+    dec->size = 0;
+    dec->out = 0;
+    dec->flushed = 0;
+    dec->output = output;
+    dec->arg = arg;
+}
+
+/*
+* @brief 解析头部
+* @param dec 解压器
+* @return 0 成功 -1 失败
+* @note
+*/
+static int lzss_parse_head(lzss_decoder_t *dec)
+{
+    if (memcmp(dec->head,LZSS_MAGIC,LZSS_MAGIC_SIZE) != 0) {
+        log_error("lzss magic err.\r\n");
+        return -1;
+    }
+    dec->window_bits = dec->head[4];
+    if (dec->window_bits < LZSS_WINDOW_BITS_MIN || dec->window_bits > LZSS_WINDOW_BITS) {
+        log_error("lzss window bits:%d not support.max:%d.\r\n",dec->window_bits,LZSS_WINDOW_BITS);
+        return -1;
+    }
+    dec->size = (uint32_t)dec->head[8] | (uint32_t)dec->head[9] << 8 | (uint32_t)dec->head[10] << 16 | (uint32_t)dec->head[11] << 24;
+    memcpy(dec->md5,&dec->head[12],16);
+
+    return 0;
+}
+
+/*
+* @brief 输出窗口中未输出的数据
+* @param dec 解压器
+* @return 0 成功 -1 失败
+* @note 输出点都在LZSS_FLUSH_SIZE边界或者结尾,一段数据不会跨越窗口末尾
+*/
+static int lzss_flush(lzss_decoder_t *dec)
+{
+    const uint8_t *window = (const uint8_t *)dec->window;
+    uint32_t size = dec->out - dec->flushed;
+
+    if (size == 0) {
+        return 0;
+    }
+    if (dec->output(dec->arg,window + (dec->flushed & (LZSS_WINDOW_SIZE - 1)),size) != 0) {
+        return -1;
+    }
+    dec->flushed = dec->out;
+
+    return 0;
+}
+
+/*
+* @brief 输出一个字节
+* @param dec 解压器
+* @param c 字节
+* @return 0 成功 -1 失败
+* @note
+*/
+static int lzss_put(lzss_decoder_t *dec,uint8_t c)
+{
+    ((uint8_t *)dec->window)[dec->out & (LZSS_WINDOW_SIZE - 1)] = c;
+    dec->out ++;
+    if ((dec->out & (LZSS_FLUSH_SIZE - 1)) == 0 || dec->out == dec->size) {
+        return lzss_flush(dec);
+    }
+
+    return 0;
+}
+
+/*
+* @brief 复制匹配
+* @param dec 解压器
+* @param length 长度
+* @return 0 成功 -1 失败
+* @note 距离可以小于长度(重复数据)
+*/
+static int lzss_copy(lzss_decoder_t *dec,uint32_t length)
+{
+    const uint8_t *window = (const uint8_t *)dec->window;
+    uint32_t distance = (dec->token & ((1UL << dec->window_bits) - 1)) + 1;
+
+    if (distance > dec->out) {
+        log_error("lzss distance:%d > output:%d.\r\n",distance,dec->out);
+        return -1;
+    }
+    if (length > dec->size - dec->out) {
+        log_error("lzss match over size:%d.\r\n",dec->size);
+        return -1;
+    }
+    while (length -- > 0) {
+        if (lzss_put(dec,window[(dec->out - distance) & (LZSS_WINDOW_SIZE - 1)]) != 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+* @brief 流式解压
+* @param dec 解压器
+* @param src 压缩数据,任意长度
+* @param size 数据量
+* @return 0 成功 -1 失败
+* @note 每满LZSS_FLUSH_SIZE字节和最后不满的数据调用一次输出函数;
+*       头部收齐后dec->size和dec->md5有效,输出函数第一次调用前已经收齐
+*/
+int lzss_decode(lzss_decoder_t *dec,const uint8_t *src,uint32_t size)
+{
+    uint32_t copy;
+    uint32_t length_max;
+    uint8_t c;
+
+    while (size > 0) {
+        switch (dec->state) {
+        case LZSS_STATE_HEAD:
+            copy = LZSS_HEADER_SIZE - dec->head_cnt;
+            if (copy > size) {
+                copy = size;
+            }
+            memcpy(&dec->head[dec->head_cnt],src,copy);
+            dec->head_cnt += copy;
+            src += copy;
+            size -= copy;
+            if (dec->head_cnt == LZSS_HEADER_SIZE) {
+                if (lzss_parse_head(dec) != 0) {
+                    goto err_exit;
+                }
+                dec->state = dec->size == 0 ? LZSS_STATE_DONE : LZSS_STATE_FLAG;
+            }
+            continue;
+        case LZSS_STATE_DONE:
+            log_error("lzss data after end.\r\n");
+            goto err_exit;
+        case LZSS_STATE_ERROR:
+            return -1;
+        default:
+            break;
+        }
+
+        c = *src ++;
+        size --;
+        length_max = (1UL << (16 - dec->window_bits)) - 1;
+        switch (dec->state) {
+        case LZSS_STATE_FLAG:
+            dec->flags = c;
+            dec->flag_cnt = 8;
+            dec->state = LZSS_STATE_ITEM;
+            continue;
+        case LZSS_STATE_ITEM:
+            if (dec->flags & 0x01) {
+                if (lzss_put(dec,c) != 0) {
+                    goto err_exit;
+                }
+                break;
+            }
+            dec->token = c;
+            dec->state = LZSS_STATE_TOKEN;
+            continue;
+        case LZSS_STATE_TOKEN:
+            dec->token |= (uint16_t)c << 8;
+            if ((uint32_t)(dec->token >> dec->window_bits) == length_max) {
+                dec->state = LZSS_STATE_EXTRA;
+                continue;
+            }
+            if (lzss_copy(dec,(dec->token >> dec->window_bits) + LZSS_MIN_MATCH) != 0) {
+                goto err_exit;
+            }
+            break;
+        case LZSS_STATE_EXTRA:
+            if (lzss_copy(dec,length_max + LZSS_MIN_MATCH + c) != 0) {
+                goto err_exit;
+            }
+            break;
+        }
+
+        /*一项结束*/
+        dec->flags >>= 1;
+        dec->flag_cnt --;
+        if (dec->out == dec->size) {
+            dec->state = LZSS_STATE_DONE;
+        } else {
+            dec->state = dec->flag_cnt == 0 ? LZSS_STATE_FLAG : LZSS_STATE_ITEM;
+        }
+    }
+
+    return 0;
+
+err_exit:
+    dec->state = LZSS_STATE_ERROR;
+    return -1;
+}
+
+/*
+* @brief 解压是否完成
+* @param dec 解压器
+* @return true 完成 false 未完成
+* @note 完成时全部数据已经输出
+*/
+bool lzss_decode_is_done(lzss_decoder_t *dec)
+{
+    return dec->state == LZSS_STATE_DONE && dec->flushed == dec->size;
+}
@@ -0,0 +1,101 @@
+#ifndef  __LZSS_H__
+#define  __LZSS_H__
+#include "stdbool.h"
+#include "stdint.h"
+
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+/*
+* 压缩格式(tools/lzss_pack.py生成):
+* 头部28字节:"LZS1" 窗口位数W(1) 保留(3) 解压后大小(4,小端) 解压后MD5(16)
+* 数据:标志字节(低位先用,1:字面字节 0:匹配)+8项;
+*      匹配为2字节小端:低W位 距离-1,高16-W位 长度-3;长度位全1时再跟1字节附加长度
+*/
+
+/********************    配置开始    **************************************/
+#define  LZSS_WINDOW_BITS                  11   /*支持的最大窗口位数,窗口占用(1<<LZSS_WINDOW_BITS)字节RAM*/
+#define  LZSS_FLUSH_SIZE                   256  /*每解压多少字节交给输出函数一次,和flash页大小一致*/
+/********************    配置结束    **************************************/
+
+#define  LZSS_WINDOW_SIZE                  (1UL << LZSS_WINDOW_BITS)
+#define  LZSS_WINDOW_BITS_MIN              8
+#define  LZSS_MIN_MATCH                    3
+#define  LZSS_HEADER_SIZE                  28
+#define  LZSS_MAGIC                        "LZS1"
+#define  LZSS_MAGIC_SIZE                   4
+
+#if  (LZSS_FLUSH_SIZE & (LZSS_FLUSH_SIZE - 1)) != 0 || LZSS_FLUSH_SIZE > LZSS_WINDOW_SIZE || \
+     LZSS_WINDOW_BITS > 15 || LZSS_WINDOW_BITS < LZSS_WINDOW_BITS_MIN
+#error "LZSS_WINDOW_BITS or LZSS_FLUSH_SIZE invalid."
+#endif
+
+/*解压数据输出函数,0:成功 -1:失败*/
+typedef int (*lzss_output_t)(void *arg,const uint8_t *data,uint32_t size);
+
+typedef struct
+{
+    uint8_t       state;
+    uint8_t       window_bits;/*文件的窗口位数*/
+    uint8_t       flags;      /*当前标志字节*/
+    uint8_t       flag_cnt;   /*当前标志字节剩余项数*/
+    uint16_t      token;      /*正在读取的匹配*/
+    uint16_t      head_cnt;   /*已收到的头部字节数*/
+    uint32_t      size;       /*解压后大小*/
+    uint32_t      out;        /*已解压字节数*/
+    uint32_t      flushed;    /*已输出字节数*/
+    uint8_t       md5[16];    /*解压后MD5*/
+    uint8_t       head[LZSS_HEADER_SIZE];
+    lzss_output_t output;
+    void         *arg;
+    uint32_t      window[LZSS_WINDOW_SIZE / 4];/*4字节对齐,输出的整段数据可以直接编程*/
+}lzss_decoder_t;
+
+
+/*
+* @brief 是否是压缩文件
+* @param src 文件开始的数据
+* @param size 数据量
+* @return true 是 false 不是
+* @note 应用程序开头是栈顶地址,不会和"LZS1"冲突
+*/
+bool lzss_is_compressed(const uint8_t *src,uint32_t size);
+
+/*
+* @brief 解压初始化
+* @param dec 解压器
+* @param output 输出函数
+* @param arg 输出函数参数
+* @return 无
+* @note
+*/
+void lzss_decoder_init(lzss_decoder_t *dec,lzss_output_t output,void *arg);
+
+/*
+* @brief 流式解压
+* @param dec 解压器
+* @param src 压缩数据,任意长度
+* @param size 数据量
+* @return 0 成功 -1 失败
+* @note 每满LZSS_FLUSH_SIZE字节和最后不满的数据调用一次输出函数;
+*       头部收齐后dec->size和dec->md5有效,输出函数第一次调用前已经收齐
+*/
+int lzss_decode(lzss_decoder_t *dec,const uint8_t *src,uint32_t size);
+
+/*
+* @brief 解压是否完成
+* @param dec 解压器
+* @return true 完成 false 未完成
+* @note 完成时全部数据已经输出
+*/
+bool lzss_decode_is_done(lzss_decoder_t *dec);
+
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif
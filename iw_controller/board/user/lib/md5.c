@@ -209,4 +209,69 @@ void md5(const char *message, long len, char *output) {
     i += numbytes;
   }
   word32tobytes(d, output);
-}
\ No newline at end of file
+}
+
+
+static void digest_block(WORD32 *d, const char *pt) {
+  WORD32 d_old[4];
+  WORD32 wbuff[16];
+  d_old[0]=d[0]; d_old[1]=d[1]; d_old[2]=d[2]; d_old[3]=d[3];
+  bytestoword32(wbuff, pt);
+  digest(wbuff, d);
+  d[0]+=d_old[0]; d[1]+=d_old[1]; d[2]+=d_old[2]; d[3]+=d_old[3];
+}
+
+
+void md5_init(md5_ctx_t *ctx) {
+  inic_digest(ctx->d);
+  ctx->len = 0;
+  ctx->cnt = 0;
+}
+
+
+void md5_update(md5_ctx_t *ctx, const char *message, long len) {
+  int num;
+  ctx->len += len;
+  /* complete the pending block first */
+  if (ctx->cnt > 0) {
+    num = 64 - ctx->cnt;
+    if (num > len) num = (int)len;
+    memcpy(ctx->buff + ctx->cnt, message, num);
+    ctx->cnt += num;
+    message += num;
+    len -= num;
+    if (ctx->cnt < 64)
+      return;
+    digest_block(ctx->d, ctx->buff);
+    ctx->cnt = 0;
+  }
+  /* whole blocks straight from the message */
+  while (len >= 64) {
+    digest_block(ctx->d, message);
+    message += 64;
+    len -= 64;
+  }
+  if (len > 0) {
+    memcpy(ctx->buff, message, len);
+    ctx->cnt = (int)len;
+  }
+}
+
+
+void md5_final(md5_ctx_t *ctx, char *output) {
+  WORD32 d_old[4];
+  WORD32 wbuff[16];
+  ctx->buff[ctx->cnt++] = '\200';
+  if (ctx->cnt > 64 - 8) {
+    memset(ctx->buff + ctx->cnt, 0, 64 - ctx->cnt);
+    digest_block(ctx->d, ctx->buff);
+    ctx->cnt = 0;
+  }
+  memset(ctx->buff + ctx->cnt, 0, 64 - ctx->cnt);
+  d_old[0]=ctx->d[0]; d_old[1]=ctx->d[1]; d_old[2]=ctx->d[2]; d_old[3]=ctx->d[3];
+  bytestoword32(wbuff, ctx->buff);
+  put_length(wbuff, ctx->len);
+  digest(wbuff, ctx->d);
+  ctx->d[0]+=d_old[0]; ctx->d[1]+=d_old[1]; ctx->d[2]+=d_old[2]; ctx->d[3]+=d_old[3];
+  word32tobytes(ctx->d, output);
+}
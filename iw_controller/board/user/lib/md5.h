@@ -1,10 +1,26 @@
 #ifndef __MD5_H__
 #define __MD5_H__
 
-
+#include "stdint.h"
 
 #define HASHSIZE       16
 
+/* incremental md5 context */
+typedef struct {
+  uint32_t d[4];
+  long     len;
+  int      cnt;
+  char     buff[64];
+} md5_ctx_t;
+
 void md5(const char *message, long len, char *output);
 
+/**
+*  incremental md5: md5_init, md5_update as many times as needed,
+*  then md5_final gives the same value as md5() over the whole message.
+*/
+void md5_init(md5_ctx_t *ctx);
+void md5_update(md5_ctx_t *ctx, const char *message, long len);
+void md5_final(md5_ctx_t *ctx, char *output);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,244 @@
+/*****************************************************************************
+*  msg_pool
+*  Copyright (C) 2019 wkxboot 1131204425@qq.com.
+*
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License version 3 as
+*  published by the Free Software Foundation.
+*
+*  @file     msg_pool.c
+*  @brief    固定块消息池,发送者分配,接收者释放
+*  @author   wkxboot
+*  @email    1131204425@qq.com
+*  @version  v1.0.0
+*  @date     2019/1/10
+*  @license  GNU General Public License (GPL)
+*
+*
+*****************************************************************************/
+#include "fsl_common.h"
+#include "cmsis_os.h"
+#include "string.h"
+#include "msg_pool.h"
+#include "log.h"
+
+
+static msg_pool_t *msg_pool_registry[MSG_POOL_CNT_MAX];
+static uint8_t msg_pool_cnt;
+
+
+/*
+* @brief 消息池初始化并注册
+* @param pool 消息池
+* @return -1 失败
+* @return  0 成功
+* @note 在创建任务之前调用
+*/
+int msg_pool_init(msg_pool_t *pool)
+{
+    if (pool->block_cnt == 0 || pool->block_cnt > MSG_POOL_BLOCK_CNT_MAX) {
+        log_error("msg pool:%s block cnt:%d invalid.\r\n",pool->name,pool->block_cnt);
+        return -1;
+    }
+    if (msg_pool_cnt >= MSG_POOL_CNT_MAX) {
+        log_error("msg pool registry full.\r\n");
+        return -1;
+    }
+    pool->free_map = pool->block_cnt == 32 ? 0xFFFFFFFF : (1UL << pool->block_cnt) - 1;
+    pool->used = 0;
+    pool->used_max = 0;
+    pool->alloc_cnt = 0;
+    pool->fail_cnt = 0;
+    pool->free_err_cnt = 0;
+    pool->fail_logged = 0;
+    pool->free_err_logged = 0;
+    msg_pool_registry[msg_pool_cnt ++] = pool;
+
+    return 0;
+}
+
+/*
+* @brief 从消息池分配一个消息
+* @param pool 消息池
+* @return NULL 消息池耗尽
+* @return 消息指针
+* @note 可以在中断中调用
+*/
+void *msg_pool_alloc(msg_pool_t *pool)
+{
+    UBaseType_t mask;
+    uint8_t index;
+    void *msg = NULL;
+
+    mask = portSET_INTERRUPT_MASK_FROM_ISR();
+    if (pool->free_map == 0) {
+        pool->fail_cnt ++;
+    } else {
+        index = __CLZ(__RBIT(pool->free_map));
+        pool->free_map &= ~(1UL << index);
+        pool->used ++;
+        if (pool->used > pool->used_max) {
+            pool->used_max = pool->used;
+        }
+        pool->alloc_cnt ++;
+        msg = pool->block + index * pool->block_size;
+    }
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+
+    return msg;
+}
+
+/*
+* @brief 消息归还给消息池
+* @param pool 消息池
+* @param msg 消息指针
+* @return -1 失败,不属于此消息池或者重复释放
+* @return  0 成功
+* @note 可以在中断中调用
+*/
+int msg_pool_free(msg_pool_t *pool,void *msg)
+{
+    UBaseType_t mask;
+    uint32_t offset,index;
+    int rc = -1;
+
+    offset = (uint8_t *)msg - pool->block;
+    index = offset / pool->block_size;
+
+    mask = portSET_INTERRUPT_MASK_FROM_ISR();
+    if ((uint8_t *)msg >= pool->block && index < pool->block_cnt && offset % pool->block_size == 0 && (pool->free_map & (1UL << index)) == 0) {
+        pool->free_map |= 1UL << index;
+        pool->used --;
+        rc = 0;
+    } else {
+        pool->free_err_cnt ++;
+    }
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+
+    return rc;
+}
+
+/*
+* @brief 发送消息池中的消息
+* @param pool 消息池
+* @param id 消息队列
+* @param msg 消息指针,由msg_pool_alloc分配
+* @param timeout 发送超时时间
+* @return osOK 成功,消息所有权转移给接收者,由接收者释放
+* @return 其他 失败,消息已归还给消息池
+* @note
+*/
+osStatus msg_pool_put(msg_pool_t *pool,osMessageQId id,void *msg,uint32_t timeout)
+{
+    osStatus status;
+
+    status = osMessagePut(id,(uint32_t)msg,timeout);
+    if (status != osOK) {
+        msg_pool_free(pool,msg);
+    }
+
+    return status;
+}
+
+/*
+* @brief 复制消息到消息池并发送
+* @param pool 消息池
+* @param id 消息队列
+* @param msg 待复制的消息,大小为消息池块大小
+* @param timeout 发送超时时间
+* @return osOK 成功,消息所有权转移给接收者,由接收者释放
+* @return osErrorNoMemory 消息池耗尽
+* @return 其他 发送失败,消息已归还给消息池
+* @note 发送者的消息可以在栈上,返回后即可复用;可能在中断中调用,耗尽只计数,由msg_pool_check输出
+*/
+osStatus msg_pool_send(msg_pool_t *pool,osMessageQId id,const void *msg,uint32_t timeout)
+{
+    void *block;
+
+    block = msg_pool_alloc(pool);
+    if (block == NULL) {
+        return osErrorNoMemory;
+    }
+    memcpy(block,msg,pool->block_size);
+
+    return msg_pool_put(pool,id,block,timeout);
+}
+
+/*
+* @brief 取出消息队列中残留的消息并归还给消息池
+* @param pool 消息池
+* @param id 消息队列
+* @return 释放的消息数量
+* @note 用于丢弃超时后才到达的回应
+*/
+int msg_pool_flush(msg_pool_t *pool,osMessageQId id)
+{
+    int cnt = 0;
+    osEvent os_event;
+
+    while (1) {
+        os_event = osMessageGet(id,0);
+        if (os_event.status != osEventMessage) {
+            break;
+        }
+        msg_pool_free(pool,os_event.value.p);
+        cnt ++;
+    }
+    if (cnt > 0) {
+        log_warning("msg pool:%s flush %d stale msg.\r\n",pool->name,cnt);
+    }
+
+    return cnt;
+}
+
+/*
+* @brief 日志输出上次检查之后耗尽或者非法释放过的消息池
+* @param 无
+* @return 无
+* @note 在任务中周期调用,分配和释放可能在中断中,不在那里输出日志
+*/
+void msg_pool_check(void)
+{
+    msg_pool_t *pool;
+    uint32_t fail_cnt,free_err_cnt;
+
+    for (uint8_t i = 0;i < msg_pool_cnt;i ++) {
+        pool = msg_pool_registry[i];
+        /*32位读取是原子的,计数在中断中增加也不会读到一半*/
+        fail_cnt = pool->fail_cnt;
+        free_err_cnt = pool->free_err_cnt;
+        if (fail_cnt != pool->fail_logged) {
+            log_error("msg pool:%s exhausted %d times.total:%d.\r\n",pool->name,fail_cnt - pool->fail_logged,fail_cnt);
+            pool->fail_logged = fail_cnt;
+        }
+        if (free_err_cnt != pool->free_err_logged) {
+            log_error("msg pool:%s invalid free %d times.total:%d.\r\n",pool->name,free_err_cnt - pool->free_err_logged,free_err_cnt);
+            pool->free_err_logged = free_err_cnt;
+        }
+    }
+}
+
+/*
+* @brief 日志输出所有消息池使用情况
+* @param 无
+* @return 无
+* @note
+*/
+void msg_pool_dump(void)
+{
+    msg_pool_t *pool;
+
+    for (uint8_t i = 0;i < msg_pool_cnt;i ++) {
+        pool = msg_pool_registry[i];
+        log_info("pool:%s size:%d cnt:%d used:%d max:%d alloc:%d fail:%d free err:%d\r\n",
+                 pool->name,
+                 pool->block_size,
+                 pool->block_cnt,
+                 pool->used,
+                 pool->used_max,
+                 pool->alloc_cnt,
+                 pool->fail_cnt,
+                 pool->free_err_cnt);
+    }
+}
@@ -0,0 +1,133 @@
+#ifndef  __MSG_POOL_H__
+#define  __MSG_POOL_H__
+#include "stdint.h"
+#include "stdbool.h"
+#include "cmsis_os.h"
+
+#ifdef  __cplusplus
+#define MSG_POOL_BEGIN  extern "C" {
+#define MSG_POOL_END    }
+#else
+#define MSG_POOL_BEGIN
+#define MSG_POOL_END
+#endif
+
+
+MSG_POOL_BEGIN
+
+/********************    配置开始    **************************************/
+#define  MSG_POOL_BLOCK_CNT_MAX                32 /*每个消息池的最大消息块数量*/
+#define  MSG_POOL_CNT_MAX                      12 /*可注册的消息池数量,不能小于TASKS_MSG_POOL_CNT*/
+/********************    配置结束    **************************************/
+
+/*固定块消息池,一个消息类型对应一个消息池*/
+typedef struct
+{
+    const char *name;
+    uint8_t    *block;
+    uint16_t   block_size;
+    uint8_t    block_cnt;
+    uint8_t    used;          /*当前使用数量*/
+    uint8_t    used_max;      /*最大使用数量*/
+    uint32_t   free_map;      /*bit=1 对应消息块空闲*/
+    uint32_t   alloc_cnt;     /*分配成功次数*/
+    uint32_t   fail_cnt;      /*消息池耗尽次数*/
+    uint32_t   free_err_cnt;  /*非法释放次数*/
+    uint32_t   fail_logged;   /*已经输出日志的耗尽次数*/
+    uint32_t   free_err_logged; /*已经输出日志的非法释放次数*/
+}msg_pool_t;
+
+/*
+* @brief 定义消息池和它的静态存储
+* @param pool 消息池名称
+* @param type 消息类型
+* @param cnt 消息块数量
+*/
+#define  MSG_POOL_DEF(pool,type,cnt)                                           \
+static type pool##_block[(cnt)];                                               \
+msg_pool_t pool = { #pool,(uint8_t *)pool##_block,sizeof(type),(cnt) }
+
+
+/*
+* @brief 消息池初始化并注册
+* @param pool 消息池
+* @return -1 失败
+* @return  0 成功
+* @note 在创建任务之前调用
+*/
+int msg_pool_init(msg_pool_t *pool);
+
+/*
+* @brief 从消息池分配一个消息
+* @param pool 消息池
+* @return NULL 消息池耗尽
+* @return 消息指针
+* @note 可以在中断中调用
+*/
+void *msg_pool_alloc(msg_pool_t *pool);
+
+/*
+* @brief 消息归还给消息池
+* @param pool 消息池
+* @param msg 消息指针
+* @return -1 失败,不属于此消息池或者重复释放
+* @return  0 成功
+* @note 可以在中断中调用
+*/
+int msg_pool_free(msg_pool_t *pool,void *msg);
+
+/*
+* @brief 发送消息池中的消息
+* @param pool 消息池
+* @param id 消息队列
+* @param msg 消息指针,由msg_pool_alloc分配
+* @param timeout 发送超时时间
+* @return osOK 成功,消息所有权转移给接收者,由接收者释放
+* @return 其他 失败,消息已归还给消息池
+* @note
+*/
+osStatus msg_pool_put(msg_pool_t *pool,osMessageQId id,void *msg,uint32_t timeout);
+
+/*
+* @brief 复制消息到消息池并发送
+* @param pool 消息池
+* @param id 消息队列
+* @param msg 待复制的消息,大小为消息池块大小
+* @param timeout 发送超时时间
+* @return osOK 成功,消息所有权转移给接收者,由接收者释放
+* @return osErrorNoMemory 消息池耗尽
+* @return 其他 发送失败,消息已归还给消息池
+* @note 发送者的消息可以在栈上,返回后即可复用;可能在中断中调用,耗尽只计数,由msg_pool_check输出
+*/
+osStatus msg_pool_send(msg_pool_t *pool,osMessageQId id,const void *msg,uint32_t timeout);
+
+/*
+* @brief 取出消息队列中残留的消息并归还给消息池
+* @param pool 消息池
+* @param id 消息队列
+* @return 释放的消息数量
+* @note 用于丢弃超时后才到达的回应
+*/
+int msg_pool_flush(msg_pool_t *pool,osMessageQId id);
+
+/*
+* @brief 日志输出上次检查之后耗尽或者非法释放过的消息池
+* @param 无
+* @return 无
+* @note 在任务中周期调用,分配和释放可能在中断中,不在那里输出日志
+*/
+void msg_pool_check(void);
+
+/*
+* @brief 日志输出所有消息池使用情况
+* @param 无
+* @return 无
+* @note
+*/
+void msg_pool_dump(void);
+
+
+
+MSG_POOL_END
+
+#endif
@@ -66,9 +66,10 @@
 #define configINCLUDE_FREERTOS_TASK_C_ADDITIONS_H 1
 
 /* Memory allocation related definitions. */
-#define configSUPPORT_STATIC_ALLOCATION         0
+#define configSUPPORT_STATIC_ALLOCATION         1
 #define configSUPPORT_DYNAMIC_ALLOCATION        1
-#define configTOTAL_HEAP_SIZE                   ((size_t)(50 * 1024))
+/* All tasks, queues and timers use static storage, the heap only backs late additions. */
+#define configTOTAL_HEAP_SIZE                   ((size_t)(4 * 1024))
 #define configAPPLICATION_ALLOCATED_HEAP        0
 
 /* Hook function related definitions. */
@@ -79,9 +80,13 @@
 #define configUSE_DAEMON_TASK_STARTUP_HOOK      0
 
 /* Run time and task stats gathering related definitions. */
-#define configGENERATE_RUN_TIME_STATS           0
+#define configGENERATE_RUN_TIME_STATS           1
 #define configUSE_TRACE_FACILITY                1
 #define configUSE_STATS_FORMATTING_FUNCTIONS    0
+/* Run time counter is a free running 1us CTIMER, see run_time_stats.c. */
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() extern void run_time_stats_timer_init(void); \
+                                                 run_time_stats_timer_init()
+#define portGET_RUN_TIME_COUNTER_VALUE()         run_time_stats_get_counter()
 
 /* Task aware debugging. */
 #define configRECORD_STACK_HIGH_ADDRESS         1
@@ -148,9 +153,10 @@ standard names. */
 #define xPortPendSVHandler PendSV_Handler
 
 
-#define traceTASK_SWITCHED_IN()  extern void StartIdleMonitor(void); \
-                                             StartIdleMonitor()
-#define traceTASK_SWITCHED_OUT() extern void EndIdleMonitor(void); \
-                                             EndIdleMonitor()
+#if defined(__ICCARM__) || defined(__CC_ARM) || defined(__GNUC__)
+extern uint32_t run_time_stats_get_counter(void);
+/* Kernel trace hook macros of the debug tools, see trace_hooks.h. */
+#include "trace_hooks.h"
+#endif
 
 #endif /* FREERTOS_CONFIG_H */
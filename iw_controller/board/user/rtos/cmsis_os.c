@@ -1149,7 +1149,8 @@ osEvent osMessageGet (osMessageQId queue_id, uint32_t millisec)
   osEvent event;
   
   event.def.message_id = queue_id;
-  event.value.v = 0;
+  /* clear the whole union, the queue item is only the 32-bit value */
+  event.value.p = NULL;
   
   if (queue_id == NULL) {
     event.status = osErrorParameter;
@@ -1604,6 +1605,7 @@ osEvent osMessagePeek (osMessageQId queue_id, uint32_t millisec)
   osEvent event;
   
   event.def.message_id = queue_id;
+  event.value.p = NULL;
   
   if (queue_id == NULL) {
     event.status = osErrorParameter;
@@ -36,6 +36,7 @@
 #include "tasks_init.h"
 #include "device_env.h"
 #include "firmware_version.h"
+#include "trace.h"
 #include "log.h"
 
 
@@ -102,6 +103,8 @@ int main(void)
         }
 
     }
+    /*事件跟踪在创建任务前开始*/
+    trace_init();
     tasks_init();
     
     /* Start scheduler */
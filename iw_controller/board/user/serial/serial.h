@@ -249,8 +249,21 @@ int serial_complete(serial_handle_t *handle,uint32_t timeout);
   #endif
 #endif  
   
-  
-  
+/*
+*  serial critical configuration for linux simulation(freertos posix port)
+*/
+#if defined(__linux__)
+  #include "FreeRTOS.h"
+  #include "task.h"
+
+  #define SERIAL_ENTER_CRITICAL()                               \
+  {                                                             \
+  taskENTER_CRITICAL();
+
+  #define SERIAL_EXIT_CRITICAL()                                \
+  taskEXIT_CRITICAL();                                          \
+  }
+#endif
 
 
 
@@ -0,0 +1,290 @@
+/*****************************************************************************
+*  posix serial pty hal driver
+*  Copyright (C) 2019 wkxboot 1131204425@qq.com.
+*
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License version 3 as
+*  published by the Free Software Foundation.
+*
+*  @file     posix_serial_pty_hal_driver.c
+*  @brief    posix serial pty hal driver
+*  @author   wkxboot
+*  @email    1131204425@qq.com
+*  @version  v1.0.0
+*  @date     2019/1/10
+*  @license  GNU General Public License (GPL)
+*
+*
+*****************************************************************************/
+#if defined(__linux__)
+
+#define  _GNU_SOURCE
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <poll.h>
+#include "posix_serial_pty_hal_driver.h"
+#include "fsl_common.h"
+#include "sim.h"
+
+
+/* *****************************************************************************
+*
+*        serial uart hal driver在linux仿真(freertos posix port)下的移植
+*        每个端口对应一个伪终端,主机测试工具打开从设备即可与任务通信
+*
+********************************************************************************/
+/*posix serial pty驱动结构体*/
+serial_hal_driver_t posix_serial_pty_hal_driver = {
+.init = posix_serial_pty_hal_init,
+.deinit = posix_serial_pty_hal_deinit,
+.enable_txe_it = posix_serial_pty_hal_enable_txe_it,
+.disable_txe_it = posix_serial_pty_hal_disable_txe_it,
+.enable_rxne_it = posix_serial_pty_hal_enable_rxne_it,
+.disable_rxne_it = posix_serial_pty_hal_disable_rxne_it
+};
+
+typedef struct
+{
+    int  fd;
+    bool txe_it;
+    bool rxne_it;
+    bool tx_pending;      /*已经从发送缓存取出,还没有写入伪终端的字节*/
+    char tx_byte;
+    char slave_name[32];
+}posix_serial_pty_t;
+
+static posix_serial_pty_t pty[POSIX_SERIAL_PTY_PORT_CNT_MAX] = {
+[0 ... POSIX_SERIAL_PTY_PORT_CNT_MAX - 1] = { .fd = -1 }
+};
+
+/*端口对应的仿真FLEXCOMM中断,中断处理调用posix_serial_pty_hal_isr*/
+static const IRQn_Type pty_irq[POSIX_SERIAL_PTY_PORT_CNT_MAX] = {
+FLEXCOMM0_IRQn,FLEXCOMM1_IRQn,FLEXCOMM2_IRQn,FLEXCOMM3_IRQn,FLEXCOMM4_IRQn,
+FLEXCOMM5_IRQn,FLEXCOMM6_IRQn,FLEXCOMM7_IRQn,FLEXCOMM8_IRQn,FLEXCOMM9_IRQn
+};
+
+
+/*
+* @brief 检查伪终端的收发事件
+* @param 无
+* @return 无
+* @note 每个节拍在仿真中断中调用,有可读数据或者待发送数据时挂起端口的FLEXCOMM中断
+*/
+static void posix_serial_pty_hal_poll(void)
+{
+    struct pollfd fds;
+
+    for (uint8_t port = 0;port < POSIX_SERIAL_PTY_PORT_CNT_MAX;port ++) {
+        if (pty[port].fd < 0) {
+            continue;
+        }
+        if (pty[port].txe_it || pty[port].tx_pending) {
+            NVIC_SetPendingIRQ(pty_irq[port]);
+            continue;
+        }
+        if (pty[port].rxne_it) {
+            fds.fd = pty[port].fd;
+            fds.events = POLLIN;
+            if (poll(&fds,1,0) == 1 && (fds.revents & POLLIN)) {
+                NVIC_SetPendingIRQ(pty_irq[port]);
+            }
+        }
+    }
+}
+
+
+/*
+* @brief 仿真串口初始化驱动,为端口创建一个伪终端
+* @param port uart端口号
+* @param bauds 波特率(仿真忽略)
+* @param data_bits 数据宽度(仿真忽略)
+* @param stop_bit 停止位(仿真忽略)
+* @return -1 失败
+* @return  0 成功
+* @note 伪终端从设备名称通过posix_serial_pty_hal_slave_name获取
+*/
+int posix_serial_pty_hal_init(uint8_t port,uint32_t baud_rates,uint8_t data_bits,uint8_t stop_bits)
+{
+    int fd;
+    struct termios tio;
+    static bool poll_registered = false;
+
+    if (port >= POSIX_SERIAL_PTY_PORT_CNT_MAX) {
+        return -1;
+    }
+    if (poll_registered == false) {
+        if (sim_poll_register(posix_serial_pty_hal_poll) != 0) {
+            return -1;
+        }
+        poll_registered = true;
+    }
+    if (pty[port].fd >= 0) {
+        return 0;
+    }
+
+    fd = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (fd < 0) {
+        return -1;
+    }
+    /*复位时重新执行程序,主设备不能留给新的进程*/
+    fcntl(fd,F_SETFD,FD_CLOEXEC);
+    if (grantpt(fd) != 0 || unlockpt(fd) != 0 || ptsname_r(fd,pty[port].slave_name,sizeof(pty[port].slave_name)) != 0) {
+        close(fd);
+        return -1;
+    }
+    /*原始模式,不做行处理和回显*/
+    if (tcgetattr(fd,&tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(fd,TCSANOW,&tio);
+    }
+    pty[port].fd = fd;
+    pty[port].txe_it = false;
+    pty[port].rxne_it = false;
+    pty[port].tx_pending = false;
+    sim_serial_port(port,pty[port].slave_name);
+
+    NVIC_SetPriority(pty_irq[port],3);
+    EnableIRQ(pty_irq[port]);
+    return 0;
+}
+
+
+/*
+* @brief 仿真串口去初始化驱动
+* @param port uart端口号
+* @return = 0 成功
+* @return < 0 失败
+* @note
+*/
+int posix_serial_pty_hal_deinit(uint8_t port)
+{
+    if (port >= POSIX_SERIAL_PTY_PORT_CNT_MAX) {
+        return -1;
+    }
+    if (pty[port].fd >= 0) {
+        DisableIRQ(pty_irq[port]);
+        close(pty[port].fd);
+        pty[port].fd = -1;
+        pty[port].tx_pending = false;
+    }
+    return 0;
+}
+
+
+/*
+* @brief 仿真串口发送为空中断使能驱动
+* @param port uart端口号
+* @return 无
+* @note
+*/
+void posix_serial_pty_hal_enable_txe_it(uint8_t port)
+{
+    if (port < POSIX_SERIAL_PTY_PORT_CNT_MAX) {
+        pty[port].txe_it = true;
+    }
+}
+
+
+/*
+* @brief 仿真串口发送为空中断禁止驱动
+* @param port uart端口号
+* @return 无
+* @note
+*/
+void posix_serial_pty_hal_disable_txe_it(uint8_t port)
+{
+    if (port < POSIX_SERIAL_PTY_PORT_CNT_MAX) {
+        pty[port].txe_it = false;
+    }
+}
+
+
+/*
+* @brief 仿真串口接收不为空中断使能驱动
+* @param port uart端口号
+* @return 无
+* @note
+*/
+void posix_serial_pty_hal_enable_rxne_it(uint8_t port)
+{
+    if (port < POSIX_SERIAL_PTY_PORT_CNT_MAX) {
+        pty[port].rxne_it = true;
+    }
+}
+
+
+/*
+* @brief 仿真串口接收不为空中断禁止驱动
+* @param port uart端口号
+* @return 无
+* @note
+*/
+void posix_serial_pty_hal_disable_rxne_it(uint8_t port)
+{
+    if (port < POSIX_SERIAL_PTY_PORT_CNT_MAX) {
+        pty[port].rxne_it = false;
+    }
+}
+
+
+/*
+* @brief 获取端口对应的伪终端从设备名称
+* @param port uart端口号
+* @return NULL 端口未初始化
+* @return 其他 从设备名称,例如/dev/pts/3
+* @note
+*/
+const char *posix_serial_pty_hal_slave_name(uint8_t port)
+{
+    if (port >= POSIX_SERIAL_PTY_PORT_CNT_MAX || pty[port].fd < 0) {
+        return NULL;
+    }
+    return pty[port].slave_name;
+}
+
+
+/*
+* @brief 仿真串口中断routine驱动
+* @param handle uart的serial句柄
+* @return 无
+* @note 由仿真FLEXCOMM中断调用,对应nxp_serial_uart_hal_isr
+*/
+void posix_serial_pty_hal_isr(serial_handle_t *handle)
+{
+    ssize_t result;
+    char  send_byte,recv_byte;
+    posix_serial_pty_t *p;
+
+    if (handle->port >= POSIX_SERIAL_PTY_PORT_CNT_MAX) {
+        return;
+    }
+    p = &pty[handle->port];
+    if (p->fd < 0) {
+        return;
+    }
+
+    /*接收中断处理*/
+    while (p->rxne_it && read(p->fd,&recv_byte,1) == 1) {
+        isr_serial_put_byte_from_recv(handle,recv_byte);
+    }
+    /*发送中断处理,伪终端写满时保留已经取出的字节,下次中断重新发送*/
+    while (p->txe_it || p->tx_pending) {
+        if (p->tx_pending == false) {
+            if (isr_serial_get_byte_to_send(handle,&send_byte) != 1) {
+                break;
+            }
+            p->tx_byte = send_byte;
+            p->tx_pending = true;
+        }
+        result = write(p->fd,&p->tx_byte,1);
+        if (result != 1) {
+            break;
+        }
+        p->tx_pending = false;
+    }
+}
+
+#endif /* __linux__ */
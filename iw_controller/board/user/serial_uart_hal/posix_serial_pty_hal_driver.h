@@ -0,0 +1,95 @@
+#ifndef  __POSIX_SERIAL_PTY_HAL_DRIVER_H__
+#define  __POSIX_SERIAL_PTY_HAL_DRIVER_H__
+
+#ifdef  __cplusplus
+    extern "C" {
+#endif
+
+#include "stdint.h"
+#include "serial.h"
+
+/*仿真支持的最大端口数量,与lpc54606 flexcomm数量一致*/
+#define  POSIX_SERIAL_PTY_PORT_CNT_MAX              10
+
+extern serial_hal_driver_t posix_serial_pty_hal_driver;
+/*
+* @brief 仿真串口初始化驱动,为端口创建一个伪终端
+* @param port uart端口号
+* @param bauds 波特率(仿真忽略)
+* @param data_bits 数据宽度(仿真忽略)
+* @param stop_bit 停止位(仿真忽略)
+* @return -1 失败
+* @return  0 成功
+* @note 伪终端从设备名称通过posix_serial_pty_hal_slave_name获取
+*/
+int posix_serial_pty_hal_init(uint8_t port,uint32_t baud_rates,uint8_t data_bits,uint8_t stop_bits);
+
+/*
+* @brief 仿真串口去初始化驱动
+* @param port uart端口号
+* @return = 0 成功
+* @return < 0 失败
+* @note
+*/
+int posix_serial_pty_hal_deinit(uint8_t port);
+
+/*
+* @brief 仿真串口发送为空中断使能驱动
+* @param port uart端口号
+* @return 无
+* @note
+*/
+void posix_serial_pty_hal_enable_txe_it(uint8_t port);
+
+/*
+* @brief 仿真串口发送为空中断禁止驱动
+* @param port uart端口号
+* @return 无
+* @note
+*/
+void posix_serial_pty_hal_disable_txe_it(uint8_t port);
+
+/*
+* @brief 仿真串口接收不为空中断使能驱动
+* @param port uart端口号
+* @return 无
+* @note
+*/
+void posix_serial_pty_hal_enable_rxne_it(uint8_t port);
+
+/*
+* @brief 仿真串口接收不为空中断禁止驱动
+* @param port uart端口号
+* @return 无
+* @note
+*/
+void posix_serial_pty_hal_disable_rxne_it(uint8_t port);
+
+/*
+* @brief 获取端口对应的伪终端从设备名称
+* @param port uart端口号
+* @return NULL 端口未初始化
+* @return 其他 从设备名称,例如/dev/pts/3
+* @note
+*/
+const char *posix_serial_pty_hal_slave_name(uint8_t port);
+
+/*
+* @brief 仿真串口中断routine驱动
+* @param handle uart的serial句柄
+* @return 无
+* @note 由仿真FLEXCOMM中断调用,对应nxp_serial_uart_hal_isr
+*/
+void posix_serial_pty_hal_isr(serial_handle_t *handle);
+
+
+
+#ifdef  __cplusplus
+     }
+#endif
+
+
+
+
+
+#endif
@@ -4,46 +4,131 @@
 #include "temperature_task.h"
 #include "board.h"
 #include "fsl_adc.h"
+#include "fsl_ctimer.h"
+#include "fsl_dma.h"
+#include "fsl_inputmux.h"
 #include "fsl_clock.h"
 #include "fsl_power.h"
 #include "log.h"
 
 
-osThreadId   adc_task_hdl;
+osMessageQId adc_task_msg_q_id;
+/*ADC任务消息池*/
+MSG_POOL_DEF(adc_task_msg_pool,adc_task_message_t,ADC_TASK_MSG_POOL_SIZE);
 
-static volatile uint16_t adc_sample[2];
-static volatile uint32_t adc_cusum[2];
-static volatile uint16_t adc_average[2];
+static void adc_task_init(active_object_t *ao);
+static void adc_task_handler(active_object_t *ao,const void *event);
+/*ADC活动对象*/
+ACTIVE_OBJECT_DEF(adc_task_ao,adc_task_init,adc_task_handler,&adc_task_msg_pool);
 
-#define   TEMPERATURE_ADC           ADC0
-#define   TEMPERATURE_ADC_IRQ_ID    ADC0_SEQA_IRQn
-#define   TEMPERATURE_ADC_CHANNEL   3
-#define   TEMPERATURE_ADC_CLK_SRC   kFRO_HF_to_ADC_CLK
+/*定时器和事件*/
+static active_object_timer_t adc_calibration_timer;
+static active_object_timer_t adc_block_timer;
+static const adc_task_message_t adc_calibration_msg = { .type = ADC_TASK_MSG_TYPE_CALIBRATION };
+static const adc_task_message_t adc_timeout_msg = { .type = ADC_TASK_MSG_TYPE_TIMEOUT };
 
+#define   TEMPERATURE_ADC                   ADC0
+#define   TEMPERATURE_ADC_CLK_SRC           kFRO_HF_to_ADC_CLK
+#define   TEMPERATURE_ADC_TRIGGER_INPUT     4 /*序列A硬件触发输入号,4:CTIMER0_MAT3*/
+#define   TEMPERATURE_ADC_THCMP_IRQ_PRIORITY 3 /*阈值比较中断优先级,需要调用RTOS接口*/
+
+#define   TEMPERATURE_TRIGGER_TIMER         CTIMER0
+#define   TEMPERATURE_TRIGGER_TIMER_CLK     kCLOCK_BusClk
+#define   TEMPERATURE_TRIGGER_MATCH         kCTIMER_Match_3
+
+#define   TEMPERATURE_DMA                   DMA0
+#define   TEMPERATURE_DMA_CHANNEL           0
+#define   TEMPERATURE_DMA_IRQ_PRIORITY      3
+
+/*探头对应的ADC通道,下标为探头序号:0:箱内(ADC0_3) 1:蒸发器(ADC0_5)*/
+static const uint8_t adc_probe_channel[ADC_TASK_PROBE_CNT] = { 3, 5 };
+
+/*DMA乒乓缓存,每个转换结果是一个SEQ_GDAT寄存器值,探头通道按序号交替*/
+static uint32_t adc_block[2][ADC_TASK_BLOCK_SIZE * ADC_TASK_PROBE_CNT];
+/*两个缓存的重载描述符,互相链接*/
+SDK_ALIGN(static dma_descriptor_t adc_dma_descriptor[2],16);
+static dma_handle_t adc_dma_handle;
+/*DMA正在写的缓存*/
+static volatile uint8_t adc_dma_block;
+
+
+/*
+* @brief DMA传输完成回调
+* @param handle DMA句柄
+* @param param 用户参数
+* @param done 是否完成
+* @param tcds 中断标志
+* @return 无
+* @note 在DMA中断中执行,一个缓存写满后通知任务,DMA已经按描述符切换到另一个缓存
+*/
+static void adc_dma_callback(dma_handle_t *handle,void *param,bool done,uint32_t tcds)
+{
+    adc_task_message_t msg;
+
+    if (done == false) {
+        msg.type = ADC_TASK_MSG_TYPE_DMA_ERROR;
+        active_object_post(&adc_task_ao,&msg,0);
+        return;
+    }
+    msg.type = ADC_TASK_MSG_TYPE_COMPLETED;
+    msg.block = adc_dma_block;
+    adc_dma_block ^= 1;
+    active_object_post(&adc_task_ao,&msg,0);
+}
 
-static adc_result_info_t gAdcResultInfoStruct;
-adc_result_info_t *volatile gAdcResultInfoPtr = &gAdcResultInfoStruct;
 /*
-* @brief adc模块中断句柄
+* @brief 打开所有探头通道的阈值比较中断
 * @param 无
-* @param
 * @return 无
-* @note
+* @note 中断触发后关闭对应通道的比较中断,每个缓存采集完成后重新打开,一个缓存周期内每个探头最多报告一次
+*/
+static void adc_threshold_arm(void)
+{
+    uint32_t flags = 0;
+
+    NVIC_DisableIRQ(ADC0_THCMP_IRQn);
+    for (uint8_t i = 0;i < ADC_TASK_PROBE_CNT;i ++) {
+        flags |= kADC_ThresholdCompareFlagOnChn0 << adc_probe_channel[i];
+        ADC_EnableThresholdCompareInterrupt(TEMPERATURE_ADC,adc_probe_channel[i],kADC_ThresholdInterruptOnOutside);
+    }
+    ADC_ClearStatusFlags(TEMPERATURE_ADC,flags);
+    NVIC_EnableIRQ(ADC0_THCMP_IRQn);
+}
+
+/*
+* @brief ADC阈值比较中断
+* @param 无
+* @return 无
+* @note 单次转换结果超出传感器短路/开路门限时立即通知温度任务,不等待缓存平均和错误确认
 */
-void  ADC0_SEQA_IRQHandler()
+void ADC0_THCMP_IRQHandler(void)
 {
-    if (kADC_ConvSeqAInterruptFlag == (kADC_ConvSeqAInterruptFlag & ADC_GetStatusFlags(TEMPERATURE_ADC))) {
-        ADC_GetChannelConversionResult(TEMPERATURE_ADC, TEMPERATURE_ADC_CHANNEL, gAdcResultInfoPtr);
-        adc_sample[ADC_TASK_TEMPERATURE_IDX] = gAdcResultInfoPtr->result;
-        ADC_ClearStatusFlags(TEMPERATURE_ADC, kADC_ConvSeqAInterruptFlag);
-        osSignalSet(adc_task_hdl,ADC_TASK_ADC_COMPLETED_SIGNAL);   
+    uint32_t flags;
+    uint32_t flag;
+    temperature_task_message_t msg;
+
+    flags = ADC_GetStatusFlags(TEMPERATURE_ADC);
+    msg.request.type = TEMPERATURE_TASK_MSG_TYPE_ADC_FAULT;
+    msg.request.fault_mask = 0;
+    for (uint8_t i = 0;i < ADC_TASK_PROBE_CNT;i ++) {
+        flag = kADC_ThresholdCompareFlagOnChn0 << adc_probe_channel[i];
+        if (flags & flag) {
+            msg.request.fault_mask |= 1U << i;
+            ADC_EnableThresholdCompareInterrupt(TEMPERATURE_ADC,adc_probe_channel[i],kADC_ThresholdInterruptDisabled);
+            ADC_ClearStatusFlags(TEMPERATURE_ADC,flag);
+        }
+    }
+    if (msg.request.fault_mask != 0) {
+        active_object_post(&temperature_task_ao,&msg,0);
     }
-/* Add for ARM errata 838869, affects Cortex-M4, Cortex-M4F Store immediate overlapping
-   exception return operation might vector to incorrect interrupt */
+
+    /* Add for ARM errata 838869, affects Cortex-M4, Cortex-M4F Store immediate overlapping
+    exception return operation might vector to incorrect interrupt */
 #if defined __CORTEX_M && (__CORTEX_M == 4U)
     __DSB();
-#endif 
+#endif
 }
+
 /*
 * @brief adc模块时钟电源配置
 * @param 无
@@ -105,52 +190,124 @@ static int adc_converter_init(void)
 
     ADC_Init(TEMPERATURE_ADC, &adcConfigStruct);
 
-    /* Enable channel TEMPERATURE_ADC_CHANNEL's conversion in Sequence A. */
-    adcConvSeqConfigStruct.channelMask =(1U << TEMPERATURE_ADC_CHANNEL); /* Includes channel TEMPERATURE_ADC_CHANNEL. */
-    adcConvSeqConfigStruct.triggerMask = 0U;
+    /*序列A包含所有探头通道,一次触发从低到高依次转换*/
+    adcConvSeqConfigStruct.channelMask = 0;
+    for (uint8_t i = 0;i < ADC_TASK_PROBE_CNT;i ++) {
+        adcConvSeqConfigStruct.channelMask |= 1U << adc_probe_channel[i];
+    }
+    /*由定时器匹配输出的上升沿启动转换*/
+    adcConvSeqConfigStruct.triggerMask = TEMPERATURE_ADC_TRIGGER_INPUT;
     adcConvSeqConfigStruct.triggerPolarity = kADC_TriggerPolarityPositiveEdge;
     adcConvSeqConfigStruct.enableSingleStep = false;
     adcConvSeqConfigStruct.enableSyncBypass = false;
-    adcConvSeqConfigStruct.interruptMode = kADC_InterruptForEachSequence;
+    /*每个通道转换完成置位SEQA_INT,DMA读取SEQ_GDAT时自动清除,下一个通道转换重新产生DMA触发沿*/
+    adcConvSeqConfigStruct.interruptMode = kADC_InterruptForEachConversion;
     ADC_SetConvSeqAConfig(TEMPERATURE_ADC, &adcConvSeqConfigStruct);
-    ADC_EnableConvSeqA(TEMPERATURE_ADC, true); /* Enable the conversion sequence A. */
-    /* Clear the result register. */
-    
-    ADC_DoSoftwareTriggerConvSeqA(TEMPERATURE_ADC);
-    while (!ADC_GetChannelConversionResult(TEMPERATURE_ADC, TEMPERATURE_ADC_CHANNEL, &gAdcResultInfoStruct))
-    {
-    }
-    ADC_GetConvSeqAGlobalConversionResult(TEMPERATURE_ADC, &gAdcResultInfoStruct);
-    
-    NVIC_SetPriority(TEMPERATURE_ADC_IRQ_ID, 3);
-    /* Enable the interrupt. */
-    /* Enable the interrupt the for sequence A done. */
+    /*SEQA_INT只作为DMA触发,不打开NVIC中断*/
     ADC_EnableInterrupts(TEMPERATURE_ADC, kADC_ConvSeqAInterruptEnable);
-    EnableIRQ(TEMPERATURE_ADC_IRQ_ID);
-  
+    /*阈值对0:结果低于下限或者高于上限即为传感器短路或者开路,与temperature_task的判断一致*/
+    ADC_SetThresholdPair0(TEMPERATURE_ADC,ADC_ERR_MIN + 1,ADC_ERR_MAX - 1);
+    ADC_SetChannelWithThresholdPair0(TEMPERATURE_ADC,adcConvSeqConfigStruct.channelMask);
+    NVIC_SetPriority(ADC0_THCMP_IRQn,TEMPERATURE_ADC_THCMP_IRQ_PRIORITY);
+    adc_threshold_arm();
+    ADC_EnableConvSeqA(TEMPERATURE_ADC, true); /* Enable the conversion sequence A. */
+
+    return 0;
+}
+
+/*
+* @brief DMA初始化
+* @param 无
+* @return 0 成功
+* @note ADC序列A的中断信号经过INPUTMUX作为DMA通道的硬件触发,每次触发搬运一个结果
+*/
+static int adc_dma_init(void)
+{
+    dma_channel_trigger_t trigger;
+
+    INPUTMUX_Init(INPUTMUX);
+    INPUTMUX_AttachSignal(INPUTMUX,TEMPERATURE_DMA_CHANNEL,kINPUTMUX_Adc0SeqaIrqToDma);
+    INPUTMUX_Deinit(INPUTMUX);
+
+    DMA_Init(TEMPERATURE_DMA);
+    DMA_EnableChannel(TEMPERATURE_DMA,TEMPERATURE_DMA_CHANNEL);
+    DMA_CreateHandle(&adc_dma_handle,TEMPERATURE_DMA,TEMPERATURE_DMA_CHANNEL);
+    DMA_SetCallback(&adc_dma_handle,adc_dma_callback,NULL);
+    NVIC_SetPriority(DMA0_IRQn,TEMPERATURE_DMA_IRQ_PRIORITY);
+
+    trigger.type = kDMA_RisingEdgeTrigger;
+    trigger.burst = kDMA_EdgeBurstTransfer1;
+    trigger.wrap = kDMA_NoWrap;
+    DMA_ConfigureChannelTrigger(TEMPERATURE_DMA,TEMPERATURE_DMA_CHANNEL,&trigger);
+
+    return 0;
+}
+
+/*
+* @brief 触发定时器初始化
+* @param 无
+* @return 0 成功
+* @note 匹配3每半个取样间隔翻转一次输出,每个取样间隔产生一个上升沿
+*/
+static int adc_trigger_timer_init(void)
+{
+    ctimer_config_t config;
+    ctimer_match_config_t match;
+
+    CTIMER_GetDefaultConfig(&config);
+    config.prescale = CLOCK_GetFreq(TEMPERATURE_TRIGGER_TIMER_CLK) / ADC_TASK_TRIGGER_TIMER_FREQ - 1;
+    CTIMER_Init(TEMPERATURE_TRIGGER_TIMER,&config);
+
+    match.matchValue = ADC_TASK_TRIGGER_TIMER_FREQ / 1000 * ADC_TASK_SAMPLE_INTERVAL / 2 - 1;
+    match.enableCounterReset = true;
+    match.enableCounterStop = false;
+    match.outControl = kCTIMER_Output_Toggle;
+    match.outPinInitState = false;
+    match.enableInterrupt = false;
+    CTIMER_SetupMatch(TEMPERATURE_TRIGGER_TIMER,TEMPERATURE_TRIGGER_MATCH,&match);
+
     return 0;
 }
+
 /*
 * @brief adc模块启动
 * @param 无
-* @param
-* @return 无
-* @note
+* @return -1 失败
+* @return  0 成功
+* @note 两个缓存的描述符互相重载,DMA连续采集不需要CPU参与
 */
 static int adc_start(void)
 {
-    ADC_DoSoftwareTriggerConvSeqA(TEMPERATURE_ADC); 
+    dma_transfer_config_t transfer;
+
+    adc_dma_block = 0;
+    DMA_PrepareTransfer(&transfer,(void *)&TEMPERATURE_ADC->SEQ_GDAT[0],adc_block[1],sizeof(uint32_t),sizeof(adc_block[1]),kDMA_PeripheralToMemory,&adc_dma_descriptor[0]);
+    DMA_CreateDescriptor(&adc_dma_descriptor[1],&transfer.xfercfg,transfer.srcAddr,transfer.dstAddr,&adc_dma_descriptor[0]);
+    DMA_PrepareTransfer(&transfer,(void *)&TEMPERATURE_ADC->SEQ_GDAT[0],adc_block[0],sizeof(uint32_t),sizeof(adc_block[0]),kDMA_PeripheralToMemory,&adc_dma_descriptor[1]);
+    DMA_CreateDescriptor(&adc_dma_descriptor[0],&transfer.xfercfg,transfer.srcAddr,transfer.dstAddr,&adc_dma_descriptor[1]);
+    /*ADC触发不是外设请求*/
+    transfer.isPeriph = false;
+    if (DMA_SubmitTransfer(&adc_dma_handle,&transfer) != kStatus_Success) {
+        log_error("adc dma submit err.\r\n");
+        return -1;
+    }
+    DMA_StartTransfer(&adc_dma_handle);
+    CTIMER_Reset(TEMPERATURE_TRIGGER_TIMER);
+    CTIMER_StartTimer(TEMPERATURE_TRIGGER_TIMER);
+
     return 0;
 }
+
 /*
 * @brief adc模块停止
 * @param 无
-* @param
-* @return 无
+* @return 0 成功
 * @note
 */
 static int adc_stop(void)
 {
+    CTIMER_StopTimer(TEMPERATURE_TRIGGER_TIMER);
+    DMA_AbortTransfer(&adc_dma_handle);
     return 0;
 }
 
@@ -170,74 +327,113 @@ static int adc_calibration(void)
     }
     return 0;
 }
+
 /*
 * @brief adc模块复位
 * @param 无
-* @param
 * @return -1 失败
 * @return 0  成功
-* @note
+* @note 停止定时器和DMA后重新开始采集
 */
 static int adc_reset(void)
 {
-    return 0;
+    adc_stop();
+    return adc_start();
 }
 
 /*
-* @brief adc任务
-* @param argument 任务参数
-* @param
+* @brief 一个缓存中每个探头的平均值
+* @param block 缓存
+* @param average 每个探头的平均值,12位
+* @return 无
+* @note 按结果中的通道号区分探头,四舍五入
+*/
+static void adc_block_average(const uint32_t *block,uint16_t *average)
+{
+    uint32_t sum[ADC_TASK_PROBE_CNT] = { 0 };
+    uint16_t cnt[ADC_TASK_PROBE_CNT] = { 0 };
+    uint8_t channel,probe;
+
+    for (uint16_t i = 0;i < ADC_TASK_BLOCK_SIZE * ADC_TASK_PROBE_CNT;i ++) {
+        channel = (block[i] & ADC_SEQ_GDAT_CHN_MASK) >> ADC_SEQ_GDAT_CHN_SHIFT;
+        for (probe = 0;probe < ADC_TASK_PROBE_CNT && adc_probe_channel[probe] != channel;probe ++);
+        if (probe < ADC_TASK_PROBE_CNT) {
+            sum[probe] += (block[i] & ADC_SEQ_GDAT_RESULT_MASK) >> ADC_SEQ_GDAT_RESULT_SHIFT;
+            cnt[probe] ++;
+        }
+    }
+    for (probe = 0;probe < ADC_TASK_PROBE_CNT;probe ++) {
+        /*没有结果时按开路处理*/
+        average[probe] = cnt[probe] == 0 ? 0 : (sum[probe] + cnt[probe] / 2) / cnt[probe];
+    }
+}
+
+/*
+* @brief adc初始化
+* @param ao 活动对象
+* @return 无
+* @note 上电ADC_TASK_CALIBRATION_INTERVAL后开始校准
+*/
+static void adc_task_init(active_object_t *ao)
+{
+    active_object_timer_init(&adc_calibration_timer,ao,&adc_calibration_msg);
+    active_object_timer_init(&adc_block_timer,ao,&adc_timeout_msg);
+
+    adc_clk_pwr_config();
+    adc_dma_init();
+    adc_trigger_timer_init();
+    active_object_timer_start(&adc_calibration_timer,ADC_TASK_CALIBRATION_INTERVAL,0);
+}
+
+/*
+* @brief adc事件处理
+* @param ao 活动对象
+* @param event ADC任务消息
 * @return 无
 * @note
 */
-void adc_task(void const * argument)
+static void adc_task_handler(active_object_t *ao,const void *event)
 {
     int rc;
-    osEvent signals;
     osStatus status;
-    temperature_task_message_t adc_completed_msg;
-    uint8_t t_sample_cnt = 0;
+    const adc_task_message_t *msg = (const adc_task_message_t *)event;
+    temperature_task_message_t temperature_msg;
 
-    adc_stop();
-    adc_clk_pwr_config();
-    do {
-        osDelay(1000);
+    switch (msg->type) {
+    /*校准,失败后重试*/
+    case ADC_TASK_MSG_TYPE_CALIBRATION:
         rc = adc_calibration();
-    }while (rc != 0);
-
-    adc_converter_init();
-
-    while (1) {
-        osDelay(ADC_TASK_INTERVAL);
+        if (rc != 0) {
+            active_object_timer_start(&adc_calibration_timer,ADC_TASK_CALIBRATION_INTERVAL,0);
+            break;
+        }
+        adc_converter_init();
         adc_start();
+        active_object_timer_start(&adc_block_timer,ADC_TASK_BLOCK_TIMEOUT,0);
+        break;
 
-        signals = osSignalWait(ADC_TASK_ALL_SIGNALS,ADC_TASK_ADC_TIMEOUT);
-        if (signals.status == osEventSignal ) {
-            if (signals.value.signals & ADC_TASK_ADC_COMPLETED_SIGNAL) {
-    
-                /*temperature adc calculate*/    
-                if (t_sample_cnt < ADC_TASK_ADC_SAMPLE_MAX){
-                    adc_cusum[ADC_TASK_TEMPERATURE_IDX] += adc_sample[ADC_TASK_TEMPERATURE_IDX];   
-                    t_sample_cnt ++;             
-                } else {
-                    adc_average[ADC_TASK_TEMPERATURE_IDX] = adc_cusum[ADC_TASK_TEMPERATURE_IDX] / t_sample_cnt;  
-                    adc_cusum[ADC_TASK_TEMPERATURE_IDX] = 0;
-                    t_sample_cnt = 0;
-                    adc_completed_msg.request.type = TEMPERATURE_TASK_MSG_TYPE_ADC_COMPLETED;
-                    adc_completed_msg.request.adc = adc_average[ADC_TASK_TEMPERATURE_IDX];  
-                    status = osMessagePut(temperature_task_msg_q_id,(uint32_t)&adc_completed_msg,ADC_TASK_PUT_MSG_TIMEOUT);
-                    if (status != osOK) {
-                        log_error("put temperature msg error:%d\r\n",status);
-                    }
-                }
-            }
-    
-
-        if (signals.value.signals & ADC_TASK_ADC_ERROR_SIGNAL) {
-            log_error("adc error.reset.\r\n");
-            adc_reset();
+    /*一个缓存采集完成*/
+    case ADC_TASK_MSG_TYPE_COMPLETED:
+        active_object_timer_start(&adc_block_timer,ADC_TASK_BLOCK_TIMEOUT,0);
+        temperature_msg.request.type = TEMPERATURE_TASK_MSG_TYPE_ADC_COMPLETED;
+        adc_block_average(adc_block[msg->block],temperature_msg.request.adc);
+        status = active_object_post(&temperature_task_ao,&temperature_msg,ADC_TASK_PUT_MSG_TIMEOUT);
+        if (status != osOK) {
+            log_error("put temperature msg error:%d\r\n",status);
         }
-    }
+        /*平均值已经交给温度任务确认,重新打开比较中断*/
+        adc_threshold_arm();
+        break;
+
+    /*DMA错误或者长时间没有采集完成,重新开始*/
+    case ADC_TASK_MSG_TYPE_DMA_ERROR:
+    case ADC_TASK_MSG_TYPE_TIMEOUT:
+        log_error("adc %s.reset.\r\n",msg->type == ADC_TASK_MSG_TYPE_TIMEOUT ? "timeout" : "dma err");
+        adc_reset();
+        active_object_timer_start(&adc_block_timer,ADC_TASK_BLOCK_TIMEOUT,0);
+        break;
+
+    default:
+        break;
     }
 }
-
@@ -1,6 +1,8 @@
 #ifndef  __ADC_TASK_H__
 #define  __ADC_TASK_H__
 #include "stdint.h"
+#include "msg_pool.h"
+#include "active_object.h"
 
 
 #ifdef  __cplusplus
@@ -14,22 +16,39 @@
 ADC_TASK_BEGIN
 
 
-extern osThreadId   adc_task_hdl;
-void adc_task(void const * argument);
+extern osMessageQId    adc_task_msg_q_id;
+extern msg_pool_t      adc_task_msg_pool;
+extern active_object_t adc_task_ao;
 
 
-#define  ADC_TASK_ADC_SAMPLE_MAX               25/*ADC取样次数*/
-#define  ADC_TASK_TEMPERATURE_IDX              0 /*温度1取样序号*/
-#define  ADC_TASK_TEMPERATURE2_IDX             1 /*温度2取样序号*/
+#define  ADC_TASK_MSG_Q_SIZE                   4 /*消息队列深度:每种事件最多一个*/
+#define  ADC_TASK_MSG_POOL_SIZE                (ADC_TASK_MSG_Q_SIZE + 1) /*消息池容量:队列+正在处理的事件*/
 
-#define  ADC_TASK_INTERVAL                     40 /*ADC取样间隔*/
-#define  ADC_TASK_ADC_TIMEOUT                  10  /*ADC取样超时时间*/
+#define  ADC_TASK_PROBE_CNT                    2   /*温度探头数量,一次触发依次转换所有探头通道*/
+#define  ADC_TASK_SAMPLE_INTERVAL              8   /*硬件触发的取样间隔 单位:ms*/
+#define  ADC_TASK_BLOCK_SIZE                   128 /*每个探头在一个DMA缓存中的取样次数,一个缓存求一次平均*/
+#define  ADC_TASK_BLOCK_TIMEOUT                (ADC_TASK_SAMPLE_INTERVAL * ADC_TASK_BLOCK_SIZE * 2) /*缓存采集超时时间 单位:ms*/
+#define  ADC_TASK_TRIGGER_TIMER_FREQ           1000000 /*触发定时器计数频率 单位:Hz*/
+/*DMA乒乓缓存和描述符RAM占用 单位:byte*/
+#define  ADC_TASK_DMA_RAM_SIZE                 (2 * ADC_TASK_BLOCK_SIZE * ADC_TASK_PROBE_CNT * 4 + 2 * 16)
+
+#define  ADC_TASK_CALIBRATION_INTERVAL         1000 /*ADC校准重试间隔*/
 
 #define  ADC_TASK_PUT_MSG_TIMEOUT              5  /*发送消息超时时间*/
 
-#define  ADC_TASK_ADC_COMPLETED_SIGNAL         (1<<0)
-#define  ADC_TASK_ADC_ERROR_SIGNAL             (1<<1)
-#define  ADC_TASK_ALL_SIGNALS                  ((1<<2)-1)
+enum
+{
+    ADC_TASK_MSG_TYPE_CALIBRATION,
+    ADC_TASK_MSG_TYPE_COMPLETED,
+    ADC_TASK_MSG_TYPE_DMA_ERROR,
+    ADC_TASK_MSG_TYPE_TIMEOUT
+};
+
+typedef struct
+{
+    uint8_t type;
+    uint8_t block;/*采集完成的缓存序号*/
+}adc_task_message_t;/*ADC任务消息体*/
 
 
 
@@ -0,0 +1,201 @@
+#include "fsl_common.h"
+#include "cmsis_os.h"
+#include "string.h"
+#include "stdbool.h"
+#include "communication_latency.h"
+#include "log.h"
+
+
+typedef struct
+{
+    uint8_t  cnt;
+    uint8_t  code[COMMUNICATION_LATENCY_CODE_CNT_MAX];
+    uint16_t bucket[COMMUNICATION_LATENCY_CODE_CNT_MAX][COMMUNICATION_LATENCY_PHASE_CNT][COMMUNICATION_LATENCY_BUCKET_CNT];
+}communication_latency_t;
+
+static communication_latency_t latency;
+
+static const char *phase_name[COMMUNICATION_LATENCY_PHASE_CNT] = {
+"recv",
+"frame",
+"process",
+"send",
+"total"
+};
+
+
+/*
+* @brief 延时对应的桶序号
+* @param value 延时 单位:us
+* @return 桶序号
+* @note 桶i统计[2^i,2^(i+1))us
+*/
+static uint8_t communication_latency_bucket(uint32_t value)
+{
+    uint8_t index;
+
+    if (value == 0) {
+        return 0;
+    }
+    index = 31 - __CLZ(value);
+    if (index >= COMMUNICATION_LATENCY_BUCKET_CNT) {
+        index = COMMUNICATION_LATENCY_BUCKET_CNT - 1;
+    }
+    return index;
+}
+
+/*
+* @brief 查找命令码序号
+* @param code 命令码
+* @param add 没有找到时是否添加
+* @return -1 失败
+* @return >=0 序号
+* @note
+*/
+static int communication_latency_find(uint8_t code,bool add)
+{
+    for (uint8_t i = 0;i < latency.cnt;i ++) {
+        if (latency.code[i] == code) {
+            return i;
+        }
+    }
+    if (add == false || latency.cnt >= COMMUNICATION_LATENCY_CODE_CNT_MAX) {
+        return -1;
+    }
+    latency.code[latency.cnt] = code;
+    return latency.cnt ++;
+}
+
+/*
+* @brief 记录一次adu处理的各阶段延时
+* @param code 命令码
+* @param stamp 时间戳
+* @return -1 失败,命令码表已满
+* @return  0 成功
+* @note
+*/
+int communication_latency_record(uint8_t code,const communication_latency_stamp_t *stamp)
+{
+    int index;
+    uint32_t value[COMMUNICATION_LATENCY_PHASE_CNT];
+    uint16_t *bucket;
+
+    value[COMMUNICATION_LATENCY_PHASE_RECV] = stamp->last_byte - stamp->first_byte;
+    value[COMMUNICATION_LATENCY_PHASE_FRAME] = stamp->dispatch - stamp->last_byte;
+    value[COMMUNICATION_LATENCY_PHASE_PROCESS] = stamp->reply - stamp->dispatch;
+    value[COMMUNICATION_LATENCY_PHASE_SEND] = stamp->send_complete - stamp->reply;
+    value[COMMUNICATION_LATENCY_PHASE_TOTAL] = stamp->send_complete - stamp->first_byte;
+
+    taskENTER_CRITICAL();
+    index = communication_latency_find(code,true);
+    if (index >= 0) {
+        for (uint8_t phase = 0;phase < COMMUNICATION_LATENCY_PHASE_CNT;phase ++) {
+            bucket = &latency.bucket[index][phase][communication_latency_bucket(value[phase])];
+            /*饱和计数*/
+            if (*bucket < 0xFFFF) {
+                (*bucket) ++;
+            }
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return index >= 0 ? 0 : -1;
+}
+
+/*
+* @brief 获取命令码某阶段的直方图
+* @param code 命令码
+* @param phase 阶段
+* @param bucket 直方图缓存,容量COMMUNICATION_LATENCY_BUCKET_CNT
+* @return -1 失败
+* @return  0 成功
+* @note 没有记录过的命令码返回全0直方图
+*/
+int communication_latency_get(uint8_t code,uint8_t phase,uint16_t *bucket)
+{
+    int index;
+
+    if (phase >= COMMUNICATION_LATENCY_PHASE_CNT) {
+        log_error("latency phase:%d invalid.\r\n",phase);
+        return -1;
+    }
+    taskENTER_CRITICAL();
+    index = communication_latency_find(code,false);
+    if (index >= 0) {
+        memcpy(bucket,latency.bucket[index][phase],sizeof(latency.bucket[index][phase]));
+    } else {
+        memset(bucket,0,sizeof(latency.bucket[0][0]));
+    }
+    taskEXIT_CRITICAL();
+
+    return 0;
+}
+
+/*
+* @brief 清空所有直方图
+* @param 无
+* @return 无
+* @note
+*/
+void communication_latency_reset(void)
+{
+    taskENTER_CRITICAL();
+    memset(&latency,0,sizeof(latency));
+    taskEXIT_CRITICAL();
+}
+
+/*
+* @brief 直方图分位数
+* @param bucket 直方图
+* @param total 总次数
+* @param percent 百分位
+* @return 分位数所在桶的上限 单位:us
+* @note
+*/
+static uint32_t communication_latency_percentile(const uint16_t *bucket,uint32_t total,uint8_t percent)
+{
+    uint32_t sum = 0,target;
+
+    target = (total * percent + 99) / 100;
+    for (uint8_t i = 0;i < COMMUNICATION_LATENCY_BUCKET_CNT;i ++) {
+        sum += bucket[i];
+        if (sum >= target) {
+            return (uint32_t)2 << i;
+        }
+    }
+    return (uint32_t)2 << (COMMUNICATION_LATENCY_BUCKET_CNT - 1);
+}
+
+/*
+* @brief 日志输出每个命令码各阶段的次数,p50和p99
+* @param 无
+* @return 无
+* @note 分位数为所在桶的上限
+*/
+void communication_latency_dump(void)
+{
+    uint8_t cnt,code;
+    uint32_t total;
+    uint16_t bucket[COMMUNICATION_LATENCY_BUCKET_CNT];
+
+    cnt = latency.cnt;
+    for (uint8_t i = 0;i < cnt;i ++) {
+        code = latency.code[i];
+        for (uint8_t phase = 0;phase < COMMUNICATION_LATENCY_PHASE_CNT;phase ++) {
+            communication_latency_get(code,phase,bucket);
+            total = 0;
+            for (uint8_t j = 0;j < COMMUNICATION_LATENCY_BUCKET_CNT;j ++) {
+                total += bucket[j];
+            }
+            if (total == 0) {
+                continue;
+            }
+            log_info("code:0x%02x %-7s cnt:%d p50:<%dus p99:<%dus\r\n",
+                     code,
+                     phase_name[phase],
+                     total,
+                     communication_latency_percentile(bucket,total,50),
+                     communication_latency_percentile(bucket,total,99));
+        }
+    }
+}
@@ -0,0 +1,82 @@
+#ifndef  __COMMUNICATION_LATENCY_H__
+#define  __COMMUNICATION_LATENCY_H__
+#include "stdint.h"
+
+#ifdef  __cplusplus
+#define COMMUNICATION_LATENCY_BEGIN  extern "C" {
+#define COMMUNICATION_LATENCY_END    }
+#else
+#define COMMUNICATION_LATENCY_BEGIN
+#define COMMUNICATION_LATENCY_END
+#endif
+
+
+COMMUNICATION_LATENCY_BEGIN
+
+#define  COMMUNICATION_LATENCY_CODE_CNT_MAX         16 /*可统计的命令码数量*/
+#define  COMMUNICATION_LATENCY_BUCKET_CNT           20 /*桶i统计[2^i,2^(i+1))us,最后一个桶统计更大值*/
+
+/*主机adu处理阶段*/
+typedef enum
+{
+    COMMUNICATION_LATENCY_PHASE_RECV = 0,          /*首字节到末字节*/
+    COMMUNICATION_LATENCY_PHASE_FRAME,             /*末字节到分发(帧间超时判定)*/
+    COMMUNICATION_LATENCY_PHASE_PROCESS,           /*分发到子系统回应*/
+    COMMUNICATION_LATENCY_PHASE_SEND,              /*子系统回应到发送完成*/
+    COMMUNICATION_LATENCY_PHASE_TOTAL,             /*首字节到发送完成*/
+    COMMUNICATION_LATENCY_PHASE_CNT
+}communication_latency_phase_t;
+
+/*一次adu处理的时间戳 单位:us*/
+typedef struct
+{
+    uint32_t first_byte;
+    uint32_t last_byte;
+    uint32_t dispatch;
+    uint32_t reply;
+    uint32_t send_complete;
+}communication_latency_stamp_t;
+
+
+/*
+* @brief 记录一次adu处理的各阶段延时
+* @param code 命令码
+* @param stamp 时间戳
+* @return -1 失败,命令码表已满
+* @return  0 成功
+* @note
+*/
+int communication_latency_record(uint8_t code,const communication_latency_stamp_t *stamp);
+
+/*
+* @brief 获取命令码某阶段的直方图
+* @param code 命令码
+* @param phase 阶段
+* @param bucket 直方图缓存,容量COMMUNICATION_LATENCY_BUCKET_CNT
+* @return -1 失败
+* @return  0 成功
+* @note 没有记录过的命令码返回全0直方图
+*/
+int communication_latency_get(uint8_t code,uint8_t phase,uint16_t *bucket);
+
+/*
+* @brief 清空所有直方图
+* @param 无
+* @return 无
+* @note
+*/
+void communication_latency_reset(void);
+
+/*
+* @brief 日志输出每个命令码各阶段的次数,p50和p99
+* @param 无
+* @return 无
+* @note 分位数为所在桶的上限
+*/
+void communication_latency_dump(void);
+
+
+
+COMMUNICATION_LATENCY_END
+
+#endif
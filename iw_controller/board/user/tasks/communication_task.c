@@ -11,6 +11,14 @@
 #include "fymodem.h"
 #include "device_env.h"
 #include "md5.h"
+#include "lzss.h"
+#include "delta.h"
+#include "flash_if.h"
+#include "run_time_stats.h"
+#include "trace.h"
+#include "communication_latency.h"
+#include "history_task.h"
+#include "deadline.h"
 #include "log.h"
 
 osThreadId   communication_task_hdl;
@@ -19,16 +27,51 @@ osMessageQId communication_task_msg_q_id;
 static serial_handle_t communication_serial_handle;
 static uint8_t comm_recv_buffer[COMMUNICATION_TASK_RX_BUFFER_SIZE];
 static uint8_t comm_send_buffer[COMMUNICATION_TASK_TX_BUFFER_SIZE];
-
-
+/*主机adu首字节和末字节到达时间 单位:us,在串口中断中记录*/
+static volatile bool     host_byte_stamp_valid;
+static volatile uint32_t host_first_byte_time;
+static volatile uint32_t host_last_byte_time;
+
+
+#if defined(__linux__)
+/*linux仿真:串口端口是伪终端*/
+extern serial_hal_driver_t posix_serial_pty_hal_driver;
+extern void posix_serial_pty_hal_isr(serial_handle_t *handle);
+#define  COMMUNICATION_SERIAL_HAL_DRIVER   posix_serial_pty_hal_driver
+#define  COMMUNICATION_SERIAL_HAL_ISR      posix_serial_pty_hal_isr
+#else
 extern serial_hal_driver_t nxp_serial_uart_hal_driver;
 extern void nxp_serial_uart_hal_isr(serial_handle_t *handle);
+#define  COMMUNICATION_SERIAL_HAL_DRIVER   nxp_serial_uart_hal_driver
+#define  COMMUNICATION_SERIAL_HAL_ISR      nxp_serial_uart_hal_isr
+#endif
 /*通信任务上文实体*/
 static communication_task_contex_t communication_task_contex;
+/*主机adu从末字节到达到回应发送完成的截止时间统计*/
+DEADLINE_DEF(communication_task_deadline);
+
+/*回应消息队列的静态存储*/
+#define  RSP_MSG_Q_STORAGE(name,size)                                          \
+static uint8_t name##_buffer[(size) * sizeof(uint32_t)];                       \
+static osStaticMessageQDef_t name##_cb
+
+RSP_MSG_Q_STORAGE(unlock_lock_rsp_msg_q,COMMUNICATION_TASK_RSP_MSG_Q_SIZE);
+RSP_MSG_Q_STORAGE(lock_lock_rsp_msg_q,COMMUNICATION_TASK_RSP_MSG_Q_SIZE);
+RSP_MSG_Q_STORAGE(query_lock_status_rsp_msg_q,COMMUNICATION_TASK_RSP_MSG_Q_SIZE);
+RSP_MSG_Q_STORAGE(query_door_status_rsp_msg_q,COMMUNICATION_TASK_RSP_MSG_Q_SIZE);
+RSP_MSG_Q_STORAGE(query_temperature_rsp_msg_q,COMMUNICATION_TASK_RSP_MSG_Q_SIZE);
+RSP_MSG_Q_STORAGE(query_probe_rsp_msg_q,COMMUNICATION_TASK_RSP_MSG_Q_SIZE);
+RSP_MSG_Q_STORAGE(query_temperature_setting_rsp_msg_q,COMMUNICATION_TASK_RSP_MSG_Q_SIZE);
+RSP_MSG_Q_STORAGE(temperature_setting_rsp_msg_q,COMMUNICATION_TASK_RSP_MSG_Q_SIZE);
+RSP_MSG_Q_STORAGE(query_compressor_stats_rsp_msg_q,COMMUNICATION_TASK_RSP_MSG_Q_SIZE);
+RSP_MSG_Q_STORAGE(net_weight_rsp_msg_q,COMMUNICATION_TASK_SCALE_RSP_MSG_Q_SIZE);
+RSP_MSG_Q_STORAGE(remove_tare_rsp_msg_q,COMMUNICATION_TASK_SCALE_RSP_MSG_Q_SIZE);
+RSP_MSG_Q_STORAGE(calibration_zero_rsp_msg_q,COMMUNICATION_TASK_SCALE_RSP_MSG_Q_SIZE);
+RSP_MSG_Q_STORAGE(calibration_full_rsp_msg_q,COMMUNICATION_TASK_SCALE_RSP_MSG_Q_SIZE);
 
 
 /*协议定义*/
-#define  ADU_SIZE_MAX                               60
+#define  ADU_SIZE_MAX                               200 /*历史记录批量读取需要较长的帧*/
 /*地址域*/
 #define  ADU_ADDR_REGION_OFFSET                     0
 #define  ADU_ADDR_REGION_SIZE                       1
@@ -45,10 +88,16 @@ static communication_task_contex_t communication_task_contex;
 #define  CODE_LOCK_LOCK                             0x22  
 #define  CODE_QUERY_LOCK_STATUS                     0x23  
 #define  CODE_QUERY_TEMPERATURE                     0x41  
+#define  CODE_QUERY_PROBE                           0x42
+#define  CODE_QUERY_COMPRESSOR_STATS                0x43
 #define  CODE_SET_TEMPERATURE                       0x0A 
 #define  CODE_QUERY_MANUFACTURER_HARDWARE_VER       0x51 
 #define  CODE_QUERY_SOFTWARE_VER                    0x52
 #define  CODE_NOTIFY_UPDATE                         0x53
+#define  CODE_QUERY_RUN_TIME_STATS                  0x61
+#define  CODE_QUERY_LATENCY                         0x62
+#define  CODE_RESET_LATENCY                         0x63
+#define  CODE_QUERY_HISTORY                         0x64
 #define  CODE_COMPRESSOR_CTRL                       0xF0
 /*数据域*/
 #define  ADU_DATA_REGION_OFFSET                     2
@@ -61,11 +110,17 @@ static communication_task_contex_t communication_task_contex;
 #define  ADU_DATA_REGION_UNLOCK_LOCK_SIZE           0
 #define  ADU_DATA_REGION_QUERY_LOCK_STATUS_SIZE     0
 #define  ADU_DATA_REGION_QUERY_TEMPERATURE_SIZE     0
+#define  ADU_DATA_REGION_QUERY_PROBE_SIZE           0
+#define  ADU_DATA_REGION_QUERY_COMPRESSOR_STATS_SIZE 0
 #define  ADU_DATA_REGION_SET_TEMPERATURE_SIZE       1
 #define  ADU_DATA_REGION_QUERY_HARDWARE_VER_SIZE    0
 #define  ADU_DATA_REGION_QUERY_SOFTWARE_VER_SIZE    0
 #define  ADU_DATA_REGION_NOTIFY_UPDATE_SIZE         20
 #define  ADU_DATA_REGION_COMPRESSOR_CTRL_SIZE       1
+#define  ADU_DATA_REGION_QUERY_RUN_TIME_STATS_SIZE  3
+#define  ADU_DATA_REGION_QUERY_LATENCY_SIZE         2
+#define  ADU_DATA_REGION_RESET_LATENCY_SIZE         0
+#define  ADU_DATA_REGION_QUERY_HISTORY_SIZE         5
 
 #define  DATA_REGION_SCALE_ADDR_OFFSET              0
 #define  DATA_REGION_CALIBRATION_WEIGHT_OFFSET      1
@@ -75,9 +130,16 @@ static communication_task_contex_t communication_task_contex;
 #define  DATA_REGION_FILE_MD5_OFFSET                4
 #define  DATA_REGION_STATUS_OFFSET                  0
 #define  DATA_REGION_COMPRESSOR_CTRL_VALUE_OFFSET   0
+#define  DATA_REGION_STATS_ITEM_OFFSET              0
+#define  DATA_REGION_STATS_WINDOW_OFFSET            1
+#define  DATA_REGION_LATENCY_CODE_OFFSET            0
+#define  DATA_REGION_LATENCY_PHASE_OFFSET           1
+#define  DATA_REGION_HISTORY_SEQ_OFFSET             0
+#define  DATA_REGION_HISTORY_CNT_OFFSET             4
 /*协议操作值定义*/
 #define  DATA_NET_WEIGHT_ERR_VALUE                  0xFFFF
 #define  DATA_TEMPERATURE_ERR_VALUE                 0x7F
+#define  DATA_PROBE_ERR_VALUE                       0x7FFF
 #define  DATA_STATUS_DOOR_OPEN                      0x01
 #define  DATA_STATUS_DOOR_CLOSE                     0x00
 #define  DATA_STATUS_DOOR_ERR                       0xFF
@@ -97,6 +159,11 @@ static communication_task_contex_t communication_task_contex;
 #define  DATA_MANUFACTURER_CHANGHONG_ID             0x0101
 #define  DATA_RESULT_COMPRESSOR_CTRL_SUCCESS        0x01
 #define  DATA_RESULT_COMPRESSOR_CTRL_FAIL           0x00
+#define  DATA_RUN_TIME_STATS_ITEM_CNT_MAX           16
+#define  DATA_RESULT_RESET_LATENCY_SUCCESS          0x01
+#define  DATA_HISTORY_RECORD_SIZE                   8
+/*地址,命令码,开始序号,最新序号,上电时间,数量和CRC之外都用来放记录*/
+#define  DATA_HISTORY_RECORD_CNT_MAX                ((ADU_SIZE_MAX - 2 - 13 - ADU_CRC_SIZE) / DATA_HISTORY_RECORD_SIZE)
 /*CRC16域*/
 #define  ADU_CRC_SIZE                               2
 
@@ -113,6 +180,8 @@ static communication_task_contex_t communication_task_contex;
 #define  ADU_QUERY_DOOR_STATUS_TIMEOUT              40
 #define  ADU_QUERY_LOCK_STATUS_TIMEOUT              40
 #define  ADU_QUERY_TEMPERATURE_TIMEOUT              20
+#define  ADU_QUERY_PROBE_TIMEOUT                    20
+#define  ADU_QUERY_COMPRESSOR_STATS_TIMEOUT         20
 #define  ADU_QUERY_TEMPERATURE_SETTING_TIMEOUT      20
 #define  ADU_QUERY_SET_TEMPERATURE_TIMEOUT          500
 #define  ADU_SCALE_CNT_MAX                          20
@@ -270,6 +339,21 @@ static int query_scale_cnt(communication_task_contex_t *contex)
     return contex->cnt;
 }
 
+/*
+* @brief 丢弃电子秤回应队列中残留的回应
+* @param contex 通信任务上下文
+* @return 无
+* @note 每次电子秤请求前和超时后清空全部4个回应队列,
+*       残留的回应只来自清空时还在电子秤任务中的请求,占用的消息块有上限,见SCALE_TASK_MSG_POOL_SIZE
+*/
+static void scale_rsp_flush(const communication_task_contex_t *contex)
+{
+    msg_pool_flush(&scale_task_msg_pool,contex->net_weight_rsp_msg_q_id);
+    msg_pool_flush(&scale_task_msg_pool,contex->remove_tare_rsp_msg_q_id);
+    msg_pool_flush(&scale_task_msg_pool,contex->calibration_zero_rsp_msg_q_id);
+    msg_pool_flush(&scale_task_msg_pool,contex->calibration_full_rsp_msg_q_id);
+}
+
 /*
 * @brief 请求净重值
 * @param contex 通信任务任务上下文
@@ -291,6 +375,8 @@ static int query_net_weight(const communication_task_contex_t *contex,const uint
     utils_timer_t timer;
 
     utils_timer_init(&timer,ADU_QUERY_WEIGHT_TIMEOUT,false);
+    /*丢弃上次超时后才到达的回应*/
+    scale_rsp_flush(contex);
     /*全部电子秤任务*/
     if (addr == 0) {      
         /*发送消息*/
@@ -300,8 +386,11 @@ static int query_net_weight(const communication_task_contex_t *contex,const uint
             req_msg[i].request.addr = contex->scale_task_contex[i].internal_addr;
             req_msg[i].request.index = i;
             flags |= contex->scale_task_contex[i].flag;
-            status = osMessagePut(contex->scale_task_contex[i].msg_q_id,(uint32_t)&req_msg[i],utils_timer_value(&timer));
-            log_assert(status == osOK);
+            status = msg_pool_send(&scale_task_msg_pool,contex->scale_task_contex[i].msg_q_id,&req_msg[i],utils_timer_value(&timer));
+            if (status != osOK) {
+                log_error("comm put msg err:%d.\r\n",status);
+                return -1;
+            }
         }
         cnt = contex->cnt;
     } else {/*指定电子秤任务*/
@@ -315,8 +404,11 @@ static int query_net_weight(const communication_task_contex_t *contex,const uint
         req_msg[0].request.addr = addr;
         req_msg[0].request.index = 0;
         flags |= contex->scale_task_contex[rc].flag;
-        status = osMessagePut(contex->scale_task_contex[rc].msg_q_id,(uint32_t)&req_msg[0],utils_timer_value(&timer));
-        log_assert(status == osOK);
+        status = msg_pool_send(&scale_task_msg_pool,contex->scale_task_contex[rc].msg_q_id,&req_msg[0],utils_timer_value(&timer));
+        if (status != osOK) {
+            log_error("comm put msg err:%d.\r\n",status);
+            return -1;
+        }
         cnt = 1;
     }
     /*等待消息*/
@@ -324,6 +416,7 @@ static int query_net_weight(const communication_task_contex_t *contex,const uint
         os_event = osMessageGet(contex->net_weight_rsp_msg_q_id,utils_timer_value(&timer));
         if (os_event.status == osEventMessage ){
             rsp_msg = *(scale_task_message_t *)os_event.value.v;
+            msg_pool_free(&scale_task_msg_pool,os_event.value.p);
             if (rsp_msg.response.type != SCALE_TASK_MSG_TYPE_RSP_NET_WEIGHT) {     
                 log_error("comm net weight rsp type:%d err.\r\n",rsp_msg.response.type);
                 continue;
@@ -335,6 +428,7 @@ static int query_net_weight(const communication_task_contex_t *contex,const uint
         
     if (flags != 0) {
         log_error("net weight query timeout err.flags:%d.\r\n",flags);
+        scale_rsp_flush(contex);
         return -1;
     }
 
@@ -362,6 +456,8 @@ static int remove_tare_weight(const communication_task_contex_t *contex,const ui
     bool success = true;
 
     utils_timer_init(&timer,ADU_REMOVE_TARE_TIMEOUT,false);
+    /*丢弃上次超时后才到达的回应*/
+    scale_rsp_flush(contex);
     /*全部电子秤任务*/
     if (addr == 0) {      
         /*发送消息*/
@@ -371,8 +467,11 @@ static int remove_tare_weight(const communication_task_contex_t *contex,const ui
             req_msg[i].request.addr = contex->scale_task_contex[i].internal_addr;
             req_msg[i].request.index = i;
             flags |= contex->scale_task_contex[i].flag;
-            status = osMessagePut(contex->scale_task_contex[i].msg_q_id,(uint32_t)&req_msg[i],utils_timer_value(&timer));
-            log_assert(status == osOK);
+            status = msg_pool_send(&scale_task_msg_pool,contex->scale_task_contex[i].msg_q_id,&req_msg[i],utils_timer_value(&timer));
+            if (status != osOK) {
+                log_error("comm put msg err:%d.\r\n",status);
+                return -1;
+            }
         }
     } else {/*指定电子秤任务*/
         rc = find_scale_task_contex_index(contex,addr);
@@ -385,14 +484,18 @@ static int remove_tare_weight(const communication_task_contex_t *contex,const ui
         req_msg[0].request.addr = addr;
         req_msg[0].request.index = 0;
         flags |= contex->scale_task_contex[rc].flag;
-        status = osMessagePut(contex->scale_task_contex[rc].msg_q_id,(uint32_t)&req_msg[0],utils_timer_value(&timer));
-        log_assert(status == osOK);
+        status = msg_pool_send(&scale_task_msg_pool,contex->scale_task_contex[rc].msg_q_id,&req_msg[0],utils_timer_value(&timer));
+        if (status != osOK) {
+            log_error("comm put msg err:%d.\r\n",status);
+            return -1;
+        }
     }
     /*等待消息*/
     while (flags != 0 && utils_timer_value(&timer) > 0) {
         os_event = osMessageGet(contex->remove_tare_rsp_msg_q_id,utils_timer_value(&timer));
         if (os_event.status == osEventMessage ){
             rsp_msg = *(scale_task_message_t *)os_event.value.v;
+            msg_pool_free(&scale_task_msg_pool,os_event.value.p);
             if (rsp_msg.response.type != SCALE_TASK_MSG_TYPE_RSP_REMOVE_TARE_WEIGHT) {     
                 log_error("comm remove tare weight rsp type:%d err.\r\n",rsp_msg.response.type);
                 continue;
@@ -406,6 +509,7 @@ static int remove_tare_weight(const communication_task_contex_t *contex,const ui
         
     if (flags != 0) {
         log_error("comm remove tare weight timeout err.flags:%d.\r\n",flags);
+        scale_rsp_flush(contex);
         return -1;
     }
 
@@ -437,6 +541,8 @@ static int calibration_zero(const communication_task_contex_t *contex,const uint
         return -1;
     }
     utils_timer_init(&timer,ADU_CALIBRATION_ZERO_TIMEOUT,false);
+    /*丢弃上次超时后才到达的回应*/
+    scale_rsp_flush(contex);
 
     /*全部电子秤任务*/
     if (addr == 0) {      
@@ -448,8 +554,11 @@ static int calibration_zero(const communication_task_contex_t *contex,const uint
             req_msg[i].request.addr = contex->scale_task_contex[i].internal_addr;
             req_msg[i].request.index = i;
             flags |= contex->scale_task_contex[i].flag;
-            status = osMessagePut(contex->scale_task_contex[i].msg_q_id,(uint32_t)&req_msg[i],utils_timer_value(&timer));
-            log_assert(status == osOK);
+            status = msg_pool_send(&scale_task_msg_pool,contex->scale_task_contex[i].msg_q_id,&req_msg[i],utils_timer_value(&timer));
+            if (status != osOK) {
+                log_error("comm put msg err:%d.\r\n",status);
+                return -1;
+            }
         }
     } else {/*指定电子秤任务*/
         rc = find_scale_task_contex_index(contex,addr);
@@ -463,14 +572,18 @@ static int calibration_zero(const communication_task_contex_t *contex,const uint
         req_msg[0].request.addr = addr;
         req_msg[0].request.index = 0;
         flags |= contex->scale_task_contex[rc].flag;
-        status = osMessagePut(contex->scale_task_contex[rc].msg_q_id,(uint32_t)&req_msg[0],utils_timer_value(&timer));
-        log_assert(status == osOK);
+        status = msg_pool_send(&scale_task_msg_pool,contex->scale_task_contex[rc].msg_q_id,&req_msg[0],utils_timer_value(&timer));
+        if (status != osOK) {
+            log_error("comm put msg err:%d.\r\n",status);
+            return -1;
+        }
     }
     /*等待消息*/
     while (flags != 0 && utils_timer_value(&timer) > 0) {
         os_event = osMessageGet(contex->calibration_zero_rsp_msg_q_id,utils_timer_value(&timer));
         if (os_event.status == osEventMessage ){
             rsp_msg = *(scale_task_message_t *)os_event.value.v;
+            msg_pool_free(&scale_task_msg_pool,os_event.value.p);
             if (rsp_msg.response.type != SCALE_TASK_MSG_TYPE_RSP_CALIBRATION_ZERO_WEIGHT) {     
                 log_error("comm calibration zero weight rsp type:%d err.\r\n",rsp_msg.response.type);
                 continue;
@@ -484,6 +597,7 @@ static int calibration_zero(const communication_task_contex_t *contex,const uint
         
     if (flags != 0) {
         log_error("comm calibration zero timeout err.flags:%d.\r\n",flags);
+        scale_rsp_flush(contex);
         return -1;
     }
 
@@ -515,6 +629,8 @@ static int calibration_full(const communication_task_contex_t *contex,const uint
         return -1;
     }
     utils_timer_init(&timer,ADU_CALIBRATION_FULL_TIMEOUT,false);
+    /*丢弃上次超时后才到达的回应*/
+    scale_rsp_flush(contex);
 
     /*全部电子秤任务*/
     if (addr == 0) {      
@@ -526,8 +642,11 @@ static int calibration_full(const communication_task_contex_t *contex,const uint
             req_msg[i].request.addr = contex->scale_task_contex[i].internal_addr;
             req_msg[i].request.index = i;
             flags |= contex->scale_task_contex[i].flag;
-            status = osMessagePut(contex->scale_task_contex[i].msg_q_id,(uint32_t)&req_msg[i],utils_timer_value(&timer));
-            log_assert(status == osOK);
+            status = msg_pool_send(&scale_task_msg_pool,contex->scale_task_contex[i].msg_q_id,&req_msg[i],utils_timer_value(&timer));
+            if (status != osOK) {
+                log_error("comm put msg err:%d.\r\n",status);
+                return -1;
+            }
         }
     } else {/*指定电子秤任务*/
         rc = find_scale_task_contex_index(contex,addr);
@@ -541,14 +660,18 @@ static int calibration_full(const communication_task_contex_t *contex,const uint
         req_msg[0].request.addr = addr;
         req_msg[0].request.index = 0;
         flags |= contex->scale_task_contex[rc].flag;
-        status = osMessagePut(contex->scale_task_contex[rc].msg_q_id,(uint32_t)&req_msg[0],utils_timer_value(&timer));
-        log_assert(status == osOK);
+        status = msg_pool_send(&scale_task_msg_pool,contex->scale_task_contex[rc].msg_q_id,&req_msg[0],utils_timer_value(&timer));
+        if (status != osOK) {
+            log_error("comm put msg err:%d.\r\n",status);
+            return -1;
+        }
     }
     /*等待消息*/
     while (flags != 0 && utils_timer_value(&timer) > 0) {
         os_event = osMessageGet(contex->calibration_full_rsp_msg_q_id,utils_timer_value(&timer));
         if (os_event.status == osEventMessage ){
             rsp_msg = *(scale_task_message_t *)os_event.value.v;
+            msg_pool_free(&scale_task_msg_pool,os_event.value.p);
             if (rsp_msg.response.type != SCALE_TASK_MSG_TYPE_RSP_CALIBRATION_FULL_WEIGHT) {     
                 log_error("comm calibration full weight rsp type:%d err.\r\n",rsp_msg.response.type);
                 continue;
@@ -562,6 +685,7 @@ static int calibration_full(const communication_task_contex_t *contex,const uint
         
     if (flags != 0) {
         log_error("comm calibration full timeout err.flags:%d.\r\n",flags);
+        scale_rsp_flush(contex);
         return -1;
     }
 
@@ -588,16 +712,22 @@ static int query_door_status(communication_task_contex_t *contex,uint8_t *door_s
     req_msg.request.type = LOCK_TASK_MSG_TYPE_DOOR_STATUS;    
     req_msg.request.rsp_message_queue_id = contex->query_door_status_rsp_msg_q_id;
     utils_timer_init(&timer,ADU_QUERY_DOOR_STATUS_TIMEOUT,false);
+    /*丢弃上次超时后才到达的回应*/
+    msg_pool_flush(&lock_task_msg_pool,contex->query_door_status_rsp_msg_q_id);
     
     /*发送消息*/
-    status = osMessagePut(lock_task_msg_q_id,(uint32_t)&req_msg,utils_timer_value(&timer));
-    log_assert(status == osOK);
+    status = active_object_post(&lock_task_ao,&req_msg,utils_timer_value(&timer));
+    if (status != osOK) {
+        log_error("comm put msg err:%d.\r\n",status);
+        return -1;
+    }
 
     /*等待消息*/
     while (utils_timer_value(&timer) > 0) {
         os_event = osMessageGet(contex->query_door_status_rsp_msg_q_id,utils_timer_value(&timer));
         if (os_event.status == osEventMessage ){
             rsp_msg = *(lock_task_message_t *)os_event.value.v;
+            msg_pool_free(&lock_task_msg_pool,os_event.value.p);
             if (rsp_msg.response.type != LOCK_TASK_MSG_TYPE_RSP_DOOR_STATUS) {     
                 log_error("comm query door status rsp type:%d err.\r\n",rsp_msg.response.type);
                 continue;
@@ -631,16 +761,22 @@ static int query_lock_status(communication_task_contex_t *contex,uint8_t *lock_s
     req_msg.request.type = LOCK_TASK_MSG_TYPE_LOCK_STATUS;    
     req_msg.request.rsp_message_queue_id = contex->query_lock_status_rsp_msg_q_id;
     utils_timer_init(&timer,ADU_QUERY_LOCK_STATUS_TIMEOUT,false);
+    /*丢弃上次超时后才到达的回应*/
+    msg_pool_flush(&lock_task_msg_pool,contex->query_lock_status_rsp_msg_q_id);
     
     /*发送消息*/
-    status = osMessagePut(lock_task_msg_q_id,(uint32_t)&req_msg,utils_timer_value(&timer));
-    log_assert(status == osOK);
+    status = active_object_post(&lock_task_ao,&req_msg,utils_timer_value(&timer));
+    if (status != osOK) {
+        log_error("comm put msg err:%d.\r\n",status);
+        return -1;
+    }
 
     /*等待消息*/
     while (utils_timer_value(&timer) > 0) {
         os_event = osMessageGet(contex->query_lock_status_rsp_msg_q_id,utils_timer_value(&timer));
         if (os_event.status == osEventMessage ){
             rsp_msg = *(lock_task_message_t *)os_event.value.v;
+            msg_pool_free(&lock_task_msg_pool,os_event.value.p);
             if (rsp_msg.response.type != LOCK_TASK_MSG_TYPE_RSP_LOCK_STATUS) {     
                 log_error("comm query lock status rsp type:%d err.\r\n",rsp_msg.response.type);
                 continue;
@@ -675,16 +811,22 @@ static int unlock_lock(communication_task_contex_t *contex)
     req_msg.request.type = LOCK_TASK_MSG_TYPE_UNLOCK_LOCK;    
     req_msg.request.rsp_message_queue_id = contex->unlock_lock_rsp_msg_q_id;
     utils_timer_init(&timer,ADU_UNLOCK_RSP_TIMEOUT,false);
+    /*丢弃上次超时后才到达的回应*/
+    msg_pool_flush(&lock_task_msg_pool,contex->unlock_lock_rsp_msg_q_id);
     
     /*发送消息*/
-    status = osMessagePut(lock_task_msg_q_id,(uint32_t)&req_msg,utils_timer_value(&timer));
-    log_assert(status == osOK);
+    status = active_object_post(&lock_task_ao,&req_msg,utils_timer_value(&timer));
+    if (status != osOK) {
+        log_error("comm put msg err:%d.\r\n",status);
+        return -1;
+    }
 
     /*等待消息*/
     while (utils_timer_value(&timer) > 0) {
         os_event = osMessageGet(contex->unlock_lock_rsp_msg_q_id,utils_timer_value(&timer));
         if (os_event.status == osEventMessage ){
             rsp_msg = *(lock_task_message_t *)os_event.value.v;
+            msg_pool_free(&lock_task_msg_pool,os_event.value.p);
             if (rsp_msg.response.type != LOCK_TASK_MSG_TYPE_RSP_UNLOCK_LOCK_RESULT) {     
                 log_error("comm unlock lock rsp type:%d err.\r\n",rsp_msg.response.type);
                 continue;
@@ -716,16 +858,22 @@ static int lock_lock(communication_task_contex_t *contex)
     req_msg.request.type = LOCK_TASK_MSG_TYPE_LOCK_LOCK;    
     req_msg.request.rsp_message_queue_id = contex->lock_lock_rsp_msg_q_id;
     utils_timer_init(&timer,ADU_LOCK_RSP_TIMEOUT,false);
+    /*丢弃上次超时后才到达的回应*/
+    msg_pool_flush(&lock_task_msg_pool,contex->lock_lock_rsp_msg_q_id);
     
     /*发送消息*/
-    status = osMessagePut(lock_task_msg_q_id,(uint32_t)&req_msg,utils_timer_value(&timer));
-    log_assert(status == osOK);
+    status = active_object_post(&lock_task_ao,&req_msg,utils_timer_value(&timer));
+    if (status != osOK) {
+        log_error("comm put msg err:%d.\r\n",status);
+        return -1;
+    }
 
     /*等待消息*/
     while (utils_timer_value(&timer) > 0) {
         os_event = osMessageGet(contex->lock_lock_rsp_msg_q_id,utils_timer_value(&timer));
         if (os_event.status == osEventMessage ){
             rsp_msg = *(lock_task_message_t *)os_event.value.v;
+            msg_pool_free(&lock_task_msg_pool,os_event.value.p);
             if (rsp_msg.response.type != LOCK_TASK_MSG_TYPE_RSP_LOCK_LOCK_RESULT) {     
                 log_error("comm lock lock rsp type:%d err.\r\n",rsp_msg.response.type);
                 continue;
@@ -758,16 +906,22 @@ static int query_temperature(communication_task_contex_t *contex,int8_t *tempera
     req_msg.request.type = TEMPERATURE_TASK_MSG_TYPE_TEMPERATURE;    
     req_msg.request.rsp_message_queue_id = contex->query_temperature_rsp_msg_q_id;
     utils_timer_init(&timer,ADU_QUERY_TEMPERATURE_TIMEOUT,false);
+    /*丢弃上次超时后才到达的回应*/
+    msg_pool_flush(&temperature_task_msg_pool,contex->query_temperature_rsp_msg_q_id);
     
     /*发送消息*/
-    status = osMessagePut(temperature_task_msg_q_id,(uint32_t)&req_msg,utils_timer_value(&timer));
-    log_assert(status == osOK);
+    status = active_object_post(&temperature_task_ao,&req_msg,utils_timer_value(&timer));
+    if (status != osOK) {
+        log_error("comm put msg err:%d.\r\n",status);
+        return -1;
+    }
 
     /*等待消息*/
     while (utils_timer_value(&timer) > 0) {
         os_event = osMessageGet(contex->query_temperature_rsp_msg_q_id,utils_timer_value(&timer));
         if (os_event.status == osEventMessage ){
             rsp_msg = *(temperature_task_message_t *)os_event.value.v;
+            msg_pool_free(&temperature_task_msg_pool,os_event.value.p);
             if (rsp_msg.response.type != TEMPERATURE_TASK_MSG_TYPE_RSP_TEMPERATURE) {     
                 log_error("comm query temperature rsp type:%d err.\r\n",rsp_msg.response.type);
                 continue;
@@ -785,6 +939,60 @@ static int query_temperature(communication_task_contex_t *contex,int8_t *tempera
     return -1;
 }
 
+/*
+* @brief 查询所有探头温度
+* @param contex 通信任务上下文
+* @param probe 探头温度 单位:0.01C 错误时为DATA_PROBE_ERR_VALUE
+* @return -1 失败
+* @return  0 成功
+* @note
+*/
+static int query_probe(communication_task_contex_t *contex,int16_t *probe)
+{
+    osStatus status;
+    osEvent os_event;
+
+    temperature_task_message_t req_msg,rsp_msg;
+    utils_timer_t timer;
+
+    req_msg.request.type = TEMPERATURE_TASK_MSG_TYPE_PROBE;    
+    req_msg.request.rsp_message_queue_id = contex->query_probe_rsp_msg_q_id;
+    utils_timer_init(&timer,ADU_QUERY_PROBE_TIMEOUT,false);
+    /*丢弃上次超时后才到达的回应*/
+    msg_pool_flush(&temperature_task_msg_pool,contex->query_probe_rsp_msg_q_id);
+    
+    /*发送消息*/
+    status = active_object_post(&temperature_task_ao,&req_msg,utils_timer_value(&timer));
+    if (status != osOK) {
+        log_error("comm put msg err:%d.\r\n",status);
+        return -1;
+    }
+
+    /*等待消息*/
+    while (utils_timer_value(&timer) > 0) {
+        os_event = osMessageGet(contex->query_probe_rsp_msg_q_id,utils_timer_value(&timer));
+        if (os_event.status == osEventMessage ){
+            rsp_msg = *(temperature_task_message_t *)os_event.value.v;
+            msg_pool_free(&temperature_task_msg_pool,os_event.value.p);
+            if (rsp_msg.response.type != TEMPERATURE_TASK_MSG_TYPE_RSP_PROBE) {     
+                log_error("comm query probe rsp type:%d err.\r\n",rsp_msg.response.type);
+                continue;
+            }
+            for (uint8_t i = 0;i < TEMPERATURE_PROBE_CNT;i ++) {
+                if (rsp_msg.response.probe.err_mask & (1U << i)) {
+                    probe[i] = DATA_PROBE_ERR_VALUE;
+                } else {
+                    probe[i] = rsp_msg.response.probe.value[i];
+                }
+            }
+            return 0;
+        }
+    }
+        
+    log_error("comm query probe timeout err.\r\n");
+    return -1;
+}
+
 /*
 * @brief 查询温度设置值
 * @param contex 通信任务上下文
@@ -804,16 +1012,22 @@ static int query_temperature_setting(communication_task_contex_t *contex,int8_t
     req_msg.request.type = COMPRESSOR_TASK_MSG_TYPE_QUERY_TEMPERATURE_SETTING;    
     req_msg.request.rsp_message_queue_id = contex->query_temperature_setting_rsp_msg_q_id;
     utils_timer_init(&timer,ADU_QUERY_TEMPERATURE_SETTING_TIMEOUT,false);
+    /*丢弃上次超时后才到达的回应*/
+    msg_pool_flush(&compressor_task_msg_pool,contex->query_temperature_setting_rsp_msg_q_id);
     
     /*发送消息*/
-    status = osMessagePut(compressor_task_msg_q_id,(uint32_t)&req_msg,utils_timer_value(&timer));
-    log_assert(status == osOK);
+    status = active_object_post(&compressor_task_ao,&req_msg,utils_timer_value(&timer));
+    if (status != osOK) {
+        log_error("comm put msg err:%d.\r\n",status);
+        return -1;
+    }
 
     /*等待消息*/
     while (utils_timer_value(&timer) > 0) {
         os_event = osMessageGet(contex->query_temperature_setting_rsp_msg_q_id,utils_timer_value(&timer));
         if (os_event.status == osEventMessage ){
             rsp_msg = *(compressor_task_message_t *)os_event.value.v;
+            msg_pool_free(&compressor_task_msg_pool,os_event.value.p);
             if (rsp_msg.response.type != COMPRESSOR_TASK_MSG_TYPE_RSP_QUERY_TEMPERATURE_SETTING) {     
                 log_error("comm query temperature setting rsp type:%d err.\r\n",rsp_msg.response.type);
                 continue;
@@ -828,6 +1042,55 @@ static int query_temperature_setting(communication_task_contex_t *contex,int8_t
     return -1;
 }
 
+/*
+* @brief 查询压缩机运行统计
+* @param contex 通信任务上下文
+* @param stats 运行统计指针
+* @return -1 失败
+* @return  0 成功
+* @note
+*/
+static int query_compressor_stats(communication_task_contex_t *contex,compressor_stats_t *stats)
+{
+    osStatus status;
+    osEvent os_event;
+
+    compressor_task_message_t req_msg,rsp_msg;
+    utils_timer_t timer;
+
+    req_msg.request.type = COMPRESSOR_TASK_MSG_TYPE_QUERY_STATS;    
+    req_msg.request.rsp_message_queue_id = contex->query_compressor_stats_rsp_msg_q_id;
+    utils_timer_init(&timer,ADU_QUERY_COMPRESSOR_STATS_TIMEOUT,false);
+    /*丢弃上次超时后才到达的回应*/
+    msg_pool_flush(&compressor_task_msg_pool,contex->query_compressor_stats_rsp_msg_q_id);
+    
+    /*发送消息*/
+    status = active_object_post(&compressor_task_ao,&req_msg,utils_timer_value(&timer));
+    if (status != osOK) {
+        log_error("comm put msg err:%d.\r\n",status);
+        return -1;
+    }
+
+    /*等待消息*/
+    while (utils_timer_value(&timer) > 0) {
+        os_event = osMessageGet(contex->query_compressor_stats_rsp_msg_q_id,utils_timer_value(&timer));
+        if (os_event.status == osEventMessage ){
+            rsp_msg = *(compressor_task_message_t *)os_event.value.v;
+            msg_pool_free(&compressor_task_msg_pool,os_event.value.p);
+            if (rsp_msg.response.type != COMPRESSOR_TASK_MSG_TYPE_RSP_QUERY_STATS) {     
+                log_error("comm query compressor stats rsp type:%d err.\r\n",rsp_msg.response.type);
+                continue;
+            }
+
+            *stats = rsp_msg.response.stats;
+            return 0;
+        }
+    }
+        
+    log_error("comm query compressor stats timeout err.\r\n");
+    return -1;
+}
+
 /*
 * @brief 设置压缩机温度控制区间
 * @param contex 通信任务上下文
@@ -848,16 +1111,22 @@ static int temperature_setting(communication_task_contex_t *contex,int8_t settin
     req_msg.request.rsp_message_queue_id = contex->temperature_setting_rsp_msg_q_id;
     req_msg.request.temperature_setting = setting;
     utils_timer_init(&timer,ADU_QUERY_TEMPERATURE_SETTING_TIMEOUT,false);
+    /*丢弃上次超时后才到达的回应*/
+    msg_pool_flush(&compressor_task_msg_pool,contex->temperature_setting_rsp_msg_q_id);
     
     /*发送消息*/
-    status = osMessagePut(compressor_task_msg_q_id,(uint32_t)&req_msg,utils_timer_value(&timer));
-    log_assert(status == osOK);
+    status = active_object_post(&compressor_task_ao,&req_msg,utils_timer_value(&timer));
+    if (status != osOK) {
+        log_error("comm put msg err:%d.\r\n",status);
+        return -1;
+    }
 
     /*等待消息*/
     while (utils_timer_value(&timer) > 0) {
         os_event = osMessageGet(contex->temperature_setting_rsp_msg_q_id,utils_timer_value(&timer));
         if (os_event.status == osEventMessage ){
             rsp_msg = *(compressor_task_message_t *)os_event.value.v;
+            msg_pool_free(&compressor_task_msg_pool,os_event.value.p);
             if (rsp_msg.response.type != COMPRESSOR_TASK_MSG_TYPE_RSP_TEMPERATURE_SETTING) {     
                 log_error("comm temperature setting rsp type:%d err.\r\n",rsp_msg.response.type);
                 continue;
@@ -899,6 +1168,193 @@ static int query_software_version(communication_task_contex_t *contex,uint32_t *
     *software_version = contex->software_version;
     return 0;
 }
+/*升级文件接收*/
+typedef struct
+{
+    flash_if_stream_t stream;
+    md5_ctx_t         md5;       /*文件MD5,和通知的MD5比较*/
+    md5_ctx_t         image_md5; /*压缩或者补丁文件生成的镜像MD5,和最内层头部的MD5比较*/
+    lzss_decoder_t    lzss;
+    delta_patch_t     delta;
+    bool              compressed;/*文件是压缩格式*/
+    bool              patched;   /*文件(解压后)是差分补丁*/
+    bool              erased;    /*更新区域已经擦除*/
+    uint32_t          file_size; /*ymodem头部的文件大小*/
+    uint32_t          received;  /*已收到的文件数据量*/
+    uint32_t          payload;   /*已收到的文件(解压后)数据量*/
+    uint32_t          erase_time;/*擦除时间 单位:us*/
+    uint32_t          write_time;/*MD5 解压和编程时间(含擦除) 单位:us*/
+}update_sink_contex_t;
+
+static update_sink_contex_t update_sink_contex;
+
+/*
+* @brief 升级文件开始
+* @param arg 升级文件接收上下文
+* @param size 文件大小
+* @return 0 成功 -1 失败
+* @note 压缩文件收到头部才知道镜像大小,擦除推迟到第一次写镜像
+*/
+static int update_sink_open(void *arg,uint32_t size)
+{
+    update_sink_contex_t *contex = (update_sink_contex_t *)arg;
+
+    contex->compressed = false;
+    contex->patched = false;
+    contex->erased = false;
+    contex->file_size = size;
+    contex->received = 0;
+    contex->payload = 0;
+    contex->erase_time = 0;
+    contex->write_time = 0;
+    md5_init(&contex->md5);
+
+    return 0;
+}
+
+/*
+* @brief 写入镜像数据
+* @param arg 升级文件接收上下文
+* @param data 数据
+* @param size 数据量
+* @return 0 成功 -1 失败
+* @note 未压缩文件直接写入,压缩文件和补丁作为解压和打补丁的输出函数.只擦除镜像需要的区域
+*/
+static int update_image_write(void *arg,const uint8_t *data,uint32_t size)
+{
+    int rc;
+    uint32_t start;
+    uint32_t image_size;
+    update_sink_contex_t *contex = (update_sink_contex_t *)arg;
+
+    if (contex->erased == false) {
+        if (contex->patched == true) {
+            image_size = contex->delta.size;
+        } else {
+            image_size = contex->compressed == true ? contex->lzss.size : contex->file_size;
+        }
+        if (image_size > APPLICATION_SIZE_LIMIT) {
+            log_error("update image size:%d > limit size %d err.\r\n",image_size,APPLICATION_SIZE_LIMIT);
+            return -1;
+        }
+        start = run_time_stats_get_counter();
+        rc = flash_if_erase(APPLICATION_UPDATE_BASE_ADDR,image_size > 0 ? image_size : APPLICATION_SIZE_LIMIT);
+        contex->erase_time = run_time_stats_get_counter() - start;
+        if (rc != 0) {
+            return -1;
+        }
+        if (flash_if_stream_open(&contex->stream,APPLICATION_UPDATE_BASE_ADDR,APPLICATION_SIZE_LIMIT) != 0) {
+            return -1;
+        }
+        contex->erased = true;
+    }
+    if (contex->compressed == true || contex->patched == true) {
+        md5_update(&contex->image_md5,(const char *)data,size);
+    }
+
+    return flash_if_stream_write(&contex->stream,data,size);
+}
+
+/*
+* @brief 开始打补丁
+* @param contex 升级文件接收上下文
+* @return 0 成功 -1 失败
+* @note 旧镜像是APPLICATION_BASE_ADDR的当前应用,大小和MD5取自环境变量;
+*       先校验flash中的应用和环境变量一致,补丁头部再和它们比较
+*/
+static int update_patch_open(update_sink_contex_t *contex)
+{
+    int32_t app_size;
+    uint8_t app_md5[16];
+    char md5_value[16];
+
+    if (device_env_get_int(ENV_BOOTLOADER_APPLICATION_SIZE_NAME,&app_size) != 0 ||
+        device_env_get_bytes(ENV_BOOTLOADER_APPLICATION_MD5_NAME,app_md5,16) != 16) {
+        log_error("no app size or md5 env for patch.\r\n");
+        return -1;
+    }
+    if (app_size <= 0 || app_size > APPLICATION_SIZE_LIMIT) {
+        log_error("app size:%d err.\r\n",app_size);
+        return -1;
+    }
+    md5((const char *)FLASH_IF_ADDR(APPLICATION_BASE_ADDR),app_size,md5_value);
+    if (memcmp(md5_value,app_md5,16) != 0) {
+        log_error("app in flash not match app md5 env.\r\n");
+        return -1;
+    }
+    md5_init(&contex->image_md5);
+    delta_patch_init(&contex->delta,(const uint8_t *)FLASH_IF_ADDR(APPLICATION_BASE_ADDR),app_size,app_md5,update_image_write,contex);
+    contex->patched = true;
+    log_info("update file is patch for app size:%d.\r\n",app_size);
+
+    return 0;
+}
+
+/*
+* @brief 写入文件(解压后)数据
+* @param arg 升级文件接收上下文
+* @param data 数据
+* @param size 数据量
+* @return 0 成功 -1 失败
+* @note 以"DLT1"开头时对当前应用打补丁,否则就是镜像
+*/
+static int update_payload_write(void *arg,const uint8_t *data,uint32_t size)
+{
+    update_sink_contex_t *contex = (update_sink_contex_t *)arg;
+
+    if (contex->payload == 0 && delta_is_patch(data,size) == true) {
+        if (update_patch_open(contex) != 0) {
+            return -1;
+        }
+    }
+    contex->payload += size;
+    if (contex->patched == true) {
+        return delta_patch(&contex->delta,data,size);
+    }
+
+    return update_image_write(contex,data,size);
+}
+
+/*
+* @brief 升级文件数据
+* @param arg 升级文件接收上下文
+* @param data 数据
+* @param size 数据量
+* @return 0 成功 -1 失败
+* @note 边接收边计算MD5,不再对整个文件做第二遍MD5;
+*       文件以"LZS1"开头时边接收边解压,只占用解压窗口的RAM;解压后的数据可以是补丁
+*/
+static int update_sink_write(void *arg,const uint8_t *data,uint32_t size)
+{
+    int rc;
+    uint32_t start;
+    update_sink_contex_t *contex = (update_sink_contex_t *)arg;
+
+    start = run_time_stats_get_counter();
+    if (contex->received == 0 && lzss_is_compressed(data,size) == true) {
+        contex->compressed = true;
+        md5_init(&contex->image_md5);
+        lzss_decoder_init(&contex->lzss,update_payload_write,contex);
+        log_info("update file is compressed.\r\n");
+    }
+    contex->received += size;
+    md5_update(&contex->md5,(const char *)data,size);
+    if (contex->compressed == true) {
+        rc = lzss_decode(&contex->lzss,data,size);
+    } else {
+        rc = update_payload_write(contex,data,size);
+    }
+    contex->write_time += run_time_stats_get_counter() - start;
+
+    return rc;
+}
+
+static const fymodem_sink_t update_sink = {
+    .open = update_sink_open,
+    .write = update_sink_write,
+    .arg = &update_sink_contex
+};
+
 /*
 * @brief 处理升级
 * @param contex 通信任务上下文
@@ -918,23 +1374,65 @@ static int process_update(application_update_t *update,uint32_t timeout)
     char size_str_buffer[SIZE_STR_BUFFER];
 
     int size = 0;
+    uint32_t start;
 
     log_info("start process update...\r\n");
-    size = fymodem_receive(&communication_serial_handle,APPLICATION_UPDATE_BASE_ADDR,APPLICATION_SIZE_LIMIT,file_name,timeout);
+    start = run_time_stats_get_counter();
+    size = fymodem_receive(&communication_serial_handle,&update_sink,APPLICATION_SIZE_LIMIT,file_name,timeout);
     if (size > 0) {
         log_info("update file_name:%s.\r\n",file_name);
         if (size != update->size) {
             log_error("file ymodem get size:%d != notify size:%d.\r\n",size,update->size);
             return -1;
         }
-        /*计算MD5*/
-        md5((char *)APPLICATION_UPDATE_BASE_ADDR,size,md5_value);
+        if (update_sink_contex.compressed == true && lzss_decode_is_done(&update_sink_contex.lzss) == false) {
+            log_error("compressed file incomplete.image:%d of %d.\r\n",update_sink_contex.lzss.out,update_sink_contex.lzss.size);
+            return -1;
+        }
+        if (update_sink_contex.patched == true && delta_patch_is_done(&update_sink_contex.delta) == false) {
+            log_error("patch incomplete.image:%d of %d.\r\n",update_sink_contex.delta.out,update_sink_contex.delta.size);
+            return -1;
+        }
+        if (update_sink_contex.erased == false) {
+            log_error("update image empty.\r\n");
+            return -1;
+        }
+        /*编程最后不满一页的数据*/
+        if (flash_if_stream_close(&update_sink_contex.stream) != 0) {
+            return -1;
+        }
+        /*接收时已经计算MD5*/
+        md5_final(&update_sink_contex.md5,md5_value);
         dump_hex_str(md5_value,md5_str_buffer,16);
+        log_info("update recv time:%d ms erase:%d ms md5 and program:%d ms.\r\n",
+                 (run_time_stats_get_counter() - start) / 1000,
+                 update_sink_contex.erase_time / 1000,
+                 (update_sink_contex.write_time - update_sink_contex.erase_time) / 1000);
 
         if (strcmp(md5_str_buffer,update->md5_str) != 0) {
             log_error("file md5 calculate:%s != notify md5:%s.\r\n",md5_str_buffer,update->md5_str);
             return -1;
         }
+        /*压缩或者补丁文件:校验生成的完整镜像,bootloader用镜像的大小和MD5*/
+        if (update_sink_contex.patched == true) {
+            md5_final(&update_sink_contex.image_md5,md5_value);
+            if (memcmp(md5_value,update_sink_contex.delta.md5,16) != 0) {
+                log_error("patched image md5 err.\r\n");
+                return -1;
+            }
+            dump_hex_str(md5_value,md5_str_buffer,16);
+            size = update_sink_contex.delta.size;
+            log_info("patched image size:%d md5:%s.\r\n",size,md5_str_buffer);
+        } else if (update_sink_contex.compressed == true) {
+            md5_final(&update_sink_contex.image_md5,md5_value);
+            if (memcmp(md5_value,update_sink_contex.lzss.md5,16) != 0) {
+                log_error("decompressed image md5 err.\r\n");
+                return -1;
+            }
+            dump_hex_str(md5_value,md5_str_buffer,16);
+            size = update_sink_contex.lzss.size;
+            log_info("decompressed image size:%d md5:%s.\r\n",size,md5_str_buffer);
+        }
         /*int转换成字符串*/
         snprintf(size_str_buffer,SIZE_STR_BUFFER,"%d",size);
 
@@ -950,9 +1448,21 @@ static int process_update(application_update_t *update,uint32_t timeout)
         if (device_env_set(ENV_BOOTLOADER_UPDATE_MD5_NAME,md5_str_buffer)!= 0) {
             return -1;
         }
+#if  DEVICE_ENV_USE_WRITE_BACK > 0
+        /*size和md5保存后才能设置更新标志*/
+        if (device_env_barrier() != 0) {
+            return -1;
+        }
+#endif
         log_info("set flag new env...\r\n");
         /*设置更新标志*/
         device_env_set(ENV_BOOTLOADER_FLAG_NAME,ENV_BOOTLOADER_NEW);
+#if  DEVICE_ENV_USE_WRITE_BACK > 0
+        /*复位前保存*/
+        if (device_env_barrier() != 0) {
+            return -1;
+        }
+#endif
 
         log_info("all done. reboot...\r\n");
         /*禁止看门狗*/
@@ -978,11 +1488,13 @@ static int process_update(application_update_t *update,uint32_t timeout)
 */
 static int compressor_ctrl_pwr_on()
 {
-    static compressor_task_message_t req_msg;
+    compressor_task_message_t req_msg;
     
     req_msg.request.type = COMPRESSOR_TASK_MSG_TYPE_DEBUG_PWR_ON;
     /*发送消息*/
-    osMessagePut(compressor_task_msg_q_id,(uint32_t)&req_msg,0);
+    if (active_object_post(&compressor_task_ao,&req_msg,0) != osOK) {
+        return -1;
+    }
 
     return 0;
 }
@@ -996,15 +1508,38 @@ static int compressor_ctrl_pwr_on()
 */
 static int compressor_ctrl_pwr_off()
 {
-    static compressor_task_message_t req_msg;
+    compressor_task_message_t req_msg;
     
     req_msg.request.type = COMPRESSOR_TASK_MSG_TYPE_DEBUG_PWR_OFF;
     /*发送消息*/
-    osMessagePut(compressor_task_msg_q_id,(uint32_t)&req_msg,0);
+    if (active_object_post(&compressor_task_ao,&req_msg,0) != osOK) {
+        return -1;
+    }
     
     return 0;
 }
 
+/*
+* @brief 查询任务和中断的cpu占用率
+* @param item 统计项缓存
+* @param offset 起始统计项序号
+* @param window 新的统计窗口 单位:ms 0:不修改
+* @param total 统计项总数
+* @return -1 失败
+* @return >=0 统计项数量
+* @note 返回的是上一个完整窗口的结果
+*/
+static int query_run_time_stats(run_time_stats_item_t *item,uint8_t offset,uint16_t window,uint8_t *total)
+{
+    if (window != 0 && window != run_time_stats_get_window()) {
+        if (run_time_stats_set_window(window) != 0) {
+            return -1;
+        }
+    }
+
+    return run_time_stats_get_result(item,offset,DATA_RUN_TIME_STATS_ITEM_CNT_MAX,total);
+}
+
 /*
 * @brief 串口接收主机ADU
 * @param handle 串口句柄
@@ -1018,7 +1553,8 @@ static int receive_adu(serial_handle_t *handle,uint8_t *adu,uint8_t size,uint32_
 {
     int rc = -1;
     int read_size,read_size_total = 0;
-    char buffer[ADU_SIZE_MAX * 2 + 1];
+    /*只在通信任务中使用,放在静态区减小任务栈*/
+    static char buffer[ADU_SIZE_MAX * 2 + 1];
 
     while (read_size_total < size) {
         rc = serial_select(handle,timeout);
@@ -1089,7 +1625,18 @@ static int parse_adu(uint8_t *adu,uint8_t size,uint8_t *rsp,application_update_t
     uint8_t status;
     uint8_t scale_cnt;
     int8_t  temperature;
+    int16_t probe[TEMPERATURE_PROBE_CNT];
+    compressor_stats_t compressor_stats;
     int16_t net_weight[SCALE_CNT_MAX];
+    uint8_t stats_offset,stats_total;
+    uint16_t stats_window;
+    uint8_t latency_code,latency_phase;
+    uint16_t latency_bucket[COMMUNICATION_LATENCY_BUCKET_CNT];
+    uint32_t history_seq,history_head,history_uptime;
+    uint8_t history_cnt;
+    /*只在通信任务中使用,放在静态区减小任务栈*/
+    static run_time_stats_item_t stats_item[DATA_RUN_TIME_STATS_ITEM_CNT_MAX];
+    static history_record_t history_record[DATA_HISTORY_RECORD_CNT_MAX];
     uint8_t rsp_size = 0;
     uint8_t rsp_offset = 0;
 
@@ -1278,6 +1825,61 @@ static int parse_adu(uint8_t *adu,uint8_t size,uint8_t *rsp,application_update_t
             }
             rsp[rsp_offset ++] = temperature;
             break; 
+        case CODE_QUERY_PROBE:/*查询所有探头温度*/
+            if (size != ADU_DATA_REGION_QUERY_PROBE_SIZE) {
+                log_error("query probe data size:%d != %d err.\r\n",size,ADU_DATA_REGION_QUERY_PROBE_SIZE);
+                return -1;
+            }
+            log_debug("query probe...\r\n");
+            rc = query_probe(&communication_task_contex,probe);
+            if (rc != 0) {
+                log_error("query probe internal err.\r\n");
+                return -1;
+            }
+            /*探头数量 + 每个探头2字节温度 单位:0.01C*/
+            rsp[rsp_offset ++] = TEMPERATURE_PROBE_CNT;
+            for (uint8_t i = 0;i < TEMPERATURE_PROBE_CNT;i ++) {
+                rsp[rsp_offset ++] = ((uint16_t)probe[i] >> 8) & 0xFF;
+                rsp[rsp_offset ++] = (uint16_t)probe[i] & 0xFF;
+            }
+            break;
+        case CODE_QUERY_COMPRESSOR_STATS:/*查询压缩机运行统计*/
+            if (size != ADU_DATA_REGION_QUERY_COMPRESSOR_STATS_SIZE) {
+                log_error("query compressor stats data size:%d != %d err.\r\n",size,ADU_DATA_REGION_QUERY_COMPRESSOR_STATS_SIZE);
+                return -1;
+            }
+            log_debug("query compressor stats...\r\n");
+            rc = query_compressor_stats(&communication_task_contex,&compressor_stats);
+            if (rc != 0) {
+                log_error("query compressor stats internal err.\r\n");
+                return -1;
+            }
+            /*运行时间,开机次数,最长运行时间,耗电各4字节;温度错误次数,休息次数,1小时和24小时占空比各2字节*/
+            rsp[rsp_offset ++] = (compressor_stats.run_time >> 24) & 0xFF;
+            rsp[rsp_offset ++] = (compressor_stats.run_time >> 16) & 0xFF;
+            rsp[rsp_offset ++] = (compressor_stats.run_time >> 8) & 0xFF;
+            rsp[rsp_offset ++] = compressor_stats.run_time & 0xFF;
+            rsp[rsp_offset ++] = (compressor_stats.start_cnt >> 24) & 0xFF;
+            rsp[rsp_offset ++] = (compressor_stats.start_cnt >> 16) & 0xFF;
+            rsp[rsp_offset ++] = (compressor_stats.start_cnt >> 8) & 0xFF;
+            rsp[rsp_offset ++] = compressor_stats.start_cnt & 0xFF;
+            rsp[rsp_offset ++] = (compressor_stats.run_max >> 24) & 0xFF;
+            rsp[rsp_offset ++] = (compressor_stats.run_max >> 16) & 0xFF;
+            rsp[rsp_offset ++] = (compressor_stats.run_max >> 8) & 0xFF;
+            rsp[rsp_offset ++] = compressor_stats.run_max & 0xFF;
+            rsp[rsp_offset ++] = (compressor_stats.energy >> 24) & 0xFF;
+            rsp[rsp_offset ++] = (compressor_stats.energy >> 16) & 0xFF;
+            rsp[rsp_offset ++] = (compressor_stats.energy >> 8) & 0xFF;
+            rsp[rsp_offset ++] = compressor_stats.energy & 0xFF;
+            rsp[rsp_offset ++] = (compressor_stats.fault_cnt >> 8) & 0xFF;
+            rsp[rsp_offset ++] = compressor_stats.fault_cnt & 0xFF;
+            rsp[rsp_offset ++] = (compressor_stats.rest_cnt >> 8) & 0xFF;
+            rsp[rsp_offset ++] = compressor_stats.rest_cnt & 0xFF;
+            rsp[rsp_offset ++] = (compressor_stats.duty_hour >> 8) & 0xFF;
+            rsp[rsp_offset ++] = compressor_stats.duty_hour & 0xFF;
+            rsp[rsp_offset ++] = (compressor_stats.duty_day >> 8) & 0xFF;
+            rsp[rsp_offset ++] = compressor_stats.duty_day & 0xFF;
+            break;
         case CODE_SET_TEMPERATURE:/*设置温度区间*/
             if (size != ADU_DATA_REGION_SET_TEMPERATURE_SIZE) {
                 log_error("set temperature data size:%d != %d err.\r\n",size,ADU_DATA_REGION_SET_TEMPERATURE_SIZE);
@@ -1364,6 +1966,105 @@ static int parse_adu(uint8_t *adu,uint8_t size,uint8_t *rsp,application_update_t
             }
             break;
 
+        case CODE_QUERY_RUN_TIME_STATS:/*查询任务和中断cpu占用率*/
+            if (size != ADU_DATA_REGION_QUERY_RUN_TIME_STATS_SIZE) {
+                log_error("query run time stats data size:%d != %d err.\r\n",size,ADU_DATA_REGION_QUERY_RUN_TIME_STATS_SIZE);
+                return -1;
+            }
+            stats_offset = adu[ADU_DATA_REGION_OFFSET + DATA_REGION_STATS_ITEM_OFFSET];
+            stats_window = (uint16_t)adu[ADU_DATA_REGION_OFFSET + DATA_REGION_STATS_WINDOW_OFFSET] << 8 | adu[ADU_DATA_REGION_OFFSET + DATA_REGION_STATS_WINDOW_OFFSET + 1];
+            log_debug("query run time stats offset:%d window:%d...\r\n",stats_offset,stats_window);
+            rc = query_run_time_stats(stats_item,stats_offset,stats_window,&stats_total);
+            if (rc < 0) {
+                log_error("query run time stats internal err.\r\n");
+                return -1;
+            }
+            stats_window = run_time_stats_get_window();
+            rsp[rsp_offset ++] = stats_total;
+            rsp[rsp_offset ++] = stats_offset;
+            rsp[rsp_offset ++] = (stats_window >> 8) & 0xFF;
+            rsp[rsp_offset ++] = stats_window & 0xFF;
+            rsp[rsp_offset ++] = rc;
+            for (uint8_t i = 0;i < rc;i ++) {
+                rsp[rsp_offset ++] = stats_item[i].number;
+                rsp[rsp_offset ++] = (stats_item[i].usage >> 8) & 0xFF;
+                rsp[rsp_offset ++] = stats_item[i].usage & 0xFF;
+            }
+            break;
+
+        case CODE_QUERY_LATENCY:/*查询命令码某阶段延时直方图*/
+            if (size != ADU_DATA_REGION_QUERY_LATENCY_SIZE) {
+                log_error("query latency data size:%d != %d err.\r\n",size,ADU_DATA_REGION_QUERY_LATENCY_SIZE);
+                return -1;
+            }
+            latency_code = adu[ADU_DATA_REGION_OFFSET + DATA_REGION_LATENCY_CODE_OFFSET];
+            latency_phase = adu[ADU_DATA_REGION_OFFSET + DATA_REGION_LATENCY_PHASE_OFFSET];
+            log_debug("query latency code:%d phase:%d...\r\n",latency_code,latency_phase);
+            rc = communication_latency_get(latency_code,latency_phase,latency_bucket);
+            if (rc != 0) {
+                return -1;
+            }
+            rsp[rsp_offset ++] = latency_code;
+            rsp[rsp_offset ++] = latency_phase;
+            rsp[rsp_offset ++] = COMMUNICATION_LATENCY_BUCKET_CNT;
+            for (uint8_t i = 0;i < COMMUNICATION_LATENCY_BUCKET_CNT;i ++) {
+                rsp[rsp_offset ++] = (latency_bucket[i] >> 8) & 0xFF;
+                rsp[rsp_offset ++] = latency_bucket[i] & 0xFF;
+            }
+            break;
+
+        case CODE_RESET_LATENCY:/*清空延时直方图*/
+            if (size != ADU_DATA_REGION_RESET_LATENCY_SIZE) {
+                log_error("reset latency data size:%d != %d err.\r\n",size,ADU_DATA_REGION_RESET_LATENCY_SIZE);
+                return -1;
+            }
+            communication_latency_reset();
+            rsp[rsp_offset ++] = DATA_RESULT_RESET_LATENCY_SUCCESS;
+            break;
+
+        case CODE_QUERY_HISTORY:/*从指定序号开始批量读取历史记录*/
+            if (size != ADU_DATA_REGION_QUERY_HISTORY_SIZE) {
+                log_error("query history data size:%d != %d err.\r\n",size,ADU_DATA_REGION_QUERY_HISTORY_SIZE);
+                return -1;
+            }
+            history_seq = (uint32_t)adu[ADU_DATA_REGION_OFFSET + DATA_REGION_HISTORY_SEQ_OFFSET] << 24 |
+                          (uint32_t)adu[ADU_DATA_REGION_OFFSET + DATA_REGION_HISTORY_SEQ_OFFSET + 1] << 16 |
+                          (uint32_t)adu[ADU_DATA_REGION_OFFSET + DATA_REGION_HISTORY_SEQ_OFFSET + 2] << 8 |
+                          adu[ADU_DATA_REGION_OFFSET + DATA_REGION_HISTORY_SEQ_OFFSET + 3];
+            history_cnt = adu[ADU_DATA_REGION_OFFSET + DATA_REGION_HISTORY_CNT_OFFSET];
+            if (history_cnt > DATA_HISTORY_RECORD_CNT_MAX) {
+                history_cnt = DATA_HISTORY_RECORD_CNT_MAX;
+            }
+            log_debug("query history seq:%d cnt:%d...\r\n",history_seq,history_cnt);
+            history_uptime = history_task_uptime();
+            history_head = history_task_head();
+            history_cnt = history_task_read(history_seq,history_record,history_cnt,&history_seq);
+            /*实际开始序号,最新序号,上电时间,数量,然后每条记录:时间,类型,参数,数值*/
+            rsp[rsp_offset ++] = (history_seq >> 24) & 0xFF;
+            rsp[rsp_offset ++] = (history_seq >> 16) & 0xFF;
+            rsp[rsp_offset ++] = (history_seq >> 8) & 0xFF;
+            rsp[rsp_offset ++] = history_seq & 0xFF;
+            rsp[rsp_offset ++] = (history_head >> 24) & 0xFF;
+            rsp[rsp_offset ++] = (history_head >> 16) & 0xFF;
+            rsp[rsp_offset ++] = (history_head >> 8) & 0xFF;
+            rsp[rsp_offset ++] = history_head & 0xFF;
+            rsp[rsp_offset ++] = (history_uptime >> 24) & 0xFF;
+            rsp[rsp_offset ++] = (history_uptime >> 16) & 0xFF;
+            rsp[rsp_offset ++] = (history_uptime >> 8) & 0xFF;
+            rsp[rsp_offset ++] = history_uptime & 0xFF;
+            rsp[rsp_offset ++] = history_cnt;
+            for (uint8_t i = 0;i < history_cnt;i ++) {
+                rsp[rsp_offset ++] = (history_record[i].time >> 24) & 0xFF;
+                rsp[rsp_offset ++] = (history_record[i].time >> 16) & 0xFF;
+                rsp[rsp_offset ++] = (history_record[i].time >> 8) & 0xFF;
+                rsp[rsp_offset ++] = history_record[i].time & 0xFF;
+                rsp[rsp_offset ++] = history_record[i].type;
+                rsp[rsp_offset ++] = history_record[i].arg;
+                rsp[rsp_offset ++] = ((uint16_t)history_record[i].value >> 8) & 0xFF;
+                rsp[rsp_offset ++] = (uint16_t)history_record[i].value & 0xFF;
+            }
+            break;
+
         default:
             log_error("unknow code:%d err.\r\n",code);
     }
@@ -1389,7 +2090,8 @@ static int parse_adu(uint8_t *adu,uint8_t size,uint8_t *rsp,application_update_t
 static int send_adu(serial_handle_t *handle,uint8_t *adu,uint8_t size,uint32_t timeout)
 {
     uint8_t write_size;
-    char buffer[ADU_SIZE_MAX * 2 + 1];
+    /*只在通信任务中使用,放在静态区减小任务栈*/
+    static char buffer[ADU_SIZE_MAX * 2 + 1];
 
     write_size = serial_write(handle,(char *)adu,size);
 
@@ -1472,104 +2174,151 @@ static serial_handle_t *get_serial_handle_by_port(communication_task_contex_t *c
 /*控制器任务通信中断处理*/
 void FLEXCOMM0_IRQHandler()
 {
+    uint32_t start;
+    uint32_t recv_write;
+
+    start = run_time_stats_isr_enter();
+    trace_isr_enter(0);
     if (communication_serial_handle.registered && communication_serial_handle.init) {
-        nxp_serial_uart_hal_isr(&communication_serial_handle);
+        recv_write = communication_serial_handle.recv.write;
+        COMMUNICATION_SERIAL_HAL_ISR(&communication_serial_handle);
+        /*收到了新数据,记录主机adu首字节和末字节时间*/
+        if (communication_serial_handle.recv.write != recv_write) {
+            host_last_byte_time = run_time_stats_get_counter();
+            if (host_byte_stamp_valid == false) {
+                host_first_byte_time = host_last_byte_time;
+                host_byte_stamp_valid = true;
+            }
+        }
     }
-
+    trace_isr_exit(0);
+    run_time_stats_isr_exit(0,start);
 }
 
 /*电子秤任务通信中断处理*/
 void FLEXCOMM1_IRQHandler()
 {
+    uint32_t start;
     serial_handle_t *handle;
 
+    start = run_time_stats_isr_enter();
+    trace_isr_enter(1);
     handle = get_serial_handle_by_port(&communication_task_contex,1);
     if (handle->registered && handle->init) {
-        nxp_serial_uart_hal_isr(handle);
+        COMMUNICATION_SERIAL_HAL_ISR(handle);
     }
-
+    trace_isr_exit(1);
+    run_time_stats_isr_exit(1,start);
 }
 
 /*电子秤任务通信中断处理*/
 void FLEXCOMM2_IRQHandler()
 {
+    uint32_t start;
     serial_handle_t *handle;
 
+    start = run_time_stats_isr_enter();
+    trace_isr_enter(2);
     handle = get_serial_handle_by_port(&communication_task_contex,2);
     if (handle->registered && handle->init) {
-        nxp_serial_uart_hal_isr(handle);
+        COMMUNICATION_SERIAL_HAL_ISR(handle);
     }
-
+    trace_isr_exit(2);
+    run_time_stats_isr_exit(2,start);
 }
 
 /*电子秤任务通信中断处理*/
 void FLEXCOMM3_IRQHandler()
 {
+    uint32_t start;
     serial_handle_t *handle;
 
+    start = run_time_stats_isr_enter();
+    trace_isr_enter(3);
     handle = get_serial_handle_by_port(&communication_task_contex,3);
     if (handle->registered && handle->init) {
-        nxp_serial_uart_hal_isr(handle);
+        COMMUNICATION_SERIAL_HAL_ISR(handle);
     }
-
+    trace_isr_exit(3);
+    run_time_stats_isr_exit(3,start);
 }
 /*电子秤任务通信中断处理*/
 void FLEXCOMM4_IRQHandler()
 {
+    uint32_t start;
     serial_handle_t *handle;
 
+    start = run_time_stats_isr_enter();
+    trace_isr_enter(4);
     handle = get_serial_handle_by_port(&communication_task_contex,4);
     if (handle->registered && handle->init) {
-        nxp_serial_uart_hal_isr(handle);
+        COMMUNICATION_SERIAL_HAL_ISR(handle);
     }
-
+    trace_isr_exit(4);
+    run_time_stats_isr_exit(4,start);
 }
 
 /*电子秤任务通信中断处理*/
 void FLEXCOMM5_IRQHandler()
 {
+    uint32_t start;
     serial_handle_t *handle;
 
+    start = run_time_stats_isr_enter();
+    trace_isr_enter(5);
     handle = get_serial_handle_by_port(&communication_task_contex,5);
     if (handle->registered && handle->init) {
-        nxp_serial_uart_hal_isr(handle);
+        COMMUNICATION_SERIAL_HAL_ISR(handle);
     }
-
+    trace_isr_exit(5);
+    run_time_stats_isr_exit(5,start);
 }
 
 /*电子秤任务通信中断处理*/
 void FLEXCOMM6_IRQHandler()
 {
+    uint32_t start;
     serial_handle_t *handle;
 
+    start = run_time_stats_isr_enter();
+    trace_isr_enter(6);
     handle = get_serial_handle_by_port(&communication_task_contex,6);
     if (handle->registered && handle->init) {
-        nxp_serial_uart_hal_isr(handle);
+        COMMUNICATION_SERIAL_HAL_ISR(handle);
     }
-
+    trace_isr_exit(6);
+    run_time_stats_isr_exit(6,start);
 }
 
 /*电子秤任务通信中断处理*/
 void FLEXCOMM7_IRQHandler()
 {
+    uint32_t start;
     serial_handle_t *handle;
 
+    start = run_time_stats_isr_enter();
+    trace_isr_enter(7);
     handle = get_serial_handle_by_port(&communication_task_contex,7);
     if (handle->registered && handle->init) {
-        nxp_serial_uart_hal_isr(handle);
+        COMMUNICATION_SERIAL_HAL_ISR(handle);
     }
-
+    trace_isr_exit(7);
+    run_time_stats_isr_exit(7,start);
 }
 /*电子秤任务通信中断处理*/
 void FLEXCOMM8_IRQHandler()
 {
+    uint32_t start;
     serial_handle_t *handle;
 
+    start = run_time_stats_isr_enter();
+    trace_isr_enter(8);
     handle = get_serial_handle_by_port(&communication_task_contex,8);
     if (handle->registered && handle->init) {
-        nxp_serial_uart_hal_isr(handle);
+        COMMUNICATION_SERIAL_HAL_ISR(handle);
     }
-
+    trace_isr_exit(8);
+    run_time_stats_isr_exit(8,start);
 }
 
 
@@ -1600,7 +2349,7 @@ static void communication_task_contex_init(communication_task_contex_t *contex)
 
         rc = serial_create(&contex->scale_task_contex[i].handle,contex->scale_task_contex[i].recv,SCALE_TASK_RX_BUFFER_SIZE,contex->scale_task_contex[i].send,SCALE_TASK_TX_BUFFER_SIZE);
         log_assert(rc == 0);
-        rc = serial_register_hal_driver(&contex->scale_task_contex[i].handle,&nxp_serial_uart_hal_driver);
+        rc = serial_register_hal_driver(&contex->scale_task_contex[i].handle,&COMMUNICATION_SERIAL_HAL_DRIVER);
         log_assert(rc == 0);
  
         rc = serial_open(&contex->scale_task_contex[i].handle,
@@ -1613,57 +2362,65 @@ static void communication_task_contex_init(communication_task_contex_t *contex)
         serial_flush(&contex->scale_task_contex[i].handle);
 
         /*创建电子秤消息队列*/
-        osMessageQDef(scale_task_msg_queue,1,uint32_t);
+        osMessageQStaticDef(scale_task_msg_queue,SCALE_TASK_MSG_Q_SIZE,uint32_t,contex->scale_task_contex[i].msg_q_buffer,&contex->scale_task_contex[i].msg_q_cb);
         contex->scale_task_contex[i].msg_q_id = osMessageCreate(osMessageQ(scale_task_msg_queue),0);
         log_assert(contex->scale_task_contex[i].msg_q_id);
         /*创建电子秤任务*/
-        osThreadDef(scale_task, scale_task, osPriorityNormal, 0, 256);
+        osThreadStaticDef(scale_task, scale_task, TASKS_SCALE_PRIORITY, 0, SCALE_TASK_STACK_SIZE, contex->scale_task_contex[i].stack, &contex->scale_task_contex[i].task_cb);
         contex->scale_task_contex[i].task_hdl = osThreadCreate(osThread(scale_task),&contex->scale_task_contex[i]);
         log_assert(contex->scale_task_contex[i].task_hdl);
     }  
     /*开锁回应消息队列*/
-    osMessageQDef(unlock_lock_rsp_msg_q,1,uint32_t);
+    osMessageQStaticDef(unlock_lock_rsp_msg_q,COMMUNICATION_TASK_RSP_MSG_Q_SIZE,uint32_t,unlock_lock_rsp_msg_q_buffer,&unlock_lock_rsp_msg_q_cb);
     contex->unlock_lock_rsp_msg_q_id = osMessageCreate(osMessageQ(unlock_lock_rsp_msg_q),0);
     log_assert(contex->unlock_lock_rsp_msg_q_id);
     /*关锁回应消息队列*/
-    osMessageQDef(lock_lock_rsp_msg_q,1,uint32_t);
+    osMessageQStaticDef(lock_lock_rsp_msg_q,COMMUNICATION_TASK_RSP_MSG_Q_SIZE,uint32_t,lock_lock_rsp_msg_q_buffer,&lock_lock_rsp_msg_q_cb);
     contex->lock_lock_rsp_msg_q_id = osMessageCreate(osMessageQ(lock_lock_rsp_msg_q),0);
     log_assert(contex->lock_lock_rsp_msg_q_id);
     /*锁状态回应消息队列*/
-    osMessageQDef(query_lock_status_rsp_msg_q,1,uint32_t);
+    osMessageQStaticDef(query_lock_status_rsp_msg_q,COMMUNICATION_TASK_RSP_MSG_Q_SIZE,uint32_t,query_lock_status_rsp_msg_q_buffer,&query_lock_status_rsp_msg_q_cb);
     contex->query_lock_status_rsp_msg_q_id = osMessageCreate(osMessageQ(query_lock_status_rsp_msg_q),0);
     log_assert(contex->query_lock_status_rsp_msg_q_id);
     /*门状态回应消息队列*/
-    osMessageQDef(query_door_status_rsp_msg_q,1,uint32_t);
+    osMessageQStaticDef(query_door_status_rsp_msg_q,COMMUNICATION_TASK_RSP_MSG_Q_SIZE,uint32_t,query_door_status_rsp_msg_q_buffer,&query_door_status_rsp_msg_q_cb);
     contex->query_door_status_rsp_msg_q_id = osMessageCreate(osMessageQ(query_door_status_rsp_msg_q),0);
     log_assert(contex->query_door_status_rsp_msg_q_id);
     /*温度回应消息队列*/
-    osMessageQDef(query_temperature_rsp_msg_q,1,uint32_t);
+    osMessageQStaticDef(query_temperature_rsp_msg_q,COMMUNICATION_TASK_RSP_MSG_Q_SIZE,uint32_t,query_temperature_rsp_msg_q_buffer,&query_temperature_rsp_msg_q_cb);
     contex->query_temperature_rsp_msg_q_id = osMessageCreate(osMessageQ(query_temperature_rsp_msg_q),0);
     log_assert(contex->query_temperature_rsp_msg_q_id);
+
+    osMessageQStaticDef(query_probe_rsp_msg_q,COMMUNICATION_TASK_RSP_MSG_Q_SIZE,uint32_t,query_probe_rsp_msg_q_buffer,&query_probe_rsp_msg_q_cb);
+    contex->query_probe_rsp_msg_q_id = osMessageCreate(osMessageQ(query_probe_rsp_msg_q),0);
+    log_assert(contex->query_probe_rsp_msg_q_id);
     /*查询温度设置消息队列*/
-    osMessageQDef(query_temperature_setting_rsp_msg_q,1,uint32_t);
+    osMessageQStaticDef(query_temperature_setting_rsp_msg_q,COMMUNICATION_TASK_RSP_MSG_Q_SIZE,uint32_t,query_temperature_setting_rsp_msg_q_buffer,&query_temperature_setting_rsp_msg_q_cb);
     contex->query_temperature_setting_rsp_msg_q_id = osMessageCreate(osMessageQ(query_temperature_setting_rsp_msg_q),0);
     log_assert(contex->query_temperature_setting_rsp_msg_q_id);
     /*设置温度等级消息队列*/
-    osMessageQDef(temperature_setting_rsp_msg_q,1,uint32_t);
+    osMessageQStaticDef(temperature_setting_rsp_msg_q,COMMUNICATION_TASK_RSP_MSG_Q_SIZE,uint32_t,temperature_setting_rsp_msg_q_buffer,&temperature_setting_rsp_msg_q_cb);
     contex->temperature_setting_rsp_msg_q_id = osMessageCreate(osMessageQ(temperature_setting_rsp_msg_q),0);
     log_assert(contex->temperature_setting_rsp_msg_q_id);
+    /*查询压缩机运行统计消息队列*/
+    osMessageQStaticDef(query_compressor_stats_rsp_msg_q,COMMUNICATION_TASK_RSP_MSG_Q_SIZE,uint32_t,query_compressor_stats_rsp_msg_q_buffer,&query_compressor_stats_rsp_msg_q_cb);
+    contex->query_compressor_stats_rsp_msg_q_id = osMessageCreate(osMessageQ(query_compressor_stats_rsp_msg_q),0);
+    log_assert(contex->query_compressor_stats_rsp_msg_q_id);
 
     /*净重回应消息队列*/
-    osMessageQDef(net_weight_rsp_msg_q,SCALE_CNT_MAX,uint32_t);
+    osMessageQStaticDef(net_weight_rsp_msg_q,COMMUNICATION_TASK_SCALE_RSP_MSG_Q_SIZE,uint32_t,net_weight_rsp_msg_q_buffer,&net_weight_rsp_msg_q_cb);
     contex->net_weight_rsp_msg_q_id = osMessageCreate(osMessageQ(net_weight_rsp_msg_q),0);
     log_assert(contex->net_weight_rsp_msg_q_id);
     /*去皮回应消息队列*/
-    osMessageQDef(remove_tare_rsp_msg_q,SCALE_CNT_MAX,uint32_t);
+    osMessageQStaticDef(remove_tare_rsp_msg_q,COMMUNICATION_TASK_SCALE_RSP_MSG_Q_SIZE,uint32_t,remove_tare_rsp_msg_q_buffer,&remove_tare_rsp_msg_q_cb);
     contex->remove_tare_rsp_msg_q_id = osMessageCreate(osMessageQ(remove_tare_rsp_msg_q),0);
     log_assert(contex->remove_tare_rsp_msg_q_id);
     /*0点校准回应消息队列*/
-    osMessageQDef(calibration_zero_rsp_msg_q,SCALE_CNT_MAX,uint32_t);
+    osMessageQStaticDef(calibration_zero_rsp_msg_q,COMMUNICATION_TASK_SCALE_RSP_MSG_Q_SIZE,uint32_t,calibration_zero_rsp_msg_q_buffer,&calibration_zero_rsp_msg_q_cb);
     contex->calibration_zero_rsp_msg_q_id = osMessageCreate(osMessageQ(calibration_zero_rsp_msg_q),0);
     log_assert(contex->calibration_zero_rsp_msg_q_id);
     /*增益校准回应消息队列*/
-    osMessageQDef(calibration_full_rsp_msg_q,SCALE_CNT_MAX,uint32_t);
+    osMessageQStaticDef(calibration_full_rsp_msg_q,COMMUNICATION_TASK_SCALE_RSP_MSG_Q_SIZE,uint32_t,calibration_full_rsp_msg_q_buffer,&calibration_full_rsp_msg_q_cb);
     contex->calibration_full_rsp_msg_q_id = osMessageCreate(osMessageQ(calibration_full_rsp_msg_q),0);
     log_assert(contex->calibration_full_rsp_msg_q_id);
     /*厂商ID和硬件版本*/
@@ -1675,6 +2432,65 @@ static void communication_task_contex_init(communication_task_contex_t *contex)
     contex->initialized = true;
 }
        
+/*
+* @brief 主机adu的截止时间
+* @param code 命令码
+* @return 截止时间 单位:us
+* @note 等待子系统回应的超时加上帧间隔和发送超时,超过后主机已经按超时处理
+*/
+static uint32_t communication_task_deadline_limit(uint8_t code)
+{
+    uint32_t timeout;
+
+    switch (code) {
+        case CODE_REMOVTE_TARE:
+            timeout = ADU_REMOVE_TARE_TIMEOUT;
+            break;
+        case CODE_CALIBRATION:
+            timeout = ADU_CALIBRATION_ZERO_TIMEOUT;
+            break;
+        case CODE_QUERY_NET_WEIGHT:
+            timeout = ADU_QUERY_WEIGHT_TIMEOUT;
+            break;
+        case CODE_QUERY_DOOR_STATUS:
+            timeout = ADU_QUERY_DOOR_STATUS_TIMEOUT;
+            break;
+        case CODE_UNLOCK_LOCK:
+            timeout = ADU_UNLOCK_RSP_TIMEOUT;
+            break;
+        case CODE_LOCK_LOCK:
+            timeout = ADU_LOCK_RSP_TIMEOUT;
+            break;
+        case CODE_QUERY_LOCK_STATUS:
+            timeout = ADU_QUERY_LOCK_STATUS_TIMEOUT;
+            break;
+        case CODE_QUERY_TEMPERATURE:
+            /*先后查询温度设置和温度值*/
+            timeout = ADU_QUERY_TEMPERATURE_SETTING_TIMEOUT + ADU_QUERY_TEMPERATURE_TIMEOUT;
+            break;
+        case CODE_QUERY_PROBE:
+            timeout = ADU_QUERY_PROBE_TIMEOUT;
+            break;
+        case CODE_QUERY_COMPRESSOR_STATS:
+            timeout = ADU_QUERY_COMPRESSOR_STATS_TIMEOUT;
+            break;
+        case CODE_QUERY_HISTORY:
+            /*可能从flash读取,按本地处理计算*/
+            timeout = 0;
+            break;
+        case CODE_SET_TEMPERATURE:
+            /*temperature_setting按此超时等待压缩机任务回应*/
+            timeout = ADU_QUERY_TEMPERATURE_SETTING_TIMEOUT;
+            break;
+        default:
+            /*本地处理的命令只算帧间隔和发送时间*/
+            timeout = 0;
+            break;
+    }
+
+    return (timeout + ADU_FRAME_TIMEOUT + ADU_SEND_TIMEOUT) * 1000;
+}
+
 /*
 * @brief 与主机通信任务
 * @param argument 任务参数
@@ -1687,12 +2503,14 @@ void communication_task(void const * argument)
     application_update_t update;
     
 
-    uint8_t adu_recv[ADU_SIZE_MAX];
-    uint8_t adu_send[ADU_SIZE_MAX];
+    /*只在通信任务中使用,放在静态区减小任务栈*/
+    static uint8_t adu_recv[ADU_SIZE_MAX];
+    static uint8_t adu_send[ADU_SIZE_MAX];
+    communication_latency_stamp_t stamp;
  
     rc = serial_create(&communication_serial_handle,comm_recv_buffer,COMMUNICATION_TASK_RX_BUFFER_SIZE,comm_send_buffer,COMMUNICATION_TASK_TX_BUFFER_SIZE);
     log_assert(rc == 0);
-    rc = serial_register_hal_driver(&communication_serial_handle,&nxp_serial_uart_hal_driver);
+    rc = serial_register_hal_driver(&communication_serial_handle,&COMMUNICATION_SERIAL_HAL_DRIVER);
     log_assert(rc == 0);
  
     rc = serial_open(&communication_serial_handle,
@@ -1717,19 +2535,38 @@ void communication_task(void const * argument)
         if (rc < 0) {
             /*清空接收缓存*/
             serial_flush(&communication_serial_handle);
+            host_byte_stamp_valid = false;
             continue;
         }
+        trace_user(TRACE_USER_HOST_ADU_RECV,rc);
+        /*取出本帧首字节和末字节时间,下一帧重新记录*/
+        taskENTER_CRITICAL();
+        stamp.first_byte = host_first_byte_time;
+        stamp.last_byte = host_last_byte_time;
+        host_byte_stamp_valid = false;
+        taskEXIT_CRITICAL();
+        stamp.dispatch = run_time_stats_get_counter();
         /*解析处理pdu*/
         rc = parse_adu(adu_recv,rc,adu_send,&update);
+        trace_user(TRACE_USER_HOST_ADU_PARSED,adu_recv[ADU_CODE_REGION_OFFSET]);
         if (rc < 0) {
             update.update = COMMUNICATION_TASK_APPLICATION_NORMAL;
             continue;
         }
+        stamp.reply = run_time_stats_get_counter();
         /*回应主机处理结果*/
         rc = send_adu(&communication_serial_handle,adu_send,rc,ADU_SEND_TIMEOUT);
+        trace_user(TRACE_USER_HOST_ADU_SENT,rc);
         if (rc < 0) {
             continue;
         }
+        stamp.send_complete = run_time_stats_get_counter();
+        communication_latency_record(adu_recv[ADU_CODE_REGION_OFFSET],&stamp);
+        if (deadline_check(&communication_task_deadline,
+                           stamp.send_complete - stamp.last_byte,
+                           communication_task_deadline_limit(adu_recv[ADU_CODE_REGION_OFFSET])) == true) {
+            log_warning("code:0x%02x miss deadline.\r\n",adu_recv[ADU_CODE_REGION_OFFSET]);
+        }
         if (update.update == COMMUNICATION_TASK_APPLICATION_UPDATE) {
             rc = process_update(&update,COMMUNICATION_TASK_UPDATE_TIMEOUT);
             update.update = COMMUNICATION_TASK_APPLICATION_NORMAL;
@@ -3,9 +3,11 @@
 #include "stdbool.h"
 #include "serial.h"
 #include "scale_task.h"
+#include "deadline.h"
 
 extern osThreadId   communication_task_hdl;
 extern osMessageQId communication_task_msg_q_id;
+extern deadline_t   communication_task_deadline;
 void communication_task(void const * argument);
 
 
@@ -17,10 +19,18 @@ void communication_task(void const * argument);
 
 
 #define  COMMUNICATION_TASK_RX_BUFFER_SIZE              2048
-#define  COMMUNICATION_TASK_TX_BUFFER_SIZE              64
+#define  COMMUNICATION_TASK_TX_BUFFER_SIZE              256
 
 #define  COMMUNICATION_TASK_COMMUNICATION_ADDR          1
 
+#define  COMMUNICATION_TASK_STACK_SIZE                  400 /*任务栈大小 单位:word*/
+#define  COMMUNICATION_TASK_MSG_Q_SIZE                  4   /*消息队列深度*/
+#define  COMMUNICATION_TASK_RSP_MSG_Q_SIZE              1   /*锁,门和温度回应消息队列深度*/
+#define  COMMUNICATION_TASK_SCALE_RSP_MSG_Q_SIZE        SCALE_CNT_MAX /*电子秤回应消息队列深度*/
+/*回应消息队列静态RAM占用 单位:byte*/
+#define  COMMUNICATION_TASK_RSP_MSG_Q_RAM_SIZE          (9 * TASKS_MSG_Q_RAM_SIZE(COMMUNICATION_TASK_RSP_MSG_Q_SIZE) + \
+                                                         4 * TASKS_MSG_Q_RAM_SIZE(COMMUNICATION_TASK_SCALE_RSP_MSG_Q_SIZE))
+
 
 
 /*电子秤数量和默认地址*/
@@ -65,6 +75,11 @@ typedef struct
     uint32_t flag;
     osMessageQId msg_q_id;
     osThreadId   task_hdl;
+    /*任务和消息队列的静态存储*/
+    uint32_t stack[SCALE_TASK_STACK_SIZE];
+    osStaticThreadDef_t task_cb;
+    uint8_t msg_q_buffer[SCALE_TASK_MSG_Q_SIZE * sizeof(uint32_t)];
+    osStaticMessageQDef_t msg_q_cb;
 }scale_task_contex_t;
 
 /*通信任务上下文*/
@@ -84,8 +99,10 @@ typedef struct
     osMessageQId lock_lock_rsp_msg_q_id;
     osMessageQId unlock_lock_rsp_msg_q_id;
     osMessageQId query_temperature_rsp_msg_q_id;
+    osMessageQId query_probe_rsp_msg_q_id;
     osMessageQId query_temperature_setting_rsp_msg_q_id;
     osMessageQId temperature_setting_rsp_msg_q_id;
+    osMessageQId query_compressor_stats_rsp_msg_q_id;
 }communication_task_contex_t;
     
 
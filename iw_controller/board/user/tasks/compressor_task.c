@@ -2,18 +2,27 @@
 #include "tasks_init.h"
 #include "board.h"
 #include "compressor_task.h"
+#include "history_task.h"
 #include "device_env.h"
 #include "stdlib.h"
 #include "stdio.h"
 #include "log.h"
 
-/*任务句柄*/
-osThreadId   compressor_task_hdl;
 /*消息句柄*/
 osMessageQId compressor_task_msg_q_id;
+/*消息池*/
+MSG_POOL_DEF(compressor_task_msg_pool,compressor_task_message_t,COMPRESSOR_TASK_MSG_POOL_SIZE);
 
-/*定时器句柄*/
-osTimerId    compressor_timer_id;
+static void compressor_task_init(active_object_t *ao);
+static void compressor_task_handler(active_object_t *ao,const void *event);
+/*压缩机活动对象*/
+ACTIVE_OBJECT_DEF(compressor_task_ao,compressor_task_init,compressor_task_handler,&compressor_task_msg_pool);
+
+/*定时器和到期事件*/
+static active_object_timer_t compressor_timer;
+static const compressor_task_message_t compressor_timer_timeout_msg = { .request.type = COMPRESSOR_TASK_MSG_TYPE_TIMER_TIMEOUT };
+static active_object_timer_t compressor_stats_timer;
+static const compressor_task_message_t compressor_stats_timeout_msg = { .request.type = COMPRESSOR_TASK_MSG_TYPE_STATS_TIMEOUT };
 
 
 
@@ -45,6 +54,7 @@ typedef struct
     float temperature_work;
 
     bool   temperature_err;
+    temperature_probe_set_t probe;/*所有探头温度,供除霜和负载判断*/
 }compressor_t;
 
 /*压缩机对象实体*/
@@ -53,130 +63,479 @@ static compressor_t compressor ={
 .setting = COMPRESSOR_TASK_TEMPERATURE_SETTING_DEFAULT,
 .temperature_stop = COMPRESSOR_TASK_TEMPERATURE_SETTING_DEFAULT - COMPRESSOR_TASK_TEMPERATURE_OFFSET,
 .temperature_work = COMPRESSOR_TASK_TEMPERATURE_SETTING_DEFAULT + COMPRESSOR_TASK_TEMPERATURE_OFFSET,
-.temperature_err = false
+.temperature_err = false,
+.probe.err_mask = (1U << TEMPERATURE_PROBE_CNT) - 1
 };
 
+/*运行统计*/
+typedef struct
+{
+    compressor_stats_t total;     /*累计值,定期保存*/
+    bool     on;                  /*压缩机正在运行*/
+    uint32_t on_tick;             /*本次开机的时刻*/
+    uint32_t account_tick;        /*上次计入运行时间的时刻*/
+    uint32_t account_ms;          /*不足1s的运行时间 单位:ms*/
+    uint16_t hour[COMPRESSOR_TASK_STATS_HOUR_CNT];/*每个完整小时的运行时间 单位:s*/
+    uint16_t hour_current;        /*当前小时的运行时间 单位:s*/
+    uint8_t  hour_index;          /*下一个完整小时的位置*/
+    uint8_t  hour_cnt;            /*已有的完整小时数量*/
+    uint8_t  minute;              /*当前小时已经过的分钟*/
+    uint8_t  save_hours;          /*距离上次保存的小时数*/
+    bool     dirty;               /*有未保存的变化*/
+}compressor_stats_contex_t;
+
+static compressor_stats_contex_t compressor_stats;
+
+#if COMPRESSOR_TASK_ADAPTIVE_ENABLE > 0
+/*自适应控制的箱体热模型,在线学习*/
+typedef struct
+{
+    float    slope;             /*当前阶段的温度变化速率 单位:C/min*/
+    float    cool_rate;         /*学习到的工作阶段平均降温速率 单位:C/min*/
+    float    warm_rate;         /*学习到的停机阶段平均升温速率 单位:C/min*/
+    float    stop_lag;          /*关机后温度继续下降的等效时间 单位:min*/
+    float    work_lag;          /*开机后温度继续上升的等效时间 单位:min*/
+    float    last_temperature;  /*上一次的温度*/
+    uint32_t last_tick;         /*上一次温度的时刻*/
+    float    switch_temperature;/*上一次启停时的温度*/
+    float    switch_slope;      /*上一次启停时的温度变化速率*/
+    uint32_t switch_tick;       /*上一次启停的时刻*/
+    float    extreme;           /*启停后的温度极值*/
+    bool     valid;             /*已经有温度*/
+    bool     tracking;          /*正在等待启停后的温度折返*/
+    bool     door_open;         /*门打开*/
+    bool     disturbed;         /*本阶段开过门或者非正常启停,不学习*/
+}compressor_adaptive_t;
+
+static compressor_adaptive_t adaptive = {
+.cool_rate = COMPRESSOR_TASK_ADAPTIVE_COOL_RATE_DEFAULT,
+.warm_rate = COMPRESSOR_TASK_ADAPTIVE_WARM_RATE_DEFAULT,
+.disturbed = true
+};
+#endif
 
 
 
-static void compressor_timer_init(void);
 
 static void compressor_timer_start(uint32_t timeout);
 static void compressor_timer_stop(void);
-static void compressor_timer_expired(void const *argument);
 
 static void compressor_pwr_turn_on();
 static void compressor_pwr_turn_off();
 
+static void compressor_stats_start(void);
+static void compressor_stats_stop(void);
+
 
 /*
-* @brief 压缩机定时器
-* @param 无
+* @brief 定时器启动
+* @param timeout 超时时间
 * @return 无
 * @note
 */
-static void compressor_timer_init(void)
+static void compressor_timer_start(uint32_t timeout)
 {
-    osTimerDef(compressor_timer,compressor_timer_expired);
-    compressor_timer_id=osTimerCreate(osTimer(compressor_timer),osTimerOnce,0);
-    log_assert(compressor_timer_id);
+    active_object_timer_start(&compressor_timer,timeout,0);  
 }
 
 /*
-* @brief 定时器启动
-* @param timeout 超时时间
+* @brief 工作时间定时器停止
+* @param 无
 * @return 无
 * @note
 */
-static void compressor_timer_start(uint32_t timeout)
+
+static void compressor_timer_stop(void)
 {
-    osTimerStart(compressor_timer_id,timeout);  
+    active_object_timer_stop(&compressor_timer);  
 }
 
 /*
-* @brief 工作时间定时器停止
+* @brief 打开压缩机
 * @param 无
 * @return 无
 * @note
 */
+static void compressor_pwr_turn_on(void)
+{
+    bsp_compressor_ctrl_pwr_on(); 
+    compressor_stats_start();
+}
 
-static void compressor_timer_stop(void)
+/*
+* @brief 关闭压缩机
+* @param 无
+* @return 无
+* @note
+*/
+static void compressor_pwr_turn_off()
 {
-    osTimerStop(compressor_timer_id);  
+    bsp_compressor_ctrl_pwr_off();  
+    compressor_stats_stop();
 }
 
 /*
-* @brief 定时器回调
-* @param argument 回调参数
+* @brief 把上次计入之后的运行时间计入统计
+* @param now 当前时刻 单位:tick
 * @return 无
 * @note
 */
-static void compressor_timer_expired(void const *argument)
+static void compressor_stats_account(uint32_t now)
 {
-    osStatus status;
-    static compressor_task_message_t msg;
-    /*发送消息*/
-    msg.request.type = COMPRESSOR_TASK_MSG_TYPE_TIMER_TIMEOUT;
-    status = osMessagePut(compressor_task_msg_q_id,(uint32_t)&msg,COMPRESSOR_TASK_PUT_MSG_TIMEOUT);
-    if (status !=osOK) {
-        log_error("compressor put timeout msg error:%d\r\n",status);
-    } 
+    uint32_t seconds;
+
+    if (compressor_stats.on == false) {
+        return;
+    }
+    compressor_stats.account_ms += (now - compressor_stats.account_tick) * portTICK_PERIOD_MS;
+    compressor_stats.account_tick = now;
+    seconds = compressor_stats.account_ms / 1000;
+    if (seconds == 0) {
+        return;
+    }
+    compressor_stats.account_ms -= seconds * 1000;
+    compressor_stats.total.run_time += seconds;
+    compressor_stats.hour_current += seconds;
+    compressor_stats.dirty = true;
 }
 
 /*
-* @brief 打开压缩机
+* @brief 压缩机开机时统计
+* @param 无
+* @return 无
+* @note 已经在运行时不重复计数
+*/
+static void compressor_stats_start(void)
+{
+    if (compressor_stats.on == true) {
+        return;
+    }
+    compressor_stats.on = true;
+    compressor_stats.on_tick = osKernelSysTick();
+    compressor_stats.account_tick = compressor_stats.on_tick;
+    compressor_stats.total.start_cnt ++;
+    compressor_stats.dirty = true;
+}
+
+/*
+* @brief 压缩机关机时统计
+* @param 无
+* @return 无
+* @note 更新最长连续运行时间
+*/
+static void compressor_stats_stop(void)
+{
+    uint32_t now,run;
+
+    if (compressor_stats.on == false) {
+        return;
+    }
+    now = osKernelSysTick();
+    compressor_stats_account(now);
+    compressor_stats.on = false;
+    run = (now - compressor_stats.on_tick) * portTICK_PERIOD_MS / 1000;
+    if (run > compressor_stats.total.run_max) {
+        compressor_stats.total.run_max = run;
+    }
+}
+
+/*
+* @brief 保存累计统计到环境变量
+* @param 无
+* @return 无
+* @note 只保存累计值,占空比窗口上电后重新统计
+*/
+static void compressor_stats_save(void)
+{
+    int rc;
+    char stats_str_buffer[64];
+
+    snprintf(stats_str_buffer,sizeof(stats_str_buffer),"%u,%u,%u,%u,%u",
+             (unsigned int)compressor_stats.total.run_time,
+             (unsigned int)compressor_stats.total.start_cnt,
+             (unsigned int)compressor_stats.total.run_max,
+             (unsigned int)compressor_stats.total.fault_cnt,
+             (unsigned int)compressor_stats.total.rest_cnt);
+    rc = device_env_set(COMPRESSOR_TASK_STATS_ENV_NAME,stats_str_buffer);
+    if (rc != 0) {
+        log_error("save compressor stats fail.\r\n");
+        return;
+    }
+    compressor_stats.dirty = false;
+    log_debug("compressor stats:%s saved.\r\n",stats_str_buffer);
+}
+
+/*
+* @brief 从环境变量读取累计统计
 * @param 无
 * @return 无
 * @note
 */
-static void compressor_pwr_turn_on(void)
+static void compressor_stats_load(void)
 {
-    bsp_compressor_ctrl_pwr_on(); 
+    char stats_str[64];
+    unsigned int value[5];
+
+    /*其他任务可能同时设置环境变量,复制出来再解析*/
+    if (device_env_get_copy(COMPRESSOR_TASK_STATS_ENV_NAME,stats_str,sizeof(stats_str)) < 0) {
+        log_info("compressor stats not exsit.start from 0.\r\n");
+        return;
+    }
+    if (sscanf(stats_str,"%u,%u,%u,%u,%u",&value[0],&value[1],&value[2],&value[3],&value[4]) != 5) {
+        log_error("compressor stats:%s invalid.start from 0.\r\n",stats_str);
+        return;
+    }
+    compressor_stats.total.run_time = value[0];
+    compressor_stats.total.start_cnt = value[1];
+    compressor_stats.total.run_max = value[2];
+    compressor_stats.total.fault_cnt = (uint16_t)value[3];
+    compressor_stats.total.rest_cnt = (uint16_t)value[4];
+    log_info("compressor stats run:%us start:%u max:%us.\r\n",value[0],value[1],value[2]);
 }
 
 /*
-* @brief 关闭压缩机
+* @brief 统计周期到期
 * @param 无
 * @return 无
+* @note 每小时滚动一次占空比窗口,并按间隔保存累计值
+*/
+static void compressor_stats_tick(void)
+{
+    compressor_stats_account(osKernelSysTick());
+    if (++ compressor_stats.minute < 60 * 60 * 1000 / COMPRESSOR_TASK_STATS_INTERVAL) {
+        return;
+    }
+    compressor_stats.minute = 0;
+    compressor_stats.hour[compressor_stats.hour_index] = compressor_stats.hour_current;
+    compressor_stats.hour_index = (compressor_stats.hour_index + 1) % COMPRESSOR_TASK_STATS_HOUR_CNT;
+    if (compressor_stats.hour_cnt < COMPRESSOR_TASK_STATS_HOUR_CNT) {
+        compressor_stats.hour_cnt ++;
+    }
+    compressor_stats.hour_current = 0;
+
+    if (++ compressor_stats.save_hours >= COMPRESSOR_TASK_STATS_SAVE_HOURS) {
+        compressor_stats.save_hours = 0;
+        if (compressor_stats.dirty == true) {
+            compressor_stats_save();
+        }
+    }
+}
+
+/*
+* @brief 获取当前的运行统计
+* @param stats 统计
+* @return 无
+* @note 占空比按完整小时计算,耗电按额定功率估算
+*/
+static void compressor_stats_get(compressor_stats_t *stats)
+{
+    uint32_t sum = 0;
+    uint8_t last;
+
+    compressor_stats_account(osKernelSysTick());
+    *stats = compressor_stats.total;
+    stats->energy = (uint32_t)((uint64_t)stats->run_time * COMPRESSOR_TASK_RATED_POWER / 3600);
+    stats->duty_hour = 0;
+    stats->duty_day = 0;
+    if (compressor_stats.hour_cnt > 0) {
+        last = (compressor_stats.hour_index + COMPRESSOR_TASK_STATS_HOUR_CNT - 1) % COMPRESSOR_TASK_STATS_HOUR_CNT;
+        stats->duty_hour = compressor_stats.hour[last] * 1000 / 3600;
+        for (uint8_t i = 0;i < compressor_stats.hour_cnt;i ++) {
+            sum += compressor_stats.hour[(last + COMPRESSOR_TASK_STATS_HOUR_CNT - i) % COMPRESSOR_TASK_STATS_HOUR_CNT];
+        }
+        stats->duty_day = sum * 1000 / (compressor_stats.hour_cnt * 3600UL);
+    }
+}
+
+#if COMPRESSOR_TASK_ADAPTIVE_ENABLE > 0
+/*
+* @brief 两个时刻之间的分钟数
+* @param start 开始时刻 单位:tick
+* @param end 结束时刻 单位:tick
+* @return 分钟数
 * @note
 */
-static void compressor_pwr_turn_off()
+static float compressor_adaptive_minutes(uint32_t start,uint32_t end)
 {
-    bsp_compressor_ctrl_pwr_off();  
+    return (float)((end - start) * portTICK_PERIOD_MS) / (60.0f * 1000.0f);
+}
+
+/*
+* @brief 学习一个模型参数
+* @param value 参数
+* @param sample 本次的观测值
+* @param min 最小值
+* @param max 最大值
+* @return 无
+* @note 指数滑动平均
+*/
+static void compressor_adaptive_learn(float *value,float sample,float min,float max)
+{
+    sample = sample < min ? min : sample > max ? max : sample;
+    *value += COMPRESSOR_TASK_ADAPTIVE_GAIN * (sample - *value);
+}
+
+/*
+* @brief 用新的温度更新模型
+* @param temperature 箱内温度
+* @return 无
+* @note 估计当前速率,并在启停后的温度折返时学习滞后时间
+*/
+static void compressor_adaptive_temperature(float temperature)
+{
+    uint32_t now;
+    float minutes,overshoot;
+
+    now = osKernelSysTick();
+    if (adaptive.valid == true) {
+        minutes = compressor_adaptive_minutes(adaptive.last_tick,now);
+        if (minutes > 0) {
+            adaptive.slope += COMPRESSOR_TASK_ADAPTIVE_SLOPE_GAIN * ((temperature - adaptive.last_temperature) / minutes - adaptive.slope);
+        }
+    }
+    adaptive.last_temperature = temperature;
+    adaptive.last_tick = now;
+    adaptive.valid = true;
+
+    if (adaptive.tracking == false) {
+        return;
+    }
+    if (compressor.status == COMPRESSOR_STATUS_WORK) {
+        /*开机后温度还会上升一段时间*/
+        if (temperature > adaptive.extreme) {
+            adaptive.extreme = temperature;
+        } else if (temperature <= adaptive.extreme - COMPRESSOR_TASK_ADAPTIVE_TURN_DELTA) {
+            adaptive.tracking = false;
+            overshoot = adaptive.extreme - adaptive.switch_temperature;
+            if (adaptive.disturbed == false && adaptive.switch_slope > 0) {
+                compressor_adaptive_learn(&adaptive.work_lag,overshoot / adaptive.switch_slope,0,COMPRESSOR_TASK_ADAPTIVE_LAG_MAX);
+                log_debug("adaptive work overshoot:%.2fC lag:%.2fmin.\r\n",overshoot,adaptive.work_lag);
+            }
+        }
+    } else {
+        /*关机后温度还会下降一段时间*/
+        if (temperature < adaptive.extreme) {
+            adaptive.extreme = temperature;
+        } else if (temperature >= adaptive.extreme + COMPRESSOR_TASK_ADAPTIVE_TURN_DELTA) {
+            adaptive.tracking = false;
+            overshoot = adaptive.switch_temperature - adaptive.extreme;
+            if (adaptive.disturbed == false && adaptive.switch_slope < 0) {
+                compressor_adaptive_learn(&adaptive.stop_lag,overshoot / -adaptive.switch_slope,0,COMPRESSOR_TASK_ADAPTIVE_LAG_MAX);
+                log_debug("adaptive stop overshoot:%.2fC lag:%.2fmin.\r\n",overshoot,adaptive.stop_lag);
+            }
+        }
+    }
+}
+
+/*
+* @brief 正常启停时更新模型
+* @param work true:开机 false:关机
+* @return 无
+* @note 学习刚结束阶段的平均速率,开始跟踪本次启停后的温度极值
+*/
+static void compressor_adaptive_switch(bool work)
+{
+    uint32_t now;
+    float minutes,rate;
+
+    now = osKernelSysTick();
+    minutes = compressor_adaptive_minutes(adaptive.switch_tick,now);
+    if (adaptive.disturbed == false && minutes >= 1.0f) {
+        rate = (adaptive.last_temperature - adaptive.switch_temperature) / minutes;
+        if (work == true) {
+            compressor_adaptive_learn(&adaptive.warm_rate,rate,0,COMPRESSOR_TASK_TEMPERATURE_OFFSET);
+        } else {
+            compressor_adaptive_learn(&adaptive.cool_rate,rate,-COMPRESSOR_TASK_TEMPERATURE_OFFSET,0);
+        }
+        log_debug("adaptive cool:%.3fC/min warm:%.3fC/min.\r\n",adaptive.cool_rate,adaptive.warm_rate);
+    }
+    adaptive.switch_temperature = adaptive.last_temperature;
+    adaptive.switch_slope = adaptive.slope;
+    adaptive.switch_tick = now;
+    adaptive.extreme = adaptive.last_temperature;
+    adaptive.tracking = true;
+    adaptive.disturbed = adaptive.door_open;
+    /*新阶段的速率从学习到的平均值开始*/
+    adaptive.slope = work == true ? adaptive.cool_rate : adaptive.warm_rate;
 }
 
 /*
-* @brief 压缩机任务
-* @param argument 任务参数
+* @brief 非正常启停或者开门,本阶段不学习
+* @param 无
 * @return 无
 * @note
 */
-void compressor_task(void const *argument)
+static void compressor_adaptive_disturb(void)
 {
-    int rc;
-    osEvent  os_event;
-    osStatus status;
-    int8_t setting;
-    char *temperature_str;
-    char temperature_str_buffer[7];
+    adaptive.tracking = false;
+    adaptive.disturbed = true;
+}
+#endif
+
+/*
+* @brief 工作中是否应该关机
+* @param 无
+* @return true 关机 false 继续工作
+* @note 自适应时按关机后的滞后提前关机,使最低温度落在关机温度;开门时不提前
+*/
+static bool compressor_stop_check(void)
+{
+#if COMPRESSOR_TASK_ADAPTIVE_ENABLE > 0
+    float predict;
+
+    if (adaptive.door_open == false && adaptive.slope < 0 && compressor.temperature_float < compressor.setting) {
+        predict = compressor.temperature_float + adaptive.slope * adaptive.stop_lag;
+        return predict <= compressor.temperature_stop ? true : false;
+    }
+#endif
+    return compressor.temperature_float <= compressor.temperature_stop ? true : false;
+}
+
+/*
+* @brief 就绪时是否应该开机
+* @param 无
+* @return true 开机 false 保持停机
+* @note 自适应时按开机后的滞后提前开机
+*/
+static bool compressor_work_check(void)
+{
+#if COMPRESSOR_TASK_ADAPTIVE_ENABLE > 0
+    float predict;
+
+    if (compressor.temperature_float >= compressor.setting && adaptive.slope > 0) {
+        predict = compressor.temperature_float + adaptive.slope * adaptive.work_lag;
+        return predict >= compressor.temperature_work ? true : false;
+    }
+#endif
+    return compressor.temperature_float >= compressor.temperature_work ? true : false;
+}
+
+/*
+* @brief 压缩机初始化
+* @param ao 活动对象
+* @return 无
+* @note 读取温度配置并开始上电等待
+*/
+static void compressor_task_init(active_object_t *ao)
+{
+    int32_t setting;
 
-    compressor_task_message_t req_msg,req_update_msg,rsp_setting_msg,rsp_query_setting_msg;
-    
     /*上电先关闭压缩机*/
     compressor_pwr_turn_off();
     /*定时器初始化*/
-    compressor_timer_init();
+    active_object_timer_init(&compressor_timer,ao,&compressor_timer_timeout_msg);
     /*消除编译警告*/
     compressor_timer_stop();
+    /*读取累计运行统计并开始周期统计*/
+    compressor_stats_load();
+    active_object_timer_init(&compressor_stats_timer,ao,&compressor_stats_timeout_msg);
+    active_object_timer_start(&compressor_stats_timer,COMPRESSOR_TASK_STATS_INTERVAL,COMPRESSOR_TASK_STATS_INTERVAL);
 
     /*读取温度配置*/
-    temperature_str = device_env_get(COMPRESSOR_TASK_TEMPERATURE_ENV_NAME);
-
-    if (temperature_str == NULL) {
+    if (device_env_get_int(COMPRESSOR_TASK_TEMPERATURE_ENV_NAME,&setting) != 0) {
         log_info("setting not exsit in flash.default:%d.\r\n",compressor.setting);
     } else {
-        setting = atoi(temperature_str);
-        if (setting >= COMPRESSOR_TASK_TEMPERATURE_SETTING_MIN || setting <= COMPRESSOR_TASK_TEMPERATURE_SETTING_MAX) {
+        if (setting >= COMPRESSOR_TASK_TEMPERATURE_SETTING_MIN && setting <= COMPRESSOR_TASK_TEMPERATURE_SETTING_MAX) {
             log_info("setting:%d exsit in flash.valid.\r\n",setting);
             compressor.setting = setting;
             compressor.temperature_work = setting + COMPRESSOR_TASK_TEMPERATURE_OFFSET > COMPRESSOR_TASK_TEMPERATURE_MAX ? COMPRESSOR_TASK_TEMPERATURE_MAX : setting + COMPRESSOR_TASK_TEMPERATURE_OFFSET;
@@ -186,6 +545,9 @@ void compressor_task(void const *argument)
         }
     }
 
+    /*记录上电时的设置温度*/
+    history_task_post(HISTORY_TYPE_SETTING,(uint8_t)compressor.setting,compressor.setting);
+
     /*打印温度参数*/
     log_info("压缩机工作温度范围:%.2fC~%.2fC.\r\n",compressor.temperature_stop,compressor.temperature_work);
 
@@ -193,190 +555,266 @@ void compressor_task(void const *argument)
 
     /*上电等待*/
     compressor_timer_start(COMPRESSOR_TASK_PWR_ON_WAIT_TIMEOUT);
-  
-    while (1) {
-    os_event = osMessageGet(compressor_task_msg_q_id,osWaitForever);
-    if (os_event.status == osEventMessage) {     
-        req_msg = *(compressor_task_message_t*)os_event.value.v;
-
-        /*压缩机定时器超时消息，压缩机根据超时事件更新工作状态*/
-        if (req_msg.request.type == COMPRESSOR_TASK_MSG_TYPE_TIMER_TIMEOUT){       
-            if (compressor.status == COMPRESSOR_STATUS_INIT) {
-                /*上电等待完毕*/
-                log_info("压缩机上电等待完毕.\r\n");
-                compressor.status = COMPRESSOR_STATUS_STOP_RDY; 
-                 /*发送消息更新压缩机工作状态*/
-                req_update_msg.request.type = COMPRESSOR_TASK_MSG_TYPE_UPDATE_STATUS;
-                status = osMessagePut(compressor_task_msg_q_id,(uint32_t)&req_update_msg,COMPRESSOR_TASK_PUT_MSG_TIMEOUT);
-                if (status != osOK) {
-                    log_error("compressor put update msg timeout error:%d\r\n",status);
-                }            
-            } else if (compressor.status == COMPRESSOR_STATUS_WORK) {
-                /*压缩机工作时间到达最大时长*/
-                log_info("压缩机到达最大工作时长.停机%d分钟.\r\n",COMPRESSOR_TASK_REST_TIMEOUT / (60 * 1000));
-                compressor.status = COMPRESSOR_STATUS_STOP_REST;
-                /*关闭压缩机*/
-                compressor_pwr_turn_off(); 
-                /*等待休息完毕*/
-                compressor_timer_start(COMPRESSOR_TASK_REST_TIMEOUT);                
-            } else if (compressor.status == COMPRESSOR_STATUS_STOP_REST || compressor.status == COMPRESSOR_STATUS_STOP_WAIT || compressor.status == COMPRESSOR_STATUS_STOP_FAULT) {
-                if (compressor.status == COMPRESSOR_STATUS_STOP_REST) {
-                    /*压缩机休息完毕*/
-                    log_info("压缩机休息完毕.\r\n");
-                    compressor.status = COMPRESSOR_STATUS_STOP_CONTINUE;
-                } else if (compressor.status == COMPRESSOR_STATUS_STOP_WAIT) {
-                    /*压缩机等待完毕*/
-                    log_info("压缩机等待完毕.\r\n");
-                    compressor.status = COMPRESSOR_STATUS_STOP_RDY;
-                } else {
-                    /*压缩机传感器错误等待完毕*/
-                    log_info("压缩机温度错误等待完毕.\r\n");
-                    compressor.status = COMPRESSOR_STATUS_STOP_CONTINUE;
-                }
-                /*发送消息更新压缩机工作状态*/
-                req_update_msg.request.type = COMPRESSOR_TASK_MSG_TYPE_UPDATE_STATUS;
-                status = osMessagePut(compressor_task_msg_q_id,(uint32_t)&req_update_msg,COMPRESSOR_TASK_PUT_MSG_TIMEOUT);
-                if (status != osOK) {
-                    log_error("compressor put update msg timeout error:%d\r\n",status);
-                }          
-            } else {
+}
+
+/*
+* @brief 压缩机事件处理
+* @param ao 活动对象
+* @param event 压缩机任务消息
+* @return 无
+* @note
+*/
+static void compressor_task_handler(active_object_t *ao,const void *event)
+{
+    int rc;
+    osStatus status;
+    int8_t setting;
+    const compressor_task_message_t *req_msg = (const compressor_task_message_t *)event;
+    compressor_task_message_t req_update_msg,rsp_setting_msg,rsp_query_setting_msg,rsp_query_stats_msg;
+    compressor_status_t status_prev = compressor.status;
+    int8_t setting_prev = compressor.setting;
+
+    /*压缩机定时器超时消息，压缩机根据超时事件更新工作状态*/
+    if (req_msg->request.type == COMPRESSOR_TASK_MSG_TYPE_TIMER_TIMEOUT){       
+        if (compressor.status == COMPRESSOR_STATUS_INIT) {
+            /*上电等待完毕*/
+            log_info("压缩机上电等待完毕.\r\n");
+            compressor.status = COMPRESSOR_STATUS_STOP_RDY; 
+             /*发送消息更新压缩机工作状态*/
+            req_update_msg.request.type = COMPRESSOR_TASK_MSG_TYPE_UPDATE_STATUS;
+            status = active_object_post(ao,&req_update_msg,COMPRESSOR_TASK_PUT_MSG_TIMEOUT);
+            if (status != osOK) {
+                log_error("compressor put update msg timeout error:%d\r\n",status);
+            }            
+        } else if (compressor.status == COMPRESSOR_STATUS_WORK) {
+            /*压缩机工作时间到达最大时长*/
+#if COMPRESSOR_TASK_ADAPTIVE_ENABLE > 0
+            compressor_adaptive_disturb();
+#endif
+            log_info("压缩机到达最大工作时长.停机%d分钟.\r\n",COMPRESSOR_TASK_REST_TIMEOUT / (60 * 1000));
+            compressor_stats.total.rest_cnt ++;
+            compressor_stats.dirty = true;
+            compressor.status = COMPRESSOR_STATUS_STOP_REST;
+            /*关闭压缩机*/
+            compressor_pwr_turn_off(); 
+            /*等待休息完毕*/
+            compressor_timer_start(COMPRESSOR_TASK_REST_TIMEOUT);                
+        } else if (compressor.status == COMPRESSOR_STATUS_STOP_REST || compressor.status == COMPRESSOR_STATUS_STOP_WAIT || compressor.status == COMPRESSOR_STATUS_STOP_FAULT) {
+            if (compressor.status == COMPRESSOR_STATUS_STOP_REST) {
                 /*压缩机休息完毕*/
-                log_warning("压缩机代码内部错误.忽略.\r\n");          
+                log_info("压缩机休息完毕.\r\n");
+                compressor.status = COMPRESSOR_STATUS_STOP_CONTINUE;
+            } else if (compressor.status == COMPRESSOR_STATUS_STOP_WAIT) {
+                /*压缩机等待完毕*/
+                log_info("压缩机等待完毕.\r\n");
+                compressor.status = COMPRESSOR_STATUS_STOP_RDY;
+            } else {
+                /*压缩机传感器错误等待完毕*/
+                log_info("压缩机温度错误等待完毕.\r\n");
+                compressor.status = COMPRESSOR_STATUS_STOP_CONTINUE;
             }
-        }
-      
-        /*温度更新消息处理*/
-        if (req_msg.request.type == COMPRESSOR_TASK_MSG_TYPE_TEMPERATURE_UPDATE){ 
-            /*去除温度错误标志*/
-            compressor.temperature_err = false;
-            /*缓存温度值*/
-            compressor.temperature_int = req_msg.request.temperature_int; 
-            compressor.temperature_float = req_msg.request.temperature_float; 
             /*发送消息更新压缩机工作状态*/
             req_update_msg.request.type = COMPRESSOR_TASK_MSG_TYPE_UPDATE_STATUS;
-            status = osMessagePut(compressor_task_msg_q_id,(uint32_t)&req_update_msg,COMPRESSOR_TASK_PUT_MSG_TIMEOUT);
+            status = active_object_post(ao,&req_update_msg,COMPRESSOR_TASK_PUT_MSG_TIMEOUT);
             if (status != osOK) {
                 log_error("compressor put update msg timeout error:%d\r\n",status);
-            }   
+            }          
+        } else {
+            /*压缩机休息完毕*/
+            log_warning("压缩机代码内部错误.忽略.\r\n");          
         }
+    }
+  
+    /*温度更新消息处理*/
+    if (req_msg->request.type == COMPRESSOR_TASK_MSG_TYPE_TEMPERATURE_UPDATE){ 
+        /*去除温度错误标志*/
+        compressor.temperature_err = false;
+        /*缓存温度值*/
+        compressor.temperature_int = req_msg->request.temperature_int; 
+        compressor.temperature_float = req_msg->request.temperature_float; 
+#if COMPRESSOR_TASK_ADAPTIVE_ENABLE > 0
+        compressor_adaptive_temperature(compressor.temperature_float);
+#endif
+        /*发送消息更新压缩机工作状态*/
+        req_update_msg.request.type = COMPRESSOR_TASK_MSG_TYPE_UPDATE_STATUS;
+        status = active_object_post(ao,&req_update_msg,COMPRESSOR_TASK_PUT_MSG_TIMEOUT);
+        if (status != osOK) {
+            log_error("compressor put update msg timeout error:%d\r\n",status);
+        }   
+    }
 
-        /*温度错误消息处理*/
-        if (req_msg.request.type == COMPRESSOR_TASK_MSG_TYPE_TEMPERATURE_ERR) { 
-            compressor.temperature_err = true;
-            if (compressor.status == COMPRESSOR_STATUS_WORK){
-                /*温度异常时，如果在工作,就变更为STOP_FAULT状态*/
-                compressor.status = COMPRESSOR_STATUS_STOP_FAULT;
-                /*关闭压缩机和工作定时器*/
-                compressor_pwr_turn_off(); 
-                /*同样打开等待定时器*/ 
-                compressor_timer_start(COMPRESSOR_TASK_WAIT_TIMEOUT);  
-                log_info("温度错误.关压缩机.等待%d分钟.\r\n",COMPRESSOR_TASK_WAIT_TIMEOUT / (60 * 1000));
-            } else {
-                log_info("温度错误.压缩机已经停机状态:%d.跳过.\r\n",compressor.status);
-            }
+    /*探头温度更新消息处理,启停仍然只由箱内温度决定*/
+    if (req_msg->request.type == COMPRESSOR_TASK_MSG_TYPE_PROBE_UPDATE){ 
+        compressor.probe = req_msg->request.probe;
+        log_debug("probe err mask:0x%x evaporator:%d(0.01C).\r\n",compressor.probe.err_mask,compressor.probe.value[TEMPERATURE_PROBE_EVAPORATOR]);
+    }
+
+    /*门状态消息处理,自适应控制时开门期间不提前关机也不学习*/
+    if (req_msg->request.type == COMPRESSOR_TASK_MSG_TYPE_DOOR_STATUS){ 
+#if COMPRESSOR_TASK_ADAPTIVE_ENABLE > 0
+        adaptive.door_open = req_msg->request.door_open ? true : false;
+        if (adaptive.door_open == true) {
+            compressor_adaptive_disturb();
         }
+        /*发送消息更新压缩机工作状态*/
+        req_update_msg.request.type = COMPRESSOR_TASK_MSG_TYPE_UPDATE_STATUS;
+        status = active_object_post(ao,&req_update_msg,COMPRESSOR_TASK_PUT_MSG_TIMEOUT);
+        if (status != osOK) {
+            log_error("compressor put update msg timeout error:%d\r\n",status);
+        }   
+#endif
+    }
+
+    /*温度错误消息处理*/
+    if (req_msg->request.type == COMPRESSOR_TASK_MSG_TYPE_TEMPERATURE_ERR) { 
+        compressor.temperature_err = true;
+        compressor_stats.total.fault_cnt ++;
+        compressor_stats.dirty = true;
+        if (compressor.status == COMPRESSOR_STATUS_WORK){
+            /*温度异常时，如果在工作,就变更为STOP_FAULT状态*/
+#if COMPRESSOR_TASK_ADAPTIVE_ENABLE > 0
+            compressor_adaptive_disturb();
+#endif
+            compressor.status = COMPRESSOR_STATUS_STOP_FAULT;
+            /*关闭压缩机和工作定时器*/
+            compressor_pwr_turn_off(); 
+            /*同样打开等待定时器*/ 
+            compressor_timer_start(COMPRESSOR_TASK_WAIT_TIMEOUT);  
+            log_info("温度错误.关压缩机.等待%d分钟.\r\n",COMPRESSOR_TASK_WAIT_TIMEOUT / (60 * 1000));
+        } else {
+            log_info("温度错误.压缩机已经停机状态:%d.跳过.\r\n",compressor.status);
+        }
+    }
  
-        /*压缩机根据温度更新工作状态*/
-        if (req_msg.request.type == COMPRESSOR_TASK_MSG_TYPE_UPDATE_STATUS){ 
-            /*只有在没有温度错误和等待上电完毕后才处理压缩机的启停*/
-            if (compressor.temperature_err == false && compressor.status != COMPRESSOR_STATUS_INIT) {
-                if (compressor.temperature_float <= compressor.temperature_stop && compressor.status == COMPRESSOR_STATUS_WORK){                  
-                    compressor.status = COMPRESSOR_STATUS_STOP_WAIT;
-                    /*关闭压缩机*/
-                    compressor_pwr_turn_off(); 
-                    /*打开等待定时器*/ 
-                    compressor_timer_start(COMPRESSOR_TASK_WAIT_TIMEOUT);
-                    log_info("温度:%.2f C低于关机温度:%.2f C.关机等待%d分钟.\r\n",compressor.temperature_float,compressor.temperature_stop,COMPRESSOR_TASK_WAIT_TIMEOUT / (60 * 1000));
-                } else if (compressor.temperature_float >= compressor.temperature_work && compressor.status == COMPRESSOR_STATUS_STOP_RDY ) {       
-                    /*温度大于开机温度，同时是正常关机状态时，开机*/
-                    compressor.status = COMPRESSOR_STATUS_WORK; 
-                    /*打开压缩机*/
-                    compressor_pwr_turn_on();
-                    /*打开工作定时器*/ 
-                    compressor_timer_start(COMPRESSOR_TASK_WORK_TIMEOUT); 
-                    log_info("温度:%.2f C高于开机温度:%.2f C.正常开压缩机.\r\n",compressor.temperature_float,compressor.temperature_work);
-                }else if (compressor.temperature_float > compressor.temperature_stop && compressor.status == COMPRESSOR_STATUS_STOP_CONTINUE) {
-                    /*超时关机或者异常关机状态后，温度大于关机温度，继续开机*/ 
-                    compressor.status = COMPRESSOR_STATUS_WORK; 
-                    /*打开压缩机*/
-                    compressor_pwr_turn_on();
-                    /*打开工作定时器*/ 
-                    compressor_timer_start(COMPRESSOR_TASK_WORK_TIMEOUT); 
-                    log_info("温度:%.2f C高于关机温度:%.2f C.继续开压缩机.\r\n",compressor.temperature_float,compressor.temperature_stop);
-                } else {
-                    log_info("压缩机状态:%d无需处理.\r\n",compressor.status);
-                }
+    /*压缩机根据温度更新工作状态*/
+    if (req_msg->request.type == COMPRESSOR_TASK_MSG_TYPE_UPDATE_STATUS){ 
+        /*只有在没有温度错误和等待上电完毕后才处理压缩机的启停*/
+        if (compressor.temperature_err == false && compressor.status != COMPRESSOR_STATUS_INIT) {
+            if (compressor.status == COMPRESSOR_STATUS_WORK && compressor_stop_check() == true){                  
+                compressor.status = COMPRESSOR_STATUS_STOP_WAIT;
+#if COMPRESSOR_TASK_ADAPTIVE_ENABLE > 0
+                compressor_adaptive_switch(false);
+#endif
+                /*关闭压缩机*/
+                compressor_pwr_turn_off(); 
+                /*打开等待定时器*/ 
+                compressor_timer_start(COMPRESSOR_TASK_WAIT_TIMEOUT);
+                log_info("温度:%.2f C低于关机温度:%.2f C.关机等待%d分钟.\r\n",compressor.temperature_float,compressor.temperature_stop,COMPRESSOR_TASK_WAIT_TIMEOUT / (60 * 1000));
+            } else if (compressor.status == COMPRESSOR_STATUS_STOP_RDY && compressor_work_check() == true) {       
+                /*温度大于开机温度，同时是正常关机状态时，开机*/
+                compressor.status = COMPRESSOR_STATUS_WORK; 
+#if COMPRESSOR_TASK_ADAPTIVE_ENABLE > 0
+                compressor_adaptive_switch(true);
+#endif
+                /*打开压缩机*/
+                compressor_pwr_turn_on();
+                /*打开工作定时器*/ 
+                compressor_timer_start(COMPRESSOR_TASK_WORK_TIMEOUT); 
+                log_info("温度:%.2f C高于开机温度:%.2f C.正常开压缩机.\r\n",compressor.temperature_float,compressor.temperature_work);
+            }else if (compressor.temperature_float > compressor.temperature_stop && compressor.status == COMPRESSOR_STATUS_STOP_CONTINUE) {
+                /*超时关机或者异常关机状态后，温度大于关机温度，继续开机*/ 
+                compressor.status = COMPRESSOR_STATUS_WORK; 
+#if COMPRESSOR_TASK_ADAPTIVE_ENABLE > 0
+                compressor_adaptive_switch(true);
+                compressor_adaptive_disturb();
+#endif
+                /*打开压缩机*/
+                compressor_pwr_turn_on();
+                /*打开工作定时器*/ 
+                compressor_timer_start(COMPRESSOR_TASK_WORK_TIMEOUT); 
+                log_info("温度:%.2f C高于关机温度:%.2f C.继续开压缩机.\r\n",compressor.temperature_float,compressor.temperature_stop);
             } else {
-                log_info("压缩机正在上电等待或者温度错误.跳过.\r\n");
+                log_info("压缩机状态:%d无需处理.\r\n",compressor.status);
             }
+        } else {
+            log_info("压缩机正在上电等待或者温度错误.跳过.\r\n");
         }
-        /*查询压缩机工作温度配置消息*/
-        if (req_msg.request.type == COMPRESSOR_TASK_MSG_TYPE_QUERY_TEMPERATURE_SETTING){ 
-            /*发送消息给通信任务*/
-            rsp_query_setting_msg.response.type = COMPRESSOR_TASK_MSG_TYPE_RSP_QUERY_TEMPERATURE_SETTING;   
-            rsp_query_setting_msg.response.temperature_setting = compressor.setting ;  
-            status = osMessagePut(req_msg.request.rsp_message_queue_id,(uint32_t)&rsp_query_setting_msg,COMPRESSOR_TASK_PUT_MSG_TIMEOUT);
-            if (status != osOK) {
-                log_error("compressor put rsp query setting msg timeout error:%d\r\n",status);
-            } 
-        }
+    }
+    /*查询压缩机工作温度配置消息*/
+    if (req_msg->request.type == COMPRESSOR_TASK_MSG_TYPE_QUERY_TEMPERATURE_SETTING){ 
+        /*发送消息给通信任务*/
+        rsp_query_setting_msg.response.type = COMPRESSOR_TASK_MSG_TYPE_RSP_QUERY_TEMPERATURE_SETTING;   
+        rsp_query_setting_msg.response.temperature_setting = compressor.setting ;  
+        status = msg_pool_send(&compressor_task_msg_pool,req_msg->request.rsp_message_queue_id,&rsp_query_setting_msg,COMPRESSOR_TASK_PUT_MSG_TIMEOUT);
+        if (status != osOK) {
+            log_error("compressor put rsp query setting msg timeout error:%d\r\n",status);
+        } 
+    }
 
-        /*配置压缩机工作温度区间消息*/
-        if (req_msg.request.type == COMPRESSOR_TASK_MSG_TYPE_TEMPERATURE_SETTING){ 
-            setting = req_msg.request.temperature_setting;
-            if (setting < COMPRESSOR_TASK_TEMPERATURE_SETTING_MIN ||\
-                setting > COMPRESSOR_TASK_TEMPERATURE_SETTING_MAX) {
-                rsp_setting_msg.response.result = COMPRESSOR_TASK_FAIL;
-                log_error("温度设置值:%d ± %d C无效.min:%d C max:%d C.\r\n.",
-                            setting,
-                            COMPRESSOR_TASK_TEMPERATURE_OFFSET,
-                            COMPRESSOR_TASK_TEMPERATURE_SETTING_MIN,
-                            COMPRESSOR_TASK_TEMPERATURE_SETTING_MAX);
-             } else {              
-                rsp_setting_msg.response.result = COMPRESSOR_TASK_SUCCESS;
-                if (compressor.setting != setting) {
-                    /*复制当前温度区间到缓存*/
-                    compressor.temperature_work = setting + COMPRESSOR_TASK_TEMPERATURE_OFFSET > COMPRESSOR_TASK_TEMPERATURE_MAX ? COMPRESSOR_TASK_TEMPERATURE_MAX : setting + COMPRESSOR_TASK_TEMPERATURE_OFFSET;;
-                    compressor.temperature_stop = setting - COMPRESSOR_TASK_TEMPERATURE_OFFSET < COMPRESSOR_TASK_TEMPERATURE_MIN ? COMPRESSOR_TASK_TEMPERATURE_MIN : setting - COMPRESSOR_TASK_TEMPERATURE_OFFSET; 
-                    compressor.setting = setting;
-                    snprintf(temperature_str_buffer,7,"%d",setting);
-                    rc = device_env_set(COMPRESSOR_TASK_TEMPERATURE_ENV_NAME,temperature_str_buffer);
-                    if (rc != 0) {
-                        rsp_setting_msg.response.result = COMPRESSOR_TASK_FAIL;
-                        log_error("save temperature setting fail.\r\n");
-                    } else {                                
-                        log_debug("温度设置值:%dC成功.区间%.2fC~%.2fC.\r\n",setting,compressor.temperature_stop,compressor.temperature_work);
-                        /*发送消息更新压缩机工作状态*/
-                        req_update_msg.request.type = COMPRESSOR_TASK_MSG_TYPE_UPDATE_STATUS;
-                        status = osMessagePut(compressor_task_msg_q_id,(uint32_t)&req_update_msg,COMPRESSOR_TASK_PUT_MSG_TIMEOUT);
-                        if (status != osOK) {
-                            log_error("compressor put update msg timeout error:%d\r\n",status);
-                        }                     
-                    }
-                } else {
-                    log_debug("温度设置值与当前一致.跳过.\r\n");
+    /*配置压缩机工作温度区间消息*/
+    if (req_msg->request.type == COMPRESSOR_TASK_MSG_TYPE_TEMPERATURE_SETTING){ 
+        setting = req_msg->request.temperature_setting;
+        if (setting < COMPRESSOR_TASK_TEMPERATURE_SETTING_MIN ||\
+            setting > COMPRESSOR_TASK_TEMPERATURE_SETTING_MAX) {
+            rsp_setting_msg.response.result = COMPRESSOR_TASK_FAIL;
+            log_error("温度设置值:%d ± %d C无效.min:%d C max:%d C.\r\n.",
+                        setting,
+                        COMPRESSOR_TASK_TEMPERATURE_OFFSET,
+                        COMPRESSOR_TASK_TEMPERATURE_SETTING_MIN,
+                        COMPRESSOR_TASK_TEMPERATURE_SETTING_MAX);
+         } else {              
+            rsp_setting_msg.response.result = COMPRESSOR_TASK_SUCCESS;
+            if (compressor.setting != setting) {
+                /*复制当前温度区间到缓存*/
+                compressor.temperature_work = setting + COMPRESSOR_TASK_TEMPERATURE_OFFSET > COMPRESSOR_TASK_TEMPERATURE_MAX ? COMPRESSOR_TASK_TEMPERATURE_MAX : setting + COMPRESSOR_TASK_TEMPERATURE_OFFSET;;
+                compressor.temperature_stop = setting - COMPRESSOR_TASK_TEMPERATURE_OFFSET < COMPRESSOR_TASK_TEMPERATURE_MIN ? COMPRESSOR_TASK_TEMPERATURE_MIN : setting - COMPRESSOR_TASK_TEMPERATURE_OFFSET; 
+                compressor.setting = setting;
+                rc = device_env_set_int(COMPRESSOR_TASK_TEMPERATURE_ENV_NAME,setting);
+                if (rc != 0) {
+                    rsp_setting_msg.response.result = COMPRESSOR_TASK_FAIL;
+                    log_error("save temperature setting fail.\r\n");
+                } else {                                
+                    log_debug("温度设置值:%dC成功.区间%.2fC~%.2fC.\r\n",setting,compressor.temperature_stop,compressor.temperature_work);
+                    /*发送消息更新压缩机工作状态*/
+                    req_update_msg.request.type = COMPRESSOR_TASK_MSG_TYPE_UPDATE_STATUS;
+                    status = active_object_post(ao,&req_update_msg,COMPRESSOR_TASK_PUT_MSG_TIMEOUT);
+                    if (status != osOK) {
+                        log_error("compressor put update msg timeout error:%d\r\n",status);
+                    }                     
                 }
+            } else {
+                log_debug("温度设置值与当前一致.跳过.\r\n");
             }
-            /*发送消息给通信任务*/
-            rsp_setting_msg.response.type = COMPRESSOR_TASK_MSG_TYPE_RSP_TEMPERATURE_SETTING;     
-            status = osMessagePut(req_msg.request.rsp_message_queue_id,(uint32_t)&rsp_setting_msg,COMPRESSOR_TASK_PUT_MSG_TIMEOUT);
-            if (status != osOK) {
-                log_error("compressor put rsp_setting msg timeout error:%d\r\n",status);
-            }                                    
-        }                         
-        /*压缩机调试开机消息*/
-        if (req_msg.request.type == COMPRESSOR_TASK_MSG_TYPE_DEBUG_PWR_ON){
-            /*打开压缩机*/
-            compressor_pwr_turn_on();            
         }
-        /*压缩机调试关机机消息*/
-        if (req_msg.request.type == COMPRESSOR_TASK_MSG_TYPE_DEBUG_PWR_OFF){
-            /*关闭压缩机*/
-            compressor_pwr_turn_off();            
-        }
-
+        /*发送消息给通信任务*/
+        rsp_setting_msg.response.type = COMPRESSOR_TASK_MSG_TYPE_RSP_TEMPERATURE_SETTING;     
+        status = msg_pool_send(&compressor_task_msg_pool,req_msg->request.rsp_message_queue_id,&rsp_setting_msg,COMPRESSOR_TASK_PUT_MSG_TIMEOUT);
+        if (status != osOK) {
+            log_error("compressor put rsp_setting msg timeout error:%d\r\n",status);
+        }                                    
+    }                         
+    /*运行统计周期消息*/
+    if (req_msg->request.type == COMPRESSOR_TASK_MSG_TYPE_STATS_TIMEOUT){
+        compressor_stats_tick();
     }
+
+    /*查询运行统计消息*/
+    if (req_msg->request.type == COMPRESSOR_TASK_MSG_TYPE_QUERY_STATS){ 
+        /*发送消息给通信任务*/
+        rsp_query_stats_msg.response.type = COMPRESSOR_TASK_MSG_TYPE_RSP_QUERY_STATS;   
+        compressor_stats_get(&rsp_query_stats_msg.response.stats);
+        status = msg_pool_send(&compressor_task_msg_pool,req_msg->request.rsp_message_queue_id,&rsp_query_stats_msg,COMPRESSOR_TASK_PUT_MSG_TIMEOUT);
+        if (status != osOK) {
+            log_error("compressor put rsp query stats msg timeout error:%d\r\n",status);
+        } 
     }
- }
 
+    /*压缩机调试开机消息*/
+    if (req_msg->request.type == COMPRESSOR_TASK_MSG_TYPE_DEBUG_PWR_ON){
+        /*打开压缩机*/
+        compressor_pwr_turn_on();            
+    }
+    /*压缩机调试关机机消息*/
+    if (req_msg->request.type == COMPRESSOR_TASK_MSG_TYPE_DEBUG_PWR_OFF){
+        /*关闭压缩机*/
+        compressor_pwr_turn_off();            
+    }
 
+    /*状态和设置温度变化写入历史记录*/
+    if (compressor.status != status_prev) {
+        history_task_post(HISTORY_TYPE_COMPRESSOR,compressor.status,status_prev);
+    }
+    if (compressor.setting != setting_prev) {
+        history_task_post(HISTORY_TYPE_SETTING,(uint8_t)compressor.setting,setting_prev);
+    }
+}
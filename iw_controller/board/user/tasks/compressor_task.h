@@ -1,6 +1,9 @@
 #ifndef  __COMPRESSOR_TASK_H__
 #define  __COMPRESSOR_TASK_H__
 #include "stdint.h"
+#include "msg_pool.h"
+#include "active_object.h"
+#include "temperature_task.h"
 
 
 #ifdef  __cplusplus
@@ -14,11 +17,13 @@
 
 COMPRESSOR_TASK_BEGIN
 
-extern osThreadId   compressor_task_hdl;
-extern osMessageQId compressor_task_msg_q_id;
+extern osMessageQId    compressor_task_msg_q_id;
+extern msg_pool_t      compressor_task_msg_pool;
+extern active_object_t compressor_task_ao;
 
-void compressor_task(void const *argument);
 
+#define  COMPRESSOR_TASK_MSG_Q_SIZE                   7             /*消息队列深度*/
+#define  COMPRESSOR_TASK_MSG_POOL_SIZE                (COMPRESSOR_TASK_MSG_Q_SIZE + 4) /*消息池容量:请求+正在处理的事件+3个回应队列*/
 
 #define  COMPRESSOR_TASK_WORK_TIMEOUT                 (120*60*1000) /*连续工作时间单位:ms*/
 #define  COMPRESSOR_TASK_REST_TIMEOUT                 (5*60*1000)   /*连续工作时间后的休息时间单位:ms*/
@@ -41,6 +46,24 @@ void compressor_task(void const *argument);
 
 #define  COMPRESSOR_TASK_TEMPERATURE_ENV_NAME          "temperature"
 
+#define  COMPRESSOR_TASK_STATS_ENV_NAME                "compressor_stats"
+#define  COMPRESSOR_TASK_STATS_INTERVAL                (60 * 1000)  /*运行时间统计周期 单位:ms*/
+#define  COMPRESSOR_TASK_STATS_HOUR_CNT                24           /*按小时统计占空比的窗口*/
+#define  COMPRESSOR_TASK_STATS_SAVE_HOURS              1            /*每隔多少小时保存一次统计 单位:h*/
+#define  COMPRESSOR_TASK_RATED_POWER                   80           /*压缩机额定功率,用于估算耗电 单位:W*/
+
+/********************    自适应控制配置开始    ******************************/
+#ifndef  COMPRESSOR_TASK_ADAPTIVE_ENABLE /*tools/compressor_sim.py在编译选项中分别定义为0和1*/
+#define  COMPRESSOR_TASK_ADAPTIVE_ENABLE               0   /*1:根据学习到的降温/升温模型提前启停 0:固定回差*/
+#endif
+#define  COMPRESSOR_TASK_ADAPTIVE_GAIN                 0.25f /*模型参数每次学习的权重*/
+#define  COMPRESSOR_TASK_ADAPTIVE_SLOPE_GAIN           0.5f  /*温度变化速率的滤波权重*/
+#define  COMPRESSOR_TASK_ADAPTIVE_LAG_MAX              10.0f /*切换后温度继续变化的最长时间 单位:min*/
+#define  COMPRESSOR_TASK_ADAPTIVE_TURN_DELTA           0.1f  /*离开极值多少认为温度已经折返 单位:C*/
+#define  COMPRESSOR_TASK_ADAPTIVE_COOL_RATE_DEFAULT    (-0.2f) /*初始的工作降温速率 单位:C/min*/
+#define  COMPRESSOR_TASK_ADAPTIVE_WARM_RATE_DEFAULT    0.05f /*初始的停机升温速率 单位:C/min*/
+/********************    自适应控制配置结束    ******************************/
+
 enum
 {
   COMPRESSOR_TASK_MSG_TYPE_TEMPERATURE_UPDATE,
@@ -55,9 +78,27 @@ enum
   COMPRESSOR_TASK_MSG_TYPE_QUERY_TEMPERATURE_SETTING,
   COMPRESSOR_TASK_MSG_TYPE_RSP_QUERY_TEMPERATURE_SETTING,
     COMPRESSOR_TASK_MSG_TYPE_DEBUG_PWR_ON,
-    COMPRESSOR_TASK_MSG_TYPE_DEBUG_PWR_OFF
+    COMPRESSOR_TASK_MSG_TYPE_DEBUG_PWR_OFF,
+  COMPRESSOR_TASK_MSG_TYPE_PROBE_UPDATE,
+  COMPRESSOR_TASK_MSG_TYPE_DOOR_STATUS,
+  COMPRESSOR_TASK_MSG_TYPE_STATS_TIMEOUT,
+  COMPRESSOR_TASK_MSG_TYPE_QUERY_STATS,
+  COMPRESSOR_TASK_MSG_TYPE_RSP_QUERY_STATS
 };
 
+/*压缩机运行统计*/
+typedef struct
+{
+    uint32_t run_time;  /*累计运行时间 单位:s*/
+    uint32_t start_cnt; /*累计开机次数*/
+    uint32_t run_max;   /*最长连续运行时间 单位:s*/
+    uint32_t energy;    /*按额定功率估算的累计耗电 单位:Wh*/
+    uint16_t fault_cnt; /*温度错误次数*/
+    uint16_t rest_cnt;  /*到达最大工作时长后休息的次数*/
+    uint16_t duty_hour; /*最近1个完整小时的占空比 单位:0.1%*/
+    uint16_t duty_day;  /*最近24个完整小时的占空比,不足24小时按已有小时计算 单位:0.1%*/
+}compressor_stats_t;
+
 typedef struct
 {
     union 
@@ -68,6 +109,8 @@ typedef struct
         int8_t temperature_setting;/*设置的温度值*/
         int16_t temperature_int;/*整数温度值*/
         float temperature_float;/*浮点温度*/
+        temperature_probe_set_t probe;/*所有探头温度*/
+        uint8_t door_open;/*1:门打开 0:门关闭*/
         osMessageQId rsp_message_queue_id;/*回应的消息队列id*/
     }request;
     struct
@@ -75,6 +118,7 @@ typedef struct
         uint8_t type;/*回应的消息类型*/
         uint8_t result;/*回应的结果*/
         int8_t temperature_setting;/*回应设置的温度值*/
+        compressor_stats_t stats;/*回应的运行统计*/
     }response;
     };
 }compressor_task_message_t;/*压缩机任务消息体*/
@@ -1,31 +1,62 @@
 #include "board.h"
 #include "cmsis_os.h"
 #include "cpu_utils.h"
+#include "run_time_stats.h"
+#include "trace.h"
+#include "communication_latency.h"
+#include "deadline.h"
 #include "debug_task.h"
 #include "lock_task.h"
+#include "active_object.h"
 #include "tasks_init.h"
 #include "device_env.h"
+#include "eeprom_if.h"
 #include "log.h"
 
-osThreadId   debug_task_hdl;
+osMessageQId debug_task_msg_q_id;
+/*调试任务消息池*/
+MSG_POOL_DEF(debug_task_msg_pool,debug_task_message_t,DEBUG_TASK_MSG_POOL_SIZE);
+
+static void debug_task_init(active_object_t *ao);
+static void debug_task_handler(active_object_t *ao,const void *event);
+/*调试活动对象*/
+ACTIVE_OBJECT_DEF(debug_task_ao,debug_task_init,debug_task_handler,&debug_task_msg_pool);
+
+/*定时器和事件*/
+static active_object_timer_t debug_poll_timer;
+static const debug_task_message_t debug_poll_msg = { .type = DEBUG_TASK_MSG_TYPE_POLL };
 
 /*
-* @brief 调试任务
-* @param argument 任务参数
-* @param
+* @brief 调试初始化
+* @param ao 活动对象
 * @return 无
 * @note
 */
-void debug_task(void const * argument)
+static void debug_task_init(active_object_t *ao)
+{
+    active_object_timer_init(&debug_poll_timer,ao,&debug_poll_msg);
+    active_object_timer_start(&debug_poll_timer,DEBUG_TASK_INTERVAL,DEBUG_TASK_INTERVAL);
+}
+
+/*
+* @brief 调试事件处理
+* @param ao 活动对象
+* @param event 调试任务消息
+* @return 无
+* @note 调试线程只承载这一个活动对象,命令处理(如trace dump)允许阻塞
+*/
+static void debug_task_handler(active_object_t *ao,const void *event)
 {
     osStatus   status;
     char cmd[20];
     uint8_t level;
     uint8_t read_cnt;
     lock_task_message_t lock_msg;
+    const debug_task_message_t *msg = (const debug_task_message_t *)event;
 
-    while (1) {
-        osDelay(DEBUG_TASK_INTERVAL); 
+    if (msg->type == DEBUG_TASK_MSG_TYPE_POLL) {
+        /*更新任务cpu占用统计窗口*/
+        run_time_stats_poll();
    
         read_cnt = log_read(cmd,19);
         cmd[read_cnt] = 0;
@@ -39,10 +70,55 @@ void debug_task(void const * argument)
         if (strncmp(cmd,"cpu",strlen("cpu")) == 0) {
            log_info("cpu:%d%%.",osGetCPUUsage());
         }
+        /*设置任务cpu占用统计窗口*/
+        if (strncmp(cmd,"stats window ",strlen("stats window ")) == 0) {
+            if (run_time_stats_set_window(atoi(cmd + strlen("stats window "))) == 0) {
+                log_info("stats window:%dms ok.\r\n",run_time_stats_get_window());
+            }
+        /*查询任务cpu占用率*/
+        } else if (strncmp(cmd,"stats",strlen("stats")) == 0) {
+            run_time_stats_dump();
+        }
+        /*事件跟踪*/
+        if (strncmp(cmd,"trace start",strlen("trace start")) == 0) {
+            trace_enable(true);
+        } else if (strncmp(cmd,"trace stop",strlen("trace stop")) == 0) {
+            trace_enable(false);
+        } else if (strncmp(cmd,"trace clear",strlen("trace clear")) == 0) {
+            trace_clear();
+        } else if (strncmp(cmd,"trace dump",strlen("trace dump")) == 0) {
+            trace_dump();
+        }
+        /*消息池使用情况*/
+        if (strncmp(cmd,"pool",strlen("pool")) == 0) {
+            msg_pool_dump();
+        }
+        /*活动对象统计*/
+        if (strncmp(cmd,"ao",strlen("ao")) == 0) {
+            active_object_dump();
+        }
+        /*主机通信延时直方图*/
+        if (strncmp(cmd,"latency reset",strlen("latency reset")) == 0) {
+            communication_latency_reset();
+        } else if (strncmp(cmd,"latency",strlen("latency")) == 0) {
+            communication_latency_dump();
+        }
+        /*截止时间统计*/
+        if (strncmp(cmd,"deadline reset",strlen("deadline reset")) == 0) {
+            deadline_reset();
+        } else if (strncmp(cmd,"deadline",strlen("deadline")) == 0) {
+            deadline_dump();
+        }
+        /*EEPROM编程最长阻塞时间*/
+        if (strncmp(cmd,"eeprom reset",strlen("eeprom reset")) == 0) {
+            eeprom_if_block_time_max(true);
+        } else if (strncmp(cmd,"eeprom",strlen("eeprom")) == 0) {
+            log_info("eeprom block max:%d us.\r\n",eeprom_if_block_time_max(false));
+        }
         /*开锁*/
         if (strncmp(cmd,"unlock",strlen("unlock")) == 0) {
             lock_msg.request.type = LOCK_TASK_MSG_TYPE_DEBUG_UNLOCK_LOCK;
-            status = osMessagePut(lock_task_msg_q_id,(uint32_t)&lock_msg,0);
+            status = active_object_post(&lock_task_ao,&lock_msg,0);
             if (status != osOK) {
                 log_error("debug put unlock msg err:%d.\r\n",status);
             }
@@ -50,7 +126,7 @@ void debug_task(void const * argument)
         /*关锁*/
         if (strncmp(cmd,"lock",strlen("lock")) == 0) {
             lock_msg.request.type = LOCK_TASK_MSG_TYPE_DEBUG_LOCK_LOCK;
-            status = osMessagePut(lock_task_msg_q_id,(uint32_t)&lock_msg,0);
+            status = active_object_post(&lock_task_ao,&lock_msg,0);
             if (status != osOK) {
                 log_error("debug put lock msg err:%d.\r\n",status);
             }
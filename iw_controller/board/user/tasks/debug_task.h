@@ -1,14 +1,27 @@
 #ifndef  __DEBUG_TASK_H__
 #define  __DEBUG_TASK_H__
+#include "msg_pool.h"
+#include "active_object.h"
 
 
-extern osThreadId   debug_task_hdl;
-void debug_task(void const * argument);
+extern osMessageQId    debug_task_msg_q_id;
+extern msg_pool_t      debug_task_msg_pool;
+extern active_object_t debug_task_ao;
 
 
 #define  DEBUG_TASK_INTERVAL                  200
+#define  DEBUG_TASK_MSG_Q_SIZE                2
+#define  DEBUG_TASK_MSG_POOL_SIZE             (DEBUG_TASK_MSG_Q_SIZE + 1) /*消息池容量:队列+正在处理的事件*/
 
+enum
+{
+    DEBUG_TASK_MSG_TYPE_POLL
+};
 
+typedef struct
+{
+    uint8_t type;
+}debug_task_message_t;/*调试任务消息体*/
 
 
 
@@ -24,4 +37,6 @@ void debug_task(void const * argument);
 
 
 
-#endif
\ No newline at end of file
+
+
+#endif
@@ -0,0 +1,115 @@
+#include "cmsis_os.h"
+#include "stdbool.h"
+#include "tasks_init.h"
+#include "env_task.h"
+#include "device_env.h"
+#include "log.h"
+
+/*消息句柄*/
+osMessageQId env_task_msg_q_id;
+/*消息池*/
+MSG_POOL_DEF(env_task_msg_pool,env_task_message_t,ENV_TASK_MSG_POOL_SIZE);
+
+static void env_task_init(active_object_t *ao);
+static void env_task_handler(active_object_t *ao,const void *event);
+/*环境变量写回活动对象*/
+ACTIVE_OBJECT_DEF(env_task_ao,env_task_init,env_task_handler,&env_task_msg_pool);
+
+/*定时器和事件*/
+static active_object_timer_t env_flush_timer;
+static const env_task_message_t env_flush_msg = { .type = ENV_TASK_MSG_TYPE_FLUSH };
+
+typedef struct
+{
+    bool     ready;/*定时器已经初始化*/
+    bool     dirty;/*有未保存的设置*/
+    bool     now;  /*初始化前收到的尽快保存请求*/
+    uint32_t tick; /*第一次未保存设置的时刻 单位:tick*/
+}env_write_back_t;
+
+static env_write_back_t env_write_back;
+
+
+/*
+* @brief 有环境变量需要保存
+* @param now true:尽快保存 false:重新开始安静计时
+* @return 无
+* @note 作为device_env_write_back_enable的通知函数;不阻塞,可以在任意任务中调用.
+*       连续设置时从第一次设置开始最多推迟ENV_TASK_WRITE_BACK_DELAY_MAX
+*/
+void env_task_dirty(bool now)
+{
+    UBaseType_t mask;
+    uint32_t elapse,delay = ENV_TASK_WRITE_BACK_DELAY;
+
+    mask = portSET_INTERRUPT_MASK_FROM_ISR();
+    if (env_write_back.dirty == false) {
+        env_write_back.dirty = true;
+        env_write_back.tick = osKernelSysTick();
+    }
+    elapse = (osKernelSysTick() - env_write_back.tick) * portTICK_PERIOD_MS;
+    if (now == true || elapse >= ENV_TASK_WRITE_BACK_DELAY_MAX) {
+        delay = 0;
+    } else if (elapse + delay > ENV_TASK_WRITE_BACK_DELAY_MAX) {
+        delay = ENV_TASK_WRITE_BACK_DELAY_MAX - elapse;
+    }
+    if (env_write_back.ready == false) {
+        env_write_back.now |= now;
+        portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+        return;
+    }
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+
+    active_object_timer_start(&env_flush_timer,delay,0);
+}
+
+/*
+* @brief 环境变量写回初始化
+* @param ao 活动对象
+* @return 无
+* @note 调试线程启动前其他任务的设置只记下,在这里开始计时
+*/
+static void env_task_init(active_object_t *ao)
+{
+    UBaseType_t mask;
+    bool dirty,now;
+
+    active_object_timer_init(&env_flush_timer,ao,&env_flush_msg);
+
+    mask = portSET_INTERRUPT_MASK_FROM_ISR();
+    env_write_back.ready = true;
+    dirty = env_write_back.dirty;
+    now = env_write_back.now;
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+
+    if (dirty == true) {
+        active_object_timer_start(&env_flush_timer,now == true ? 0 : ENV_TASK_WRITE_BACK_DELAY,0);
+    }
+}
+
+/*
+* @brief 环境变量写回事件处理
+* @param ao 活动对象
+* @param event 写回任务消息
+* @return 无
+* @note 保存期间新的设置重新开始计时;保存失败的在下一个周期重试
+*/
+static void env_task_handler(active_object_t *ao,const void *event)
+{
+    UBaseType_t mask;
+    const env_task_message_t *msg = (const env_task_message_t *)event;
+
+    if (msg->type == ENV_TASK_MSG_TYPE_FLUSH) {
+        mask = portSET_INTERRUPT_MASK_FROM_ISR();
+        env_write_back.dirty = false;
+        env_write_back.now = false;
+        portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+
+#if  DEVICE_ENV_USE_WRITE_BACK > 0
+        if (device_env_barrier() != 0) {
+            log_error("env write back fail.retry.\r\n");
+            env_task_dirty(false);
+        }
+#endif
+    }
+}
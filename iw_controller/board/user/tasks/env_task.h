@@ -0,0 +1,55 @@
+#ifndef  __ENV_TASK_H__
+#define  __ENV_TASK_H__
+#include "stdint.h"
+#include "stdbool.h"
+#include "msg_pool.h"
+#include "active_object.h"
+
+#ifdef  __cplusplus
+#define ENV_TASK_BEGIN  extern "C" {
+#define ENV_TASK_END    }
+#else
+#define ENV_TASK_BEGIN
+#define ENV_TASK_END
+#endif
+
+
+ENV_TASK_BEGIN
+
+extern osMessageQId    env_task_msg_q_id;
+extern msg_pool_t      env_task_msg_pool;
+extern active_object_t env_task_ao;
+
+
+/********************    配置开始    **************************************/
+#define  ENV_TASK_WRITE_BACK_DELAY             2000  /*最后一次设置后安静多久保存 单位:ms*/
+#define  ENV_TASK_WRITE_BACK_DELAY_MAX         10000 /*连续设置时第一次设置后最多推迟多久保存 单位:ms*/
+/********************    配置结束    **************************************/
+
+#define  ENV_TASK_MSG_Q_SIZE                   2 /*消息队列深度*/
+#define  ENV_TASK_MSG_POOL_SIZE                (ENV_TASK_MSG_Q_SIZE + 1) /*消息池容量:队列+正在处理的事件*/
+
+enum
+{
+    ENV_TASK_MSG_TYPE_FLUSH
+};
+
+typedef struct
+{
+    uint8_t type;
+}env_task_message_t;/*环境变量写回任务消息体*/
+
+
+/*
+* @brief 有环境变量需要保存
+* @param now true:尽快保存 false:重新开始安静计时
+* @return 无
+* @note 作为device_env_write_back_enable的通知函数;不阻塞,可以在任意任务中调用
+*/
+void env_task_dirty(bool now);
+
+
+
+ENV_TASK_END
+
+#endif
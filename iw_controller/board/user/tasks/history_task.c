@@ -0,0 +1,421 @@
+#include "fsl_common.h"
+#include "cmsis_os.h"
+#include "string.h"
+#include "stdbool.h"
+#include "tasks_init.h"
+#include "history_task.h"
+#include "device_env.h"
+#include "flash_if.h"
+#include "crc16.h"
+#include "log.h"
+
+/*消息句柄*/
+osMessageQId history_task_msg_q_id;
+/*消息池*/
+MSG_POOL_DEF(history_task_msg_pool,history_task_message_t,HISTORY_TASK_MSG_POOL_SIZE);
+
+static void history_task_init(active_object_t *ao);
+static void history_task_handler(active_object_t *ao,const void *event);
+/*历史记录活动对象*/
+ACTIVE_OBJECT_DEF(history_task_ao,history_task_init,history_task_handler,&history_task_msg_pool);
+
+/*定时器和事件*/
+static active_object_timer_t history_sample_timer;
+static const history_task_message_t history_sample_timeout_msg = { .type = HISTORY_TASK_MSG_TYPE_SAMPLE_TIMEOUT };
+
+
+/*flash中一页的记录:页头加连续序号的记录,第k页(序号k*HISTORY_PAGE_RECORD_CNT开始)保存在k%HISTORY_PAGE_CNT页*/
+#define  HISTORY_PAGE_MAGIC                    0x4854
+#define  HISTORY_PAGE_RECORD_CNT               ((FLASH_PAGE_SIZE - sizeof(history_page_head_t)) / sizeof(history_record_t))
+#define  HISTORY_PAGE_CNT                      (HISTORY_SIZE_LIMIT / FLASH_PAGE_SIZE)
+
+typedef struct
+{
+    uint32_t seq;  /*第一条记录的序号*/
+    uint16_t magic;
+    uint16_t crc;  /*记录的crc16*/
+}history_page_head_t;
+
+typedef struct
+{
+    history_page_head_t head;
+    history_record_t    record[HISTORY_PAGE_RECORD_CNT];
+}history_page_t;
+
+typedef struct
+{
+    uint32_t head;       /*下一条记录的序号*/
+    uint32_t boot;       /*本次上电的第一条记录序号,RAM中只有之后的记录*/
+    uint32_t spill;      /*下一条写入flash的记录序号*/
+    uint32_t uptime;     /*上电后的时间 单位:s*/
+    uint32_t uptime_tick;/*上次更新时间的时刻 单位:tick*/
+    uint32_t uptime_ms;  /*不足1s的部分 单位:ms*/
+    int16_t  temperature;/*当前温度*/
+    int16_t  sample;     /*上次记录的温度*/
+    uint8_t  sample_skip;/*温度不变跳过的采样次数*/
+    int8_t   setting;
+    uint32_t door_open;  /*门打开的时刻 单位:s*/
+    bool     door_is_open;
+}history_t;
+
+static history_t history;
+static history_record_t history_ram[HISTORY_TASK_RAM_RECORD_CNT];
+
+#if  HISTORY_TASK_USE_FLASH > 0
+/*写入和读取flash的页缓存,写入只在历史记录任务中,读取在上电扫描和通信任务中*/
+static history_page_t history_write_page;
+static history_page_t history_read_page;
+#endif
+
+
+/*
+* @brief 上电后的时间
+* @param 无
+* @return 时间 单位:s
+* @note 从tick 0开始累加tick差值,tick回绕不影响;采样定时器保证至少每个采样周期调用一次
+*/
+uint32_t history_task_uptime(void)
+{
+    UBaseType_t mask;
+    uint32_t now,uptime;
+
+    mask = portSET_INTERRUPT_MASK_FROM_ISR();
+    now = osKernelSysTick();
+    history.uptime_ms += (now - history.uptime_tick) * portTICK_PERIOD_MS;
+    history.uptime_tick = now;
+    history.uptime += history.uptime_ms / 1000;
+    history.uptime_ms %= 1000;
+    uptime = history.uptime;
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+
+    return uptime;
+}
+
+/*
+* @brief 下一条记录的序号
+* @param 无
+* @return 序号
+* @note
+*/
+uint32_t history_task_head(void)
+{
+    return history.head;
+}
+
+/*
+* @brief 发送一个事件给历史记录任务
+* @param type 记录类型
+* @param arg 记录参数
+* @param value 记录数值
+* @return 无
+* @note 在发送时刻打时间戳,不等待;HISTORY_TYPE_TEMPERATURE只更新当前温度,由采样周期决定是否记录
+*/
+void history_task_post(uint8_t type,uint8_t arg,int16_t value)
+{
+    osStatus status;
+    history_task_message_t msg;
+
+    msg.type = HISTORY_TASK_MSG_TYPE_RECORD;
+    msg.record.time = history_task_uptime();
+    msg.record.type = type;
+    msg.record.arg = arg;
+    msg.record.value = value;
+    status = active_object_post(&history_task_ao,&msg,0);
+    if (status != osOK) {
+        log_error("put history msg error:%d\r\n",status);
+    }
+}
+
+#if  HISTORY_TASK_USE_FLASH > 0
+/*
+* @brief 序号所在页的flash地址
+* @param seq 页内第一条记录的序号
+* @return flash地址
+* @note
+*/
+static uint32_t history_page_addr(uint32_t seq)
+{
+    return HISTORY_BASE_ADDR + (seq / HISTORY_PAGE_RECORD_CNT) % HISTORY_PAGE_CNT * FLASH_PAGE_SIZE;
+}
+
+/*
+* @brief 读取一页并校验
+* @param seq 页内第一条记录的序号
+* @param page 页缓存
+* @return -1 页不存在或者已经被覆盖
+* @return  0 成功
+* @note
+*/
+static int history_page_read(uint32_t seq,history_page_t *page)
+{
+    flash_if_read(history_page_addr(seq),(uint8_t *)page,sizeof(history_page_t));
+    if (page->head.magic != HISTORY_PAGE_MAGIC || page->head.seq != seq) {
+        return -1;
+    }
+    if (page->head.crc != calculate_crc16((uint8_t *)page->record,sizeof(page->record))) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/*
+* @brief 查找flash中最新的一页
+* @param 无
+* @return 最新一页之后的记录序号,没有记录时为0
+* @note 上电时扫描所有页头
+*/
+static uint32_t history_flash_scan(void)
+{
+    uint32_t seq,next = 0;
+    history_page_head_t head;
+
+    for (uint32_t i = 0;i < HISTORY_PAGE_CNT;i ++) {
+        flash_if_read(HISTORY_BASE_ADDR + i * FLASH_PAGE_SIZE,(uint8_t *)&head,sizeof(head));
+        if (head.magic != HISTORY_PAGE_MAGIC || head.seq % HISTORY_PAGE_RECORD_CNT != 0) {
+            continue;
+        }
+        seq = head.seq + HISTORY_PAGE_RECORD_CNT;
+        if (seq > next && history_page_read(head.seq,&history_read_page) == 0) {
+            next = seq;
+        }
+    }
+
+    return next;
+}
+
+/*
+* @brief RAM中满一页的记录写入flash
+* @param 无
+* @return 无
+* @note 擦写期间CPU停顿,在低优先级线程中执行;失败时丢弃这一页,不重试
+*/
+static void history_flash_spill(void)
+{
+    int rc;
+    uint32_t addr;
+
+    while (history.head - history.spill >= HISTORY_PAGE_RECORD_CNT) {
+        history_write_page.head.seq = history.spill;
+        history_write_page.head.magic = HISTORY_PAGE_MAGIC;
+        for (uint8_t i = 0;i < HISTORY_PAGE_RECORD_CNT;i ++) {
+            history_write_page.record[i] = history_ram[(history.spill + i) % HISTORY_TASK_RAM_RECORD_CNT];
+        }
+        history_write_page.head.crc = calculate_crc16((uint8_t *)history_write_page.record,sizeof(history_write_page.record));
+
+        addr = history_page_addr(history.spill);
+        rc = flash_if_erase(addr,FLASH_PAGE_SIZE);
+        if (rc == 0) {
+            rc = flash_if_write(addr,(uint8_t *)&history_write_page,FLASH_PAGE_SIZE);
+        }
+        if (rc != 0) {
+            log_error("history page seq:%d write err.\r\n",history.spill);
+        }
+        history.spill += HISTORY_PAGE_RECORD_CNT;
+    }
+}
+#endif
+
+/*
+* @brief 添加一条记录
+* @param record 记录
+* @return 无
+* @note 满一页后写入flash
+*/
+static void history_append(const history_record_t *record)
+{
+    UBaseType_t mask;
+
+    mask = portSET_INTERRUPT_MASK_FROM_ISR();
+    history_ram[history.head % HISTORY_TASK_RAM_RECORD_CNT] = *record;
+    history.head ++;
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+
+#if  HISTORY_TASK_USE_FLASH > 0
+    history_flash_spill();
+#endif
+}
+
+/*
+* @brief 从指定序号开始读取记录
+* @param seq 开始序号
+* @param record 记录缓存
+* @param cnt 最多读取的数量
+* @param first 实际读到的第一条记录的序号,已经被覆盖的记录会跳过
+* @return 读到的记录数量
+* @note 先从RAM读取,更早的记录从flash读取;只在通信任务中调用
+*/
+uint8_t history_task_read(uint32_t seq,history_record_t *record,uint8_t cnt,uint32_t *first)
+{
+    UBaseType_t mask;
+    uint32_t head,oldest;
+    uint8_t n = 0;
+    bool valid;
+
+    *first = history.head;
+    while (n < cnt) {
+        head = history.head;
+        if (seq >= head) {
+            break;
+        }
+        /*RAM中保存本次上电后最近的记录*/
+        oldest = head > HISTORY_TASK_RAM_RECORD_CNT ? head - HISTORY_TASK_RAM_RECORD_CNT : 0;
+        if (oldest < history.boot) {
+            oldest = history.boot;
+        }
+        if (seq >= oldest) {
+            mask = portSET_INTERRUPT_MASK_FROM_ISR();
+            /*复制前可能被新记录覆盖*/
+            valid = history.head - seq <= HISTORY_TASK_RAM_RECORD_CNT;
+            if (valid == true) {
+                record[n] = history_ram[seq % HISTORY_TASK_RAM_RECORD_CNT];
+            }
+            portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+            if (valid == false) {
+                continue;
+            }
+            if (n == 0) {
+                *first = seq;
+            }
+            n ++;
+            seq ++;
+            continue;
+        }
+#if  HISTORY_TASK_USE_FLASH > 0
+        /*超出flash容量的记录已经被覆盖*/
+        if (history.boot > HISTORY_PAGE_CNT * HISTORY_PAGE_RECORD_CNT && seq < history.boot - HISTORY_PAGE_CNT * HISTORY_PAGE_RECORD_CNT) {
+            seq = history.boot - HISTORY_PAGE_CNT * HISTORY_PAGE_RECORD_CNT;
+        }
+        if (history_page_read(seq - seq % HISTORY_PAGE_RECORD_CNT,&history_read_page) != 0) {
+            /*跳过不存在的页,不能越过RAM中最早的记录*/
+            seq += HISTORY_PAGE_RECORD_CNT - seq % HISTORY_PAGE_RECORD_CNT;
+            if (seq > oldest) {
+                seq = oldest;
+            }
+            continue;
+        }
+        if (n == 0) {
+            *first = seq;
+        }
+        do {
+            record[n ++] = history_read_page.record[seq % HISTORY_PAGE_RECORD_CNT];
+            seq ++;
+        } while (n < cnt && seq % HISTORY_PAGE_RECORD_CNT != 0);
+#else
+        seq = oldest;
+#endif
+    }
+
+    return n;
+}
+
+/*
+* @brief 周期温度采样
+* @param 无
+* @return 无
+* @note 温度变化超过HISTORY_TASK_TEMPERATURE_DELTA或者连续跳过HISTORY_TASK_SAMPLE_KEEPALIVE次后记录
+*/
+static void history_sample(void)
+{
+    history_record_t record;
+    int16_t delta;
+
+    delta = history.temperature - history.sample;
+    if (history.sample_skip + 1 < HISTORY_TASK_SAMPLE_KEEPALIVE &&
+        delta < HISTORY_TASK_TEMPERATURE_DELTA && delta > -HISTORY_TASK_TEMPERATURE_DELTA) {
+        history.sample_skip ++;
+        return;
+    }
+    record.time = history_task_uptime();
+    record.type = HISTORY_TYPE_TEMPERATURE;
+    record.arg = (uint8_t)history.setting;
+    record.value = history.temperature;
+    history_append(&record);
+    history.sample = history.temperature;
+    history.sample_skip = 0;
+}
+
+/*
+* @brief 历史记录初始化
+* @param ao 活动对象
+* @return 无
+* @note 序号接着flash中最新的一页,上次上电未写入flash的记录丢失
+*/
+static void history_task_init(active_object_t *ao)
+{
+    history_record_t record;
+    uint32_t seq = 0;
+
+#if  HISTORY_TASK_USE_FLASH > 0
+    seq = history_flash_scan();
+#endif
+    history.boot = seq;
+    history.spill = seq;
+    history.head = seq;
+    history.temperature = HISTORY_VALUE_ERR;
+    history.sample = HISTORY_VALUE_ERR;
+    log_info("history start seq:%d.\r\n",history.head);
+
+    record.time = history_task_uptime();
+    record.type = HISTORY_TYPE_BOOT;
+    record.arg = 0;
+    record.value = 0;
+    history_append(&record);
+
+    active_object_timer_init(&history_sample_timer,ao,&history_sample_timeout_msg);
+    active_object_timer_start(&history_sample_timer,HISTORY_TASK_SAMPLE_INTERVAL,HISTORY_TASK_SAMPLE_INTERVAL);
+}
+
+/*
+* @brief 历史记录事件处理
+* @param ao 活动对象
+* @param event 历史记录任务消息
+* @return 无
+* @note
+*/
+static void history_task_handler(active_object_t *ao,const void *event)
+{
+    const history_task_message_t *msg = (const history_task_message_t *)event;
+    history_record_t record;
+
+    if (msg->type == HISTORY_TASK_MSG_TYPE_SAMPLE_TIMEOUT) {
+        history_sample();
+        return;
+    }
+    if (msg->type != HISTORY_TASK_MSG_TYPE_RECORD) {
+        return;
+    }
+
+    record = msg->record;
+    switch (record.type) {
+    case HISTORY_TYPE_TEMPERATURE:
+        /*温度错误和恢复立即记录,其他由采样决定*/
+        history.temperature = record.value;
+        if ((record.value == HISTORY_VALUE_ERR) != (history.sample == HISTORY_VALUE_ERR)) {
+            record.arg = (uint8_t)history.setting;
+            history_append(&record);
+            history.sample = record.value;
+            history.sample_skip = 0;
+        }
+        break;
+    case HISTORY_TYPE_SETTING:
+        history.setting = (int8_t)record.arg;
+        history_append(&record);
+        break;
+    case HISTORY_TYPE_DOOR:
+        if (record.arg != 0) {
+            history.door_open = record.time;
+            history.door_is_open = true;
+            record.value = 0;
+        } else {
+            /*打开的时长,上电后第一次关闭时未知*/
+            record.value = history.door_is_open == true ? (int16_t)MIN(record.time - history.door_open,INT16_MAX) : -1;
+            history.door_is_open = false;
+        }
+        history_append(&record);
+        break;
+    default:
+        history_append(&record);
+        break;
+    }
+}
@@ -0,0 +1,110 @@
+#ifndef  __HISTORY_TASK_H__
+#define  __HISTORY_TASK_H__
+#include "stdint.h"
+#include "stdbool.h"
+#include "msg_pool.h"
+#include "active_object.h"
+
+#ifdef  __cplusplus
+#define HISTORY_TASK_BEGIN  extern "C" {
+#define HISTORY_TASK_END    }
+#else
+#define HISTORY_TASK_BEGIN
+#define HISTORY_TASK_END
+#endif
+
+
+HISTORY_TASK_BEGIN
+
+extern osMessageQId    history_task_msg_q_id;
+extern msg_pool_t      history_task_msg_pool;
+extern active_object_t history_task_ao;
+
+
+/********************    配置开始    **************************************/
+#define  HISTORY_TASK_USE_FLASH                1  /*RAM记录满一页后是否写入flash*/
+#define  HISTORY_TASK_RAM_RECORD_CNT           256 /*RAM环形缓存的记录数量*/
+#define  HISTORY_TASK_SAMPLE_INTERVAL          (60 * 1000) /*温度采样周期 单位:ms*/
+#define  HISTORY_TASK_SAMPLE_KEEPALIVE         10  /*温度不变时每隔多少个采样周期仍然记录一次*/
+#define  HISTORY_TASK_TEMPERATURE_DELTA        10  /*与上次记录相差多少才记录 单位:0.01C*/
+/********************    配置结束    **************************************/
+
+#define  HISTORY_TASK_MSG_Q_SIZE               8 /*消息队列深度*/
+#define  HISTORY_TASK_MSG_POOL_SIZE            (HISTORY_TASK_MSG_Q_SIZE + 1) /*消息池容量:队列+正在处理的事件*/
+
+#define  HISTORY_VALUE_ERR                     0x7FFF /*温度错误时记录的温度值*/
+
+/*记录类型*/
+enum
+{
+    HISTORY_TYPE_BOOT = 0,    /*上电 value:0*/
+    HISTORY_TYPE_TEMPERATURE, /*箱内温度 arg:设置温度 value:温度 单位:0.01C,错误时为HISTORY_VALUE_ERR*/
+    HISTORY_TYPE_SETTING,     /*设置温度变化 arg:新的设置温度 value:旧的设置温度*/
+    HISTORY_TYPE_COMPRESSOR,  /*压缩机状态变化 arg:新状态 value:旧状态*/
+    HISTORY_TYPE_DOOR         /*门状态变化 arg:1打开 0关闭 value:关闭时为本次打开的时长 单位:s*/
+};
+
+/*一条记录,序号由所在位置决定,不保存*/
+typedef struct
+{
+    uint32_t time;/*上电后的时间 单位:s*/
+    uint8_t  type;
+    uint8_t  arg;
+    int16_t  value;
+}history_record_t;
+
+enum
+{
+    HISTORY_TASK_MSG_TYPE_RECORD,
+    HISTORY_TASK_MSG_TYPE_SAMPLE_TIMEOUT
+};
+
+typedef struct
+{
+    uint8_t type;
+    history_record_t record;
+}history_task_message_t;/*历史记录任务消息体*/
+
+
+/*
+* @brief 发送一个事件给历史记录任务
+* @param type 记录类型
+* @param arg 记录参数
+* @param value 记录数值
+* @return 无
+* @note 在发送时刻打时间戳,不等待;HISTORY_TYPE_TEMPERATURE只更新当前温度,由采样周期决定是否记录
+*/
+void history_task_post(uint8_t type,uint8_t arg,int16_t value);
+
+/*
+* @brief 上电后的时间
+* @param 无
+* @return 时间 单位:s
+* @note
+*/
+uint32_t history_task_uptime(void);
+
+/*
+* @brief 下一条记录的序号
+* @param 无
+* @return 序号
+* @note
+*/
+uint32_t history_task_head(void);
+
+/*
+* @brief 从指定序号开始读取记录
+* @param seq 开始序号
+* @param record 记录缓存
+* @param cnt 最多读取的数量
+* @param first 实际读到的第一条记录的序号,已经被覆盖的记录会跳过
+* @return 读到的记录数量
+* @note 先从RAM读取,更早的记录从flash读取;只在通信任务中调用
+*/
+uint8_t history_task_read(uint32_t seq,history_record_t *record,uint8_t cnt,uint32_t *first);
+
+
+
+HISTORY_TASK_END
+
+#endif
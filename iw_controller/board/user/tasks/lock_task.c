@@ -5,11 +5,26 @@
 #include "tasks_init.h"
 #include "lock_task.h"
 #include "communication_task.h"
+#include "compressor_task.h"
+#include "history_task.h"
 #include "log.h"
 
-osThreadId   lock_task_hdl;
 osMessageQId lock_task_msg_q_id;
-osTimerId    lock_controller_timer_id;
+/*锁任务消息池*/
+MSG_POOL_DEF(lock_task_msg_pool,lock_task_message_t,LOCK_TASK_MSG_POOL_SIZE);
+
+static void lock_task_init(active_object_t *ao);
+static void lock_task_handler(active_object_t *ao,const void *event);
+/*锁控活动对象*/
+ACTIVE_OBJECT_DEF(lock_task_ao,lock_task_init,lock_task_handler,&lock_task_msg_pool);
+
+/*定时器和到期事件*/
+static active_object_timer_t lock_debounce_timer;
+static active_object_timer_t lock_manual_timer;
+static active_object_timer_t lock_operation_timer;
+static const lock_task_message_t lock_debounce_timeout_msg = { .request.type = LOCK_TASK_MSG_TYPE_SENSOR_DEBOUNCE_TIMEOUT };
+static const lock_task_message_t lock_manual_timeout_msg = { .request.type = LOCK_TASK_MSG_TYPE_MANUAL_UNLOCK_TIMEOUT };
+static const lock_task_message_t lock_operation_timeout_msg = { .request.type = LOCK_TASK_MSG_TYPE_OPERATION_TIMEOUT };
 
 
 typedef struct
@@ -17,309 +32,384 @@ typedef struct
     struct
     {
      uint8_t status;
-     uint32_t hold_on_time;
     }door_sensor;
     struct
     {
      uint8_t status;
-     uint32_t hold_on_time;
     }lock_sensor;
     struct
     {
      uint8_t status;
-     uint32_t hold_on_time;
     }hole_sensor;
     struct
     {
     uint8_t status;
-    uint32_t hold_on_time;
-    uint32_t unlock_hold_on_time;
     bool manual_unlock;
     }manual_switch;
+    struct
+    {
+    bool busy;/*是否有开关锁操作在等待传感器*/
+    uint8_t type;/*LOCK_TASK_MSG_TYPE_LOCK_LOCK或者LOCK_TASK_MSG_TYPE_UNLOCK_LOCK*/
+    uint32_t start;/*操作开始时刻 单位:tick*/
+    uint32_t timeout;/*操作超时时间 单位:ms*/
+    osMessageQId rsp_message_queue_id;/*回应的消息队列id*/
+    }operation;
 }lock_controller_t;
 
 
 /*锁控对象实体*/
 static volatile lock_controller_t lock_controller;
 
-static void lock_controller_timer_expired(void const *argument);
 
+/*最后一次引脚跳变的时刻 单位:tick,中断中写入*/
+static volatile uint32_t lock_sensor_edge_tick;
+/*消抖定时器已经启动,到期时检查引脚是否稳定*/
+static volatile bool lock_sensor_debouncing;
 
 /*
-* @brief 锁控定时器初始化
+* @brief 传感器引脚电平变化中断回调
 * @param 无
 * @return 无
-* @note
+* @note 只记录跳变时刻,消抖定时器没有启动时才启动它;抖动期间的跳变不再操作定时器,
+* @note 由到期处理根据最后一次跳变时刻决定采样还是继续等待
 */
-static void lock_controller_timer_init(void)
+static void lock_sensor_int_callback(void)
 {
-    osTimerDef(lock_controller_timer,lock_controller_timer_expired);
-    lock_controller_timer_id = osTimerCreate(osTimer(lock_controller_timer),osTimerPeriodic,0);
-    log_assert(lock_controller_timer_id);
+    lock_sensor_edge_tick = osKernelSysTick();
+    if (lock_sensor_debouncing == false) {
+        lock_sensor_debouncing = true;
+        active_object_timer_start(&lock_debounce_timer,LOCK_TASK_SENSOR_DEBOUNCE_TIME,0);
+    }
 }
+
 /*
-* @brief 锁控定时器开始
+* @brief 消抖定时器到期,检查引脚是否已经稳定
 * @param 无
-* @return 无
-* @note
+* @return true 最后一次跳变之后已经稳定LOCK_TASK_SENSOR_DEBOUNCE_TIME,可以采样
+* @return false 还在抖动,定时器已经按剩余时间重新启动
+* @note 先清除标志再读跳变时刻,检查之后到来的跳变会自己启动定时器,不会漏掉最终电平
 */
-static void lock_controller_timer_start(void)
+static bool lock_sensor_debounce_check(void)
 {
-    osTimerStart(lock_controller_timer_id,LOCK_TASK_LOCK_CONTROLLER_TIMER_TIMEOUT);  
-    log_debug("lock controller timer start.\r\n"); 
+    uint32_t elapse;
+
+    lock_sensor_debouncing = false;
+    elapse = osKernelSysTick() - lock_sensor_edge_tick;
+    if (elapse < LOCK_TASK_SENSOR_DEBOUNCE_TIME / portTICK_PERIOD_MS) {
+        lock_sensor_debouncing = true;
+        active_object_timer_start(&lock_debounce_timer,LOCK_TASK_SENSOR_DEBOUNCE_TIME - elapse * portTICK_PERIOD_MS,0);
+        return false;
+    }
+    return true;
 }
+
 /*
-* @brief 锁控定时器回调
-* @param argument 回调参数
+* @brief 锁控初始化
+* @param ao 活动对象
 * @return 无
-* @note
+* @note 先采样一次得到初始状态,之后只在引脚跳变时采样
+*/
+static void lock_task_init(active_object_t *ao)
+{
+    int rc;
+
+    active_object_timer_init(&lock_debounce_timer,ao,&lock_debounce_timeout_msg);
+    active_object_timer_init(&lock_manual_timer,ao,&lock_manual_timeout_msg);
+    active_object_timer_init(&lock_operation_timer,ao,&lock_operation_timeout_msg);
+
+    rc = bsp_sensor_int_init(lock_sensor_int_callback);
+    log_assert(rc == 0);
+    lock_sensor_edge_tick = osKernelSysTick();
+    lock_sensor_debouncing = true;
+    active_object_timer_start(&lock_debounce_timer,LOCK_TASK_SENSOR_DEBOUNCE_TIME,0);
+    log_debug("lock controller sensor init ok.\r\n");
+}
+
+/*
+* @brief 采样所有传感器
+* @param 无
+* @return true 锁或者锁孔或者门状态有变化
+* @return false 没有变化
+* @note 手动按键按下时直接开锁,松开后开始开锁保持计时
 */
-static void lock_controller_timer_expired(void const *argument)
-{ 
-    osStatus os_status;
-    static lock_task_message_t req_msg;
+static bool lock_controller_sensor_sample(void)
+{
+    bool change = false;
+    compressor_task_message_t door_msg;
 
     uint8_t status;
-    /*锁传感器状态轮询*/
+    /*锁传感器状态*/
     status = bsp_lock_sensor_status();
     if (status != lock_controller.lock_sensor.status) {
-        lock_controller.lock_sensor.hold_on_time += LOCK_TASK_LOCK_CONTROLLER_TIMER_TIMEOUT;
-        if (lock_controller.lock_sensor.hold_on_time >= LOCK_TASK_STATUS_HOLD_ON_TIME) {
-            lock_controller.lock_sensor.hold_on_time = 0;
-            lock_controller.lock_sensor.status = status;
-   
-            if (lock_controller.lock_sensor.status == BSP_LOCK_STATUS_UNLOCKED) {
-                log_info("lock status change to --> UNLOCKED.\r\n");
-            } else {
-                log_info("lock status change to --> LOCKED.\r\n");
-            }
+        lock_controller.lock_sensor.status = status;
+        change = true;
+        if (lock_controller.lock_sensor.status == BSP_LOCK_STATUS_UNLOCKED) {
+            log_info("lock status change to --> UNLOCKED.\r\n");
+        } else {
+            log_info("lock status change to --> LOCKED.\r\n");
         }
-    } else {
-        lock_controller.lock_sensor.hold_on_time = 0;
     }
-    /*锁孔传感器状态轮询*/
+    /*锁孔传感器状态*/
     status = bsp_hole_sensor_status();
     if (status != lock_controller.hole_sensor.status) {
-        lock_controller.hole_sensor.hold_on_time += LOCK_TASK_LOCK_CONTROLLER_TIMER_TIMEOUT;
-        if (lock_controller.hole_sensor.hold_on_time >= LOCK_TASK_STATUS_HOLD_ON_TIME) {
-            lock_controller.hole_sensor.hold_on_time = 0;
-            lock_controller.hole_sensor.status = status;
-   
-            if (lock_controller.hole_sensor.status == BSP_HOLE_STATUS_OPEN) {
-                log_info("hole status change to --> OPEN.\r\n");
-            } else {
-                log_info("hole status change to --> CLOSE.\r\n");
-            }
+        lock_controller.hole_sensor.status = status;
+        change = true;
+        if (lock_controller.hole_sensor.status == BSP_HOLE_STATUS_OPEN) {
+            log_info("hole status change to --> OPEN.\r\n");
+        } else {
+            log_info("hole status change to --> CLOSE.\r\n");
         }
-    } else {
-        lock_controller.hole_sensor.hold_on_time = 0;
     }
-    /*门磁传感器状态轮询*/
+    /*门磁传感器状态*/
     status = bsp_door_sensor_status();
     if (status != lock_controller.door_sensor.status) {
-        lock_controller.door_sensor.hold_on_time += LOCK_TASK_LOCK_CONTROLLER_TIMER_TIMEOUT;
-        if (lock_controller.door_sensor.hold_on_time >= LOCK_TASK_STATUS_HOLD_ON_TIME) {
-            lock_controller.door_sensor.hold_on_time = 0;
-            lock_controller.door_sensor.status = status;
-   
-            if (lock_controller.door_sensor.status == BSP_DOOR_STATUS_OPEN) {
-                log_info("door status change to --> OPEN.\r\n");
-            } else {
-                log_info("door status change to --> CLOSE.\r\n");
-            }
+        lock_controller.door_sensor.status = status;
+        change = true;
+        if (lock_controller.door_sensor.status == BSP_DOOR_STATUS_OPEN) {
+            log_info("door status change to --> OPEN.\r\n");
+        } else {
+            log_info("door status change to --> CLOSE.\r\n");
+        }
+        history_task_post(HISTORY_TYPE_DOOR,lock_controller.door_sensor.status == BSP_DOOR_STATUS_OPEN ? 1 : 0,0);
+        /*门状态作为压缩机自适应控制的前馈*/
+        door_msg.request.type = COMPRESSOR_TASK_MSG_TYPE_DOOR_STATUS;
+        door_msg.request.door_open = lock_controller.door_sensor.status == BSP_DOOR_STATUS_OPEN ? 1 : 0;
+        if (active_object_post(&compressor_task_ao,&door_msg,0) != osOK) {
+            log_error("lock put compressor door msg error.\r\n");
         }
-    } else {
-        lock_controller.door_sensor.hold_on_time = 0;
     }
 
-    /*手动按键状态轮询*/
+    /*手动按键状态*/
     status = bsp_unlock_sw_status();
     if (status != lock_controller.manual_switch.status) {
-        lock_controller.manual_switch.hold_on_time += LOCK_TASK_LOCK_CONTROLLER_TIMER_TIMEOUT;
-        if (lock_controller.manual_switch.hold_on_time >= LOCK_TASK_STATUS_HOLD_ON_TIME) {
-            lock_controller.manual_switch.hold_on_time = 0;
-            lock_controller.manual_switch.status = status;
-
-            if (status == BSP_UNLOCK_SW_STATUS_PRESS) {
-                if (lock_controller.manual_switch.manual_unlock == false) {
-                    lock_controller.manual_switch.manual_unlock = true;
-                    /*检测到手动开门*/
-                    req_msg.request.type = LOCK_TASK_MSG_TYPE_MANUAL_UNLOCK_LOCK;
-                    os_status = osMessagePut(lock_task_msg_q_id,(uint32_t)&req_msg,0);
-                    if (os_status != osOK) {
-                        log_error("put manual unlock msg err:%d.\r\n",status);
-                    }
-                }
-            } else {
-                /*检测到松手关门,重新计时*/
-                lock_controller.manual_switch.unlock_hold_on_time = 0;
+        lock_controller.manual_switch.status = status;
+
+        if (status == BSP_UNLOCK_SW_STATUS_PRESS) {
+            /*按下时停止开锁保持计时*/
+            active_object_timer_stop(&lock_manual_timer);
+            if (lock_controller.manual_switch.manual_unlock == false) {
+                lock_controller.manual_switch.manual_unlock = true;
+                /*检测到手动开门*/
+                log_info("manual unlock lock...\r\n");
+                bsp_lock_ctrl_open();
             }
+        } else if (lock_controller.manual_switch.manual_unlock == true) {
+            /*检测到松手,开始开锁保持计时*/
+            active_object_timer_start(&lock_manual_timer,LOCK_TASK_MANUAL_UNLOCK_TIME,0);
+        }
+    }
+
+    return change;
+}
+
+/*
+* @brief 结束正在等待的开关锁操作并回应
+* @param success 传感器是否到达目标状态
+* @return 无
+* @note 失败时把锁恢复到操作之前的方向
+*/
+static void lock_operation_finish(bool success)
+{
+    osStatus status;
+    lock_task_message_t rsp_msg;
+
+    active_object_timer_stop(&lock_operation_timer);
+    lock_controller.operation.busy = false;
 
-         }
+    if (lock_controller.operation.type == LOCK_TASK_MSG_TYPE_UNLOCK_LOCK) {
+        rsp_msg.response.type = LOCK_TASK_MSG_TYPE_RSP_UNLOCK_LOCK_RESULT;
+        if (success == true) {
+            rsp_msg.response.result = LOCK_TASK_SUCCESS;
+            log_debug("unlock success.\r\n");
+        } else {
+            /*如果开锁失败，就把锁关闭*/
+            bsp_lock_ctrl_close();
+            rsp_msg.response.result = LOCK_TASK_FAIL;
+            log_error("unlock fail.timeout.\r\n");
+        }
     } else {
-        lock_controller.manual_switch.hold_on_time = 0;
+        rsp_msg.response.type = LOCK_TASK_MSG_TYPE_RSP_LOCK_LOCK_RESULT;
+        if (success == true) {
+            rsp_msg.response.result = LOCK_TASK_SUCCESS;
+            log_debug("lock success.\r\n");
+        } else {
+            /*如果关锁失败，就把锁打开*/
+            bsp_lock_ctrl_open();
+            rsp_msg.response.result = LOCK_TASK_FAIL;
+            log_error("lock fail.timeout.\r\n");
+        }
     }
-    
-    /*按键松开后的开锁保持时间*/
-    if (lock_controller.manual_switch.manual_unlock == true && lock_controller.manual_switch.status == BSP_UNLOCK_SW_STATUS_RELEASE) {
-        lock_controller.manual_switch.unlock_hold_on_time += LOCK_TASK_LOCK_CONTROLLER_TIMER_TIMEOUT;
-        if (lock_controller.manual_switch.unlock_hold_on_time >= LOCK_TASK_MANUAL_UNLOCK_TIME) {
-            /*关锁*/
-            lock_controller.manual_switch.unlock_hold_on_time = 0;
-            lock_controller.manual_switch.manual_unlock = false;
-            req_msg.request.type = LOCK_TASK_MSG_TYPE_MANUAL_LOCK_LOCK;
-            os_status = osMessagePut(lock_task_msg_q_id,(uint32_t)&req_msg,0);
-            if (os_status != osOK) {
-                log_error("put manual unlock msg err:%d.\r\n",status);
-            }
+
+    status = msg_pool_send(&lock_task_msg_pool,lock_controller.operation.rsp_message_queue_id,&rsp_msg,LOCK_TASK_PUT_MSG_TIMEOUT);
+    if (status != osOK){
+        log_error("lock put operation result msg err:%d.\r\n",status);
+    }
+}
+
+/*
+* @brief 检查传感器是否到达开关锁操作的目标状态
+* @param 无
+* @return 无
+* @note 到达时回应成功
+*/
+static void lock_operation_check(void)
+{
+    if (lock_controller.operation.busy == false) {
+        return;
+    }
+    if (lock_controller.operation.type == LOCK_TASK_MSG_TYPE_UNLOCK_LOCK) {
+        if (lock_controller.lock_sensor.status == BSP_LOCK_STATUS_UNLOCKED && lock_controller.hole_sensor.status == BSP_HOLE_STATUS_OPEN) {
+            lock_operation_finish(true);
+        }
+    } else {
+        if (lock_controller.lock_sensor.status == BSP_LOCK_STATUS_LOCKED && lock_controller.hole_sensor.status == BSP_HOLE_STATUS_CLOSE) {
+            lock_operation_finish(true);
         }
     }
 }
 
 /*
-* @brief 锁控任务
-* @param argument 任务参数
+* @brief 开始开关锁操作,等待传感器到达目标状态或者超时
+* @param req_msg 开锁或者关锁请求
+* @param timeout 超时时间 单位:ms
 * @return 无
-* @note
+* @note 上一个操作还没有结束时直接回应失败
 */
-void lock_task(void const *argument)
+static void lock_operation_start(const lock_task_message_t *req_msg,uint32_t timeout)
 {
-    osStatus   status;
-    osEvent    os_event;
-    lock_task_message_t req_msg,rsp_msg;
-    utils_timer_t timer;
- 
- 
-    osMessageQDef(lock_task_msg_q,4,uint32_t);
-    lock_task_msg_q_id = osMessageCreate(osMessageQ(lock_task_msg_q),lock_task_hdl);
-    log_assert(lock_task_msg_q_id); 
- 
-    lock_controller_timer_init();
-    lock_controller_timer_start();
- 
-    while (1) {
-        os_event = osMessageGet(lock_task_msg_q_id,LOCK_TASK_MSG_WAIT_TIMEOUT);
-        if (os_event.status == osEventMessage) {
-            req_msg = *(lock_task_message_t *)os_event.value.v;
- 
-        /*获取门状态*/
-        if (req_msg.request.type == LOCK_TASK_MSG_TYPE_DOOR_STATUS) {   
-            rsp_msg.response.type = LOCK_TASK_MSG_TYPE_RSP_DOOR_STATUS;
-  
-            if (lock_controller.door_sensor.status == BSP_DOOR_STATUS_OPEN) { 
-                rsp_msg.response.status = LOCK_TASK_STATUS_DOOR_OPEN;
-            } else {
-                rsp_msg.response.status = LOCK_TASK_STATUS_DOOR_CLOSE; 
-            }
-            status = osMessagePut(req_msg.request.rsp_message_queue_id,(uint32_t)&rsp_msg,LOCK_TASK_PUT_MSG_TIMEOUT);
-            if (status != osOK) {
-                log_error("lock put door status msg err:%d.\r\n",status);
-            }
+    osStatus status;
+    lock_task_message_t rsp_msg;
+
+    if (lock_controller.operation.busy == true) {
+        rsp_msg.response.type = req_msg->request.type == LOCK_TASK_MSG_TYPE_UNLOCK_LOCK ? LOCK_TASK_MSG_TYPE_RSP_UNLOCK_LOCK_RESULT : LOCK_TASK_MSG_TYPE_RSP_LOCK_LOCK_RESULT;
+        rsp_msg.response.result = LOCK_TASK_FAIL;
+        log_error("lock operation busy.\r\n");
+        status = msg_pool_send(&lock_task_msg_pool,req_msg->request.rsp_message_queue_id,&rsp_msg,LOCK_TASK_PUT_MSG_TIMEOUT);
+        if (status != osOK){
+            log_error("lock put busy msg err:%d.\r\n",status);
         }
+        return;
+    }
 
-        /*获取锁状态*/
-        if (req_msg.request.type == LOCK_TASK_MSG_TYPE_LOCK_STATUS) {   
-            rsp_msg.response.type = LOCK_TASK_MSG_TYPE_RSP_LOCK_STATUS;
-  
-            if (lock_controller.lock_sensor.status == BSP_LOCK_STATUS_LOCKED) { 
-                rsp_msg.response.status = LOCK_TASK_STATUS_LOCK_LOCKED;
-            } else {
-                rsp_msg.response.status = LOCK_TASK_STATUS_LOCK_UNLOCKED; 
-            }
-            status = osMessagePut(req_msg.request.rsp_message_queue_id,(uint32_t)&rsp_msg,LOCK_TASK_PUT_MSG_TIMEOUT);
-            if (status != osOK) {
-                log_error("lock put door status msg err:%d.\r\n",status);
-            }
+    if (req_msg->request.type == LOCK_TASK_MSG_TYPE_UNLOCK_LOCK) {
+        log_debug("unlock lock...\r\n");
+        /*执行开锁操作*/
+        bsp_lock_ctrl_open();
+    } else {
+        log_debug("lock lock...\r\n");
+        /*只有在没手动开门的情况下，才执行关锁操作*/
+        if (lock_controller.manual_switch.manual_unlock == false) {
+            bsp_lock_ctrl_close();
         }
+    }
+    lock_controller.operation.busy = true;
+    lock_controller.operation.type = req_msg->request.type;
+    lock_controller.operation.start = osKernelSysTick();
+    lock_controller.operation.timeout = timeout;
+    lock_controller.operation.rsp_message_queue_id = req_msg->request.rsp_message_queue_id;
+    active_object_timer_start(&lock_operation_timer,timeout,0);
+    /*传感器可能已经在目标状态*/
+    lock_operation_check();
+}
 
-        /*开锁*/
-        if (req_msg.request.type == LOCK_TASK_MSG_TYPE_UNLOCK_LOCK){ 
-            log_debug("unlock lock...\r\n");
-            /*执行开锁操作*/
-            bsp_lock_ctrl_open();
+/*
+* @brief 锁控事件处理
+* @param ao 活动对象
+* @param event 锁任务消息
+* @return 无
+* @note 开关锁不再阻塞等待传感器,等待期间仍然可以查询状态
+*/
+static void lock_task_handler(active_object_t *ao,const void *event)
+{
+    osStatus   status;
+    const lock_task_message_t *req_msg = (const lock_task_message_t *)event;
+    lock_task_message_t rsp_msg;
 
-            utils_timer_init(&timer,LOCK_TASK_UNLOCK_TIMEOUT,false);
+    switch (req_msg->request.type) {
+    /*获取门状态*/
+    case LOCK_TASK_MSG_TYPE_DOOR_STATUS:
+        rsp_msg.response.type = LOCK_TASK_MSG_TYPE_RSP_DOOR_STATUS;
 
-            while (utils_timer_value(&timer) > 0 && (lock_controller.lock_sensor.status != BSP_LOCK_STATUS_UNLOCKED || lock_controller.hole_sensor.status != BSP_HOLE_STATUS_OPEN) ){
-                osDelay(10);
-            }
-            rsp_msg.response.type = LOCK_TASK_MSG_TYPE_RSP_UNLOCK_LOCK_RESULT;
-            if (lock_controller.lock_sensor.status == BSP_LOCK_STATUS_UNLOCKED && lock_controller.hole_sensor.status == BSP_HOLE_STATUS_OPEN) {               
-                rsp_msg.response.result = LOCK_TASK_SUCCESS;
-                log_debug("unlock success.\r\n");
-            } else {
-                /*如果开锁失败，就把锁关闭*/
-                bsp_lock_ctrl_close();
-                rsp_msg.response.result = LOCK_TASK_FAIL;
-                log_error("unlock fail.timeout.\r\n");
-            }
-   
-            status = osMessagePut(req_msg.request.rsp_message_queue_id,(uint32_t)&rsp_msg,LOCK_TASK_PUT_MSG_TIMEOUT);
-            if (status != osOK){
-                log_error("lock put unlock msg err:%d.\r\n",status);
-            } 
+        if (lock_controller.door_sensor.status == BSP_DOOR_STATUS_OPEN) {
+            rsp_msg.response.status = LOCK_TASK_STATUS_DOOR_OPEN;
+        } else {
+            rsp_msg.response.status = LOCK_TASK_STATUS_DOOR_CLOSE;
         }
- 
-        /*关锁*/
-        if (req_msg.request.type == LOCK_TASK_MSG_TYPE_LOCK_LOCK){ 
-            log_debug("lock lock...\r\n");
-            /*只有在没手动开门的情况下，才执行关锁操作*/
-            if (lock_controller.manual_switch.manual_unlock == false) {
-                bsp_lock_ctrl_close();
-            }
+        status = msg_pool_send(&lock_task_msg_pool,req_msg->request.rsp_message_queue_id,&rsp_msg,LOCK_TASK_PUT_MSG_TIMEOUT);
+        if (status != osOK) {
+            log_error("lock put door status msg err:%d.\r\n",status);
+        }
+        break;
 
-            utils_timer_init(&timer,LOCK_TASK_LOCK_TIMEOUT,false);
+    /*获取锁状态*/
+    case LOCK_TASK_MSG_TYPE_LOCK_STATUS:
+        rsp_msg.response.type = LOCK_TASK_MSG_TYPE_RSP_LOCK_STATUS;
 
-            while (utils_timer_value(&timer) > 0 && (lock_controller.lock_sensor.status != BSP_LOCK_STATUS_LOCKED || lock_controller.hole_sensor.status != BSP_HOLE_STATUS_CLOSE) ){
-                osDelay(10);
-            }
-            rsp_msg.response.type = LOCK_TASK_MSG_TYPE_RSP_LOCK_LOCK_RESULT;
-            if (lock_controller.lock_sensor.status == BSP_LOCK_STATUS_LOCKED && lock_controller.hole_sensor.status == BSP_HOLE_STATUS_CLOSE) {               
-                rsp_msg.response.result = LOCK_TASK_SUCCESS;
-                log_debug("lock success.\r\n");
-            } else {
-                /*如果关锁失败，就把锁打开*/
-                bsp_lock_ctrl_open();
-                rsp_msg.response.result = LOCK_TASK_FAIL;
-                log_error("lock fail.timeout.\r\n");
-            }
-   
-            status = osMessagePut(req_msg.request.rsp_message_queue_id,(uint32_t)&rsp_msg,LOCK_TASK_PUT_MSG_TIMEOUT);
-            if (status != osOK){
-                log_error("lock put lock msg err:%d.\r\n",status);
-            } 
+        if (lock_controller.lock_sensor.status == BSP_LOCK_STATUS_LOCKED) {
+            rsp_msg.response.status = LOCK_TASK_STATUS_LOCK_LOCKED;
+        } else {
+            rsp_msg.response.status = LOCK_TASK_STATUS_LOCK_UNLOCKED;
+        }
+        status = msg_pool_send(&lock_task_msg_pool,req_msg->request.rsp_message_queue_id,&rsp_msg,LOCK_TASK_PUT_MSG_TIMEOUT);
+        if (status != osOK) {
+            log_error("lock put door status msg err:%d.\r\n",status);
         }
+        break;
 
-        /*手动按键开锁*/
-        if (req_msg.request.type == LOCK_TASK_MSG_TYPE_MANUAL_UNLOCK_LOCK){ 
-            log_info("manual unlock lock...\r\n");
-            /*执行开锁操作*/
-            bsp_lock_ctrl_open();
+    /*开锁*/
+    case LOCK_TASK_MSG_TYPE_UNLOCK_LOCK:
+        lock_operation_start(req_msg,LOCK_TASK_UNLOCK_TIMEOUT);
+        break;
+
+    /*关锁*/
+    case LOCK_TASK_MSG_TYPE_LOCK_LOCK:
+        lock_operation_start(req_msg,LOCK_TASK_LOCK_TIMEOUT);
+        break;
+
+    /*传感器引脚稳定,采样*/
+    case LOCK_TASK_MSG_TYPE_SENSOR_DEBOUNCE_TIMEOUT:
+        if (lock_sensor_debounce_check() == false) {
+            break;
+        }
+        if (lock_controller_sensor_sample() == true) {
+            lock_operation_check();
         }
+        break;
 
-        /*手动按键关锁*/
-        if (req_msg.request.type == LOCK_TASK_MSG_TYPE_MANUAL_LOCK_LOCK){ 
+    /*开关锁操作超时*/
+    case LOCK_TASK_MSG_TYPE_OPERATION_TIMEOUT:
+        /*定时器停止之前已经发出的到期事件,忽略*/
+        if (lock_controller.operation.busy == true &&
+            osKernelSysTick() - lock_controller.operation.start >= lock_controller.operation.timeout / portTICK_PERIOD_MS) {
+            lock_operation_finish(false);
+        }
+        break;
+
+    /*手动按键松开后保持时间到,关锁*/
+    case LOCK_TASK_MSG_TYPE_MANUAL_UNLOCK_TIMEOUT:
+        if (lock_controller.manual_switch.manual_unlock == true && lock_controller.manual_switch.status != BSP_UNLOCK_SW_STATUS_PRESS) {
+            lock_controller.manual_switch.manual_unlock = false;
             log_info("manual lock lock...\r\n");
-            /*执行开锁操作*/
             bsp_lock_ctrl_close();
         }
+        break;
 
+    /*调试接口上锁*/
+    case LOCK_TASK_MSG_TYPE_DEBUG_LOCK_LOCK:
+        log_info("debug lock lock...\r\n");
+        /*执行上锁操作*/
+        bsp_lock_ctrl_close();
+        break;
 
-        /*调试接口上锁*/
-        if (req_msg.request.type == LOCK_TASK_MSG_TYPE_DEBUG_LOCK_LOCK){ 
-            log_info("debug lock lock...\r\n");
-            /*执行上锁操作*/
-            bsp_lock_ctrl_close();
-        }
+    /*调试接口开锁*/
+    case LOCK_TASK_MSG_TYPE_DEBUG_UNLOCK_LOCK:
+        log_info("debug unlock lock...\r\n");
+        /*执行开锁操作*/
+        bsp_lock_ctrl_open();
+        break;
 
-        /*调试接口开锁*/
-        if (req_msg.request.type == LOCK_TASK_MSG_TYPE_DEBUG_UNLOCK_LOCK){ 
-            log_info("debug unlock lock...\r\n");
-            /*执行开锁操作*/
-            bsp_lock_ctrl_open();
-        }
-   
- }
- 
- }
-}
\ No newline at end of file
+    default:
+        log_warning("lock unknown msg type:%d.\r\n",req_msg->request.type);
+        break;
+    }
+}
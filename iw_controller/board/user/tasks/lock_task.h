@@ -1,21 +1,23 @@
 #ifndef  __LOCK_TASK_H__
 #define  __LOCK_TASK_H__
+#include "msg_pool.h"
+#include "active_object.h"
 
 
 
-extern osThreadId   lock_task_hdl;
-extern osMessageQId lock_task_msg_q_id;
-void lock_task(void const * argument);
+extern osMessageQId    lock_task_msg_q_id;
+extern msg_pool_t      lock_task_msg_pool;
+extern active_object_t lock_task_ao;
 
 
-#define  LOCK_TASK_MSG_WAIT_TIMEOUT                 osWaitForever
+#define  LOCK_TASK_MSG_Q_SIZE                       7   /*消息队列深度:4个请求+3个定时器事件*/
+#define  LOCK_TASK_MSG_POOL_SIZE                    (LOCK_TASK_MSG_Q_SIZE + 5) /*消息池容量:请求+正在处理的事件+4个回应队列*/
 #define  LOCK_TASK_PUT_MSG_TIMEOUT                  5
 #define  LOCK_TASK_LOCK_TIMEOUT                     980
 #define  LOCK_TASK_UNLOCK_TIMEOUT                   980
-#define  LOCK_TASK_LOCK_CONTROLLER_TIMER_TIMEOUT    10
 
-/*状态稳定时间*/
-#define  LOCK_TASK_STATUS_HOLD_ON_TIME              100
+/*传感器引脚最后一次跳变后的稳定时间 单位:ms;触点抖动在几ms内结束*/
+#define  LOCK_TASK_SENSOR_DEBOUNCE_TIME             10
 /*手动开门保持时间*/
 #define  LOCK_TASK_MANUAL_UNLOCK_TIME               5000
 
@@ -41,10 +43,11 @@ enum
     LOCK_TASK_MSG_TYPE_RSP_UNLOCK_LOCK_RESULT,
     LOCK_TASK_MSG_TYPE_RSP_LOCK_STATUS,
     LOCK_TASK_MSG_TYPE_RSP_DOOR_STATUS,
-    LOCK_TASK_MSG_TYPE_MANUAL_LOCK_LOCK,
-    LOCK_TASK_MSG_TYPE_MANUAL_UNLOCK_LOCK,
     LOCK_TASK_MSG_TYPE_DEBUG_LOCK_LOCK,
-    LOCK_TASK_MSG_TYPE_DEBUG_UNLOCK_LOCK
+    LOCK_TASK_MSG_TYPE_DEBUG_UNLOCK_LOCK,
+    LOCK_TASK_MSG_TYPE_SENSOR_DEBOUNCE_TIMEOUT,
+    LOCK_TASK_MSG_TYPE_MANUAL_UNLOCK_TIMEOUT,
+    LOCK_TASK_MSG_TYPE_OPERATION_TIMEOUT
 };
 
 typedef struct
@@ -6,10 +6,15 @@
 #include "serial.h"
 #include "scale_task.h"
 #include "communication_task.h"
+#include "trace.h"
+#include "run_time_stats.h"
+#include "deadline.h"
 #include "log.h"
 
 extern int scale_serial_handle;
 extern serial_hal_driver_t nxp_serial_uart_hal_driver;
+/*电子秤任务消息池,所有电子秤任务共用*/
+MSG_POOL_DEF(scale_task_msg_pool,scale_task_message_t,SCALE_TASK_MSG_POOL_SIZE);
 
 typedef enum
 {
@@ -387,6 +392,7 @@ static int scale_task_poll(serial_handle_t *handle,uint8_t addr,uint8_t code,uin
         return -1;
     }
 
+    trace_user(TRACE_USER_SCALE_REQ,(uint16_t)addr << 8 | code);
     rc = send_adu(handle,adu_send,rc,ADU_SEND_TIMEOUT);
     if (rc != 0) {
         return -1;
@@ -394,10 +400,12 @@ static int scale_task_poll(serial_handle_t *handle,uint8_t addr,uint8_t code,uin
 
     rc = receive_adu(handle,adu_recv,timeout);
     if (rc <= 0) {
+        trace_user(TRACE_USER_SCALE_TIMEOUT,(uint16_t)addr << 8 | code);
         /*清空接收缓存*/
         serial_flush(handle);
         return -1;
     }
+    trace_user(TRACE_USER_SCALE_RSP,(uint16_t)addr << 8 | code);
     rc = parse_pdu((uint8_t *)&adu_recv[ADU_PDU_OFFSET],rc - ADU_HEAD_SIZE - ADU_PDU_SIZE_REGION_SIZE - ADU_CRC_SIZE,addr,code,rsp);
     if (rc < 0 ) {
         return -1;
@@ -406,6 +414,34 @@ static int scale_task_poll(serial_handle_t *handle,uint8_t addr,uint8_t code,uin
 }
  
 
+/*所有电子秤任务共用,取出请求到回应放入队列的截止时间统计*/
+DEADLINE_DEF(scale_task_deadline);
+
+/*
+* @brief 电子秤请求的截止时间
+* @param type 请求消息类型
+* @return 截止时间 单位:us
+* @note 发送时间加上receive_adu的最长时间:轮询超时内收到帧头后,PDU和CRC各还有一个帧间隔
+*/
+static uint32_t scale_task_deadline_limit(uint8_t type)
+{
+    uint32_t timeout;
+
+    switch (type) {
+        case SCALE_TASK_MSG_TYPE_NET_WEIGHT:
+            timeout = ADU_QUERY_WEIGHT_TIMEOUT;
+            break;
+        case SCALE_TASK_MSG_TYPE_REMOVE_TARE_WEIGHT:
+            timeout = ADU_REMOVE_TARE_TIMEOUT;
+            break;
+        default:
+            timeout = ADU_CALIBRATION_ZERO_TIMEOUT;
+            break;
+    }
+
+    return (timeout + 2 * ADU_FRAME_TIMEOUT + ADU_SEND_TIMEOUT) * 1000;
+}
+
 /*
 * @brief 电子秤任务
 * @param argument 任务参数
@@ -420,6 +456,7 @@ void scale_task(void const *argument)
     osEvent os_event;
     uint8_t req_value[2];
     uint8_t rsp_value[2];
+    uint32_t start;
 
     scale_task_message_t req_msg,net_weight_msg,remove_tare_msg,calibration_zero_msg,calibration_full_msg;
     scale_task_contex_t *task_contex;
@@ -428,7 +465,9 @@ void scale_task(void const *argument)
     while (1) {
         os_event = osMessageGet(task_contex->msg_q_id,SCALE_TASK_MSG_WAIT_TIMEOUT_VALUE);
         if (os_event.status == osEventMessage) {
+            start = run_time_stats_get_counter();
             req_msg = *(scale_task_message_t *)os_event.value.v;
+            msg_pool_free(&scale_task_msg_pool,os_event.value.p);
  
             /*获取净重值*/
             if (req_msg.request.type == SCALE_TASK_MSG_TYPE_NET_WEIGHT) { 
@@ -446,7 +485,7 @@ void scale_task(void const *argument)
                 net_weight_msg.response.index = req_msg.request.index;
                 net_weight_msg.response.flag = task_contex->flag;
 
-                status = osMessagePut(req_msg.request.rsp_message_queue_id,(uint32_t )&net_weight_msg,SCALE_TASK_PUT_MSG_TIMEOUT);
+                status = msg_pool_send(&scale_task_msg_pool,req_msg.request.rsp_message_queue_id,&net_weight_msg,SCALE_TASK_PUT_MSG_TIMEOUT);
                 if (status != osOK) {
                     log_error("put net weight msg err:%d.\r\n",status);
                 }  
@@ -466,7 +505,7 @@ void scale_task(void const *argument)
                 remove_tare_msg.response.index = req_msg.request.index;
                 remove_tare_msg.response.flag = task_contex->flag;
 
-                status = osMessagePut(req_msg.request.rsp_message_queue_id,(uint32_t )&remove_tare_msg,SCALE_TASK_PUT_MSG_TIMEOUT);
+                status = msg_pool_send(&scale_task_msg_pool,req_msg.request.rsp_message_queue_id,&remove_tare_msg,SCALE_TASK_PUT_MSG_TIMEOUT);
                 if (status != osOK) {
                     log_error("put net weight msg err:%d.\r\n",status);
                 }                      
@@ -487,7 +526,7 @@ void scale_task(void const *argument)
                 calibration_zero_msg.response.index = req_msg.request.index;
                 calibration_zero_msg.response.flag = task_contex->flag;
 
-                status = osMessagePut(req_msg.request.rsp_message_queue_id,(uint32_t )&calibration_zero_msg,SCALE_TASK_PUT_MSG_TIMEOUT);
+                status = msg_pool_send(&scale_task_msg_pool,req_msg.request.rsp_message_queue_id,&calibration_zero_msg,SCALE_TASK_PUT_MSG_TIMEOUT);
                 if (status != osOK) {
                     log_error("put calibration zero weight msg err:%d.\r\n",status);
                 }                             
@@ -508,11 +547,15 @@ void scale_task(void const *argument)
                 calibration_full_msg.response.index = req_msg.request.index;
                 calibration_full_msg.response.flag = task_contex->flag;
 
-                status = osMessagePut(req_msg.request.rsp_message_queue_id,(uint32_t )&calibration_full_msg,SCALE_TASK_PUT_MSG_TIMEOUT);
+                status = msg_pool_send(&scale_task_msg_pool,req_msg.request.rsp_message_queue_id,&calibration_full_msg,SCALE_TASK_PUT_MSG_TIMEOUT);
                 if (status != osOK) {
                     log_error("put calibration full weight msg err:%d.\r\n",status);
                 }                          
             }
+
+            if (deadline_check(&scale_task_deadline,run_time_stats_get_counter() - start,scale_task_deadline_limit(req_msg.request.type)) == true) {
+                log_warning("scale:%d type:%d miss deadline.\r\n",task_contex->internal_addr,req_msg.request.type);
+            }
         }
 
     }
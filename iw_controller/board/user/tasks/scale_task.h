@@ -1,10 +1,22 @@
 #ifndef  __SCALE_TASK_H__
 #define  __SCALE_TASK_H__
+#include "msg_pool.h"
+#include "deadline.h"
 
 extern osThreadId   scale_task_hdl;
+extern msg_pool_t   scale_task_msg_pool;
+extern deadline_t   scale_task_deadline;
 void scale_task(void const * argument);
 
 
+#define  SCALE_TASK_STACK_SIZE                256 /*任务栈大小 单位:word*/
+#define  SCALE_TASK_MSG_Q_SIZE                1   /*消息队列深度*/
+/*
+* 消息池容量,所有电子秤任务共用.每个请求在队列中和回应时各占一个消息块,电子秤任务处理时不占用.
+* 通信任务每次请求前和超时后清空全部回应队列,之后残留的回应最多来自清空时每个电子秤任务
+* 队列中和正在处理的请求,再加上本次请求.
+*/
+#define  SCALE_TASK_MSG_POOL_SIZE             (SCALE_CNT_MAX * (SCALE_TASK_MSG_Q_SIZE + 1) + SCALE_CNT_MAX)
 #define  SCALE_TASK_RX_BUFFER_SIZE            32
 #define  SCALE_TASK_TX_BUFFER_SIZE            32
 #define  SCALE_TASK_FRAME_SIZE_MAX            20
@@ -8,78 +8,267 @@
 #include "temperature_task.h"
 #include "compressor_task.h"
 #include "communication_task.h"
+#include "history_task.h"
+#include "env_task.h"
+#include "device_env.h"
+#include "deadline.h"
 #include "log.h"
 
+/**************************************************************************/
+/* 任务和消息队列的静态存储                                               */
+/**************************************************************************/
+/*控制线程:锁,ADC,温度,压缩机和看门狗活动对象*/
+static ACTIVE_OBJECT_THREAD_DEF(control_thread,TASKS_CONTROL_THREAD_DEADLINE);
+static uint32_t control_thread_stack[TASKS_CONTROL_THREAD_STACK_SIZE];
+static osStaticThreadDef_t control_thread_cb;
+
+/*调试线程:调试,历史记录和环境变量写回活动对象,命令处理和flash擦写可能阻塞,单独一个线程*/
+static ACTIVE_OBJECT_THREAD_DEF(debug_thread,0);
+static uint32_t debug_thread_stack[TASKS_DEBUG_THREAD_STACK_SIZE];
+static osStaticThreadDef_t debug_thread_cb;
+
+static uint8_t debug_task_msg_q_buffer[DEBUG_TASK_MSG_Q_SIZE * sizeof(uint32_t)];
+static osStaticMessageQDef_t debug_task_msg_q_cb;
+
+static uint8_t history_task_msg_q_buffer[HISTORY_TASK_MSG_Q_SIZE * sizeof(uint32_t)];
+static osStaticMessageQDef_t history_task_msg_q_cb;
+
+static uint8_t env_task_msg_q_buffer[ENV_TASK_MSG_Q_SIZE * sizeof(uint32_t)];
+static osStaticMessageQDef_t env_task_msg_q_cb;
+
+static uint8_t watch_dog_task_msg_q_buffer[WATCH_DOG_TASK_MSG_Q_SIZE * sizeof(uint32_t)];
+static osStaticMessageQDef_t watch_dog_task_msg_q_cb;
+
+static uint8_t lock_task_msg_q_buffer[LOCK_TASK_MSG_Q_SIZE * sizeof(uint32_t)];
+static osStaticMessageQDef_t lock_task_msg_q_cb;
+
+static uint8_t compressor_task_msg_q_buffer[COMPRESSOR_TASK_MSG_Q_SIZE * sizeof(uint32_t)];
+static osStaticMessageQDef_t compressor_task_msg_q_cb;
+
+static uint8_t adc_task_msg_q_buffer[ADC_TASK_MSG_Q_SIZE * sizeof(uint32_t)];
+static osStaticMessageQDef_t adc_task_msg_q_cb;
+
+static uint8_t temperature_task_msg_q_buffer[TEMPERATURE_TASK_MSG_Q_SIZE * sizeof(uint32_t)];
+static osStaticMessageQDef_t temperature_task_msg_q_cb;
+
+static uint32_t communication_task_stack[COMMUNICATION_TASK_STACK_SIZE];
+static osStaticThreadDef_t communication_task_cb;
+static uint8_t communication_task_msg_q_buffer[COMMUNICATION_TASK_MSG_Q_SIZE * sizeof(uint32_t)];
+static osStaticMessageQDef_t communication_task_msg_q_cb;
+
+/*任务消息池,按顺序注册*/
+static msg_pool_t * const tasks_msg_pool[] = {
+&scale_task_msg_pool,
+&lock_task_msg_pool,
+&temperature_task_msg_pool,
+&compressor_task_msg_pool,
+&adc_task_msg_pool,
+&watch_dog_task_msg_pool,
+&debug_task_msg_pool,
+&history_task_msg_pool,
+&env_task_msg_pool
+};
+
+#if  TASKS_MSG_POOL_CNT > MSG_POOL_CNT_MAX
+#error "MSG_POOL_CNT_MAX too small for tasks msg pools."
+#endif
+/*消息池表和TASKS_MSG_POOL_CNT不一致时编译失败*/
+typedef char tasks_msg_pool_cnt_check[(sizeof(tasks_msg_pool) / sizeof(tasks_msg_pool[0]) == TASKS_MSG_POOL_CNT) ? 1 : -1];
+
+
+/*
+* @brief 输出各子系统静态RTOS对象的RAM占用
+* @param 无
+* @return 无
+* @note 数值均为编译期常量;子系统的全部RAM(含串口缓存等)见链接map文件的MODULE SUMMARY
+*/
+static void tasks_ram_report(void)
+{
+    uint32_t size,total = 0;
+
+    size = TASKS_TASK_RAM_SIZE(TASKS_CONTROL_THREAD_STACK_SIZE) + TASKS_TASK_RAM_SIZE(TASKS_DEBUG_THREAD_STACK_SIZE);
+    total += size;
+    log_info("ram ao threads:%d bytes.\r\n",size);
+
+    size = TASKS_AO_RAM_SIZE + TASKS_MSG_Q_RAM_SIZE(DEBUG_TASK_MSG_Q_SIZE) + TASKS_AO_TIMER_RAM_SIZE + 
+           TASKS_MSG_POOL_RAM_SIZE(debug_task_message_t,DEBUG_TASK_MSG_POOL_SIZE);
+    total += size;
+    log_info("ram debug:%d bytes.\r\n",size);
+
+    size = TASKS_AO_RAM_SIZE + TASKS_MSG_Q_RAM_SIZE(HISTORY_TASK_MSG_Q_SIZE) + TASKS_AO_TIMER_RAM_SIZE + 
+           TASKS_MSG_POOL_RAM_SIZE(history_task_message_t,HISTORY_TASK_MSG_POOL_SIZE) + 
+           HISTORY_TASK_RAM_RECORD_CNT * sizeof(history_record_t);
+    total += size;
+    log_info("ram history:%d bytes.\r\n",size);
+
+    size = TASKS_AO_RAM_SIZE + TASKS_MSG_Q_RAM_SIZE(ENV_TASK_MSG_Q_SIZE) + TASKS_AO_TIMER_RAM_SIZE + 
+           TASKS_MSG_POOL_RAM_SIZE(env_task_message_t,ENV_TASK_MSG_POOL_SIZE);
+    total += size;
+    log_info("ram env:%d bytes.\r\n",size);
+
+    size = TASKS_AO_RAM_SIZE + TASKS_MSG_Q_RAM_SIZE(WATCH_DOG_TASK_MSG_Q_SIZE) + TASKS_AO_TIMER_RAM_SIZE + 
+           TASKS_MSG_POOL_RAM_SIZE(watch_dog_task_message_t,WATCH_DOG_TASK_MSG_POOL_SIZE);
+    total += size;
+    log_info("ram watch dog:%d bytes.\r\n",size);
+
+    size = TASKS_AO_RAM_SIZE + TASKS_MSG_Q_RAM_SIZE(LOCK_TASK_MSG_Q_SIZE) + TASKS_AO_TIMER_RAM_SIZE * 3 + 
+           TASKS_MSG_POOL_RAM_SIZE(lock_task_message_t,LOCK_TASK_MSG_POOL_SIZE);
+    total += size;
+    log_info("ram lock:%d bytes.\r\n",size);
+
+    size = TASKS_AO_RAM_SIZE + TASKS_MSG_Q_RAM_SIZE(COMPRESSOR_TASK_MSG_Q_SIZE) + TASKS_AO_TIMER_RAM_SIZE * 2 + 
+           TASKS_MSG_POOL_RAM_SIZE(compressor_task_message_t,COMPRESSOR_TASK_MSG_POOL_SIZE);
+    total += size;
+    log_info("ram compressor:%d bytes.\r\n",size);
+
+    size = TASKS_AO_RAM_SIZE * 2 + TASKS_MSG_Q_RAM_SIZE(ADC_TASK_MSG_Q_SIZE) + TASKS_AO_TIMER_RAM_SIZE * 2 + 
+           TASKS_MSG_POOL_RAM_SIZE(adc_task_message_t,ADC_TASK_MSG_POOL_SIZE) + ADC_TASK_DMA_RAM_SIZE + 
+           TASKS_MSG_Q_RAM_SIZE(TEMPERATURE_TASK_MSG_Q_SIZE) + 
+           TASKS_MSG_POOL_RAM_SIZE(temperature_task_message_t,TEMPERATURE_TASK_MSG_POOL_SIZE);
+    total += size;
+    log_info("ram adc and temperature:%d bytes.\r\n",size);
+
+    size = TASKS_TASK_RAM_SIZE(COMMUNICATION_TASK_STACK_SIZE) + TASKS_MSG_Q_RAM_SIZE(COMMUNICATION_TASK_MSG_Q_SIZE) + 
+           COMMUNICATION_TASK_RSP_MSG_Q_RAM_SIZE;
+    total += size;
+    log_info("ram communication:%d bytes.\r\n",size);
+
+    size = SCALE_CNT_MAX * (TASKS_TASK_RAM_SIZE(SCALE_TASK_STACK_SIZE) + TASKS_MSG_Q_RAM_SIZE(SCALE_TASK_MSG_Q_SIZE)) + 
+           TASKS_MSG_POOL_RAM_SIZE(scale_task_message_t,SCALE_TASK_MSG_POOL_SIZE);
+    total += size;
+    log_info("ram scale:%d bytes.\r\n",size);
+
+    size = TASKS_TASK_RAM_SIZE(configMINIMAL_STACK_SIZE) + TASKS_TASK_RAM_SIZE(configTIMER_TASK_STACK_DEPTH);
+    total += size;
+    log_info("ram kernel:%d bytes.\r\n",size);
+
+    log_info("ram total:%d bytes.heap:%d free:%d bytes.\r\n",total,configTOTAL_HEAP_SIZE,xPortGetFreeHeapSize());
+}
+
 /*
 * @brief 任务初始化
 * @param 无
 * @return 无
-* @note
+* @note 所有任务,消息队列和定时器均使用静态存储,不占用heap
 */
 
 void tasks_init(void)
 {
+    int rc;
+
+    /**************************************************************************/  
+    /* 任务消息池                                                             */
+    /**************************************************************************/  
+    for (uint8_t i = 0;i < TASKS_MSG_POOL_CNT;i ++) {
+        rc = msg_pool_init(tasks_msg_pool[i]);
+        log_assert(rc == 0);
+    }
+
+    /**************************************************************************/  
+    /* 截止时间统计                                                           */
+    /**************************************************************************/  
+    rc = deadline_init(&communication_task_deadline);
+    log_assert(rc == 0);
+    rc = deadline_init(&scale_task_deadline);
+    log_assert(rc == 0);
+    rc = deadline_init(&control_thread.deadline);
+    log_assert(rc == 0);
+
     /**************************************************************************/  
     /* 任务消息队列                                                           */
     /**************************************************************************/  
 
     /*通信消息队列*/
-    osMessageQDef(communication_task_msg_q,4,uint32_t);
+    osMessageQStaticDef(communication_task_msg_q,COMMUNICATION_TASK_MSG_Q_SIZE,uint32_t,communication_task_msg_q_buffer,&communication_task_msg_q_cb);
     communication_task_msg_q_id = osMessageCreate(osMessageQ(communication_task_msg_q),0);
     log_assert(communication_task_msg_q_id);
 
     /*温度消息队列*/
-    osMessageQDef(temperature_task_msg_q,4,uint32_t);
+    osMessageQStaticDef(temperature_task_msg_q,TEMPERATURE_TASK_MSG_Q_SIZE,uint32_t,temperature_task_msg_q_buffer,&temperature_task_msg_q_cb);
     temperature_task_msg_q_id = osMessageCreate(osMessageQ(temperature_task_msg_q),0);
     log_assert(temperature_task_msg_q_id);
 
     /*压缩机消息队列*/
-    osMessageQDef(compressor_task_msg_q,4,uint32_t);
+    osMessageQStaticDef(compressor_task_msg_q,COMPRESSOR_TASK_MSG_Q_SIZE,uint32_t,compressor_task_msg_q_buffer,&compressor_task_msg_q_cb);
     compressor_task_msg_q_id = osMessageCreate(osMessageQ(compressor_task_msg_q),0);
     log_assert(compressor_task_msg_q_id);
 
     /*锁控消息队列*/
-    osMessageQDef(lock_task_msg_q,4,uint32_t);
+    osMessageQStaticDef(lock_task_msg_q,LOCK_TASK_MSG_Q_SIZE,uint32_t,lock_task_msg_q_buffer,&lock_task_msg_q_cb);
     lock_task_msg_q_id = osMessageCreate(osMessageQ(lock_task_msg_q),0);
     log_assert(lock_task_msg_q_id);
 
+    /*ADC消息队列*/
+    osMessageQStaticDef(adc_task_msg_q,ADC_TASK_MSG_Q_SIZE,uint32_t,adc_task_msg_q_buffer,&adc_task_msg_q_cb);
+    adc_task_msg_q_id = osMessageCreate(osMessageQ(adc_task_msg_q),0);
+    log_assert(adc_task_msg_q_id);
+
+    /*看门狗消息队列*/
+    osMessageQStaticDef(watch_dog_task_msg_q,WATCH_DOG_TASK_MSG_Q_SIZE,uint32_t,watch_dog_task_msg_q_buffer,&watch_dog_task_msg_q_cb);
+    watch_dog_task_msg_q_id = osMessageCreate(osMessageQ(watch_dog_task_msg_q),0);
+    log_assert(watch_dog_task_msg_q_id);
+
+    /*调试消息队列*/
+    osMessageQStaticDef(debug_task_msg_q,DEBUG_TASK_MSG_Q_SIZE,uint32_t,debug_task_msg_q_buffer,&debug_task_msg_q_cb);
+    debug_task_msg_q_id = osMessageCreate(osMessageQ(debug_task_msg_q),0);
+    log_assert(debug_task_msg_q_id);
+
+    /*历史记录消息队列*/
+    osMessageQStaticDef(history_task_msg_q,HISTORY_TASK_MSG_Q_SIZE,uint32_t,history_task_msg_q_buffer,&history_task_msg_q_cb);
+    history_task_msg_q_id = osMessageCreate(osMessageQ(history_task_msg_q),0);
+    log_assert(history_task_msg_q_id);
+
+    /*环境变量写回消息队列*/
+    osMessageQStaticDef(env_task_msg_q,ENV_TASK_MSG_Q_SIZE,uint32_t,env_task_msg_q_buffer,&env_task_msg_q_cb);
+    env_task_msg_q_id = osMessageCreate(osMessageQ(env_task_msg_q),0);
+    log_assert(env_task_msg_q_id);
+
+    /**************************************************************************/  
+    /* 活动对象                                                               */
+    /**************************************************************************/  
+    /*按处理优先级顺序挂到控制线程*/
+    rc = active_object_init(&control_thread,&lock_task_ao,lock_task_msg_q_id);
+    log_assert(rc == 0);
+    rc = active_object_init(&control_thread,&adc_task_ao,adc_task_msg_q_id);
+    log_assert(rc == 0);
+    rc = active_object_init(&control_thread,&temperature_task_ao,temperature_task_msg_q_id);
+    log_assert(rc == 0);
+    rc = active_object_init(&control_thread,&compressor_task_ao,compressor_task_msg_q_id);
+    log_assert(rc == 0);
+    rc = active_object_init(&control_thread,&watch_dog_task_ao,watch_dog_task_msg_q_id);
+    log_assert(rc == 0);
+
+    rc = active_object_init(&debug_thread,&debug_task_ao,debug_task_msg_q_id);
+    log_assert(rc == 0);
+    rc = active_object_init(&debug_thread,&history_task_ao,history_task_msg_q_id);
+    log_assert(rc == 0);
+    rc = active_object_init(&debug_thread,&env_task_ao,env_task_msg_q_id);
+    log_assert(rc == 0);
+
+#if  DEVICE_ENV_USE_WRITE_BACK > 0
+    /*之后的环境变量设置由写回活动对象保存*/
+    rc = device_env_write_back_enable(env_task_dirty);
+    log_assert(rc == 0);
+#endif
+
     /**************************************************************************/  
     /* 任务创建                                                               */
     /**************************************************************************/  
-    /*调试任务*/
-    osThreadDef(debug_task, debug_task, osPriorityNormal, 0, 256);
-    debug_task_hdl = osThreadCreate(osThread(debug_task), NULL);
-    log_assert(debug_task_hdl);
-
-    /*看门狗任务*/
-    osThreadDef(watch_dog_task, watch_dog_task, osPriorityNormal, 0, 256);
-    watch_dog_task_hdl = osThreadCreate(osThread(watch_dog_task), NULL);
-    log_assert(watch_dog_task_hdl);
-
-    /*锁控任务*/
-    osThreadDef(lock_task, lock_task, osPriorityNormal, 0, 256);
-    lock_task_hdl = osThreadCreate(osThread(lock_task), NULL);
-    log_assert(lock_task_hdl);
-
-    /*压缩机任务*/
-    osThreadDef(compressor_task, compressor_task, osPriorityNormal, 0, 256);
-    compressor_task_hdl = osThreadCreate(osThread(compressor_task), NULL);
-    log_assert(compressor_task_hdl);
-
-    /*ADC任务*/
-    osThreadDef(adc_task, adc_task, osPriorityNormal, 0, 256);
-    adc_task_hdl = osThreadCreate(osThread(adc_task), NULL);
-    log_assert(adc_task_hdl);
-
-    /*温度任务*/
-    osThreadDef(temperature_task, temperature_task, osPriorityNormal, 0, 256);
-    temperature_task_hdl = osThreadCreate(osThread(temperature_task), NULL);
-    log_assert(temperature_task_hdl);
+    /*调试线程*/
+    osThreadStaticDef(debug_thread, active_object_thread, TASKS_DEBUG_THREAD_PRIORITY, 0, TASKS_DEBUG_THREAD_STACK_SIZE, debug_thread_stack, &debug_thread_cb);
+    debug_thread.hdl = osThreadCreate(osThread(debug_thread), &debug_thread);
+    log_assert(debug_thread.hdl);
+
+    /*控制线程*/
+    osThreadStaticDef(control_thread, active_object_thread, TASKS_CONTROL_THREAD_PRIORITY, 0, TASKS_CONTROL_THREAD_STACK_SIZE, control_thread_stack, &control_thread_cb);
+    control_thread.hdl = osThreadCreate(osThread(control_thread), &control_thread);
+    log_assert(control_thread.hdl);
 
     /*主控器通信任务*/
-    osThreadDef(communication_task, communication_task, osPriorityNormal, 0, 400);
+    osThreadStaticDef(communication_task, communication_task, TASKS_COMMUNICATION_PRIORITY, 0, COMMUNICATION_TASK_STACK_SIZE, communication_task_stack, &communication_task_cb);
     communication_task_hdl = osThreadCreate(osThread(communication_task), NULL);
     log_assert(communication_task_hdl);
 
+    tasks_ram_report();
 }
 
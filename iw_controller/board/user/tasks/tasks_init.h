@@ -2,6 +2,7 @@
 #define  __TASKS_INIT_H__
 
 #include "stdint.h"
+#include "active_object.h"
 
 
 #ifdef  __cplusplus
@@ -14,6 +15,44 @@
 
 TASKS_BEGIN
 
+/*
+* 优先级和截止时间模型
+* 按速率单调原则分配:截止时间越短优先级越高,同优先级不时间片轮转(configUSE_TIME_SLICING=0)
+* 优先级                   任务                   作业和截止时间
+* osPriorityRealtime       FreeRTOS定时器服务     内核
+* osPriorityHigh           主机通信任务           收到末字节到回应发送完成,子系统等待超时+帧间隔+发送超时
+* osPriorityHigh           电子秤任务             取出请求到回应放入队列,轮询超时+2个帧间隔+发送超时(净重46ms)
+* osPriorityNormal         控制线程               单个事件处理TASKS_CONTROL_THREAD_DEADLINE
+* osPriorityLow            调试线程               无,命令处理(日志导出)可以长时间占用
+* 串口收发由中断完成,高优先级任务每个作业只占用很短的CPU时间,大部分时间阻塞在串口和消息队列上;
+* 控制线程的长事件只推迟调试线程,不会推迟主机链路和电子秤.超时次数通过debug命令deadline查看.
+*/
+#define  TASKS_COMMUNICATION_PRIORITY              osPriorityHigh
+#define  TASKS_SCALE_PRIORITY                      osPriorityHigh
+#define  TASKS_CONTROL_THREAD_PRIORITY             osPriorityNormal
+#define  TASKS_DEBUG_THREAD_PRIORITY               osPriorityLow
+
+#define  TASKS_CONTROL_THREAD_DEADLINE             20 /*控制线程单个事件处理的截止时间 单位:ms*/
+
+/*活动对象线程栈大小 单位:word*/
+#define  TASKS_CONTROL_THREAD_STACK_SIZE           384 /*锁,ADC,温度,压缩机和看门狗共用,一次只运行一个事件处理*/
+#define  TASKS_DEBUG_THREAD_STACK_SIZE             256
+
+#define  TASKS_MSG_POOL_CNT                        9  /*tasks_init注册的消息池数量*/
+
+/*静态分配的RTOS对象RAM占用,编译期计算 单位:byte*/
+#define  TASKS_TASK_RAM_SIZE(stack_size)           ((stack_size) * sizeof(uint32_t) + sizeof(StaticTask_t))
+#define  TASKS_MSG_Q_RAM_SIZE(q_size)              ((q_size) * sizeof(uint32_t) + sizeof(StaticQueue_t))
+#define  TASKS_AO_RAM_SIZE                         (sizeof(active_object_t))
+#define  TASKS_AO_TIMER_RAM_SIZE                   (sizeof(active_object_timer_t))
+#define  TASKS_MSG_POOL_RAM_SIZE(type,cnt)         (sizeof(type) * (cnt) + sizeof(msg_pool_t))
+
+/*
+* @brief 任务初始化
+* @param 无
+* @return 无
+* @note 所有任务,消息队列和定时器均使用静态存储,不占用heap
+*/
 void tasks_init(void);
 
 
@@ -0,0 +1,104 @@
+#include "stdint.h"
+#include "stdbool.h"
+#include "temperature_filter.h"
+#include "log.h"
+
+
+/*
+* @brief 滤波器初始化
+* @param filter 滤波器
+* @param median_size 中值窗口长度,奇数
+* @param iir_shift IIR系数1/2^iir_shift
+* @return -1 参数错误
+* @return  0 成功
+* @note
+*/
+int temperature_filter_init(temperature_filter_t *filter,uint8_t median_size,uint8_t iir_shift)
+{
+    if (median_size == 0 || median_size > TEMPERATURE_FILTER_MEDIAN_SIZE_MAX || (median_size & 1) == 0) {
+        log_error("filter median size:%d invalid.\r\n",median_size);
+        return -1;
+    }
+    if (iir_shift > TEMPERATURE_FILTER_IIR_SHIFT_MAX) {
+        log_error("filter iir shift:%d invalid.\r\n",iir_shift);
+        return -1;
+    }
+    filter->median_size = median_size;
+    filter->iir_shift = iir_shift;
+    temperature_filter_reset(filter);
+
+    return 0;
+}
+
+/*
+* @brief 清空滤波器历史
+* @param filter 滤波器
+* @return 无
+* @note 传感器错误恢复后重新开始
+*/
+void temperature_filter_reset(temperature_filter_t *filter)
+{
+    filter->cnt = 0;
+    filter->oldest = 0;
+    filter->iir = 0;
+    filter->iir_valid = false;
+}
+
+/*
+* @brief 滑动中值
+* @param filter 滤波器
+* @param value 输入值
+* @return 窗口中值
+* @note 删除最早的值后把新值插入有序数组,窗口长度有上限,每次最多移动TEMPERATURE_FILTER_MEDIAN_SIZE_MAX个值
+*/
+static int16_t temperature_filter_median(temperature_filter_t *filter,int16_t value)
+{
+    uint8_t i;
+    int16_t old;
+
+    if (filter->cnt < filter->median_size) {
+        filter->window[filter->cnt] = value;
+        i = filter->cnt ++;
+    } else {
+        old = filter->window[filter->oldest];
+        filter->window[filter->oldest] = value;
+        filter->oldest = filter->oldest + 1 >= filter->median_size ? 0 : filter->oldest + 1;
+        /*删除最早的值*/
+        for (i = 0;filter->sorted[i] != old;i ++);
+        for (;i + 1 < filter->cnt;i ++) {
+            filter->sorted[i] = filter->sorted[i + 1];
+        }
+    }
+    /*插入新值,i为空位*/
+    for (;i > 0 && filter->sorted[i - 1] > value;i --) {
+        filter->sorted[i] = filter->sorted[i - 1];
+    }
+    filter->sorted[i] = value;
+
+    return filter->sorted[filter->cnt / 2];
+}
+
+/*
+* @brief 输入一个值并输出滤波结果
+* @param filter 滤波器
+* @param value 输入值
+* @return 滤波结果
+* @note 窗口没有填满时取已有值的中值
+*/
+int16_t temperature_filter_put(temperature_filter_t *filter,int16_t value)
+{
+    int32_t x;
+
+    x = (int32_t)temperature_filter_median(filter,value) << TEMPERATURE_FILTER_IIR_FRAC_BITS;
+    if (filter->iir_valid == false) {
+        filter->iir = x;
+        filter->iir_valid = true;
+    } else {
+        /*y += (x - y) / 2^shift,除法向0取整,正负对称*/
+        filter->iir += (x - filter->iir) / (1 << filter->iir_shift);
+    }
+    /*四舍五入去掉小数位*/
+    x = filter->iir + (filter->iir >= 0 ? 1 << (TEMPERATURE_FILTER_IIR_FRAC_BITS - 1) : -(1 << (TEMPERATURE_FILTER_IIR_FRAC_BITS - 1)));
+
+    return (int16_t)(x / (1 << TEMPERATURE_FILTER_IIR_FRAC_BITS));
+}
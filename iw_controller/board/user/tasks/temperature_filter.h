@@ -0,0 +1,67 @@
+#ifndef  __TEMPERATURE_FILTER_H__
+#define  __TEMPERATURE_FILTER_H__
+#include "stdint.h"
+#include "stdbool.h"
+
+#ifdef  __cplusplus
+#define TEMPERATURE_FILTER_BEGIN  extern "C" {
+#define TEMPERATURE_FILTER_END    }
+#else
+#define TEMPERATURE_FILTER_BEGIN
+#define TEMPERATURE_FILTER_END
+#endif
+
+
+TEMPERATURE_FILTER_BEGIN
+
+#define  TEMPERATURE_FILTER_MEDIAN_SIZE_MAX        9 /*中值窗口最大长度*/
+#define  TEMPERATURE_FILTER_IIR_SHIFT_MAX          6 /*IIR系数最小为1/2^6*/
+#define  TEMPERATURE_FILTER_IIR_FRAC_BITS          8 /*IIR状态的小数位数*/
+
+/*中值加一阶IIR滤波器,输入输出单位相同*/
+typedef struct
+{
+    uint8_t median_size;                           /*中值窗口长度,奇数,1:不做中值*/
+    uint8_t iir_shift;                             /*IIR系数1/2^iir_shift,0:不做IIR*/
+    uint8_t cnt;                                   /*窗口内的数量*/
+    uint8_t oldest;                                /*最早输入在window中的位置*/
+    int16_t window[TEMPERATURE_FILTER_MEDIAN_SIZE_MAX];/*按输入顺序*/
+    int16_t sorted[TEMPERATURE_FILTER_MEDIAN_SIZE_MAX];/*按大小顺序*/
+    int32_t iir;                                   /*IIR状态,带TEMPERATURE_FILTER_IIR_FRAC_BITS位小数*/
+    bool    iir_valid;
+}temperature_filter_t;
+
+
+/*
+* @brief 滤波器初始化
+* @param filter 滤波器
+* @param median_size 中值窗口长度,奇数
+* @param iir_shift IIR系数1/2^iir_shift
+* @return -1 参数错误
+* @return  0 成功
+* @note
+*/
+int temperature_filter_init(temperature_filter_t *filter,uint8_t median_size,uint8_t iir_shift);
+
+/*
+* @brief 清空滤波器历史
+* @param filter 滤波器
+* @return 无
+* @note 传感器错误恢复后重新开始
+*/
+void temperature_filter_reset(temperature_filter_t *filter);
+
+/*
+* @brief 输入一个值并输出滤波结果
+* @param filter 滤波器
+* @param value 输入值
+* @return 滤波结果
+* @note 窗口没有填满时取已有值的中值
+*/
+int16_t temperature_filter_put(temperature_filter_t *filter,int16_t value);
+
+
+
+TEMPERATURE_FILTER_END
+
+#endif
@@ -0,0 +1,29 @@
+#include "stdint.h"
+#include "temperature_table.h"
+
+
+/*
+* @brief 查表得到温度
+* @param table 查找表
+* @param adc adc数值
+* @param t 温度 单位:0.01C
+* @return -1 超出表的范围
+* @return  0 成功
+* @note 相邻两项之间整数线性插值
+*/
+int temperature_table_lookup(const temperature_table_t *table,uint16_t adc,int16_t *t)
+{
+    uint16_t index,frac;
+    uint32_t diff;
+
+    if (adc < table->adc_min || adc > table->adc_max) {
+        return -1;
+    }
+    index = (adc >> table->shift) - table->base;
+    frac = adc & ((1U << table->shift) - 1);
+    /*表单调递增*/
+    diff = table->value[index + 1] - table->value[index];
+    *t = table->value[index] + (int16_t)((diff * frac + (1U << (table->shift - 1))) >> table->shift);
+
+    return 0;
+}
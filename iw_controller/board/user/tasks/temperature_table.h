@@ -0,0 +1,47 @@
+#ifndef  __TEMPERATURE_TABLE_H__
+#define  __TEMPERATURE_TABLE_H__
+#include "stdint.h"
+
+#ifdef  __cplusplus
+#define TEMPERATURE_TABLE_BEGIN  extern "C" {
+#define TEMPERATURE_TABLE_END    }
+#else
+#define TEMPERATURE_TABLE_BEGIN
+#define TEMPERATURE_TABLE_END
+#endif
+
+
+TEMPERATURE_TABLE_BEGIN
+
+/*adc数值到温度的查找表,由tools/ntc_table.py按探头的阻温曲线和分压电阻生成*/
+typedef struct
+{
+    const char    *name;
+    uint16_t      adc_min;                         /*表内最小的有效adc数值*/
+    uint16_t      adc_max;                         /*表内最大的有效adc数值*/
+    uint8_t       shift;                           /*相邻两项间隔2^shift个adc数值*/
+    uint16_t      base;                            /*第0项对应的adc数值>>shift*/
+    uint16_t      size;
+    const int16_t *value;                          /*温度 单位:0.01C,单调递增*/
+}temperature_table_t;
+
+/*生成的表*/
+extern const temperature_table_t temperature_table_ntc;
+
+
+/*
+* @brief 查表得到温度
+* @param table 查找表
+* @param adc adc数值
+* @param t 温度 单位:0.01C
+* @return -1 超出表的范围
+* @return  0 成功
+* @note 相邻两项之间整数线性插值
+*/
+int temperature_table_lookup(const temperature_table_t *table,uint16_t adc,int16_t *t);
+
+
+
+TEMPERATURE_TABLE_END
+
+#endif
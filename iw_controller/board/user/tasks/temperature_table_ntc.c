@@ -0,0 +1,56 @@
+/*
+* 由tools/ntc_table.py生成,不要手动修改
+* 阻温表,分压电阻或者ADC参数变化后重新生成
+*/
+#include "temperature_table.h"
+
+
+/*第i项为adc数值(base + i) << shift时的温度,与浮点算法最大误差0.0400C(adc:3694)*/
+static const int16_t temperature_table_ntc_value[360] = {
+ -2016, -1996, -1975, -1954, -1933, -1913, -1893, -1873, -1853, -1833,
+ -1813, -1794, -1774, -1754, -1735, -1716, -1697, -1678, -1658, -1640,
+ -1621, -1602, -1583, -1564, -1546, -1528, -1509, -1491, -1472, -1454,
+ -1436, -1418, -1400, -1382, -1364, -1346, -1328, -1311, -1293, -1275,
+ -1257, -1239, -1222, -1205, -1187, -1170, -1152, -1135, -1118, -1102,
+ -1084, -1067, -1050, -1033, -1016, -1000,  -983,  -966,  -949,  -932,
+  -916,  -900,  -883,  -866,  -849,  -833,  -816,  -800,  -783,  -767,
+  -750,  -734,  -718,  -702,  -685,  -669,  -653,  -636,  -620,  -605,
+  -588,  -572,  -556,  -540,  -524,  -508,  -492,  -476,  -460,  -444,
+  -428,  -412,  -397,  -381,  -364,  -349,  -333,  -317,  -302,  -286,
+  -270,  -254,  -238,  -222,  -207,  -191,  -175,  -159,  -143,  -128,
+  -112,   -97,   -81,   -65,   -49,   -34,   -18,    -3,    13,    29,
+    45,    60,    76,    91,   107,   123,   139,   154,   170,   185,
+   201,   217,   233,   249,   264,   280,   295,   311,   327,   343,
+   358,   374,   389,   405,   421,   437,   453,   469,   484,   500,
+   517,   533,   548,   564,   580,   596,   612,   628,   645,   661,
+   676,   692,   708,   725,   741,   758,   774,   789,   806,   822,
+   839,   855,   872,   888,   904,   921,   937,   954,   970,   987,
+  1003,  1020,  1037,  1054,  1071,  1088,  1104,  1121,  1138,  1155,
+  1172,  1189,  1205,  1223,  1240,  1258,  1275,  1292,  1309,  1327,
+  1345,  1362,  1379,  1396,  1414,  1432,  1450,  1468,  1485,  1503,
+  1521,  1539,  1557,  1575,  1593,  1611,  1630,  1649,  1667,  1685,
+  1704,  1723,  1741,  1760,  1778,  1797,  1817,  1836,  1855,  1874,
+  1893,  1912,  1931,  1951,  1970,  1990,  2010,  2030,  2050,  2069,
+  2089,  2110,  2130,  2150,  2170,  2190,  2211,  2232,  2254,  2274,
+  2295,  2316,  2337,  2359,  2380,  2401,  2424,  2446,  2467,  2490,
+  2512,  2534,  2556,  2578,  2600,  2623,  2647,  2669,  2693,  2716,
+  2740,  2764,  2787,  2811,  2835,  2859,  2882,  2907,  2933,  2957,
+  2983,  3007,  3033,  3058,  3084,  3109,  3136,  3162,  3189,  3215,
+  3243,  3270,  3297,  3326,  3353,  3381,  3409,  3438,  3466,  3495,
+  3523,  3553,  3583,  3612,  3644,  3674,  3704,  3735,  3769,  3800,
+  3833,  3865,  3896,  3930,  3964,  3995,  4031,  4064,  4100,  4135,
+  4172,  4208,  4245,  4282,  4319,  4357,  4395,  4434,  4474,  4512,
+  4553,  4591,  4634,  4675,  4720,  4763,  4807,  4853,  4897,  4943,
+  4989,  5037,  5085,  5135,  5185,  5232,  5284,  5339,  5391,  5448,
+  5500,  5559,  5615,  5675,  5740,  5800,  5863,  5928,  5994,  6061,
+};
+
+const temperature_table_t temperature_table_ntc = {
+.name = "ntc",
+.adc_min = 871,
+.adc_max = 3728,
+.shift = 3,
+.base = 108,
+.size = 360,
+.value = temperature_table_ntc_value
+};
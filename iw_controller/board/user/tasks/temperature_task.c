@@ -2,259 +2,318 @@
 #include "tasks_init.h"
 #include "stdio.h"
 #include "stdbool.h"
+#include "stdlib.h"
 #include "adc_task.h"
 #include "compressor_task.h"
+#include "history_task.h"
 #include "temperature_task.h"
+#include "temperature_table.h"
+#include "temperature_filter.h"
+#include "device_env.h"
 #include "log.h"
 
-/*任务句柄*/
-osThreadId   temperature_task_hdl;
 /*消息句柄*/
 osMessageQId temperature_task_msg_q_id;
+/*消息池*/
+MSG_POOL_DEF(temperature_task_msg_pool,temperature_task_message_t,TEMPERATURE_TASK_MSG_POOL_SIZE);
 
+static void temperature_task_init(active_object_t *ao);
+static void temperature_task_handler(active_object_t *ao,const void *event);
+/*温度活动对象*/
+ACTIVE_OBJECT_DEF(temperature_task_ao,temperature_task_init,temperature_task_handler,&temperature_task_msg_pool);
 
-/**/
-static int16_t const t_r_map[][2]={
-  {-22,21180},{-21,20010},{-20,18900},{-19,17870},{-18,16900},{-17,15980},{-16,15120},{-15,14310},{-14,13550},{-13,12830},
-  {-12,12160},{-11,11520},{-10,10920},{-9,10350} ,{-8,9820}  ,{-7,9316}  ,{-6,8841}  ,{-5,8392}  ,{-4,7968}  ,{-3 ,7568},
-  {-2 ,7190} ,{-1,6833}  ,{0,6495}   ,{1,6175 }  ,{2,5873 }  ,{3,5587 }  ,{4,5315}   ,{5,5060}   ,{6,4818}   ,{7,4589}  ,
-  {8,4372}   ,{9,4167}   ,{10,3972}  ,{11,3788}  ,{12,3613}  ,{13,3447}  ,{14,3290}  ,{15,3141}  ,{16,2999}  ,{17,2865} ,
-  {18,2737}  ,{19,2616}  ,{20,2501}  ,{21,2391}  ,{22,2287}  ,{23,2188}  ,{24,2094}  ,{25,2005}  ,{26,1919}  ,{27,1838} ,
-  {28,1761}  ,{29,1687}  ,{30,1617}  ,{31,1550}  ,{32,1486}  ,{33,1426}  ,{34,1368}  ,{35,1312}  ,{36,1259}  ,{37,1209} ,
-  {38,1161}  ,{39,1115}  ,{40,1071}  ,{41,1029}  ,{42,989}   ,{43,951}   ,{44,914}   ,{45,879}   ,{46,845}   ,{47,813}  ,
-  {48,783}   ,{49,753}   ,{50,725}   ,{51,698}   ,{52,672}   ,{53,647}   ,{54,624}   ,{55,601}   ,{56,579}   ,{57,559}  ,
-  {58,539}   ,{59,520}   ,{60,502}   ,{61,484}   ,{62,467}   ,{63,451}   ,{64,435}   ,{65,421}   ,{66,406}   ,{67,392}
-};
 
-#define  TR_MAP_IDX_MIN        2
-#define  TR_MAP_IDX_MAX        82
+/*探头配置*/
+typedef struct
+{
+    const char                *name;
+    const temperature_table_t *table;
+    int16_t                   compensation;/*温度补偿值 单位:0.01C*/
+    int16_t                   alarm_min;   /*低于此值报警 单位:0.01C*/
+    int16_t                   alarm_max;   /*高于此值报警 单位:0.01C*/
+}temperature_probe_config_t;
+
+static const temperature_probe_config_t temperature_probe_config[TEMPERATURE_PROBE_CNT] = {
+{ "cabinet",   &temperature_table_ntc,TEMPERATURE_COMPENSATION_VALUE,TEMPERATURE_ALARM_VALUE_MIN * 100,TEMPERATURE_ALARM_VALUE_MAX * 100 },
+{ "evaporator",&temperature_table_ntc,0,TEMPERATURE_EVAPORATOR_ALARM_VALUE_MIN * 100,TEMPERATURE_EVAPORATOR_ALARM_VALUE_MAX * 100 }
+};
 
 typedef struct
 {
-    float value_float;
+    int16_t value;/*温度 单位:0.01C*/
     int16_t value_int;
     int8_t dir;
     uint8_t err_cnt;
     bool err;
     bool change;
+    temperature_filter_t filter;
 }temperature_t;
 
-/*温度对象实体*/
-static temperature_t   temperature;
+/*每个探头的温度对象实体*/
+static temperature_t   temperature[TEMPERATURE_PROBE_CNT];
 
 
- /*
- * @brief 获取温度传感器电阻值
- * @param adc adc数值
- * @return 电阻值
- * @note
- */             
-static uint32_t get_r(const uint16_t adc)
-{
-    float t_sensor_r;
-    t_sensor_r = (TEMPERATURE_SENSOR_SUPPLY_VOLTAGE * TEMPERATURE_SENSOR_ADC_VALUE_MAX * TEMPERATURE_SENSOR_BYPASS_RES_VALUE)/(adc * TEMPERATURE_SENSOR_REFERENCE_VOLTAGE)-TEMPERATURE_SENSOR_BYPASS_RES_VALUE;
-    return (uint32_t)t_sensor_r;
-}
-
- /*
- * @brief 获取浮点温度值
- * @param r 温度传感器电阻值
- * @param idx 阻温映射表下标号
- * @return 浮点温度值
- * @note
- */ 
-static float calcaulate_float_t(uint32_t r,uint8_t idx)
+/*
+* @brief adc数值转换为温度
+* @param probe 探头序号
+* @param adc adc数值
+* @param t 温度 单位:0.01C
+* @return -1 传感器短路,开路或者超出阻温表范围
+* @return  0 成功
+* @note 阻温表由tools/ntc_table.py生成
+*/
+static int temperature_get_by_adc(uint8_t probe,uint16_t adc,int16_t *t)
 {
-    uint32_t r1,r2;
+    const temperature_probe_config_t *config = &temperature_probe_config[probe];
 
-    float t;
-
-    r1 = t_r_map[idx][1];
-    r2 = t_r_map[idx + 1][1];
+    if (adc >= ADC_ERR_MAX || adc <= ADC_ERR_MIN) {
+        log_error("%s传感器短路或者开路错误.\r\n",config->name);
+        return -1;
+    }
+    /*adc越大电阻越小温度越高*/
+    if (temperature_table_lookup(config->table,adc,t) != 0) {
+        log_error("%s NTC 超出%s阻温表范围！adc=%d\r\n",config->name,config->table->name,adc);
+        return -1;
+    }
+    *t += config->compensation;
 
-    t = t_r_map[idx][0] + (r1 - r) * 1.0 /(r1 - r2) + TEMPERATURE_COMPENSATION_VALUE;
-  
-    log_debug("temperature: %.2f C.\r\n",t);
-   
-    return t;  
+    return 0;
 }
 
 /*
 * @brief 获取四舍五入整数温度值
-* @param t_float 浮点温度值
+* @param t 温度 单位:0.01C
 * @return 整形四舍五入温度值
 * @note
 */
-static int16_t calculate_approximate_t(float t_float)
+static int16_t calculate_approximate_t(int16_t t)
 {
-    int16_t t = (int16_t)t_float;
+    return t >= 0 ? (t + 50) / 100 : (t - 50) / 100;
+}
 
-    t_float -= t;
 
-    if(t_float >= 0.5 ) {
-        t += 1; 
-    } else if (t_float <= -0.5){
-        t -= 1;
+/*
+* @brief 温度初始化
+* @param ao 活动对象
+* @return 无
+* @note
+*/
+static void temperature_task_init(active_object_t *ao)
+{
+    uint8_t median_size = TEMPERATURE_TASK_FILTER_MEDIAN_SIZE;
+    uint8_t iir_shift = TEMPERATURE_TASK_FILTER_IIR_SHIFT;
+    int32_t value;
+
+    /*读取滤波参数,无效时使用默认值,所有探头相同*/
+    if (device_env_get_int(TEMPERATURE_TASK_FILTER_MEDIAN_ENV_NAME,&value) == 0) {
+        median_size = (uint8_t)value;
     }
-  
-    return t;  
+    if (device_env_get_int(TEMPERATURE_TASK_FILTER_IIR_ENV_NAME,&value) == 0) {
+        iir_shift = (uint8_t)value;
+    }
+    if (median_size == 0 || median_size > TEMPERATURE_FILTER_MEDIAN_SIZE_MAX || (median_size & 1) == 0 || iir_shift > TEMPERATURE_FILTER_IIR_SHIFT_MAX) {
+        log_error("filter setting invalid.default median:%d iir:%d.\r\n",TEMPERATURE_TASK_FILTER_MEDIAN_SIZE,TEMPERATURE_TASK_FILTER_IIR_SHIFT);
+        median_size = TEMPERATURE_TASK_FILTER_MEDIAN_SIZE;
+        iir_shift = TEMPERATURE_TASK_FILTER_IIR_SHIFT;
+    }
+    for (uint8_t i = 0;i < TEMPERATURE_PROBE_CNT;i ++) {
+        log_assert(temperature_probe_config[i].table != NULL);
+        temperature[i].value_int = 0;
+        temperature[i].value = 0;
+        temperature_filter_init(&temperature[i].filter,median_size,iir_shift);
+    }
+    log_info("temperature probe:%d filter median:%d iir:1/%d.\r\n",TEMPERATURE_PROBE_CNT,median_size,1 << iir_shift);
 }
 
 /*
-* @brief 获取实际浮点
+* @brief 处理一个探头的adc平均值
+* @param probe 探头序号
 * @param adc adc数值
-* @return 整形四舍五入温度值
-* @note
+* @return 无
+* @note 错误连续确认TEMPERATURE_ERR_CNT次,正常值同方向变化TEMPERATURE_TASK_TEMPERATURE_CHANGE_CNT次后接受,结果变化时置位change
 */
-float get_float_temperature_by_adc(uint16_t adc)
+static void temperature_probe_update(uint8_t probe,uint16_t adc)
 {
-    uint32_t r; 
-    uint8_t mid;
-    int low = TR_MAP_IDX_MIN;  
-    int high =TR_MAP_IDX_MAX; 
- 
-    if (adc >= ADC_ERR_MAX ||
-        adc <= ADC_ERR_MIN ){
-        log_error("传感器短路或者开路错误.\r\n");
-        return TEMPERATURE_ERR_VALUE;
-    }
+    int rc;
+    int16_t t;
+    temperature_t *temp = &temperature[probe];
+    const temperature_probe_config_t *config = &temperature_probe_config[probe];
 
-    r = get_r(adc);
-
-    if (r <= t_r_map[TR_MAP_IDX_MAX][1]){
-        log_error("NTC 小于最高温度阻值！r=%d\r\n",r); 
-        return TEMPERATURE_ERR_VALUE;
-    }else if (r >= t_r_map[TR_MAP_IDX_MIN][1]){
-        log_error("NTC 大于最低温度阻值！r=%d\r\n",r); 
-        return TEMPERATURE_ERR_VALUE;
+    rc = temperature_get_by_adc(probe,adc,&t);
+    /*去除尖峰后平滑,错误值不进入滤波器*/
+    if (rc == 0) {
+        t = temperature_filter_put(&temp->filter,t);
     }
-
-    while (low <= high) {  
-        mid = (low + high) / 2;  
-        if (r > t_r_map[mid][1]) {
-            if (r <= t_r_map[mid-1][1]){
-                /*返回指定精度的温度*/
-                return calcaulate_float_t(r, mid - 1);
-            } else {
-                high = mid - 1;  
+  
+    /*判断是否在报警范围*/ 
+    if (rc != 0 || (t > config->alarm_max || t < config->alarm_min)) {
+        if (temp->err == false) {  
+            temp->err_cnt ++; 
+            if (temp->err_cnt >= TEMPERATURE_ERR_CNT) {
+                temp->err = true;
+                temp->change = true;
+                /*恢复后不使用错误之前的历史*/
+                temperature_filter_reset(&temp->filter);
             }
+        }
+    } else {  
+        /*温度由错误变为正常，需要发送温度变化消息*/
+        if ( temp->err == true) {
+            temp->err = false;
+            temp->err_cnt = 0;
+            temp->change = true;
+        }
+        /*温度精度*/
+        if (t - temp->value >= TEMPERATURE_ACCURATE) {
+            temp->dir += 1;    
+        }else if(t - temp->value <= -TEMPERATURE_ACCURATE) {
+            temp->dir -= 1;      
         } else {
-            if (r > t_r_map[mid+1][1]) {
-                /*返回带有温度补偿值的温度*/
-                return calcaulate_float_t(r, mid);
-            } else {
-                low = mid + 1;   
-            }
-        }  
+            temp->dir = 0; 
+        }
+        /*温度正常变化 当满足条件时 接受数据变化*/
+        if (temp->dir >= TEMPERATURE_TASK_TEMPERATURE_CHANGE_CNT ||
+            temp->dir <= -TEMPERATURE_TASK_TEMPERATURE_CHANGE_CNT){
+            temp->value_int = calculate_approximate_t(t);
+            temp->value = t;
+            temp->change = true;
+        }
     }
+}
+
+/*
+* @brief 探头短路或者开路
+* @param probe 探头序号
+* @return 无
+* @note ADC阈值比较中断检测到时调用,跳过错误确认立即置为错误;恢复仍由平均值判断
+*/
+static void temperature_probe_fault(uint8_t probe)
+{
+    temperature_t *temp = &temperature[probe];
 
-    return TEMPERATURE_ERR_VALUE;
+    if (temp->err == true) {
+        return;
+    }
+    log_error("%s adc out of range.fault now.\r\n",temperature_probe_config[probe].name);
+    temp->err = true;
+    temp->err_cnt = TEMPERATURE_ERR_CNT;
+    temp->change = true;
+    temperature_filter_reset(&temp->filter);
 }
 
+/*
+* @brief 获取所有探头的温度
+* @param set 探头温度集合
+* @return 无
+* @note 错误的探头温度为TEMPERATURE_PROBE_ERR_VALUE
+*/
+static void temperature_probe_set_get(temperature_probe_set_t *set)
+{
+    set->err_mask = 0;
+    for (uint8_t i = 0;i < TEMPERATURE_PROBE_CNT;i ++) {
+        if (temperature[i].err == true) {
+            set->err_mask |= 1U << i;
+            set->value[i] = TEMPERATURE_PROBE_ERR_VALUE;
+        } else {
+            set->value[i] = temperature[i].value;
+        }
+    }
+}
 
 /*
-* @brief 温度传感器任务
-* @param argument 任务参数
-* @return 
+* @brief 温度事件处理
+* @param ao 活动对象
+* @param event 温度任务消息
+* @return 无
 * @note
 */
-void temperature_task(void const *argument)
+static void temperature_task_handler(active_object_t *ao,const void *event)
 {
-
-    osEvent  os_event;
     osStatus status;
-    temperature_task_message_t req_msg,rsp_msg;
+    const temperature_task_message_t *req_msg = (const temperature_task_message_t *)event;
+    temperature_task_message_t rsp_msg;
     compressor_task_message_t update_msg;
-    uint16_t bypass_r_adc;
-    int16_t t_int;
-    float t_float;
+    temperature_t *cabinet = &temperature[TEMPERATURE_PROBE_CABINET];
+    bool change = false;
 
-    temperature.value_int = 0;
-    temperature.value_float = 0.0;
+    /*温度ADC转换完成消息处理*/
+    if (req_msg->request.type == TEMPERATURE_TASK_MSG_TYPE_ADC_COMPLETED){
+        for (uint8_t i = 0;i < TEMPERATURE_PROBE_CNT;i ++) {
+            temperature_probe_update(i,req_msg->request.adc[i]);
+            change = change || temperature[i].change;
+        }
+    }
 
-    while (1) {
-        os_event = osMessageGet(temperature_task_msg_q_id,TEMPERATURE_TASK_MSG_WAIT_TIMEOUT);
-        if (os_event.status == osEventMessage){
-            req_msg = *(temperature_task_message_t*)os_event.value.v;
- 
-            /*温度ADC转换完成消息处理*/
-            if (req_msg.request.type == TEMPERATURE_TASK_MSG_TYPE_ADC_COMPLETED){
-                bypass_r_adc = req_msg.request.adc;  
-             
-                t_float = get_float_temperature_by_adc(bypass_r_adc);
-              
-                /*判断是否在报警范围*/ 
-                if (t_float == TEMPERATURE_ERR_VALUE || (t_float > TEMPERATURE_ALARM_VALUE_MAX || t_float < TEMPERATURE_ALARM_VALUE_MIN)) {
-                    if (temperature.err == false) {  
-                        temperature.err_cnt ++; 
-                        if (temperature.err_cnt >= TEMPERATURE_ERR_CNT) {
-                            temperature.err = true;
-                            temperature.change = true;
-                        }
-                    }
-                } else {  
-                    t_int = calculate_approximate_t(t_float);
-                    /*温度由错误变为正常，需要发送温度变化消息*/
-                    if ( temperature.err == true) {
-                        temperature.err = false;
-                        temperature.err_cnt = 0;
-                        temperature.change = true;
-                    }
-                    /*温度精度*/
-                    if (t_float - temperature.value_float >= TEMPERATURE_ACCURATE) {
-                        temperature.dir += 1;    
-                    }else if(t_float - temperature.value_float <= -TEMPERATURE_ACCURATE) {
-                        temperature.dir -= 1;      
-                    } else {
-                        temperature.dir = 0; 
-                    }
-                    /*温度正常变化 当满足条件时 接受数据变化*/
-                    if (temperature.dir >= TEMPERATURE_TASK_TEMPERATURE_CHANGE_CNT ||
-                        temperature.dir <= -TEMPERATURE_TASK_TEMPERATURE_CHANGE_CNT){
-                        temperature.value_int = t_int;
-                        temperature.value_float = t_float;
-                        temperature.change = true;
-                    }
-                }
-            }
-    
-            if (temperature.change == true) {
-         
-                if (temperature.err == true){
-                    /*压缩机温度错误消息*/
-                    update_msg.request.type = COMPRESSOR_TASK_MSG_TYPE_TEMPERATURE_ERR;
-                    log_error("temperature err.\r\n");
-                }else{
-                    /*压缩机温度更新消息*/
-                    update_msg.request.type = COMPRESSOR_TASK_MSG_TYPE_TEMPERATURE_UPDATE;
-                    update_msg.request.temperature_int = temperature.value_int;
-                    update_msg.request.temperature_float = temperature.value_float;
-                    log_info("teperature change to:%.2f C.\r\n",temperature.value_float);
-                }
-                temperature.change = false;       
-                temperature.dir = 0;    
-                status = osMessagePut(compressor_task_msg_q_id,(uint32_t)&update_msg,TEMPERATURE_TASK_PUT_MSG_TIMEOUT);
-                if (status !=osOK) {
-                    log_error("put compressor t msg error:%d\r\n",status); 
-                } 
+    /*ADC阈值比较中断检测到的探头故障*/
+    if (req_msg->request.type == TEMPERATURE_TASK_MSG_TYPE_ADC_FAULT){
+        for (uint8_t i = 0;i < TEMPERATURE_PROBE_CNT;i ++) {
+            if (req_msg->request.fault_mask & (1U << i)) {
+                temperature_probe_fault(i);
             }
+            change = change || temperature[i].change;
+        }
+    }
+
+    /*箱内温度控制压缩机启停*/
+    if (cabinet->change == true) {
+ 
+        if (cabinet->err == true){
+            /*压缩机温度错误消息*/
+            update_msg.request.type = COMPRESSOR_TASK_MSG_TYPE_TEMPERATURE_ERR;
+            log_error("temperature err.\r\n");
+        }else{
+            /*压缩机温度更新消息*/
+            update_msg.request.type = COMPRESSOR_TASK_MSG_TYPE_TEMPERATURE_UPDATE;
+            update_msg.request.temperature_int = cabinet->value_int;
+            update_msg.request.temperature_float = cabinet->value / 100.0f;
+            log_info("teperature change to:%d(0.01C).\r\n",cabinet->value);
         }
+        status = active_object_post(&compressor_task_ao,&update_msg,TEMPERATURE_TASK_PUT_MSG_TIMEOUT);
+        if (status !=osOK) {
+            log_error("put compressor t msg error:%d\r\n",status); 
+        } 
+        history_task_post(HISTORY_TYPE_TEMPERATURE,0,cabinet->err == true ? HISTORY_VALUE_ERR : cabinet->value);
+    }
 
-        /*温度查询消息处理*/
-        if (req_msg.request.type == TEMPERATURE_TASK_MSG_TYPE_TEMPERATURE){
-            rsp_msg.response.type = TEMPERATURE_TASK_MSG_TYPE_RSP_TEMPERATURE;
-            if (temperature.err == true) {
-                rsp_msg.response.err = true;
-            } else {
-                rsp_msg.response.err = false;
-                rsp_msg.response.temperature_int = temperature.value_int;
-                rsp_msg.response.temperature_float = temperature.value_float;
+    /*任何探头变化都把探头集合发给压缩机*/
+    if (change == true) {
+        update_msg.request.type = COMPRESSOR_TASK_MSG_TYPE_PROBE_UPDATE;
+        temperature_probe_set_get(&update_msg.request.probe);
+        status = active_object_post(&compressor_task_ao,&update_msg,TEMPERATURE_TASK_PUT_MSG_TIMEOUT);
+        if (status !=osOK) {
+            log_error("put compressor probe msg error:%d\r\n",status); 
+        } 
+        for (uint8_t i = 0;i < TEMPERATURE_PROBE_CNT;i ++) {
+            if (temperature[i].change == true) {
+                temperature[i].change = false;
+                temperature[i].dir = 0;
             }
-            status = osMessagePut(req_msg.request.rsp_message_queue_id,(uint32_t)&rsp_msg,TEMPERATURE_TASK_PUT_MSG_TIMEOUT);
-           if (status !=osOK) {
-               log_error("put temperature msg error:%d\r\n",status); 
-           }          
         }
+    }
+
+    /*温度查询消息处理*/
+    if (req_msg->request.type == TEMPERATURE_TASK_MSG_TYPE_TEMPERATURE){
+        rsp_msg.response.type = TEMPERATURE_TASK_MSG_TYPE_RSP_TEMPERATURE;
+        if (cabinet->err == true) {
+            rsp_msg.response.err = true;
+        } else {
+            rsp_msg.response.err = false;
+            rsp_msg.response.temperature_int = cabinet->value_int;
+            rsp_msg.response.temperature_float = cabinet->value / 100.0f;
+        }
+        status = msg_pool_send(&temperature_task_msg_pool,req_msg->request.rsp_message_queue_id,&rsp_msg,TEMPERATURE_TASK_PUT_MSG_TIMEOUT);
+       if (status !=osOK) {
+           log_error("put temperature msg error:%d\r\n",status); 
+       }          
+    }
 
+    /*探头温度查询消息处理*/
+    if (req_msg->request.type == TEMPERATURE_TASK_MSG_TYPE_PROBE){
+        rsp_msg.response.type = TEMPERATURE_TASK_MSG_TYPE_RSP_PROBE;
+        temperature_probe_set_get(&rsp_msg.response.probe);
+        status = msg_pool_send(&temperature_task_msg_pool,req_msg->request.rsp_message_queue_id,&rsp_msg,TEMPERATURE_TASK_PUT_MSG_TIMEOUT);
+        if (status !=osOK) {
+            log_error("put probe msg error:%d\r\n",status); 
+        }          
     }
-}
\ No newline at end of file
+}
@@ -2,6 +2,9 @@
 #define  __TEMPERATURE_TASK_H__
 #include "stdint.h"
 #include "stdbool.h"
+#include "msg_pool.h"
+#include "active_object.h"
+#include "adc_task.h"
 
 #ifdef  __cplusplus
 #define TEMPERATURE_TASK_BEGIN  extern "C" {
@@ -14,42 +17,65 @@
 
 TEMPERATURE_TASK_BEGIN
 
-extern osThreadId   temperature_task_hdl;
-extern osMessageQId temperature_task_msg_q_id;
+extern osMessageQId    temperature_task_msg_q_id;
+extern msg_pool_t      temperature_task_msg_pool;
+extern active_object_t temperature_task_ao;
 
-void temperature_task(void const *argument);
 
 
+#define  TEMPERATURE_TASK_MSG_Q_SIZE               4 /*消息队列深度*/
+#define  TEMPERATURE_TASK_MSG_POOL_SIZE            (TEMPERATURE_TASK_MSG_Q_SIZE + 3) /*消息池容量:请求+正在处理的事件+回应*/
 
 #define  TEMPERATURE_TASK_TEMPERATURE_CHANGE_CNT   3 /*连续保持的次数*/
 
-#define  TEMPERATURE_SENSOR_ADC_VALUE_MAX          4096/*温度AD转换最大数值*/      
-#define  TEMPERATURE_SENSOR_BYPASS_RES_VALUE       5100/*温度AD转换旁路电阻值*/  
-#define  TEMPERATURE_SENSOR_REFERENCE_VOLTAGE      3.30 /*温度传感器参考电压 单位:V*/
-#define  TEMPERATURE_SENSOR_SUPPLY_VOLTAGE         3.30 /*温度传感器供电电压 单位:V*/
+/*滤波参数,环境变量中保存为十进制字符串,上电时读取*/
+#define  TEMPERATURE_TASK_FILTER_MEDIAN_ENV_NAME   "t_median"
+#define  TEMPERATURE_TASK_FILTER_IIR_ENV_NAME      "t_iir"
+#define  TEMPERATURE_TASK_FILTER_MEDIAN_SIZE       5 /*默认中值窗口长度,每个值对应一次ADC缓存平均*/
+#define  TEMPERATURE_TASK_FILTER_IIR_SHIFT         2 /*默认IIR系数1/2^2*/
 
+/*阻温表和分压电阻参数在tools/ntc_table.py中,修改后重新生成temperature_table_<name>.c*/
 
-#define  TEMPERATURE_TASK_MSG_WAIT_TIMEOUT         osWaitForever
 #define  TEMPERATURE_TASK_PUT_MSG_TIMEOUT          5    /*发送消息超时时间*/
 
-#define  TEMPERATURE_COMPENSATION_VALUE            0.0  /*温度补偿值,因为温度传感器位置温度与实际温度有误差*/
+#define  TEMPERATURE_COMPENSATION_VALUE            0    /*温度补偿值,因为温度传感器位置温度与实际温度有误差 单位:0.01C*/
 #define  TEMPERATURE_ALARM_VALUE_MAX               55   /*软件温度高值异常上限 >*/
 #define  TEMPERATURE_ALARM_VALUE_MIN               -19  /*软件温度低值异常下限 <*/
-#define  TEMPERATURE_ERR_VALUE                     127.0/*错误温度值*/
-#define  TEMPERATURE_ACCURATE                      0.1  /*温度精度*/ 
+#define  TEMPERATURE_EVAPORATOR_ALARM_VALUE_MAX    60   /*蒸发器温度高值异常上限 >*/
+#define  TEMPERATURE_EVAPORATOR_ALARM_VALUE_MIN    -20  /*蒸发器温度低值异常下限 <*/
+#define  TEMPERATURE_ACCURATE                      10   /*温度精度 单位:0.01C*/ 
 #define  TEMPERATURE_ERR_CNT                       3    /*温度错误确认次数*/ 
 
 
+#define  TEMPERATURE_PROBE_CNT                     ADC_TASK_PROBE_CNT /*探头数量,顺序与adc_task的通道表一致*/
+#define  TEMPERATURE_PROBE_ERR_VALUE               0x7FFF /*错误探头的温度值*/
+
 #define  ADC_ERR_MAX                               4090
 #define  ADC_ERR_MIN                               5
 
+enum
+{
+    TEMPERATURE_PROBE_CABINET = 0,/*箱内,控制压缩机启停*/
+    TEMPERATURE_PROBE_EVAPORATOR  /*蒸发器,用于除霜和负载判断*/
+};
+
 enum
 {
     TEMPERATURE_TASK_MSG_TYPE_ADC_COMPLETED,
     TEMPERATURE_TASK_MSG_TYPE_TEMPERATURE,
-    TEMPERATURE_TASK_MSG_TYPE_RSP_TEMPERATURE
+    TEMPERATURE_TASK_MSG_TYPE_RSP_TEMPERATURE,
+    TEMPERATURE_TASK_MSG_TYPE_PROBE,
+    TEMPERATURE_TASK_MSG_TYPE_RSP_PROBE,
+    TEMPERATURE_TASK_MSG_TYPE_ADC_FAULT
 };
 
+/*所有探头的温度*/
+typedef struct
+{
+    uint8_t err_mask;/*bit i置位表示探头i错误*/
+    int16_t value[TEMPERATURE_PROBE_CNT];/*温度 单位:0.01C 错误时为TEMPERATURE_PROBE_ERR_VALUE*/
+}temperature_probe_set_t;
+
 typedef struct
 {
     union 
@@ -57,7 +83,8 @@ typedef struct
     struct 
     {  
         uint8_t type;/*请求消息类型*/
-        uint16_t adc;/*模数转换数值*/
+        uint16_t adc[TEMPERATURE_PROBE_CNT];/*每个探头的模数转换数值*/
+        uint8_t fault_mask;/*阈值比较中断检测到短路或者开路的探头,bit i对应探头i*/
         osMessageQId rsp_message_queue_id;/*回应的消息队列id*/
     }request;
     struct
@@ -66,6 +93,7 @@ typedef struct
         bool err;/*温度是否错误*/
         int16_t temperature_int;/*回应的温度整数*/
         float temperature_float;/*回应的温度整数*/
+        temperature_probe_set_t probe;/*回应的所有探头温度*/
     }response;
     };
 }temperature_task_message_t;/*温度任务消息体*/
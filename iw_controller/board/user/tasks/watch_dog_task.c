@@ -15,7 +15,20 @@
  * Definitions
  ******************************************************************************/
 
-osThreadId   watch_dog_task_hdl;
+osMessageQId watch_dog_task_msg_q_id;
+/*看门狗任务消息池*/
+MSG_POOL_DEF(watch_dog_task_msg_pool,watch_dog_task_message_t,WATCH_DOG_TASK_MSG_POOL_SIZE);
+
+static void watch_dog_task_init(active_object_t *ao);
+static void watch_dog_task_handler(active_object_t *ao,const void *event);
+/*看门狗活动对象*/
+ACTIVE_OBJECT_DEF(watch_dog_task_ao,watch_dog_task_init,watch_dog_task_handler,&watch_dog_task_msg_pool);
+
+/*定时器和事件*/
+static active_object_timer_t watch_dog_alive_timer;
+static const watch_dog_task_message_t watch_dog_alive_msg = { .type = WATCH_DOG_TASK_MSG_TYPE_ALIVE };
+/*活动对象线程仍在处理事件*/
+static volatile bool watch_dog_alive;
 
 
 #define  WDT_ENABLE_RESET      1
@@ -26,7 +39,7 @@ osThreadId   watch_dog_task_hdl;
 * @param 无
 * @param
 * @return 无
-* @note
+* @note 只有活动对象线程在上一个喂狗周期内处理过事件才喂狗
 */
 void WDT_BOD_IRQHandler(void)
 {
@@ -35,10 +48,14 @@ void WDT_BOD_IRQHandler(void)
     /* Handle warning interrupt */
     if (wdtStatus & kWWDT_WarningFlag)
     {
-        log_debug("feed dog.tv:%d.\r\n",WWDT->TV);
-
         WWDT_ClearStatusFlags(WWDT, kWWDT_WarningFlag);
-        WWDT_Refresh(WWDT);
+        if (watch_dog_alive == true) {
+            watch_dog_alive = false;
+            log_debug("feed dog.tv:%d.\r\n",WWDT->TV);
+            WWDT_Refresh(WWDT);
+        } else {
+            log_error("ao thread stall.no feed.\r\n");
+        }
     }
        
 
@@ -53,14 +70,12 @@ void WDT_BOD_IRQHandler(void)
 
 
 /*
-* @brief 看门狗任务
-* @param
-* @param
+* @brief 看门狗初始化
+* @param ao 活动对象
 * @return 
-* @note
+* @note 在看门狗警告中断中喂狗,周期事件证明活动对象线程没有卡住
 */
-
-void watch_dog_task(void const * argument)
+static void watch_dog_task_init(active_object_t *ao)
 {
 
     wwdt_config_t config;
@@ -102,9 +117,26 @@ void watch_dog_task(void const * argument)
     /* Setup watchdog clock frequency(Hz). */
     config.clockFreq_Hz = WDT_CLK_FREQ;
 
+    watch_dog_alive = true;
     WWDT_Init(WWDT, &config);
 
-    while (1){
-        osDelay(WATCH_DOG_TASK_INTERVAL); 
+    active_object_timer_init(&watch_dog_alive_timer,ao,&watch_dog_alive_msg);
+    active_object_timer_start(&watch_dog_alive_timer,WATCH_DOG_TASK_INTERVAL,WATCH_DOG_TASK_INTERVAL);
+}
+
+/*
+* @brief 看门狗事件处理
+* @param ao 活动对象
+* @param event 看门狗任务消息
+* @return 
+* @note 存活事件时顺便输出中断中发生的消息池耗尽
+*/
+static void watch_dog_task_handler(active_object_t *ao,const void *event)
+{
+    const watch_dog_task_message_t *msg = (const watch_dog_task_message_t *)event;
+
+    if (msg->type == WATCH_DOG_TASK_MSG_TYPE_ALIVE) {
+        watch_dog_alive = true;
+        msg_pool_check();
     }
 }
\ No newline at end of file
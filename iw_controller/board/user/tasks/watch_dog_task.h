@@ -1,21 +1,26 @@
 #ifndef  __WATCH_DOG_TASK_H__
 #define  __WATCH_DOG_TASK_H__
+#include "msg_pool.h"
+#include "active_object.h"
 
-/*任务句柄*/
-extern osThreadId   watch_dog_task_hdl;
+extern osMessageQId    watch_dog_task_msg_q_id;
+extern msg_pool_t      watch_dog_task_msg_pool;
+extern active_object_t watch_dog_task_ao;
 
-/*
-* @brief 看门狗任务
-* @param argument 任务参数
-* @param
-* @return 无
-* @note
-*/
-void watch_dog_task(void const * argument);
 
+#define  WATCH_DOG_TASK_INTERVAL            1000 /*活动对象线程存活事件周期,小于喂狗周期 单位:ms*/
+#define  WATCH_DOG_TASK_MSG_Q_SIZE          2
+#define  WATCH_DOG_TASK_MSG_POOL_SIZE       (WATCH_DOG_TASK_MSG_Q_SIZE + 1) /*消息池容量:队列+正在处理的事件*/
 
-#define  WATCH_DOG_TASK_INTERVAL            100
+enum
+{
+    WATCH_DOG_TASK_MSG_TYPE_ALIVE
+};
 
+typedef struct
+{
+    uint8_t type;
+}watch_dog_task_message_t;/*看门狗任务消息体*/
 
 
 
@@ -23,4 +28,5 @@ void watch_dog_task(void const * argument);
 
 
 
-#endif
\ No newline at end of file
+
+#endif
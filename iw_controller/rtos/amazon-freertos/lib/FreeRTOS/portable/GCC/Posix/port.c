@@ -0,0 +1,402 @@
+/*
+ * FreeRTOS Kernel V10.0.1
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+/*-----------------------------------------------------------
+ * Implementation of functions defined in portable.h for the POSIX (Linux)
+ * simulator.
+ *
+ * Each task gets a pthread whose control block lives at the top of the task
+ * stack, so the stack memory the application gives to the task is only used
+ * for that block; the task code runs on the pthread stack.  A single mutex
+ * and a condition per thread hand the processor from one thread to the next,
+ * so exactly one task thread runs at any time.
+ *
+ * SIGALRM is the only interrupt.  It is raised every tick by an interval
+ * timer and is blocked in a thread while that thread is in a critical section
+ * or has set the interrupt mask.  The signal handler runs on the thread of the
+ * interrupted task, calls vPortSimInterruptHandler() (the simulated device
+ * interrupts and the tick) and switches to another task when one of them
+ * asked for it.  When the idle task was interrupted and nothing became ready
+ * the handler waits for the next tick instead of returning to the busy idle
+ * loop, which keeps the simulator from spinning a host CPU.
+ *
+ * Functions that take locks in the C library (malloc, stdio) must not be
+ * called by tasks or simulated interrupts: a task preempted while holding
+ * such a lock would block every other task that needs it.
+ *----------------------------------------------------------*/
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#ifndef configIDLE_TASK_NAME
+	#define configIDLE_TASK_NAME "IDLE"
+#endif
+
+/* Stack of the pthread that runs a task.  The task code of a Cortex-M
+application needs only a few KB, the rest is headroom for 64 bit pointers
+and the C library. */
+#define portTHREAD_STACK_SIZE		( 256 * 1024 )
+#define portTHREAD_ALIGNMENT		( ( portPOINTER_SIZE_TYPE ) 16 )
+
+typedef struct THREAD
+{
+	pthread_t xThread;
+	pthread_cond_t xCond;
+	volatile BaseType_t xRunning;
+	TaskFunction_t pxCode;
+	void *pvParams;
+} Thread_t;
+
+static pthread_mutex_t xSchedulerMutex = PTHREAD_MUTEX_INITIALIZER;
+static sigset_t xTickSignal;
+static volatile BaseType_t xInsideInterrupt = pdFALSE;
+static volatile BaseType_t xSwitchRequired = pdFALSE;
+static TaskHandle_t xIdleTask = NULL;
+
+/* Critical nesting is per thread, it survives a context switch with the
+thread that owns it. */
+static __thread UBaseType_t uxCriticalNesting = 0;
+
+/*-----------------------------------------------------------*/
+
+/* The control block sits just above the top of stack returned by
+pxPortInitialiseStack(), pxTopOfStack is the first member of the TCB and
+never changes on this port. */
+static Thread_t *prvGetThreadFromTask( TaskHandle_t xTask )
+{
+StackType_t *pxTopOfStack = *( StackType_t ** ) xTask;
+
+	return ( Thread_t * ) ( pxTopOfStack + 1 );
+}
+/*-----------------------------------------------------------*/
+
+/* Critical sections can be used before the first task is created. */
+__attribute__(( constructor )) static void prvInitTickSignal( void )
+{
+	sigemptyset( &xTickSignal );
+	sigaddset( &xTickSignal, SIGALRM );
+}
+/*-----------------------------------------------------------*/
+
+static void prvBlockTick( void )
+{
+	pthread_sigmask( SIG_BLOCK, &xTickSignal, NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvUnblockTick( void )
+{
+	pthread_sigmask( SIG_UNBLOCK, &xTickSignal, NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvWaitRunning( Thread_t *pxThread )
+{
+	pthread_mutex_lock( &xSchedulerMutex );
+	while( pxThread->xRunning == pdFALSE )
+	{
+		pthread_cond_wait( &pxThread->xCond, &xSchedulerMutex );
+	}
+	pthread_mutex_unlock( &xSchedulerMutex );
+}
+/*-----------------------------------------------------------*/
+
+/* Select the next task and hand the processor to its thread.  Called with
+the tick signal blocked.  Returns pdTRUE when another thread ran, after this
+thread got the processor back. */
+static BaseType_t prvSwitchContext( void )
+{
+Thread_t *pxFrom, *pxTo;
+
+	pxFrom = prvGetThreadFromTask( xTaskGetCurrentTaskHandle() );
+	vTaskSwitchContext();
+	pxTo = prvGetThreadFromTask( xTaskGetCurrentTaskHandle() );
+	if( pxTo == pxFrom )
+	{
+		return pdFALSE;
+	}
+
+	pthread_mutex_lock( &xSchedulerMutex );
+	pxFrom->xRunning = pdFALSE;
+	pxTo->xRunning = pdTRUE;
+	pthread_cond_signal( &pxTo->xCond );
+	while( pxFrom->xRunning == pdFALSE )
+	{
+		pthread_cond_wait( &pxFrom->xCond, &xSchedulerMutex );
+	}
+	pthread_mutex_unlock( &xSchedulerMutex );
+
+	return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvIdleRunning( void )
+{
+TaskHandle_t xTask = xTaskGetCurrentTaskHandle();
+
+	if( xIdleTask == NULL && strcmp( pcTaskGetName( xTask ), configIDLE_TASK_NAME ) == 0 )
+	{
+		xIdleTask = xTask;
+	}
+	return xTask == xIdleTask ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvTickSignalHandler( int iSignal )
+{
+int iSavedErrno = errno;
+
+	for( ;; )
+	{
+		xInsideInterrupt = pdTRUE;
+		vPortSimInterruptHandler();
+		xInsideInterrupt = pdFALSE;
+
+		if( xSwitchRequired != pdFALSE )
+		{
+			xSwitchRequired = pdFALSE;
+			if( prvSwitchContext() != pdFALSE )
+			{
+				break;
+			}
+		}
+		if( prvIdleRunning() == pdFALSE )
+		{
+			break;
+		}
+		/* Nothing to do until the next tick. */
+		sigwait( &xTickSignal, &iSignal );
+	}
+
+	errno = iSavedErrno;
+}
+/*-----------------------------------------------------------*/
+
+static void *prvThreadEntry( void *pvParams )
+{
+Thread_t *pxThread = ( Thread_t * ) pvParams;
+
+	prvWaitRunning( pxThread );
+
+	/* A task starts with interrupts enabled. */
+	uxCriticalNesting = 0;
+	prvUnblockTick();
+	pxThread->pxCode( pxThread->pvParams );
+
+	/* Task functions must not return. */
+	vTaskDelete( NULL );
+	return NULL;
+}
+/*-----------------------------------------------------------*/
+
+StackType_t *pxPortInitialiseStack( StackType_t *pxTopOfStack, TaskFunction_t pxCode, void *pvParameters )
+{
+Thread_t *pxThread;
+pthread_attr_t xAttr;
+sigset_t xAllSignals, xOldSignals;
+int iResult;
+
+	pxThread = ( Thread_t * ) ( ( ( portPOINTER_SIZE_TYPE ) pxTopOfStack - sizeof( Thread_t ) ) & ~( portTHREAD_ALIGNMENT - 1 ) );
+	memset( pxThread, 0, sizeof( Thread_t ) );
+	pthread_cond_init( &pxThread->xCond, NULL );
+	pxThread->xRunning = pdFALSE;
+	pxThread->pxCode = pxCode;
+	pxThread->pvParams = pvParameters;
+
+	/* The new thread starts with every asynchronous signal blocked, it
+	unblocks the tick when it gets the processor for the first time.  Faults
+	stay deliverable so a crash in a task reaches the debugger or sanitizer
+	handler. */
+	pthread_attr_init( &xAttr );
+	pthread_attr_setstacksize( &xAttr, portTHREAD_STACK_SIZE );
+	sigfillset( &xAllSignals );
+	sigdelset( &xAllSignals, SIGSEGV );
+	sigdelset( &xAllSignals, SIGBUS );
+	sigdelset( &xAllSignals, SIGFPE );
+	sigdelset( &xAllSignals, SIGILL );
+	pthread_sigmask( SIG_SETMASK, &xAllSignals, &xOldSignals );
+	iResult = pthread_create( &pxThread->xThread, &xAttr, prvThreadEntry, pxThread );
+	pthread_sigmask( SIG_SETMASK, &xOldSignals, NULL );
+	pthread_attr_destroy( &xAttr );
+	configASSERT( iResult == 0 );
+
+	return ( StackType_t * ) pxThread - 1;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortStartScheduler( void )
+{
+struct sigaction xAction;
+struct itimerval xTimer;
+
+	memset( &xAction, 0, sizeof( xAction ) );
+	xAction.sa_handler = prvTickSignalHandler;
+	sigfillset( &xAction.sa_mask );
+	xAction.sa_flags = SA_RESTART;
+	sigaction( SIGALRM, &xAction, NULL );
+
+	xTimer.it_interval.tv_sec = 0;
+	xTimer.it_interval.tv_usec = 1000000UL / configTICK_RATE_HZ;
+	xTimer.it_value = xTimer.it_interval;
+	setitimer( ITIMER_REAL, &xTimer, NULL );
+
+	/* Start the first task, this thread only waits from now on.  The tick
+	is blocked here since vTaskStartScheduler() disabled interrupts. */
+	pthread_mutex_lock( &xSchedulerMutex );
+	prvGetThreadFromTask( xTaskGetCurrentTaskHandle() )->xRunning = pdTRUE;
+	pthread_cond_signal( &prvGetThreadFromTask( xTaskGetCurrentTaskHandle() )->xCond );
+	pthread_mutex_unlock( &xSchedulerMutex );
+
+	for( ;; )
+	{
+		pause();
+	}
+
+	/* Should not get here. */
+	return 0;
+}
+/*-----------------------------------------------------------*/
+
+void vPortEndScheduler( void )
+{
+struct itimerval xTimer;
+
+	memset( &xTimer, 0, sizeof( xTimer ) );
+	setitimer( ITIMER_REAL, &xTimer, NULL );
+	exit( 0 );
+}
+/*-----------------------------------------------------------*/
+
+void vPortYield( void )
+{
+	if( xInsideInterrupt != pdFALSE )
+	{
+		xSwitchRequired = pdTRUE;
+		return;
+	}
+	vPortEnterCritical();
+	prvSwitchContext();
+	vPortExitCritical();
+}
+/*-----------------------------------------------------------*/
+
+void vPortYieldFromISR( void )
+{
+	if( xInsideInterrupt != pdFALSE )
+	{
+		xSwitchRequired = pdTRUE;
+	}
+	else
+	{
+		vPortYield();
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnterCritical( void )
+{
+	if( xInsideInterrupt == pdFALSE && uxCriticalNesting == 0 )
+	{
+		prvBlockTick();
+	}
+	uxCriticalNesting++;
+}
+/*-----------------------------------------------------------*/
+
+void vPortExitCritical( void )
+{
+	configASSERT( uxCriticalNesting );
+	uxCriticalNesting--;
+	if( xInsideInterrupt == pdFALSE && uxCriticalNesting == 0 )
+	{
+		prvUnblockTick();
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortDisableInterrupts( void )
+{
+	prvBlockTick();
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnableInterrupts( void )
+{
+	if( xInsideInterrupt == pdFALSE )
+	{
+		prvUnblockTick();
+	}
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t xPortSetInterruptMask( void )
+{
+sigset_t xOldSignals;
+
+	pthread_sigmask( SIG_BLOCK, &xTickSignal, &xOldSignals );
+	return sigismember( &xOldSignals, SIGALRM ) == 1 ? 1 : 0;
+}
+/*-----------------------------------------------------------*/
+
+void vPortClearInterruptMask( UBaseType_t uxMask )
+{
+	if( uxMask == 0 )
+	{
+		prvUnblockTick();
+	}
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortIsInsideInterrupt( void )
+{
+	return xInsideInterrupt;
+}
+/*-----------------------------------------------------------*/
+
+void xPortSysTickHandler( void )
+{
+	if( xTaskIncrementTick() != pdFALSE )
+	{
+		xSwitchRequired = pdTRUE;
+	}
+}
+/*-----------------------------------------------------------*/
+
+__attribute__(( weak )) void vPortSimInterruptHandler( void )
+{
+	xPortSysTickHandler();
+}
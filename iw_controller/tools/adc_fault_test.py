@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+probe fault test of the adc threshold compare path on the simulation build.
+
+the simulated adc (board/sim/drivers/fsl_adc.c) is the adc stub: the
+probe channels read the adc3/adc5 values of the inputs file, and a
+conversion outside threshold pair 0 raises ADC0_THCMP like the hardware.
+for each case the test changes one probe input and polls
+CODE_QUERY_PROBE on the host link until the probe reads as failed, then
+restores the input and waits for the averaged path to recover it:
+
+    short      adc 4095, must be flagged by the interrupt
+    open       adc 0, same
+    range      adc inside the short/open limits but outside the ntc
+               table, no interrupt; flagged by the averaged path after
+               TEMPERATURE_ERR_CNT blocks, the reference for the timing
+
+pass: short and open faults show up within FAULT_LIMIT (well below one
+1.024 s adc block), only on the faulty probe, the cabinet fault is sent
+to the compressor task ("temperature err." on the console), the range
+case takes at least one block, and every probe recovers.
+
+    python3 adc_fault_test.py [_gate_build/iw_controller_sim]
+"""
+import argparse
+import os
+import sys
+import tempfile
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from sim_smoke import Sim, SimError  # noqa: E402
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+CODE_QUERY_PROBE = 0x42
+DATA_PROBE_ERR_VALUE = 0x7FFF
+PROBE_INPUT = ('adc3', 'adc5')     # adc_probe_channel of adc_task.c
+PROBE_NAME = ('cabinet', 'evaporator')
+ADC_NORMAL = 2048                  # SIM_ADC_DEFAULT_VALUE
+BLOCK = 1.024                      # s, ADC_TASK_SAMPLE_INTERVAL * ADC_TASK_BLOCK_SIZE
+FAULT_LIMIT = 0.5                  # s, input file poll + a few 8 ms samples + dispatch
+RECOVER_LIMIT = 20.0               # s, averaged path, filter and change hysteresis
+POLL = 0.02
+
+CASES = [
+    # name     probe value  interrupt
+    ('short',  0,    4095,  True),
+    ('open',   0,    0,     True),
+    ('short',  1,    4095,  True),
+    ('open',   1,    0,     True),
+    ('range',  0,    4000,  False),
+]
+
+
+def probes(sim):
+    data = sim.request(CODE_QUERY_PROBE)
+    cnt = data[0]
+    return [(data[1 + 2 * i] << 8) | data[2 + 2 * i] for i in range(cnt)]
+
+
+def wait(sim, predicate, limit):
+    """seconds until predicate(probe values) holds, None after limit"""
+    start = time.monotonic()
+    while time.monotonic() - start < limit:
+        values = probes(sim)
+        if predicate(values):
+            return time.monotonic() - start, values
+        time.sleep(POLL)
+    return None, probes(sim)
+
+
+def run(exe, keep):
+    results = []
+    state_dir = tempfile.mkdtemp(prefix='iw_adc_fault_')
+    sim = Sim(exe, state_dir)
+    try:
+        sim.start()
+        sim.set_input(**{name: ADC_NORMAL for name in PROBE_INPUT})
+        # the probes read 0 until the first blocks went through the filter
+        elapsed, values = wait(sim, lambda v: all(x not in (0, DATA_PROBE_ERR_VALUE) for x in v), RECOVER_LIMIT)
+        if elapsed is None:
+            raise SimError('probes not valid after boot: %s' % values)
+
+        for name, probe, value, interrupt in CASES:
+            other = 1 - probe
+            mark = len(sim.console())
+            sim.set_input(**{PROBE_INPUT[probe]: value})
+            elapsed, values = wait(sim, lambda v: v[probe] == DATA_PROBE_ERR_VALUE, RECOVER_LIMIT)
+            case = '%s %s' % (PROBE_NAME[probe], name)
+            if elapsed is None:
+                results.append((case, False, 'not flagged in %.0f s' % RECOVER_LIMIT))
+            else:
+                ok = elapsed <= FAULT_LIMIT if interrupt else elapsed >= BLOCK
+                detail = '%.3f s, %s' % (elapsed, '<= %.1f s' % FAULT_LIMIT if interrupt else '>= one block')
+                if values[other] == DATA_PROBE_ERR_VALUE:
+                    ok, detail = False, detail + ', other probe flagged too'
+                if interrupt and probe == 0:
+                    time.sleep(0.1)
+                    if b'temperature err.' not in sim.console()[mark:]:
+                        ok, detail = False, detail + ', no compressor temperature err'
+                results.append((case, ok, detail))
+
+            sim.set_input(**{PROBE_INPUT[probe]: ADC_NORMAL})
+            elapsed, values = wait(sim, lambda v: v[probe] != DATA_PROBE_ERR_VALUE, RECOVER_LIMIT)
+            results.append(('  recover', elapsed is not None,
+                            '%.1f s' % elapsed if elapsed is not None else 'still failed after %.0f s' % RECOVER_LIMIT))
+    except SimError as e:
+        results.append(('simulator', False, str(e)))
+    finally:
+        sim.stop()
+
+    print('%-22s %-6s %s' % ('case', 'result', 'detail'))
+    for name, ok, detail in results:
+        print('%-22s %-6s %s' % (name, 'ok' if ok else 'FAIL', detail))
+    failed = [r for r in results if not r[1]]
+    print('result: %s' % ('FAIL' if failed else 'ok'))
+    if failed or keep:
+        print('state dir: %s' % state_dir)
+    else:
+        for name in os.listdir(state_dir):
+            path = os.path.join(state_dir, name)
+            if os.path.islink(path) or os.path.isfile(path):
+                os.unlink(path)
+        os.rmdir(state_dir)
+    return 1 if failed else 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument('exe', nargs='?', default=os.path.join(HERE, '..', '_gate_build', 'iw_controller_sim'))
+    parser.add_argument('--keep', action='store_true', help='keep the state directory')
+    args = parser.parse_args()
+    if not os.path.exists(args.exe):
+        print('no simulator at %s, build it with cmake first' % args.exe)
+        return 1
+    return run(os.path.abspath(args.exe), args.keep)
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,266 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+host side thermal plant simulator for the compressor control in compressor_task.c.
+
+the cabinet is a two node model: the cabinet air exchanges heat with the
+ambient (much faster while the door is open) and with the evaporator, and
+the compressor pulls heat out of the evaporator. the evaporator mass is what
+makes the air keep cooling after a stop and keep warming after a start.
+
+the controller is the firmware itself: compressor_sim/control.c includes
+tasks/compressor_task.c with host stand-ins for the rtos, env and board
+headers, and is built twice as a shared library:
+
+    fixed     COMPRESSOR_TASK_ADAPTIVE_ENABLE 0, setting +/- offset hysteresis
+    adaptive  COMPRESSOR_TASK_ADAPTIVE_ENABLE 1, learned lag, no early stop with the door open
+
+the temperature task only reports a new cabinet temperature when it moved by
+--report-delta, so both controllers see the same coarse updates as on the
+board. run
+
+    python3 compressor_sim.py --hours 48 --doors 30
+
+and compare energy, cycles and deviation from the setting. --sweep runs both
+controllers over door rates, ambients and settings and fails where the
+adaptive control holds the temperature worse than the fixed hysteresis
+(rms deviation, or hold peak: the peak outside HOLD_AFTER_DOOR after each
+door opening) or uses more energy. the peak with the door transients and
+the cycles are printed for comparison:
+
+    python3 compressor_sim.py --sweep --hours 120
+"""
+import argparse
+import ctypes
+import math
+import multiprocessing
+import os
+import random
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+TASKS = os.path.join(HERE, '..', 'board', 'user', 'tasks')
+
+# compressor_task.h
+PWR_ON_WAIT_TIMEOUT = 2 * 60
+
+# the peak right after a door opening is the door, not the control: the
+# hold peak leaves out HOLD_AFTER_DOOR after every opening. it is compared
+# to the fixed control within the temperature report step, the controllers
+# only see the air in --report-delta steps
+HOLD_AFTER_DOOR = 30 * 60
+PEAK_TOLERANCE = 0.1
+
+
+class Plant(object):
+    """cabinet air + evaporator, temperatures in C, time in s"""
+
+    def __init__(self, args):
+        self.args = args
+        self.air = args.ambient
+        self.evaporator = args.ambient
+
+    def step(self, dt, on, door_open):
+        a = self.args
+        ua_ambient = a.ua_door if door_open else a.ua_cabinet
+        q_ambient = ua_ambient * (a.ambient - self.air)
+        q_evaporator = a.ua_evaporator * (self.evaporator - self.air)
+        q_compressor = -a.cooling_power if on else 0.0
+        self.air += (q_ambient + q_evaporator) / a.c_air * dt
+        self.evaporator += (q_compressor - q_evaporator) / a.c_evaporator * dt
+
+
+def door_schedule(args):
+    """list of (open second, close second)"""
+    rnd = random.Random(args.seed)
+    end = args.hours * 3600
+    doors = []
+    for _ in range(int(args.doors * args.hours / 24.0)):
+        start = rnd.uniform(PWR_ON_WAIT_TIMEOUT * 4, end)
+        doors.append((int(start), int(start + rnd.uniform(5, args.door_max))))
+    return sorted(doors)
+
+
+def build(out_dir):
+    """control library per COMPRESSOR_TASK_ADAPTIVE_ENABLE, {adaptive: path}"""
+    libs = {}
+    for adaptive in (False, True):
+        lib = os.path.join(out_dir, 'control_%d.so' % adaptive)
+        subprocess.check_call(['gcc', '-std=gnu99', '-funsigned-char', '-Wall', '-O2', '-shared', '-fPIC',
+                               '-DCOMPRESSOR_TASK_ADAPTIVE_ENABLE=%d' % adaptive,
+                               '-I', os.path.join(HERE, 'compressor_sim'), '-I', TASKS,
+                               os.path.join(HERE, 'compressor_sim', 'control.c'), '-o', lib])
+        libs[adaptive] = lib
+    return libs
+
+
+class Control(object):
+    """compressor_task.c through control.c, one instance per process"""
+
+    def __init__(self, lib, setting):
+        self.lib = ctypes.CDLL(lib)
+        self.lib.control_temperature.argtypes = [ctypes.c_float]
+        self.lib.control_init(setting)
+
+    def tick(self):
+        self.lib.control_tick_advance(1000)
+
+    def door_status(self, door_open):
+        self.lib.control_door(1 if door_open else 0)
+
+    def temperature_update(self, t):
+        self.lib.control_temperature(t)
+
+    @property
+    def on(self):
+        return self.lib.control_on() != 0
+
+    def model(self):
+        out = (ctypes.c_float * 4)()
+        if self.lib.control_model(out) != 0:
+            return None
+        return list(out)
+
+
+def run(args, lib, doors):
+    plant = Plant(args)
+    compressor = Control(lib, args.setting)
+    reported = None
+    door_index = 0
+    door_open = False
+    on_seconds = 0
+    cycles = 0
+    square = 0.0
+    samples = 0
+    lo, hi, hold = None, None, None
+    door_closed = None
+    settle = args.settle * 3600
+    for second in range(int(args.hours * 3600)):
+        was_on = compressor.on
+        compressor.tick()
+        opened = door_index < len(doors) and doors[door_index][0] <= second < doors[door_index][1]
+        if door_index < len(doors) and second >= doors[door_index][1]:
+            door_index += 1
+        if opened != door_open:
+            door_open = opened
+            compressor.door_status(door_open)
+            if not door_open:
+                door_closed = second
+        plant.step(1.0, compressor.on, door_open)
+        # temperature task only reports changes
+        measured = round(plant.air / args.resolution) * args.resolution
+        if reported is None or abs(measured - reported) >= args.report_delta:
+            reported = measured
+            compressor.temperature_update(reported)
+        if second >= settle:
+            on = compressor.on
+            if on:
+                on_seconds += 1
+            if on and not was_on:
+                cycles += 1
+            deviation = plant.air - args.setting
+            square += deviation * deviation
+            samples += 1
+            lo = plant.air if lo is None else min(lo, plant.air)
+            hi = plant.air if hi is None else max(hi, plant.air)
+            if not door_open and (door_closed is None or second - door_closed >= HOLD_AFTER_DOOR):
+                hold = plant.air if hold is None else max(hold, plant.air)
+    hours = args.hours - args.settle
+    return {
+        "energy": on_seconds * args.electric_power / 3600.0 / 1000.0,
+        "duty": 100.0 * on_seconds / max(samples, 1),
+        "cycles": cycles / hours * 24.0,
+        "rms": math.sqrt(square / max(samples, 1)),
+        "min": lo,
+        "max": hi,
+        "hold": hold,
+        "model": compressor.model(),
+    }
+
+
+def run_job(job):
+    args, lib = job
+    return run(args, lib, door_schedule(args))
+
+
+def run_all(jobs):
+    """every run in a fresh process, the task state in the library is static"""
+    with multiprocessing.get_context('fork').Pool() as pool:
+        return pool.map(run_job, jobs, chunksize=1)
+
+
+SWEEP_DOORS = (0, 30, 60)
+SWEEP_AMBIENT = (20, 30)
+SWEEP_SETTING = (2, 6)
+
+
+def sweep(args, libs):
+    conditions = []
+    jobs = []
+    for doors in SWEEP_DOORS:
+        for ambient in SWEEP_AMBIENT:
+            for setting in SWEEP_SETTING:
+                conditions.append((doors, ambient, setting))
+                for adaptive in (False, True):
+                    case = argparse.Namespace(**vars(args))
+                    case.doors, case.ambient, case.setting = doors, ambient, setting
+                    jobs.append((case, libs[adaptive]))
+    results = run_all(jobs)
+    print("%5s %7s %7s  %-34s %-34s %s" % ("doors", "ambient", "setting", "fixed kWh cycles rms hold max",
+                                            "adaptive kWh cycles rms hold max", "result"))
+    failed = 0
+    for i, (doors, ambient, setting) in enumerate(conditions):
+        f, a = results[2 * i], results[2 * i + 1]
+        ok = (a["energy"] < f["energy"] and a["rms"] <= f["rms"] and
+              a["hold"] <= f["hold"] + PEAK_TOLERANCE)
+        failed += 0 if ok else 1
+        print("%5d %7d %7d  %6.3f %5.1f %5.2f %5.2f %5.2f   %6.3f %5.1f %5.2f %5.2f %5.2f   %s" % (
+            doors, ambient, setting, f["energy"], f["cycles"], f["rms"], f["hold"], f["max"],
+            a["energy"], a["cycles"], a["rms"], a["hold"], a["max"], "ok" if ok else "FAIL"))
+    print("result: %s" % ("FAIL" if failed else "ok"))
+    return 1 if failed else 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--hours", type=float, default=48, help="simulated time")
+    parser.add_argument("--settle", type=float, default=6, help="hours ignored at the start while the model learns")
+    parser.add_argument("--setting", type=int, default=6, help="temperature setting C")
+    parser.add_argument("--ambient", type=float, default=30, help="ambient temperature C")
+    parser.add_argument("--doors", type=float, default=24, help="door openings per day")
+    parser.add_argument("--door-max", type=float, default=60, help="longest door opening s")
+    parser.add_argument("--seed", type=int, default=1, help="door schedule seed")
+    parser.add_argument("--c-air", type=float, default=20000, help="cabinet air + content heat capacity J/K")
+    parser.add_argument("--c-evaporator", type=float, default=15000, help="evaporator heat capacity J/K")
+    parser.add_argument("--ua-cabinet", type=float, default=1.5, help="cabinet wall conductance W/K")
+    parser.add_argument("--ua-door", type=float, default=40, help="conductance with the door open W/K")
+    parser.add_argument("--ua-evaporator", type=float, default=12, help="evaporator to air conductance W/K")
+    parser.add_argument("--cooling-power", type=float, default=150, help="heat pulled out by the compressor W")
+    parser.add_argument("--electric-power", type=float, default=80, help="compressor electric power W")
+    parser.add_argument("--resolution", type=float, default=0.01, help="temperature resolution C")
+    parser.add_argument("--report-delta", type=float, default=0.1, help="temperature change reported to the compressor C")
+    parser.add_argument("--sweep", action="store_true", help="compare both controllers over the SWEEP_* conditions")
+    args = parser.parse_args()
+    if args.settle >= args.hours:
+        parser.error("--settle must be shorter than --hours")
+
+    with tempfile.TemporaryDirectory() as out_dir:
+        libs = build(out_dir)
+        if args.sweep:
+            return sweep(args, libs)
+        results = run_all([(args, libs[False]), (args, libs[True])])
+
+    print("%-9s %10s %7s %10s %8s %8s %8s %8s" % ("control", "energy kWh", "duty %", "cycles/day", "rms C", "min C",
+                                                   "hold C", "max C"))
+    for name, r in zip(("fixed", "adaptive"), results):
+        print("%-9s %10.3f %7.1f %10.1f %8.2f %8.2f %8.2f %8.2f" % (name, r["energy"], r["duty"], r["cycles"], r["rms"],
+                                                                 r["min"], r["hold"], r["max"]))
+        if r["model"] is not None:
+            print("learned   cool %.3f C/min warm %.3f C/min stop lag %.2f min work lag %.2f min" % tuple(r["model"]))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
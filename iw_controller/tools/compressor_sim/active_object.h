@@ -0,0 +1,46 @@
+/*
+ * host stand-in for board/user/active_object/active_object.h. events
+ * posted to the compressor task go to the queue of control.c, timers
+ * expire on control_tick.
+ */
+#ifndef __ACTIVE_OBJECT_H__
+#define __ACTIVE_OBJECT_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cmsis_os.h"
+#include "msg_pool.h"
+
+typedef struct active_object active_object_t;
+typedef struct active_object_timer active_object_timer_t;
+
+typedef void (*active_object_init_t)(active_object_t *ao);
+typedef void (*active_object_handler_t)(active_object_t *ao,const void *event);
+
+struct active_object
+{
+    const char                *name;
+    active_object_init_t      init;
+    active_object_handler_t   handler;
+    msg_pool_t                *pool;
+};
+
+struct active_object_timer
+{
+    active_object_t           *ao;
+    const void                *event;
+    uint32_t                  period;
+    uint32_t                  expire;
+    bool                      armed;
+    active_object_timer_t     *next;
+};
+
+#define  ACTIVE_OBJECT_DEF(ao,init,handler,pool)                               \
+active_object_t ao = { #ao,(init),(handler),(pool) }
+
+osStatus active_object_post(active_object_t *ao,const void *event,uint32_t timeout);
+void active_object_timer_init(active_object_timer_t *timer,active_object_t *ao,const void *event);
+void active_object_timer_start(active_object_timer_t *timer,uint32_t timeout,uint32_t period);
+void active_object_timer_stop(active_object_timer_t *timer);
+
+#endif
@@ -0,0 +1,10 @@
+/*
+ * host stand-in for board.h, the compressor relay of the plant model
+ */
+#ifndef __BOARD_H__
+#define __BOARD_H__
+
+void bsp_compressor_ctrl_pwr_on(void);
+void bsp_compressor_ctrl_pwr_off(void);
+
+#endif
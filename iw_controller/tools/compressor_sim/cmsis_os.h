@@ -0,0 +1,30 @@
+/*
+ * host stand-in for board/user/rtos/cmsis_os.h, compressor_sim.py drives
+ * the compressor task single threaded and owns the tick.
+ */
+#ifndef __CMSIS_OS_H__
+#define __CMSIS_OS_H__
+
+#include <stdint.h>
+
+#define  portTICK_PERIOD_MS              1
+
+typedef void *osMessageQId;
+typedef void *osThreadId;
+
+typedef enum
+{
+    osOK = 0,
+    osErrorResource = 0x81,
+    osErrorOS = 0xFF
+}osStatus;
+
+/*current time of the plant model, see control.c*/
+extern uint32_t control_tick;
+
+static inline uint32_t osKernelSysTick(void)
+{
+    return control_tick;
+}
+
+#endif
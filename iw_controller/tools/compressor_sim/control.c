@@ -0,0 +1,203 @@
+/*
+ * host build of the compressor control (tasks/compressor_task.c) for
+ * compressor_sim.py. the task source is included as is, so the plant
+ * drives the same handler, switch checks and adaptive model as the
+ * board; COMPRESSOR_TASK_ADAPTIVE_ENABLE comes from the compiler line.
+ *
+ * compressor_sim.py loads it with ctypes, one process per run because
+ * the task state is static:
+ *
+ *   control_init(setting)       power on with the setting in the env
+ *   control_tick_advance(ms)    advance the tick, expire timers
+ *   control_temperature(t)      temperature task update, C
+ *   control_door(open)          door status
+ *   control_on()                compressor relay, 1 on
+ *   control_model(out)          learned cool/warm rate and stop/work lag,
+ *                               -1 without the adaptive control
+ *
+ * every call dispatches the events it caused before returning, like the
+ * control thread between two ticks.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "compressor_task.c"
+
+#define  CONTROL_QUEUE_SIZE            COMPRESSOR_TASK_MSG_Q_SIZE
+#define  CONTROL_TIMER_CNT             4
+
+uint32_t control_tick;
+
+static compressor_task_message_t control_queue[CONTROL_QUEUE_SIZE];
+static uint8_t control_queue_head,control_queue_cnt;
+static active_object_timer_t *control_timer[CONTROL_TIMER_CNT];
+static uint8_t control_timer_cnt;
+static int control_relay;
+static int32_t control_setting;
+
+osStatus active_object_post(active_object_t *ao,const void *event,uint32_t timeout)
+{
+    (void)ao;
+    (void)timeout;
+    if (control_queue_cnt >= CONTROL_QUEUE_SIZE) {
+        fprintf(stderr,"[control] queue full.\n");
+        return osErrorResource;
+    }
+    memcpy(&control_queue[(control_queue_head + control_queue_cnt) % CONTROL_QUEUE_SIZE],event,sizeof(compressor_task_message_t));
+    control_queue_cnt ++;
+    return osOK;
+}
+
+void active_object_timer_init(active_object_timer_t *timer,active_object_t *ao,const void *event)
+{
+    timer->ao = ao;
+    timer->event = event;
+    timer->armed = false;
+    if (control_timer_cnt < CONTROL_TIMER_CNT) {
+        control_timer[control_timer_cnt ++] = timer;
+    }
+}
+
+void active_object_timer_start(active_object_timer_t *timer,uint32_t timeout,uint32_t period)
+{
+    timer->expire = control_tick + timeout / portTICK_PERIOD_MS;
+    timer->period = period / portTICK_PERIOD_MS;
+    timer->armed = true;
+}
+
+void active_object_timer_stop(active_object_timer_t *timer)
+{
+    timer->armed = false;
+}
+
+void bsp_compressor_ctrl_pwr_on(void)
+{
+    control_relay = 1;
+}
+
+void bsp_compressor_ctrl_pwr_off(void)
+{
+    control_relay = 0;
+}
+
+void history_task_post(uint8_t type,uint8_t arg,int16_t value)
+{
+    (void)type;
+    (void)arg;
+    (void)value;
+}
+
+int device_env_get_copy(char *name,char *buffer,uint16_t size)
+{
+    (void)name;
+    (void)buffer;
+    (void)size;
+    return -1;
+}
+
+int device_env_set(char *name,char *value)
+{
+    (void)name;
+    (void)value;
+    return 0;
+}
+
+int device_env_get_int(char *name,int32_t *value)
+{
+    if (strcmp(name,COMPRESSOR_TASK_TEMPERATURE_ENV_NAME) != 0) {
+        return -1;
+    }
+    *value = control_setting;
+    return 0;
+}
+
+int device_env_set_int(char *name,int32_t value)
+{
+    (void)name;
+    (void)value;
+    return 0;
+}
+
+static void control_dispatch(void)
+{
+    compressor_task_message_t msg;
+
+    while (control_queue_cnt > 0) {
+        msg = control_queue[control_queue_head];
+        control_queue_head = (control_queue_head + 1) % CONTROL_QUEUE_SIZE;
+        control_queue_cnt --;
+        compressor_task_ao.handler(&compressor_task_ao,&msg);
+    }
+}
+
+static void control_post(const compressor_task_message_t *msg)
+{
+    active_object_post(&compressor_task_ao,msg,0);
+    control_dispatch();
+}
+
+void control_init(int32_t setting)
+{
+    control_setting = setting;
+    compressor_task_ao.init(&compressor_task_ao);
+    control_dispatch();
+}
+
+void control_tick_advance(uint32_t ms)
+{
+    active_object_timer_t *timer;
+
+    control_tick += ms / portTICK_PERIOD_MS;
+    for (uint8_t i = 0;i < control_timer_cnt;i ++) {
+        timer = control_timer[i];
+        if (timer->armed == false || (int32_t)(control_tick - timer->expire) < 0) {
+            continue;
+        }
+        if (timer->period > 0) {
+            timer->expire += timer->period;
+        } else {
+            timer->armed = false;
+        }
+        control_post(timer->event);
+    }
+}
+
+void control_temperature(float temperature)
+{
+    compressor_task_message_t msg;
+
+    memset(&msg,0,sizeof(msg));
+    msg.request.type = COMPRESSOR_TASK_MSG_TYPE_TEMPERATURE_UPDATE;
+    msg.request.temperature_float = temperature;
+    msg.request.temperature_int = (int16_t)(temperature < 0 ? temperature - 0.5f : temperature + 0.5f);
+    control_post(&msg);
+}
+
+void control_door(int open)
+{
+    compressor_task_message_t msg;
+
+    memset(&msg,0,sizeof(msg));
+    msg.request.type = COMPRESSOR_TASK_MSG_TYPE_DOOR_STATUS;
+    msg.request.door_open = open ? 1 : 0;
+    control_post(&msg);
+}
+
+int control_on(void)
+{
+    return control_relay;
+}
+
+int control_model(float *out)
+{
+#if COMPRESSOR_TASK_ADAPTIVE_ENABLE > 0
+    out[0] = adaptive.cool_rate;
+    out[1] = adaptive.warm_rate;
+    out[2] = adaptive.stop_lag;
+    out[3] = adaptive.work_lag;
+    return 0;
+#else
+    (void)out;
+    return -1;
+#endif
+}
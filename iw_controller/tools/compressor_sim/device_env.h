@@ -0,0 +1,15 @@
+/*
+ * host stand-in for board/user/device_env/device_env.h, the setting of
+ * the run and no stored stats
+ */
+#ifndef __DEVICE_ENV_H__
+#define __DEVICE_ENV_H__
+
+#include <stdint.h>
+
+int device_env_get_copy(char *name,char *buffer,uint16_t size);
+int device_env_set(char *name,char *value);
+int device_env_get_int(char *name,int32_t *value);
+int device_env_set_int(char *name,int32_t value);
+
+#endif
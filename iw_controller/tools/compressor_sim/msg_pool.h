@@ -0,0 +1,33 @@
+/*
+ * host stand-in for board/user/msg_pool/msg_pool.h, only the pool
+ * definition and the response path the compressor task uses.
+ */
+#ifndef __MSG_POOL_H__
+#define __MSG_POOL_H__
+
+#include <stdint.h>
+#include "cmsis_os.h"
+
+typedef struct
+{
+    const char *name;
+    uint8_t    *block;
+    uint32_t   size;
+    uint32_t   cnt;
+}msg_pool_t;
+
+#define  MSG_POOL_DEF(pool,type,cnt)                                           \
+static type pool##_block[(cnt)];                                               \
+msg_pool_t pool = { #pool,(uint8_t *)pool##_block,sizeof(type),(cnt) }
+
+/*responses to the communication task, the plant has none*/
+static inline osStatus msg_pool_send(msg_pool_t *pool,osMessageQId queue,const void *msg,uint32_t timeout)
+{
+    (void)pool;
+    (void)queue;
+    (void)msg;
+    (void)timeout;
+    return osOK;
+}
+
+#endif
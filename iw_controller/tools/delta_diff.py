@@ -0,0 +1,290 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+host diff tool for delta firmware updates (lib/delta.c).
+
+makes a patch that turns the application installed on the controller
+(old.bin, the image whose md5 is app_md5 in device_env) into new.bin.
+the controller reads the old image from APPLICATION_BASE_ADDR while the
+patch arrives and writes the result to the update area through a 256
+byte buffer, then checks the new image's md5 from the patch header
+before it sets the update flag. a patch made for another image is
+refused before anything is written.
+
+    python3 delta_diff.py old.bin new.bin new.patch
+    python3 ymodem_send.py --port /dev/ttyUSB0 new.patch
+
+the patch is lzss packed (lzss_pack.py) when that makes it smaller and
+not --raw; the controller unpacks and patches in one pass. -a applies
+a patch on the host.
+
+format, little endian:
+
+    header   "DLT1", old size (4), new size (4), reserved (4),
+             old md5 (16), new md5 (16)
+    ops      COPY 0x00 length seek            old bytes
+             ADD  0x01 length seek + length   old bytes + difference bytes
+             DATA 0x02 length + length        new bytes
+             length is an unsigned varint (7 bits per byte, msb = more),
+             seek moves the old image position before the op, zigzag
+             signed varint. the position advances with COPY and ADD.
+
+matching is bsdiff like: exact matches of 8 bytes or more through a
+k-gram index, extended backwards over pending new bytes and forwards
+while same offset bytes agree more often than not. code that moved
+keeps its offset, so the changed branch and pointer bytes become small
+repeated ADD differences that pack well.
+"""
+import argparse
+import hashlib
+import os
+import struct
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import lzss_pack  # noqa: E402
+
+MAGIC = b'DLT1'
+HEADER = struct.Struct('<4sIII16s16s')
+OP_COPY = 0
+OP_ADD = 1
+OP_DATA = 2
+
+K = 8                   # index k-gram and shortest exact match
+CANDIDATES_MAX = 32     # positions kept per k-gram
+EXTEND_DROP = 16        # approximate extension stops this far below its best score
+COPY_RUN_MIN = 16       # equal runs at least this long become COPY inside an ADD
+
+
+class FormatError(Exception):
+    pass
+
+
+def varint(v):
+    out = bytearray()
+    while True:
+        b = v & 0x7f
+        v >>= 7
+        if v:
+            out.append(b | 0x80)
+        else:
+            out.append(b)
+            return bytes(out)
+
+
+def zigzag(v):
+    return v * 2 if v >= 0 else -v * 2 - 1
+
+
+def build_index(src):
+    index = {}
+    for p in range(len(src) - K + 1):
+        lst = index.setdefault(src[p:p + K], [])
+        if len(lst) < CANDIDATES_MAX:
+            lst.append(p)
+    return index
+
+
+def exact_length(src, tgt, s, t):
+    n = min(len(src) - s, len(tgt) - t)
+    length = 0
+    while length < n and src[s + length] == tgt[t + length]:
+        length += 1
+    return length
+
+
+def extend(src, tgt, s, t, length):
+    """end (exclusive, in tgt) of the approximate match at the same offset"""
+    end = t + length
+    k = end
+    score = best = 0
+    limit = min(len(tgt), len(src) - s + t)
+    while k < limit:
+        score += 1 if src[s + k - t] == tgt[k] else -1
+        k += 1
+        if score > best:
+            best, end = score, k
+        elif score < best - EXTEND_DROP:
+            break
+    return end
+
+
+def match_ops(src, tgt):
+    """[(op, tgt start, tgt end, src start)]"""
+    index = build_index(src)
+    ops = []
+    lit = 0
+    i = 0
+    offset = 0
+    n = len(tgt)
+    while i < n:
+        best_len, best_s = 0, -1
+        # the previous offset first, an equal match there needs no seek
+        predicted = i + offset
+        if 0 <= predicted < len(src):
+            best_len, best_s = exact_length(src, tgt, predicted, i), predicted
+        if best_len < K and i + K <= n:
+            for s in index.get(tgt[i:i + K], ()):
+                length = exact_length(src, tgt, s, i)
+                if length > best_len:
+                    best_len, best_s = length, s
+        if best_len < K:
+            i += 1
+            continue
+        t, s = i, best_s
+        while t > lit and s > 0 and src[s - 1] == tgt[t - 1]:
+            t -= 1
+            s -= 1
+        if t > lit:
+            ops.append((OP_DATA, lit, t, 0))
+        end = extend(src, tgt, s, t, i + best_len - t)
+        ops.append((OP_ADD, t, end, s))
+        offset = s - t
+        i = lit = end
+    if lit < n:
+        ops.append((OP_DATA, lit, n, 0))
+    return ops
+
+
+def split_add(src, tgt, t, end, s):
+    """long equal runs of an ADD region become COPY"""
+    parts = []
+    k = t
+    start = t
+    while k < end:
+        if src[s + k - t] != tgt[k]:
+            k += 1
+            continue
+        run = k
+        while k < end and src[s + k - t] == tgt[k]:
+            k += 1
+        if k - run >= COPY_RUN_MIN or (run == start and k == end):
+            if run > start:
+                parts.append((OP_ADD, start, run))
+            parts.append((OP_COPY, run, k))
+            start = k
+    if start < end:
+        parts.append((OP_ADD, start, end))
+    return parts
+
+
+def diff(src, tgt):
+    out = bytearray(HEADER.pack(MAGIC, len(src), len(tgt), 0,
+                                hashlib.md5(src).digest(), hashlib.md5(tgt).digest()))
+    pos = 0
+    for op, t, end, s in match_ops(src, tgt):
+        if op == OP_DATA:
+            out += bytes([OP_DATA]) + varint(end - t) + tgt[t:end]
+            continue
+        for kind, a, b in split_add(src, tgt, t, end, s):
+            sa = s + a - t
+            out += bytes([kind]) + varint(b - a) + varint(zigzag(sa - pos))
+            if kind == OP_ADD:
+                out += bytes((tgt[a + k] - src[sa + k]) & 0xff for k in range(b - a))
+            pos = sa + b - a
+    return bytes(out)
+
+
+def read_varint(patch, p):
+    v = shift = 0
+    while True:
+        b = patch[p]
+        p += 1
+        v |= (b & 0x7f) << shift
+        shift += 7
+        if not b & 0x80:
+            return v, p
+        if shift > 28:
+            raise FormatError('varint too long')
+
+
+def apply(src, patch):
+    """reference patcher, same checks as delta_patch(). takes lzss packed
+    patches too"""
+    if lzss_pack.MAGIC == patch[:4]:
+        patch = lzss_pack.unpack(patch)
+    if len(patch) < HEADER.size:
+        raise FormatError('short header')
+    magic, src_size, size, _, src_md5, md5 = HEADER.unpack_from(patch)
+    if magic != MAGIC:
+        raise FormatError('bad magic')
+    if src_size != len(src) or src_md5 != hashlib.md5(src).digest():
+        raise FormatError('patch not made for this image')
+    out = bytearray()
+    p = HEADER.size
+    pos = 0
+    try:
+        while len(out) < size:
+            op = patch[p]
+            length, p = read_varint(patch, p + 1)
+            if op > OP_DATA or length == 0 or len(out) + length > size:
+                raise FormatError('bad op at %d' % p)
+            if op == OP_DATA:
+                if p + length > len(patch):
+                    raise FormatError('truncated')
+                out += patch[p:p + length]
+                p += length
+                continue
+            seek, p = read_varint(patch, p)
+            pos += seek >> 1 if not seek & 1 else -((seek >> 1) + 1)
+            if pos < 0 or pos + length > len(src):
+                raise FormatError('seek out of image at %d' % p)
+            if op == OP_COPY:
+                out += src[pos:pos + length]
+            else:
+                if p + length > len(patch):
+                    raise FormatError('truncated')
+                out += bytes((src[pos + k] + patch[p + k]) & 0xff for k in range(length))
+                p += length
+            pos += length
+    except IndexError:
+        raise FormatError('truncated')
+    if p != len(patch):
+        raise FormatError('data after end')
+    if hashlib.md5(out).digest() != md5:
+        raise FormatError('md5 mismatch')
+    return bytes(out)
+
+
+def make(src, tgt, raw=False, window_bits=lzss_pack.WINDOW_BITS):
+    """packed patch, or the raw one when packing does not gain"""
+    patch = diff(src, tgt)
+    if raw:
+        return patch
+    packed = lzss_pack.pack(patch, window_bits)
+    return packed if len(packed) < len(patch) else patch
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument('old')
+    ap.add_argument('new', help='new image, or the patch with -a')
+    ap.add_argument('output')
+    ap.add_argument('-a', '--apply', action='store_true')
+    ap.add_argument('--raw', action='store_true', help='do not lzss pack the patch')
+    ap.add_argument('--window', type=int, default=lzss_pack.WINDOW_BITS, help='lzss window bits')
+    args = ap.parse_args()
+
+    with open(args.old, 'rb') as f:
+        src = f.read()
+    with open(args.new, 'rb') as f:
+        data = f.read()
+    if args.apply:
+        out = apply(src, data)
+    else:
+        out = make(src, data, args.raw, args.window)
+        if apply(src, out) != data:
+            sys.exit('self check failed')
+    with open(args.output, 'wb') as f:
+        f.write(out)
+    if not args.apply:
+        print('%s -> %s: patch %d bytes (%.1f%% of %d), md5 %s' %
+              (args.old, args.new, len(out), 100.0 * len(out) / max(len(data), 1), len(data),
+               hashlib.md5(out).hexdigest()))
+        print('old md5 %s, new md5 %s' % (hashlib.md5(src).hexdigest(), hashlib.md5(data).hexdigest()))
+        if len(out) >= len(lzss_pack.pack(data, args.window)):
+            print('no gain over the packed image, send lzss_pack.py output instead')
+
+
+if __name__ == '__main__':
+    main()
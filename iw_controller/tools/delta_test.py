@@ -0,0 +1,206 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+round trip test of delta firmware updates.
+
+makes patches with delta_diff.py for a corpus of old/new image pairs,
+builds the firmware chain (lib/lzss.c -> lib/delta.c, lib/md5.c) for the
+host with the stand-ins in delta_test/ and applies every patch fed in
+random chunk sizes like ymodem packets. the output and its md5 must
+match the new image. each patch is also applied to a wrong old image,
+which must be refused, and truncated and bit flipped patches go to a
+sanitizer build, which must never produce a wrong image with a good md5.
+
+the corpus starts from the application like image of lzss_test.py and
+changes it the way a release does: a few constants, a longer log
+string, code inserted or removed with everything behind it moved (the
+vector table, literal pool pointers and some branch offsets follow), a
+large rewrite, and an unrelated image as the worst case. real images
+go with --pairs:
+
+    python3 delta_test.py
+    python3 delta_test.py --pairs v1.bin v2.bin v2.bin v3.bin
+
+sizes are compared with sending the image raw and lzss packed; the link
+columns are the transfer times at 115200 baud.
+"""
+import argparse
+import hashlib
+import os
+import random
+import subprocess
+import sys
+import tempfile
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import delta_diff  # noqa: E402
+import lzss_pack  # noqa: E402
+import lzss_test  # noqa: E402
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+LIB = lzss_test.LIB
+SIZE_LIMIT = lzss_test.SIZE_LIMIT
+BAUD = lzss_test.BAUD
+FLASH_BASE = 0x8000     # APPLICATION_BASE_ADDR
+
+
+def build(out_dir, name, flags):
+    exe = os.path.join(out_dir, name)
+    cmd = ['gcc', '-std=gnu99', '-funsigned-char', '-Wall'] + flags + [
+        '-I', os.path.join(HERE, 'delta_test'), '-I', LIB,
+        os.path.join(HERE, 'delta_test', 'apply.c'), os.path.join(LIB, 'delta.c'),
+        os.path.join(LIB, 'lzss.c'), os.path.join(LIB, 'md5.c'), '-o', exe]
+    subprocess.check_call(cmd)
+    return exe
+
+
+def used(image):
+    """length without the erased flash tail"""
+    return len(image.rstrip(b'\xff'))
+
+
+def relocate(image, at, shift, rng):
+    """move everything from at by shift like the linker would: words
+    pointing behind at follow, some branches across the gap change"""
+    out = bytearray(image)
+    end = used(image)
+    for p in range(0, end - 3, 4):
+        v = int.from_bytes(out[p:p + 4], 'little')
+        if FLASH_BASE + at <= (v & ~1) < FLASH_BASE + end:
+            out[p:p + 4] = ((v + shift) & 0xffffffff).to_bytes(4, 'little')
+    for _ in range(end // 256):
+        p = rng.randrange(0, end - 1) & ~1
+        out[p] = (out[p] + shift // 2) & 0xff
+    return bytes(out)
+
+
+def resize(image, at, data, remove=0):
+    """insert data (or remove bytes) at at, keep the image size"""
+    end = used(image)
+    shift = len(data) - remove
+    moved = relocate(image, at, shift, random.Random(at))
+    body = moved[:at] + data + moved[at + remove:end]
+    return body + b'\xff' * (len(image) - len(body))
+
+
+def corpus(seed):
+    """[(name, old, new)]"""
+    rng = random.Random(seed)
+    old = lzss_test.corpus(seed)['app_like.bin']
+    end = used(old)
+    pairs = [('identical', old, old)]
+
+    new = bytearray(old)
+    for _ in range(16):
+        p = rng.randrange(end // 4) * 4
+        new[p:p + 4] = rng.randrange(1 << 32).to_bytes(4, 'little')
+    pairs.append(('constants', old, bytes(new)))
+
+    s = old.find(b'\0', end * 3 // 4) + 1
+    text = b'update image verified, set flag. '
+    pairs.append(('log_string', old, resize(old, s, text)))
+
+    code = old[rng.randrange(0x100, end // 2):][:512]
+    pairs.append(('code_insert', old, resize(old, end * 2 // 5, code)))
+    pairs.append(('code_remove', old, resize(old, end // 3, b'', 1024)))
+
+    both = resize(resize(old, end // 4, code[:200]), end * 3 // 5, b'', 300)
+    pairs.append(('insert_remove', old, both))
+
+    new = bytearray(old)
+    a = rng.randrange(end // 2)
+    new[a:a + end * 3 // 10] = bytes(rng.randrange(256) for _ in range(end * 3 // 10))
+    pairs.append(('rewrite_30%', old, bytes(new)))
+
+    pairs.append(('unrelated', old, bytes(rng.randrange(256) for _ in range(32768))))
+    return pairs
+
+
+def run(exe, old, update, seed, repeat, work):
+    paths = [os.path.join(work, n) for n in ('old.bin', 'update.bin', 'out.bin')]
+    for path, data in zip(paths, (old, update)):
+        with open(path, 'wb') as f:
+            f.write(data)
+    p = subprocess.run([exe] + paths + [str(seed), str(repeat)], stdout=subprocess.PIPE,
+                       stderr=subprocess.PIPE)
+    if p.returncode < 0 or b'runtime error' in p.stderr or b'AddressSanitizer' in p.stderr:
+        raise RuntimeError('patcher crashed:\n' + p.stderr.decode(errors='replace'))
+    parts = p.stdout.split()
+    with open(paths[2], 'rb') as f:
+        out = f.read()
+    return {'done': parts[1] == b'1', 'md5_ok': parts[3] == b'1', 'us': float(parts[4]), 'out': out}
+
+
+def damage(exe, old, patch, new, rng, count, work):
+    bad = 0
+    for i in range(count):
+        buf = bytearray(patch)
+        if i % 2 == 0:
+            buf = buf[:rng.randrange(len(buf))]
+        else:
+            for _ in range(1 + rng.randrange(3)):
+                pos = rng.randrange(len(buf))
+                buf[pos] ^= 1 << rng.randrange(8)
+        r = run(exe, old, bytes(buf), rng.randrange(1 << 30), 0, work)
+        if r['md5_ok'] and r['out'] != new:
+            bad += 1
+    return bad
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument('--pairs', nargs='+', help='old new [old new ...] images instead of the built in corpus')
+    ap.add_argument('--repeat', type=int, default=50, help='applies per speed measurement')
+    ap.add_argument('--damage', type=int, default=40, help='damaged patches per pair')
+    ap.add_argument('--seed', type=int, default=1)
+    args = ap.parse_args()
+
+    if args.pairs:
+        if len(args.pairs) % 2:
+            ap.error('--pairs takes old and new images')
+        pairs = []
+        for o, n in zip(args.pairs[::2], args.pairs[1::2]):
+            pairs.append((os.path.basename(n), open(o, 'rb').read(), open(n, 'rb').read()))
+    else:
+        pairs = corpus(args.seed)
+    work = tempfile.mkdtemp()
+    fast = build(work, 'apply', ['-O2'])
+    checked = build(work, 'apply_san', lzss_test.sanitizer_flags())
+    rng = random.Random(args.seed)
+
+    print('%-14s %6s %6s %6s %6s %6s %6s %7s %14s %6s %6s %4s' %
+          ('pair', 'image', 'packed', 'diff', 'patch', 'ratio', 'diff s', 'MB/s', 'link s', 'wrong', 'damage', 'ok'))
+    failed = 0
+    for name, old, new in pairs:
+        start = time.monotonic()
+        raw = delta_diff.diff(old, new)
+        patch = delta_diff.make(old, new)
+        diff_time = time.monotonic() - start
+        packed = lzss_pack.pack(new)
+        r = run(fast, old, patch, rng.randrange(1 << 30), args.repeat, work)
+        ok = r['done'] and r['md5_ok'] and r['out'] == new
+        for update in (raw, patch):
+            s = run(checked, old, update, rng.randrange(1 << 30), 0, work)
+            ok = ok and s['md5_ok'] and s['out'] == new
+        # another image installed: refused before anything is written
+        other = bytearray(old)
+        other[rng.randrange(len(other))] ^= 0x01
+        w = run(checked, bytes(other), patch, rng.randrange(1 << 30), 0, work)
+        wrong_ok = not w['md5_ok'] and len(w['out']) == 0
+        bad = damage(checked, old, patch, new, rng, args.damage, work)
+        ok = ok and wrong_ok and bad == 0 and hashlib.md5(r['out']).digest() == hashlib.md5(new).digest()
+        mbs = len(new) / r['us'] if r['us'] else 0.0
+        link = '%4.1f/%3.1f/%3.1f' % (len(new) * 10.0 / BAUD, len(packed) * 10.0 / BAUD,
+                                     len(patch) * 10.0 / BAUD)
+        print('%-14s %6d %6d %6d %6d %5.1f%% %6.2f %7.1f %14s %6s %6d %4s' %
+              (name[:14], len(new), len(packed), len(raw), len(patch), 100.0 * len(patch) / max(len(new), 1),
+               diff_time, mbs, link, 'no' if wrong_ok else 'USED', bad, 'yes' if ok else 'NO'))
+        sys.stdout.flush()
+        failed += 0 if ok else 1
+    print('link s: raw/packed/patch')
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,173 @@
+/*
+ * host build of the firmware patcher (lib/delta.c behind lib/lzss.c)
+ * for delta_test.py. the update file is fed in random chunks like
+ * ymodem packets through the same chain as process_update(): lzss when
+ * the file is packed, then delta when the data is a patch, into a memory
+ * image the size of the update area. the old image stands in for the
+ * application at APPLICATION_BASE_ADDR, its md5 for app_md5. then the
+ * chain runs again <repeat> times in 1024 byte chunks for the speed.
+ *
+ * usage: apply <old image> <update file> <image out> <seed> <repeat>
+ * prints "result <done> <size> <md5 ok> <us per apply>" on stdout.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "lzss.h"
+#include "delta.h"
+#include "md5.h"
+
+#define  APPLY_SIZE_LIMIT          0x18000 /*APPLICATION_SIZE_LIMIT*/
+#define  APPLY_CHUNK_MAX           1100
+#define  APPLY_PACKET_SIZE         1024
+
+int log_enable = 1;
+
+typedef struct
+{
+    uint8_t        image[APPLY_SIZE_LIMIT];
+    uint32_t       size;
+    md5_ctx_t      md5;
+    bool           compressed;
+    bool           patched;
+    uint32_t       payload;   /*lzss output so far*/
+    lzss_decoder_t lzss;
+    delta_patch_t  delta;
+    const uint8_t *source;
+    uint32_t       source_size;
+    uint8_t        source_md5[HASHSIZE];
+}apply_contex_t;
+
+static apply_contex_t apply_contex;
+
+static int apply_image_write(void *arg,const uint8_t *data,uint32_t size)
+{
+    apply_contex_t *contex = (apply_contex_t *)arg;
+
+    /*same bound as the flash stream of the update area*/
+    if (contex->size + size > APPLY_SIZE_LIMIT) {
+        fprintf(stderr,"output over limit\n");
+        return -1;
+    }
+    memcpy(contex->image + contex->size,data,size);
+    contex->size += size;
+    md5_update(&contex->md5,(const char *)data,size);
+    return 0;
+}
+
+static int apply_payload_write(void *arg,const uint8_t *data,uint32_t size)
+{
+    apply_contex_t *contex = (apply_contex_t *)arg;
+
+    if (contex->payload == 0 && delta_is_patch(data,size)) {
+        contex->patched = true;
+        delta_patch_init(&contex->delta,contex->source,contex->source_size,contex->source_md5,apply_image_write,contex);
+    }
+    contex->payload += size;
+    if (contex->patched) {
+        return delta_patch(&contex->delta,data,size);
+    }
+    return apply_image_write(contex,data,size);
+}
+
+static int apply_file(const uint8_t *src,uint32_t size,unsigned int seed,uint32_t chunk)
+{
+    uint32_t part;
+    bool first = true;
+    int rc;
+
+    apply_contex.size = 0;
+    apply_contex.payload = 0;
+    apply_contex.compressed = false;
+    apply_contex.patched = false;
+    md5_init(&apply_contex.md5);
+    srand(seed);
+    while (size > 0) {
+        part = chunk > 0 ? chunk : 1 + (uint32_t)rand() % APPLY_CHUNK_MAX;
+        if (part > size) {
+            part = size;
+        }
+        if (first && lzss_is_compressed(src,part)) {
+            apply_contex.compressed = true;
+            lzss_decoder_init(&apply_contex.lzss,apply_payload_write,&apply_contex);
+        }
+        first = false;
+        rc = apply_contex.compressed ? lzss_decode(&apply_contex.lzss,src,part) : apply_payload_write(&apply_contex,src,part);
+        if (rc != 0) {
+            return -1;
+        }
+        src += part;
+        size -= part;
+    }
+    if (apply_contex.compressed && !lzss_decode_is_done(&apply_contex.lzss)) {
+        return -1;
+    }
+    if (apply_contex.patched && !delta_patch_is_done(&apply_contex.delta)) {
+        return -1;
+    }
+    return 0;
+}
+
+static uint32_t read_file(const char *name,uint8_t *buffer,uint32_t size)
+{
+    FILE *f = fopen(name,"rb");
+    uint32_t n;
+
+    if (f == NULL) {
+        exit(2);
+    }
+    n = (uint32_t)fread(buffer,1,size,f);
+    fclose(f);
+    return n;
+}
+
+int main(int argc,char *argv[])
+{
+    static uint8_t old[APPLY_SIZE_LIMIT];
+    static uint8_t file[2 * APPLY_SIZE_LIMIT];
+    char md5_value[HASHSIZE];
+    const uint8_t *expect = NULL;
+    struct timespec t0,t1;
+    uint32_t size;
+    int repeat,done,md5_ok;
+    double us = 0.0;
+    FILE *f;
+
+    if (argc < 6) {
+        fprintf(stderr,"usage: %s <old image> <update file> <image out> <seed> <repeat>\n",argv[0]);
+        return 2;
+    }
+    apply_contex.source = old;
+    apply_contex.source_size = read_file(argv[1],old,sizeof(old));
+    md5((const char *)old,apply_contex.source_size,(char *)apply_contex.source_md5);
+    size = read_file(argv[2],file,sizeof(file));
+    repeat = atoi(argv[5]);
+
+    done = apply_file(file,size,(unsigned int)atoi(argv[4]),0) == 0;
+    md5_final(&apply_contex.md5,md5_value);
+    /*the md5 process_update() checks: the innermost header's*/
+    if (apply_contex.patched) {
+        expect = apply_contex.delta.md5;
+    } else if (apply_contex.compressed) {
+        expect = apply_contex.lzss.md5;
+    }
+    md5_ok = done && expect != NULL && memcmp(md5_value,expect,HASHSIZE) == 0;
+    f = fopen(argv[3],"wb");
+    if (f != NULL) {
+        fwrite(apply_contex.image,1,apply_contex.size,f);
+        fclose(f);
+    }
+
+    if (md5_ok && repeat > 0) {
+        log_enable = 0;
+        clock_gettime(CLOCK_MONOTONIC,&t0);
+        for (int i = 0; i < repeat; i++) {
+            apply_file(file,size,0,APPLY_PACKET_SIZE);
+        }
+        clock_gettime(CLOCK_MONOTONIC,&t1);
+        us = ((t1.tv_sec - t0.tv_sec) * 1e6 + (t1.tv_nsec - t0.tv_nsec) / 1e3) / repeat;
+    }
+    printf("result %d %u %d %.1f\n",done,apply_contex.size,md5_ok,us);
+    return md5_ok ? 0 : 1;
+}
@@ -0,0 +1,85 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+power cut test of the env storage (device_env/device_env.c).
+
+builds device_env.c for the host with the stand-ins in env_power_cut/,
+where the eeprom is a memory array that loses power before a given
+byte of a write. a random sequence of boots, sets, deletes, write back
+barriers and bootloader rewrites of the legacy env is cut at every byte
+it writes (see env_power_cut/cut.c). after each cut the boot must give
+every name its value before or after the interrupted step, the
+bootloader must read the same bootloader keys from the legacy env and
+its backup as the application, and the following steps must reach the
+expected state. one run goes to a sanitizer build.
+
+    python3 env_power_cut.py
+    python3 env_power_cut.py --seeds 1 2 3 --steps 300
+"""
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import lzss_test  # noqa: E402
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+USER = os.path.join(HERE, '..', 'board', 'user')
+
+
+def build(out_dir, name, flags):
+    exe = os.path.join(out_dir, name)
+    cmd = ['gcc', '-std=gnu99', '-funsigned-char', '-Wall'] + flags + [
+        '-I', os.path.join(HERE, 'env_power_cut'),
+        '-I', os.path.join(USER, 'device_env'), '-I', os.path.join(USER, 'lib'),
+        os.path.join(HERE, 'env_power_cut', 'cut.c'), os.path.join(USER, 'lib', 'crc16.c'), '-o', exe]
+    subprocess.check_call(cmd)
+    return exe
+
+
+def run(exe, seed, steps, tail):
+    start = time.time()
+    p = subprocess.run([exe, str(seed), str(steps), str(tail)], stdout=subprocess.PIPE,
+                       universal_newlines=True)
+    lines = p.stdout.splitlines()
+    result = [l for l in lines if l.startswith('result ')]
+    if not result:
+        return None, lines, time.time() - start
+    return [int(v) for v in result[0].split()[1:]], lines, time.time() - start
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument('--seeds', type=int, nargs='+', default=[1, 2])
+    parser.add_argument('--steps', type=int, default=200)
+    parser.add_argument('--tail', type=int, default=20, help='steps run after each cut, 0: all')
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as work:
+        fast = build(work, 'cut', ['-O2'])
+        checked = build(work, 'cut_san', lzss_test.sanitizer_flags())
+        runs = [(fast, 'O2', seed, args.steps, args.tail) for seed in args.seeds]
+        runs.append((checked, 'san', args.seeds[0] + 100, 40, 0))
+
+        failed = False
+        print('%-5s %6s %6s %6s %8s %8s %9s %7s' % ('build', 'seed', 'steps', 'tail', 'cuts', 'compact', 'failures', 'time'))
+        for exe, name, seed, steps, tail in runs:
+            result, lines, seconds = run(exe, seed, steps, tail)
+            if result is None:
+                failed = True
+                print('%-5s %6d crashed' % (name, seed))
+                print('\n'.join(lines[-10:]))
+                continue
+            count, cuts, compactions, failures = result
+            print('%-5s %6d %6d %6s %8d %8d %9d %6.1fs' % (name, seed, count, tail or 'all', cuts, compactions, failures, seconds))
+            if failures:
+                failed = True
+                print('\n'.join(l for l in lines if l.startswith('fail ')))
+        return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,41 @@
+/*
+ * host stand-in for board/user/rtos/cmsis_os.h, the test is single
+ * threaded so the env mutex does nothing.
+ */
+#ifndef __CMSIS_OS_H__
+#define __CMSIS_OS_H__
+
+#include <stdint.h>
+
+#define  osWaitForever                   0xFFFFFFFF
+#define  osMutexStaticDef(name,cb)       static const osMutexDef_t os_mutex_def_##name = { (cb) }
+#define  osMutex(name)                   (&os_mutex_def_##name)
+
+typedef int osStaticMutexDef_t;
+
+typedef struct
+{
+    osStaticMutexDef_t *controlblock;
+}osMutexDef_t;
+
+typedef const osMutexDef_t *osMutexId;
+
+static inline osMutexId osMutexCreate(const osMutexDef_t *def)
+{
+    return def;
+}
+
+static inline int osMutexWait(osMutexId mutex,uint32_t timeout)
+{
+    (void)mutex;
+    (void)timeout;
+    return 0;
+}
+
+static inline int osMutexRelease(osMutexId mutex)
+{
+    (void)mutex;
+    return 0;
+}
+
+#endif
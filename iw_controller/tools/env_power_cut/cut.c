@@ -0,0 +1,521 @@
+/*
+ * host power cut test of the env storage (device_env/device_env.c) for
+ * env_power_cut.py. device_env.c is included so power_on() can clear its
+ * RAM like a reset does. the eeprom is a memory array; a write stops
+ * before byte <cut> and the test boots again from what reached it.
+ *
+ * a random sequence runs like the firmware uses the env: boot (the first
+ * one migrates the legacy env written by the old firmware), the flag set
+ * directly from main(), write back enabled, sets and deletes saved with
+ * device_env_barrier(), and the bootloader rewriting the legacy env and
+ * its backup the way the old device_env module does, followed by a boot.
+ * the sequence is cut at every written byte of every step. after the
+ * boot every name has its value before or after the step, and the
+ * bootloader keys read from the legacy env (env first, backup when the
+ * env crc is bad) match the application. the step is then redone when
+ * it was lost and the next <tail> steps (0: the rest of the sequence)
+ * must reach the state the model has after them.
+ *
+ * usage: cut <seed> <steps> <tail>
+ * prints "result <steps> <cuts> <compactions> <failures>" on stdout.
+ */
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "device_env.c"
+
+#define  CUT_EEPROM_BASE           0x40108000
+#define  CUT_EEPROM_SIZE           0x4000
+#define  CUT_STEP_MAX              1000
+#define  CUT_STEP_KEY_MAX          3
+#define  CUT_VALUE_SIZE            33
+#define  CUT_FAILURE_PRINT_MAX     10
+
+int log_enable = 0;
+
+static const char * const cut_key[] = {
+    ENV_BOOTLOADER_FLAG_NAME,
+    ENV_BOOTLOADER_UPDATE_SIZE_NAME,
+    ENV_BOOTLOADER_APPLICATION_SIZE_NAME,
+    ENV_BOOTLOADER_BACKUP_SIZE_NAME,
+    ENV_BOOTLOADER_UPDATE_MD5_NAME,
+    ENV_BOOTLOADER_APPLICATION_MD5_NAME,
+    ENV_BOOTLOADER_BACKUP_MD5_NAME,
+    "temperature",
+    "compressor",
+    "lock_type",
+    "scale_0",
+    "scale_1",
+    "scale_2"
+};
+
+#define  CUT_KEY_CNT               (sizeof(cut_key) / sizeof(cut_key[0]))
+#define  CUT_BOOTLOADER_KEY_CNT    7
+
+typedef struct
+{
+    bool set[CUT_KEY_CNT];
+    char value[CUT_KEY_CNT][CUT_VALUE_SIZE];
+}cut_state_t;
+
+typedef enum
+{
+    CUT_STEP_BOOT,
+    CUT_STEP_SET,       /*device_env_set before write back is enabled*/
+    CUT_STEP_ENABLE,
+    CUT_STEP_BATCH,     /*device_env_set then device_env_barrier*/
+    CUT_STEP_BOOTLOADER
+}cut_step_type_t;
+
+typedef struct
+{
+    cut_step_type_t type;
+    bool    write_back; /*write back enabled before the step*/
+    uint8_t cnt;
+    uint8_t key[CUT_STEP_KEY_MAX];
+    bool    del[CUT_STEP_KEY_MAX];
+    char    value[CUT_STEP_KEY_MAX][CUT_VALUE_SIZE];
+}cut_step_t;
+
+static uint8_t cut_eeprom[CUT_EEPROM_SIZE];
+static long cut_budget = -1;
+static unsigned long cut_written;
+static jmp_buf cut_jmp;
+
+static cut_step_t cut_step[CUT_STEP_MAX];
+static cut_state_t cut_model[CUT_STEP_MAX + 1];
+static uint8_t cut_snapshot[CUT_STEP_MAX][CUT_EEPROM_SIZE];
+static unsigned long cut_step_written[CUT_STEP_MAX];
+static int cut_step_cnt;
+static int cut_failures;
+static uint32_t cut_rand_state;
+
+int eeprom_if_init(void)
+{
+    return 0;
+}
+
+int eeprom_if_read(int addr,uint8_t *dst,int size)
+{
+    if (addr < CUT_EEPROM_BASE || addr + size > CUT_EEPROM_BASE + CUT_EEPROM_SIZE) {
+        return -1;
+    }
+    memcpy(dst,&cut_eeprom[addr - CUT_EEPROM_BASE],size);
+    return 0;
+}
+
+int eeprom_if_write(int addr,uint8_t *src,int size)
+{
+    if (addr < CUT_EEPROM_BASE || addr + size > CUT_EEPROM_BASE + CUT_EEPROM_SIZE) {
+        return -1;
+    }
+    for (int i = 0;i < size;i ++) {
+        if (cut_budget == 0) {
+            longjmp(cut_jmp,1);
+        }
+        if (cut_budget > 0) {
+            cut_budget --;
+        }
+        cut_eeprom[addr - CUT_EEPROM_BASE + i] = src[i];
+        cut_written ++;
+    }
+    return 0;
+}
+
+static uint32_t cut_rand(uint32_t range)
+{
+    cut_rand_state ^= cut_rand_state << 13;
+    cut_rand_state ^= cut_rand_state >> 17;
+    cut_rand_state ^= cut_rand_state << 5;
+    return cut_rand_state % range;
+}
+
+static void cut_dirty(bool now)
+{
+    (void)now;
+}
+
+static void cut_fail(int step,long cut,const char *what)
+{
+    if (cut_failures ++ < CUT_FAILURE_PRINT_MAX) {
+        printf("fail step %d cut %ld: %s\n",step,cut,what);
+    }
+}
+
+/*reset clears the RAM of device_env.c*/
+static void power_on(void)
+{
+    memset(&device_env,0,sizeof(device_env));
+    memset(&device_env_backup,0,sizeof(device_env_backup));
+    memset(device_env_index,0,sizeof(device_env_index));
+    device_env_index_valid = false;
+    memset(&device_env_log,0,sizeof(device_env_log));
+    memset(&device_env_write_back,0,sizeof(device_env_write_back));
+    if (device_env_init() != 0) {
+        cut_fail(-1,-1,"device_env_init");
+    }
+}
+
+static void app_state(cut_state_t *state)
+{
+    char *value;
+
+    memset(state,0,sizeof(*state));
+    for (uint8_t i = 0;i < CUT_KEY_CNT;i ++) {
+        value = device_env_get((char *)cut_key[i]);
+        if (value != NULL) {
+            state->set[i] = true;
+            snprintf(state->value[i],CUT_VALUE_SIZE,"%s",value);
+        }
+    }
+}
+
+/*legacy env as the bootloader reads it: env, else backup, else empty*/
+static void legacy_load(device_env_t *env)
+{
+    eeprom_if_read(DEVICE_ENV_BASE_ADDR,(uint8_t *)env,sizeof(*env));
+    if (env->crc == calculate_crc16(env->data_region,DEVICE_ENV_DATA_SIZE_LIMIT)) {
+        return;
+    }
+    eeprom_if_read(DEVICE_ENV_BACKUP_BASE_ADDR,(uint8_t *)env,sizeof(*env));
+    if (env->crc == calculate_crc16(env->data_region,DEVICE_ENV_DATA_SIZE_LIMIT)) {
+        return;
+    }
+    memset(env,0,sizeof(*env));
+}
+
+static void legacy_state(cut_state_t *state)
+{
+    device_env_t env;
+    char *value;
+
+    legacy_load(&env);
+    memset(state,0,sizeof(*state));
+    for (uint8_t i = 0;i < CUT_BOOTLOADER_KEY_CNT;i ++) {
+        value = device_env_legacy_get(&env,cut_key[i]);
+        if (value != NULL) {
+            state->set[i] = true;
+            snprintf(state->value[i],CUT_VALUE_SIZE,"%s",value);
+        }
+    }
+}
+
+/*rebuild "name=value\0...\0\0" with one entry changed*/
+static void legacy_set(device_env_t *env,const char *name,const char *value)
+{
+    uint8_t data[DEVICE_ENV_DATA_SIZE_LIMIT] = { 0 };
+    int i,next,pos = 0,len = strlen(name);
+    char *entry;
+
+    for (i = 0;i < DEVICE_ENV_DATA_SIZE_LIMIT && env->data_region[i] != '\0';i = next + 1) {
+        for (next = i;next < DEVICE_ENV_DATA_SIZE_LIMIT && env->data_region[next] != '\0';++ next);
+        entry = (char *)&env->data_region[i];
+        if (strncmp(entry,name,len) == 0 && entry[len] == '=') {
+            continue;
+        }
+        memcpy(&data[pos],entry,next - i + 1);
+        pos += next - i + 1;
+    }
+    if (value != NULL) {
+        pos += sprintf((char *)&data[pos],"%s=%s",name,value) + 1;
+    }
+    memcpy(env->data_region,data,sizeof(data));
+}
+
+/*the bootloader sets its keys with the legacy device_env: env, then backup*/
+static void bootloader_write(const cut_step_t *step)
+{
+    device_env_t env;
+
+    legacy_load(&env);
+    for (uint8_t i = 0;i < step->cnt;i ++) {
+        legacy_set(&env,cut_key[step->key[i]],step->del[i] ? NULL : step->value[i]);
+    }
+    env.crc = calculate_crc16(env.data_region,DEVICE_ENV_DATA_SIZE_LIMIT);
+    eeprom_if_write(DEVICE_ENV_BASE_ADDR,(uint8_t *)&env,sizeof(env));
+    eeprom_if_write(DEVICE_ENV_BACKUP_BASE_ADDR,(uint8_t *)&env,sizeof(env));
+}
+
+static void step_run(const cut_step_t *step)
+{
+    switch (step->type) {
+    case CUT_STEP_BOOT:
+        power_on();
+        break;
+    case CUT_STEP_ENABLE:
+        device_env_write_back_enable(cut_dirty);
+        break;
+    case CUT_STEP_SET:
+    case CUT_STEP_BATCH:
+        for (uint8_t i = 0;i < step->cnt;i ++) {
+            device_env_set((char *)cut_key[step->key[i]],step->del[i] ? NULL : (char *)step->value[i]);
+        }
+        if (step->type == CUT_STEP_BATCH) {
+            device_env_barrier();
+        }
+        break;
+    case CUT_STEP_BOOTLOADER:
+        bootloader_write(step);
+        break;
+    }
+}
+
+static void model_apply(const cut_step_t *step,const cut_state_t *before,cut_state_t *after)
+{
+    *after = *before;
+    if (step->type == CUT_STEP_BOOT || step->type == CUT_STEP_ENABLE) {
+        return;
+    }
+    for (uint8_t i = 0;i < step->cnt;i ++) {
+        after->set[step->key[i]] = !step->del[i];
+        memset(after->value[step->key[i]],0,CUT_VALUE_SIZE);
+        if (!step->del[i]) {
+            strcpy(after->value[step->key[i]],step->value[i]);
+        }
+    }
+}
+
+static bool key_equal(const cut_state_t *a,const cut_state_t *b,uint8_t i)
+{
+    return a->set[i] == b->set[i] && (!a->set[i] || strcmp(a->value[i],b->value[i]) == 0);
+}
+
+static bool state_equal(const cut_state_t *a,const cut_state_t *b,uint8_t cnt)
+{
+    for (uint8_t i = 0;i < cnt;i ++) {
+        if (!key_equal(a,b,i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void random_value(uint8_t key,char *value)
+{
+    static const char hex[] = "0123456789abcdef";
+    int len;
+
+    if (key == 0) {
+        static const char * const flag[] = { ENV_BOOTLOADER_INIT,ENV_BOOTLOADER_NORMAL,ENV_BOOTLOADER_NEW,
+                                             ENV_BOOTLOADER_UPDATE,ENV_BOOTLOADER_COMPLETE,ENV_BOOTLOADER_OK };
+        strcpy(value,flag[cut_rand(6)]);
+        return;
+    }
+    if (key >= 4 && key <= 6) {
+        len = 32;
+    } else if (key < CUT_BOOTLOADER_KEY_CNT) {
+        len = 1 + cut_rand(6);
+    } else {
+        len = 1 + cut_rand(16);
+    }
+    for (int i = 0;i < len;i ++) {
+        value[i] = key >= 4 && key <= 6 ? hex[cut_rand(16)] : '0' + cut_rand(10);
+    }
+    value[len] = '\0';
+}
+
+static cut_step_t *step_add(cut_step_type_t type,bool write_back)
+{
+    cut_step_t *step = &cut_step[cut_step_cnt ++];
+
+    memset(step,0,sizeof(*step));
+    step->type = type;
+    step->write_back = write_back;
+    return step;
+}
+
+/*boot, flag from main(), write back enabled by tasks_init*/
+static void sequence_boot(bool flag)
+{
+    cut_step_t *step;
+
+    step_add(CUT_STEP_BOOT,false);
+    if (flag) {
+        step = step_add(CUT_STEP_SET,false);
+        step->cnt = 1;
+        step->key[0] = 0;
+        strcpy(step->value[0],cut_rand(2) ? ENV_BOOTLOADER_OK : ENV_BOOTLOADER_INIT);
+    }
+    step_add(CUT_STEP_ENABLE,false);
+}
+
+static void sequence_make(int steps)
+{
+    cut_step_t *step;
+    uint32_t r;
+
+    cut_step_cnt = 0;
+    sequence_boot(false);
+    while (cut_step_cnt < steps - 5) {
+        r = cut_rand(20);
+        if (r == 0) {
+            step = step_add(CUT_STEP_BOOTLOADER,true);
+            step->cnt = 1 + cut_rand(CUT_STEP_KEY_MAX);
+            for (uint8_t i = 0;i < step->cnt;i ++) {
+                step->key[i] = cut_rand(CUT_BOOTLOADER_KEY_CNT);
+                step->del[i] = step->key[i] != 0 && cut_rand(5) == 0;
+                random_value(step->key[i],step->value[i]);
+            }
+            sequence_boot(cut_rand(2) == 0);
+        } else if (r == 1) {
+            sequence_boot(cut_rand(2) == 0);
+        } else {
+            step = step_add(CUT_STEP_BATCH,true);
+            step->cnt = 1 + (cut_rand(4) == 0 ? cut_rand(CUT_STEP_KEY_MAX) : 0);
+            for (uint8_t i = 0;i < step->cnt;i ++) {
+                step->key[i] = cut_rand(4) == 0 ? cut_rand(CUT_BOOTLOADER_KEY_CNT) : CUT_BOOTLOADER_KEY_CNT + cut_rand(CUT_KEY_CNT - CUT_BOOTLOADER_KEY_CNT);
+                step->del[i] = cut_rand(8) == 0;
+                random_value(step->key[i],step->value[i]);
+            }
+        }
+    }
+}
+
+/*the env the old firmware left: legacy format, env and backup*/
+static void eeprom_make(void)
+{
+    device_env_t env;
+
+    memset(cut_eeprom,0xFF,sizeof(cut_eeprom));
+    memset(&env,0,sizeof(env));
+    legacy_set(&env,ENV_BOOTLOADER_FLAG_NAME,ENV_BOOTLOADER_OK);
+    legacy_set(&env,ENV_BOOTLOADER_APPLICATION_SIZE_NAME,"61440");
+    legacy_set(&env,ENV_BOOTLOADER_APPLICATION_MD5_NAME,"0123456789abcdef0123456789abcdef");
+    legacy_set(&env,"temperature","5");
+    legacy_set(&env,"lock_type","1");
+    env.crc = calculate_crc16(env.data_region,DEVICE_ENV_DATA_SIZE_LIMIT);
+    memcpy(&cut_eeprom[DEVICE_ENV_BASE_ADDR - CUT_EEPROM_BASE],&env,sizeof(env));
+    memcpy(&cut_eeprom[DEVICE_ENV_BACKUP_BASE_ADDR - CUT_EEPROM_BASE],&env,sizeof(env));
+}
+
+/*after a boot: every key before or after the step, bootloader agrees*/
+static void check_boot(int k,long cut,cut_state_t *state)
+{
+    cut_state_t legacy;
+
+    app_state(state);
+    for (uint8_t i = 0;i < CUT_KEY_CNT;i ++) {
+        if (!key_equal(state,&cut_model[k],i) && !key_equal(state,&cut_model[k + 1],i)) {
+            char what[128];
+
+            snprintf(what,sizeof(what),"%s=%s neither before nor after",cut_key[i],state->set[i] ? state->value[i] : "(none)");
+            cut_fail(k,cut,what);
+        }
+    }
+    legacy_state(&legacy);
+    if (!state_equal(state,&legacy,CUT_BOOTLOADER_KEY_CNT)) {
+        cut_fail(k,cut,"bootloader view differs");
+    }
+}
+
+static void step_restore(int k)
+{
+    memcpy(cut_eeprom,cut_snapshot[k],sizeof(cut_eeprom));
+    if (cut_step[k].type == CUT_STEP_BOOT) {
+        return;
+    }
+    cut_written = 0;
+    power_on();
+    if (cut_step[k].write_back) {
+        device_env_write_back_enable(cut_dirty);
+    }
+    if (cut_written != 0) {
+        cut_fail(k,-1,"boot after a complete step writes");
+    }
+}
+
+int main(int argc,char *argv[])
+{
+    cut_state_t state,legacy;
+    unsigned long cuts = 0;
+    uint32_t compactions = 0,seq;
+    int steps,tail,end;
+
+    if (argc != 4) {
+        fprintf(stderr,"usage: cut <seed> <steps> <tail>\n");
+        return 2;
+    }
+    cut_rand_state = (uint32_t)strtoul(argv[1],NULL,0) * 2654435761UL + 1;
+    steps = atoi(argv[2]);
+    tail = atoi(argv[3]);
+    if (steps < 10 || steps > CUT_STEP_MAX) {
+        fprintf(stderr,"steps 10..%d\n",CUT_STEP_MAX);
+        return 2;
+    }
+    sequence_make(steps);
+    eeprom_make();
+
+    /*uncut run: snapshot, bytes written and model per step*/
+    memset(&cut_model[0],0,sizeof(cut_model[0]));
+    legacy_state(&cut_model[0]);
+    cut_model[0].set[7] = true;
+    strcpy(cut_model[0].value[7],"5");
+    cut_model[0].set[9] = true;
+    strcpy(cut_model[0].value[9],"1");
+    seq = 0;
+    for (int k = 0;k < cut_step_cnt;k ++) {
+        memcpy(cut_snapshot[k],cut_eeprom,sizeof(cut_eeprom));
+        model_apply(&cut_step[k],&cut_model[k],&cut_model[k + 1]);
+        cut_written = 0;
+        step_run(&cut_step[k]);
+        cut_step_written[k] = cut_written;
+        if (device_env_log.seq != seq) {
+            compactions += seq != 0;
+            seq = device_env_log.seq;
+        }
+        if (cut_step[k].type != CUT_STEP_BOOTLOADER) {
+            app_state(&state);
+            if (!state_equal(&state,&cut_model[k + 1],CUT_KEY_CNT)) {
+                cut_fail(k,-1,"uncut run differs from the model");
+            }
+        }
+    }
+
+    for (int k = 0;k < cut_step_cnt;k ++) {
+        for (long cut = 0;cut < (long)cut_step_written[k];cut ++) {
+            step_restore(k);
+            cut_budget = cut;
+            if (setjmp(cut_jmp) == 0) {
+                step_run(&cut_step[k]);
+                cut_budget = -1;
+                cut_fail(k,cut,"step finished before the cut");
+                continue;
+            }
+            cut_budget = -1;
+            cuts ++;
+
+            power_on();
+            check_boot(k,cut,&state);
+            /*lost or half done: redo the step, then the rest*/
+            if (cut_step[k].write_back) {
+                device_env_write_back_enable(cut_dirty);
+            }
+            if (!state_equal(&state,&cut_model[k + 1],CUT_KEY_CNT)) {
+                if (cut_step[k].type == CUT_STEP_BOOT) {
+                    cut_fail(k,cut,"boot after a cut boot differs");
+                } else {
+                    step_run(&cut_step[k]);
+                }
+            }
+            end = tail == 0 || k + 1 + tail > cut_step_cnt ? cut_step_cnt : k + 1 + tail;
+            /*a bootloader step is only seen by the application after the next boot*/
+            if (end < cut_step_cnt && cut_step[end - 1].type == CUT_STEP_BOOTLOADER) {
+                end ++;
+            }
+            for (int j = k + 1;j < end;j ++) {
+                step_run(&cut_step[j]);
+            }
+            app_state(&state);
+            legacy_state(&legacy);
+            if (!state_equal(&state,&cut_model[end],CUT_KEY_CNT)) {
+                cut_fail(k,cut,"final state differs");
+            } else if (!state_equal(&state,&legacy,CUT_BOOTLOADER_KEY_CNT)) {
+                cut_fail(k,cut,"final bootloader view differs");
+            }
+        }
+    }
+
+    printf("result %d %lu %u %d\n",cut_step_cnt,cuts,compactions,cut_failures);
+    return cut_failures != 0;
+}
@@ -0,0 +1,14 @@
+/*
+ * host stand-in for board/user/eeprom_if/eeprom_if.h, the eeprom is a
+ * memory array in cut.c that can lose power in the middle of a write.
+ */
+#ifndef __EEPROM_IF_H__
+#define __EEPROM_IF_H__
+
+#include <stdint.h>
+
+int eeprom_if_init(void);
+int eeprom_if_write(int addr,uint8_t *src,int size);
+int eeprom_if_read(int addr,uint8_t *dst,int size);
+
+#endif
@@ -0,0 +1,18 @@
+/*
+ * host stand-in for board/user/debug/log/log.h
+ */
+#ifndef __LOG_H__
+#define __LOG_H__
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define  log_error(...)    do { if (log_enable) fprintf(stderr,"[env] " __VA_ARGS__); } while (0)
+#define  log_warning(...)  do { if (log_enable) fprintf(stderr,"[env] " __VA_ARGS__); } while (0)
+#define  log_info(...)     do { if (log_enable) fprintf(stderr,"[env] " __VA_ARGS__); } while (0)
+#define  log_debug(...)
+#define  log_assert(x)     do { if (!(x)) abort(); } while (0)
+
+extern int log_enable;
+
+#endif
@@ -0,0 +1,299 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+replay adc traces through the temperature filter stage.
+
+builds the firmware conversion and filter (temperature_table.c,
+temperature_table_ntc.c, temperature_filter.c) for the host with the
+stand-ins in filter_replay/ and feeds adc block averages (one per
+ADC_TASK_SAMPLE_INTERVAL * ADC_TASK_BLOCK_SIZE = 1.024 s) through it for
+a set of median window / iir shift settings (the t_median and t_iir env
+entries).
+
+without --trace it replays synthetic traces made from the ntc curve of
+ntc_table.py, where the true temperature is known:
+
+    steady     4 C with adc noise, gives the output noise
+    spikes     the same with 1 and 2 sample adc spikes (relay and
+               compressor start transients), gives the worst deviation
+    step       4 C -> 9 C door opening, gives the samples until the
+               output has made 90% of the step (t90)
+    ramp       pull down at -0.6 C/min, gives the tracking lag
+
+checks: the C filter output matches a python model of the median and
+iir exactly, and the default setting of temperature_task.h rejects the
+spikes, lowers the noise and keeps t90 within its analytic bound.
+
+recorded traces (one adc value per line, '#' comments, the last column of
+a csv) have no true temperature; for them the noise is the standard
+deviation of the sample to sample difference and the lag the shift with
+the best correlation between input and output:
+
+    python3 filter_replay.py
+    python3 filter_replay.py --trace probe0.csv --config 5,2 7,3
+"""
+import argparse
+import math
+import os
+import random
+import re
+import subprocess
+import sys
+import tempfile
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import ntc_table  # noqa: E402
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+TASKS = os.path.join(HERE, '..', 'board', 'user', 'tasks')
+
+SAMPLE_PERIOD = 1.024        # s, one adc block average
+CONFIGS = [(1, 0), (3, 1), (5, 2), (5, 3), (7, 2), (9, 4)]
+IIR_FRAC_BITS = 8            # TEMPERATURE_FILTER_IIR_FRAC_BITS
+WARM_UP = 20                 # samples skipped before measuring
+ADC_NOISE = 2.0              # adc codes rms
+SPIKE = 250                  # adc codes
+STEP_AT = 100
+STEP_FROM, STEP_TO = 4.0, 9.0
+RAMP_SLOPE = -0.6 / 60 * SAMPLE_PERIOD   # C per sample
+SPIKE_MARGIN = 5             # 0.01 C, spikes may add this over the steady worst
+
+
+def header_define(name, path):
+    text = open(path, encoding='utf-8', errors='replace').read()
+    return int(re.search(r'define\s+%s\s+(\d+)' % name, text).group(1))
+
+
+def build(out_dir):
+    task_h = os.path.join(TASKS, 'temperature_task.h')
+    exe = os.path.join(out_dir, 'replay')
+    cmd = ['gcc', '-std=gnu99', '-funsigned-char', '-Wall', '-O2',
+           '-DADC_ERR_MAX=%d' % header_define('ADC_ERR_MAX', task_h),
+           '-DADC_ERR_MIN=%d' % header_define('ADC_ERR_MIN', task_h),
+           '-I', os.path.join(HERE, 'filter_replay'), '-I', TASKS,
+           os.path.join(HERE, 'filter_replay', 'replay.c'),
+           os.path.join(TASKS, 'temperature_table.c'),
+           os.path.join(TASKS, 'temperature_table_ntc.c'),
+           os.path.join(TASKS, 'temperature_filter.c'), '-o', exe]
+    subprocess.check_call(cmd)
+    return exe
+
+
+def replay(exe, config, adc):
+    """[(temperature, filtered)] in 0.01 C, None for a failed conversion"""
+    out = subprocess.run([exe, str(config[0]), str(config[1])], input=''.join('%d\n' % a for a in adc),
+                         stdout=subprocess.PIPE, check=True, universal_newlines=True).stdout
+    result = []
+    for line in out.splitlines():
+        t, y = line.split()
+        result.append(None if t == 'E' else (int(t), int(y)))
+    return result
+
+
+def cdiv(a, b):
+    """c integer division, truncates toward zero"""
+    q = abs(a) // abs(b)
+    return q if (a >= 0) == (b > 0) else -q
+
+
+def model(values, config):
+    """median of the last n readings, then y += (x - y) / 2^shift"""
+    size, shift = config
+    window, y, out = [], None, []
+    for v in values:
+        window.append(v)
+        if len(window) > size:
+            window.pop(0)
+        x = sorted(window)[len(window) // 2] << IIR_FRAC_BITS
+        y = x if y is None else y + cdiv(x - y, 1 << shift)
+        half = 1 << (IIR_FRAC_BITS - 1)
+        out.append(cdiv(y + (half if y >= 0 else -half), 1 << IIR_FRAC_BITS))
+    return out
+
+
+def t90_bound(config):
+    """median delay plus the iir time to 90%"""
+    size, shift = config
+    iir = 0 if shift == 0 else math.ceil(math.log(0.1) / math.log(1.0 - 1.0 / (1 << shift)))
+    return size // 2 + iir + 2
+
+
+def temperature_to_adc(t):
+    curve = ntc_table.T_R_MAP
+    for (t1, r1), (t2, r2) in zip(curve, curve[1:]):
+        if t1 <= t <= t2:
+            r = r1 + (r2 - r1) * (t - t1) / (t2 - t1)
+            return 3.30 * 4096 * 5100 / (3.30 * (r + 5100))
+    raise ValueError(t)
+
+
+def synthetic(rng):
+    """name -> (true temperature in 0.01 C, adc codes)"""
+    traces = {}
+
+    def make(truth, spikes=()):
+        adc = [int(round(temperature_to_adc(t) + rng.gauss(0, ADC_NOISE))) for t in truth]
+        for at, width, size in spikes:
+            for k in range(at, min(at + width, len(adc))):
+                adc[k] += size
+        return [round(t * 100) for t in truth], adc
+
+    traces['steady'] = make([4.0] * 600)
+    spikes = []
+    for i, at in enumerate(range(40, 600, 37)):
+        spikes.append((at, 1 + i % 2, SPIKE if i % 3 else -SPIKE))
+    traces['spikes'] = make([4.0] * 600, spikes)
+    traces['step'] = make([STEP_FROM] * STEP_AT + [STEP_TO] * 200)
+    traces['ramp'] = make([8.0 + RAMP_SLOPE * k for k in range(int(6.0 / -RAMP_SLOPE))])
+    return traces
+
+
+def std(values):
+    mean = sum(values) / len(values)
+    return math.sqrt(sum((v - mean) ** 2 for v in values) / len(values))
+
+
+def measure(name, truth, result, config):
+    """metric value in 0.01 C or samples, raw metric"""
+    raw = [r[0] for r in result]
+    out = [r[1] for r in result]
+    if name in ('steady', 'spikes'):
+        err_raw = [abs(a - b) for a, b in zip(raw[WARM_UP:], truth[WARM_UP:])]
+        err_out = [abs(a - b) for a, b in zip(out[WARM_UP:], truth[WARM_UP:])]
+        if name == 'steady':
+            return std([a - b for a, b in zip(out[WARM_UP:], truth[WARM_UP:])]), \
+                std([a - b for a, b in zip(raw[WARM_UP:], truth[WARM_UP:])]), max(err_out)
+        return max(err_out), max(err_raw), None
+    if name == 'step':
+        level = (STEP_FROM + 0.9 * (STEP_TO - STEP_FROM)) * 100
+
+        def t90(values):
+            for k in range(STEP_AT, len(values)):
+                if values[k] >= level:
+                    return k - STEP_AT
+            return len(values)
+        return t90(out), t90(raw), None
+    # ramp: mean tracking error over the second half in samples
+    half = len(out) // 2
+    slope = RAMP_SLOPE * 100
+    return sum(o - t for o, t in zip(out[half:], truth[half:])) / (len(out) - half) / -slope, \
+        sum(r - t for r, t in zip(raw[half:], truth[half:])) / (len(raw) - half) / -slope, None
+
+
+def read_trace(path):
+    values = []
+    for line in open(path):
+        line = line.split('#')[0].strip()
+        if line:
+            try:
+                values.append(int(float(line.replace(';', ',').split(',')[-1])))
+            except ValueError:
+                pass          # csv header
+    return values
+
+
+def recorded(exe, configs, path):
+    adc = read_trace(path)
+    print('trace %s, %d samples' % (path, len(adc)))
+    print('  %-8s %10s %10s %8s %8s' % ('config', 'noise raw', 'noise out', 'lag', 'errors'))
+    for config in configs:
+        result = replay(exe, config, adc)
+        good = [r for r in result if r is not None]
+        if len(good) < 3:
+            print('  %d,%-6d no valid samples' % config)
+            continue
+        raw = [r[0] for r in good]
+        out = [r[1] for r in good]
+        d_raw = std([b - a for a, b in zip(raw, raw[1:])])
+        d_out = std([b - a for a, b in zip(out, out[1:])])
+        mean_raw, mean_out = sum(raw) / len(raw), sum(out) / len(out)
+        best, lag = None, 0
+        for shift in range(0, min(30, len(raw) - 2)):
+            c = sum((raw[k] - mean_raw) * (out[k + shift] - mean_out) for k in range(len(raw) - shift))
+            if best is None or c > best:
+                best, lag = c, shift
+        print('  %d,%-6d %10.2f %10.2f %8d %8d' % (config[0], config[1], d_raw / 100, d_out / 100, lag,
+                                                  len(result) - len(good)))
+
+
+def parse_config(text):
+    size, shift = text.split(',')
+    return int(size), int(shift)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument('--trace', nargs='*', default=[], help='recorded adc traces')
+    parser.add_argument('--config', nargs='*', type=parse_config, help='median size,iir shift pairs')
+    parser.add_argument('--seed', type=int, default=1)
+    args = parser.parse_args()
+
+    task_h = os.path.join(TASKS, 'temperature_task.h')
+    default = (header_define('TEMPERATURE_TASK_FILTER_MEDIAN_SIZE', task_h),
+               header_define('TEMPERATURE_TASK_FILTER_IIR_SHIFT', task_h))
+    configs = args.config or CONFIGS
+    if default not in configs:
+        configs = configs + [default]
+
+    failed = False
+    with tempfile.TemporaryDirectory() as out_dir:
+        exe = build(out_dir)
+        if args.trace:
+            for path in args.trace:
+                recorded(exe, configs, path)
+            return 0
+
+        traces = synthetic(random.Random(args.seed))
+        print('synthetic traces, %.3f s per sample, noise %.1f adc rms, spikes %d adc' %
+              (SAMPLE_PERIOD, ADC_NOISE, SPIKE))
+        print('%-8s %8s %8s %10s %10s %8s %8s %s' % ('config', 'noise', 'raw', 'spike max', 'raw', 't90', 'ramp',
+                                                      'model'))
+        rows = {}
+        for config in configs:
+            metrics = {}
+            exact = True
+            for name, (truth, adc) in traces.items():
+                result = replay(exe, config, adc)
+                if any(r is None for r in result):
+                    print('%s: conversion failed in the %s trace' % (config, name))
+                    return 1
+                exact = exact and [r[1] for r in result] == model([r[0] for r in result], config)
+                metrics[name] = measure(name, truth, result, config)
+            rows[config] = metrics
+            failed = failed or not exact
+            print('%d,%-6d %8.3f %8.3f %10.2f %10.2f %8d %8.1f %s%s' % (
+                config[0], config[1], metrics['steady'][0] / 100, metrics['steady'][1] / 100,
+                metrics['spikes'][0] / 100, metrics['spikes'][1] / 100, metrics['step'][0],
+                metrics['ramp'][0], 'ok' if exact else 'FAIL',
+                ' (default)' if config == default else ''))
+        print('noise: output rms error C, spike: worst error C, t90 and ramp lag: samples')
+
+        m = rows[default]
+        checks = [
+            ('default rejects spikes', m['spikes'][0] <= m['steady'][2] + SPIKE_MARGIN,
+             'spike worst %.2f C, steady worst %.2f C' % (m['spikes'][0] / 100, m['steady'][2] / 100)),
+            ('default lowers noise', m['steady'][0] < m['steady'][1],
+             '%.3f C < %.3f C raw' % (m['steady'][0] / 100, m['steady'][1] / 100)),
+            ('default step t90', m['step'][0] <= t90_bound(default),
+             '%d samples (%.1f s) <= %d' % (m['step'][0], m['step'][0] * SAMPLE_PERIOD, t90_bound(default))),
+        ]
+        for name, ok, detail in checks:
+            print('%-24s %-4s %s' % (name, 'ok' if ok else 'FAIL', detail))
+            failed = failed or not ok
+
+        # median edge cases against the model: partial window, repeats
+        rng = random.Random(args.seed + 1)
+        values = [rng.choice([400, 401, 401, 402, -300, 900]) for _ in range(300)]
+        adc = [int(round(temperature_to_adc(v / 100.0))) for v in values]
+        for config in configs:
+            result = replay(exe, config, adc)
+            if [r[1] for r in result] != model([r[0] for r in result], config):
+                print('%d,%d: output differs from the model on repeated values' % config)
+                failed = True
+
+    print('result: %s' % ('FAIL' if failed else 'ok'))
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,51 @@
+/*
+ * host build of the temperature filter stage (tasks/temperature_filter.c)
+ * for filter_replay.py. reads one adc block average per line from stdin
+ * and runs it through the path of temperature_probe_update(): adc range
+ * check and ntc table lookup (temperature_table.c), then the filter for
+ * readings that converted. the alarm and change hysteresis that follow in
+ * the temperature task are not part of the replay.
+ *
+ * usage: replay <median size> <iir shift>
+ * prints "<temperature> <filtered>" in 0.01 C per input line, "E E" for a
+ * reading that failed conversion (it does not enter the filter).
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "temperature_table.h"
+#include "temperature_filter.h"
+
+/*passed in from temperature_task.h*/
+#ifndef  ADC_ERR_MAX
+#error "ADC_ERR_MAX"
+#endif
+#ifndef  ADC_ERR_MIN
+#error "ADC_ERR_MIN"
+#endif
+
+int main(int argc,char *argv[])
+{
+    temperature_filter_t filter;
+    char line[64];
+    long adc;
+    int16_t t;
+
+    if (argc != 3) {
+        fprintf(stderr,"usage: replay <median size> <iir shift>\n");
+        return 2;
+    }
+    if (temperature_filter_init(&filter,atoi(argv[1]),atoi(argv[2])) != 0) {
+        return 2;
+    }
+    while (fgets(line,sizeof(line),stdin) != NULL) {
+        adc = strtol(line,NULL,10);
+        if (adc < 0 || adc > UINT16_MAX || adc >= ADC_ERR_MAX || adc <= ADC_ERR_MIN ||
+            temperature_table_lookup(&temperature_table_ntc,(uint16_t)adc,&t) != 0) {
+            printf("E E\n");
+            continue;
+        }
+        printf("%d %d\n",t,temperature_filter_put(&filter,t));
+    }
+    return 0;
+}
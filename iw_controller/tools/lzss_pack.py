@@ -0,0 +1,204 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+host packer for compressed firmware updates (lib/lzss.c).
+
+the controller takes a packed file through the normal update command:
+it sees the "LZS1" magic, decompresses on the fly into the update area
+through a (1 << window bits) byte RAM window and checks the md5 of the
+decompressed image from the header. the update notify command carries
+the size and md5 of the packed file, that is what goes over the link:
+
+    python3 lzss_pack.py app.bin app.lzs
+    python3 ymodem_send.py --port /dev/ttyUSB0 app.lzs
+
+format, all little endian:
+
+    header   "LZS1", window bits W, 3 reserved, image size (4), image md5 (16)
+    data     flag byte (lsb first, 1 literal, 0 match) + 8 items
+             literal: 1 byte
+             match:   2 bytes, low W bits distance - 1, high 16 - W bits
+                      length - 3; all ones length bits add one more byte
+                      of length
+
+--window must not be larger than LZSS_WINDOW_BITS of the firmware (11).
+-d unpacks, every pack is checked by unpacking it again.
+"""
+import argparse
+import hashlib
+import struct
+import sys
+
+MAGIC = b'LZS1'
+HEADER = struct.Struct('<4sB3xI16s')
+MIN_MATCH = 3
+WINDOW_BITS = 11
+WINDOW_BITS_MIN = 8
+WINDOW_BITS_MAX = 15
+CHAIN_MAX = 256             # candidates tried per position
+
+
+class FormatError(Exception):
+    pass
+
+
+def limits(window_bits):
+    length_max = (1 << (16 - window_bits)) - 1
+    return 1 << window_bits, length_max, MIN_MATCH + length_max + 255
+
+
+def find_matches(data, window_bits, chain_max=CHAIN_MAX):
+    """longest match at every position with 3 byte hash chains.
+    returns a function pos -> (length, distance)"""
+    window, _, match_max = limits(window_bits)
+    head = {}
+    prev = [-1] * len(data)
+    n = len(data)
+
+    def insert(pos):
+        if pos + MIN_MATCH <= n:
+            key = data[pos:pos + MIN_MATCH]
+            prev[pos] = head.get(key, -1)
+            head[key] = pos
+
+    def longest(pos):
+        best_len, best_dist = 0, 0
+        if pos + MIN_MATCH > n:
+            return best_len, best_dist
+        limit = min(match_max, n - pos)
+        cand = head.get(data[pos:pos + MIN_MATCH], -1)
+        tries = chain_max
+        while cand >= 0 and pos - cand <= window and tries > 0:
+            tries -= 1
+            # the chain key is the first 3 bytes, only a longer match counts
+            if data[cand + best_len] == data[pos + best_len]:
+                length = MIN_MATCH
+                while length < limit and data[cand + length] == data[pos + length]:
+                    length += 1
+                if length > best_len:
+                    best_len, best_dist = length, pos - cand
+                    if length == limit:
+                        break
+            cand = prev[cand]
+        return best_len, best_dist
+
+    return insert, longest
+
+
+def pack(data, window_bits=WINDOW_BITS, chain_max=CHAIN_MAX):
+    if not WINDOW_BITS_MIN <= window_bits <= WINDOW_BITS_MAX:
+        raise ValueError('window bits %d out of range' % window_bits)
+    _, length_max, _ = limits(window_bits)
+    insert, longest = find_matches(data, window_bits, chain_max)
+    out = bytearray(HEADER.pack(MAGIC, window_bits, len(data), hashlib.md5(data).digest()))
+    flag_pos = -1
+    flag_bit = 8
+    pos = 0
+    n = len(data)
+
+    def item(literal, payload):
+        nonlocal flag_pos, flag_bit
+        if flag_bit == 8:
+            flag_pos = len(out)
+            out.append(0)
+            flag_bit = 0
+        if literal:
+            out[flag_pos] |= 1 << flag_bit
+        flag_bit += 1
+        out.extend(payload)
+
+    cur = longest(pos) if n else (0, 0)
+    while pos < n:
+        length, dist = cur
+        insert(pos)
+        nxt = longest(pos + 1) if pos + 1 < n else (0, 0)
+        # lazy: a longer match one byte later beats this one
+        if length >= MIN_MATCH and nxt[0] <= length:
+            code = min(length - MIN_MATCH, length_max)
+            token = (dist - 1) | (code << window_bits)
+            payload = struct.pack('<H', token)
+            if code == length_max:
+                payload += bytes([length - MIN_MATCH - length_max])
+            item(False, payload)
+            for p in range(pos + 1, pos + length):
+                insert(p)
+            pos += length
+            cur = longest(pos) if pos < n else (0, 0)
+        else:
+            item(True, data[pos:pos + 1])
+            pos += 1
+            cur = nxt
+    return bytes(out)
+
+
+def unpack(packed):
+    """reference decoder, same checks as lzss_decode()"""
+    if len(packed) < HEADER.size:
+        raise FormatError('short header')
+    magic, window_bits, size, digest = HEADER.unpack_from(packed)
+    if magic != MAGIC or not WINDOW_BITS_MIN <= window_bits <= WINDOW_BITS_MAX:
+        raise FormatError('bad header')
+    _, length_max, _ = limits(window_bits)
+    out = bytearray()
+    pos = HEADER.size
+    try:
+        while len(out) < size:
+            flags = packed[pos]
+            pos += 1
+            for _ in range(8):
+                if len(out) >= size:
+                    break
+                if flags & 1:
+                    out.append(packed[pos])
+                    pos += 1
+                else:
+                    token = packed[pos] | packed[pos + 1] << 8
+                    pos += 2
+                    dist = (token & ((1 << window_bits) - 1)) + 1
+                    length = (token >> window_bits) + MIN_MATCH
+                    if length - MIN_MATCH == length_max:
+                        length += packed[pos]
+                        pos += 1
+                    if dist > len(out) or len(out) + length > size:
+                        raise FormatError('bad match at %d' % pos)
+                    for _ in range(length):
+                        out.append(out[-dist])
+                flags >>= 1
+    except IndexError:
+        raise FormatError('truncated')
+    if pos != len(packed):
+        raise FormatError('data after end')
+    if hashlib.md5(out).digest() != digest:
+        raise FormatError('md5 mismatch')
+    return bytes(out)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument('input')
+    ap.add_argument('output')
+    ap.add_argument('-d', '--decompress', action='store_true')
+    ap.add_argument('--window', type=int, default=WINDOW_BITS, help='window bits, default %d' % WINDOW_BITS)
+    ap.add_argument('--chain', type=int, default=CHAIN_MAX, help='match candidates per position')
+    args = ap.parse_args()
+
+    with open(args.input, 'rb') as f:
+        data = f.read()
+    if args.decompress:
+        out = unpack(data)
+    else:
+        out = pack(data, args.window, args.chain)
+        if unpack(out) != data:
+            sys.exit('self check failed')
+    with open(args.output, 'wb') as f:
+        f.write(out)
+    if not args.decompress:
+        print('%s: %d -> %d bytes (%.1f%%), window %d bytes, md5 %s' %
+              (args.input, len(data), len(out), 100.0 * len(out) / max(len(data), 1),
+               1 << args.window, hashlib.md5(out).hexdigest()))
+        if len(out) >= len(data):
+            print('no gain, send the raw image')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,173 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+round trip, ratio and speed test of the compressed firmware update.
+
+packs every corpus file with lzss_pack.py, builds the firmware
+decompressor (lib/lzss.c + lib/md5.c) for the host with the stand-ins in
+lzss_test/, feeds the packed file to it in random chunk sizes like
+ymodem packets and checks that the output and its md5 match. then it
+times the decompression (1024 byte chunks, md5 included) and throws
+truncated and corrupted files at a sanitizer build, which must reject
+them or at least never produce a wrong image with a good md5.
+
+the default corpus is the thumb code in the repo's prebuilt libraries,
+an application like image assembled from them, the sources' log strings
+and 0xff filled flash tail, and the two extremes (random, zeros). real
+images go with --files:
+
+    python3 lzss_test.py
+    python3 lzss_test.py --files app.bin --window 10 11
+
+the link column is the ymodem transfer time at 115200 baud of the raw
+and the packed file. decompression speed is the host's; the decoder
+does a handful of operations per output byte, the controller only has
+to keep up with the ~11 KB/s of the link.
+"""
+import argparse
+import glob
+import hashlib
+import os
+import random
+import re
+import subprocess
+import sys
+import tempfile
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import lzss_pack  # noqa: E402
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.join(HERE, '..')
+LIB = os.path.join(ROOT, 'board', 'user', 'lib')
+SIZE_LIMIT = 0x18000
+BAUD = 115200
+
+
+def build(out_dir, name, flags):
+    exe = os.path.join(out_dir, name)
+    cmd = ['gcc', '-std=gnu99', '-funsigned-char', '-Wall'] + flags + [
+        '-I', os.path.join(HERE, 'lzss_test'), '-I', LIB,
+        os.path.join(HERE, 'lzss_test', 'bench.c'),
+        os.path.join(LIB, 'lzss.c'), os.path.join(LIB, 'md5.c'), '-o', exe]
+    subprocess.check_call(cmd)
+    return exe
+
+
+def sanitizer_flags():
+    """asan/ubsan when the host gcc has them"""
+    flags = ['-O1', '-g', '-fsanitize=address,undefined', '-fno-sanitize-recover=all']
+    with tempfile.TemporaryDirectory() as d:
+        src = os.path.join(d, 't.c')
+        with open(src, 'w') as f:
+            f.write('int main(void){return 0;}\n')
+        if subprocess.call(['gcc'] + flags + [src, '-o', os.path.join(d, 't')],
+                           stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL) == 0:
+            return flags
+    return ['-O1', '-g']
+
+
+def corpus(seed):
+    """name -> bytes"""
+    items = {}
+    libs = sorted(glob.glob(os.path.join(ROOT, '**', '*.a'), recursive=True))
+    for path in libs:
+        items[os.path.basename(path)] = open(path, 'rb').read()[:SIZE_LIMIT]
+    # vector table, code, constant strings, then erased flash up to a
+    # 32 KB sector, like a linked application
+    strings = bytearray()
+    for path in sorted(glob.glob(os.path.join(ROOT, 'board', 'user', '**', '*.c'), recursive=True)):
+        with open(path, 'rb') as f:
+            for s in re.findall(rb'"((?:[^"\\\n]|\\.){4,})"', f.read()):
+                strings += s + b'\0'
+    rng = random.Random(seed)
+    vectors = bytearray(b'\x00\x80\x02\x20')
+    for _ in range(63):
+        vectors += (0x8000 + rng.randrange(0x4000) * 2 + 1).to_bytes(4, 'little')
+    image = bytes(vectors) + b''.join(items[os.path.basename(p)] for p in libs) + bytes(strings)
+    image = image[:SIZE_LIMIT - 0x2000]
+    image += b'\xff' * (-len(image) % 0x8000)
+    items['app_like.bin'] = image[:SIZE_LIMIT]
+    items['random.bin'] = bytes(rng.randrange(256) for _ in range(32768))
+    items['zeros.bin'] = bytes(SIZE_LIMIT)
+    return items
+
+
+def bench(exe, packed, seed, repeat, work):
+    src = os.path.join(work, 'in.lzs')
+    dst = os.path.join(work, 'out.bin')
+    with open(src, 'wb') as f:
+        f.write(packed)
+    p = subprocess.run([exe, src, dst, str(seed), str(repeat)], stdout=subprocess.PIPE,
+                       stderr=subprocess.PIPE)
+    if p.returncode < 0 or b'runtime error' in p.stderr or b'AddressSanitizer' in p.stderr:
+        raise RuntimeError('decoder crashed:\n' + p.stderr.decode(errors='replace'))
+    parts = p.stdout.split()
+    with open(dst, 'rb') as f:
+        out = f.read()
+    return {'done': parts[1] == b'1', 'md5_ok': parts[3] == b'1', 'us': float(parts[4]), 'out': out}
+
+
+def damage(packed, data, exe, rng, count, work):
+    """truncated and bit flipped files: a good md5 must mean a good image"""
+    bad = 0
+    for i in range(count):
+        buf = bytearray(packed)
+        if i % 2 == 0:
+            buf = buf[:rng.randrange(len(buf))]
+        else:
+            for _ in range(1 + rng.randrange(3)):
+                pos = rng.randrange(len(buf))
+                buf[pos] ^= 1 << rng.randrange(8)
+        r = bench(exe, bytes(buf), rng.randrange(1 << 30), 0, work)
+        if r['md5_ok'] and r['out'] != data:
+            bad += 1
+    return bad
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument('--files', nargs='+', help='images to test instead of the built in corpus')
+    ap.add_argument('--window', type=int, nargs='+', default=[lzss_pack.WINDOW_BITS])
+    ap.add_argument('--repeat', type=int, default=50, help='decodes per speed measurement')
+    ap.add_argument('--damage', type=int, default=40, help='damaged files per image')
+    ap.add_argument('--seed', type=int, default=1)
+    args = ap.parse_args()
+
+    if args.files:
+        items = dict((os.path.basename(p), open(p, 'rb').read()) for p in args.files)
+    else:
+        items = corpus(args.seed)
+    work = tempfile.mkdtemp()
+    fast = build(work, 'bench', ['-O2'])
+    checked = build(work, 'bench_san', sanitizer_flags())
+    rng = random.Random(args.seed)
+
+    print('%-22s %3s %7s %7s %6s %8s %9s %13s %6s %4s' %
+          ('file', 'W', 'raw', 'packed', 'ratio', 'pack s', 'MB/s', 'link s', 'damage', 'ok'))
+    failed = 0
+    for w in args.window:
+        for name, data in items.items():
+            start = time.monotonic()
+            packed = lzss_pack.pack(data, w)
+            pack_time = time.monotonic() - start
+            r = bench(fast, packed, rng.randrange(1 << 30), args.repeat, work)
+            ok = r['done'] and r['md5_ok'] and r['out'] == data and \
+                hashlib.md5(r['out']).digest() == hashlib.md5(data).digest()
+            san = bench(checked, packed, rng.randrange(1 << 30), 0, work)
+            ok = ok and san['md5_ok'] and san['out'] == data
+            bad = damage(packed, data, checked, rng, args.damage, work)
+            ok = ok and bad == 0
+            mbs = len(data) / r['us'] if r['us'] else 0.0
+            link = '%5.1f -> %5.1f' % (len(data) * 10.0 / BAUD, len(packed) * 10.0 / BAUD)
+            print('%-22s %3d %7d %7d %5.1f%% %8.2f %9.1f %13s %6d %4s' %
+                  (name[:22], w, len(data), len(packed), 100.0 * len(packed) / max(len(data), 1),
+                   pack_time, mbs, link, bad, 'yes' if ok else 'NO'))
+            sys.stdout.flush()
+            failed += 0 if ok else 1
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,116 @@
+/*
+ * host build of the firmware decompressor (lib/lzss.c) for lzss_test.py.
+ * decodes a packed file fed in random chunks like ymodem packets into a
+ * memory image the size of the update area, hashes the output like
+ * process_update() and writes it out. then decodes it again <repeat>
+ * times in 1024 byte chunks for the speed.
+ *
+ * usage: bench <packed in> <image out> <seed> <repeat>
+ * prints "result <done> <size> <md5 ok> <us per decode>" on stdout.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "lzss.h"
+#include "md5.h"
+
+#define  BENCH_SIZE_LIMIT          0x18000 /*APPLICATION_SIZE_LIMIT*/
+#define  BENCH_CHUNK_MAX           1100
+#define  BENCH_PACKET_SIZE         1024
+
+int log_enable = 1;
+
+typedef struct
+{
+    uint8_t   image[BENCH_SIZE_LIMIT];
+    uint32_t  size;
+    uint32_t  calls;
+    md5_ctx_t md5;
+}bench_sink_contex_t;
+
+static bench_sink_contex_t bench_sink_contex;
+static lzss_decoder_t bench_decoder;
+
+static int bench_output(void *arg,const uint8_t *data,uint32_t size)
+{
+    bench_sink_contex_t *contex = (bench_sink_contex_t *)arg;
+
+    /*same bound as the flash stream of the update area*/
+    if (contex->size + size > BENCH_SIZE_LIMIT || size > LZSS_FLUSH_SIZE) {
+        fprintf(stderr,"output over limit\n");
+        return -1;
+    }
+    memcpy(contex->image + contex->size,data,size);
+    contex->size += size;
+    contex->calls ++;
+    md5_update(&contex->md5,(const char *)data,size);
+    return 0;
+}
+
+static int bench_decode(const uint8_t *src,uint32_t size,unsigned int seed,uint32_t chunk)
+{
+    uint32_t part;
+
+    bench_sink_contex.size = 0;
+    bench_sink_contex.calls = 0;
+    md5_init(&bench_sink_contex.md5);
+    lzss_decoder_init(&bench_decoder,bench_output,&bench_sink_contex);
+    srand(seed);
+    while (size > 0) {
+        part = chunk > 0 ? chunk : 1 + (uint32_t)rand() % BENCH_CHUNK_MAX;
+        if (part > size) {
+            part = size;
+        }
+        if (lzss_decode(&bench_decoder,src,part) != 0) {
+            return -1;
+        }
+        src += part;
+        size -= part;
+    }
+    return 0;
+}
+
+int main(int argc,char *argv[])
+{
+    static uint8_t packed[2 * BENCH_SIZE_LIMIT];
+    char md5_value[HASHSIZE];
+    struct timespec t0,t1;
+    uint32_t size;
+    int repeat,done,md5_ok;
+    double us = 0.0;
+    FILE *f;
+
+    if (argc < 5) {
+        fprintf(stderr,"usage: %s <packed in> <image out> <seed> <repeat>\n",argv[0]);
+        return 2;
+    }
+    f = fopen(argv[1],"rb");
+    if (f == NULL) {
+        return 2;
+    }
+    size = (uint32_t)fread(packed,1,sizeof(packed),f);
+    fclose(f);
+    repeat = atoi(argv[4]);
+
+    done = bench_decode(packed,size,(unsigned int)atoi(argv[3]),0) == 0 && lzss_decode_is_done(&bench_decoder);
+    md5_final(&bench_sink_contex.md5,md5_value);
+    md5_ok = done && memcmp(md5_value,bench_decoder.md5,HASHSIZE) == 0;
+    f = fopen(argv[2],"wb");
+    if (f != NULL) {
+        fwrite(bench_sink_contex.image,1,bench_sink_contex.size,f);
+        fclose(f);
+    }
+
+    if (md5_ok && repeat > 0) {
+        log_enable = 0;
+        clock_gettime(CLOCK_MONOTONIC,&t0);
+        for (int i = 0; i < repeat; i++) {
+            bench_decode(packed,size,0,BENCH_PACKET_SIZE);
+        }
+        clock_gettime(CLOCK_MONOTONIC,&t1);
+        us = ((t1.tv_sec - t0.tv_sec) * 1e6 + (t1.tv_nsec - t0.tv_nsec) / 1e3) / repeat;
+    }
+    printf("result %d %u %d %.1f\n",done,bench_sink_contex.size,md5_ok,us);
+    return md5_ok ? 0 : 1;
+}
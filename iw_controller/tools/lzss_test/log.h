@@ -0,0 +1,15 @@
+/*
+ * host stand-in for board/user/debug/log/log.h
+ */
+#ifndef __LOG_H__
+#define __LOG_H__
+
+#include <stdio.h>
+
+#define  log_error(...)    do { if (log_enable) fprintf(stderr,"[lzss] " __VA_ARGS__); } while (0)
+#define  log_info(...)     do { if (log_enable) fprintf(stderr,"[lzss] " __VA_ARGS__); } while (0)
+#define  log_debug(...)
+
+extern int log_enable;
+
+#endif
@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+concurrency stress test of the message pool (msg_pool/msg_pool.c).
+
+builds msg_pool.c for the host with the stand-ins in msg_pool_stress/,
+where tasks and interrupts are threads and the interrupt mask is a
+global mutex. task producers and interrupt producers (send timeout 0,
+bursts) post stack messages with msg_pool_send to slow consumers until
+the pool runs dry and the queues fill up (see msg_pool_stress/stress.c).
+the run fails unless the pool counters are exact (alloc, exhaustion,
+invalid free and what msg_pool_check reported), every sent message
+arrived once and unchanged while its consumer held it, and the pool is
+full again at the end. every seed also runs on a sanitizer build.
+
+    python3 msg_pool_stress.py
+    python3 msg_pool_stress.py --seeds 1 2 3 --attempts 50000 --hold 300
+"""
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import lzss_test  # noqa: E402
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+USER = os.path.join(HERE, '..', 'board', 'user')
+
+
+def build(out_dir, name, flags):
+    exe = os.path.join(out_dir, name)
+    # msg_pool_put passes the block address as uint32_t like on the target
+    cmd = ['gcc', '-std=gnu99', '-funsigned-char', '-Wall', '-Wno-pointer-to-int-cast',
+           '-fno-pie', '-no-pie'] + flags + [
+        '-I', os.path.join(HERE, 'msg_pool_stress'), '-I', os.path.join(USER, 'msg_pool'),
+        os.path.join(HERE, 'msg_pool_stress', 'stress.c'), os.path.join(USER, 'msg_pool', 'msg_pool.c'),
+        '-lpthread', '-o', exe]
+    subprocess.check_call(cmd)
+    return exe
+
+
+def run(exe, seed, attempts, hold):
+    start = time.time()
+    p = subprocess.run([exe, str(seed), str(attempts), str(hold)], stdout=subprocess.PIPE,
+                       stderr=subprocess.PIPE, universal_newlines=True)
+    checks = {}
+    failed = []
+    for line in p.stdout.splitlines():
+        parts = line.split()
+        if len(parts) >= 2 and parts[0] == 'check' and parts[-1] in ('ok', 'FAIL'):
+            name = ' '.join(parts[1:-3])
+            checks[name] = int(parts[-3])
+            if parts[-1] == 'FAIL':
+                failed.append(line)
+    ok = p.returncode == 0 and not failed and 'result 0' in p.stdout
+    if not ok:
+        failed.append('exit %d' % p.returncode)
+        failed += p.stderr.splitlines()[-20:]
+    return ok, checks, failed, time.time() - start
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument('--seeds', type=int, nargs='+', default=[1, 2])
+    ap.add_argument('--attempts', type=int, default=20000, help='sends per producer')
+    ap.add_argument('--hold', type=int, default=100, help='longest time a consumer holds a message, us')
+    args = ap.parse_args()
+
+    work = tempfile.mkdtemp()
+    builds = [('O2', build(work, 'stress', ['-O2'])),
+              ('sanitizer', build(work, 'stress_san', lzss_test.sanitizer_flags()))]
+    print('%-10s %5s %8s %8s %8s %8s %8s %7s %4s' %
+          ('build', 'seed', 'sent', 'received', 'no mem', 'put fail', 'max used', 'time s', 'ok'))
+    failed = 0
+    for name, exe in builds:
+        for seed in args.seeds:
+            ok, checks, lines, elapsed = run(exe, seed, args.attempts, args.hold)
+            print('%-10s %5d %8d %8d %8d %8d %8d %7.1f %4s' %
+                  (name, seed, checks.get('sent', 0), checks.get('received', 0), checks.get('fail_cnt', 0),
+                   checks.get('alloc_cnt', 0) - checks.get('sent', 0), checks.get('used_max', 0),
+                   elapsed, 'yes' if ok else 'NO'))
+            for line in lines:
+                print('    ' + line)
+            sys.stdout.flush()
+            failed += 0 if ok else 1
+    print('result: %s' % ('FAIL' if failed else 'ok'))
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
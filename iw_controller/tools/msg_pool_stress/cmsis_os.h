@@ -0,0 +1,71 @@
+/*
+ * host stand-in for board/user/rtos/cmsis_os.h. tasks and interrupts are
+ * pthreads: the interrupt mask is one global mutex, so a critical section
+ * excludes every other thread like it excludes interrupts and the
+ * scheduler on the board. message queues are bounded fifos of 32 bit
+ * values; msg_pool_put passes block addresses as uint32_t like on the
+ * target, so the test links with -no-pie to keep the pools below 4 GB.
+ */
+#ifndef __CMSIS_OS_H__
+#define __CMSIS_OS_H__
+
+#include <stdint.h>
+#include <pthread.h>
+
+#define  osWaitForever                   0xFFFFFFFF
+#define  OS_QUEUE_SIZE_MAX               16
+
+typedef unsigned long UBaseType_t;
+
+typedef enum
+{
+    osOK = 0,
+    osEventMessage = 0x10,
+    osEventTimeout = 0x40,
+    osErrorResource = 0x81,
+    osErrorNoMemory = 0x85,
+    osErrorOS = 0xFF
+}osStatus;
+
+typedef struct
+{
+    osStatus status;
+    union
+    {
+        uint32_t v;
+        void *p;
+    }value;
+}osEvent;
+
+typedef struct
+{
+    pthread_mutex_t lock;
+    pthread_cond_t  changed;
+    uint32_t        item[OS_QUEUE_SIZE_MAX];
+    uint32_t        size;
+    uint32_t        head;
+    uint32_t        cnt;
+}os_queue_t;
+
+typedef os_queue_t *osMessageQId;
+
+extern pthread_mutex_t os_interrupt_mask;
+
+static inline UBaseType_t portSET_INTERRUPT_MASK_FROM_ISR(void)
+{
+    pthread_mutex_lock(&os_interrupt_mask);
+    return 0;
+}
+
+static inline void portCLEAR_INTERRUPT_MASK_FROM_ISR(UBaseType_t mask)
+{
+    (void)mask;
+    pthread_mutex_unlock(&os_interrupt_mask);
+}
+
+/*queue helpers in stress.c, timeout 0 is the interrupt variant*/
+void os_queue_init(os_queue_t *queue,uint32_t size);
+osStatus osMessagePut(osMessageQId id,uint32_t info,uint32_t millisec);
+osEvent osMessageGet(osMessageQId id,uint32_t millisec);
+
+#endif
@@ -0,0 +1,24 @@
+/*
+ * host stand-in for the cmsis core intrinsics msg_pool.c uses
+ */
+#ifndef __FSL_COMMON_H__
+#define __FSL_COMMON_H__
+
+#include <stdint.h>
+
+static inline uint32_t __RBIT(uint32_t value)
+{
+    uint32_t result = 0;
+
+    for (int i = 0;i < 32;i ++) {
+        result = (result << 1) | ((value >> i) & 1);
+    }
+    return result;
+}
+
+static inline uint32_t __CLZ(uint32_t value)
+{
+    return value == 0 ? 32 : __builtin_clz(value);
+}
+
+#endif
@@ -0,0 +1,17 @@
+/*
+ * host stand-in for board/user/debug/log/log.h, errors go to stress.c
+ * which counts what msg_pool_check reports.
+ */
+#ifndef __LOG_H__
+#define __LOG_H__
+
+#include <stdio.h>
+
+void stress_log_error(const char *fmt,...);
+
+#define  log_error(...)    stress_log_error(__VA_ARGS__)
+#define  log_warning(...)  fprintf(stderr,"[msg pool] " __VA_ARGS__)
+#define  log_info(...)     fprintf(stderr,"[msg pool] " __VA_ARGS__)
+#define  log_debug(...)
+
+#endif
@@ -0,0 +1,436 @@
+/*
+ * host stress test of the message pool (board/user/msg_pool/msg_pool.c)
+ * for msg_pool_stress.py.
+ *
+ * STRESS_TASK_CNT task producers (send timeout STRESS_TASK_TIMEOUT) and
+ * STRESS_ISR_CNT interrupt producers (timeout 0, bursts) send copies of a
+ * stack message with msg_pool_send to STRESS_CONSUMER_CNT slow consumers,
+ * one queue each. a consumer checks the block, holds it for a random time,
+ * checks it again (nobody else may have been handed the block meanwhile),
+ * poisons it and frees it. a monitor task calls msg_pool_check all along.
+ * the pool is smaller than the queues plus what the consumers hold, so
+ * both exhaustion and full queues happen.
+ *
+ * afterwards every counter must be exact: alloc_cnt is the successful
+ * sends plus the sends whose put failed, fail_cnt the osErrorNoMemory
+ * returns and what msg_pool_check reported, every successful send was
+ * received exactly once and intact, no free failed and the pool is full
+ * again. a last single threaded pass exhausts the pool on purpose and
+ * frees a block twice, inside a block and past the pool, which must be
+ * refused and reported by msg_pool_check.
+ *
+ * usage: stress <seed> <attempts per producer> <consumer hold us>
+ * prints one "check" line per counter and "result <failures>" on stdout.
+ */
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include "msg_pool.h"
+
+#define  STRESS_POOL_CNT            8
+#define  STRESS_QUEUE_SIZE          4
+#define  STRESS_CONSUMER_CNT        2
+#define  STRESS_TASK_CNT            3
+#define  STRESS_ISR_CNT             2
+#define  STRESS_PRODUCER_CNT        (STRESS_TASK_CNT + STRESS_ISR_CNT)
+#define  STRESS_TASK_TIMEOUT        1     /*ms*/
+#define  STRESS_TASK_PACE_US        40
+#define  STRESS_ISR_BURST_MAX       4
+#define  STRESS_ISR_PACE_US         200
+#define  STRESS_CONSUMER_WAIT       5     /*ms*/
+#define  STRESS_MONITOR_US          1000
+#define  STRESS_POISON              0xDD
+
+typedef struct
+{
+    uint32_t producer;
+    uint32_t seq;
+    uint32_t check;
+    uint8_t  fill[20];
+}stress_msg_t;
+
+typedef struct
+{
+    uint32_t id;
+    uint32_t seed;
+    bool     isr;
+    uint32_t ok;
+    uint32_t nomem;
+    uint32_t put_fail;
+}stress_producer_t;
+
+typedef struct
+{
+    uint32_t id;
+    uint32_t seed;
+    uint32_t received;
+    uint32_t duplicate;
+    uint32_t corrupt;
+    uint32_t free_fail;
+}stress_consumer_t;
+
+pthread_mutex_t os_interrupt_mask = PTHREAD_MUTEX_INITIALIZER;
+
+MSG_POOL_DEF(stress_pool,stress_msg_t,STRESS_POOL_CNT);
+
+static os_queue_t stress_queue[STRESS_CONSUMER_CNT];
+static stress_producer_t stress_producer[STRESS_PRODUCER_CNT];
+static stress_consumer_t stress_consumer[STRESS_CONSUMER_CNT];
+static uint32_t stress_attempts;
+static uint32_t stress_hold_us;
+/*bit per producer and seq: sent ok, received*/
+static uint8_t *stress_sent[STRESS_PRODUCER_CNT];
+static uint8_t *stress_received[STRESS_PRODUCER_CNT];
+static volatile int stress_producing = 1;
+static volatile int stress_running = 1;
+static uint32_t stress_logged_exhausted;
+static uint32_t stress_logged_invalid;
+static int stress_failures;
+
+void stress_log_error(const char *fmt,...)
+{
+    char buf[160];
+    const char *p;
+    unsigned n;
+    va_list ap;
+
+    va_start(ap,fmt);
+    vsnprintf(buf,sizeof(buf),fmt,ap);
+    va_end(ap);
+    if ((p = strstr(buf,"exhausted ")) != NULL && sscanf(p,"exhausted %u",&n) == 1) {
+        stress_logged_exhausted += n;
+    } else if ((p = strstr(buf,"invalid free ")) != NULL && sscanf(p,"invalid free %u",&n) == 1) {
+        stress_logged_invalid += n;
+    } else {
+        fprintf(stderr,"[msg pool] %s",buf);
+    }
+}
+
+void os_queue_init(os_queue_t *queue,uint32_t size)
+{
+    pthread_mutex_init(&queue->lock,NULL);
+    pthread_cond_init(&queue->changed,NULL);
+    queue->size = size;
+    queue->head = 0;
+    queue->cnt = 0;
+}
+
+static void stress_deadline(struct timespec *ts,uint32_t millisec)
+{
+    clock_gettime(CLOCK_REALTIME,ts);
+    ts->tv_sec += millisec / 1000;
+    ts->tv_nsec += (long)(millisec % 1000) * 1000000;
+    if (ts->tv_nsec >= 1000000000) {
+        ts->tv_sec ++;
+        ts->tv_nsec -= 1000000000;
+    }
+}
+
+osStatus osMessagePut(osMessageQId id,uint32_t info,uint32_t millisec)
+{
+    struct timespec ts;
+    osStatus status = osOK;
+
+    stress_deadline(&ts,millisec);
+    pthread_mutex_lock(&id->lock);
+    while (id->cnt == id->size) {
+        if (millisec == 0 || pthread_cond_timedwait(&id->changed,&id->lock,&ts) == ETIMEDOUT) {
+            break;
+        }
+    }
+    if (id->cnt == id->size) {
+        status = osErrorOS;
+    } else {
+        id->item[(id->head + id->cnt) % id->size] = info;
+        id->cnt ++;
+        pthread_cond_broadcast(&id->changed);
+    }
+    pthread_mutex_unlock(&id->lock);
+
+    return status;
+}
+
+osEvent osMessageGet(osMessageQId id,uint32_t millisec)
+{
+    struct timespec ts;
+    osEvent event;
+
+    event.status = osEventTimeout;
+    event.value.p = NULL;
+    stress_deadline(&ts,millisec);
+    pthread_mutex_lock(&id->lock);
+    while (id->cnt == 0) {
+        if (millisec == 0 || pthread_cond_timedwait(&id->changed,&id->lock,&ts) == ETIMEDOUT) {
+            break;
+        }
+    }
+    if (id->cnt > 0) {
+        event.status = osEventMessage;
+        event.value.p = (void *)(uintptr_t)id->item[id->head];
+        id->head = (id->head + 1) % id->size;
+        id->cnt --;
+        pthread_cond_broadcast(&id->changed);
+    }
+    pthread_mutex_unlock(&id->lock);
+
+    return event;
+}
+
+static uint32_t stress_check_value(uint32_t producer,uint32_t seq)
+{
+    return producer * 0x9E3779B1 ^ seq * 0x85EBCA77;
+}
+
+static void stress_msg_fill(stress_msg_t *msg,uint32_t producer,uint32_t seq)
+{
+    msg->producer = producer;
+    msg->seq = seq;
+    msg->check = stress_check_value(producer,seq);
+    for (uint32_t i = 0;i < sizeof(msg->fill);i ++) {
+        msg->fill[i] = (uint8_t)(seq + i * 7);
+    }
+}
+
+static bool stress_msg_valid(const stress_msg_t *msg)
+{
+    if (msg->producer >= STRESS_PRODUCER_CNT || msg->seq >= stress_attempts ||
+        msg->check != stress_check_value(msg->producer,msg->seq)) {
+        return false;
+    }
+    for (uint32_t i = 0;i < sizeof(msg->fill);i ++) {
+        if (msg->fill[i] != (uint8_t)(msg->seq + i * 7)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void *stress_producer_thread(void *arg)
+{
+    stress_producer_t *p = arg;
+    stress_msg_t msg;
+    osStatus status;
+    uint32_t seq = 0,burst;
+
+    while (seq < stress_attempts) {
+        burst = p->isr ? 1 + rand_r(&p->seed) % STRESS_ISR_BURST_MAX : 1;
+        for (;burst > 0 && seq < stress_attempts;burst --,seq ++) {
+            stress_msg_fill(&msg,p->id,seq);
+            status = msg_pool_send(&stress_pool,&stress_queue[rand_r(&p->seed) % STRESS_CONSUMER_CNT],&msg,
+                                   p->isr ? 0 : STRESS_TASK_TIMEOUT);
+            if (status == osOK) {
+                p->ok ++;
+                stress_sent[p->id][seq / 8] |= 1 << (seq % 8);
+            } else if (status == osErrorNoMemory) {
+                p->nomem ++;
+            } else {
+                p->put_fail ++;
+            }
+            /*the message was copied, the stack copy is free to change*/
+            memset(&msg,0,sizeof(msg));
+        }
+        usleep(rand_r(&p->seed) % (p->isr ? STRESS_ISR_PACE_US : STRESS_TASK_PACE_US));
+    }
+    return NULL;
+}
+
+static void *stress_consumer_thread(void *arg)
+{
+    stress_consumer_t *c = arg;
+    stress_msg_t *msg;
+    osEvent event;
+    uint8_t bit;
+
+    while (1) {
+        event = osMessageGet(&stress_queue[c->id],STRESS_CONSUMER_WAIT);
+        if (event.status != osEventMessage) {
+            if (!stress_producing) {
+                break;
+            }
+            continue;
+        }
+        msg = event.value.p;
+        if (!stress_msg_valid(msg)) {
+            c->corrupt ++;
+        } else {
+            bit = 1 << (msg->seq % 8);
+            pthread_mutex_lock(&os_interrupt_mask);
+            if (stress_received[msg->producer][msg->seq / 8] & bit) {
+                c->duplicate ++;
+            }
+            stress_received[msg->producer][msg->seq / 8] |= bit;
+            pthread_mutex_unlock(&os_interrupt_mask);
+            c->received ++;
+        }
+        if (stress_hold_us > 0) {
+            usleep(rand_r(&c->seed) % stress_hold_us);
+        }
+        /*still ours: a block handed out twice or reused early is overwritten by now*/
+        if (!stress_msg_valid(msg)) {
+            c->corrupt ++;
+        }
+        memset(msg,STRESS_POISON,sizeof(*msg));
+        if (msg_pool_free(&stress_pool,msg) != 0) {
+            c->free_fail ++;
+        }
+    }
+    return NULL;
+}
+
+static void *stress_monitor_thread(void *arg)
+{
+    (void)arg;
+    while (stress_running) {
+        msg_pool_check();
+        usleep(STRESS_MONITOR_US);
+    }
+    return NULL;
+}
+
+static void stress_expect(const char *name,uint32_t value,uint32_t expect)
+{
+    bool ok = value == expect;
+
+    printf("check %-26s %10u %10u %s\n",name,value,expect,ok ? "ok" : "FAIL");
+    stress_failures += ok ? 0 : 1;
+}
+
+static void stress_expect_nonzero(const char *name,uint32_t value)
+{
+    printf("check %-26s %10u %10s %s\n",name,value,">0",value > 0 ? "ok" : "FAIL");
+    stress_failures += value > 0 ? 0 : 1;
+}
+
+/*
+ * single threaded: exhaustion and frees the pool must refuse
+ */
+static void stress_misuse(void)
+{
+    void *block[STRESS_POOL_CNT];
+    uint32_t fail_cnt = stress_pool.fail_cnt;
+    uint32_t free_err_cnt = stress_pool.free_err_cnt;
+    uint32_t distinct = 0,refused = 0;
+
+    for (uint32_t i = 0;i < STRESS_POOL_CNT;i ++) {
+        block[i] = msg_pool_alloc(&stress_pool);
+        distinct += block[i] != NULL ? 1 : 0;
+        for (uint32_t j = 0;j < i;j ++) {
+            distinct -= block[i] == block[j] ? 1 : 0;
+        }
+    }
+    stress_expect("exhaust distinct blocks",distinct,STRESS_POOL_CNT);
+    stress_expect("exhaust alloc null",msg_pool_alloc(&stress_pool) == NULL ? 1 : 0,1);
+    stress_expect("exhaust fail_cnt",stress_pool.fail_cnt - fail_cnt,1);
+
+    for (uint32_t i = 0;i < STRESS_POOL_CNT;i ++) {
+        msg_pool_free(&stress_pool,block[i]);
+    }
+    refused += msg_pool_free(&stress_pool,block[0]) != 0 ? 1 : 0;
+    refused += msg_pool_free(&stress_pool,(uint8_t *)block[1] + 4) != 0 ? 1 : 0;
+    refused += msg_pool_free(&stress_pool,stress_pool_block + STRESS_POOL_CNT) != 0 ? 1 : 0;
+    stress_expect("invalid free refused",refused,3);
+    stress_expect("invalid free free_err_cnt",stress_pool.free_err_cnt - free_err_cnt,3);
+    stress_expect("invalid free used",stress_pool.used,0);
+
+    stress_logged_exhausted = 0;
+    stress_logged_invalid = 0;
+    msg_pool_check();
+    stress_expect("invalid free logged exh.",stress_logged_exhausted,1);
+    stress_expect("invalid free logged",stress_logged_invalid,3);
+}
+
+int main(int argc,char *argv[])
+{
+    pthread_t producer[STRESS_PRODUCER_CNT],consumer[STRESS_CONSUMER_CNT],monitor;
+    uint32_t seed,ok = 0,nomem = 0,put_fail = 0,put_fail_isr = 0;
+    uint32_t received = 0,duplicate = 0,corrupt = 0,free_fail = 0,missing = 0,unsent = 0;
+
+    if (argc != 4) {
+        fprintf(stderr,"usage: stress <seed> <attempts per producer> <consumer hold us>\n");
+        return 2;
+    }
+    seed = strtoul(argv[1],NULL,0);
+    stress_attempts = strtoul(argv[2],NULL,0);
+    stress_hold_us = strtoul(argv[3],NULL,0);
+    /*msg_pool_put passes the block as uint32_t like on the target*/
+    if ((uintptr_t)(uint32_t)(uintptr_t)stress_pool_block != (uintptr_t)stress_pool_block) {
+        fprintf(stderr,"pool above 4 GB, link with -no-pie\n");
+        return 2;
+    }
+    if (msg_pool_init(&stress_pool) != 0) {
+        return 2;
+    }
+    for (uint32_t i = 0;i < STRESS_CONSUMER_CNT;i ++) {
+        os_queue_init(&stress_queue[i],STRESS_QUEUE_SIZE);
+        stress_consumer[i].id = i;
+        stress_consumer[i].seed = seed * 31 + 1000 + i;
+        pthread_create(&consumer[i],NULL,stress_consumer_thread,&stress_consumer[i]);
+    }
+    pthread_create(&monitor,NULL,stress_monitor_thread,NULL);
+    for (uint32_t i = 0;i < STRESS_PRODUCER_CNT;i ++) {
+        stress_sent[i] = calloc((stress_attempts + 7) / 8,1);
+        stress_received[i] = calloc((stress_attempts + 7) / 8,1);
+        stress_producer[i].id = i;
+        stress_producer[i].seed = seed * 31 + i;
+        stress_producer[i].isr = i >= STRESS_TASK_CNT;
+        pthread_create(&producer[i],NULL,stress_producer_thread,&stress_producer[i]);
+    }
+
+    for (uint32_t i = 0;i < STRESS_PRODUCER_CNT;i ++) {
+        pthread_join(producer[i],NULL);
+    }
+    stress_producing = 0;
+    for (uint32_t i = 0;i < STRESS_CONSUMER_CNT;i ++) {
+        pthread_join(consumer[i],NULL);
+    }
+    stress_running = 0;
+    pthread_join(monitor,NULL);
+    msg_pool_check();
+
+    for (uint32_t i = 0;i < STRESS_PRODUCER_CNT;i ++) {
+        ok += stress_producer[i].ok;
+        nomem += stress_producer[i].nomem;
+        put_fail += stress_producer[i].put_fail;
+        put_fail_isr += stress_producer[i].isr ? stress_producer[i].put_fail : 0;
+        for (uint32_t seq = 0;seq < stress_attempts;seq ++) {
+            uint8_t bit = 1 << (seq % 8);
+            missing += (stress_sent[i][seq / 8] & bit) && !(stress_received[i][seq / 8] & bit) ? 1 : 0;
+            unsent += !(stress_sent[i][seq / 8] & bit) && (stress_received[i][seq / 8] & bit) ? 1 : 0;
+        }
+    }
+    for (uint32_t i = 0;i < STRESS_CONSUMER_CNT;i ++) {
+        received += stress_consumer[i].received;
+        duplicate += stress_consumer[i].duplicate;
+        corrupt += stress_consumer[i].corrupt;
+        free_fail += stress_consumer[i].free_fail;
+    }
+
+    printf("check %-26s %10s %10s\n","","value","expect");
+    stress_expect("attempts",ok + nomem + put_fail,stress_attempts * STRESS_PRODUCER_CNT);
+    stress_expect("alloc_cnt",stress_pool.alloc_cnt,ok + put_fail);
+    stress_expect("fail_cnt",stress_pool.fail_cnt,nomem);
+    stress_expect("logged exhausted",stress_logged_exhausted,nomem);
+    stress_expect("free_err_cnt",stress_pool.free_err_cnt,0);
+    stress_expect("logged invalid free",stress_logged_invalid,0);
+    stress_expect("received",received,ok);
+    stress_expect("missing",missing,0);
+    stress_expect("received not sent",unsent,0);
+    stress_expect("duplicate",duplicate,0);
+    stress_expect("corrupt",corrupt,0);
+    stress_expect("consumer free failed",free_fail,0);
+    stress_expect("used",stress_pool.used,0);
+    stress_expect("free_map",stress_pool.free_map,(1UL << STRESS_POOL_CNT) - 1);
+    stress_expect("used_max",stress_pool.used_max,STRESS_POOL_CNT);
+    stress_expect_nonzero("sent",ok);
+    stress_expect_nonzero("exhausted",nomem);
+    stress_expect_nonzero("put failed from isr",put_fail_isr);
+    stress_misuse();
+    printf("result %d\n",stress_failures);
+
+    return stress_failures ? 1 : 0;
+}
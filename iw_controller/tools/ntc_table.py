@@ -0,0 +1,202 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+generate an adc code -> temperature lookup table for temperature_table.c.
+
+the ntc divider is supply -- ntc -- adc -- bypass resistor -- gnd, so
+
+    r_ntc = supply * adc_max * r_bypass / (adc * vref) - r_bypass
+
+the table holds the temperature in 0.01 C at every 2^shift adc codes; the
+firmware interpolates linearly between two entries with integer math.
+
+before writing anything the generated table is checked against the old
+float path (get_r + binary search over the r/t map + float interpolation)
+for every valid adc code, and generation fails if the difference is ever
+larger than --tolerance. rerun after changing the curve or the divider:
+
+    python3 ntc_table.py -o ../board/user/tasks
+
+every probe type gets its own table, e.g. a probe with another curve:
+
+    python3 ntc_table.py --name evaporator --curve evaporator.csv -o ../board/user/tasks
+
+the curve file has one "temperature,resistance" pair per line, resistance
+decreasing. declare the new table in temperature_table.h and add the
+generated temperature_table_<name>.c to the iar project.
+"""
+import argparse
+import os
+import sys
+
+# ntc curve: (temperature C, resistance ohm), resistance strictly decreasing
+T_R_MAP = [
+    (-22, 21180), (-21, 20010), (-20, 18900), (-19, 17870), (-18, 16900), (-17, 15980), (-16, 15120), (-15, 14310),
+    (-14, 13550), (-13, 12830), (-12, 12160), (-11, 11520), (-10, 10920), (-9, 10350), (-8, 9820), (-7, 9316),
+    (-6, 8841), (-5, 8392), (-4, 7968), (-3, 7568), (-2, 7190), (-1, 6833), (0, 6495), (1, 6175),
+    (2, 5873), (3, 5587), (4, 5315), (5, 5060), (6, 4818), (7, 4589), (8, 4372), (9, 4167),
+    (10, 3972), (11, 3788), (12, 3613), (13, 3447), (14, 3290), (15, 3141), (16, 2999), (17, 2865),
+    (18, 2737), (19, 2616), (20, 2501), (21, 2391), (22, 2287), (23, 2188), (24, 2094), (25, 2005),
+    (26, 1919), (27, 1838), (28, 1761), (29, 1687), (30, 1617), (31, 1550), (32, 1486), (33, 1426),
+    (34, 1368), (35, 1312), (36, 1259), (37, 1209), (38, 1161), (39, 1115), (40, 1071), (41, 1029),
+    (42, 989), (43, 951), (44, 914), (45, 879), (46, 845), (47, 813), (48, 783), (49, 753),
+    (50, 725), (51, 698), (52, 672), (53, 647), (54, 624), (55, 601), (56, 579), (57, 559),
+    (58, 539), (59, 520), (60, 502), (61, 484), (62, 467), (63, 451), (64, 435), (65, 421),
+    (66, 406), (67, 392),
+]
+
+# usable part of the default curve, same limits as the old TR_MAP_IDX_MIN/MAX
+T_R_MAP_IDX_MIN = 2
+T_R_MAP_IDX_MAX = 82
+
+# adc codes at or beyond these are a shorted or open sensor
+ADC_ERR_MAX = 4090
+ADC_ERR_MIN = 5
+
+HEADER = """\
+/*
+* 由tools/ntc_table.py生成,不要手动修改
+* 阻温表,分压电阻或者ADC参数变化后重新生成
+*/
+"""
+
+
+def ntc_r(adc, args):
+    """resistance as the firmware float path computed it (truncated)"""
+    r = (args.supply * args.adc_max * args.bypass) / (adc * args.vref) - args.bypass
+    return int(r)
+
+
+def interpolate(r, curve):
+    """temperature of resistance r on the piecewise linear curve"""
+    for i in range(len(curve) - 1):
+        t1, r1 = curve[i]
+        t2, r2 = curve[i + 1]
+        if r1 >= r > r2:
+            return t1 + (r1 - r) / (r1 - r2)
+    return None
+
+
+def float_path(adc, args):
+    """reference: the float conversion the table replaces, None on error"""
+    if adc >= ADC_ERR_MAX or adc <= ADC_ERR_MIN:
+        return None
+    r = ntc_r(adc, args)
+    if r <= args.curve[args.idx_max][1] or r >= args.curve[args.idx_min][1]:
+        return None
+    return interpolate(r, args.curve)
+
+
+def table_path(adc, table, base, shift):
+    """the integer lookup exactly as temperature_table_lookup does it"""
+    index = (adc >> shift) - base
+    frac = adc & ((1 << shift) - 1)
+    diff = table[index + 1] - table[index]
+    return table[index] + ((diff * frac + (1 << (shift - 1))) >> shift)
+
+
+def build(args):
+    valid = [adc for adc in range(args.adc_max) if float_path(adc, args) is not None]
+    if not valid:
+        sys.exit("no valid adc code")
+    adc_min, adc_max = valid[0], valid[-1]
+    if valid != list(range(adc_min, adc_max + 1)):
+        sys.exit("valid adc codes are not contiguous")
+
+    step = 1 << args.shift
+    base = adc_min >> args.shift
+    table = []
+    for k in range(base, (adc_max >> args.shift) + 2):
+        t = interpolate(ntc_r(k * step, args), args.curve)
+        if t is None:
+            sys.exit("adc code %d outside the r/t map" % (k * step))
+        table.append(int(round(t * 100)))
+    for i in range(len(table) - 1):
+        if table[i + 1] < table[i]:
+            sys.exit("table is not monotonic at entry %d" % i)
+
+    worst, worst_adc = 0.0, adc_min
+    for adc in valid:
+        err = abs(table_path(adc, table, base, args.shift) / 100.0 - float_path(adc, args))
+        if err > worst:
+            worst, worst_adc = err, adc
+    if worst > args.tolerance:
+        sys.exit("adc %d differs from the float path by %.4f C > %.4f C" % (worst_adc, worst, args.tolerance))
+    return adc_min, adc_max, base, table, worst, worst_adc
+
+
+def write(args, adc_min, adc_max, base, table, worst, worst_adc):
+    rows = []
+    for i in range(0, len(table), 10):
+        rows.append("".join("%6d," % v for v in table[i:i + 10]))
+    c = HEADER + """\
+#include "temperature_table.h"
+
+
+/*第i项为adc数值(base + i) << shift时的温度,与浮点算法最大误差{worst:.4f}C(adc:{worst_adc})*/
+static const int16_t temperature_table_{name}_value[{size}] = {{
+{rows}
+}};
+
+const temperature_table_t temperature_table_{name} = {{
+.name = "{name}",
+.adc_min = {adc_min},
+.adc_max = {adc_max},
+.shift = {shift},
+.base = {base},
+.size = {size},
+.value = temperature_table_{name}_value
+}};
+""".format(name=args.name, adc_min=adc_min, adc_max=adc_max, shift=args.shift, base=base, size=len(table),
+           worst=worst, worst_adc=worst_adc, rows="\n".join(rows))
+
+    with open(os.path.join(args.output, "temperature_table_%s.c" % args.name), "w") as f:
+        f.write(c)
+
+
+def load_curve(path):
+    """read "temperature,resistance" lines"""
+    curve = []
+    with open(path) as f:
+        for line in f:
+            line = line.split("#")[0].strip()
+            if not line:
+                continue
+            t, r = line.split(",")
+            curve.append((int(t), int(r)))
+    for i in range(len(curve) - 1):
+        if curve[i + 1][1] >= curve[i][1]:
+            sys.exit("curve resistance is not decreasing at line %d" % (i + 2))
+    return curve
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("-o", "--output", default=".", help="output directory")
+    parser.add_argument("--name", default="ntc", help="table name, gives temperature_table_<name>")
+    parser.add_argument("--curve", help="curve file, default is the built-in cabinet ntc curve")
+    parser.add_argument("--idx-min", type=int, help="first usable curve point, default 2 of the built-in curve")
+    parser.add_argument("--idx-max", type=int, help="last usable curve point, default 82 of the built-in curve")
+    parser.add_argument("--shift", type=int, default=3, help="table step is 2^shift adc codes")
+    parser.add_argument("--adc-max", type=int, default=4096, help="adc full scale")
+    parser.add_argument("--bypass", type=float, default=5100, help="bypass resistor ohm")
+    parser.add_argument("--vref", type=float, default=3.30, help="adc reference voltage")
+    parser.add_argument("--supply", type=float, default=3.30, help="ntc supply voltage")
+    parser.add_argument("--tolerance", type=float, default=0.05, help="max difference to the float path in C")
+    args = parser.parse_args()
+    if args.curve:
+        args.curve = load_curve(args.curve)
+        args.idx_min = 0 if args.idx_min is None else args.idx_min
+        args.idx_max = len(args.curve) - 1 if args.idx_max is None else args.idx_max
+    else:
+        args.curve = T_R_MAP
+        args.idx_min = T_R_MAP_IDX_MIN if args.idx_min is None else args.idx_min
+        args.idx_max = T_R_MAP_IDX_MAX if args.idx_max is None else args.idx_max
+
+    adc_min, adc_max, base, table, worst, worst_adc = build(args)
+    write(args, adc_min, adc_max, base, table, worst, worst_adc)
+    print("adc %d..%d, %d entries, max err %.4f C at adc %d" % (adc_min, adc_max, len(table), worst, worst_adc))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,266 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+smoke test of the linux simulation build (CMakeLists.txt, board/sim).
+
+boots iw_controller_sim in a fresh state directory and talks to the
+firmware like the host does, over the pseudo terminal of serial port 0:
+
+    first boot     the firmware writes the init env and resets itself,
+                   the simulator re-executes and the ports come back
+    version        CODE_QUERY_SOFTWARE_VER answers firmware_version.h
+    door           door status follows the door input (gpio -> pint ->
+                   lock task -> communication task)
+    temperature    the adc probes give a plausible temperature (ctimer
+                   trigger -> adc -> dma -> adc task -> temperature task)
+    reset          a second start keeps eeprom.bin and flash.bin, no
+                   second first-boot reset
+
+the Sim class is usable from other host tests:
+
+    python3 sim_smoke.py _gate_build/iw_controller_sim
+"""
+import argparse
+import os
+import re
+import select
+import signal
+import subprocess
+import sys
+import tempfile
+import termios
+import time
+import tty
+
+ADU_ADDR = 0x01
+CODE_QUERY_DOOR_STATUS = 0x11
+CODE_QUERY_TEMPERATURE = 0x41
+CODE_QUERY_SOFTWARE_VER = 0x52
+
+DOOR_OPEN_LEVEL = 1          # BSP_DOOR_OPEN_LEVEL
+DATA_STATUS_DOOR_OPEN = 0x01
+DATA_STATUS_DOOR_CLOSE = 0x00
+
+BOOT_TIMEOUT = 10.0
+RSP_TIMEOUT = 2.0
+FRAME_GAP = 0.05             # firmware frame timeout is 3 ms
+INPUT_SETTLE = 0.5           # inputs file is read every 50 ms, lock task debounces
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+
+class SimError(Exception):
+    pass
+
+
+def crc16(data):
+    """modbus crc, sent low byte first like adu_add_crc16"""
+    crc = 0xFFFF
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = (crc >> 1) ^ 0xA001 if crc & 1 else crc >> 1
+    return bytes([crc & 0xFF, crc >> 8])
+
+
+def firmware_version():
+    path = os.path.join(HERE, '..', 'board', 'user', 'tasks', 'firmware_version.h')
+    text = open(path, encoding='utf-8', errors='replace').read()
+    code = []
+    for name in ('MAJOR', 'MINOR', 'REVISION'):
+        m = re.search(r'FIRMWARE_VERSION_%s_CODE\s+(\d+)' % name, text)
+        code.append(int(m.group(1)))
+    return code
+
+
+class Sim:
+    """one simulator process with its state directory"""
+
+    def __init__(self, exe, state_dir):
+        self.exe = exe
+        self.dir = state_dir
+        self.proc = None
+        self.fd = -1
+        self.log = None
+        self.inputs = {}
+
+    def start(self, console=False):
+        """console: keep stdin open for debug task commands, see command()"""
+        env = dict(os.environ, IW_SIM_DIR=self.dir)
+        ports = os.path.join(self.dir, 'ports')
+        if os.path.exists(ports):
+            os.unlink(ports)
+        self.log = open(os.path.join(self.dir, 'console.log'), 'ab')
+        self.proc = subprocess.Popen([self.exe], env=env,
+                                     stdin=subprocess.PIPE if console else subprocess.DEVNULL,
+                                     stdout=self.log, stderr=subprocess.STDOUT)
+        deadline = time.time() + BOOT_TIMEOUT
+        while time.time() < deadline:
+            if self.proc.poll() is not None:
+                raise SimError('simulator exited with %d' % self.proc.returncode)
+            if self.port_name(0) is not None:
+                break
+            time.sleep(0.05)
+        else:
+            raise SimError('port 0 not up in %.0f s' % BOOT_TIMEOUT)
+        self.open_port(0)
+
+    def port_name(self, port):
+        try:
+            for line in open(os.path.join(self.dir, 'ports')):
+                fields = line.split()
+                if len(fields) == 2 and int(fields[0]) == port:
+                    return fields[1]
+        except (OSError, ValueError):
+            pass
+        return None
+
+    def open_port(self, port):
+        if self.fd >= 0:
+            os.close(self.fd)
+        self.fd = os.open(self.port_name(port), os.O_RDWR | os.O_NOCTTY | os.O_NONBLOCK)
+        tty.setraw(self.fd)
+        termios.tcflush(self.fd, termios.TCIOFLUSH)
+
+    def command(self, text):
+        """send one debug task command, the output goes to console.log"""
+        self.proc.stdin.write(text.encode() + b'\n')
+        self.proc.stdin.flush()
+
+    def console(self):
+        return open(os.path.join(self.dir, 'console.log'), 'rb').read()
+
+    def stop(self):
+        if self.fd >= 0:
+            os.close(self.fd)
+            self.fd = -1
+        if self.proc is not None and self.proc.stdin is not None:
+            self.proc.stdin.close()
+        if self.proc is not None and self.proc.poll() is None:
+            self.proc.send_signal(signal.SIGTERM)
+            try:
+                self.proc.wait(2)
+            except subprocess.TimeoutExpired:
+                self.proc.kill()
+                self.proc.wait()
+        self.proc = None
+        if self.log is not None:
+            self.log.close()
+            self.log = None
+
+    def set_input(self, **values):
+        self.inputs.update(values)
+        tmp = os.path.join(self.dir, 'inputs.tmp')
+        with open(tmp, 'w') as f:
+            for key, value in sorted(self.inputs.items()):
+                f.write('%s=%d\n' % (key, value))
+        os.rename(tmp, os.path.join(self.dir, 'inputs'))
+
+    def outputs(self):
+        result = {}
+        try:
+            for line in open(os.path.join(self.dir, 'outputs')):
+                key, _, value = line.strip().partition('=')
+                result[key] = int(value)
+        except OSError:
+            pass
+        return result
+
+    def request(self, code, data=b''):
+        """send one adu, return the data region of the response"""
+        adu = bytes([ADU_ADDR, code]) + bytes(data)
+        os.write(self.fd, adu + crc16(adu))
+        rsp = b''
+        deadline = time.time() + RSP_TIMEOUT
+        while time.time() < deadline:
+            wait = FRAME_GAP if rsp else deadline - time.time()
+            r, _, _ = select.select([self.fd], [], [], max(wait, 0))
+            if not r:
+                if rsp:
+                    break
+                continue
+            try:
+                rsp += os.read(self.fd, 256)
+            except BlockingIOError:
+                pass
+        if len(rsp) < 4:
+            raise SimError('code 0x%02x: no response (%r)' % (code, rsp))
+        if crc16(rsp[:-2]) != rsp[-2:]:
+            raise SimError('code 0x%02x: crc err in %s' % (code, rsp.hex()))
+        if rsp[0] != ADU_ADDR or rsp[1] != code:
+            raise SimError('code 0x%02x: bad header in %s' % (code, rsp.hex()))
+        return rsp[2:-2]
+
+
+def check(results, name, ok, detail):
+    results.append((name, ok, detail))
+
+
+def run(exe, keep):
+    results = []
+    state_dir = tempfile.mkdtemp(prefix='iw_sim_')
+    sim = Sim(exe, state_dir)
+    try:
+        sim.start()
+        console = open(os.path.join(state_dir, 'console.log'), 'rb').read()
+        check(results, 'first boot', console.count(b'firmware version') >= 2,
+              'init env written, %d boots' % console.count(b'firmware version'))
+
+        data = sim.request(CODE_QUERY_SOFTWARE_VER)
+        want = firmware_version()
+        check(results, 'version', list(data) == want,
+              'got %s want %s' % ('.'.join(map(str, data)), '.'.join(map(str, want))))
+
+        data = sim.request(CODE_QUERY_DOOR_STATUS)
+        check(results, 'door close', data == bytes([DATA_STATUS_DOOR_CLOSE]), data.hex())
+        sim.set_input(door=DOOR_OPEN_LEVEL)
+        time.sleep(INPUT_SETTLE)
+        data = sim.request(CODE_QUERY_DOOR_STATUS)
+        check(results, 'door open', data == bytes([DATA_STATUS_DOOR_OPEN]), data.hex())
+        sim.set_input(door=1 - DOOR_OPEN_LEVEL)
+        time.sleep(INPUT_SETTLE)
+
+        data = sim.request(CODE_QUERY_TEMPERATURE)
+        temperature = data[1] - 256 if len(data) == 2 and data[1] > 127 else (data[1] if len(data) == 2 else None)
+        check(results, 'temperature', temperature is not None and -20 <= temperature <= 50,
+              'setting %d temperature %s' % (data[0], temperature) if len(data) == 2 else data.hex())
+        sim.stop()
+
+        sim.start()
+        console = open(os.path.join(state_dir, 'console.log'), 'rb').read()
+        data = sim.request(CODE_QUERY_SOFTWARE_VER)
+        check(results, 'restart', console.count(b'first boot') == 1 and list(data) == want,
+              'state kept, %d first boots' % console.count(b'first boot'))
+    except SimError as e:
+        check(results, 'simulator', False, str(e))
+    finally:
+        sim.stop()
+
+    print('%-12s %-6s %s' % ('check', 'result', 'detail'))
+    for name, ok, detail in results:
+        print('%-12s %-6s %s' % (name, 'ok' if ok else 'FAIL', detail))
+    failed = [r for r in results if not r[1]]
+    if failed or keep:
+        print('state dir: %s' % state_dir)
+    else:
+        for name in os.listdir(state_dir):
+            path = os.path.join(state_dir, name)
+            if os.path.islink(path) or os.path.isfile(path):
+                os.unlink(path)
+        os.rmdir(state_dir)
+    return 1 if failed else 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument('exe', nargs='?', default=os.path.join(HERE, '..', '_gate_build', 'iw_controller_sim'))
+    parser.add_argument('--keep', action='store_true', help='keep the state directory')
+    args = parser.parse_args()
+    if not os.path.exists(args.exe):
+        print('no simulator at %s, build it with cmake first' % args.exe)
+        return 1
+    return run(os.path.abspath(args.exe), args.keep)
+
+
+if __name__ == '__main__':
+    sys.exit(main())
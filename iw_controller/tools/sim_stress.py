@@ -0,0 +1,319 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+stress test of the host link deadline on the linux simulation build.
+
+loads every serial port of iw_controller_sim at once and checks that the
+host link still answers inside the deadline model of tasks_init.h:
+
+    host port 0    requests back to back, a mix of net weight (all scales,
+                   fans out to the scale tasks), door, lock, temperature,
+                   probe, compressor stats and version
+    scale ports    one emulated scale on each of ports 1, 3, 5 and 7
+    inputs         door toggled every DOOR_TOGGLE s (pint -> lock task ->
+                   control thread)
+    console        debug commands (stats, pool, ao) on the low priority
+                   debug thread
+
+two phases run one after the other:
+
+    nominal        scales answer after SCALE_FAST ms
+    worst          scales answer just inside the 35 ms scale poll timeout,
+                   one scale is silent (scale task times out) and one
+                   sends noise before its answer
+
+pass: every request is answered with a valid frame inside its deadline
+(communication_task_deadline_limit plus the frame gap), and the worst
+response of the firmware deadline counters ("deadline" debug command) for
+the communication, scale and control jobs is inside its limit.  both allow
+SLACK ms of host scheduling jitter; the miss counts are printed.
+
+    python3 sim_stress.py [_gate_build/iw_controller_sim] [--seconds 4]
+"""
+import argparse
+import os
+import random
+import re
+import select
+import sys
+import tempfile
+import threading
+import time
+import tty
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from sim_smoke import Sim, SimError, crc16, ADU_ADDR, DOOR_OPEN_LEVEL  # noqa: E402
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+# communication_task.c codes and deadlines (communication_task_deadline_limit,
+# subsystem timeout + ADU_FRAME_TIMEOUT + ADU_SEND_TIMEOUT) in ms
+ADU_FRAME_TIMEOUT = 3
+ADU_SEND_TIMEOUT = 5
+REQUESTS = [
+    # name           code  data      subsystem timeout
+    ('net weight',   0x03, b'\x00',  40),
+    ('door',         0x11, b'',      40),
+    ('lock',         0x23, b'',      40),
+    ('temperature',  0x41, b'',      20 + 20),
+    ('probe',        0x42, b'',      20),
+    ('compressor',   0x43, b'',      20),
+    ('version',      0x52, b'',      0),
+]
+
+SCALE_PORTS = (1, 3, 5, 7)   # get_serial_port_by_addr, scale addr 1..4
+SCALE_FAST = 2               # ms
+SCALE_SLOW = 30              # ms, ADU_QUERY_WEIGHT_TIMEOUT of scale_task.c is 35
+# ms, the simulator shares the cpu with this script and the pseudo terminals,
+# so wall clock response times pick up scheduling jitter on top of the model
+SLACK = 10
+DOOR_TOGGLE = 0.2            # s
+DEBUG_TASK_INTERVAL = 0.2    # s, debug task reads one command per poll
+CONSOLE_INTERVAL = 2 * DEBUG_TASK_INTERVAL
+CONSOLE_COMMANDS = ('stats', 'pool', 'ao')
+RSP_GAP = 0.004              # s without bytes after a frame with a valid crc
+
+
+def scale_crc(data):
+    """scale_task.c adu_add_crc16 sends the modbus crc high byte first"""
+    return crc16(data)[::-1]
+
+
+class Scale(threading.Thread):
+    """one scale on a pseudo terminal, answers scale_task.c adus"""
+
+    def __init__(self, sim, port, weight):
+        super().__init__(daemon=True)
+        self.sim = sim
+        self.port = port
+        self.weight = weight
+        self.delay = SCALE_FAST / 1000.0
+        self.silent = False
+        self.noise = False
+        self.polls = 0
+        self.running = True
+        self.fd = os.open(sim.port_name(port), os.O_RDWR | os.O_NOCTTY | os.O_NONBLOCK)
+        tty.setraw(self.fd)
+
+    def run(self):
+        buf = b''
+        while self.running:
+            r, _, _ = select.select([self.fd], [], [], 0.05)
+            if not r:
+                continue
+            try:
+                buf += os.read(self.fd, 64)
+            except (BlockingIOError, OSError):
+                continue
+            while True:
+                start = buf.find(b'ML')
+                if start < 0:
+                    buf = buf[-1:]
+                    break
+                buf = buf[start:]
+                if len(buf) < 3 or len(buf) < 3 + buf[2] + 2:
+                    break
+                size = 3 + buf[2] + 2
+                frame, buf = buf[:size], buf[size:]
+                if scale_crc(frame[:-2]) != frame[-2:]:
+                    continue
+                self.answer(frame[3], frame[4])
+
+    def answer(self, addr, code):
+        self.polls += 1
+        if self.silent:
+            return
+        time.sleep(self.delay)
+        if code == 0:
+            value = bytes([self.weight & 0xFF, (self.weight >> 8) & 0xFF])
+        else:
+            value = b'\x00'
+        pdu = bytes([addr, code]) + value
+        adu = b'ML' + bytes([len(pdu)]) + pdu
+        out = adu + scale_crc(adu)
+        if self.noise:
+            out = bytes(random.randrange(256) for _ in range(5)).replace(b'M', b'm') + out
+        os.write(self.fd, out)
+
+    def stop(self):
+        self.running = False
+        self.join(1)
+        os.close(self.fd)
+
+
+def request(sim, code, data, timeout):
+    """send one adu, return (latency ms, data region) or (None, reason)"""
+    adu = bytes([ADU_ADDR, code]) + data
+    os.write(sim.fd, adu + crc16(adu))
+    sent = time.monotonic()
+    rsp = b''
+    done = None
+    deadline = sent + timeout
+    while time.monotonic() < deadline:
+        r, _, _ = select.select([sim.fd], [], [], RSP_GAP if done else max(deadline - time.monotonic(), 0))
+        if not r:
+            if done is not None:
+                break
+            continue
+        try:
+            rsp += os.read(sim.fd, 512)
+        except BlockingIOError:
+            continue
+        if len(rsp) >= 4 and crc16(rsp[:-2]) == rsp[-2:]:
+            done = time.monotonic()
+        else:
+            done = None
+    if done is None:
+        return None, 'no valid response (%s)' % rsp.hex()
+    if rsp[0] != ADU_ADDR or rsp[1] != code:
+        return None, 'bad header %s' % rsp.hex()
+    return (done - sent) * 1000.0, rsp[2:-2]
+
+
+class Phase:
+    def __init__(self, name):
+        self.name = name
+        self.latency = {r[0]: [] for r in REQUESTS}
+        self.errors = []
+        self.polls = []
+
+    def worst(self, name):
+        return max(self.latency[name]) if self.latency[name] else 0.0
+
+
+def load(sim, phase, seconds):
+    """host requests back to back, door toggles and console commands"""
+    end = time.monotonic() + seconds
+    next_door = time.monotonic()
+    next_console = time.monotonic()
+    door = 1 - DOOR_OPEN_LEVEL
+    i = 0
+    while time.monotonic() < end:
+        now = time.monotonic()
+        if now >= next_door:
+            door = 1 - door
+            sim.set_input(door=door)
+            next_door = now + DOOR_TOGGLE
+        if now >= next_console:
+            sim.command(CONSOLE_COMMANDS[i % len(CONSOLE_COMMANDS)])
+            next_console = now + CONSOLE_INTERVAL
+        name, code, data, timeout = REQUESTS[i % len(REQUESTS)]
+        limit = timeout + ADU_FRAME_TIMEOUT * 2 + ADU_SEND_TIMEOUT + SLACK
+        latency, result = request(sim, code, data, 1.0)
+        if latency is None:
+            phase.errors.append('%s: %s' % (name, result))
+        else:
+            phase.latency[name].append(latency)
+            if latency > limit:
+                phase.errors.append('%s: %.1f ms > %d ms' % (name, latency, limit))
+        i += 1
+    sim.set_input(door=1 - DOOR_OPEN_LEVEL)
+
+
+def deadlines(sim):
+    """firmware counters, {name: (cnt, miss, worst us, limit us)}"""
+    time.sleep(CONSOLE_INTERVAL)
+    mark = len(sim.console())
+    sim.command('deadline')
+    pattern = re.compile(rb'deadline:(\w+) cnt:(\d+) miss:(\d+) worst:(\d+)us/(\d+)us')
+    end = time.time() + 2.0
+    result = {}
+    while time.time() < end and len(result) < 3:
+        time.sleep(0.1)
+        for m in pattern.finditer(sim.console()[mark:]):
+            result[m.group(1).decode()] = tuple(int(v) for v in m.groups()[1:])
+    return result
+
+
+def run(exe, seconds, keep):
+    state_dir = tempfile.mkdtemp(prefix='iw_stress_')
+    sim = Sim(exe, state_dir)
+    scales = []
+    phases = []
+    counters = []
+    failed = False
+    try:
+        sim.start(console=True)
+        end = time.time() + 2.0
+        while any(sim.port_name(port) is None for port in SCALE_PORTS):
+            if time.time() > end:
+                raise SimError('scale ports not up')
+            time.sleep(0.05)
+        scales = [Scale(sim, port, 100 * (n + 1)) for n, port in enumerate(SCALE_PORTS)]
+        for scale in scales:
+            scale.start()
+
+        for name in ('nominal', 'worst'):
+            if name == 'worst':
+                for scale in scales:
+                    scale.delay = SCALE_SLOW / 1000.0
+                scales[1].silent = True
+                scales[2].noise = True
+            sim.command('deadline reset')
+            time.sleep(CONSOLE_INTERVAL)
+            polls = [scale.polls for scale in scales]
+            phase = Phase(name)
+            load(sim, phase, seconds)
+            phase.polls = [scale.polls - n for scale, n in zip(scales, polls)]
+            phases.append(phase)
+            counters.append(deadlines(sim))
+    except SimError as e:
+        print('simulator: %s' % e)
+        failed = True
+    finally:
+        for scale in scales:
+            scale.stop()
+        sim.stop()
+
+    for phase, counter in zip(phases, counters):
+        print('phase %s, scale polls %s' % (phase.name, ' '.join(str(n) for n in phase.polls)))
+        print('  %-12s %6s %10s %10s' % ('request', 'cnt', 'mean ms', 'worst ms'))
+        for name, _, _, _ in REQUESTS:
+            values = phase.latency[name]
+            mean = sum(values) / len(values) if values else 0.0
+            print('  %-12s %6d %10.1f %10.1f' % (name, len(values), mean, phase.worst(name)))
+        print('  %-28s %6s %6s %12s %12s' % ('deadline', 'cnt', 'miss', 'worst us', 'limit us'))
+        for name in sorted(counter):
+            cnt, miss, worst, limit = counter[name]
+            print('  %-28s %6d %6d %12d %12d' % (name, cnt, miss, worst, limit))
+            if worst > limit + SLACK * 1000:
+                phase.errors.append('%s: worst %d us > %d us' % (name, worst, limit + SLACK * 1000))
+        if len(counter) < 3:
+            phase.errors.append('deadline dump incomplete: %s' % ', '.join(sorted(counter)))
+        if sum(len(v) for v in phase.latency.values()) == 0:
+            phase.errors.append('no request answered')
+        for error in phase.errors[:10]:
+            print('  FAIL %s' % error)
+        if len(phase.errors) > 10:
+            print('  FAIL ... %d more' % (len(phase.errors) - 10))
+        failed = failed or bool(phase.errors)
+    if len(phases) != 2:
+        failed = True
+
+    if failed or keep:
+        print('state dir: %s' % state_dir)
+    else:
+        for name in os.listdir(state_dir):
+            path = os.path.join(state_dir, name)
+            if os.path.islink(path) or os.path.isfile(path):
+                os.unlink(path)
+        os.rmdir(state_dir)
+    print('result: %s' % ('FAIL' if failed else 'ok'))
+    return 1 if failed else 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument('exe', nargs='?', default=os.path.join(HERE, '..', '_gate_build', 'iw_controller_sim'))
+    parser.add_argument('--seconds', type=float, default=4.0, help='load time of each phase')
+    parser.add_argument('--keep', action='store_true', help='keep the state directory')
+    args = parser.parse_args()
+    if not os.path.exists(args.exe):
+        print('no simulator at %s, build it with cmake first' % args.exe)
+        return 1
+    random.seed(1)
+    return run(os.path.abspath(args.exe), args.seconds, args.keep)
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+equivalence and speed test of the ntc lookup table.
+
+builds the firmware lookup (tasks/temperature_table.c with the generated
+temperature_table_ntc.c) for the host together with the float conversion
+it replaced (temperature_table_test/bench.c) and runs every adc code
+through both:
+
+    reject     both paths must flag the same codes as shorted, open or
+               outside the r/t map
+    accuracy   elsewhere the table may differ from the float path by at
+               most --tolerance C
+
+then it times both over the valid adc range. the float path is all
+hardware double on the host; on the cortex-m4f the double math of get_r
+and calcaulate_float_t is a software library, so the target gains more
+than the host ratio shows. a sanitizer build repeats the equivalence run.
+
+    python3 temperature_table_test.py [--tolerance 0.05] [--repeat 200]
+"""
+import argparse
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from lzss_test import sanitizer_flags  # noqa: E402
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+TASKS = os.path.join(HERE, '..', 'board', 'user', 'tasks')
+
+
+def adc_err_limits():
+    """ADC_ERR_MAX/MIN of temperature_task.h"""
+    text = open(os.path.join(TASKS, 'temperature_task.h'), encoding='utf-8', errors='replace').read()
+    return ['-D%s=%s' % (name, re.search(r'define\s+%s\s+(\d+)' % name, text).group(1))
+            for name in ('ADC_ERR_MAX', 'ADC_ERR_MIN')]
+
+
+def build(out_dir, name, flags):
+    exe = os.path.join(out_dir, name)
+    cmd = ['gcc', '-std=gnu99', '-funsigned-char', '-Wall'] + flags + adc_err_limits() + [
+        '-I', TASKS,
+        os.path.join(HERE, 'temperature_table_test', 'bench.c'),
+        os.path.join(TASKS, 'temperature_table.c'),
+        os.path.join(TASKS, 'temperature_table_ntc.c'),
+        '-lm', '-o', exe]
+    subprocess.check_call(cmd)
+    return exe
+
+
+def run(exe, repeat):
+    out = subprocess.run([exe, str(repeat)], stdout=subprocess.PIPE, check=True,
+                         universal_newlines=True).stdout
+    result = {}
+    for line in out.splitlines():
+        fields = line.split()
+        if fields and fields[0] in ('equal', 'speed'):
+            result[fields[0]] = [float(v) for v in fields[1:]]
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument('--tolerance', type=float, default=0.05, help='max difference in C')
+    parser.add_argument('--repeat', type=int, default=200, help='sweeps of the valid range for the speed')
+    args = parser.parse_args()
+
+    failed = False
+    with tempfile.TemporaryDirectory() as out_dir:
+        builds = [('-O2', build(out_dir, 'bench', ['-O2']), args.repeat),
+                  ('sanitizer', build(out_dir, 'bench_san', sanitizer_flags()), 0)]
+        print('%-10s %6s %6s %8s %10s %6s' % ('build', 'codes', 'valid', 'mismatch', 'worst C', 'adc'))
+        speed = None
+        for name, exe, repeat in builds:
+            result = run(exe, repeat)
+            codes, valid, mismatch, worst, worst_adc = result['equal']
+            worst /= 10000.0
+            ok = mismatch == 0 and worst <= args.tolerance and valid > 0
+            failed = failed or not ok
+            print('%-10s %6d %6d %8d %10.4f %6d %s' % (name, codes, valid, mismatch, worst, worst_adc,
+                                                      'ok' if ok else 'FAIL'))
+            if 'speed' in result:
+                speed = result['speed']
+
+    if speed is None:
+        print('no speed result')
+        return 1
+    table_ns, float_ns, table_tsc, float_tsc = speed
+    print('%-10s %12s %12s' % ('path', 'ns/conv', 'cycles/conv'))
+    print('%-10s %12.2f %12.1f' % ('table', table_ns, table_tsc))
+    print('%-10s %12.2f %12.1f' % ('float', float_ns, float_tsc))
+    print('speedup %.1fx' % (float_ns / table_ns if table_ns > 0 else 0.0))
+    if table_ns >= float_ns:
+        print('FAIL table lookup is not faster than the float path')
+        failed = True
+    print('result: %s' % ('FAIL' if failed else 'ok'))
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,220 @@
+/*
+ * host build of the ntc table lookup (tasks/temperature_table.c with the
+ * generated temperature_table_ntc.c) for temperature_table_test.py.
+ *
+ * float_path() is the conversion the table replaced, kept verbatim from
+ * the old temperature_task.c (get_r, binary search over t_r_map,
+ * calcaulate_float_t) including its double constants. table_path() is
+ * temperature_get_by_adc() without the log and compensation.
+ *
+ * every adc code 0..4095 goes through both paths: they must reject the
+ * same codes and differ by at most the tolerance elsewhere. then both
+ * paths convert a sweep of adc codes <repeat> times for the speed.
+ *
+ * usage: bench <repeat>
+ * prints "equal <codes> <valid> <mismatch> <worst 0.0001C> <worst adc>"
+ * and "speed <table ns> <float ns> <table cycles> <float cycles>"; the
+ * cycles are host time stamp counter ticks, 0 where there is none.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define  BENCH_TSC()                   __rdtsc()
+#else
+#define  BENCH_TSC()                   0
+#endif
+#include "temperature_table.h"
+
+/*passed in from temperature_task.h*/
+#ifndef  ADC_ERR_MAX
+#error "ADC_ERR_MAX"
+#endif
+#ifndef  ADC_ERR_MIN
+#error "ADC_ERR_MIN"
+#endif
+
+#define  BENCH_ADC_CODES               4096
+
+/*old temperature_task.h*/
+#define  TEMPERATURE_SENSOR_ADC_VALUE_MAX          4096
+#define  TEMPERATURE_SENSOR_BYPASS_RES_VALUE       5100
+#define  TEMPERATURE_SENSOR_REFERENCE_VOLTAGE      3.30
+#define  TEMPERATURE_SENSOR_SUPPLY_VOLTAGE         3.30
+#define  TEMPERATURE_COMPENSATION_VALUE            0.0
+#define  TEMPERATURE_ERR_VALUE                     127.0
+
+static int16_t const t_r_map[][2]={
+  {-22,21180},{-21,20010},{-20,18900},{-19,17870},{-18,16900},{-17,15980},{-16,15120},{-15,14310},{-14,13550},{-13,12830},
+  {-12,12160},{-11,11520},{-10,10920},{-9,10350} ,{-8,9820}  ,{-7,9316}  ,{-6,8841}  ,{-5,8392}  ,{-4,7968}  ,{-3 ,7568},
+  {-2 ,7190} ,{-1,6833}  ,{0,6495}   ,{1,6175 }  ,{2,5873 }  ,{3,5587 }  ,{4,5315}   ,{5,5060}   ,{6,4818}   ,{7,4589}  ,
+  {8,4372}   ,{9,4167}   ,{10,3972}  ,{11,3788}  ,{12,3613}  ,{13,3447}  ,{14,3290}  ,{15,3141}  ,{16,2999}  ,{17,2865} ,
+  {18,2737}  ,{19,2616}  ,{20,2501}  ,{21,2391}  ,{22,2287}  ,{23,2188}  ,{24,2094}  ,{25,2005}  ,{26,1919}  ,{27,1838} ,
+  {28,1761}  ,{29,1687}  ,{30,1617}  ,{31,1550}  ,{32,1486}  ,{33,1426}  ,{34,1368}  ,{35,1312}  ,{36,1259}  ,{37,1209} ,
+  {38,1161}  ,{39,1115}  ,{40,1071}  ,{41,1029}  ,{42,989}   ,{43,951}   ,{44,914}   ,{45,879}   ,{46,845}   ,{47,813}  ,
+  {48,783}   ,{49,753}   ,{50,725}   ,{51,698}   ,{52,672}   ,{53,647}   ,{54,624}   ,{55,601}   ,{56,579}   ,{57,559}  ,
+  {58,539}   ,{59,520}   ,{60,502}   ,{61,484}   ,{62,467}   ,{63,451}   ,{64,435}   ,{65,421}   ,{66,406}   ,{67,392}
+};
+
+#define  TR_MAP_IDX_MIN        2
+#define  TR_MAP_IDX_MAX        82
+
+static uint32_t get_r(const uint16_t adc)
+{
+    float t_sensor_r;
+    t_sensor_r = (TEMPERATURE_SENSOR_SUPPLY_VOLTAGE * TEMPERATURE_SENSOR_ADC_VALUE_MAX * TEMPERATURE_SENSOR_BYPASS_RES_VALUE)/(adc * TEMPERATURE_SENSOR_REFERENCE_VOLTAGE)-TEMPERATURE_SENSOR_BYPASS_RES_VALUE;
+    return (uint32_t)t_sensor_r;
+}
+
+static float calcaulate_float_t(uint32_t r,uint8_t idx)
+{
+    uint32_t r1,r2;
+
+    float t;
+
+    r1 = t_r_map[idx][1];
+    r2 = t_r_map[idx + 1][1];
+
+    t = t_r_map[idx][0] + (r1 - r) * 1.0 /(r1 - r2) + TEMPERATURE_COMPENSATION_VALUE;
+
+    return t;
+}
+
+static float float_path(uint16_t adc)
+{
+    uint32_t r;
+    uint8_t mid;
+    int low = TR_MAP_IDX_MIN;
+    int high =TR_MAP_IDX_MAX;
+
+    if (adc >= ADC_ERR_MAX ||
+        adc <= ADC_ERR_MIN ){
+        return TEMPERATURE_ERR_VALUE;
+    }
+
+    r = get_r(adc);
+
+    if (r <= t_r_map[TR_MAP_IDX_MAX][1]){
+        return TEMPERATURE_ERR_VALUE;
+    }else if (r >= t_r_map[TR_MAP_IDX_MIN][1]){
+        return TEMPERATURE_ERR_VALUE;
+    }
+
+    while (low <= high) {
+        mid = (low + high) / 2;
+        if (r > t_r_map[mid][1]) {
+            if (r <= t_r_map[mid-1][1]){
+                return calcaulate_float_t(r, mid - 1);
+            } else {
+                high = mid - 1;
+            }
+        } else {
+            if (r > t_r_map[mid+1][1]) {
+                return calcaulate_float_t(r, mid);
+            } else {
+                low = mid + 1;
+            }
+        }
+    }
+
+    return TEMPERATURE_ERR_VALUE;
+}
+
+static int table_path(uint16_t adc,int16_t *t)
+{
+    if (adc >= ADC_ERR_MAX || adc <= ADC_ERR_MIN) {
+        return -1;
+    }
+    return temperature_table_lookup(&temperature_table_ntc,adc,t);
+}
+
+static uint64_t bench_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*keeps the compiler from dropping the conversions*/
+static volatile int32_t bench_sink;
+
+int main(int argc,char *argv[])
+{
+    int repeat;
+    uint32_t valid = 0,mismatch = 0;
+    uint16_t worst_adc = 0;
+    double worst = 0.0,err;
+    float t_float;
+    int16_t t;
+    int rc;
+    int32_t sum;
+    uint64_t start_ns,start_tsc,table_ns,float_ns,table_tsc,float_tsc;
+    uint32_t conversions;
+
+    if (argc != 2) {
+        fprintf(stderr,"usage: bench <repeat>\n");
+        return 2;
+    }
+    repeat = atoi(argv[1]);
+
+    for (uint32_t adc = 0;adc < BENCH_ADC_CODES;adc ++) {
+        t_float = float_path(adc);
+        rc = table_path(adc,&t);
+        if ((t_float == TEMPERATURE_ERR_VALUE) != (rc != 0)) {
+            if (mismatch ++ < 10) {
+                fprintf(stderr,"adc:%u float:%.4f table rc:%d\n",adc,t_float,rc);
+            }
+            continue;
+        }
+        if (rc != 0) {
+            continue;
+        }
+        valid ++;
+        err = fabs(t / 100.0 - t_float);
+        if (err > worst) {
+            worst = err;
+            worst_adc = adc;
+        }
+    }
+    printf("equal %u %u %u %ld %u\n",BENCH_ADC_CODES,valid,mismatch,lround(worst * 10000.0),worst_adc);
+
+    if (repeat <= 0) {
+        return 0;
+    }
+    /*the valid range, where both paths do their full work*/
+    conversions = (uint32_t)repeat * (temperature_table_ntc.adc_max - temperature_table_ntc.adc_min + 1);
+
+    sum = 0;
+    start_ns = bench_ns();
+    start_tsc = BENCH_TSC();
+    for (int i = 0;i < repeat;i ++) {
+        for (uint32_t adc = temperature_table_ntc.adc_min;adc <= temperature_table_ntc.adc_max;adc ++) {
+            table_path(adc,&t);
+            sum += t;
+        }
+    }
+    table_tsc = BENCH_TSC() - start_tsc;
+    table_ns = bench_ns() - start_ns;
+    bench_sink = sum;
+
+    sum = 0;
+    start_ns = bench_ns();
+    start_tsc = BENCH_TSC();
+    for (int i = 0;i < repeat;i ++) {
+        for (uint32_t adc = temperature_table_ntc.adc_min;adc <= temperature_table_ntc.adc_max;adc ++) {
+            sum += (int32_t)(float_path(adc) * 100.0f);
+        }
+    }
+    float_tsc = BENCH_TSC() - start_tsc;
+    float_ns = bench_ns() - start_ns;
+    bench_sink = sum;
+
+    printf("speed %.2f %.2f %.1f %.1f\n",
+           (double)table_ns / conversions,(double)float_ns / conversions,
+           (double)table_tsc / conversions,(double)float_tsc / conversions);
+    return 0;
+}
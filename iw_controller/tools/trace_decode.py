@@ -0,0 +1,173 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+decode an iw_controller event trace dump into chrome trace / perfetto json.
+
+the dump is produced by the "trace dump" debug command (see
+board/user/debug/trace/trace.c) and captured from the rtt log, e.g.
+
+    JLinkRTTLogger ... rtt.log
+    python3 trace_decode.py rtt.log -o trace.json
+
+open trace.json in chrome://tracing or https://ui.perfetto.dev.
+every slice carries its cost in cpu cycles in args.cycles.
+"""
+import argparse
+import json
+import re
+import struct
+import sys
+
+EVENT_TASK_SWITCHED_IN = 0x01
+EVENT_TASK_SWITCHED_OUT = 0x02
+EVENT_QUEUE_SEND = 0x03
+EVENT_QUEUE_SEND_FROM_ISR = 0x04
+EVENT_QUEUE_RECEIVE = 0x05
+EVENT_QUEUE_BLOCK = 0x06
+EVENT_ISR_ENTER = 0x07
+EVENT_ISR_EXIT = 0x08
+EVENT_USER = 0x10
+
+QUEUE_EVENT_NAMES = {
+    EVENT_QUEUE_SEND: "queue send",
+    EVENT_QUEUE_SEND_FROM_ISR: "queue send from isr",
+    EVENT_QUEUE_RECEIVE: "queue receive",
+    EVENT_QUEUE_BLOCK: "queue block",
+}
+
+USER_EVENT_NAMES = {
+    0x01: "host adu recv",
+    0x02: "host adu parsed",
+    0x03: "host adu sent",
+    0x04: "scale req",
+    0x05: "scale rsp",
+    0x06: "scale timeout",
+}
+
+RECORD = struct.Struct("<IBBH")
+ISR_TID_BASE = 1000
+PID = 1
+
+HDR_RE = re.compile(r"trace hdr freq:(\d+) cnt:(\d+) lost:(\d+)")
+TASK_RE = re.compile(r"trace task (\d+) (\S+)")
+REC_RE = re.compile(r"trace rec ([0-9a-f]+)")
+
+
+def parse_dump(lines):
+    freq = None
+    tasks = {}
+    records = []
+    lost = 0
+    for line in lines:
+        m = HDR_RE.search(line)
+        if m:
+            freq = int(m.group(1))
+            lost = int(m.group(3))
+            tasks = {}
+            records = []
+            continue
+        m = TASK_RE.search(line)
+        if m:
+            tasks[int(m.group(1))] = m.group(2)
+            continue
+        m = REC_RE.search(line)
+        if m:
+            raw = bytes.fromhex(m.group(1))
+            for off in range(0, len(raw) - RECORD.size + 1, RECORD.size):
+                records.append(RECORD.unpack_from(raw, off))
+    if freq is None:
+        raise ValueError("no 'trace hdr' line found in dump")
+    return freq, tasks, records, lost
+
+
+def unwrap(records):
+    """dwt cyccnt is 32 bit; consecutive records are far less than one wrap apart."""
+    out = []
+    base = 0
+    prev = None
+    for cycle, etype, eid, arg in records:
+        if prev is not None and cycle < prev:
+            base += 1 << 32
+        prev = cycle
+        out.append((base + cycle, etype, eid, arg))
+    return out
+
+
+def to_chrome(freq, tasks, records, lost):
+    events = []
+    us_per_cycle = 1e6 / freq
+
+    def ts(cycle):
+        return cycle * us_per_cycle
+
+    def task_name(number):
+        return tasks.get(number, "task %d" % number)
+
+    for number, name in tasks.items():
+        events.append({"ph": "M", "name": "thread_name", "pid": PID, "tid": number,
+                       "args": {"name": name}})
+    events.append({"ph": "M", "name": "process_name", "pid": PID,
+                   "args": {"name": "iw_controller"}})
+
+    records = unwrap(records)
+    if not records:
+        return {"traceEvents": events}
+    origin = records[0][0]
+
+    running = None      # (task number, start cycle)
+    isr_open = {}       # isr -> start cycle
+    for cycle, etype, eid, arg in records:
+        cycle -= origin
+        if etype == EVENT_TASK_SWITCHED_IN:
+            running = (eid, cycle)
+        elif etype == EVENT_TASK_SWITCHED_OUT:
+            if running is not None and running[0] == eid:
+                dur = cycle - running[1]
+                events.append({"ph": "X", "name": task_name(eid), "pid": PID, "tid": eid,
+                               "ts": ts(running[1]), "dur": ts(dur), "args": {"cycles": dur}})
+            running = None
+        elif etype == EVENT_ISR_ENTER:
+            isr_open[eid] = cycle
+        elif etype == EVENT_ISR_EXIT:
+            start = isr_open.pop(eid, None)
+            if start is not None:
+                dur = cycle - start
+                tid = ISR_TID_BASE + eid
+                events.append({"ph": "X", "name": "flexcomm%d isr" % eid, "pid": PID, "tid": tid,
+                               "ts": ts(start), "dur": ts(dur), "args": {"cycles": dur}})
+        elif etype in QUEUE_EVENT_NAMES:
+            tid = running[0] if running is not None else 0
+            events.append({"ph": "i", "s": "t", "name": QUEUE_EVENT_NAMES[etype], "pid": PID,
+                           "tid": tid, "ts": ts(cycle), "args": {"queue": "0x%04x" % arg}})
+        elif etype == EVENT_USER:
+            tid = running[0] if running is not None else 0
+            events.append({"ph": "i", "s": "t", "name": USER_EVENT_NAMES.get(eid, "user %d" % eid),
+                           "pid": PID, "tid": tid, "ts": ts(cycle), "args": {"arg": arg}})
+
+    for isr in sorted({e["tid"] for e in events if e.get("tid", 0) >= ISR_TID_BASE}):
+        events.append({"ph": "M", "name": "thread_name", "pid": PID, "tid": isr,
+                       "args": {"name": "flexcomm%d isr" % (isr - ISR_TID_BASE)}})
+
+    return {"traceEvents": events, "displayTimeUnit": "ns",
+            "otherData": {"cpu_freq": freq, "records": len(records), "lost": lost}}
+
+
+def main():
+    parser = argparse.ArgumentParser(description="decode iw_controller trace dump to chrome trace json")
+    parser.add_argument("dump", help="rtt log containing a 'trace dump' output, '-' for stdin")
+    parser.add_argument("-o", "--output", default="-", help="output json file, default stdout")
+    args = parser.parse_args()
+
+    src = sys.stdin if args.dump == "-" else open(args.dump, encoding="utf-8", errors="replace")
+    with src:
+        freq, tasks, records, lost = parse_dump(src)
+
+    trace = to_chrome(freq, tasks, records, lost)
+    dst = sys.stdout if args.output == "-" else open(args.output, "w", encoding="utf-8")
+    with dst:
+        json.dump(trace, dst)
+    sys.stderr.write("decoded %d records (%d lost before ring start)\n" % (len(records), lost))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,243 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+linux loopback test of the firmware update transfer.
+
+builds the firmware receiver (lib/fymodem.c + lib/md5.c) for the host
+with the stand-ins in ymodem_loopback/, runs it as a child process and
+connects ymodem_send.Sender to its stdin/stdout through an emulated
+serial link: 10 bit times per byte at the given baud rate, a one way
+latency (usb serial adapters, the board's task switch) and random bit
+errors in both directions. the receiver sleeps --page-us per 256 byte
+flash page like the IAP program in process_update() and --md5-us per KB
+hashed.
+
+the modes are
+
+    baseline  the pipeline before the streaming update: classic sender,
+              whole update area erased, every packet programmed before
+              its ACK, then a second md5 pass over the image
+    classic   classic sender, streaming receiver (ACK, then md5 and
+              program while the next packet arrives)
+    window    windowed sender, streaming receiver
+
+for every baud rate, bit error rate and mode it reports the time, the
+throughput and how close it gets to the line rate, and checks the md5
+of what arrived. the times include the md5 after the transfer:
+
+    python3 ymodem_loopback.py
+    python3 ymodem_loopback.py --baud 115200 --ber 0 1e-5 --size 98304
+    python3 ymodem_loopback.py --mode baseline classic --ber 0 --size 98304
+
+baseline and classic runs pay one packet timeout (1 s) for the window
+offer before falling back, the data column leaves that out.
+"""
+import argparse
+import hashlib
+import os
+import queue
+import random
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from ymodem_send import Sender, SendError  # noqa: E402
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+LIB = os.path.join(HERE, '..', 'board', 'user', 'lib')
+MODES = ['baseline', 'classic', 'window']
+
+
+def build(out_dir):
+    rx = os.path.join(out_dir, 'rx')
+    cmd = ['gcc', '-std=gnu99', '-O2', '-funsigned-char',
+           '-I', os.path.join(HERE, 'ymodem_loopback'), '-I', LIB,
+           os.path.join(HERE, 'ymodem_loopback', 'rx.c'),
+           os.path.join(LIB, 'fymodem.c'), os.path.join(LIB, 'md5.c'),
+           '-o', rx]
+    subprocess.check_call(cmd)
+    return rx
+
+
+class Wire(threading.Thread):
+    """one direction of the link: paces bytes at baud/10, delays them by
+    the latency and flips bits with the bit error rate"""
+
+    SLICE = 16
+
+    def __init__(self, deliver, baud, latency, ber, rng):
+        threading.Thread.__init__(self, daemon=True)
+        self.q = queue.Queue()
+        self.deliver = deliver
+        self.byte_time = 10.0 / baud
+        self.latency = latency
+        self.p_byte = 1.0 - (1.0 - ber) ** 8
+        self.rng = rng
+        self.free = 0.0
+        self.errors = 0
+
+    def put(self, data):
+        self.q.put((time.monotonic(), bytes(data)))
+
+    def corrupt(self, data):
+        if self.p_byte == 0:
+            return data
+        out = bytearray(data)
+        for i in range(len(out)):
+            if self.rng.random() < self.p_byte:
+                out[i] ^= 1 << self.rng.randrange(8)
+                self.errors += 1
+        return bytes(out)
+
+    def run(self):
+        while True:
+            t, data = self.q.get()
+            if data is None:
+                return
+            # the line is busy until the previous chunk is out
+            self.free = max(self.free, t)
+            for i in range(0, len(data), self.SLICE):
+                part = data[i:i + self.SLICE]
+                self.free += len(part) * self.byte_time
+                wait = self.free + self.latency - time.monotonic()
+                if wait > 0:
+                    time.sleep(wait)
+                if not self.deliver(self.corrupt(part)):
+                    return
+
+
+class LinkPort(object):
+    """sender side of the link, pyserial like read/write/timeout"""
+
+    def __init__(self, wire):
+        self.wire = wire
+        self.timeout = 1.0
+        self.buf = bytearray()
+        self.cond = threading.Condition()
+
+    def write(self, data):
+        self.wire.put(data)
+        return len(data)
+
+    def feed(self, data):
+        with self.cond:
+            self.buf += data
+            self.cond.notify()
+        return True
+
+    def read(self, n):
+        end = time.monotonic() + self.timeout
+        with self.cond:
+            while not self.buf:
+                left = end - time.monotonic()
+                if left <= 0:
+                    return b''
+                self.cond.wait(left)
+            out = bytes(self.buf[:n])
+            del self.buf[:n]
+            return out
+
+
+def run_once(rx, data, baud, ber, mode, args, seed):
+    rng = random.Random(seed)
+    image = tempfile.NamedTemporaryFile(delete=False)
+    image.close()
+    proc = subprocess.Popen([rx, image.name, str(args.page_us), str(args.md5_us),
+                             'baseline' if mode == 'baseline' else 'stream'],
+                            stdin=subprocess.PIPE, stdout=subprocess.PIPE,
+                            stderr=subprocess.PIPE, bufsize=0)
+
+    def to_rx(part):
+        try:
+            proc.stdin.write(part)
+            return True
+        except (BrokenPipeError, ValueError):
+            return False
+
+    fwd = Wire(to_rx, baud, args.latency_ms / 1000.0, ber, rng)
+    port = LinkPort(fwd)
+    rev = Wire(port.feed, baud, args.latency_ms / 1000.0, ber, rng)
+
+    def from_rx():
+        while True:
+            part = os.read(proc.stdout.fileno(), 4096)
+            if not part:
+                rev.q.put((0, None))
+                return
+            rev.put(part)
+
+    for t in (fwd, rev):
+        t.start()
+    reader = threading.Thread(target=from_rx, daemon=True)
+    reader.start()
+
+    sender = Sender(port, window=mode == 'window')
+    ok = False
+    stats = {'time': 0.0, 'data_time': 0.0, 'retransmits': 0, 'window': 0}
+    try:
+        stats = sender.send('app.bin', data)
+    except SendError as e:
+        stats['error'] = str(e)
+    fwd.q.put((0, None))
+    try:
+        _, err = proc.communicate(timeout=15)
+    except subprocess.TimeoutExpired:
+        proc.kill()
+        _, err = proc.communicate()
+    want = hashlib.md5(data).hexdigest()
+    for line in err.decode(errors='replace').splitlines():
+        if line.startswith('result '):
+            parts = line.split()
+            ok = len(parts) == 4 and int(parts[1]) == len(data) and parts[2] == want
+            if ok:
+                # the md5 after the transfer, before the update is reported
+                stats['time'] += int(parts[3]) / 1e6
+                stats['data_time'] += int(parts[3]) / 1e6
+    with open(image.name, 'rb') as f:
+        ok = ok and f.read() == data
+    os.unlink(image.name)
+    stats['ok'] = ok
+    stats['bit_errors'] = fwd.errors + rev.errors
+    return stats
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument('--baud', type=int, nargs='+', default=[57600, 115200, 230400, 460800])
+    ap.add_argument('--ber', type=float, nargs='+', default=[0.0, 1e-5, 3e-5])
+    ap.add_argument('--size', type=int, default=32768, help='image size in bytes, at most 96 KB')
+    ap.add_argument('--latency-ms', type=float, default=2.0, help='one way link latency')
+    ap.add_argument('--page-us', type=int, default=1000, help='flash program time per 256 byte page')
+    ap.add_argument('--md5-us', type=int, default=150, help='md5 time per KB on the target')
+    ap.add_argument('--mode', choices=MODES, nargs='+', default=MODES)
+    ap.add_argument('--seed', type=int, default=1)
+    args = ap.parse_args()
+
+    data = random.Random(args.seed).randbytes(args.size) if hasattr(random.Random, 'randbytes') \
+        else os.urandom(args.size)
+    work = tempfile.mkdtemp()
+    rx = build(work)
+
+    print('%-8s %7s %8s %8s %8s %8s %6s %7s %5s %4s' %
+          ('mode', 'baud', 'ber', 'time s', 'data s', 'KB/s', 'line%', 'resent', 'bits', 'ok'))
+    failed = 0
+    for baud in args.baud:
+        for ber in args.ber:
+            for mode in [m for m in MODES if m in args.mode]:
+                s = run_once(rx, data, baud, ber, mode, args, args.seed)
+                line_rate = baud / 10.0 / 1024.0
+                kbs = args.size / 1024.0 / s['data_time'] if s['data_time'] else 0.0
+                print('%-8s %7d %8.0e %8.2f %8.2f %8.2f %6.1f %7d %5d %4s%s' %
+                      (mode, baud, ber, s['time'], s['data_time'],
+                       kbs, 100.0 * kbs / line_rate, s['retransmits'], s['bit_errors'],
+                       'yes' if s['ok'] else 'NO', '  ' + s['error'] if 'error' in s else ''))
+                sys.stdout.flush()
+                failed += 0 if s['ok'] else 1
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,13 @@
+/*
+ * host stand-in for board/user/debug/log/log.h
+ */
+#ifndef __LOG_H__
+#define __LOG_H__
+
+#include <stdio.h>
+
+#define  log_error(...)    fprintf(stderr,"[rx] " __VA_ARGS__)
+#define  log_info(...)     fprintf(stderr,"[rx] " __VA_ARGS__)
+#define  log_debug(...)
+
+#endif
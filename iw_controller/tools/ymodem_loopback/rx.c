@@ -0,0 +1,216 @@
+/*
+ * host build of the firmware ymodem receiver (lib/fymodem.c) for
+ * ymodem_loopback.py. the serial port is stdin/stdout, the sink is a
+ * memory image that hashes like process_update() and sleeps the given
+ * time per flash page to stand in for the IAP program and per KB for the
+ * md5 on the target.
+ *
+ * baseline is the pipeline before the streaming update: the whole update
+ * area is erased, every packet is programmed before its ACK goes out
+ * (the ACK is held back until the sink write returns) and the md5 is a
+ * second pass over the whole image after the transfer.
+ *
+ * usage: rx <image out> <program us per page> <md5 us per KB> <stream|baseline>
+ * prints "result <size> <md5> <us after the transfer>" on stderr.
+ */
+#include <poll.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "fymodem.h"
+#include "md5.h"
+
+#define  RX_FLASH_PAGE_SIZE       256
+#define  RX_SIZE_LIMIT            0x18000 /*APPLICATION_SIZE_LIMIT*/
+#define  RX_WAIT_TIMEOUT          10000
+
+typedef struct
+{
+    uint8_t   image[RX_SIZE_LIMIT];
+    uint32_t  size;
+    uint32_t  page_us;
+    uint32_t  md5_us;   /*per KB*/
+    bool      baseline;
+    bool      opened;
+    int       ack_held; /*baseline: ACK waiting for the program, -1 none*/
+    md5_ctx_t md5;
+}rx_sink_contex_t;
+
+static rx_sink_contex_t rx_sink_contex = { .ack_held = -1 };
+
+static int rx_write_all(int fd,const char *src,int size)
+{
+    int done = 0;
+    ssize_t rc;
+
+    while (done < size) {
+        rc = write(fd,src + done,size - done);
+        if (rc <= 0) {
+            return -1;
+        }
+        done += rc;
+    }
+    return done;
+}
+
+/*the program of the last packet is done, the held ACK goes out*/
+static int rx_release_ack(serial_handle_t *handle)
+{
+    char c;
+
+    if (rx_sink_contex.ack_held < 0) {
+        return 0;
+    }
+    c = (char)rx_sink_contex.ack_held;
+    rx_sink_contex.ack_held = -1;
+    return rx_write_all(handle->tx_fd,&c,1) < 0 ? -1 : 0;
+}
+
+int serial_read(serial_handle_t *handle,char *dst,int size)
+{
+    ssize_t rc;
+
+    if (rx_release_ack(handle) != 0) {
+        return -1;
+    }
+    rc = read(handle->rx_fd,dst,size);
+
+    return rc <= 0 ? -1 : (int)rc;
+}
+
+int serial_write(serial_handle_t *handle,const char *src,int size)
+{
+    if (rx_release_ack(handle) != 0) {
+        return -1;
+    }
+    if (rx_sink_contex.baseline && rx_sink_contex.opened && size == 1 && src[0] == 0x06) {
+        rx_sink_contex.ack_held = src[0];
+        return 1;
+    }
+    return rx_write_all(handle->tx_fd,src,size);
+}
+
+int serial_flush(serial_handle_t *handle)
+{
+    (void)handle;
+    return 0;
+}
+
+int serial_select(serial_handle_t *handle,uint32_t timeout)
+{
+    struct pollfd pfd = { .fd = handle->rx_fd, .events = POLLIN };
+    int rc;
+
+    if (rx_release_ack(handle) != 0) {
+        return -1;
+    }
+    rc = poll(&pfd,1,(int)timeout);
+
+    if (rc < 0) {
+        return -1;
+    }
+    if (rc > 0 && (pfd.revents & POLLIN) == 0) {
+        /*sender gone*/
+        return -1;
+    }
+    return rc;
+}
+
+int serial_complete(serial_handle_t *handle,uint32_t timeout)
+{
+    (void)handle;
+    (void)timeout;
+    return 0;
+}
+
+static int rx_sink_open(void *arg,uint32_t size)
+{
+    rx_sink_contex_t *contex = (rx_sink_contex_t *)arg;
+
+    contex->size = 0;
+    contex->opened = true;
+    md5_init(&contex->md5);
+    /*erase time of the pages of the file, the baseline erased the whole update area*/
+    if (contex->baseline) {
+        size = RX_SIZE_LIMIT;
+    }
+    usleep(contex->page_us * ((size + RX_FLASH_PAGE_SIZE - 1) / RX_FLASH_PAGE_SIZE));
+    return 0;
+}
+
+static int rx_sink_write(void *arg,const uint8_t *data,uint32_t size)
+{
+    rx_sink_contex_t *contex = (rx_sink_contex_t *)arg;
+    uint32_t pages;
+
+    if (contex->size + size > RX_SIZE_LIMIT) {
+        return -1;
+    }
+    /*pages completed by this write*/
+    pages = (contex->size + size) / RX_FLASH_PAGE_SIZE - contex->size / RX_FLASH_PAGE_SIZE;
+    memcpy(contex->image + contex->size,data,size);
+    contex->size += size;
+    if (contex->baseline) {
+        /*programmed in the critical section before the ACK, md5 comes later*/
+        usleep(contex->page_us * pages);
+        return 0;
+    }
+    md5_update(&contex->md5,(const char *)data,size);
+    usleep(contex->page_us * pages + contex->md5_us * size / 1024);
+    return 0;
+}
+
+static uint64_t rx_now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+int main(int argc,char *argv[])
+{
+    serial_handle_t handle = { .rx_fd = 0, .tx_fd = 1 };
+    fymodem_sink_t sink = { rx_sink_open, rx_sink_write, &rx_sink_contex };
+    char file_name[FYMODEM_FILE_NAME_MAX_LENGTH + 1];
+    char md5_value[HASHSIZE];
+    int32_t size;
+    uint64_t start;
+    FILE *f;
+
+    if (argc < 5) {
+        fprintf(stderr,"usage: %s <image out> <program us per page> <md5 us per KB> <stream|baseline>\n",argv[0]);
+        return 2;
+    }
+    rx_sink_contex.page_us = (uint32_t)atoi(argv[2]);
+    rx_sink_contex.md5_us = (uint32_t)atoi(argv[3]);
+    rx_sink_contex.baseline = strcmp(argv[4],"baseline") == 0;
+
+    size = fymodem_receive(&handle,&sink,RX_SIZE_LIMIT,file_name,RX_WAIT_TIMEOUT);
+    rx_release_ack(&handle);
+    if (size <= 0) {
+        fprintf(stderr,"result -1\n");
+        return 1;
+    }
+    start = rx_now_us();
+    if (rx_sink_contex.baseline) {
+        /*second pass over the programmed image*/
+        md5((const char *)rx_sink_contex.image,rx_sink_contex.size,md5_value);
+        usleep(rx_sink_contex.md5_us * rx_sink_contex.size / 1024);
+    } else {
+        md5_final(&rx_sink_contex.md5,md5_value);
+    }
+    f = fopen(argv[1],"wb");
+    if (f != NULL) {
+        fwrite(rx_sink_contex.image,1,rx_sink_contex.size,f);
+        fclose(f);
+    }
+    fprintf(stderr,"result %d ",(int)size);
+    for (int i = 0; i < HASHSIZE; i++) {
+        fprintf(stderr,"%02x",(uint8_t)md5_value[i]);
+    }
+    fprintf(stderr," %u\n",(unsigned)(rx_now_us() - start));
+    return 0;
+}
@@ -0,0 +1,52 @@
+/*
+ * host stand-in for board/user/serial/serial.h, just enough for
+ * lib/fymodem.c: the serial port is stdin/stdout of the process.
+ */
+#ifndef __SERIAL_H__
+#define __SERIAL_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct
+{
+    int rx_fd;
+    int tx_fd;
+}serial_handle_t;
+
+typedef struct
+{
+    uint64_t end;
+}utils_timer_t;
+
+static inline uint64_t utils_now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static inline int utils_timer_init(utils_timer_t *timer,uint32_t timeout,bool up)
+{
+    (void)up;
+    timer->end = utils_now_ms() + timeout;
+    return 0;
+}
+
+static inline uint32_t utils_timer_value(utils_timer_t *timer)
+{
+    uint64_t now = utils_now_ms();
+
+    return now >= timer->end ? 0 : (uint32_t)(timer->end - now);
+}
+
+int serial_read(serial_handle_t *handle,char *dst,int size);
+int serial_write(serial_handle_t *handle,const char *src,int size);
+int serial_flush(serial_handle_t *handle);
+int serial_select(serial_handle_t *handle,uint32_t timeout);
+int serial_complete(serial_handle_t *handle,uint32_t timeout);
+
+#endif
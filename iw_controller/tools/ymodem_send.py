@@ -0,0 +1,234 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+host side ymodem-1k sender for the firmware update (lib/fymodem.c).
+
+two modes:
+
+    classic   stop-and-wait, every packet waits for its ACK
+    window    the receiver offers 'W' + window size after acking the
+              header. the sender then streams up to window packets
+              ahead. data packets are answered with ACK/NAK + seq + ~seq:
+              ACK n acks everything up to n, NAK n acks everything
+              before n and asks for n again. the receiver keeps the
+              packets after a lost one, only n is repeated (selective
+              repeat)
+
+a receiver that does not offer 'W' gets classic mode. run it after the
+update notify command has been accepted, when the controller waits for
+the file:
+
+    python3 ymodem_send.py --port /dev/ttyUSB0 --baud 115200 app.bin
+
+--classic ignores the offer, the controller falls back to classic after
+one packet timeout. needs pyserial for a real port. ymodem_loopback.py
+uses the Sender class over an emulated link.
+"""
+import argparse
+import os
+import time
+
+SOH = 0x01
+STX = 0x02
+EOT = 0x04
+ACK = 0x06
+NAK = 0x15
+CAN = 0x18
+CRC = 0x43
+WIN = 0x57
+
+PACKET_SIZE = 128
+PACKET_1K_SIZE = 1024
+PAD = 0x1A
+
+RESPONSE_TIMEOUT = 3.0      # longer than the receiver's 1 s packet timeout
+START_TIMEOUT = 30.0
+RETRY_MAX = 10
+WINDOW_MAX = 127            # seq is 8 bit, acks must stay unambiguous
+
+
+class SendError(Exception):
+    pass
+
+
+def crc16(data):
+    """crc16-ccitt, same as ym_crc16"""
+    crc = 0
+    for b in data:
+        x = ((crc >> 8) ^ b) & 0xff
+        x ^= x >> 4
+        crc = ((crc << 8) ^ (x << 12) ^ (x << 5) ^ x) & 0xffff
+    return crc
+
+
+def packet(seq, data, size, pad=PAD):
+    body = bytes(data) + bytes([pad]) * (size - len(data))
+    c = crc16(body)
+    start = SOH if size == PACKET_SIZE else STX
+    return bytes([start, seq & 0xff, ~seq & 0xff]) + body + bytes([c >> 8, c & 0xff])
+
+
+def header(name, size):
+    """block 0, zero padded. no name ends the batch"""
+    if name is None:
+        return packet(0, b'', PACKET_SIZE, 0)
+    info = name.encode()[:PACKET_SIZE - 18] + b'\0' + str(size).encode() + b' '
+    return packet(0, info, PACKET_SIZE, 0)
+
+
+class Sender(object):
+    """port needs write(bytes) and read(n) returning b'' on timeout,
+    with a settable timeout attribute (pyserial style)"""
+
+    def __init__(self, port, window=True, window_max=WINDOW_MAX, log=None):
+        self.port = port
+        self.window = window
+        self.window_max = min(window_max, WINDOW_MAX)
+        self.log = log or (lambda msg: None)
+        self.pending = b''
+        self.stats = {}
+
+    def getc(self, timeout):
+        if not self.pending:
+            self.port.timeout = timeout
+            self.pending = self.port.read(4096)
+            if not self.pending:
+                return None
+        c = self.pending[0]
+        self.pending = self.pending[1:]
+        return c
+
+    def wait_for(self, chars, timeout):
+        end = time.monotonic() + timeout
+        while True:
+            left = end - time.monotonic()
+            if left <= 0:
+                return None
+            c = self.getc(left)
+            if c in chars:
+                return c
+            if c == CAN and self.getc(1.0) == CAN:
+                raise SendError('aborted by receiver')
+
+    def response(self, timeout):
+        """window mode response: (ACK|NAK, seq), ('CAN', 0) or None"""
+        end = time.monotonic() + timeout
+        while True:
+            left = end - time.monotonic()
+            if left <= 0:
+                return None
+            c = self.getc(left)
+            if c in (ACK, NAK):
+                seq = self.getc(1.0)
+                cmp = self.getc(1.0)
+                if seq is not None and cmp is not None and seq ^ cmp == 0xff:
+                    return c, seq
+            elif c == CAN and self.getc(1.0) == CAN:
+                return CAN, 0
+
+    def send_acked(self, data, expect_offer=False):
+        """send a packet or EOT stop-and-wait. returns the char after
+        the ACK when expect_offer (the 'C' or 'W' that starts data)"""
+        for _ in range(RETRY_MAX):
+            self.port.write(data)
+            c = self.wait_for((ACK, NAK, CRC), RESPONSE_TIMEOUT)
+            if c == ACK:
+                if not expect_offer:
+                    return None
+                while True:
+                    c = self.wait_for((CRC, WIN), RESPONSE_TIMEOUT)
+                    if c is None:
+                        raise SendError('no start after header')
+                    if c == WIN:
+                        n = self.getc(1.0)
+                        if self.window and n:
+                            return min(n, self.window_max)
+                        continue
+                    return 1
+            self.stats['retransmits'] += 1
+        raise SendError('too many retries')
+
+    def send_classic(self, packets):
+        for p in packets:
+            self.send_acked(p)
+
+    def send_window(self, packets, window):
+        total = len(packets)
+        base = 0    # oldest unacked, index into packets, seq = index + 1
+        nxt = 0
+        timeouts = 0
+        while base < total:
+            while nxt < total and nxt < base + window:
+                self.port.write(packets[nxt])
+                nxt += 1
+            r = self.response(RESPONSE_TIMEOUT)
+            if r is None:
+                timeouts += 1
+                if timeouts >= RETRY_MAX:
+                    raise SendError('no response')
+                self.port.write(packets[base])
+                self.stats['retransmits'] += 1
+                continue
+            timeouts = 0
+            kind, seq = r
+            if kind == CAN:
+                raise SendError('aborted by receiver')
+            # map the 8 bit seq into [base, nxt]
+            idx = base + ((seq - (base + 1)) & 0xff)
+            if kind == ACK and idx < nxt:
+                base = idx + 1
+            elif kind == NAK and idx <= nxt:
+                # everything before it arrived, repeat just this one,
+                # the receiver kept the rest of the window
+                base = idx
+                if idx < nxt:
+                    self.port.write(packets[idx])
+                    self.stats['retransmits'] += 1
+
+    def send(self, name, data):
+        self.stats = {'retransmits': 0, 'window': 1}
+        start = time.monotonic()
+        if self.wait_for((CRC,), START_TIMEOUT) is None:
+            raise SendError('receiver not ready')
+        window = self.send_acked(header(name, len(data)), expect_offer=True)
+        self.stats['window'] = window
+        packets = []
+        for seq, off in enumerate(range(0, len(data), PACKET_1K_SIZE), 1):
+            packets.append(packet(seq, data[off:off + PACKET_1K_SIZE], PACKET_1K_SIZE))
+        data_start = time.monotonic()
+        if window > 1:
+            self.send_window(packets, window)
+        else:
+            self.send_classic(packets)
+        self.send_acked(bytes([EOT]))
+        self.stats['data_time'] = time.monotonic() - data_start
+        # end of batch
+        if self.wait_for((CRC,), RESPONSE_TIMEOUT) is not None:
+            self.send_acked(header(None, 0))
+        self.stats['time'] = time.monotonic() - start
+        self.log('sent %d bytes in %.2f s (data %.2f s), window %d, %d retransmits' %
+                 (len(data), self.stats['time'], self.stats['data_time'],
+                  window, self.stats['retransmits']))
+        return self.stats
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument('file')
+    ap.add_argument('--port', required=True)
+    ap.add_argument('--baud', type=int, default=115200)
+    ap.add_argument('--classic', action='store_true', help='stop-and-wait even if window mode is offered')
+    ap.add_argument('--window-max', type=int, default=WINDOW_MAX)
+    args = ap.parse_args()
+
+    import serial
+    with open(args.file, 'rb') as f:
+        data = f.read()
+    port = serial.Serial(args.port, args.baud, timeout=1.0)
+    sender = Sender(port, window=not args.classic, window_max=args.window_max, log=print)
+    stats = sender.send(os.path.basename(args.file), data)
+    print('%.2f KB/s' % (len(data) / 1024.0 / stats['time']))
+
+
+if __name__ == '__main__':
+    main()